@@ -52,6 +52,7 @@ case "$1" in
 	build "--without-libnettle --with-libgcrypt" "libgcrypt"
 	build "--without-gnutls" "openssl"
 	build "--without-gnutls --without-openssl" "nossl"
+	build "--enable-internal-arc4" "internalarc4"
 	build "--without-libcares" "nocares"
 	build "--without-libxml2" "expat"
 	build "--without-libxml2 --without-libexpat" "noxml"
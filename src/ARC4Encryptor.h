@@ -39,6 +39,13 @@
 
 #ifdef USE_INTERNAL_ARC4
 #include "InternalARC4Encryptor.h"
+
+namespace aria2 {
+
+class ARC4Encryptor : public InternalARC4Encryptor {
+};
+
+} // namespace aria2
 #elif HAVE_LIBNETTLE
 #include "LibnettleARC4Encryptor.h"
 #elif HAVE_LIBGCRYPT
@@ -100,6 +100,9 @@ AbstractCommand::AbstractCommand(
   if (socket_ && socket_->isOpen()) {
     setReadCheckSocket(socket_);
   }
+  if (socketRecvBuffer_) {
+    socketRecvBuffer_->setCommand(this);
+  }
   if (incNumConnection_) {
     requestGroup->increaseStreamConnection();
   }
@@ -114,6 +117,9 @@ AbstractCommand::~AbstractCommand()
 {
   disableReadCheckSocket();
   disableWriteCheckSocket();
+  if (socketRecvBuffer_) {
+    socketRecvBuffer_->releaseCommand(this);
+  }
 #ifdef ENABLE_ASYNC_DNS
   asyncNameResolverMan_->disableNameResolverCheck(e_, this);
 #endif // ENABLE_ASYNC_DNS
@@ -145,7 +151,8 @@ bool AbstractCommand::shouldProcess() const
       return true;
     }
 
-    if (socketRecvBuffer_ && !socketRecvBuffer_->bufferEmpty()) {
+    if (socketRecvBuffer_ && (!socketRecvBuffer_->bufferEmpty() ||
+                              socketRecvBuffer_->dataAvailable())) {
       return true;
     }
 
@@ -176,6 +183,30 @@ bool AbstractCommand::shouldProcess() const
   return noCheck();
 }
 
+void AbstractCommand::sleepUntilSocketReady()
+{
+#ifdef ENABLE_ASYNC_DNS
+  // The name resolution is polled at every refresh.
+  if (asyncNameResolverMan_->resolverChecked()) {
+    return;
+  }
+#endif // ENABLE_ASYNC_DNS
+  if (!checkSocketIsReadable_ && !checkSocketIsWritable_) {
+    return;
+  }
+  auto timeout = timeout_ - checkPoint_.difference(global::wallclock());
+  if (req_ && getPieceStorage()) {
+    if (fileEntry_->countPooledRequest() > 0) {
+      return;
+    }
+    // Wake up for the search of faster server in execute().
+    timeout = std::min(timeout,
+                       10_s - serverStatTimer_.difference(global::wallclock()));
+  }
+  e_->sleepCommand(
+      this, std::chrono::duration_cast<std::chrono::milliseconds>(timeout));
+}
+
 bool AbstractCommand::execute()
 {
   A2_LOG_DEBUG(fmt("CUID#%" PRId64
@@ -341,6 +372,7 @@ bool AbstractCommand::execute()
     }
 
     addCommandSelf();
+    sleepUntilSocketReady();
     return false;
   }
   catch (DlAbortEx& err) {
@@ -930,7 +962,8 @@ const std::shared_ptr<PieceStorage>& AbstractCommand::getPieceStorage() const
 void AbstractCommand::checkSocketRecvBuffer()
 {
   if (socketRecvBuffer_->bufferEmpty() &&
-      socket_->getRecvBufferedLength() == 0) {
+      socket_->getRecvBufferedLength() == 0 &&
+      !socketRecvBuffer_->dataAvailable()) {
     return;
   }
 
@@ -95,6 +95,10 @@ private:
 
   bool shouldProcess() const;
 
+  // Lets this command sleep until the socket becomes ready or it
+  // times out, if nothing else needs periodic execution.
+  void sleepUntilSocketReady();
+
 public:
   RequestGroup* getRequestGroup() const { return requestGroup_; }
 
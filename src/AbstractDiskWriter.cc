@@ -43,6 +43,7 @@
 #include <cerrno>
 #include <cstring>
 #include <cassert>
+#include <algorithm>
 
 #include "File.h"
 #include "util.h"
@@ -53,6 +54,7 @@
 #include "DownloadFailureException.h"
 #include "error_code.h"
 #include "LogFactory.h"
+#include "SocketCore.h"
 
 namespace aria2 {
 
@@ -290,6 +292,43 @@ ssize_t AbstractDiskWriter::writeDataInternal(const unsigned char* data,
   }
 }
 
+#ifdef HAVE_PWRITEV
+ssize_t AbstractDiskWriter::writeDataVInternal(const a2iovec* iov,
+                                               size_t iovcnt, int64_t offset)
+{
+  a2iovec buf[A2_IOV_MAX];
+  ssize_t writtenLength = 0;
+  while (iovcnt > 0) {
+    size_t num = std::min(iovcnt, static_cast<size_t>(A2_IOV_MAX));
+    std::copy(iov, iov + num, buf);
+    iov += num;
+    iovcnt -= num;
+    a2iovec* first = buf;
+    while (num > 0) {
+      ssize_t ret = 0;
+      while ((ret = pwritev(fd_, first, num, offset)) == -1 && errno == EINTR)
+        ;
+      if (ret == -1) {
+        return -1;
+      }
+      writtenLength += ret;
+      offset += ret;
+      // Skip the buffers written completely and adjust the one
+      // written partially.
+      for (; num > 0 && static_cast<size_t>(ret) >= first->A2IOVEC_LEN;
+           ++first, --num) {
+        ret -= first->A2IOVEC_LEN;
+      }
+      if (num > 0) {
+        first->A2IOVEC_BASE = static_cast<char*>(first->A2IOVEC_BASE) + ret;
+        first->A2IOVEC_LEN -= ret;
+      }
+    }
+  }
+  return writtenLength;
+}
+#endif // HAVE_PWRITEV
+
 ssize_t AbstractDiskWriter::readDataInternal(unsigned char* data, size_t len,
                                              int64_t offset)
 {
@@ -439,6 +478,25 @@ bool isDiskFullError(int errNum)
 #endif // !__MINGW32__
       ;
 }
+
+// Throws the exception for the write error |errNum| on |filename|.
+void throwOnWriteError(const std::string& filename, int errNum)
+{
+  // If the error indicates disk full situation, throw
+  // DownloadFailureException and abort download instantly.
+  if (isDiskFullError(errNum)) {
+    throw DOWNLOAD_FAILURE_EXCEPTION3(
+        errNum,
+        fmt(EX_FILE_WRITE, filename.c_str(), fileStrerror(errNum).c_str()),
+        error_code::NOT_ENOUGH_DISK_SPACE);
+  }
+  else {
+    throw DL_ABORT_EX3(
+        errNum,
+        fmt(EX_FILE_WRITE, filename.c_str(), fileStrerror(errNum).c_str()),
+        error_code::FILE_IO_ERROR);
+  }
+}
 } // namespace
 
 void AbstractDiskWriter::writeData(const unsigned char* data, size_t len,
@@ -446,22 +504,27 @@ void AbstractDiskWriter::writeData(const unsigned char* data, size_t len,
 {
   ensureMmapWrite(len, offset);
   if (writeDataInternal(data, len, offset) < 0) {
-    int errNum = fileError();
-    // If the error indicates disk full situation, throw
-    // DownloadFailureException and abort download instantly.
-    if (isDiskFullError(errNum)) {
-      throw DOWNLOAD_FAILURE_EXCEPTION3(
-          errNum,
-          fmt(EX_FILE_WRITE, filename_.c_str(), fileStrerror(errNum).c_str()),
-          error_code::NOT_ENOUGH_DISK_SPACE);
-    }
-    else {
-      throw DL_ABORT_EX3(
-          errNum,
-          fmt(EX_FILE_WRITE, filename_.c_str(), fileStrerror(errNum).c_str()),
-          error_code::FILE_IO_ERROR);
+    throwOnWriteError(filename_, fileError());
+  }
+}
+
+void AbstractDiskWriter::writeDataV(const a2iovec* iov, size_t iovcnt,
+                                    int64_t offset)
+{
+#ifdef HAVE_PWRITEV
+  size_t len = 0;
+  for (size_t i = 0; i < iovcnt; ++i) {
+    len += iov[i].A2IOVEC_LEN;
+  }
+  ensureMmapWrite(len, offset);
+  if (!mapaddr_) {
+    if (writeDataVInternal(iov, iovcnt, offset) < 0) {
+      throwOnWriteError(filename_, fileError());
     }
+    return;
   }
+#endif // HAVE_PWRITEV
+  DiskWriter::writeDataV(iov, iovcnt, offset);
 }
 
 ssize_t AbstractDiskWriter::readData(unsigned char* data, size_t len,
@@ -590,4 +653,28 @@ void AbstractDiskWriter::dropCache(int64_t len, int64_t offset)
 #endif // HAVE_POSIX_FADVISE
 }
 
+ssize_t AbstractDiskWriter::sendData(const std::shared_ptr<SocketCore>& socket,
+                                     size_t len, int64_t offset)
+{
+  if (mapaddr_) {
+    if (offset >= maplen_) {
+      throw DL_ABORT_EX(EX_DATA_READ);
+    }
+    return socket->writeData(
+        mapaddr_ + offset, std::min(maplen_ - offset, static_cast<int64_t>(len)));
+  }
+#if defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+  if (!socket->isSecure()) {
+    auto nsent = socket->sendFile(fd_, offset, len);
+    if (nsent == 0 && !socket->wantWrite()) {
+      // sendfile(2) returns 0 if offset is at or beyond the end of
+      // file.
+      throw DL_ABORT_EX(EX_DATA_READ);
+    }
+    return nsent;
+  }
+#endif // HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+  return DiskWriter::sendData(socket, len, offset);
+}
+
 } // namespace aria2
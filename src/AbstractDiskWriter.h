@@ -60,6 +60,10 @@ private:
 
   ssize_t writeDataInternal(const unsigned char* data, size_t len,
                             int64_t offset);
+#ifdef HAVE_PWRITEV
+  ssize_t writeDataVInternal(const a2iovec* iov, size_t iovcnt,
+                             int64_t offset);
+#endif // HAVE_PWRITEV
   ssize_t readDataInternal(unsigned char* data, size_t len, int64_t offset);
 
   void seek(int64_t offset);
@@ -82,6 +86,10 @@ public:
   virtual void writeData(const unsigned char* data, size_t len,
                          int64_t offset) CXX11_OVERRIDE;
 
+  // Uses pwritev(2) if it is available and the file is not mapped.
+  virtual void writeDataV(const a2iovec* iov, size_t iovcnt,
+                          int64_t offset) CXX11_OVERRIDE;
+
   virtual ssize_t readData(unsigned char* data, size_t len,
                            int64_t offset) CXX11_OVERRIDE;
 
@@ -100,6 +108,11 @@ public:
   virtual void enableMmap() CXX11_OVERRIDE;
 
   virtual void dropCache(int64_t len, int64_t offset) CXX11_OVERRIDE;
+
+  // Uses sendfile(2) if it is available and socket is not secured by
+  // TLS.
+  virtual ssize_t sendData(const std::shared_ptr<SocketCore>& socket,
+                           size_t len, int64_t offset) CXX11_OVERRIDE;
 };
 
 } // namespace aria2
@@ -38,7 +38,6 @@
 #include "DiskWriter.h"
 #include "FileEntry.h"
 #include "TruncFileAllocationIterator.h"
-#include "WrDiskCacheEntry.h"
 #include "LogFactory.h"
 #ifdef HAVE_SOME_FALLOCATE
 #include "FallocFileAllocationIterator.h"
@@ -76,6 +75,12 @@ void AbstractSingleDiskAdaptor::writeData(const unsigned char* data, size_t len,
   diskWriter_->writeData(data, len, offset);
 }
 
+void AbstractSingleDiskAdaptor::writeDataV(const a2iovec* iov, size_t iovcnt,
+                                           int64_t offset)
+{
+  diskWriter_->writeDataV(iov, iovcnt, offset);
+}
+
 ssize_t AbstractSingleDiskAdaptor::readData(unsigned char* data, size_t len,
                                             int64_t offset)
 {
@@ -94,13 +99,11 @@ ssize_t AbstractSingleDiskAdaptor::readDataDropCache(unsigned char* data,
   return rv;
 }
 
-void AbstractSingleDiskAdaptor::writeCache(const WrDiskCacheEntry* entry)
+ssize_t
+AbstractSingleDiskAdaptor::sendData(const std::shared_ptr<SocketCore>& socket,
+                                    size_t len, int64_t offset)
 {
-  for (auto& d : entry->getDataSet()) {
-    A2_LOG_DEBUG(fmt("Cache flush goff=%" PRId64 ", len=%lu", d->goff,
-                     static_cast<unsigned long>(d->len)));
-    writeData(d->data + d->offset, d->len, d->goff);
-  }
+  return diskWriter_->sendData(socket, len, offset);
 }
 
 bool AbstractSingleDiskAdaptor::fileExists()
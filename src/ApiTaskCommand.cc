@@ -0,0 +1,115 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "ApiTaskCommand.h"
+
+#include <exception>
+
+#include "aria2api.h"
+#include "ApiTaskQueue.h"
+#include "DownloadEngine.h"
+#include "RequestGroupMan.h"
+#include "LogFactory.h"
+#include "fmt.h"
+
+namespace aria2 {
+
+namespace {
+// The maximum number of tasks run in one execution, so that the tasks
+// posted continuously do not starve downloads.
+const size_t MAX_TASKS_PER_EXECUTION = 1024;
+} // namespace
+
+ApiTaskCommand::ApiTaskCommand(cuid_t cuid, DownloadEngine* e,
+                               Session* session)
+    : Command(cuid), e_(e), session_(session)
+{
+  auto fd = session_->taskQueue->getWakeupFd();
+  if (fd == (sock_t)-1) {
+    setStatusRealtime();
+  }
+  else {
+    e_->addFdForReadCheck(fd, this);
+  }
+}
+
+ApiTaskCommand::~ApiTaskCommand()
+{
+  auto fd = session_->taskQueue->getWakeupFd();
+  if (fd != (sock_t)-1) {
+    e_->deleteFdForReadCheck(fd, this);
+  }
+}
+
+bool ApiTaskCommand::execute()
+{
+  runTasks();
+  if (e_->isHaltRequested() || e_->getRequestGroupMan()->downloadFinished()) {
+    // run() is about to return 0.  Reject further tasks and run the
+    // ones which came in the meantime.
+    session_->taskQueue->close();
+    runTasks();
+    return true;
+  }
+  e_->addCommand(std::unique_ptr<Command>(this));
+  return false;
+}
+
+void ApiTaskCommand::runTasks()
+{
+  auto& queue = session_->taskQueue;
+  queue->clearWakeup();
+  Task task;
+  for (size_t i = 0; i < MAX_TASKS_PER_EXECUTION; ++i) {
+    if (!queue->pop(task)) {
+      return;
+    }
+    try {
+      task(session_);
+    }
+    catch (std::exception& ex) {
+      A2_LOG_ERROR(fmt("Exception caught in the posted task: %s", ex.what()));
+    }
+    catch (...) {
+      A2_LOG_ERROR("Unknown exception caught in the posted task");
+    }
+    // Destroy the captured objects now.
+    task = nullptr;
+  }
+  // More tasks are left.  Come back without waiting for events.
+  setStatusActive();
+  e_->setNoWait(true);
+}
+
+} // namespace aria2
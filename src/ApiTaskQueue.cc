@@ -0,0 +1,76 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "ApiTaskQueue.h"
+
+namespace aria2 {
+
+ApiTaskQueue::ApiTaskQueue(size_t capacity)
+    : queue_(capacity), wakeupPending_(false), closed_(false)
+{
+}
+
+bool ApiTaskQueue::push(Task& task)
+{
+  if (closed_.load(std::memory_order_acquire) || !queue_.push(task)) {
+    return false;
+  }
+  wakeUp();
+  return true;
+}
+
+bool ApiTaskQueue::pop(Task& task) { return queue_.pop(task); }
+
+void ApiTaskQueue::close() { closed_.store(true, std::memory_order_release); }
+
+void ApiTaskQueue::wakeUp()
+{
+  // Pairs with the fence in clearWakeup().  Either we see
+  // wakeupPending_ false and write, or the consumer sees our task
+  // after clearing wakeupPending_.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (wakeupPending_.exchange(true)) {
+    return;
+  }
+  wakeupFd_.notify();
+}
+
+void ApiTaskQueue::clearWakeup()
+{
+  wakeupFd_.clear();
+  wakeupPending_.store(false);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+} // namespace aria2
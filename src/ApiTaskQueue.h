@@ -0,0 +1,99 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_API_TASK_QUEUE_H
+#define D_API_TASK_QUEUE_H
+
+#include "common.h"
+
+#include <atomic>
+
+#include <aria2/aria2.h>
+
+#include "MpscQueue.h"
+#include "WakeupFd.h"
+
+namespace aria2 {
+
+// The queue of the tasks posted to the session by aria2::postTask().
+// Any thread can push tasks, and the thread running DownloadEngine
+// pops them.  When the queue becomes non-empty, the wakeup file
+// descriptor, which is watched by ApiTaskCommand, becomes readable so
+// that event polling returns immediately.  On Windows, there is no
+// wakeup file descriptor and the tasks are picked up at the next
+// event polling timeout.
+class ApiTaskQueue {
+public:
+  ApiTaskQueue(size_t capacity);
+
+  ApiTaskQueue(const ApiTaskQueue&) = delete;
+  ApiTaskQueue& operator=(const ApiTaskQueue&) = delete;
+
+  // Moves |task| into the queue and wakes up event polling if
+  // necessary.  Returns false if the queue is full or closed, and
+  // |task| is left untouched.  This function can be called from any
+  // thread.
+  bool push(Task& task);
+
+  // Moves the oldest task to |task| and returns true.  If the queue
+  // is empty, returns false.  Only the thread running DownloadEngine
+  // may call this function.
+  bool pop(Task& task);
+
+  // Makes the wakeup file descriptor unreadable.  Call this function
+  // before popping tasks, so that the task pushed after the last pop
+  // triggers another wakeup.
+  void clearWakeup();
+
+  // Makes push() fail from now on.
+  void close();
+
+  // Returns the file descriptor which becomes readable when a task is
+  // pushed, or -1 if it is not available.
+  sock_t getWakeupFd() const { return wakeupFd_.getFd(); }
+
+private:
+  void wakeUp();
+
+  MpscQueue<Task> queue_;
+  // true if wakeup file descriptor was made readable and
+  // clearWakeup() has not been called yet.
+  std::atomic<bool> wakeupPending_;
+  std::atomic<bool> closed_;
+  WakeupFd wakeupFd_;
+};
+
+} // namespace aria2
+
+#endif // D_API_TASK_QUEUE_H
@@ -0,0 +1,190 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "ArenaStructParserStateMachine.h"
+
+#include "a2functional.h"
+
+namespace aria2 {
+
+std::unique_ptr<ValueArena> ArenaStructParserStateMachine::noResult()
+{
+  return nullptr;
+}
+
+ArenaStructParserStateMachine::ArenaStructParserStateMachine()
+    : arena_{make_unique<ValueArena>()},
+      inputFirst_{nullptr},
+      inputLast_{nullptr},
+      str_{nullptr},
+      strLen_{0},
+      spilled_{false},
+      number_{0},
+      bval_{false}
+{
+}
+
+ArenaStructParserStateMachine::~ArenaStructParserStateMachine() = default;
+
+void ArenaStructParserStateMachine::setInput(const char* data, size_t len)
+{
+  inputFirst_ = data;
+  inputLast_ = data + len;
+}
+
+void ArenaStructParserStateMachine::reset()
+{
+  if (!arena_->empty()) {
+    arena_ = make_unique<ValueArena>();
+  }
+  inputFirst_ = inputLast_ = nullptr;
+  beginString();
+}
+
+void ArenaStructParserStateMachine::beginElement(int elementType)
+{
+  switch (elementType) {
+  case STRUCT_DICT_T:
+    arena_->beginDict();
+    break;
+  case STRUCT_ARRAY_T:
+    arena_->beginList();
+    break;
+  case STRUCT_DICT_KEY_T:
+  case STRUCT_STRING_T:
+    beginString();
+    break;
+  case STRUCT_NUMBER_T:
+    number_ = 0;
+    break;
+  case STRUCT_BOOL_T:
+    bval_ = false;
+    break;
+  default:
+    break;
+  }
+}
+
+void ArenaStructParserStateMachine::endElement(int elementType)
+{
+  switch (elementType) {
+  case STRUCT_DICT_T:
+  case STRUCT_ARRAY_T:
+    arena_->endContainer();
+    break;
+  case STRUCT_DICT_KEY_T:
+  case STRUCT_STRING_T:
+    endString();
+    break;
+  case STRUCT_NUMBER_T:
+    arena_->addInteger(number_);
+    break;
+  case STRUCT_BOOL_T:
+    arena_->addBool(bval_);
+    break;
+  case STRUCT_NULL_T:
+    arena_->addNull();
+    break;
+  default:
+    break;
+  }
+}
+
+void ArenaStructParserStateMachine::beginString()
+{
+  str_ = nullptr;
+  strLen_ = 0;
+  spilled_ = false;
+  buf_.clear();
+}
+
+void ArenaStructParserStateMachine::endString()
+{
+  if (spilled_) {
+    arena_->addString(arena_->copyString(buf_.data(), buf_.size()),
+                      buf_.size());
+  }
+  else if (strLen_ == 0) {
+    arena_->addString("", 0);
+  }
+  else {
+    arena_->addString(str_, strLen_);
+  }
+}
+
+void ArenaStructParserStateMachine::charactersCallback(const char* data,
+                                                       size_t len)
+{
+  if (!spilled_ && inputFirst_ && inputFirst_ <= data &&
+      data + len <= inputLast_) {
+    if (strLen_ == 0) {
+      str_ = data;
+      strLen_ = len;
+      return;
+    }
+    if (str_ + strLen_ == data) {
+      strLen_ += len;
+      return;
+    }
+  }
+  // The data may not survive this call (e.g., the unescaped
+  // character or the buffer reused for the next chunk), so copy it
+  // now.
+  if (!spilled_) {
+    buf_.assign(str_ ? str_ : "", strLen_);
+    spilled_ = true;
+  }
+  buf_.append(data, len);
+}
+
+void ArenaStructParserStateMachine::numberCallback(int64_t number, int frac,
+                                                   int exp)
+{
+  // TODO Ignore frac and exp
+  number_ = number;
+}
+
+void ArenaStructParserStateMachine::boolCallback(bool bval) { bval_ = bval; }
+
+std::unique_ptr<ValueArena> ArenaStructParserStateMachine::getResult()
+{
+  if (arena_->empty()) {
+    return nullptr;
+  }
+  auto res = std::move(arena_);
+  arena_ = make_unique<ValueArena>();
+  return res;
+}
+
+} // namespace aria2
@@ -0,0 +1,111 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_ARENA_STRUCT_PARSER_STATE_MACHINE_H
+#define D_ARENA_STRUCT_PARSER_STATE_MACHINE_H
+
+#include "StructParserStateMachine.h"
+
+#include <string>
+#include <memory>
+
+#include "ValueArena.h"
+
+namespace aria2 {
+
+// Builds ValueArena from the events of JSON or Bencode parser.
+class ArenaStructParserStateMachine : public StructParserStateMachine {
+public:
+  typedef std::unique_ptr<ValueArena> ResultType;
+
+  static std::unique_ptr<ValueArena> noResult();
+
+  ArenaStructParserStateMachine();
+  virtual ~ArenaStructParserStateMachine();
+
+  virtual void beginElement(int elementType) CXX11_OVERRIDE;
+  virtual void endElement(int elementType) CXX11_OVERRIDE;
+  virtual void reset() CXX11_OVERRIDE;
+  virtual void charactersCallback(const char* data,
+                                  size_t len) CXX11_OVERRIDE;
+  virtual void numberCallback(int64_t number, int frac,
+                              int exp) CXX11_OVERRIDE;
+  virtual void boolCallback(bool bval) CXX11_OVERRIDE;
+
+  // Tells that the whole input is |len| bytes of |data|, and it
+  // outlives the result.  The strings which appear in it without
+  // escape are referenced instead of being copied.
+  void setInput(const char* data, size_t len);
+
+  // Returns the parsed value.  If nothing is parsed, returns nullptr.
+  std::unique_ptr<ValueArena> getResult();
+
+private:
+  void beginString();
+  void endString();
+
+  std::unique_ptr<ValueArena> arena_;
+  const char* inputFirst_;
+  const char* inputLast_;
+  // The string being parsed, which is in the input buffer.
+  const char* str_;
+  size_t strLen_;
+  // True if the string being parsed is stored in buf_.
+  bool spilled_;
+  std::string buf_;
+  int64_t number_;
+  bool bval_;
+};
+
+// Parses |len| bytes of |data| in one go using Parser, and returns
+// the result.  The strings in the result may refer to |data|, so it
+// must outlive the result.  The |error| is set in the same way as
+// GenericParser::parseFinal().
+template <typename Parser>
+std::unique_ptr<ValueArena> parseArena(const char* data, size_t len,
+                                       ssize_t& error)
+{
+  ArenaStructParserStateMachine psm;
+  Parser parser(&psm);
+  psm.setInput(data, len);
+  error = parser.parseFinal(data, len);
+  if (error < 0) {
+    return ArenaStructParserStateMachine::noResult();
+  }
+  return psm.getResult();
+}
+
+} // namespace aria2
+
+#endif // D_ARENA_STRUCT_PARSER_STATE_MACHINE_H
@@ -0,0 +1,128 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "BdpEstimator.h"
+
+#include <algorithm>
+
+#include "wallclock.h"
+
+namespace aria2 {
+
+namespace {
+// A round is at least this long, so that the rate of a fast peer on
+// a short path is not measured over a few scheduling ticks.
+constexpr auto MIN_ROUND_TIME = std::chrono::milliseconds(100);
+} // namespace
+
+const std::chrono::milliseconds BdpEstimator::MIN_REQUEST_TIMEOUT =
+    std::chrono::seconds(5);
+
+BdpEstimator::BdpEstimator()
+    : minRtt_(0),
+      srtt_(0),
+      rttvar_(0),
+      latencySampled_(false),
+      roundStart_(Timer::zero()),
+      roundDelivered_(0),
+      bandwidthSamples_{{}},
+      bandwidthIndex_(0)
+{
+}
+
+void BdpEstimator::updateLatency(Timer::Clock::duration latency)
+{
+  auto sample = std::chrono::duration_cast<std::chrono::microseconds>(latency);
+  if (!latencySampled_) {
+    latencySampled_ = true;
+    minRtt_ = sample;
+    srtt_ = sample;
+    rttvar_ = sample / 2;
+    return;
+  }
+  minRtt_ = std::min(minRtt_, sample);
+  auto delta = srtt_ > sample ? srtt_ - sample : sample - srtt_;
+  rttvar_ = (rttvar_ * 3 + delta) / 4;
+  srtt_ = (srtt_ * 7 + sample) / 8;
+}
+
+void BdpEstimator::updateDelivered(int32_t bytes)
+{
+  const auto& now = global::wallclock();
+  if (roundDelivered_ == 0) {
+    // Start a new round with the first block, so that the time the
+    // peer was idle is not counted.
+    roundStart_ = now;
+  }
+  roundDelivered_ += bytes;
+  if (!latencySampled_) {
+    return;
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      roundStart_.difference(now));
+  if (elapsed < std::max(std::chrono::duration_cast<std::chrono::microseconds>(
+                             MIN_ROUND_TIME),
+                         minRtt_)) {
+    return;
+  }
+  bandwidthSamples_[bandwidthIndex_] =
+      roundDelivered_ * 1000000 / elapsed.count();
+  bandwidthIndex_ = (bandwidthIndex_ + 1) % BANDWIDTH_WINDOW;
+  roundDelivered_ = 0;
+}
+
+int64_t BdpEstimator::getBandwidth() const
+{
+  return *std::max_element(std::begin(bandwidthSamples_),
+                           std::end(bandwidthSamples_));
+}
+
+size_t BdpEstimator::getPipelineDepth(int32_t blockLength) const
+{
+  auto bdp = getBandwidth() * minRtt_.count() / 1000000;
+  return (bdp * 2 + blockLength - 1) / blockLength;
+}
+
+std::chrono::milliseconds
+BdpEstimator::getRequestTimeout(const std::chrono::milliseconds& upper) const
+{
+  if (!latencySampled_) {
+    return upper;
+  }
+  auto rto = std::chrono::duration_cast<std::chrono::milliseconds>(
+      srtt_ + rttvar_ * 4);
+  return std::min(upper, std::max(MIN_REQUEST_TIMEOUT, rto));
+}
+
+} // namespace aria2
@@ -0,0 +1,109 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_BDP_ESTIMATOR_H
+#define D_BDP_ESTIMATOR_H
+
+#include "common.h"
+
+#include <array>
+#include <chrono>
+
+#include "TimerA2.h"
+
+namespace aria2 {
+
+// Estimates the bandwidth-delay product of the path to a peer from
+// the latency of block requests and the rate of received blocks.
+// The minimum latency approximates the round trip time, and the
+// bandwidth is the maximum delivery rate observed in the last few
+// rounds, in the spirit of BBR.  The smoothed latency and its
+// variation are used to derive the request timeout as RFC 6298 does
+// for TCP.
+class BdpEstimator {
+public:
+  BdpEstimator();
+
+  // Updates the latency estimate with |latency|, which is the time
+  // from sending a request to receiving the requested block.
+  void updateLatency(Timer::Clock::duration latency);
+
+  // Accounts |bytes| of block data received from the peer.
+  void updateDelivered(int32_t bytes);
+
+  // Returns the number of requests of |blockLength| bytes which
+  // should be outstanding to keep the pipe to the peer full.  Twice
+  // the bandwidth-delay product is returned so that the pipeline can
+  // double every round until the path is saturated.  Returns 0 if
+  // there is no estimate yet.
+  size_t getPipelineDepth(int32_t blockLength) const;
+
+  // Returns the request timeout, which is srtt + 4 * rttvar bounded
+  // by [MIN_REQUEST_TIMEOUT, |upper|].  It only decides when a request
+  // is stalled; the peer is snubbed after |upper|.  Returns |upper| if no latency
+  // has been measured yet.
+  std::chrono::milliseconds
+  getRequestTimeout(const std::chrono::milliseconds& upper) const;
+
+  // Returns the maximum delivery rate in the recent rounds in bytes
+  // per second.
+  int64_t getBandwidth() const;
+
+  const std::chrono::microseconds& getMinRtt() const { return minRtt_; }
+
+  const std::chrono::microseconds& getSmoothedLatency() const
+  {
+    return srtt_;
+  }
+
+  static const std::chrono::milliseconds MIN_REQUEST_TIMEOUT;
+
+  // The number of rounds the delivery rate samples are kept.
+  static const size_t BANDWIDTH_WINDOW = 10;
+
+private:
+  std::chrono::microseconds minRtt_;
+  std::chrono::microseconds srtt_;
+  std::chrono::microseconds rttvar_;
+  bool latencySampled_;
+
+  Timer roundStart_;
+  int64_t roundDelivered_;
+  std::array<int64_t, BANDWIDTH_WINDOW> bandwidthSamples_;
+  size_t bandwidthIndex_;
+};
+
+} // namespace aria2
+
+#endif // D_BDP_ESTIMATOR_H
@@ -34,6 +34,7 @@
 /* copyright --> */
 #include "BitfieldMan.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
@@ -44,6 +45,44 @@ using namespace aria2::expr;
 
 namespace aria2 {
 
+namespace {
+// Allocates zero-filled buffer for a bitfield of |length| bytes.  The
+// buffer is padded to a multiple of 8 bytes, so that it can be read
+// in 64 bits words.
+unsigned char* allocBitfield(size_t length)
+{
+  size_t n = (length + 7) / 8 * 8;
+  auto bitfield = new unsigned char[n];
+  memset(bitfield, 0, n);
+  return bitfield;
+}
+} // namespace
+
+namespace {
+bool testSummary(const std::vector<uint64_t>& summary, size_t w)
+{
+  return (summary[w / 64] >> (w % 64)) & 1;
+}
+} // namespace
+
+namespace {
+// Returns the smallest word index which is greater than or equal to
+// |w| and whose bit in |summary| is not set.  If there is no such
+// word, returns |nwords|.
+size_t findUnsetWord(const std::vector<uint64_t>& summary, size_t w,
+                     size_t nwords)
+{
+  while (w < nwords) {
+    uint64_t bits = ~summary[w / 64] >> (w % 64);
+    if (bits) {
+      return std::min(nwords, w + bitfield::countTrailingZero64(bits));
+    }
+    w = (w / 64 + 1) * 64;
+  }
+  return nwords;
+}
+} // namespace
+
 BitfieldMan::BitfieldMan(int32_t blockLength, int64_t totalLength)
     : totalLength_(totalLength),
       cachedCompletedLength_(0),
@@ -62,10 +101,8 @@ BitfieldMan::BitfieldMan(int32_t blockLength, int64_t totalLength)
   if (blockLength_ > 0 && totalLength_ > 0) {
     blocks_ = (totalLength_ + blockLength_ - 1) / blockLength_;
     bitfieldLength_ = blocks_ / 8 + (blocks_ % 8 ? 1 : 0);
-    bitfield_ = new unsigned char[bitfieldLength_];
-    useBitfield_ = new unsigned char[bitfieldLength_];
-    memset(bitfield_, 0, bitfieldLength_);
-    memset(useBitfield_, 0, bitfieldLength_);
+    bitfield_ = allocBitfield(bitfieldLength_);
+    useBitfield_ = allocBitfield(bitfieldLength_);
     updateCache();
   }
 }
@@ -75,8 +112,8 @@ BitfieldMan::BitfieldMan(const BitfieldMan& bitfieldMan)
       cachedCompletedLength_(0),
       cachedFilteredCompletedLength_(0),
       cachedFilteredTotalLength_(0),
-      bitfield_(new unsigned char[bitfieldMan.bitfieldLength_]),
-      useBitfield_(new unsigned char[bitfieldMan.bitfieldLength_]),
+      bitfield_(allocBitfield(bitfieldMan.bitfieldLength_)),
+      useBitfield_(allocBitfield(bitfieldMan.bitfieldLength_)),
       filterBitfield_(nullptr),
       bitfieldLength_(bitfieldMan.bitfieldLength_),
       cachedNumMissingBlock_(0),
@@ -88,7 +125,7 @@ BitfieldMan::BitfieldMan(const BitfieldMan& bitfieldMan)
   memcpy(bitfield_, bitfieldMan.bitfield_, bitfieldLength_);
   memcpy(useBitfield_, bitfieldMan.useBitfield_, bitfieldLength_);
   if (filterEnabled_) {
-    filterBitfield_ = new unsigned char[bitfieldLength_];
+    filterBitfield_ = allocBitfield(bitfieldLength_);
     memcpy(filterBitfield_, bitfieldMan.filterBitfield_, bitfieldLength_);
   }
   updateCache();
@@ -104,16 +141,16 @@ BitfieldMan& BitfieldMan::operator=(const BitfieldMan& bitfieldMan)
     filterEnabled_ = bitfieldMan.filterEnabled_;
 
     delete[] bitfield_;
-    bitfield_ = new unsigned char[bitfieldLength_];
+    bitfield_ = allocBitfield(bitfieldLength_);
     memcpy(bitfield_, bitfieldMan.bitfield_, bitfieldLength_);
 
     delete[] useBitfield_;
-    useBitfield_ = new unsigned char[bitfieldLength_];
+    useBitfield_ = allocBitfield(bitfieldLength_);
     memcpy(useBitfield_, bitfieldMan.useBitfield_, bitfieldLength_);
 
     delete[] filterBitfield_;
     if (filterEnabled_) {
-      filterBitfield_ = new unsigned char[bitfieldLength_];
+      filterBitfield_ = allocBitfield(bitfieldLength_);
       memcpy(filterBitfield_, bitfieldMan.filterBitfield_, bitfieldLength_);
     }
     else {
@@ -150,72 +187,115 @@ int32_t BitfieldMan::getBlockLength(size_t index) const
   }
 }
 
+uint64_t BitfieldMan::getWordMask(size_t w) const
+{
+  if (w + 1 == countWord() && blocks_ % 64) {
+    return ~static_cast<uint64_t>(0) << (64 - blocks_ % 64);
+  }
+  return ~static_cast<uint64_t>(0);
+}
+
+uint64_t BitfieldMan::getMissingWord(size_t w) const
+{
+  uint64_t bits = ~bitfield::loadWord(bitfield_, w) & getWordMask(w);
+  if (filterEnabled_) {
+    bits &= bitfield::loadWord(filterBitfield_, w);
+  }
+  return bits;
+}
+
+uint64_t BitfieldMan::getMissingUnusedWord(size_t w) const
+{
+  return getMissingWord(w) & ~bitfield::loadWord(useBitfield_, w);
+}
+
 bool BitfieldMan::hasMissingPiece(const unsigned char* peerBitfield,
                                   size_t length) const
 {
   if (bitfieldLength_ != length) {
     return false;
   }
-  bool retval = false;
-  for (size_t i = 0; i < bitfieldLength_; ++i) {
+  // peerBitfield is not padded, so the trailing bytes which do not
+  // fill a word are checked one by one.
+  const size_t nwords = bitfieldLength_ / 8;
+  for (size_t w = findUnsetWord(setSummary_, 0, nwords); w < nwords;
+       w = findUnsetWord(setSummary_, w + 1, nwords)) {
+    if (bitfield::loadWord(peerBitfield, w) & getMissingWord(w)) {
+      return true;
+    }
+  }
+  for (size_t i = nwords * 8; i < bitfieldLength_; ++i) {
     unsigned char temp = peerBitfield[i] & ~bitfield_[i];
     if (filterEnabled_) {
       temp &= filterBitfield_[i];
     }
     if (temp & 0xffu) {
-      retval = true;
-      break;
+      return true;
     }
   }
-  return retval;
+  return false;
 }
 
 bool BitfieldMan::getFirstMissingUnusedIndex(size_t& index) const
 {
-  if (filterEnabled_) {
-    return bitfield::getFirstSetBitIndex(
-        index,
-        ~array(bitfield_) & ~array(useBitfield_) & array(filterBitfield_),
-        blocks_);
-  }
-  else {
-    return bitfield::getFirstSetBitIndex(
-        index, ~array(bitfield_) & ~array(useBitfield_), blocks_);
+  const size_t nwords = countWord();
+  for (size_t w = findUnsetWord(usedSummary_, 0, nwords); w < nwords;
+       w = findUnsetWord(usedSummary_, w + 1, nwords)) {
+    uint64_t bits = getMissingUnusedWord(w);
+    if (bits) {
+      index = w * 64 + bitfield::countLeadingZero64(bits);
+      return true;
+    }
   }
+  return false;
 }
 
 size_t BitfieldMan::getFirstNMissingUnusedIndex(std::vector<size_t>& out,
                                                 size_t n) const
 {
-  if (filterEnabled_) {
-    return bitfield::getFirstNSetBitIndex(
-        std::back_inserter(out), n,
-        ~array(bitfield_) & ~array(useBitfield_) & array(filterBitfield_),
-        blocks_);
-  }
-  else {
-    return bitfield::getFirstNSetBitIndex(
-        std::back_inserter(out), n, ~array(bitfield_) & ~array(useBitfield_),
-        blocks_);
+  const size_t origN = n;
+  const size_t nwords = countWord();
+  for (size_t w = findUnsetWord(usedSummary_, 0, nwords); w < nwords && n > 0;
+       w = findUnsetWord(usedSummary_, w + 1, nwords)) {
+    uint64_t bits = getMissingUnusedWord(w);
+    for (; bits && n > 0; --n) {
+      size_t i = bitfield::countLeadingZero64(bits);
+      out.push_back(w * 64 + i);
+      bits &= ~(static_cast<uint64_t>(1) << (63 - i));
+    }
   }
+  return origN - n;
 }
 
 bool BitfieldMan::getFirstMissingIndex(size_t& index) const
 {
-  if (filterEnabled_) {
-    return bitfield::getFirstSetBitIndex(
-        index, ~array(bitfield_) & array(filterBitfield_), blocks_);
-  }
-  else {
-    return bitfield::getFirstSetBitIndex(index, ~array(bitfield_), blocks_);
+  const size_t nwords = countWord();
+  for (size_t w = findUnsetWord(setSummary_, 0, nwords); w < nwords;
+       w = findUnsetWord(setSummary_, w + 1, nwords)) {
+    uint64_t bits = getMissingWord(w);
+    if (bits) {
+      index = w * 64 + bitfield::countLeadingZero64(bits);
+      return true;
+    }
   }
+  return false;
 }
 
 namespace {
 template <typename Array>
-size_t getStartIndex(size_t index, const Array& bitfield, size_t blocks)
-{
-  while (index < blocks && bitfield::test(bitfield, blocks, index)) {
+size_t getStartIndex(size_t index, const Array& bitfield, size_t blocks,
+                     const std::vector<uint64_t>& usedSummary)
+{
+  while (index < blocks) {
+    // bitfield includes bitfield_ | useBitfield_, so the whole word
+    // can be skipped if usedSummary says it is full.
+    if (index % 64 == 0 && testSummary(usedSummary, index / 64)) {
+      index += 64;
+      continue;
+    }
+    if (!bitfield::test(bitfield, blocks, index)) {
+      break;
+    }
     ++index;
   }
   if (blocks <= index) {
@@ -243,13 +323,15 @@ template <typename Array>
 bool getSparseMissingUnusedIndex(size_t& index, int32_t minSplitSize,
                                  const Array& bitfield,
                                  const unsigned char* useBitfield,
+                                 const std::vector<uint64_t>& usedSummary,
                                  int32_t blockLength, size_t blocks)
 {
   BitfieldMan::Range maxRange;
   BitfieldMan::Range currentRange;
   size_t nextIndex = 0;
   while (nextIndex < blocks) {
-    currentRange.startIndex = getStartIndex(nextIndex, bitfield, blocks);
+    currentRange.startIndex =
+        getStartIndex(nextIndex, bitfield, blocks, usedSummary);
     if (currentRange.startIndex == blocks) {
       break;
     }
@@ -308,13 +390,13 @@ bool BitfieldMan::getSparseMissingUnusedIndex(
         index, minSplitSize,
         array(ignoreBitfield) | ~array(filterBitfield_) | array(bitfield_) |
             array(useBitfield_),
-        useBitfield_, blockLength_, blocks_);
+        useBitfield_, usedSummary_, blockLength_, blocks_);
   }
   else {
     return aria2::getSparseMissingUnusedIndex(
         index, minSplitSize,
         array(ignoreBitfield) | array(bitfield_) | array(useBitfield_),
-        useBitfield_, blockLength_, blocks_);
+        useBitfield_, usedSummary_, blockLength_, blocks_);
   }
 }
 
@@ -323,6 +405,7 @@ template <typename Array>
 bool getGeomMissingUnusedIndex(size_t& index, int32_t minSplitSize,
                                const Array& bitfield,
                                const unsigned char* useBitfield,
+                               const std::vector<uint64_t>& usedSummary,
                                int32_t blockLength, size_t blocks, double base,
                                size_t offsetIndex)
 {
@@ -350,7 +433,7 @@ bool getGeomMissingUnusedIndex(size_t& index, int32_t minSplitSize,
     }
   }
   return getSparseMissingUnusedIndex(index, minSplitSize, bitfield, useBitfield,
-                                     blockLength, blocks);
+                                     usedSummary, blockLength, blocks);
 }
 } // namespace
 
@@ -365,13 +448,13 @@ bool BitfieldMan::getGeomMissingUnusedIndex(size_t& index, int32_t minSplitSize,
         index, minSplitSize,
         array(ignoreBitfield) | ~array(filterBitfield_) | array(bitfield_) |
             array(useBitfield_),
-        useBitfield_, blockLength_, blocks_, base, offsetIndex);
+        useBitfield_, usedSummary_, blockLength_, blocks_, base, offsetIndex);
   }
   else {
     return aria2::getGeomMissingUnusedIndex(
         index, minSplitSize,
         array(ignoreBitfield) | array(bitfield_) | array(useBitfield_),
-        useBitfield_, blockLength_, blocks_, base, offsetIndex);
+        useBitfield_, usedSummary_, blockLength_, blocks_, base, offsetIndex);
   }
 }
 
@@ -381,6 +464,7 @@ bool getInorderMissingUnusedIndex(size_t& index, size_t startIndex,
                                   size_t lastIndex, int32_t minSplitSize,
                                   const Array& bitfield,
                                   const unsigned char* useBitfield,
+                                  const std::vector<uint64_t>& usedSummary,
                                   int32_t blockLength, size_t blocks)
 {
   // We always return first piece if it is available.
@@ -414,6 +498,9 @@ bool getInorderMissingUnusedIndex(size_t& index, size_t startIndex,
       }
       i = j + 1;
     }
+    else if (i % 64 == 0 && testSummary(usedSummary, i / 64)) {
+      i += 64;
+    }
     else {
       ++i;
     }
@@ -431,13 +518,13 @@ bool BitfieldMan::getInorderMissingUnusedIndex(
         index, 0, blocks_, minSplitSize,
         array(ignoreBitfield) | ~array(filterBitfield_) | array(bitfield_) |
             array(useBitfield_),
-        useBitfield_, blockLength_, blocks_);
+        useBitfield_, usedSummary_, blockLength_, blocks_);
   }
   else {
     return aria2::getInorderMissingUnusedIndex(
         index, 0, blocks_, minSplitSize,
         array(ignoreBitfield) | array(bitfield_) | array(useBitfield_),
-        useBitfield_, blockLength_, blocks_);
+        useBitfield_, usedSummary_, blockLength_, blocks_);
   }
 }
 
@@ -451,13 +538,13 @@ bool BitfieldMan::getInorderMissingUnusedIndex(
         index, startIndex, endIndex, minSplitSize,
         array(ignoreBitfield) | ~array(filterBitfield_) | array(bitfield_) |
             array(useBitfield_),
-        useBitfield_, blockLength_, blocks_);
+        useBitfield_, usedSummary_, blockLength_, blocks_);
   }
   else {
     return aria2::getInorderMissingUnusedIndex(
         index, startIndex, endIndex, minSplitSize,
         array(ignoreBitfield) | array(bitfield_) | array(useBitfield_),
-        useBitfield_, blockLength_, blocks_);
+        useBitfield_, usedSummary_, blockLength_, blocks_);
   }
 }
 
@@ -574,26 +661,44 @@ bool BitfieldMan::setBitInternal(unsigned char* bitfield, size_t index, bool on)
 
 bool BitfieldMan::setUseBit(size_t index)
 {
-  return setBitInternal(useBitfield_, index, true);
+  if (!setBitInternal(useBitfield_, index, true)) {
+    return false;
+  }
+  updateSummary(index);
+  return true;
 }
 
 bool BitfieldMan::unsetUseBit(size_t index)
 {
-  return setBitInternal(useBitfield_, index, false);
+  if (!setBitInternal(useBitfield_, index, false)) {
+    return false;
+  }
+  updateSummary(index);
+  return true;
 }
 
 bool BitfieldMan::setBit(size_t index)
 {
-  bool b = setBitInternal(bitfield_, index, true);
-  updateCache();
-  return b;
+  if (blocks_ <= index) {
+    return false;
+  }
+  if (!isBitSet(index)) {
+    setBitInternal(bitfield_, index, true);
+    updateCache(index, true);
+  }
+  return true;
 }
 
 bool BitfieldMan::unsetBit(size_t index)
 {
-  bool b = setBitInternal(bitfield_, index, false);
-  updateCache();
-  return b;
+  if (blocks_ <= index) {
+    return false;
+  }
+  if (isBitSet(index)) {
+    setBitInternal(bitfield_, index, false);
+    updateCache(index, false);
+  }
+  return true;
 }
 
 bool BitfieldMan::isFilteredAllBitSet() const
@@ -695,6 +800,7 @@ void BitfieldMan::setAllUseBit()
   for (size_t i = 0; i < blocks_; ++i) {
     setBitInternal(useBitfield_, i, true);
   }
+  updateSummary();
 }
 
 bool BitfieldMan::setFilterBit(size_t index)
@@ -705,8 +811,7 @@ bool BitfieldMan::setFilterBit(size_t index)
 void BitfieldMan::ensureFilterBitfield()
 {
   if (!filterBitfield_) {
-    filterBitfield_ = new unsigned char[bitfieldLength_];
-    memset(filterBitfield_, 0, bitfieldLength_);
+    filterBitfield_ = allocBitfield(bitfieldLength_);
   }
 }
 
@@ -849,6 +954,57 @@ void BitfieldMan::updateCache()
   cachedFilteredTotalLength_ = getFilteredTotalLengthNow();
   cachedCompletedLength_ = getCompletedLengthNow();
   cachedFilteredCompletedLength_ = getFilteredCompletedLengthNow();
+  updateSummary();
+}
+
+void BitfieldMan::updateCache(size_t index, bool on)
+{
+  int64_t length = getBlockLength(index);
+  if (!on) {
+    length = -length;
+  }
+  cachedCompletedLength_ += length;
+  if (!filterEnabled_ || isFilterBitSet(index)) {
+    cachedFilteredCompletedLength_ += length;
+    if (on) {
+      --cachedNumMissingBlock_;
+    }
+    else {
+      ++cachedNumMissingBlock_;
+    }
+  }
+  updateSummary(index);
+}
+
+void BitfieldMan::updateSummary(size_t index)
+{
+  size_t w = index / 64;
+  uint64_t mask = getWordMask(w);
+  uint64_t bits = bitfield::loadWord(bitfield_, w) & mask;
+  uint64_t used = (bits | bitfield::loadWord(useBitfield_, w)) & mask;
+  uint64_t flag = static_cast<uint64_t>(1) << (w % 64);
+  if (bits == mask) {
+    setSummary_[w / 64] |= flag;
+  }
+  else {
+    setSummary_[w / 64] &= ~flag;
+  }
+  if (used == mask) {
+    usedSummary_[w / 64] |= flag;
+  }
+  else {
+    usedSummary_[w / 64] &= ~flag;
+  }
+}
+
+void BitfieldMan::updateSummary()
+{
+  const size_t nwords = countWord();
+  setSummary_.assign((nwords + 63) / 64, 0);
+  usedSummary_.assign((nwords + 63) / 64, 0);
+  for (size_t w = 0; w < nwords; ++w) {
+    updateSummary(w * 64);
+  }
 }
 
 bool BitfieldMan::isBitRangeSet(size_t startIndex, size_t endIndex) const
@@ -52,6 +52,14 @@ private:
   unsigned char* useBitfield_;
   unsigned char* filterBitfield_;
 
+  // The i-th bit (counted from LSB) of setSummary_ is set if all bits
+  // in the i-th 64 bits word of bitfield_ are set.  usedSummary_ is
+  // the same for bitfield_ | useBitfield_.  They are updated on every
+  // bit change, so that the missing piece queries can skip the
+  // completed part of the bitfield 64 blocks at a time.
+  std::vector<uint64_t> setSummary_;
+  std::vector<uint64_t> usedSummary_;
+
   size_t bitfieldLength_;
   size_t cachedNumMissingBlock_;
   size_t cachedNumFilteredBlock_;
@@ -69,6 +77,28 @@ private:
 
   int64_t getCompletedLength(bool useFilter) const;
 
+  // Returns the number of 64 bits words in the bitfield.
+  size_t countWord() const { return (blocks_ + 63) / 64; }
+
+  // Returns the mask of valid bits in the |w|-th word.
+  uint64_t getWordMask(size_t w) const;
+
+  // Returns the bits in the |w|-th word which are missing (and
+  // unused, respectively) and not filtered.
+  uint64_t getMissingWord(size_t w) const;
+  uint64_t getMissingUnusedWord(size_t w) const;
+
+  // Updates the summary bits of the word which the index-th bit
+  // belongs to.
+  void updateSummary(size_t index);
+
+  // Rebuilds the summary from scratch.
+  void updateSummary();
+
+  // Updates the cached values and the summary after the index-th bit
+  // of bitfield_ was flipped to |on|.
+  void updateCache(size_t index, bool on);
+
   // If filterBitfield_ is 0, allocate bitfieldLength_ bytes to it and
   // set 0 to all bytes.
   void ensureFilterBitfield();
@@ -36,10 +36,12 @@
 #define D_BT_CANCEL_MESSAGE_H
 
 #include "RangeBtMessage.h"
+#include "PoolAllocated.h"
 
 namespace aria2 {
 
-class BtCancelMessage : public RangeBtMessage {
+class BtCancelMessage : public RangeBtMessage,
+                        public PoolAllocated<BtCancelMessage> {
 public:
   BtCancelMessage(size_t index = 0, int32_t begin = 0, int32_t length = 0);
 
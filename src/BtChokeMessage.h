@@ -36,10 +36,12 @@
 #define D_BT_CHOKE_MESSAGE_H
 
 #include "ZeroBtMessage.h"
+#include "PoolAllocated.h"
 
 namespace aria2 {
 
-class BtChokeMessage : public ZeroBtMessage {
+class BtChokeMessage : public ZeroBtMessage,
+                       public PoolAllocated<BtChokeMessage> {
 public:
   BtChokeMessage();
 
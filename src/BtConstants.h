@@ -48,11 +48,18 @@ constexpr size_t PEER_ID_LENGTH = 20;
 
 constexpr size_t MAX_BLOCK_LENGTH = 64_k;
 
+// The initial number of outstanding requests to a peer, and the
+// minimum unless the peer tells a smaller request queue size (reqq).
 constexpr size_t DEFAULT_MAX_OUTSTANDING_REQUEST = 6;
 
-// Upper Bound of the number of outstanding request
+// Upper Bound of the number of outstanding request to a peer which
+// does not tell its request queue size (reqq) in extended handshake.
 constexpr size_t UB_MAX_OUTSTANDING_REQUEST = 256;
 
+// Upper Bound of the number of outstanding request to a peer which
+// tells its request queue size.
+constexpr size_t UB_MAX_REQQ_OUTSTANDING_REQUEST = 2048;
+
 constexpr size_t METADATA_PIECE_SIZE = 16_k;
 
 constexpr const char LPD_MULTICAST_ADDR[] = "239.192.152.143";
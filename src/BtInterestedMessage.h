@@ -36,13 +36,15 @@
 #define D_BT_INTERESTED_MESSAGE_H
 
 #include "ZeroBtMessage.h"
+#include "PoolAllocated.h"
 
 namespace aria2 {
 
 class PeerStorage;
 class BtInterestedMessage;
 
-class BtInterestedMessage : public ZeroBtMessage {
+class BtInterestedMessage : public ZeroBtMessage,
+                            public PoolAllocated<BtInterestedMessage> {
 private:
   PeerStorage* peerStorage_;
 
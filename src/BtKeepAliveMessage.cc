@@ -48,4 +48,10 @@ std::vector<unsigned char> BtKeepAliveMessage::createMessage()
   return std::vector<unsigned char>(MESSAGE_LENGTH);
 }
 
+size_t BtKeepAliveMessage::writeMessage(unsigned char* buf)
+{
+  memset(buf, 0, MESSAGE_LENGTH);
+  return MESSAGE_LENGTH;
+}
+
 } // namespace aria2
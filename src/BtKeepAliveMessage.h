@@ -36,10 +36,12 @@
 #define D_BT_KEEP_ALIVE_MESSAGE_H
 
 #include "SimpleBtMessage.h"
+#include "PoolAllocated.h"
 
 namespace aria2 {
 
-class BtKeepAliveMessage : public SimpleBtMessage {
+class BtKeepAliveMessage : public SimpleBtMessage,
+                           public PoolAllocated<BtKeepAliveMessage> {
 private:
   static const size_t MESSAGE_LENGTH = 4;
 
@@ -54,6 +56,8 @@ public:
 
   virtual std::vector<unsigned char> createMessage() CXX11_OVERRIDE;
 
+  virtual size_t writeMessage(unsigned char* buf) CXX11_OVERRIDE;
+
   virtual std::string toString() const CXX11_OVERRIDE { return NAME; }
 };
 
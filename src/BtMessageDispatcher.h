@@ -70,6 +70,10 @@ public:
 
   virtual void checkRequestSlotAndDoNecessaryThing() = 0;
 
+  // Sends cancel for the outstanding requests whose blocks have been
+  // received from other peers in end game mode.
+  virtual void cancelAcquiredRequests() = 0;
+
   virtual bool isSendingInProgress() = 0;
 
   virtual size_t countMessageInQueue() = 0;
@@ -36,13 +36,15 @@
 #define D_BT_NOT_INTERESTED_MESSAGE_H
 
 #include "ZeroBtMessage.h"
+#include "PoolAllocated.h"
 
 namespace aria2 {
 
 class PeerStorage;
 class BtNotInterestedMessage;
 
-class BtNotInterestedMessage : public ZeroBtMessage {
+class BtNotInterestedMessage : public ZeroBtMessage,
+                               public PoolAllocated<BtNotInterestedMessage> {
 private:
   PeerStorage* peerStorage_;
 
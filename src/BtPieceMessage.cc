@@ -61,6 +61,7 @@
 #include "WrDiskCacheEntry.h"
 #include "DownloadFailureException.h"
 #include "BtRejectMessage.h"
+#include "EndGameManager.h"
 
 namespace aria2 {
 
@@ -103,6 +104,7 @@ void BtPieceMessage::doReceivedAction()
   downloadContext_->updateDownload(blockLength_);
   if (slot) {
     getPeer()->snubbing(false);
+    getPeer()->updateRequestLatency(slot->getLatency());
     std::shared_ptr<Piece> piece = getPieceStorage()->getPiece(index_);
     int64_t offset =
         static_cast<int64_t>(index_) * downloadContext_->getPieceLength() +
@@ -113,21 +115,30 @@ void BtPieceMessage::doReceivedAction()
                      static_cast<unsigned long>(slot->getBlockIndex())));
     if (piece->hasBlock(slot->getBlockIndex())) {
       A2_LOG_DEBUG("Already have this block.");
+      addWastedLength();
       return;
     }
     if (piece->getWrDiskCacheEntry()) {
       // Write Disk Cache enabled. Unfortunately, it incurs extra data
       // copy.
-      auto dataCopy = new unsigned char[blockLength_];
+      auto wrDiskCache = getPieceStorage()->getWrDiskCache();
+      size_t capacity;
+      auto dataCopy = wrDiskCache->allocateBuffer(blockLength_, &capacity);
       memcpy(dataCopy, data_ + 9, blockLength_);
-      piece->updateWrCache(getPieceStorage()->getWrDiskCache(), dataCopy, 0,
-                           blockLength_, blockLength_, offset);
+      piece->updateWrCache(wrDiskCache, dataCopy, 0, blockLength_, capacity,
+                           offset);
     }
     else {
       getPieceStorage()->getDiskAdaptor()->writeData(data_ + 9, blockLength_,
                                                      offset);
     }
     piece->completeBlock(slot->getBlockIndex());
+    if (getPieceStorage()->isEndGame()) {
+      auto egm = getPieceStorage()->getEndGameManager();
+      if (egm) {
+        egm->onBlockReceived(getCuid(), index_, slot->getBlockIndex());
+      }
+    }
     A2_LOG_DEBUG(fmt(
         MSG_PIECE_BITFIELD, getCuid(),
         util::toHex(piece->getBitfield(), piece->getBitfieldLength()).c_str()));
@@ -148,6 +159,15 @@ void BtPieceMessage::doReceivedAction()
     A2_LOG_DEBUG(fmt("CUID#%" PRId64
                      " - RequestSlot not found, index=%lu, begin=%d",
                      getCuid(), static_cast<unsigned long>(index_), begin_));
+    addWastedLength();
+  }
+}
+
+void BtPieceMessage::addWastedLength()
+{
+  auto egm = getPieceStorage()->getEndGameManager();
+  if (egm) {
+    egm->addWastedLength(blockLength_);
   }
 }
 
@@ -215,6 +235,22 @@ void BtPieceMessage::send()
 void BtPieceMessage::pushPieceData(int64_t offset, int32_t length) const
 {
   assert(length <= static_cast<int32_t>(MAX_BLOCK_LENGTH));
+  auto peerConnection = getPeerConnection();
+  if (!peerConnection->isEncryptionEnabled()) {
+    // Without encryption, the block is sent directly from the file
+    // when the socket becomes writable, so that it is not copied into
+    // the send buffer.
+    unsigned char header[MESSAGE_HEADER_LENGTH];
+    createMessageHeader(header);
+    const auto& peer = getPeer();
+    peerConnection->pushBytes(header, sizeof(header));
+    peerConnection->pushFile(
+        getPieceStorage()->getDiskAdaptor(), offset, length,
+        make_unique<PieceSendUpdate>(downloadContext_, peer, 0));
+    peer->updateUploadSpeed(length);
+    downloadContext_->updateUploadSpeed(length);
+    return;
+  }
   auto buf = std::vector<unsigned char>(length + MESSAGE_HEADER_LENGTH);
   createMessageHeader(buf.data());
   ssize_t r;
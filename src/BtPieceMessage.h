@@ -36,6 +36,7 @@
 #define D_BT_PIECE_MESSAGE_H
 
 #include "AbstractBtMessage.h"
+#include "PoolAllocated.h"
 
 namespace aria2 {
 
@@ -43,7 +44,8 @@ class Piece;
 class DownloadContext;
 class PeerStorage;
 
-class BtPieceMessage : public AbstractBtMessage {
+class BtPieceMessage : public AbstractBtMessage,
+                       public PoolAllocated<BtPieceMessage> {
 private:
   size_t index_;
   int32_t begin_;
@@ -60,6 +62,9 @@ private:
 
   void pushPieceData(int64_t offset, int32_t length) const;
 
+  // Accounts the block data of this message as thrown away.
+  void addWastedLength();
+
 public:
   BtPieceMessage(size_t index = 0, int32_t begin = 0, int32_t blockLength = 0);
 
@@ -36,12 +36,14 @@
 #define D_BT_PIECE_MESSAGE_VALIDATOR_H
 
 #include "BtMessageValidator.h"
+#include "PoolAllocated.h"
 
 namespace aria2 {
 
 class BtPieceMessage;
 
-class BtPieceMessageValidator : public BtMessageValidator {
+class BtPieceMessageValidator : public BtMessageValidator,
+                                public PoolAllocated<BtPieceMessageValidator> {
 private:
   const BtPieceMessage* message_;
   size_t numPiece_;
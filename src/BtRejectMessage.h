@@ -36,10 +36,12 @@
 #define D_BT_REJECT_MESSAGE_H
 
 #include "RangeBtMessage.h"
+#include "PoolAllocated.h"
 
 namespace aria2 {
 
-class BtRejectMessage : public RangeBtMessage {
+class BtRejectMessage : public RangeBtMessage,
+                        public PoolAllocated<BtRejectMessage> {
 public:
   BtRejectMessage(size_t index = 0, int32_t begin = 0, int32_t length = 0);
 
@@ -36,10 +36,12 @@
 #define D_BT_REQUEST_MESSAGE_H
 
 #include "RangeBtMessage.h"
+#include "PoolAllocated.h"
 
 namespace aria2 {
 
-class BtRequestMessage : public RangeBtMessage {
+class BtRequestMessage : public RangeBtMessage,
+                         public PoolAllocated<BtRequestMessage> {
 private:
   size_t blockIndex_;
 
@@ -36,10 +36,12 @@
 #define D_BT_UNCHOKE_MESSAGE_H
 
 #include "ZeroBtMessage.h"
+#include "PoolAllocated.h"
 
 namespace aria2 {
 
-class BtUnchokeMessage : public ZeroBtMessage {
+class BtUnchokeMessage : public ZeroBtMessage,
+                         public PoolAllocated<BtUnchokeMessage> {
 private:
   static const size_t MESSAGE_LENGTH = 5;
 
@@ -58,7 +58,7 @@ CheckIntegrityCommand::CheckIntegrityCommand(cuid_t cuid,
 
 CheckIntegrityCommand::~CheckIntegrityCommand()
 {
-  getDownloadEngine()->getCheckIntegrityMan()->dropPickedEntry();
+  getDownloadEngine()->getCheckIntegrityMan()->dropPickedEntry(entry_);
 }
 
 bool CheckIntegrityCommand::executeInternal()
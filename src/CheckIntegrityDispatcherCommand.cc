@@ -57,6 +57,9 @@ CheckIntegrityDispatcherCommand::createCommand(CheckIntegrityEntry* entry)
   A2_LOG_INFO(fmt("CUID#%" PRId64 " - Dispatching CheckIntegrityCommand "
                   "CUID#%" PRId64 ".",
                   getCuid(), newCUID));
+#ifdef ENABLE_THREADS
+  entry->setThreadPool(getDownloadEngine()->getThreadPool());
+#endif // ENABLE_THREADS
   return make_unique<CheckIntegrityCommand>(newCUID, entry->getRequestGroup(),
                                             getDownloadEngine(), entry);
 }
@@ -76,6 +76,15 @@ int64_t CheckIntegrityEntry::getCurrentLength()
 
 bool CheckIntegrityEntry::finished() { return validator_->finished(); }
 
+#ifdef ENABLE_THREADS
+void CheckIntegrityEntry::setThreadPool(ThreadPool* threadPool)
+{
+  if (validator_) {
+    validator_->setThreadPool(threadPool);
+  }
+}
+#endif // ENABLE_THREADS
+
 void CheckIntegrityEntry::cutTrailingGarbage()
 {
   getRequestGroup()->getPieceStorage()->getDiskAdaptor()->cutTrailingGarbage();
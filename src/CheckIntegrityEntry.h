@@ -47,6 +47,9 @@ namespace aria2 {
 class IteratableValidator;
 class DownloadEngine;
 class FileAllocationEntry;
+#ifdef ENABLE_THREADS
+class ThreadPool;
+#endif // ENABLE_THREADS
 
 class CheckIntegrityEntry : public RequestGroupEntry,
                             public ProgressAwareEntry {
@@ -79,6 +82,12 @@ public:
 
   virtual void initValidator() = 0;
 
+#ifdef ENABLE_THREADS
+  // Lets the validator hash chunks using threadPool.  Call this after
+  // initValidator().
+  void setThreadPool(ThreadPool* threadPool);
+#endif // ENABLE_THREADS
+
   virtual void
   onDownloadFinished(std::vector<std::unique_ptr<Command>>& commands,
                      DownloadEngine* e) = 0;
@@ -43,7 +43,8 @@ Command::Command(cuid_t cuid)
       readEvent_(false),
       writeEvent_(false),
       errorEvent_(false),
-      hupEvent_(false)
+      hupEvent_(false),
+      timerNode_(this)
 {
 }
 
@@ -37,9 +37,10 @@
 
 #include "common.h"
 
-namespace aria2 {
+#include "TimerWheel.h"
+#include "cuid.h"
 
-typedef int64_t cuid_t;
+namespace aria2 {
 
 class Command {
 public:
@@ -61,6 +62,12 @@ private:
   bool errorEvent_;
   bool hupEvent_;
 
+  // Linked in the timer wheel of DownloadEngine while this command
+  // sleeps.
+  TimerWheel::Node timerNode_;
+
+  friend class TimerWheel;
+
 protected:
   bool readEventEnabled() const { return readEvent_; }
 
@@ -94,6 +101,13 @@ public:
 
   void transitStatus();
 
+  // Returns true if this command sleeps.  See
+  // DownloadEngine::sleepCommand().
+  bool isSleeping() const { return timerNode_.linked(); }
+
+  // Cancels the sleep.
+  void wakeUp() { timerNode_.unlink(); }
+
   void readEventReceived();
 
   void writeEventReceived();
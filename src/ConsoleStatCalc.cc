@@ -136,10 +136,10 @@ namespace {
 void printProgressCompact(ColorizedStream& o, const DownloadEngine* e,
                           const SizeFormatter& sizeFormatter)
 {
-  if (!e->getRequestGroupMan()->downloadFinished()) {
-    NetStat& netstat = e->getRequestGroupMan()->getNetStat();
-    int dl = netstat.calculateDownloadSpeed();
-    int ul = netstat.calculateUploadSpeed();
+  auto& rgman = e->getRequestGroupMan();
+  if (!rgman->downloadFinished()) {
+    int dl = rgman->calculateOverallDownloadSpeed();
+    int ul = rgman->calculateOverallUploadSpeed();
     o << colors::magenta << "[" << colors::clear << "DL:" << colors::green
       << sizeFormatter(dl) << "B" << colors::clear;
     if (ul) {
@@ -148,7 +148,9 @@ void printProgressCompact(ColorizedStream& o, const DownloadEngine* e,
     o << colors::magenta << "]" << colors::clear;
   }
 
-  const RequestGroupList& groups = e->getRequestGroupMan()->getRequestGroups();
+  const RequestGroupList& groups = rgman->getRequestGroups();
+  // The downloads run by the other engine shards are only counted.
+  size_t numGroup = groups.size() + rgman->countShardedGroup();
   size_t cnt = 0;
   const size_t MAX_ITEM = 5;
   for (auto i = groups.begin(), eoi = groups.end(); i != eoi && cnt < MAX_ITEM;
@@ -160,8 +162,8 @@ void printProgressCompact(ColorizedStream& o, const DownloadEngine* e,
     printSizeProgress(o, rg, stat, sizeFormatter);
     o << colors::magenta << "]" << colors::clear;
   }
-  if (cnt < groups.size()) {
-    o << "(+" << groups.size() - cnt << ")";
+  if (cnt < numGroup) {
+    o << "(+" << numGroup - cnt << ")";
   }
 }
 } // namespace
@@ -334,20 +336,22 @@ void ConsoleStatCalc::calculateStat(const DownloadEngine* e)
   if (!readoutVisibility_) {
     return;
   }
-  size_t numGroup = e->getRequestGroupMan()->countRequestGroup();
+  size_t numGroup = e->getRequestGroupMan()->countRequestGroup() +
+                    e->getRequestGroupMan()->countShardedGroup();
   const bool color = global::cout()->supportsColor() && isTTY_ && colorOutput_;
-  if (numGroup == 1) {
+  if (numGroup == 1 && e->getRequestGroupMan()->countRequestGroup() == 1) {
     const std::shared_ptr<RequestGroup>& rg =
         *e->getRequestGroupMan()->getRequestGroups().begin();
     printProgress(o, rg, e, sizeFormatter);
   }
-  else if (numGroup > 1) {
-    // For more than 2 RequestGroups, use compact readout form
+  else if (numGroup > 0) {
+    // For more than 2 RequestGroups, or the ones run by the other
+    // engine shards, use compact readout form
     printProgressCompact(o, e, sizeFormatter);
   }
 
   {
-    auto& entry = e->getFileAllocationMan()->getPickedEntry();
+    auto entry = e->getFileAllocationMan()->getPickedEntry();
     if (entry) {
       o << " [FileAlloc:#"
         << GroupId::toAbbrevHex(entry->getRequestGroup()->getGID()) << " "
@@ -366,7 +370,8 @@ void ConsoleStatCalc::calculateStat(const DownloadEngine* e)
     }
   }
   {
-    auto& entry = e->getCheckIntegrityMan()->getPickedEntry();
+    auto& ciman = e->getCheckIntegrityMan();
+    auto entry = ciman->getPickedEntry();
     if (entry) {
       o << " [Checksum:#"
         << GroupId::toAbbrevHex(entry->getRequestGroup()->getGID()) << " "
@@ -379,8 +384,10 @@ void ConsoleStatCalc::calculateStat(const DownloadEngine* e)
         o << "--";
       }
       o << "%)]";
-      if (e->getCheckIntegrityMan()->hasNext()) {
-        o << "(+" << e->getCheckIntegrityMan()->countEntryInQueue() << ")";
+      // Other entries being verified in parallel are counted as well.
+      auto rest = ciman->countPickedEntry() - 1 + ciman->countEntryInQueue();
+      if (rest > 0) {
+        o << "(+" << rest << ")";
       }
     }
   }
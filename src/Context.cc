@@ -170,6 +170,9 @@ Context::Context(bool standalone, int argc, char** argv, const KeyVals& options)
 #endif // ENABLE_BITTORRENT
   LogFactory::setLogFile(op->get(PREF_LOG));
   LogFactory::setLogLevel(op->get(PREF_LOG_LEVEL));
+  LogFactory::setSubsystemLogLevels(op->get(PREF_SUBSYSTEM_LOG_LEVEL));
+  LogFactory::setLogFormat(op->get(PREF_LOG_FORMAT));
+  LogFactory::setAsync(op->getAsBool(PREF_ASYNC_LOG));
   LogFactory::setConsoleLogLevel(op->get(PREF_CONSOLE_LOG_LEVEL));
   LogFactory::setColorOutput(op->getAsBool(PREF_ENABLE_COLOR));
   if (op->getAsBool(PREF_QUIET)) {
@@ -50,6 +50,9 @@ public:
 
   virtual ssize_t sendMessage(const unsigned char* data, size_t len,
                               const std::string& host, uint16_t port) = 0;
+
+  // Sends the messages which sendMessage() buffered, if any.
+  virtual void flushMessages() = 0;
 };
 
 } // namespace aria2
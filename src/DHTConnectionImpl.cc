@@ -36,6 +36,7 @@
 
 #include <utility>
 #include <algorithm>
+#include <cstring>
 
 #include "LogFactory.h"
 #include "Logger.h"
@@ -43,10 +44,17 @@
 #include "util.h"
 #include "SocketCore.h"
 #include "SimpleRandomizer.h"
+#include "DatagramRing.h"
 #include "fmt.h"
+#include "a2functional.h"
 
 namespace aria2 {
 
+namespace {
+// The maximum size of UDP datagram.
+constexpr size_t MAX_DATAGRAM_LENGTH = 64_k;
+} // namespace
+
 DHTConnectionImpl::DHTConnectionImpl(int family)
     : socket_(std::make_shared<SocketCore>(SOCK_DGRAM)), family_(family)
 {
@@ -88,9 +96,35 @@ bool DHTConnectionImpl::bind(uint16_t& port, const std::string& addr)
   return false;
 }
 
+void DHTConnectionImpl::setBatchSize(size_t batchSize)
+{
+  if (batchSize > 1) {
+    recvRing_ = make_unique<DatagramRing>(batchSize, MAX_DATAGRAM_LENGTH);
+    sendRing_ = make_unique<DatagramRing>(batchSize, MAX_DATAGRAM_LENGTH);
+  }
+  else {
+    recvRing_.reset();
+    sendRing_.reset();
+  }
+}
+
 ssize_t DHTConnectionImpl::receiveMessage(unsigned char* data, size_t len,
                                           std::string& host, uint16_t& port)
 {
+  if (recvRing_) {
+    if (recvRing_->empty() && socket_->readDataFrom(*recvRing_) == 0) {
+      return 0;
+    }
+    auto& datagram = recvRing_->front();
+    auto remoteEndpoint = util::getNumericNameInfo(&datagram.addr.su.sa,
+                                                   datagram.addr.suLength);
+    size_t length = std::min(len, datagram.length);
+    memcpy(data, datagram.data, length);
+    recvRing_->popFront();
+    host = remoteEndpoint.addr;
+    port = remoteEndpoint.port;
+    return length;
+  }
   Endpoint remoteEndpoint;
   ssize_t length = socket_->readDataFrom(data, len, remoteEndpoint);
   if (length == 0) {
@@ -102,10 +136,68 @@ ssize_t DHTConnectionImpl::receiveMessage(unsigned char* data, size_t len,
   return length;
 }
 
+namespace {
+// Stores the address of numeric host and port to addr.  Returns true
+// if it succeeds.
+bool getNumericSockAddr(SockAddr& addr, const std::string& host,
+                        uint16_t port, int family)
+{
+  struct addrinfo* res;
+  if (callGetaddrinfo(&res, host.c_str(), util::uitos(port).c_str(), family,
+                      SOCK_DGRAM, AI_NUMERICHOST, 0) != 0) {
+    return false;
+  }
+  memcpy(&addr.su, res->ai_addr, res->ai_addrlen);
+  addr.suLength = res->ai_addrlen;
+  freeaddrinfo(res);
+  return true;
+}
+} // namespace
+
 ssize_t DHTConnectionImpl::sendMessage(const unsigned char* data, size_t len,
                                        const std::string& host, uint16_t port)
 {
+  if (sendRing_) {
+    if (sendRing_->full()) {
+      flushMessages();
+      if (sendRing_->full()) {
+        return 0;
+      }
+    }
+    auto& datagram = sendRing_->getFreeSlot(0);
+    if (len <= sendRing_->getMaxDatagramLength() &&
+        getNumericSockAddr(datagram.addr, host, port, family_)) {
+      memcpy(datagram.data, data, len);
+      datagram.length = len;
+      sendRing_->pushBack();
+      return len;
+    }
+    // Keep the order of the messages.
+    flushMessages();
+    if (!sendRing_->empty()) {
+      return 0;
+    }
+  }
   return socket_->writeData(data, len, host, port);
 }
 
+void DHTConnectionImpl::flushMessages()
+{
+  if (!sendRing_) {
+    return;
+  }
+  while (!sendRing_->empty()) {
+    try {
+      if (socket_->writeData(*sendRing_) == 0) {
+        // Would block.  Try again next time.
+        break;
+      }
+    }
+    catch (RecoverableException& e) {
+      A2_LOG_INFO_EX("Failed to send UDP datagram.", e);
+      sendRing_->popFront();
+    }
+  }
+}
+
 } // namespace aria2
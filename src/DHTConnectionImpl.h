@@ -44,6 +44,7 @@
 namespace aria2 {
 
 class SocketCore;
+class DatagramRing;
 
 class DHTConnectionImpl : public DHTConnection {
 private:
@@ -51,6 +52,11 @@ private:
 
   int family_;
 
+  // Datagrams received or to be sent in batch.  They are null if
+  // batching is disabled.
+  std::unique_ptr<DatagramRing> recvRing_;
+  std::unique_ptr<DatagramRing> sendRing_;
+
 public:
   DHTConnectionImpl(int family);
 
@@ -81,10 +87,19 @@ public:
                                  std::string& host,
                                  uint16_t& port) CXX11_OVERRIDE;
 
+  // If batching is enabled and host is a numeric address, the
+  // message is buffered and len is returned.  It is sent by
+  // flushMessages() or when the buffer gets full.
   virtual ssize_t sendMessage(const unsigned char* data, size_t len,
                               const std::string& host,
                               uint16_t port) CXX11_OVERRIDE;
 
+  virtual void flushMessages() CXX11_OVERRIDE;
+
+  // Receives and sends at most batchSize datagrams per system call.
+  // If batchSize is 1, batching is disabled.
+  void setBatchSize(size_t batchSize);
+
   const std::shared_ptr<SocketCore>& getSocket() const { return socket_; }
 };
 
@@ -164,6 +164,8 @@ bool DHTInteractionCommand::execute()
       udpTrackerClient_->requestFail(UDPT_ERR_NETWORK);
     }
   }
+  // no throw
+  connection_->flushMessages();
   e_->addRoutineCommand(std::unique_ptr<Command>(this));
   return false;
 }
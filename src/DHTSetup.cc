@@ -114,6 +114,7 @@ DHTSetup::setup(DownloadEngine* e, int family)
 
     uint16_t port;
     auto connection = make_unique<DHTConnectionImpl>(family);
+    connection->setBatchSize(e->getOption()->getAsInt(PREF_UDP_BATCH_SIZE));
     {
       port = e->getBtRegistry()->getUdpPort();
       const std::string& addr = e->getOption()->get(
@@ -0,0 +1,78 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "DatagramRing.h"
+
+#include <cassert>
+
+namespace aria2 {
+
+DatagramRing::DatagramRing(size_t capacity, size_t maxDatagramLength)
+    // Not initialized, so that the pages of the buffer are not
+    // touched until datagrams are actually stored.
+    : buf_(new unsigned char[capacity * maxDatagramLength]),
+      slots_(capacity),
+      maxDatagramLength_(maxDatagramLength),
+      head_(0),
+      size_(0)
+#if defined(HAVE_RECVMMSG) || defined(HAVE_SENDMMSG)
+      ,
+      msgs_(capacity),
+      iovs_(capacity)
+#endif // HAVE_RECVMMSG || HAVE_SENDMMSG
+{
+  assert(capacity > 0);
+  for (size_t i = 0; i < capacity; ++i) {
+    slots_[i].data = buf_.get() + i * maxDatagramLength;
+    slots_[i].length = 0;
+  }
+}
+
+void DatagramRing::popFront(size_t n)
+{
+  assert(n <= size_);
+  head_ = (head_ + n) % slots_.size();
+  size_ -= n;
+  if (size_ == 0) {
+    head_ = 0;
+  }
+}
+
+void DatagramRing::pushBack(size_t n)
+{
+  assert(size_ + n <= slots_.size());
+  size_ += n;
+}
+
+} // namespace aria2
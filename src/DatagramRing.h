@@ -0,0 +1,106 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_DATAGRAM_RING_H
+#define D_DATAGRAM_RING_H
+
+#include "common.h"
+
+#include <vector>
+#include <memory>
+
+#include "a2netcompat.h"
+
+namespace aria2 {
+
+// Fixed size FIFO of datagrams for batched UDP I/O in SocketCore.
+// All slots and their buffers are allocated in the constructor, so
+// that no memory is allocated per datagram.
+class DatagramRing {
+public:
+  struct Datagram {
+    unsigned char* data;
+    size_t length;
+    SockAddr addr;
+  };
+
+  // Each slot can hold a datagram of at most maxDatagramLength
+  // bytes.
+  DatagramRing(size_t capacity, size_t maxDatagramLength);
+
+  size_t capacity() const { return slots_.size(); }
+
+  size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+  bool full() const { return size_ == slots_.size(); }
+
+  size_t getMaxDatagramLength() const { return maxDatagramLength_; }
+
+  // Returns the i-th oldest datagram.  i must be less than size().
+  Datagram& get(size_t i) { return slots_[(head_ + i) % slots_.size()]; }
+
+  Datagram& front() { return get(0); }
+
+  // Removes the n oldest datagrams.
+  void popFront(size_t n = 1);
+
+  // Returns the i-th free slot.  i must be less than capacity() -
+  // size().  The caller fills it and then calls pushBack() to
+  // append it.
+  Datagram& getFreeSlot(size_t i) { return get(size_ + i); }
+
+  // Appends the n first free slots.
+  void pushBack(size_t n = 1);
+
+private:
+  std::unique_ptr<unsigned char[]> buf_;
+  std::vector<Datagram> slots_;
+  size_t maxDatagramLength_;
+  size_t head_;
+  size_t size_;
+
+#if defined(HAVE_RECVMMSG) || defined(HAVE_SENDMMSG)
+  friend class SocketCore;
+
+  // Scratch space for recvmmsg(2) and sendmmsg(2).
+  std::vector<struct mmsghdr> msgs_;
+  std::vector<struct iovec> iovs_;
+#endif // HAVE_RECVMMSG || HAVE_SENDMMSG
+};
+
+} // namespace aria2
+
+#endif // D_DATAGRAM_RING_H
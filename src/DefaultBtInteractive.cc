@@ -81,6 +81,7 @@
 #include "UTMetadataRequestFactory.h"
 #include "UTMetadataRequestTracker.h"
 #include "wallclock.h"
+#include "EndGameManager.h"
 
 namespace aria2 {
 
@@ -300,7 +301,6 @@ void DefaultBtInteractive::sendKeepAlive()
 
 size_t DefaultBtInteractive::receiveMessages()
 {
-  size_t countOldOutstandingRequest = dispatcher_->countOutstandingRequest();
   size_t msgcount = 0;
   while (1) {
     if (requestGroupMan_->doesOverallDownloadSpeedExceed() ||
@@ -338,13 +338,10 @@ size_t DefaultBtInteractive::receiveMessages()
     }
   }
 
-  if (!pieceStorage_->isEndGame() &&
-      countOldOutstandingRequest > dispatcher_->countOutstandingRequest() &&
-      (countOldOutstandingRequest - dispatcher_->countOutstandingRequest()) *
-              4 >=
-          maxOutstandingRequest_) {
-    maxOutstandingRequest_ = std::min((size_t)UB_MAX_OUTSTANDING_REQUEST,
-                                      maxOutstandingRequest_ * 2);
+  if (msgcount && !pieceStorage_->isEndGame()) {
+    // Keep the pipeline as deep as the bandwidth-delay product of the
+    // path to the peer.
+    maxOutstandingRequest_ = peer_->getMaxOutstandingRequest();
   }
   return msgcount;
 }
@@ -573,6 +570,14 @@ void DefaultBtInteractive::doInteractionProcessing()
     decideInterest();
     checkHave();
     sendKeepAlive();
+    if (pieceStorage_->isEndGame()) {
+      auto egm = pieceStorage_->getEndGameManager();
+      if (egm && egm->popCancelRequired(cuid_)) {
+        // Other peers sent us the blocks we requested.  Cancel them
+        // all at once, so that the cancels go out together.
+        dispatcher_->cancelAcquiredRequests();
+      }
+    }
     btRequestFactory_->removeCompletedPiece();
     if (!pieceStorage_->downloadFinished()) {
       addRequests();
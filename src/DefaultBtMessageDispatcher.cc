@@ -58,6 +58,7 @@
 #include "fmt.h"
 #include "PeerConnection.h"
 #include "BtCancelMessage.h"
+#include "EndGameManager.h"
 
 namespace aria2 {
 
@@ -67,13 +68,43 @@ DefaultBtMessageDispatcher::DefaultBtMessageDispatcher()
       peerConnection_{nullptr},
       messageFactory_{nullptr},
       requestGroupMan_{nullptr},
-      requestTimeout_{0}
+      requestTimeout_{0},
+      pieceStorage_{nullptr},
+      endGameTracked_{false}
 {
 }
 
 DefaultBtMessageDispatcher::~DefaultBtMessageDispatcher()
 {
   A2_LOG_DEBUG("DefaultBtMessageDispatcher::deleted");
+  if (endGameTracked_) {
+    pieceStorage_->getEndGameManager()->removeConnection(cuid_);
+  }
+}
+
+EndGameManager* DefaultBtMessageDispatcher::getEndGameManager()
+{
+  if (!pieceStorage_ || !pieceStorage_->isEndGame()) {
+    return nullptr;
+  }
+  auto egm = pieceStorage_->getEndGameManager();
+  if (egm && !endGameTracked_) {
+    endGameTracked_ = true;
+    // The requests sent before entering end game mode are tracked
+    // from now on.
+    for (auto& slot : requestSlots_) {
+      egm->addRequest(cuid_, slot->getIndex(), slot->getBlockIndex());
+    }
+  }
+  return egm;
+}
+
+void DefaultBtMessageDispatcher::untrackRequest(const RequestSlot& slot)
+{
+  if (endGameTracked_) {
+    pieceStorage_->getEndGameManager()->removeRequest(
+        cuid_, slot.getIndex(), slot.getBlockIndex());
+  }
 }
 
 void DefaultBtMessageDispatcher::addMessageToQueue(
@@ -164,6 +195,7 @@ void DefaultBtMessageDispatcher::doAbortOutstandingRequestAction(
   for (auto& slot : requestSlots_) {
     if (slot->getIndex() == piece->getIndex()) {
       abortOutstandingRequest(slot.get(), piece, cuid_);
+      untrackRequest(*slot);
     }
   }
   requestSlots_.erase(
@@ -191,6 +223,7 @@ void DefaultBtMessageDispatcher::doChokedAction()
                        slot->getBegin(),
                        static_cast<unsigned long>(slot->getBlockIndex())));
       slot->getPiece()->cancelBlock(slot->getBlockIndex());
+      untrackRequest(*slot);
     }
   }
   requestSlots_.erase(
@@ -214,6 +247,27 @@ void DefaultBtMessageDispatcher::doChokingAction()
 
 void DefaultBtMessageDispatcher::checkRequestSlotAndDoNecessaryThing()
 {
+  // A request older than the timeout adapted to the latency of the
+  // peer is likely stalled.  In end game mode, it stops counting
+  // against the redundancy limit of the block, so that the block can
+  // be requested from other peers.  The request is kept, and the
+  // block is still accepted if it arrives late.
+  auto egm = getEndGameManager();
+  if (egm) {
+    auto timeout = peer_->getRequestTimeout(requestTimeout_);
+    for (auto& slot : requestSlots_) {
+      if (!slot->isReleased() && slot->isTimeout(timeout)) {
+        A2_LOG_DEBUG(fmt(MSG_RELEASING_REQUEST_SLOT_STALLED, cuid_,
+                         static_cast<unsigned long>(slot->getIndex()),
+                         slot->getBegin(),
+                         static_cast<unsigned long>(slot->getBlockIndex())));
+        egm->removeRequest(cuid_, slot->getIndex(), slot->getBlockIndex());
+        slot->setReleased(true);
+      }
+    }
+  }
+  // Only a request which is not answered within --bt-request-timeout
+  // is dropped, and the peer is snubbed.
   for (auto& slot : requestSlots_) {
     if (slot->isTimeout(requestTimeout_)) {
       A2_LOG_DEBUG(fmt(MSG_DELETING_REQUEST_SLOT_TIMEOUT, cuid_,
@@ -221,22 +275,38 @@ void DefaultBtMessageDispatcher::checkRequestSlotAndDoNecessaryThing()
                        slot->getBegin(),
                        static_cast<unsigned long>(slot->getBlockIndex())));
       slot->getPiece()->cancelBlock(slot->getBlockIndex());
+      addMessageToQueue(messageFactory_->createCancelMessage(
+          slot->getIndex(), slot->getBegin(), slot->getLength()));
       peer_->snubbing(true);
+      untrackRequest(*slot);
     }
-    else if (slot->getPiece()->hasBlock(slot->getBlockIndex())) {
+  }
+  requestSlots_.erase(
+      std::remove_if(std::begin(requestSlots_), std::end(requestSlots_),
+                     [&](const std::unique_ptr<RequestSlot>& slot) {
+                       return slot->isTimeout(requestTimeout_);
+                     }),
+      std::end(requestSlots_));
+  cancelAcquiredRequests();
+}
+
+void DefaultBtMessageDispatcher::cancelAcquiredRequests()
+{
+  for (auto& slot : requestSlots_) {
+    if (slot->getPiece()->hasBlock(slot->getBlockIndex())) {
       A2_LOG_DEBUG(fmt(MSG_DELETING_REQUEST_SLOT_ACQUIRED, cuid_,
                        static_cast<unsigned long>(slot->getIndex()),
                        slot->getBegin(),
                        static_cast<unsigned long>(slot->getBlockIndex())));
       addMessageToQueue(messageFactory_->createCancelMessage(
           slot->getIndex(), slot->getBegin(), slot->getLength()));
+      untrackRequest(*slot);
     }
   }
   requestSlots_.erase(
       std::remove_if(std::begin(requestSlots_), std::end(requestSlots_),
                      [&](const std::unique_ptr<RequestSlot>& slot) {
-                       return slot->isTimeout(requestTimeout_) ||
-                              slot->getPiece()->hasBlock(slot->getBlockIndex());
+                       return slot->getPiece()->hasBlock(slot->getBlockIndex());
                      }),
       std::end(requestSlots_));
 }
@@ -277,6 +347,7 @@ void DefaultBtMessageDispatcher::removeOutstandingRequest(
        i != eoi; ++i) {
     if (*(*i) == *slot) {
       abortOutstandingRequest((*i).get(), (*i)->getPiece(), cuid_);
+      untrackRequest(*(*i));
       requestSlots_.erase(i);
       break;
     }
@@ -286,6 +357,10 @@ void DefaultBtMessageDispatcher::removeOutstandingRequest(
 void DefaultBtMessageDispatcher::addOutstandingRequest(
     std::unique_ptr<RequestSlot> slot)
 {
+  auto egm = getEndGameManager();
+  if (egm) {
+    egm->addRequest(cuid_, slot->getIndex(), slot->getBlockIndex());
+  }
   requestSlots_.push_back(std::move(slot));
 }
 
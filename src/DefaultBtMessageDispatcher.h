@@ -51,6 +51,8 @@ class Peer;
 class Piece;
 class RequestGroupMan;
 class PeerConnection;
+class PieceStorage;
+class EndGameManager;
 
 class DefaultBtMessageDispatcher : public BtMessageDispatcher {
 private:
@@ -62,7 +64,18 @@ private:
   BtMessageFactory* messageFactory_;
   std::shared_ptr<Peer> peer_;
   RequestGroupMan* requestGroupMan_;
+  // Upper bound of the request timeout, which adapts to the latency
+  // of the peer.
   std::chrono::seconds requestTimeout_;
+  PieceStorage* pieceStorage_;
+  // true if the outstanding requests are tracked by EndGameManager.
+  bool endGameTracked_;
+
+  // Returns EndGameManager if the download is in end game mode.
+  // Otherwise returns nullptr.
+  EndGameManager* getEndGameManager();
+
+  void untrackRequest(const RequestSlot& slot);
 
 public:
   DefaultBtMessageDispatcher();
@@ -92,6 +105,8 @@ public:
 
   virtual void checkRequestSlotAndDoNecessaryThing() CXX11_OVERRIDE;
 
+  virtual void cancelAcquiredRequests() CXX11_OVERRIDE;
+
   virtual bool isSendingInProgress() CXX11_OVERRIDE;
 
   virtual size_t countMessageInQueue() CXX11_OVERRIDE
@@ -136,6 +151,11 @@ public:
 
   void setRequestGroupMan(RequestGroupMan* rgman);
 
+  void setPieceStorage(PieceStorage* pieceStorage)
+  {
+    pieceStorage_ = pieceStorage;
+  }
+
   void setCuid(cuid_t cuid) { cuid_ = cuid; }
 
   void setRequestTimeout(std::chrono::seconds requestTimeout)
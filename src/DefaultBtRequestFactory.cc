@@ -49,6 +49,7 @@
 #include "array_fun.h"
 #include "fmt.h"
 #include "BtRequestMessage.h"
+#include "EndGameManager.h"
 
 namespace aria2 {
 
@@ -198,6 +199,12 @@ std::vector<std::unique_ptr<BtRequestMessage>>
 DefaultBtRequestFactory::createRequestMessagesOnEndGame(size_t max)
 {
   auto requests = std::vector<std::unique_ptr<BtRequestMessage>>{};
+  auto egm = pieceStorage_->getEndGameManager();
+  size_t redundancyLimit = 0;
+  if (egm) {
+    redundancyLimit =
+        egm->getRedundancyLimit(cuid_, peer_->calculateDownloadSpeed());
+  }
   for (auto itr = std::begin(pieces_), eoi = std::end(pieces_);
        itr != eoi && requests.size() < max; ++itr) {
     auto& piece = *itr;
@@ -223,7 +230,9 @@ DefaultBtRequestFactory::createRequestMessagesOnEndGame(size_t max)
               eoi2 = std::end(missingBlockIndexes);
          bitr != eoi2 && requests.size() < max; ++bitr) {
       size_t blockIndex = *bitr;
-      if (!dispatcher_->isOutstandingRequest(piece->getIndex(), blockIndex)) {
+      if (!dispatcher_->isOutstandingRequest(piece->getIndex(), blockIndex) &&
+          (!egm || egm->countRequest(piece->getIndex(), blockIndex) <
+                       redundancyLimit)) {
         A2_LOG_DEBUG(
             fmt("Creating RequestMessage index=%lu, begin=%u,"
                 " blockIndex=%lu",
@@ -35,6 +35,7 @@
 #include "DefaultPeerStorage.h"
 
 #include <algorithm>
+#include <cstring>
 
 #include "LogFactory.h"
 #include "Logger.h"
@@ -59,6 +60,7 @@ const size_t MAX_PEER_LIST_SIZE = 512;
 
 DefaultPeerStorage::DefaultPeerStorage()
     : maxPeerListSize_(MAX_PEER_LIST_SIZE),
+      numUnusedPeers_(),
       seederStateChoke_(make_unique<BtSeederStateChoke>()),
       leecherStateChoke_(make_unique<BtLeecherStateChoke>()),
       lastTransferStatMapUpdated_(Timer::zero())
@@ -70,20 +72,113 @@ DefaultPeerStorage::~DefaultPeerStorage()
   assert(uniqPeers_.size() == unusedPeers_.size() + usedPeers_.size());
 }
 
+namespace {
+// Stores the binary form of IPv4 address ipaddr in dest, and returns
+// 4.  If ipaddr is not IPv4 address in dotted decimal notation,
+// returns 0.  This is much faster than net::getBinAddr(), which
+// calls getaddrinfo().
+size_t parseIPv4(unsigned char* dest, const std::string& ipaddr)
+{
+  size_t n = 0;
+  unsigned int octet = 0;
+  size_t digits = 0;
+  for (auto c : ipaddr) {
+    if ('0' <= c && c <= '9') {
+      octet = octet * 10 + (c - '0');
+      if (++digits > 3 || octet > 255) {
+        return 0;
+      }
+    }
+    else if (c == '.' && digits > 0 && n < 3) {
+      dest[n++] = octet;
+      octet = 0;
+      digits = 0;
+    }
+    else {
+      return 0;
+    }
+  }
+  if (digits == 0 || n != 3) {
+    return 0;
+  }
+  dest[n++] = octet;
+  return n;
+}
+} // namespace
+
+DefaultPeerStorage::Key::Key(const std::string& ipaddr, uint16_t port)
+    : addrlen(parseIPv4(addr, ipaddr)), port(port)
+{
+  // IPv6 addresses are rare, and they come from inetNtop() in the
+  // canonical form, so we just keep them as they are.
+  if (addrlen == 0) {
+    name = ipaddr;
+  }
+}
+
+bool DefaultPeerStorage::Key::operator==(const Key& other) const
+{
+  return addrlen == other.addrlen && port == other.port &&
+         memcmp(addr, other.addr, addrlen) == 0 && name == other.name;
+}
+
+size_t DefaultPeerStorage::KeyHash::operator()(const Key& key) const
+{
+  // FNV-1a
+  uint32_t h = 2166136261u;
+  auto mix = [&h](unsigned char c) { h = (h ^ c) * 16777619u; };
+  for (size_t i = 0; i < key.addrlen; ++i) {
+    mix(key.addr[i]);
+  }
+  mix(key.port >> 8);
+  mix(key.port & 0xffu);
+  if (key.name.empty()) {
+    return h;
+  }
+  return h ^ std::hash<std::string>()(key.name);
+}
+
 size_t DefaultPeerStorage::countAllPeer() const
 {
   return unusedPeers_.size() + usedPeers_.size();
 }
 
-bool DefaultPeerStorage::isPeerAlreadyAdded(const std::shared_ptr<Peer>& peer)
+DefaultPeerStorage::Priority
+DefaultPeerStorage::getPriority(const std::shared_ptr<Peer>& peer,
+                                const Key& key) const
 {
-  return uniqPeers_.count(
-      std::make_pair(peer->getIPAddress(), peer->getOrigPort()));
+  if (peer->isLocalPeer()) {
+    return PRIORITY_LOCAL;
+  }
+  if (droppedKeys_.count(key)) {
+    return PRIORITY_DROPPED;
+  }
+  return PRIORITY_NORMAL;
 }
 
-void DefaultPeerStorage::addUniqPeer(const std::shared_ptr<Peer>& peer)
+void DefaultPeerStorage::pushUnusedPeer(const std::shared_ptr<Peer>& peer,
+                                        Priority priority)
 {
-  uniqPeers_.insert(std::make_pair(peer->getIPAddress(), peer->getOrigPort()));
+  // Insert after the peers of the same or higher priority.  The peers
+  // of lower priority are few, so this is mostly push_back().
+  size_t pos = 0;
+  for (int i = 0; i <= priority; ++i) {
+    pos += numUnusedPeers_[i];
+  }
+  unusedPeers_.insert(std::begin(unusedPeers_) + pos, peer);
+  ++numUnusedPeers_[priority];
+}
+
+void DefaultPeerStorage::countUnusedPeerRemoval(size_t index)
+{
+  for (auto& n : numUnusedPeers_) {
+    if (index < n) {
+      --n;
+      return;
+    }
+    index -= n;
+  }
+  assert(0);
 }
 
 bool DefaultPeerStorage::addPeer(const std::shared_ptr<Peer>& peer)
@@ -96,7 +191,8 @@ bool DefaultPeerStorage::addPeer(const std::shared_ptr<Peer>& peer)
                      static_cast<unsigned long>(maxPeerListSize_)));
     return false;
   }
-  if (isPeerAlreadyAdded(peer)) {
+  Key key(peer->getIPAddress(), peer->getOrigPort());
+  if (uniqPeers_.count(key)) {
     A2_LOG_DEBUG(fmt("Adding %s:%u is rejected because it has been already"
                      " added.",
                      peer->getIPAddress().c_str(), peer->getPort()));
@@ -111,8 +207,8 @@ bool DefaultPeerStorage::addPeer(const std::shared_ptr<Peer>& peer)
   if (peerListSize >= maxPeerListSize_) {
     deleteUnusedPeer(peerListSize - maxPeerListSize_ + 1);
   }
-  unusedPeers_.push_back(peer);
-  addUniqPeer(peer);
+  pushUnusedPeer(peer, getPriority(peer, key));
+  uniqPeers_.emplace(std::move(key), peer);
   A2_LOG_DEBUG(fmt("Now unused peer list contains %lu peers",
                    static_cast<unsigned long>(unusedPeers_.size())));
   return true;
@@ -123,7 +219,8 @@ void DefaultPeerStorage::addPeer(
 {
   if (unusedPeers_.size() < maxPeerListSize_) {
     for (auto& peer : peers) {
-      if (isPeerAlreadyAdded(peer)) {
+      Key key(peer->getIPAddress(), peer->getOrigPort());
+      if (uniqPeers_.count(key)) {
         A2_LOG_DEBUG(fmt("Adding %s:%u is rejected because it has been already"
                          " added.",
                          peer->getIPAddress().c_str(), peer->getPort()));
@@ -138,8 +235,8 @@ void DefaultPeerStorage::addPeer(
         A2_LOG_DEBUG(fmt(MSG_ADDING_PEER, peer->getIPAddress().c_str(),
                          peer->getPort()));
       }
-      unusedPeers_.push_back(peer);
-      addUniqPeer(peer);
+      pushUnusedPeer(peer, getPriority(peer, key));
+      uniqPeers_.emplace(std::move(key), peer);
     }
   }
   else {
@@ -164,42 +261,44 @@ std::shared_ptr<Peer>
 DefaultPeerStorage::addAndCheckoutPeer(const std::shared_ptr<Peer>& peer,
                                        cuid_t cuid)
 {
-  if (isPeerAlreadyAdded(peer)) {
-    auto it = std::find_if(std::begin(unusedPeers_), std::end(unusedPeers_),
-                           [&peer](const std::shared_ptr<Peer>& p) {
-                             return p->getIPAddress() == peer->getIPAddress() &&
-                                    p->getOrigPort() == peer->getOrigPort();
-                           });
-    if (it == std::end(unusedPeers_)) {
-      // peer is in usedPeers_.
+  Key key(peer->getIPAddress(), peer->getOrigPort());
+  auto i = uniqPeers_.find(key);
+  if (i != std::end(uniqPeers_)) {
+    if (usedPeers_.count((*i).second)) {
       return nullptr;
     }
-
+    auto it = std::find(std::begin(unusedPeers_), std::end(unusedPeers_),
+                        (*i).second);
+    assert(it != std::end(unusedPeers_));
+    countUnusedPeerRemoval(it - std::begin(unusedPeers_));
     unusedPeers_.erase(it);
+    (*i).second = peer;
   }
   else {
-    addUniqPeer(peer);
+    uniqPeers_.emplace(std::move(key), peer);
   }
 
-  unusedPeers_.push_front(peer);
-
-  return checkoutPeer(cuid);
+  return checkoutPeer(peer, cuid);
 }
 
 void DefaultPeerStorage::addDroppedPeer(const std::shared_ptr<Peer>& peer)
 {
   // Make sure that no duplicated peer exists in droppedPeers_. If
   // exists, erase older one.
-  for (auto i = std::begin(droppedPeers_), eoi = std::end(droppedPeers_);
-       i != eoi; ++i) {
-    if ((*i)->getIPAddress() == peer->getIPAddress() &&
-        (*i)->getPort() == peer->getPort()) {
-      droppedPeers_.erase(i);
-      break;
+  if (!droppedKeys_.emplace(peer->getIPAddress(), peer->getPort()).second) {
+    for (auto i = std::begin(droppedPeers_), eoi = std::end(droppedPeers_);
+         i != eoi; ++i) {
+      if ((*i)->getIPAddress() == peer->getIPAddress() &&
+          (*i)->getPort() == peer->getPort()) {
+        droppedPeers_.erase(i);
+        break;
+      }
     }
   }
   droppedPeers_.push_front(peer);
   if (droppedPeers_.size() > 50) {
+    auto& last = droppedPeers_.back();
+    droppedKeys_.erase(Key(last->getIPAddress(), last->getPort()));
     droppedPeers_.pop_back();
   }
 }
@@ -220,41 +319,36 @@ bool DefaultPeerStorage::isPeerAvailable() { return !unusedPeers_.empty(); }
 
 bool DefaultPeerStorage::isBadPeer(const std::string& ipaddr)
 {
-  auto i = badPeers_.find(ipaddr);
-  if (i == std::end(badPeers_)) {
-    return false;
-  }
+  purgeBadPeers();
+  return badPeers_.count(Key(ipaddr, 0));
+}
 
-  if ((*i).second <= global::wallclock()) {
-    badPeers_.erase(i);
-    return false;
+void DefaultPeerStorage::purgeBadPeers()
+{
+  while (!badPeerExpiries_.empty() &&
+         badPeerExpiries_.top().first <= global::wallclock()) {
+    auto& ipaddr = badPeerExpiries_.top().second;
+    auto i = badPeers_.find(Key(ipaddr, 0));
+    // Skip if the address has been marked bad again since then.
+    if (i != std::end(badPeers_) && (*i).second <= global::wallclock()) {
+      A2_LOG_DEBUG(fmt("Purge %s from bad peer", ipaddr.c_str()));
+      badPeers_.erase(i);
+    }
+    badPeerExpiries_.pop();
   }
-
-  return true;
 }
 
 void DefaultPeerStorage::addBadPeer(const std::string& ipaddr)
 {
-  if (lastBadPeerCleaned_.difference(global::wallclock()) >= 1_h) {
-    for (auto i = std::begin(badPeers_); i != std::end(badPeers_);) {
-      if ((*i).second <= global::wallclock()) {
-        A2_LOG_DEBUG(fmt("Purge %s from bad peer", (*i).first.c_str()));
-        badPeers_.erase(i++);
-        // badPeers_.end() will not be invalidated.
-      }
-      else {
-        ++i;
-      }
-    }
-    lastBadPeerCleaned_ = global::wallclock();
-  }
+  purgeBadPeers();
   A2_LOG_DEBUG(fmt("Added %s as bad peer", ipaddr.c_str()));
   // We use variable timeout to avoid many bad peers wake up at once.
   auto t = global::wallclock();
   t.advance(std::chrono::seconds(
       std::max(SimpleRandomizer::getInstance()->getRandomNumber(601), 120L)));
 
-  badPeers_[ipaddr] = std::move(t);
+  badPeers_[Key(ipaddr, 0)] = t;
+  badPeerExpiries_.emplace(std::move(t), ipaddr);
 }
 
 void DefaultPeerStorage::deleteUnusedPeer(size_t delSize)
@@ -264,6 +358,7 @@ void DefaultPeerStorage::deleteUnusedPeer(size_t delSize)
     onErasingPeer(peer);
     A2_LOG_DEBUG(fmt("Remove peer %s:%u", peer->getIPAddress().c_str(),
                      peer->getOrigPort()));
+    countUnusedPeerRemoval(unusedPeers_.size() - 1);
     unusedPeers_.pop_back();
   }
 }
@@ -274,7 +369,14 @@ std::shared_ptr<Peer> DefaultPeerStorage::checkoutPeer(cuid_t cuid)
     return nullptr;
   }
   auto peer = unusedPeers_.front();
+  countUnusedPeerRemoval(0);
   unusedPeers_.pop_front();
+  return checkoutPeer(peer, cuid);
+}
+
+std::shared_ptr<Peer>
+DefaultPeerStorage::checkoutPeer(const std::shared_ptr<Peer>& peer, cuid_t cuid)
+{
   if (peer->usedBy() != 0) {
     A2_LOG_WARN(fmt("CUID#%" PRId64 " is already set for peer %s:%u",
                     peer->usedBy(), peer->getIPAddress().c_str(),
@@ -290,7 +392,7 @@ std::shared_ptr<Peer> DefaultPeerStorage::checkoutPeer(cuid_t cuid)
 
 void DefaultPeerStorage::onErasingPeer(const std::shared_ptr<Peer>& peer)
 {
-  uniqPeers_.erase(std::make_pair(peer->getIPAddress(), peer->getOrigPort()));
+  uniqPeers_.erase(Key(peer->getIPAddress(), peer->getOrigPort()));
 }
 
 void DefaultPeerStorage::onReturningPeer(const std::shared_ptr<Peer>& peer)
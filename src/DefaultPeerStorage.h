@@ -38,7 +38,9 @@
 #include "PeerStorage.h"
 
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <queue>
 
 #include "TimerA2.h"
 
@@ -55,30 +57,94 @@ private:
   std::shared_ptr<PieceStorage> pieceStorage_;
   size_t maxPeerListSize_;
 
-  // This contains ip address and port pair and is used to ensure that
-  // no duplicate peers are stored.
-  std::set<std::pair<std::string, uint16_t>> uniqPeers_;
-  // Unused (not connected) peers, sorted by last added.
+  // IP address and port of a peer in binary form.  The indexes below
+  // use it as the key so that lookups hash a few bytes instead of
+  // comparing address strings.  The address which is not IPv4 is kept
+  // in name.
+  struct Key {
+    unsigned char addr[4];
+    uint8_t addrlen;
+    uint16_t port;
+    std::string name;
+
+    Key(const std::string& ipaddr, uint16_t port);
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  // The priority of unused peers.  The smaller value comes first in
+  // unusedPeers_.
+  enum Priority {
+    // Peers found by Local Peer Discovery.
+    PRIORITY_LOCAL,
+    PRIORITY_NORMAL,
+    // Peers which recently disconnected from us.
+    PRIORITY_DROPPED,
+    NUM_PRIORITY
+  };
+
+  // Maps ip address and port pair to the peer, both unused and used.
+  // This is used to ensure that no duplicate peers are stored.
+  std::unordered_map<Key, std::shared_ptr<Peer>, KeyHash> uniqPeers_;
+  // Unused (not connected) peers, sorted by priority, and then by last
+  // added.  checkoutPeer() takes the front, and the back is removed
+  // first when the list is full.
   std::deque<std::shared_ptr<Peer>> unusedPeers_;
+  // The number of peers of each priority in unusedPeers_.
+  size_t numUnusedPeers_[NUM_PRIORITY];
   // The set of used peers. Some of them are not connected yet. To
   // know it is connected or not, call Peer::isActive().
   PeerSet usedPeers_;
 
   std::deque<std::shared_ptr<Peer>> droppedPeers_;
+  // The ip address and port pairs of droppedPeers_.
+  std::unordered_set<Key, KeyHash> droppedKeys_;
 
   std::unique_ptr<BtSeederStateChoke> seederStateChoke_;
   std::unique_ptr<BtLeecherStateChoke> leecherStateChoke_;
 
   Timer lastTransferStatMapUpdated_;
 
-  std::map<std::string, Timer> badPeers_;
-  Timer lastBadPeerCleaned_;
-
-  bool isPeerAlreadyAdded(const std::shared_ptr<Peer>& peer);
-  void addUniqPeer(const std::shared_ptr<Peer>& peer);
+  // The time when ip address stops being bad, and the address.
+  typedef std::pair<Timer, std::string> BadPeerExpiry;
+
+  struct BadPeerExpiryGreater {
+    bool operator()(const BadPeerExpiry& lhs, const BadPeerExpiry& rhs) const
+    {
+      return rhs.first < lhs.first;
+    }
+  };
+
+  // Maps ip address (port is always 0) to the time when it stops
+  // being bad.
+  std::unordered_map<Key, Timer, KeyHash> badPeers_;
+  // The entries of badPeers_, the earliest expiry first.  An entry is
+  // left here when the address is marked bad again, and it is
+  // ignored when it is popped.
+  std::priority_queue<BadPeerExpiry, std::vector<BadPeerExpiry>,
+                      BadPeerExpiryGreater>
+      badPeerExpiries_;
 
   void addDroppedPeer(const std::shared_ptr<Peer>& peer);
 
+  // Removes bad peers which have expired.
+  void purgeBadPeers();
+
+  // Returns the priority of peer whose key is key.
+  Priority getPriority(const std::shared_ptr<Peer>& peer,
+                       const Key& key) const;
+  void pushUnusedPeer(const std::shared_ptr<Peer>& peer, Priority priority);
+  // Updates numUnusedPeers_ for the removal of the peer at index in
+  // unusedPeers_.  This does not remove the peer.
+  void countUnusedPeerRemoval(size_t index);
+
+  std::shared_ptr<Peer> checkoutPeer(const std::shared_ptr<Peer>& peer,
+                                     cuid_t cuid);
+
 public:
   DefaultPeerStorage();
 
@@ -71,6 +71,7 @@
 #include "SimpleRandomizer.h"
 #ifdef ENABLE_BITTORRENT
 #include "bittorrent_helper.h"
+#include "EndGameManager.h"
 #endif // ENABLE_BITTORRENT
 
 namespace aria2 {
@@ -533,6 +534,16 @@ void DefaultPieceStorage::cancelPiece(const std::shared_ptr<Piece>& piece,
   }
 }
 
+void DefaultPieceStorage::enterEndGame()
+{
+  endGame_ = true;
+#ifdef ENABLE_BITTORRENT
+  if (!endGameManager_) {
+    endGameManager_ = make_unique<EndGameManager>();
+  }
+#endif // ENABLE_BITTORRENT
+}
+
 bool DefaultPieceStorage::hasPiece(size_t index)
 {
   return bitfieldMan_->isBitSet(index);
@@ -96,6 +96,8 @@ private:
 
   WrDiskCache* wrDiskCache_;
 #ifdef ENABLE_BITTORRENT
+  std::unique_ptr<EndGameManager> endGameManager_;
+
   void getMissingPiece(std::vector<std::shared_ptr<Piece>>& pieces,
                        size_t minMissingBlocks, const unsigned char* bitfield,
                        size_t length, cuid_t cuid);
@@ -169,6 +171,11 @@ public:
   getMissingFastPiece(const std::shared_ptr<Peer>& peer,
                       const std::vector<size_t>& excludedIndexes, cuid_t cuid);
 
+  virtual EndGameManager* getEndGameManager() CXX11_OVERRIDE
+  {
+    return endGameManager_.get();
+  }
+
 #endif // ENABLE_BITTORRENT
 
   virtual bool hasMissingUnusedPiece() CXX11_OVERRIDE;
@@ -228,7 +235,7 @@ public:
 
   virtual bool isEndGame() CXX11_OVERRIDE { return endGame_; }
 
-  virtual void enterEndGame() CXX11_OVERRIDE { endGame_ = true; }
+  virtual void enterEndGame() CXX11_OVERRIDE;
 
   virtual std::shared_ptr<DiskAdaptor> getDiskAdaptor() CXX11_OVERRIDE;
 
@@ -63,6 +63,7 @@ public:
         command_{std::move(command)},
         noWait_{noWait}
   {
+    enableSleep();
   }
 
   virtual ~DelayedCommand() {}
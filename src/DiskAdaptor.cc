@@ -35,6 +35,9 @@
 #include "DiskAdaptor.h"
 #include "FileEntry.h"
 #include "OpenedFileCounter.h"
+#include "WrDiskCacheEntry.h"
+#include "LogFactory.h"
+#include "fmt.h"
 
 namespace aria2 {
 
@@ -42,4 +45,34 @@ DiskAdaptor::DiskAdaptor() : fileAllocationMethod_(FILE_ALLOC_ADAPTIVE) {}
 
 DiskAdaptor::~DiskAdaptor() = default;
 
+void DiskAdaptor::writeCache(const WrDiskCacheEntry* entry)
+{
+  a2iovec iov[A2_IOV_MAX];
+  size_t iovcnt = 0;
+  int64_t start = 0;
+  int64_t end = 0;
+  auto flush = [&]() {
+    A2_LOG_DEBUG(fmt("Cache flush goff=%" PRId64 ", len=%" PRId64
+                     ", cells=%lu",
+                     start, end - start, static_cast<unsigned long>(iovcnt)));
+    writeDataV(iov, iovcnt, start);
+    iovcnt = 0;
+  };
+  for (auto& d : entry->getDataSet()) {
+    if (iovcnt == A2_IOV_MAX || (iovcnt > 0 && d->goff != end)) {
+      flush();
+    }
+    if (iovcnt == 0) {
+      start = end = d->goff;
+    }
+    iov[iovcnt].A2IOVEC_BASE = reinterpret_cast<char*>(d->data + d->offset);
+    iov[iovcnt].A2IOVEC_LEN = d->len;
+    ++iovcnt;
+    end += d->len;
+  }
+  if (iovcnt > 0) {
+    flush();
+  }
+}
+
 } // namespace aria2
@@ -42,6 +42,7 @@
 #include <memory>
 
 #include "TimeA2.h"
+#include "a2netcompat.h"
 
 namespace aria2 {
 
@@ -49,6 +50,7 @@ class FileEntry;
 class FileAllocationIterator;
 class WrDiskCacheEntry;
 class OpenedFileCounter;
+class SocketCore;
 
 class DiskAdaptor : public BinaryStream {
 public:
@@ -111,8 +113,22 @@ public:
   virtual ssize_t readDataDropCache(unsigned char* data, size_t len,
                                     int64_t offset) = 0;
 
-  // Writes cached data to the underlying disk.
-  virtual void writeCache(const WrDiskCacheEntry* entry) = 0;
+  // Writes the data in |iovcnt| buffers pointed by |iov| to the
+  // contiguous region starting at |offset|.  The region may span more
+  // than one file.
+  virtual void writeDataV(const a2iovec* iov, size_t iovcnt,
+                          int64_t offset) = 0;
+
+  // Writes cached data to the underlying disk.  The contiguous data
+  // cells are written with one writeDataV() call.
+  void writeCache(const WrDiskCacheEntry* entry);
+
+  // Writes at most len bytes of data at offset to socket without
+  // reading them into memory, if the underlying DiskWriter supports
+  // it.  The data may be written partially, for example when it
+  // spans more than one file.  Returns the number of bytes written.
+  virtual ssize_t sendData(const std::shared_ptr<SocketCore>& socket,
+                           size_t len, int64_t offset) = 0;
 
   void setFileAllocationMethod(FileAllocationMethod method)
   {
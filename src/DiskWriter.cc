@@ -0,0 +1,67 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2009 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "DiskWriter.h"
+
+#include <array>
+#include <algorithm>
+
+#include "SocketCore.h"
+#include "DlAbortEx.h"
+#include "message.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+void DiskWriter::writeDataV(const a2iovec* iov, size_t iovcnt, int64_t offset)
+{
+  for (size_t i = 0; i < iovcnt; ++i) {
+    writeData(reinterpret_cast<const unsigned char*>(iov[i].A2IOVEC_BASE),
+              iov[i].A2IOVEC_LEN, offset);
+    offset += iov[i].A2IOVEC_LEN;
+  }
+}
+
+ssize_t DiskWriter::sendData(const std::shared_ptr<SocketCore>& socket,
+                             size_t len, int64_t offset)
+{
+  std::array<unsigned char, 16_k> buf;
+  auto nread = readData(buf.data(), std::min(len, buf.size()), offset);
+  if (nread <= 0) {
+    throw DL_ABORT_EX(EX_DATA_READ);
+  }
+  return socket->writeData(buf.data(), nread);
+}
+
+} // namespace aria2
@@ -37,8 +37,14 @@
 
 #include "BinaryStream.h"
 
+#include <memory>
+
+#include "a2netcompat.h"
+
 namespace aria2 {
 
+class SocketCore;
+
 /**
  * Interface for writing to a binary stream of bytes.
  *
@@ -85,6 +91,17 @@ public:
 
   // Drops cache in range [offset, offset + len)
   virtual void dropCache(int64_t len, int64_t offset) {}
+
+  // Writes the data in |iovcnt| buffers pointed by |iov| to the
+  // contiguous region starting at |offset|.  The default
+  // implementation calls writeData() for each buffer.
+  virtual void writeDataV(const a2iovec* iov, size_t iovcnt, int64_t offset);
+
+  // Writes at most len bytes of data at offset to socket and returns
+  // the number of bytes written.  The default implementation reads
+  // the data into a temporary buffer and writes it to socket.
+  virtual ssize_t sendData(const std::shared_ptr<SocketCore>& socket,
+                           size_t len, int64_t offset);
 };
 
 } // namespace aria2
@@ -157,8 +157,7 @@ bool DownloadCommand::executeInternal()
     // read data from socket here, we will get EOF and leaves 2nd
     // response unprocessed.  To prevent this, we don't read from
     // socket when buffer is not empty.
-    eof = getSocketRecvBuffer()->recv() == 0 && !getSocket()->wantRead() &&
-          !getSocket()->wantWrite();
+    eof = getSocketRecvBuffer()->recv() == 0 && getSocketRecvBuffer()->eof();
   }
   if (!eof) {
     size_t bufSize;
@@ -67,6 +67,9 @@
 #include "DownloadContext.h"
 #include "fmt.h"
 #include "wallclock.h"
+#include "Http2Session.h"
+#include "SocketPool.h"
+#include "TimerWheel.h"
 #ifdef ENABLE_BITTORRENT
 #include "BtRegistry.h"
 #endif // ENABLE_BITTORRENT
@@ -75,6 +78,9 @@
 #endif // ENABLE_WEBSOCKET
 #include "Option.h"
 #include "util_security.h"
+#ifdef ENABLE_THREADS
+#include "ThreadPool.h"
+#endif // ENABLE_THREADS
 
 namespace aria2 {
 
@@ -92,14 +98,25 @@ volatile sig_atomic_t globalHaltRequested = 0;
 
 namespace {
 constexpr auto DEFAULT_REFRESH_INTERVAL = 1_s;
+// The limits of idle connections kept in SocketPool.  The per-key
+// limit matches the maximum of --max-connection-per-server.
+constexpr size_t MAX_POOLED_SOCKETS_PER_KEY = 16;
+constexpr size_t MAX_POOLED_SOCKETS = 256;
+// HTTP/2 sessions without streams are closed after this period.
+constexpr auto HTTP2_SESSION_IDLE_TIMEOUT = 15_s;
 } // namespace
 
 DownloadEngine::DownloadEngine(std::unique_ptr<EventPoll> eventPoll)
     : eventPoll_(std::move(eventPoll)),
       haltRequested_(0),
+      shard_(false),
+      socketPool_(make_unique<SocketPool>(MAX_POOLED_SOCKETS_PER_KEY,
+                                          MAX_POOLED_SOCKETS)),
       noWait_(true),
       refreshInterval_(DEFAULT_REFRESH_INTERVAL),
       lastRefresh_(Timer::zero()),
+      timerWheel_(make_unique<TimerWheel>(global::wallclock())),
+      lastStateSerial_(0),
       cookieStorage_(make_unique<CookieStorage>()),
 #ifdef ENABLE_BITTORRENT
       btRegistry_(make_unique<BtRegistry>()),
@@ -108,6 +125,10 @@ DownloadEngine::DownloadEngine(std::unique_ptr<EventPoll> eventPoll)
       asyncDNSServers_(nullptr),
 #endif // HAVE_ARES_ADDR_NODE
       dnsCache_(make_unique<DNSCache>()),
+#ifdef ENABLE_THREADS
+      numCheckIntegrityThreads_(1),
+      numFileAllocationThreads_(1),
+#endif // ENABLE_THREADS
       option_(nullptr)
 {
   unsigned char sessionId[20];
@@ -126,15 +147,24 @@ namespace {
 void executeCommand(std::deque<std::unique_ptr<Command>>& commands,
                     Command::STATUS statusFilter)
 {
+  // Commands which do not match statusFilter stay in their slot.
+  // Executed commands leave a null slot behind, which is removed in
+  // one pass at the end. Commands added during execution are appended
+  // after max and are not touched in this turn. Sleeping commands are
+  // skipped unless something has activated them since they went to
+  // sleep.
   size_t max = commands.size();
+  size_t executed = 0;
   for (size_t i = 0; i < max; ++i) {
-    auto com = std::move(commands.front());
-    commands.pop_front();
-    if (!com->statusMatch(statusFilter)) {
-      com->clearIOEvents();
-      commands.push_back(std::move(com));
+    auto& slot = commands[i];
+    if (!slot->statusMatch(statusFilter) ||
+        (slot->isSleeping() && !slot->statusMatch(Command::STATUS_ACTIVE))) {
+      slot->clearIOEvents();
       continue;
     }
+    auto com = std::move(slot);
+    ++executed;
+    com->wakeUp();
     com->transitStatus();
     if (com->execute()) {
       com.reset();
@@ -144,6 +174,11 @@ void executeCommand(std::deque<std::unique_ptr<Command>>& commands,
       com.release();
     }
   }
+  if (executed == 0) {
+    return;
+  }
+  auto last = std::begin(commands) + max;
+  commands.erase(std::remove(std::begin(commands), last, nullptr), last);
 }
 } // namespace
 
@@ -165,7 +200,7 @@ private:
 
 int DownloadEngine::run(bool oneshot)
 {
-  GlobalHaltRequestedFinalizer ghrf(oneshot);
+  GlobalHaltRequestedFinalizer ghrf(oneshot || shard_);
   while (!commands_.empty() || !routineCommands_.empty()) {
     if (!commands_.empty()) {
       waitData();
@@ -173,8 +208,10 @@ int DownloadEngine::run(bool oneshot)
     noWait_ = false;
     global::wallclock().reset();
     calculateStatistics();
+    timerWheel_->advance(global::wallclock());
     if (lastRefresh_.difference(global::wallclock()) + A2_DELTA_MILLIS >=
         refreshInterval_) {
+      wakeUpSleepingCommandsIfNecessary();
       refreshInterval_ = DEFAULT_REFRESH_INTERVAL;
       lastRefresh_ = global::wallclock();
       executeCommand(commands_, Command::STATUS_ALL);
@@ -235,6 +272,16 @@ bool DownloadEngine::deleteSocketForWriteCheck(
                                   EventPoll::EVENT_WRITE);
 }
 
+bool DownloadEngine::addFdForReadCheck(sock_t fd, Command* command)
+{
+  return eventPoll_->addEvents(fd, command, EventPoll::EVENT_READ);
+}
+
+bool DownloadEngine::deleteFdForReadCheck(sock_t fd, Command* command)
+{
+  return eventPoll_->deleteEvents(fd, command, EventPoll::EVENT_READ);
+}
+
 void DownloadEngine::calculateStatistics()
 {
   if (statCalc_) {
@@ -251,6 +298,9 @@ void DownloadEngine::onEndOfRun()
 
 void DownloadEngine::afterEachIteration()
 {
+  if (shard_) {
+    return;
+  }
   if (global::globalHaltRequested == 1) {
     A2_LOG_NOTICE(_("Shutdown sequence commencing..."
                     " Press Ctrl-C again for emergency shutdown."));
@@ -309,50 +359,7 @@ void DownloadEngine::addRoutineCommand(std::unique_ptr<Command> command)
   routineCommands_.push_back(std::move(command));
 }
 
-void DownloadEngine::poolSocket(const std::string& key,
-                                const SocketPoolEntry& entry)
-{
-  A2_LOG_INFO(fmt("Pool socket for %s", key.c_str()));
-  std::multimap<std::string, SocketPoolEntry>::value_type p(key, entry);
-  socketPool_.insert(p);
-}
-
-void DownloadEngine::evictSocketPool()
-{
-  if (socketPool_.empty()) {
-    return;
-  }
-
-  std::multimap<std::string, SocketPoolEntry> newPool;
-  A2_LOG_DEBUG("Scanning SocketPool and erasing timed out entry.");
-  for (auto& elem : socketPool_) {
-    if (!elem.second.isTimeout()) {
-      newPool.insert(elem);
-    }
-  }
-  A2_LOG_DEBUG(
-      fmt("%lu entries removed.",
-          static_cast<unsigned long>(socketPool_.size() - newPool.size())));
-  socketPool_ = std::move(newPool);
-}
-
-namespace {
-std::string createSockPoolKey(const std::string& host, uint16_t port,
-                              const std::string& username,
-                              const std::string& proxyhost, uint16_t proxyport)
-{
-  std::string key;
-  if (!username.empty()) {
-    key += util::percentEncode(username);
-    key += "@";
-  }
-  key += fmt("%s(%u)", host.c_str(), port);
-  if (!proxyhost.empty()) {
-    key += fmt("/%s(%u)", proxyhost.c_str(), proxyport);
-  }
-  return key;
-}
-} // namespace
+void DownloadEngine::evictSocketPool() { socketPool_->evict(); }
 
 void DownloadEngine::poolSocket(const std::string& ipaddr, uint16_t port,
                                 const std::string& username,
@@ -362,9 +369,9 @@ void DownloadEngine::poolSocket(const std::string& ipaddr, uint16_t port,
                                 const std::string& options,
                                 std::chrono::seconds timeout)
 {
-  SocketPoolEntry e(sock, options, std::move(timeout));
-  poolSocket(createSockPoolKey(ipaddr, port, username, proxyhost, proxyport),
-             e);
+  socketPool_->add(
+      SocketPool::Key(ipaddr, port, username, proxyhost, proxyport), sock,
+      options, std::move(timeout));
 }
 
 void DownloadEngine::poolSocket(const std::string& ipaddr, uint16_t port,
@@ -373,9 +380,9 @@ void DownloadEngine::poolSocket(const std::string& ipaddr, uint16_t port,
                                 const std::shared_ptr<SocketCore>& sock,
                                 std::chrono::seconds timeout)
 {
-  SocketPoolEntry e(sock, std::move(timeout));
-  poolSocket(createSockPoolKey(ipaddr, port, A2STR::NIL, proxyhost, proxyport),
-             e);
+  socketPool_->add(SocketPool::Key(ipaddr, port, A2STR::NIL, proxyhost,
+                                   proxyport),
+                   sock, A2STR::NIL, std::move(timeout));
 }
 
 namespace {
@@ -399,6 +406,18 @@ void DownloadEngine::poolSocket(const std::shared_ptr<Request>& request,
                                 const std::shared_ptr<SocketCore>& socket,
                                 std::chrono::seconds timeout)
 {
+#ifdef ENABLE_SSL
+  if (request->getProtocol() == "https") {
+    // The session ticket of TLSv1.3 is sent after the handshake, so
+    // that the session data is taken here, not just after the
+    // handshake.
+    auto data = socket->getTlsSessionData();
+    if (!data.empty()) {
+      socketPool_->putTlsSessionData(request->getHost(), request->getPort(),
+                                     std::move(data));
+    }
+  }
+#endif // ENABLE_SSL
   if (proxyRequest) {
     // If proxy is defined, then pool socket with its hostname.
     poolSocket(request->getHost(), request->getPort(), proxyRequest->getHost(),
@@ -435,22 +454,81 @@ void DownloadEngine::poolSocket(const std::shared_ptr<Request>& request,
   }
 }
 
-std::multimap<std::string, DownloadEngine::SocketPoolEntry>::iterator
-DownloadEngine::findSocketPoolEntry(const std::string& key)
+void DownloadEngine::addHttp2Session(const std::string& hostname,
+                                     uint16_t port,
+                                     std::shared_ptr<Http2Session> session)
+{
+  http2Sessions_.emplace(fmt("%s:%u", hostname.c_str(), port),
+                         std::move(session));
+}
+
+namespace {
+// Nobody reads the socket of an idle session, so process the frames
+// the server sent meanwhile, like GOAWAY.
+void recvIdleHttp2Session(Http2Session& session)
 {
-  std::pair<std::multimap<std::string, SocketPoolEntry>::iterator,
-            std::multimap<std::string, SocketPoolEntry>::iterator>
-      range = socketPool_.equal_range(key);
-  for (auto i = range.first, eoi = range.second; i != eoi; ++i) {
-    const SocketPoolEntry& e = (*i).second;
-    // We assume that if socket is readable it means peer shutdowns
-    // connection and the socket will receive EOF. So skip it.
-    if (!e.isTimeout() && !e.getSocket()->isReadable(0)) {
-      A2_LOG_INFO(fmt("Found socket for %s", key.c_str()));
-      return i;
+  try {
+    session.recv();
+  }
+  catch (RecoverableException& e) {
+    A2_LOG_DEBUG_EX("Idle HTTP/2 session was closed.", e);
+  }
+}
+
+bool http2SessionTimeout(const Http2Session& session)
+{
+  return session.countStream() == 0 &&
+         session.getIdleTimer().difference(global::wallclock()) >=
+             HTTP2_SESSION_IDLE_TIMEOUT;
+}
+} // namespace
+
+std::shared_ptr<Http2Session>
+DownloadEngine::findHttp2Session(const std::string& hostname, uint16_t port)
+{
+  auto range =
+      http2Sessions_.equal_range(fmt("%s:%u", hostname.c_str(), port));
+  for (auto i = range.first; i != range.second; ++i) {
+    auto& session = (*i).second;
+    // The timed out sessions are removed by evictHttp2Sessions().
+    if (http2SessionTimeout(*session)) {
+      continue;
+    }
+    if (session->countStream() == 0) {
+      recvIdleHttp2Session(*session);
+    }
+    if (session->canSubmitRequest()) {
+      return session;
     }
   }
-  return socketPool_.end();
+  return nullptr;
+}
+
+void DownloadEngine::evictHttp2Sessions()
+{
+  if (http2Sessions_.empty()) {
+    return;
+  }
+  A2_LOG_DEBUG("Scanning HTTP/2 sessions and erasing closed or idle ones.");
+  size_t numSessions = http2Sessions_.size();
+  for (auto i = std::begin(http2Sessions_); i != std::end(http2Sessions_);) {
+    auto& session = (*i).second;
+    if (http2SessionTimeout(*session)) {
+      i = http2Sessions_.erase(i);
+      continue;
+    }
+    if (session->countStream() == 0) {
+      recvIdleHttp2Session(*session);
+    }
+    if (!session->isOpen()) {
+      i = http2Sessions_.erase(i);
+      continue;
+    }
+    ++i;
+  }
+  A2_LOG_DEBUG(fmt("%lu HTTP/2 sessions removed.",
+                   static_cast<unsigned long>(numSessions -
+                                              http2Sessions_.size())));
 }
 
 std::shared_ptr<SocketCore>
@@ -458,13 +536,9 @@ DownloadEngine::popPooledSocket(const std::string& ipaddr, uint16_t port,
                                 const std::string& proxyhost,
                                 uint16_t proxyport)
 {
-  std::shared_ptr<SocketCore> s;
-  auto i = findSocketPoolEntry(
-      createSockPoolKey(ipaddr, port, A2STR::NIL, proxyhost, proxyport));
-  if (i != socketPool_.end()) {
-    s = (*i).second.getSocket();
-    socketPool_.erase(i);
-  }
+  auto s = socketPool_->pop(
+      SocketPool::Key(ipaddr, port, A2STR::NIL, proxyhost, proxyport));
+  socketPool_->countLookup(s != nullptr);
   return s;
 }
 
@@ -474,14 +548,9 @@ DownloadEngine::popPooledSocket(std::string& options, const std::string& ipaddr,
                                 const std::string& proxyhost,
                                 uint16_t proxyport)
 {
-  std::shared_ptr<SocketCore> s;
-  auto i = findSocketPoolEntry(
-      createSockPoolKey(ipaddr, port, username, proxyhost, proxyport));
-  if (i != socketPool_.end()) {
-    s = (*i).second.getSocket();
-    options = (*i).second.getOptions();
-    socketPool_.erase(i);
-  }
+  auto s = socketPool_->pop(
+      SocketPool::Key(ipaddr, port, username, proxyhost, proxyport), &options);
+  socketPool_->countLookup(s != nullptr);
   return s;
 }
 
@@ -491,11 +560,12 @@ DownloadEngine::popPooledSocket(const std::vector<std::string>& ipaddrs,
 {
   std::shared_ptr<SocketCore> s;
   for (const auto& ipaddr : ipaddrs) {
-    s = popPooledSocket(ipaddr, port, A2STR::NIL, 0);
+    s = socketPool_->pop(SocketPool::Key(ipaddr, port));
     if (s) {
       break;
     }
   }
+  socketPool_->countLookup(s != nullptr);
   return s;
 }
 
@@ -506,34 +576,15 @@ DownloadEngine::popPooledSocket(std::string& options,
 {
   std::shared_ptr<SocketCore> s;
   for (const auto& ipaddr : ipaddrs) {
-    s = popPooledSocket(options, ipaddr, port, username, A2STR::NIL, 0);
+    s = socketPool_->pop(SocketPool::Key(ipaddr, port, username), &options);
     if (s) {
       break;
     }
   }
+  socketPool_->countLookup(s != nullptr);
   return s;
 }
 
-DownloadEngine::SocketPoolEntry::SocketPoolEntry(
-    const std::shared_ptr<SocketCore>& socket, const std::string& options,
-    std::chrono::seconds timeout)
-    : socket_(socket), options_(options), timeout_(std::move(timeout))
-{
-}
-
-DownloadEngine::SocketPoolEntry::SocketPoolEntry(
-    const std::shared_ptr<SocketCore>& socket, std::chrono::seconds timeout)
-    : socket_(socket), timeout_(std::move(timeout))
-{
-}
-
-DownloadEngine::SocketPoolEntry::~SocketPoolEntry() = default;
-
-bool DownloadEngine::SocketPoolEntry::isTimeout() const
-{
-  return registeredTime_.difference(global::wallclock()) >= timeout_;
-}
-
 cuid_t DownloadEngine::newCUID() { return cuidCounter_.newID(); }
 
 const std::string&
@@ -583,6 +634,26 @@ void DownloadEngine::setRefreshInterval(std::chrono::milliseconds interval)
   refreshInterval_ = std::move(interval);
 }
 
+void DownloadEngine::sleepCommand(Command* command,
+                                  std::chrono::milliseconds timeout)
+{
+  auto deadline = global::wallclock();
+  deadline.advance(timeout);
+  timerWheel_->schedule(command, deadline);
+}
+
+void DownloadEngine::wakeUpSleepingCommandsIfNecessary()
+{
+  auto stateSerial =
+      requestGroupMan_ ? requestGroupMan_->getStateSerial() : 0;
+  if (refreshInterval_ == std::chrono::milliseconds(0) || haltRequested_ ||
+      stateSerial != lastStateSerial_ ||
+      (requestGroupMan_ && requestGroupMan_->downloadFinished())) {
+    timerWheel_->clear();
+  }
+  lastStateSerial_ = stateSerial;
+}
+
 void DownloadEngine::addCommand(std::vector<std::unique_ptr<Command>> commands)
 {
   commands_.insert(commands_.end(),
@@ -612,6 +683,35 @@ void DownloadEngine::setCheckIntegrityMan(
   checkIntegrityMan_ = std::move(ciman);
 }
 
+#ifdef ENABLE_THREADS
+ThreadPool* DownloadEngine::getThreadPool()
+{
+  if (!threadPool_) {
+    threadPool_ = make_unique<ThreadPool>(numCheckIntegrityThreads_);
+  }
+  return threadPool_.get();
+}
+
+void DownloadEngine::setNumCheckIntegrityThreads(size_t numThreads)
+{
+  numCheckIntegrityThreads_ = numThreads;
+}
+
+ThreadPool* DownloadEngine::getFileAllocationThreadPool()
+{
+  if (!fileAllocationThreadPool_) {
+    fileAllocationThreadPool_ =
+        make_unique<ThreadPool>(numFileAllocationThreads_);
+  }
+  return fileAllocationThreadPool_.get();
+}
+
+void DownloadEngine::setNumFileAllocationThreads(size_t numThreads)
+{
+  numFileAllocationThreads_ = numThreads;
+}
+#endif // ENABLE_THREADS
+
 #ifdef HAVE_ARES_ADDR_NODE
 void DownloadEngine::setAsyncDNSServers(ares_addr_node* asyncDNSServers)
 {
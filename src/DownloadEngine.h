@@ -65,6 +65,12 @@ class AuthConfigFactory;
 class Request;
 class EventPoll;
 class Command;
+class Http2Session;
+class SocketPool;
+class TimerWheel;
+#ifdef ENABLE_THREADS
+class ThreadPool;
+#endif // ENABLE_THREADS
 #ifdef ENABLE_BITTORRENT
 class BtRegistry;
 #endif // ENABLE_BITTORRENT
@@ -93,42 +99,25 @@ private:
 
   int haltRequested_;
 
-  class SocketPoolEntry {
-  private:
-    std::shared_ptr<SocketCore> socket_;
-    // protocol specific option string
-    std::string options_;
+  // true if this engine is a worker shard of EngineShardMan.  The
+  // worker shards leave the stop signals to the primary engine.
+  bool shard_;
 
-    std::chrono::seconds timeout_;
+  std::unique_ptr<SocketPool> socketPool_;
 
-    Timer registeredTime_;
-
-  public:
-    SocketPoolEntry(const std::shared_ptr<SocketCore>& socket,
-                    const std::string& option, std::chrono::seconds timeout);
-
-    SocketPoolEntry(const std::shared_ptr<SocketCore>& socket,
-                    std::chrono::seconds timeout);
-
-    ~SocketPoolEntry();
-
-    bool isTimeout() const;
-
-    const std::shared_ptr<SocketCore>& getSocket() const { return socket_; }
-
-    const std::string& getOptions() const { return options_; }
-  };
-
-  // key = IP address:port, value = SocketPoolEntry
-  std::multimap<std::string, SocketPoolEntry> socketPool_;
-
-  Timer lastSocketPoolScan_;
+  // key = hostname:port
+  std::multimap<std::string, std::shared_ptr<Http2Session>> http2Sessions_;
 
   bool noWait_;
 
   std::chrono::milliseconds refreshInterval_;
   Timer lastRefresh_;
 
+  // Sleeping commands.  See sleepCommand().
+  std::unique_ptr<TimerWheel> timerWheel_;
+  // RequestGroupMan::getStateSerial() seen at the last refresh.
+  uint64_t lastStateSerial_;
+
   std::unique_ptr<CookieStorage> cookieStorage_;
 
 #ifdef ENABLE_BITTORRENT
@@ -158,11 +147,22 @@ private:
 
   void afterEachIteration();
 
-  void poolSocket(const std::string& key, const SocketPoolEntry& entry);
-
-  std::multimap<std::string, SocketPoolEntry>::iterator
-  findSocketPoolEntry(const std::string& key);
-
+  // Wakes up all sleeping commands if something happened which they
+  // should notice.
+  void wakeUpSleepingCommandsIfNecessary();
+
+#ifdef ENABLE_THREADS
+  // Declared before the objects which may have jobs in it, so that
+  // it is destroyed after them.  Created on the first integrity
+  // check.
+  std::unique_ptr<ThreadPool> threadPool_;
+  size_t numCheckIntegrityThreads_;
+  // Separated from threadPool_ because a file allocation job keeps a
+  // worker until the whole file is allocated.  Created on the first
+  // file allocation.
+  std::unique_ptr<ThreadPool> fileAllocationThreadPool_;
+  size_t numFileAllocationThreads_;
+#endif // ENABLE_THREADS
   std::unique_ptr<RequestGroupMan> requestGroupMan_;
   std::unique_ptr<FileAllocationMan> fileAllocationMan_;
   std::unique_ptr<CheckIntegrityMan> checkIntegrityMan_;
@@ -195,6 +195,12 @@ public:
   bool deleteSocketForWriteCheck(const std::shared_ptr<SocketCore>& socket,
                                  Command* command);
 
+  // Same as addSocketForReadCheck() and deleteSocketForReadCheck(),
+  // but take a file descriptor which is not necessarily a socket,
+  // such as eventfd.
+  bool addFdForReadCheck(sock_t fd, Command* command);
+  bool deleteFdForReadCheck(sock_t fd, Command* command);
+
 #ifdef ENABLE_ASYNC_DNS
 
   bool addNameResolverCheck(const std::shared_ptr<AsyncNameResolver>& resolver,
@@ -229,6 +235,20 @@ public:
 
   void setCheckIntegrityMan(std::unique_ptr<CheckIntegrityMan> ciman);
 
+#ifdef ENABLE_THREADS
+  // Returns the pool which hashes pieces during integrity checks.
+  // Its threads are started on the first call.
+  ThreadPool* getThreadPool();
+
+  void setNumCheckIntegrityThreads(size_t numThreads);
+
+  // Returns the pool which allocates files.  Its threads are started
+  // on the first call.
+  ThreadPool* getFileAllocationThreadPool();
+
+  void setNumFileAllocationThreads(size_t numThreads);
+#endif // ENABLE_THREADS
+
   Option* getOption() const { return option_; }
 
   void setOption(Option* op) { option_ = op; }
@@ -243,6 +263,8 @@ public:
 
   void requestForceHalt();
 
+  void setShard(bool f) { shard_ = f; }
+
   void setNoWait(bool b);
 
   void addRoutineCommand(std::unique_ptr<Command> command);
@@ -289,6 +311,26 @@ public:
 
   void evictSocketPool();
 
+  const std::unique_ptr<SocketPool>& getSocketPool() const
+  {
+    return socketPool_;
+  }
+
+  // Registers HTTP/2 session connected to hostname:port, so that the
+  // following requests to the server are sent through it.
+  void addHttp2Session(const std::string& hostname, uint16_t port,
+                       std::shared_ptr<Http2Session> session);
+
+  // Returns HTTP/2 session connected to hostname:port which accepts
+  // a new request, or nullptr.  Only the sessions of hostname:port
+  // are examined.
+  std::shared_ptr<Http2Session> findHttp2Session(const std::string& hostname,
+                                                 uint16_t port);
+
+  // Removes the broken HTTP/2 sessions and the ones idle for too
+  // long.
+  void evictHttp2Sessions();
+
   const std::unique_ptr<CookieStorage>& getCookieStorage() const;
 
 #ifdef ENABLE_BITTORRENT
@@ -324,6 +366,15 @@ public:
 
   void setRefreshInterval(std::chrono::milliseconds interval);
 
+  // Lets |command| sleep for |timeout|.  The sleeping command is
+  // skipped when all commands are executed every refresh interval,
+  // and it is executed when its socket becomes ready or |timeout|
+  // elapses.  All sleeping commands are woken up by
+  // setRefreshInterval(0), halt request and the state change of any
+  // RequestGroup, so that they notice them.  The sleep is cancelled
+  // when the command is executed.
+  void sleepCommand(Command* command, std::chrono::milliseconds timeout);
+
   const std::string getSessionId() const { return sessionId_; }
 
 #ifdef HAVE_ARES_ADDR_NODE
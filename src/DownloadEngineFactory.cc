@@ -64,6 +64,9 @@
 #ifdef HAVE_EPOLL
 #include "EpollEventPoll.h"
 #endif // HAVE_EPOLL
+#ifdef HAVE_IO_URING
+#include "IoUringEventPoll.h"
+#endif // HAVE_IO_URING
 #ifdef HAVE_PORT_ASSOCIATE
 #include "PortEventPoll.h"
 #endif // HAVE_PORT_ASSOCIATE
@@ -109,6 +112,27 @@ std::unique_ptr<EventPoll> createEventPoll(Option* op)
   }
   else
 #endif // HAVE_EPLL
+#ifdef HAVE_IO_URING
+      if (pollMethod == V_IO_URING) {
+    auto ep = make_unique<IoUringEventPoll>();
+    if (ep->good()) {
+      return std::move(ep);
+    }
+#ifdef HAVE_EPOLL
+    // io_uring is often disabled by seccomp filters, containers or
+    // kernel.io_uring_disabled.  epoll is always there on Linux.
+    A2_LOG_WARN("Initializing IoUringEventPoll failed."
+                " Falling back to epoll.");
+    auto epp = make_unique<EpollEventPoll>();
+    if (epp->good()) {
+      return std::move(epp);
+    }
+#endif // HAVE_EPOLL
+    throw DL_ABORT_EX("Initializing IoUringEventPoll failed."
+                      " Try --event-poll=select");
+  }
+  else
+#endif // HAVE_IO_URING
 #ifdef HAVE_KQUEUE
       if (pollMethod == V_KQUEUE) {
     auto kp = make_unique<KqueueEventPoll>();
@@ -143,10 +167,12 @@ std::unique_ptr<EventPoll> createEventPoll(Option* op)
   assert(0);
   return nullptr;
 }
-} // namespace
 
-std::unique_ptr<DownloadEngine> DownloadEngineFactory::newDownloadEngine(
-    Option* op, std::vector<std::shared_ptr<RequestGroup>> requestGroups)
+// Creates DownloadEngine with the parts which the primary engine and
+// the worker shards have in common.
+std::unique_ptr<DownloadEngine>
+createDownloadEngine(Option* op,
+                     std::vector<std::shared_ptr<RequestGroup>> requestGroups)
 {
   const size_t MAX_CONCURRENT_DOWNLOADS =
       op->getAsInt(PREF_MAX_CONCURRENT_DOWNLOADS);
@@ -158,8 +184,24 @@ std::unique_ptr<DownloadEngine> DownloadEngineFactory::newDownloadEngine(
     requestGroupMan->initWrDiskCache();
     e->setRequestGroupMan(std::move(requestGroupMan));
   }
+#ifdef ENABLE_THREADS
+  {
+    // Files are allocated by worker threads, one download per thread.
+    const size_t numThreads = op->getAsInt(PREF_FILE_ALLOCATION_THREADS);
+    e->setNumFileAllocationThreads(numThreads);
+    e->setFileAllocationMan(make_unique<FileAllocationMan>(numThreads));
+  }
+  {
+    // Pieces are hashed by worker threads.  Up to the same number of
+    // downloads are verified at the same time.
+    const size_t numThreads = op->getAsInt(PREF_CHECK_INTEGRITY_THREADS);
+    e->setNumCheckIntegrityThreads(numThreads);
+    e->setCheckIntegrityMan(make_unique<CheckIntegrityMan>(numThreads));
+  }
+#else  // !ENABLE_THREADS
   e->setFileAllocationMan(make_unique<FileAllocationMan>());
   e->setCheckIntegrityMan(make_unique<CheckIntegrityMan>());
+#endif // !ENABLE_THREADS
   e->addRoutineCommand(
       make_unique<FillRequestGroupCommand>(e->newCUID(), e.get()));
   e->addRoutineCommand(make_unique<FileAllocationDispatcherCommand>(
@@ -174,6 +216,14 @@ std::unique_ptr<DownloadEngine> DownloadEngineFactory::newDownloadEngine(
         e->newCUID(), e.get(),
         std::chrono::seconds(op->getAsInt(PREF_AUTO_SAVE_INTERVAL))));
   }
+  return e;
+}
+} // namespace
+
+std::unique_ptr<DownloadEngine> DownloadEngineFactory::newDownloadEngine(
+    Option* op, std::vector<std::shared_ptr<RequestGroup>> requestGroups)
+{
+  auto e = createDownloadEngine(op, std::move(requestGroups));
   if (op->getAsInt(PREF_SAVE_SESSION_INTERVAL) > 0) {
     e->addRoutineCommand(make_unique<SaveSessionCommand>(
         e->newCUID(), e.get(),
@@ -222,4 +272,17 @@ std::unique_ptr<DownloadEngine> DownloadEngineFactory::newDownloadEngine(
   return e;
 }
 
+#ifdef ENABLE_THREADS
+std::unique_ptr<DownloadEngine>
+DownloadEngineFactory::newShardEngine(Option* op)
+{
+  auto e = createDownloadEngine(op, {});
+  e->setShard(true);
+  // The worker shard waits for downloads from the primary engine
+  // until it is halted.
+  e->getRequestGroupMan()->setKeepRunning(true);
+  return e;
+}
+#endif // ENABLE_THREADS
+
 } // namespace aria2
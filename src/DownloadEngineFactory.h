@@ -53,6 +53,12 @@ public:
   std::unique_ptr<DownloadEngine>
   newDownloadEngine(Option* op,
                     std::vector<std::shared_ptr<RequestGroup>> requestGroups);
+
+#ifdef ENABLE_THREADS
+  // Creates the engine of a worker shard of EngineShardMan.  It has no
+  // download initially, and keeps running until it is halted.
+  std::unique_ptr<DownloadEngine> newShardEngine(Option* op);
+#endif // ENABLE_THREADS
 };
 
 } // namespace aria2
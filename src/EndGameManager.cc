@@ -0,0 +1,134 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "EndGameManager.h"
+
+#include <algorithm>
+
+namespace aria2 {
+
+const size_t EndGameManager::FAST_PEER_REDUNDANCY;
+
+const size_t EndGameManager::SLOW_PEER_REDUNDANCY;
+
+EndGameManager::EndGameManager() : wastedLength_(0) {}
+
+EndGameManager::~EndGameManager() = default;
+
+void EndGameManager::addRequest(cuid_t cuid, size_t index, size_t blockIndex)
+{
+  auto& cuids = requests_[std::make_pair(index, blockIndex)];
+  if (std::find(std::begin(cuids), std::end(cuids), cuid) == std::end(cuids)) {
+    cuids.push_back(cuid);
+  }
+}
+
+void EndGameManager::removeRequest(cuid_t cuid, size_t index,
+                                   size_t blockIndex)
+{
+  auto i = requests_.find(std::make_pair(index, blockIndex));
+  if (i == std::end(requests_)) {
+    return;
+  }
+  auto& cuids = (*i).second;
+  cuids.erase(std::remove(std::begin(cuids), std::end(cuids), cuid),
+              std::end(cuids));
+  if (cuids.empty()) {
+    requests_.erase(i);
+  }
+}
+
+void EndGameManager::removeConnection(cuid_t cuid)
+{
+  for (auto i = std::begin(requests_); i != std::end(requests_);) {
+    auto& cuids = (*i).second;
+    cuids.erase(std::remove(std::begin(cuids), std::end(cuids), cuid),
+                std::end(cuids));
+    if (cuids.empty()) {
+      requests_.erase(i++);
+    }
+    else {
+      ++i;
+    }
+  }
+  speeds_.erase(cuid);
+  cancelRequired_.erase(cuid);
+}
+
+size_t EndGameManager::countRequest(size_t index, size_t blockIndex) const
+{
+  auto i = requests_.find(std::make_pair(index, blockIndex));
+  if (i == std::end(requests_)) {
+    return 0;
+  }
+  return (*i).second.size();
+}
+
+size_t EndGameManager::getRedundancyLimit(cuid_t cuid, int downloadSpeed)
+{
+  speeds_[cuid] = downloadSpeed;
+  if (downloadSpeed == 0) {
+    return SLOW_PEER_REDUNDANCY;
+  }
+  int64_t total = 0;
+  for (auto& kv : speeds_) {
+    total += kv.second;
+  }
+  if (downloadSpeed * static_cast<int64_t>(speeds_.size()) >= total) {
+    return FAST_PEER_REDUNDANCY;
+  }
+  return SLOW_PEER_REDUNDANCY;
+}
+
+void EndGameManager::onBlockReceived(cuid_t cuid, size_t index,
+                                     size_t blockIndex)
+{
+  auto i = requests_.find(std::make_pair(index, blockIndex));
+  if (i == std::end(requests_)) {
+    return;
+  }
+  for (auto c : (*i).second) {
+    if (c != cuid) {
+      cancelRequired_.insert(c);
+    }
+  }
+  requests_.erase(i);
+}
+
+bool EndGameManager::popCancelRequired(cuid_t cuid)
+{
+  return cancelRequired_.erase(cuid);
+}
+
+} // namespace aria2
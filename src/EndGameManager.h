@@ -0,0 +1,112 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_END_GAME_MANAGER_H
+#define D_END_GAME_MANAGER_H
+
+#include "common.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "cuid.h"
+
+namespace aria2 {
+
+// Keeps track of the outstanding requests of each block in end game
+// mode, where the same block may be requested from several peers.
+// It limits how many peers a block is requested from, and tells the
+// other connections to cancel their requests as soon as a block is
+// received.  It also counts the bytes of the received blocks which
+// were thrown away.
+class EndGameManager {
+public:
+  EndGameManager();
+
+  ~EndGameManager();
+
+  // Records that the connection |cuid| requested the block
+  // |blockIndex| of the piece |index|.
+  void addRequest(cuid_t cuid, size_t index, size_t blockIndex);
+
+  void removeRequest(cuid_t cuid, size_t index, size_t blockIndex);
+
+  // Removes all requests and the state of the connection |cuid|.
+  void removeConnection(cuid_t cuid);
+
+  // Returns the number of connections which requested the block.
+  size_t countRequest(size_t index, size_t blockIndex) const;
+
+  // Records |downloadSpeed| of the connection |cuid| and returns the
+  // number of outstanding requests a block can have for |cuid| to
+  // request it too.  A connection at least as fast as the average of
+  // the connections in end game mode is allowed to duplicate
+  // requests up to FAST_PEER_REDUNDANCY.  Slower connections only
+  // get the blocks nobody requested.
+  size_t getRedundancyLimit(cuid_t cuid, int downloadSpeed);
+
+  // Called when the block was received from the connection |cuid|.
+  // The other connections which requested the block are marked so
+  // that they cancel their requests.
+  void onBlockReceived(cuid_t cuid, size_t index, size_t blockIndex);
+
+  // Returns true if the connection |cuid| has requests to cancel
+  // because the blocks were received from other connections.  The
+  // mark is cleared.
+  bool popCancelRequired(cuid_t cuid);
+
+  // Adds |length| bytes of block data which were received but thrown
+  // away, because the block had already been received or was not
+  // requested.
+  void addWastedLength(int32_t length) { wastedLength_ += length; }
+
+  int64_t getWastedLength() const { return wastedLength_; }
+
+  static const size_t FAST_PEER_REDUNDANCY = 3;
+
+  static const size_t SLOW_PEER_REDUNDANCY = 1;
+
+private:
+  // (piece index, block index) -> connections which requested it
+  std::map<std::pair<size_t, size_t>, std::vector<cuid_t>> requests_;
+  // connection -> download speed
+  std::map<cuid_t, int> speeds_;
+  std::set<cuid_t> cancelRequired_;
+  int64_t wastedLength_;
+};
+
+} // namespace aria2
+
+#endif // D_END_GAME_MANAGER_H
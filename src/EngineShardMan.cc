@@ -0,0 +1,313 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "EngineShardMan.h"
+
+#ifndef __MINGW32__
+#include <signal.h>
+#endif // !__MINGW32__
+
+#include <cassert>
+#include <iterator>
+
+#include "DownloadEngine.h"
+#include "DownloadEngineFactory.h"
+#include "EngineTaskCommand.h"
+#include "RequestGroupMan.h"
+#include "RequestGroup.h"
+#include "DownloadContext.h"
+#include "DownloadResult.h"
+#include "GroupId.h"
+#include "WrDiskCache.h"
+#include "CookieStorage.h"
+#include "Cookie.h"
+#include "ServerStatMan.h"
+#include "SimpleRandomizer.h"
+#include "TimeA2.h"
+#include "RecoverableException.h"
+#include "LogFactory.h"
+#include "message.h"
+#include "fmt.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+struct EngineShardMan::Shard {
+  Shard(size_t index)
+      : index(index), numGroup(0), downloadSpeed(0), uploadSpeed(0)
+  {
+  }
+
+  size_t index;
+  EngineTaskQueue taskQueue;
+  // The worker engine.  nullptr for the primary engine.
+  std::unique_ptr<DownloadEngine> e;
+  std::thread thread;
+  // The number of downloads handed to this shard.  Only the primary
+  // engine thread touches this.
+  size_t numGroup;
+  std::atomic<int> downloadSpeed;
+  std::atomic<int> uploadSpeed;
+};
+
+EngineShardMan::EngineShardMan(size_t numShards, Option* option,
+                               std::function<void(DownloadEngine*)> setupEngine)
+    : option_(option),
+      setupEngine_(std::move(setupEngine)),
+      e_(nullptr),
+      diskCacheTotal_(0),
+      numGroup_(0),
+      nextShard_(1)
+{
+  assert(numShards > 0);
+  for (size_t i = 0; i < numShards; ++i) {
+    shards_.push_back(make_unique<Shard>(i));
+  }
+}
+
+EngineShardMan::~EngineShardMan() { join(); }
+
+void EngineShardMan::start(DownloadEngine* e)
+{
+  e_ = e;
+  // The shards share the randomizer.  Create it before they start.
+  SimpleRandomizer::getInstance();
+  // Create all worker engines first, so that nothing is left running
+  // if one of them fails.
+  for (size_t i = 1; i < shards_.size(); ++i) {
+    auto& shard = shards_[i];
+    shard->e = DownloadEngineFactory().newShardEngine(option_);
+    setupEngine_(shard->e.get());
+  }
+  for (auto& shard : shards_) {
+    auto se = shard->e ? shard->e.get() : e_;
+    auto& rgman = se->getRequestGroupMan();
+    rgman->setEngineShardMan(this, shard->index);
+    if (rgman->getWrDiskCache()) {
+      rgman->getWrDiskCache()->shareTotal(&diskCacheTotal_);
+    }
+    se->addCommand(
+        make_unique<EngineTaskCommand>(se->newCUID(), se, &shard->taskQueue));
+  }
+#ifndef __MINGW32__
+  // Signals are handled by the primary engine.
+  sigset_t all, old;
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+#endif // !__MINGW32__
+  for (size_t i = 1; i < shards_.size(); ++i) {
+    shards_[i]->thread =
+        std::thread(&EngineShardMan::run, this, shards_[i].get());
+  }
+#ifndef __MINGW32__
+  pthread_sigmask(SIG_SETMASK, &old, nullptr);
+#endif // !__MINGW32__
+  A2_LOG_INFO(fmt("Started %lu engine shards.",
+                  static_cast<unsigned long>(shards_.size())));
+}
+
+void EngineShardMan::run(Shard* shard)
+{
+  try {
+    shard->e->run();
+  }
+  catch (RecoverableException& ex) {
+    A2_LOG_ERROR_EX(EX_EXCEPTION_CAUGHT, ex);
+  }
+}
+
+void EngineShardMan::join()
+{
+  for (auto& shard : shards_) {
+    if (shard->thread.joinable()) {
+      shard->taskQueue.push([](DownloadEngine* e) { e->requestHalt(); });
+    }
+  }
+  for (auto& shard : shards_) {
+    if (shard->thread.joinable()) {
+      shard->thread.join();
+    }
+  }
+}
+
+void EngineShardMan::stop()
+{
+  join();
+  if (!e_) {
+    return;
+  }
+  // Run the tasks which came after EngineTaskCommand of the primary
+  // engine exited.
+  std::vector<EngineTask> tasks;
+  shards_[0]->taskQueue.popAll(tasks);
+  for (auto& task : tasks) {
+    task(e_);
+  }
+  auto now = Time().getTimeFromEpoch();
+  for (size_t i = 1; i < shards_.size(); ++i) {
+    auto& se = shards_[i]->e;
+    if (!se) {
+      continue;
+    }
+    std::vector<const Cookie*> cookies;
+    se->getCookieStorage()->dumpCookie(std::back_inserter(cookies));
+    for (auto c : cookies) {
+      e_->getCookieStorage()->store(make_unique<Cookie>(*c), now);
+    }
+    e_->getRequestGroupMan()->getServerStatMan()->merge(
+        *se->getRequestGroupMan()->getServerStatMan());
+  }
+  e_->getRequestGroupMan()->setEngineShardMan(nullptr, 0);
+  e_ = nullptr;
+}
+
+size_t EngineShardMan::selectShard(const std::shared_ptr<RequestGroup>& group,
+                                   size_t numLocal)
+{
+#ifdef ENABLE_BITTORRENT
+  if (group->getDownloadContext()->hasAttribute(CTX_ATTR_BT)) {
+    return 0;
+  }
+#endif // ENABLE_BITTORRENT
+  size_t numWorker = shards_.size() - 1;
+  size_t best = 0;
+  size_t bestLoad = numLocal;
+  for (size_t i = 0; i < numWorker; ++i) {
+    auto& shard = shards_[1 + (nextShard_ - 1 + i) % numWorker];
+    if (shard->numGroup < bestLoad) {
+      best = shard->index;
+      bestLoad = shard->numGroup;
+    }
+  }
+  if (best != 0) {
+    nextShard_ = best % numWorker + 1;
+  }
+  return best;
+}
+
+void EngineShardMan::assign(size_t shard, std::shared_ptr<RequestGroup> group)
+{
+  assert(shard > 0 && shard < shards_.size());
+  A2_LOG_DEBUG(fmt("GID#%s is handed to engine shard %lu.",
+                   GroupId::toHex(group->getGID()).c_str(),
+                   static_cast<unsigned long>(shard)));
+  ++shards_[shard]->numGroup;
+  ++numGroup_;
+  shards_[shard]->taskQueue.push([group](DownloadEngine* e) {
+    e->getRequestGroupMan()->startRequestGroup(group, e);
+    e->setNoWait(true);
+    e->setRefreshInterval(std::chrono::milliseconds(0));
+  });
+}
+
+void EngineShardMan::halt()
+{
+  for (size_t i = 1; i < shards_.size(); ++i) {
+    shards_[i]->taskQueue.push([](DownloadEngine* e) {
+      e->requestHalt();
+      e->setNoWait(true);
+      e->setRefreshInterval(std::chrono::milliseconds(0));
+    });
+  }
+}
+
+void EngineShardMan::forceHalt()
+{
+  for (size_t i = 1; i < shards_.size(); ++i) {
+    shards_[i]->taskQueue.push([](DownloadEngine* e) {
+      e->requestForceHalt();
+      e->setNoWait(true);
+      e->setRefreshInterval(std::chrono::milliseconds(0));
+    });
+  }
+}
+
+void EngineShardMan::postStopped(
+    size_t shard, size_t numStopped,
+    std::vector<std::shared_ptr<DownloadResult>> results,
+    std::vector<std::shared_ptr<RequestGroup>> nextGroups)
+{
+  shards_[0]->taskQueue.push([this, shard, numStopped, results,
+                              nextGroups](DownloadEngine* e) {
+    auto& s = shards_[shard];
+    assert(s->numGroup >= numStopped);
+    s->numGroup -= numStopped;
+    numGroup_ -= numStopped;
+    auto& rgman = e->getRequestGroupMan();
+    for (size_t i = 0; i < numStopped; ++i) {
+      rgman->decreaseNumActive();
+    }
+    for (auto& dr : results) {
+      rgman->addDownloadResult(dr);
+    }
+    rgman->insertReservedGroup(0, nextGroups);
+    e->setNoWait(true);
+    e->setRefreshInterval(std::chrono::milliseconds(0));
+  });
+}
+
+int EngineShardMan::updateDownloadSpeed(size_t shard, int speed)
+{
+  shards_[shard]->downloadSpeed.store(speed, std::memory_order_relaxed);
+  int total = 0;
+  for (auto& s : shards_) {
+    total += s->downloadSpeed.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+int EngineShardMan::updateUploadSpeed(size_t shard, int speed)
+{
+  shards_[shard]->uploadSpeed.store(speed, std::memory_order_relaxed);
+  int total = 0;
+  for (auto& s : shards_) {
+    total += s->uploadSpeed.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+bool EngineShardMan::doesDownloadSpeedExceed(size_t shard, int speed,
+                                             int limit)
+{
+  return limit < updateDownloadSpeed(shard, speed) &&
+         limit / static_cast<int>(shards_.size()) < speed;
+}
+
+bool EngineShardMan::doesUploadSpeedExceed(size_t shard, int speed, int limit)
+{
+  return limit < updateUploadSpeed(shard, speed) &&
+         limit / static_cast<int>(shards_.size()) < speed;
+}
+
+} // namespace aria2
@@ -0,0 +1,163 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_ENGINE_SHARD_MAN_H
+#define D_ENGINE_SHARD_MAN_H
+
+#include "common.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "EngineTaskQueue.h"
+
+namespace aria2 {
+
+class DownloadEngine;
+class Option;
+class RequestGroup;
+struct DownloadResult;
+
+// Runs downloads on several DownloadEngines, one thread each, so that
+// the event loop is not bound to one CPU core (--engine-shards).
+// Shard 0 is the primary engine, which runs in the calling thread
+// and owns the download queue.  Its RequestGroupMan hands the
+// downloads to the worker shards 1..N-1 when they start and takes
+// their results back when they stop.  Each worker shard has its own
+// EventPoll, commands, socket pool, DNS cache, cookies and server
+// stats.  The shards share the disk cache limit and the overall speed
+// limits.
+//
+// BitTorrent downloads stay in the primary engine, because the
+// listening port, DHT and the peer registry are per process.
+class EngineShardMan {
+public:
+  // |numShards| includes the primary engine.  |setupEngine| is called
+  // for each worker engine before its thread starts, to load the
+  // cookies, netrc and so on.
+  EngineShardMan(size_t numShards, Option* option,
+                 std::function<void(DownloadEngine*)> setupEngine);
+
+  ~EngineShardMan();
+
+  EngineShardMan(const EngineShardMan&) = delete;
+  EngineShardMan& operator=(const EngineShardMan&) = delete;
+
+  // Creates the worker engines and starts their threads.  From now
+  // on, the RequestGroupMan of |e|, the primary engine, hands
+  // downloads to them.
+  void start(DownloadEngine* e);
+
+  // Halts the worker shards and waits for their threads to finish.
+  // Then merges their cookies and server stats into the primary
+  // engine.  Call this after DownloadEngine::run() of the primary
+  // engine returned.
+  void stop();
+
+  size_t getNumShard() const { return shards_.size(); }
+
+  // Returns the shard which should run |group|, that is the one with
+  // the fewest downloads.  0 means the primary engine.  |numLocal| is
+  // the number of downloads running in the primary engine.
+  size_t selectShard(const std::shared_ptr<RequestGroup>& group,
+                     size_t numLocal);
+
+  // Hands |group| to the worker shard |shard| and starts it there.
+  // The primary engine must not touch |group| after this call until
+  // it comes back.
+  void assign(size_t shard, std::shared_ptr<RequestGroup> group);
+
+  // Returns the number of downloads running in the worker shards.
+  size_t countGroup() const { return numGroup_; }
+
+  void halt();
+
+  void forceHalt();
+
+  // Called in the thread of the worker shard |shard| when
+  // |numStopped| downloads stopped there.  |results| and the
+  // downloads created by them, |nextGroups|, are added to the primary
+  // engine.
+  void postStopped(size_t shard, size_t numStopped,
+                   std::vector<std::shared_ptr<DownloadResult>> results,
+                   std::vector<std::shared_ptr<RequestGroup>> nextGroups);
+
+  // Records |speed| as the current download speed of |shard|, and
+  // returns the sum of the download speeds of all shards.  This
+  // function can be called from any thread.
+  int updateDownloadSpeed(size_t shard, int speed);
+
+  // Same as updateDownloadSpeed(), but for upload speed.
+  int updateUploadSpeed(size_t shard, int speed);
+
+  // Records |speed| as the current download speed of |shard|, and
+  // returns true if |shard| should be throttled to keep the sum of
+  // the download speeds under |limit|.  That is the case if the sum
+  // exceeds |limit| and |shard| uses more than its share of |limit|.
+  // Throttling only the shards above their share keeps a busy shard
+  // from starving the others.
+  bool doesDownloadSpeedExceed(size_t shard, int speed, int limit);
+
+  // Same as doesDownloadSpeedExceed(), but for upload speed.
+  bool doesUploadSpeedExceed(size_t shard, int speed, int limit);
+
+private:
+  struct Shard;
+
+  void run(Shard* shard);
+
+  // Requests halt to the worker shards and joins their threads.
+  void join();
+
+  Option* option_;
+  std::function<void(DownloadEngine*)> setupEngine_;
+  DownloadEngine* e_;
+  // The number of bytes held in the disk caches of all shards.
+  // Declared before shards_, so that it outlives their caches.
+  std::atomic<size_t> diskCacheTotal_;
+  // The number of downloads running in the worker shards.  Only the
+  // primary engine thread touches this.
+  size_t numGroup_;
+  // The worker shard examined first by selectShard(), so that ties
+  // are spread over the shards.
+  size_t nextShard_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace aria2
+
+#endif // D_ENGINE_SHARD_MAN_H
@@ -0,0 +1,108 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "EngineTaskCommand.h"
+
+#include <vector>
+
+#include "EngineTaskQueue.h"
+#include "DownloadEngine.h"
+#include "RequestGroupMan.h"
+#include "RecoverableException.h"
+#include "LogFactory.h"
+#include "message.h"
+
+namespace aria2 {
+
+EngineTaskCommand::EngineTaskCommand(cuid_t cuid, DownloadEngine* e,
+                                     EngineTaskQueue* queue)
+    : Command(cuid), e_(e), queue_(queue)
+{
+  auto fd = queue_->getWakeupFd();
+  if (fd == (sock_t)-1) {
+    setStatusRealtime();
+  }
+  else {
+    e_->addFdForReadCheck(fd, this);
+  }
+}
+
+EngineTaskCommand::~EngineTaskCommand()
+{
+  auto fd = queue_->getWakeupFd();
+  if (fd != (sock_t)-1) {
+    e_->deleteFdForReadCheck(fd, this);
+  }
+}
+
+bool EngineTaskCommand::execute()
+{
+  runTasks();
+  auto& rgman = e_->getRequestGroupMan();
+  // This command runs at least every refresh interval.  Keep the
+  // speed seen by the other shards up to date, even while this
+  // engine has nothing to download.
+  rgman->calculateOverallDownloadSpeed();
+  rgman->calculateOverallUploadSpeed();
+  if (rgman->downloadFinished()) {
+    return true;
+  }
+  if (e_->isHaltRequested()) {
+    // FillRequestGroupCommand is gone, so collect the stopped
+    // downloads here.  A worker shard passes their results to the
+    // primary engine in removeStoppedGroup().
+    rgman->removeStoppedGroup(e_);
+    if (rgman->countRequestGroup() == 0 && rgman->countShardedGroup() == 0) {
+      return true;
+    }
+  }
+  e_->addCommand(std::unique_ptr<Command>(this));
+  return false;
+}
+
+void EngineTaskCommand::runTasks()
+{
+  std::vector<EngineTask> tasks;
+  queue_->popAll(tasks);
+  for (auto& task : tasks) {
+    try {
+      task(e_);
+    }
+    catch (RecoverableException& ex) {
+      A2_LOG_ERROR_EX(EX_EXCEPTION_CAUGHT, ex);
+    }
+  }
+}
+
+} // namespace aria2
@@ -0,0 +1,86 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_ENGINE_TASK_QUEUE_H
+#define D_ENGINE_TASK_QUEUE_H
+
+#include "common.h"
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "WakeupFd.h"
+
+namespace aria2 {
+
+class DownloadEngine;
+
+typedef std::function<void(DownloadEngine*)> EngineTask;
+
+// The queue of the tasks posted to a DownloadEngine by the other
+// engine shards.  Any thread can push tasks, and the thread running
+// the DownloadEngine pops them.  The wakeup file descriptor, which is
+// watched by EngineTaskCommand, becomes readable when a task is
+// pushed.  Unlike ApiTaskQueue, the queue is not bounded, because
+// the tasks carry downloads and their results, which must not be
+// dropped.
+class EngineTaskQueue {
+public:
+  EngineTaskQueue();
+
+  EngineTaskQueue(const EngineTaskQueue&) = delete;
+  EngineTaskQueue& operator=(const EngineTaskQueue&) = delete;
+
+  // Appends |task| to the queue.  This function can be called from
+  // any thread.
+  void push(EngineTask task);
+
+  // Moves all queued tasks to the end of |tasks|.  Only the thread
+  // running the DownloadEngine may call this function.
+  void popAll(std::vector<EngineTask>& tasks);
+
+  // Returns the file descriptor which becomes readable when a task is
+  // pushed, or -1 if it is not available.
+  sock_t getWakeupFd() const { return wakeupFd_.getFd(); }
+
+private:
+  std::mutex mutex_;
+  std::vector<EngineTask> tasks_;
+  WakeupFd wakeupFd_;
+};
+
+} // namespace aria2
+
+#endif // D_ENGINE_TASK_QUEUE_H
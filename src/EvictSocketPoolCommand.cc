@@ -57,6 +57,7 @@ void EvictSocketPoolCommand::preProcess()
 void EvictSocketPoolCommand::process()
 {
   getDownloadEngine()->evictSocketPool();
+  getDownloadEngine()->evictHttp2Sessions();
 }
 
 } // namespace aria2
@@ -62,7 +62,8 @@ FileAllocationCommand::FileAllocationCommand(
 
 FileAllocationCommand::~FileAllocationCommand()
 {
-  getDownloadEngine()->getFileAllocationMan()->dropPickedEntry();
+  getDownloadEngine()->getFileAllocationMan()->dropPickedEntry(
+      fileAllocationEntry_);
 }
 
 bool FileAllocationCommand::executeInternal()
@@ -85,6 +86,14 @@ bool FileAllocationCommand::executeInternal()
     return true;
   }
   else {
+#ifdef ENABLE_THREADS
+    if (fileAllocationEntry_->allocatingInBackground() &&
+        timer_.difference(global::wallclock()) >= 1_s) {
+      // The allocation takes long.  Check the worker thread on the
+      // next refresh instead of in every iteration.
+      setStatusInactive();
+    }
+#endif // ENABLE_THREADS
     getDownloadEngine()->addCommand(std::unique_ptr<Command>(this));
     return false;
   }
@@ -54,6 +54,9 @@ FileAllocationDispatcherCommand::createCommand(FileAllocationEntry* entry)
 {
   cuid_t newCUID = getDownloadEngine()->newCUID();
   A2_LOG_INFO(fmt(MSG_FILE_ALLOCATION_DISPATCH, newCUID));
+#ifdef ENABLE_THREADS
+  entry->setThreadPool(getDownloadEngine()->getFileAllocationThreadPool());
+#endif // ENABLE_THREADS
   return make_unique<FileAllocationCommand>(newCUID, entry->getRequestGroup(),
                                             getDownloadEngine(), entry);
 }
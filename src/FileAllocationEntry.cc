@@ -38,6 +38,9 @@
 #include "RequestGroup.h"
 #include "PieceStorage.h"
 #include "DiskAdaptor.h"
+#ifdef ENABLE_THREADS
+#include "ThreadPool.h"
+#endif // ENABLE_THREADS
 
 namespace aria2 {
 
@@ -47,29 +50,96 @@ FileAllocationEntry::FileAllocationEntry(RequestGroup* requestGroup,
       fileAllocationIterator_{requestGroup->getPieceStorage()
                                   ->getDiskAdaptor()
                                   ->fileAllocationIterator()}
+#ifdef ENABLE_THREADS
+      ,
+      threadPool_{nullptr},
+      currentLength_{0},
+      totalLength_{0},
+      cancel_{false}
+#endif // ENABLE_THREADS
 {
 }
 
-FileAllocationEntry::~FileAllocationEntry() = default;
+FileAllocationEntry::~FileAllocationEntry()
+{
+#ifdef ENABLE_THREADS
+  if (job_.valid()) {
+    // The job stops after the current chunk.
+    cancel_ = true;
+    job_.wait();
+  }
+#endif // ENABLE_THREADS
+}
 
 int64_t FileAllocationEntry::getCurrentLength()
 {
+#ifdef ENABLE_THREADS
+  if (job_.valid()) {
+    return currentLength_;
+  }
+#endif // ENABLE_THREADS
   return fileAllocationIterator_->getCurrentLength();
 }
 
 int64_t FileAllocationEntry::getTotalLength()
 {
+#ifdef ENABLE_THREADS
+  if (job_.valid()) {
+    return totalLength_;
+  }
+#endif // ENABLE_THREADS
   return fileAllocationIterator_->getTotalLength();
 }
 
 bool FileAllocationEntry::finished()
 {
+#ifdef ENABLE_THREADS
+  if (job_.valid()) {
+    return false;
+  }
+#endif // ENABLE_THREADS
   return fileAllocationIterator_->finished();
 }
 
 void FileAllocationEntry::allocateChunk()
 {
+#ifdef ENABLE_THREADS
+  if (threadPool_) {
+    if (!job_.valid()) {
+      allocateInBackground();
+    }
+    else if (job_.wait_for(std::chrono::seconds(0)) ==
+             std::future_status::ready) {
+      // get() makes job_ invalid and rethrows the exception thrown in
+      // the job, if any.
+      job_.get();
+    }
+    return;
+  }
+#endif // ENABLE_THREADS
   fileAllocationIterator_->allocateChunk();
 }
 
+#ifdef ENABLE_THREADS
+void FileAllocationEntry::setThreadPool(ThreadPool* threadPool)
+{
+  threadPool_ = threadPool;
+}
+
+void FileAllocationEntry::allocateInBackground()
+{
+  currentLength_ = fileAllocationIterator_->getCurrentLength();
+  totalLength_ = fileAllocationIterator_->getTotalLength();
+  // The destructor waits for the job, so this outlives it.
+  job_ = threadPool_->submit([this] {
+    auto itr = fileAllocationIterator_.get();
+    while (!cancel_ && !itr->finished()) {
+      itr->allocateChunk();
+      totalLength_ = itr->getTotalLength();
+      currentLength_ = itr->getCurrentLength();
+    }
+  });
+}
+#endif // ENABLE_THREADS
+
 } // namespace aria2
@@ -39,6 +39,10 @@
 
 #include <vector>
 #include <memory>
+#ifdef ENABLE_THREADS
+#include <atomic>
+#include <future>
+#endif // ENABLE_THREADS
 
 #include "ProgressAwareEntry.h"
 
@@ -47,11 +51,26 @@ namespace aria2 {
 class FileAllocationIterator;
 class Command;
 class DownloadEngine;
+#ifdef ENABLE_THREADS
+class ThreadPool;
+#endif // ENABLE_THREADS
 
 class FileAllocationEntry : public RequestGroupEntry,
                             public ProgressAwareEntry {
 private:
   std::unique_ptr<FileAllocationIterator> fileAllocationIterator_;
+#ifdef ENABLE_THREADS
+  ThreadPool* threadPool_;
+  // Runs fileAllocationIterator_ to the end.  While it is valid,
+  // fileAllocationIterator_ must not be touched by this thread.
+  std::future<void> job_;
+  // Progress of job_, updated after each chunk.
+  std::atomic<int64_t> currentLength_;
+  std::atomic<int64_t> totalLength_;
+  std::atomic<bool> cancel_;
+
+  void allocateInBackground();
+#endif // ENABLE_THREADS
 
 public:
   FileAllocationEntry(
@@ -66,8 +85,21 @@ public:
 
   virtual bool finished() CXX11_OVERRIDE;
 
+  // Allocates next chunk.  If thread pool is set, the allocation is
+  // done by a worker thread and this function just starts it or
+  // checks whether it has finished.  The error in the worker thread
+  // is rethrown here.
   void allocateChunk();
 
+#ifdef ENABLE_THREADS
+  // Lets a worker thread in threadPool allocate the whole file.
+  void setThreadPool(ThreadPool* threadPool);
+
+  // Returns true if the allocation is in progress in a worker
+  // thread.
+  bool allocatingInBackground() const { return job_.valid(); }
+#endif // ENABLE_THREADS
+
   virtual void
   prepareForNextAction(std::vector<std::unique_ptr<Command>>& commands,
                        DownloadEngine* e) = 0;
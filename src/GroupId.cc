@@ -35,6 +35,9 @@
 #include "GroupId.h"
 
 #include <cassert>
+#ifdef ENABLE_THREADS
+#include <mutex>
+#endif // ENABLE_THREADS
 
 #include "util.h"
 
@@ -42,9 +45,21 @@ namespace aria2 {
 
 std::set<a2_gid_t> GroupId::set_;
 
+#ifdef ENABLE_THREADS
+namespace {
+// Guards set_.  GroupIds are created and destroyed by the engine
+// shards as well.
+std::mutex setMutex;
+} // namespace
+#define A2_LOCK_SET std::lock_guard<std::mutex> lock(setMutex)
+#else // !ENABLE_THREADS
+#define A2_LOCK_SET
+#endif // !ENABLE_THREADS
+
 std::shared_ptr<GroupId> GroupId::create()
 {
   a2_gid_t n;
+  A2_LOCK_SET;
   for (;;) {
     util::generateRandomData(reinterpret_cast<unsigned char*>(&n), sizeof(n));
     if (n != 0 && set_.count(n) == 0) {
@@ -58,6 +73,7 @@ std::shared_ptr<GroupId> GroupId::create()
 std::shared_ptr<GroupId> GroupId::import(a2_gid_t n)
 {
   std::shared_ptr<GroupId> res;
+  A2_LOCK_SET;
   if (n == 0 || set_.count(n) != 0) {
     return res;
   }
@@ -65,7 +81,11 @@ std::shared_ptr<GroupId> GroupId::import(a2_gid_t n)
   return res;
 }
 
-void GroupId::clear() { set_.clear(); }
+void GroupId::clear()
+{
+  A2_LOCK_SET;
+  set_.clear();
+}
 
 int GroupId::expandUnique(a2_gid_t& n, const char* hex)
 {
@@ -84,6 +104,7 @@ int GroupId::expandUnique(a2_gid_t& n, const char* hex)
   }
   p <<= 64 - i * 4;
   a2_gid_t mask = UINT64_MAX - ((1LL << (64 - i * 4)) - 1);
+  A2_LOCK_SET;
   auto itr = set_.lower_bound(p);
   if (itr == set_.end()) {
     return ERR_NOT_FOUND;
@@ -140,8 +161,13 @@ std::string GroupId::toHex() const { return toHex(gid_); }
 
 std::string GroupId::toAbbrevHex() const { return toAbbrevHex(gid_); }
 
+// The callers of the constructor hold the lock already.
 GroupId::GroupId(a2_gid_t gid) : gid_(gid) { set_.insert(gid_); }
 
-GroupId::~GroupId() { set_.erase(gid_); }
+GroupId::~GroupId()
+{
+  A2_LOCK_SET;
+  set_.erase(gid_);
+}
 
 } // namespace aria2
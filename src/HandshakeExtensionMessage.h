@@ -55,6 +55,10 @@ private:
 
   size_t metadataSize_;
 
+  // The number of outstanding requests the peer accepts.  0 if not
+  // told.
+  size_t reqq_;
+
   ExtensionMessageRegistry extreg_;
 
   DownloadContext* dctx_;
@@ -94,6 +98,10 @@ public:
 
   void setMetadataSize(size_t size) { metadataSize_ = size; }
 
+  size_t getReqq() const { return reqq_; }
+
+  void setReqq(size_t reqq) { reqq_ = reqq; }
+
   void setDownloadContext(DownloadContext* dctx) { dctx_ = dctx; }
 
   void setExtension(int key, uint8_t id);
@@ -0,0 +1,174 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "HpackDecoder.h"
+
+#include "DlAbortEx.h"
+#include "fmt.h"
+
+namespace aria2 {
+
+namespace {
+// The size of an entry is the sum of its name and value lengths plus
+// 32 bytes of overhead.
+size_t entrySize(const hpack::HeaderField& field)
+{
+  return field.first.size() + field.second.size() + 32;
+}
+} // namespace
+
+HpackDecoder::HpackDecoder(size_t maxTableSize)
+    : tableSize_(0), tableCapacity_(maxTableSize), maxTableSize_(maxTableSize)
+{
+}
+
+const hpack::HeaderField& HpackDecoder::getEntry(uint64_t index) const
+{
+  if (index == 0) {
+    throw DL_ABORT_EX("HPACK: index 0");
+  }
+  if (index <= hpack::getStaticTableSize()) {
+    return hpack::getStaticTableEntry(index);
+  }
+  index -= hpack::getStaticTableSize() + 1;
+  if (index >= table_.size()) {
+    throw DL_ABORT_EX(fmt("HPACK: index %lu is out of range",
+                          static_cast<unsigned long>(index)));
+  }
+  return table_[index];
+}
+
+void HpackDecoder::evict(size_t capacity)
+{
+  while (tableSize_ > capacity) {
+    tableSize_ -= entrySize(table_.back());
+    table_.pop_back();
+  }
+}
+
+void HpackDecoder::addEntry(hpack::HeaderField field)
+{
+  size_t size = entrySize(field);
+  if (size > tableCapacity_) {
+    // An entry larger than the table empties the table.
+    evict(0);
+    return;
+  }
+  evict(tableCapacity_ - size);
+  tableSize_ += size;
+  table_.push_front(std::move(field));
+}
+
+namespace {
+// Decodes a string literal at |data| and stores it in |s|.  Returns
+// the number of bytes consumed.
+size_t decodeString(std::string& s, const unsigned char* data, size_t len)
+{
+  uint64_t slen;
+  size_t n = hpack::decodeInteger(slen, data, len, 7);
+  if (n == 0 || slen > len - n) {
+    throw DL_ABORT_EX("HPACK: truncated string literal");
+  }
+  if (data[0] & 0x80) {
+    s = hpack::huffmanDecode(data + n, slen);
+  }
+  else {
+    s.assign(data + n, data + n + slen);
+  }
+  return n + slen;
+}
+} // namespace
+
+void HpackDecoder::decode(std::vector<hpack::HeaderField>& headers,
+                          const unsigned char* data, size_t len)
+{
+  // Dynamic table size updates are only allowed at the beginning of
+  // a header block.
+  bool sizeUpdateAllowed = true;
+  for (size_t i = 0; i < len;) {
+    auto p = data + i;
+    auto rest = len - i;
+    uint64_t index;
+    size_t n;
+    if (p[0] & 0x80) {
+      // Indexed Header Field Representation
+      n = hpack::decodeInteger(index, p, rest, 7);
+      if (n == 0) {
+        throw DL_ABORT_EX("HPACK: truncated index");
+      }
+      headers.push_back(getEntry(index));
+      i += n;
+      sizeUpdateAllowed = false;
+      continue;
+    }
+    if ((p[0] & 0xe0) == 0x20) {
+      // Dynamic Table Size Update
+      uint64_t size;
+      n = hpack::decodeInteger(size, p, rest, 5);
+      if (n == 0 || !sizeUpdateAllowed || size > maxTableSize_) {
+        throw DL_ABORT_EX("HPACK: bad dynamic table size update");
+      }
+      tableCapacity_ = size;
+      evict(tableCapacity_);
+      i += n;
+      continue;
+    }
+    // Literal Header Field with Incremental Indexing has 6 bits
+    // prefix.  Without Indexing and Never Indexed have 4 bits.
+    bool indexing = (p[0] & 0xc0) == 0x40;
+    n = hpack::decodeInteger(index, p, rest, indexing ? 6 : 4);
+    if (n == 0) {
+      throw DL_ABORT_EX("HPACK: truncated index");
+    }
+    hpack::HeaderField field;
+    if (index) {
+      field.first = getEntry(index).first;
+    }
+    else {
+      n += decodeString(field.first, p + n, rest - n);
+    }
+    if (n >= rest) {
+      throw DL_ABORT_EX("HPACK: truncated header field");
+    }
+    n += decodeString(field.second, p + n, rest - n);
+    if (indexing) {
+      addEntry(field);
+    }
+    headers.push_back(std::move(field));
+    i += n;
+    sizeUpdateAllowed = false;
+  }
+}
+
+} // namespace aria2
@@ -0,0 +1,80 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_HPACK_DECODER_H
+#define D_HPACK_DECODER_H
+
+#include "common.h"
+
+#include <deque>
+#include <vector>
+
+#include "hpack.h"
+
+namespace aria2 {
+
+// Decodes HPACK header blocks.  One object is used per HTTP/2
+// connection, because the dynamic table is shared by all header
+// blocks of the connection.
+class HpackDecoder {
+public:
+  // |maxTableSize| is the value of SETTINGS_HEADER_TABLE_SIZE we
+  // advertised.
+  HpackDecoder(size_t maxTableSize = 4096);
+
+  // Decodes a complete header block [data, data+len) and appends the
+  // header fields to |headers|.  Throws DlAbortEx on a compression
+  // error, after which the object must not be used.
+  void decode(std::vector<hpack::HeaderField>& headers,
+              const unsigned char* data, size_t len);
+
+  size_t getTableSize() const { return tableSize_; }
+
+  size_t getNumTableEntries() const { return table_.size(); }
+
+private:
+  // Entries in the dynamic table, the newest first.
+  std::deque<hpack::HeaderField> table_;
+  size_t tableSize_;
+  size_t tableCapacity_;
+  size_t maxTableSize_;
+
+  const hpack::HeaderField& getEntry(uint64_t index) const;
+  void addEntry(hpack::HeaderField field);
+  void evict(size_t capacity);
+};
+
+} // namespace aria2
+
+#endif // D_HPACK_DECODER_H
@@ -0,0 +1,839 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "Http2Session.h"
+
+#include <cstring>
+#include <cassert>
+
+#include "SocketCore.h"
+#include "Command.h"
+#include "DownloadEngine.h"
+#include "DlRetryEx.h"
+#include "LogFactory.h"
+#include "Logger.h"
+#include "fmt.h"
+#include "util.h"
+#include "a2functional.h"
+#include "A2STR.h"
+#include "wallclock.h"
+
+namespace aria2 {
+
+namespace {
+enum {
+  FRAME_DATA = 0x0,
+  FRAME_HEADERS = 0x1,
+  FRAME_PRIORITY = 0x2,
+  FRAME_RST_STREAM = 0x3,
+  FRAME_SETTINGS = 0x4,
+  FRAME_PUSH_PROMISE = 0x5,
+  FRAME_PING = 0x6,
+  FRAME_GOAWAY = 0x7,
+  FRAME_WINDOW_UPDATE = 0x8,
+  FRAME_CONTINUATION = 0x9
+};
+
+enum {
+  FLAG_END_STREAM = 0x1,
+  FLAG_ACK = 0x1,
+  FLAG_END_HEADERS = 0x4,
+  FLAG_PADDED = 0x8,
+  FLAG_PRIORITY = 0x20
+};
+
+enum {
+  SETTINGS_HEADER_TABLE_SIZE = 0x1,
+  SETTINGS_ENABLE_PUSH = 0x2,
+  SETTINGS_MAX_CONCURRENT_STREAMS = 0x3,
+  SETTINGS_INITIAL_WINDOW_SIZE = 0x4,
+  SETTINGS_MAX_FRAME_SIZE = 0x5
+};
+
+enum {
+  ERR_NO_ERROR = 0x0,
+  ERR_PROTOCOL_ERROR = 0x1,
+  ERR_FLOW_CONTROL_ERROR = 0x3,
+  ERR_STREAM_CLOSED = 0x5,
+  ERR_FRAME_SIZE_ERROR = 0x6,
+  ERR_REFUSED_STREAM = 0x7,
+  ERR_CANCEL = 0x8,
+  ERR_COMPRESSION_ERROR = 0x9
+};
+
+constexpr char CONNECTION_PREFACE[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+constexpr size_t FRAME_HEADER_LENGTH = 9;
+// We never advertise SETTINGS_MAX_FRAME_SIZE, so that frames from the
+// server are at most this long.
+constexpr size_t MAX_FRAME_SIZE = 16_k;
+constexpr size_t MAX_HEADER_BLOCK_SIZE = 64_k;
+constexpr int32_t DEFAULT_WINDOW_SIZE = 65535;
+// The defaults of 64KiB only allow 64KiB in flight per round trip,
+// which is far too small for bulk downloads.  Received data is
+// buffered until the command of the stream reads it, so the
+// connection window also bounds the memory used by a session.
+constexpr int32_t STREAM_WINDOW_SIZE = 4_m;
+constexpr int32_t CONNECTION_WINDOW_SIZE = 16_m;
+// Assumed until the server tells its limit.
+constexpr size_t INITIAL_MAX_CONCURRENT_STREAMS = 100;
+constexpr int32_t MAX_STREAM_ID = 0x7fffffff;
+
+uint32_t getUint32(const unsigned char* p)
+{
+  return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) |
+         p[3];
+}
+
+void putUint32(std::string& out, uint32_t n)
+{
+  out += static_cast<char>(n >> 24);
+  out += static_cast<char>(n >> 16);
+  out += static_cast<char>(n >> 8);
+  out += static_cast<char>(n);
+}
+
+void putSetting(std::string& out, uint16_t id, uint32_t value)
+{
+  out += static_cast<char>(id >> 8);
+  out += static_cast<char>(id);
+  putUint32(out, value);
+}
+
+bool isValidFieldText(const std::string& s)
+{
+  return s.find_first_of(std::string("\r\n\0", 3)) == std::string::npos;
+}
+
+// Formats the response header fields as HTTP/1.1 response header.
+// Returns an empty string if |headers| is not a valid response.
+std::string createHttp1Header(const std::vector<hpack::HeaderField>& headers,
+                              int& status)
+{
+  status = 0;
+  std::string fields;
+  for (auto& hd : headers) {
+    if (!isValidFieldText(hd.first) || !isValidFieldText(hd.second)) {
+      return A2STR::NIL;
+    }
+    if (hd.first == ":status") {
+      if (hd.second.size() != 3 ||
+          !util::isNumber(std::begin(hd.second), std::end(hd.second))) {
+        return A2STR::NIL;
+      }
+      status = (hd.second[0] - '0') * 100 + (hd.second[1] - '0') * 10 +
+               (hd.second[2] - '0');
+      continue;
+    }
+    if (hd.first.empty() || hd.first[0] == ':' || hd.first == "connection" ||
+        hd.first == "transfer-encoding") {
+      continue;
+    }
+    fields += hd.first;
+    fields += ": ";
+    fields += hd.second;
+    fields += "\r\n";
+  }
+  if (status < 100) {
+    return A2STR::NIL;
+  }
+  auto res = fmt("HTTP/1.1 %d\r\n", status);
+  res += fields;
+  // The stream is not reusable, and the body ends with the stream.
+  res += "Connection: close\r\n\r\n";
+  return res;
+}
+} // namespace
+
+Http2Session::Stream::Stream()
+    : pos(0),
+      headerLength(0),
+      recvWindow(STREAM_WINDOW_SIZE),
+      consumed(0),
+      errorCode(ERR_NO_ERROR),
+      finalResponse(false),
+      endStream(false),
+      reset(false),
+      command(nullptr)
+{
+}
+
+Http2Session::Http2Session(std::shared_ptr<SocketCore> socket,
+                           DownloadEngine* e)
+    : socket_(std::move(socket)),
+      e_(e),
+      socketBuffer_(socket_),
+      rbuf_(FRAME_HEADER_LENGTH + MAX_FRAME_SIZE),
+      rbufLen_(0),
+      headerStreamId_(0),
+      headerFlags_(0),
+      expectContinuation_(false),
+      nextStreamId_(1),
+      lastStreamId_(MAX_STREAM_ID),
+      readingStreamId_(0),
+      maxConcurrentStreams_(INITIAL_MAX_CONCURRENT_STREAMS),
+      maxFrameSize_(MAX_FRAME_SIZE),
+      connRecvWindow_(CONNECTION_WINDOW_SIZE),
+      connConsumed_(0),
+      settingsReceived_(false),
+      goawayReceived_(false),
+      idleTimer_(global::wallclock())
+{
+  socketBuffer_.pushStr(std::string(CONNECTION_PREFACE));
+  std::string settings;
+  putSetting(settings, SETTINGS_ENABLE_PUSH, 0);
+  putSetting(settings, SETTINGS_INITIAL_WINDOW_SIZE, STREAM_WINDOW_SIZE);
+  queueFrame(FRAME_SETTINGS, 0, 0, settings);
+  queueWindowUpdate(0, CONNECTION_WINDOW_SIZE - DEFAULT_WINDOW_SIZE);
+}
+
+Http2Session::~Http2Session() = default;
+
+void Http2Session::queueFrame(uint8_t type, uint8_t flags, int32_t streamId,
+                              const std::string& payload)
+{
+  std::string frame;
+  frame.reserve(FRAME_HEADER_LENGTH + payload.size());
+  frame += static_cast<char>(payload.size() >> 16);
+  frame += static_cast<char>(payload.size() >> 8);
+  frame += static_cast<char>(payload.size());
+  frame += static_cast<char>(type);
+  frame += static_cast<char>(flags);
+  putUint32(frame, streamId);
+  frame += payload;
+  socketBuffer_.pushStr(std::move(frame));
+}
+
+void Http2Session::queueRstStream(int32_t streamId, uint32_t errorCode)
+{
+  std::string payload;
+  putUint32(payload, errorCode);
+  queueFrame(FRAME_RST_STREAM, 0, streamId, payload);
+}
+
+void Http2Session::queueWindowUpdate(int32_t streamId, int32_t increment)
+{
+  std::string payload;
+  putUint32(payload, increment);
+  queueFrame(FRAME_WINDOW_UPDATE, 0, streamId, payload);
+}
+
+int32_t Http2Session::submitRequest(
+    const std::vector<hpack::HeaderField>& headers)
+{
+  assert(canSubmitRequest());
+  int32_t streamId = nextStreamId_;
+  nextStreamId_ += 2;
+  std::string block;
+  hpack::encodeHeaderBlock(block, headers);
+  // The header block is split into CONTINUATION frames if it does not
+  // fit in a frame.
+  uint8_t type = FRAME_HEADERS;
+  uint8_t flags = FLAG_END_STREAM;
+  for (size_t i = 0;; i += maxFrameSize_) {
+    auto fragment = block.substr(i, maxFrameSize_);
+    bool last = i + maxFrameSize_ >= block.size();
+    queueFrame(type, last ? flags | FLAG_END_HEADERS : flags, streamId,
+               fragment);
+    if (last) {
+      break;
+    }
+    type = FRAME_CONTINUATION;
+    flags = 0;
+  }
+  streams_.emplace(streamId, Stream());
+  return streamId;
+}
+
+void Http2Session::send()
+{
+  if (!error_.empty()) {
+    return;
+  }
+  try {
+    socketBuffer_.send();
+  }
+  catch (RecoverableException& e) {
+    fail(e.what());
+    throw;
+  }
+}
+
+void Http2Session::fail(const std::string& error)
+{
+  if (!error_.empty()) {
+    return;
+  }
+  A2_LOG_INFO(fmt("HTTP/2 connection failed: %s", error.c_str()));
+  error_ = error;
+  for (auto& elem : streams_) {
+    wake(elem.first, elem.second);
+  }
+}
+
+void Http2Session::wake(int32_t streamId, Stream& stream)
+{
+  if (streamId == readingStreamId_ || !stream.command || !e_) {
+    return;
+  }
+  stream.command->setStatus(Command::STATUS_ONESHOT_REALTIME);
+  e_->setNoWait(true);
+}
+
+void Http2Session::connectionError(uint32_t errorCode,
+                                   const std::string& reason)
+{
+  std::string payload;
+  // We accept no stream initiated by the server.
+  putUint32(payload, 0);
+  putUint32(payload, errorCode);
+  queueFrame(FRAME_GOAWAY, 0, 0, payload);
+  try {
+    socketBuffer_.send();
+  }
+  catch (RecoverableException& e) {
+    // The connection is closed anyway.
+  }
+  throw DL_RETRY_EX(fmt("HTTP/2 protocol error: %s", reason.c_str()));
+}
+
+void Http2Session::resetStream(int32_t streamId, Stream& stream,
+                               uint32_t errorCode)
+{
+  queueRstStream(streamId, errorCode);
+  stream.reset = true;
+  stream.errorCode = errorCode;
+  wake(streamId, stream);
+}
+
+void Http2Session::recv()
+{
+  if (!error_.empty()) {
+    throw DL_RETRY_EX(error_);
+  }
+  try {
+    for (;;) {
+      size_t len = rbuf_.size() - rbufLen_;
+      socket_->readData(rbuf_.data() + rbufLen_, len);
+      if (len == 0) {
+        if (socket_->wantRead() || socket_->wantWrite()) {
+          break;
+        }
+        throw DL_RETRY_EX("HTTP/2 connection was closed by the server");
+      }
+      rbufLen_ += len;
+      size_t n = processFrames();
+      if (n) {
+        std::memmove(rbuf_.data(), rbuf_.data() + n, rbufLen_ - n);
+        rbufLen_ -= n;
+      }
+    }
+    socketBuffer_.send();
+  }
+  catch (RecoverableException& e) {
+    fail(e.what());
+    throw;
+  }
+}
+
+size_t Http2Session::processFrames()
+{
+  size_t i = 0;
+  for (;;) {
+    auto p = rbuf_.data() + i;
+    size_t rest = rbufLen_ - i;
+    if (rest < FRAME_HEADER_LENGTH) {
+      break;
+    }
+    size_t length = (p[0] << 16) | (p[1] << 8) | p[2];
+    if (length > MAX_FRAME_SIZE) {
+      connectionError(ERR_FRAME_SIZE_ERROR,
+                      fmt("frame is too large: %lu",
+                          static_cast<unsigned long>(length)));
+    }
+    if (rest < FRAME_HEADER_LENGTH + length) {
+      break;
+    }
+    int32_t streamId = getUint32(p + 5) & MAX_STREAM_ID;
+    processFrame(p[3], p[4], streamId, p + FRAME_HEADER_LENGTH, length);
+    i += FRAME_HEADER_LENGTH + length;
+  }
+  return i;
+}
+
+void Http2Session::processFrame(uint8_t type, uint8_t flags,
+                                int32_t streamId,
+                                const unsigned char* payload, size_t length)
+{
+  if (!settingsReceived_ && type != FRAME_SETTINGS) {
+    connectionError(ERR_PROTOCOL_ERROR, "SETTINGS is expected");
+  }
+  if (expectContinuation_ && type != FRAME_CONTINUATION) {
+    connectionError(ERR_PROTOCOL_ERROR, "CONTINUATION is expected");
+  }
+  switch (type) {
+  case FRAME_DATA:
+    onData(flags, streamId, payload, length);
+    break;
+  case FRAME_HEADERS:
+    onHeaders(flags, streamId, payload, length);
+    break;
+  case FRAME_PRIORITY:
+    if (length != 5) {
+      connectionError(ERR_FRAME_SIZE_ERROR, "bad PRIORITY");
+    }
+    break;
+  case FRAME_RST_STREAM: {
+    if (streamId == 0) {
+      connectionError(ERR_PROTOCOL_ERROR, "RST_STREAM on stream 0");
+    }
+    if (length != 4) {
+      connectionError(ERR_FRAME_SIZE_ERROR, "bad RST_STREAM");
+    }
+    auto i = streams_.find(streamId);
+    if (i != std::end(streams_) && !(*i).second.reset) {
+      auto& stream = (*i).second;
+      stream.reset = true;
+      stream.errorCode = getUint32(payload);
+      wake(streamId, stream);
+    }
+    break;
+  }
+  case FRAME_SETTINGS:
+    onSettings(flags, streamId, payload, length);
+    break;
+  case FRAME_PUSH_PROMISE:
+    // We disabled server push.
+    connectionError(ERR_PROTOCOL_ERROR, "unexpected PUSH_PROMISE");
+    break;
+  case FRAME_PING:
+    if (streamId != 0) {
+      connectionError(ERR_PROTOCOL_ERROR, "PING on stream");
+    }
+    if (length != 8) {
+      connectionError(ERR_FRAME_SIZE_ERROR, "bad PING");
+    }
+    if (!(flags & FLAG_ACK)) {
+      queueFrame(FRAME_PING, FLAG_ACK, 0,
+                 std::string(payload, payload + length));
+    }
+    break;
+  case FRAME_GOAWAY:
+    if (streamId != 0) {
+      connectionError(ERR_PROTOCOL_ERROR, "GOAWAY on stream");
+    }
+    if (length < 8) {
+      connectionError(ERR_FRAME_SIZE_ERROR, "bad GOAWAY");
+    }
+    onGoaway(payload, length);
+    break;
+  case FRAME_WINDOW_UPDATE:
+    // We send no DATA, so that the windows of the server side do not
+    // matter.
+    if (length != 4) {
+      connectionError(ERR_FRAME_SIZE_ERROR, "bad WINDOW_UPDATE");
+    }
+    if (streamId == 0 && (getUint32(payload) & MAX_STREAM_ID) == 0) {
+      connectionError(ERR_PROTOCOL_ERROR, "WINDOW_UPDATE with 0 increment");
+    }
+    break;
+  case FRAME_CONTINUATION:
+    onContinuation(flags, streamId, payload, length);
+    break;
+  default:
+    // Unknown frame types must be ignored.
+    break;
+  }
+}
+
+void Http2Session::onSettings(uint8_t flags, int32_t streamId,
+                              const unsigned char* payload, size_t length)
+{
+  if (streamId != 0) {
+    connectionError(ERR_PROTOCOL_ERROR, "SETTINGS on stream");
+  }
+  if (length % 6 != 0 || ((flags & FLAG_ACK) && length != 0)) {
+    connectionError(ERR_FRAME_SIZE_ERROR, "bad SETTINGS");
+  }
+  if (flags & FLAG_ACK) {
+    return;
+  }
+  settingsReceived_ = true;
+  for (size_t i = 0; i < length; i += 6) {
+    uint16_t id = (payload[i] << 8) | payload[i + 1];
+    uint32_t value = getUint32(payload + i + 2);
+    switch (id) {
+    case SETTINGS_MAX_CONCURRENT_STREAMS:
+      maxConcurrentStreams_ = value;
+      break;
+    case SETTINGS_INITIAL_WINDOW_SIZE:
+      if (value > static_cast<uint32_t>(MAX_STREAM_ID)) {
+        connectionError(ERR_FLOW_CONTROL_ERROR, "bad initial window size");
+      }
+      break;
+    case SETTINGS_MAX_FRAME_SIZE:
+      if (value < 16_k || value > 16_m - 1) {
+        connectionError(ERR_PROTOCOL_ERROR, "bad max frame size");
+      }
+      maxFrameSize_ = value;
+      break;
+    default:
+      // We do not use the dynamic table for encoding, so that
+      // SETTINGS_HEADER_TABLE_SIZE does not matter.  Unknown settings
+      // must be ignored.
+      break;
+    }
+  }
+  queueFrame(FRAME_SETTINGS, FLAG_ACK, 0, A2STR::NIL);
+}
+
+void Http2Session::onGoaway(const unsigned char* payload, size_t length)
+{
+  goawayReceived_ = true;
+  lastStreamId_ = getUint32(payload) & MAX_STREAM_ID;
+  uint32_t errorCode = getUint32(payload + 4);
+  A2_LOG_INFO(fmt("HTTP/2 GOAWAY received: last-stream-id=%d, error=%u",
+                  lastStreamId_, errorCode));
+  // The streams after the last stream ID were not processed, and can
+  // be retried safely.
+  for (auto& elem : streams_) {
+    if (elem.first > lastStreamId_ && !elem.second.reset) {
+      elem.second.reset = true;
+      elem.second.errorCode = ERR_REFUSED_STREAM;
+      wake(elem.first, elem.second);
+    }
+  }
+}
+
+void Http2Session::onData(uint8_t flags, int32_t streamId,
+                          const unsigned char* payload, size_t length)
+{
+  if (streamId == 0) {
+    connectionError(ERR_PROTOCOL_ERROR, "DATA on stream 0");
+  }
+  // Padding is subject to flow control as well.
+  if (static_cast<int32_t>(length) > connRecvWindow_) {
+    connectionError(ERR_FLOW_CONTROL_ERROR, "connection window exceeded");
+  }
+  connRecvWindow_ -= length;
+  size_t padLength = 0;
+  if (flags & FLAG_PADDED) {
+    if (length == 0 || payload[0] >= length) {
+      connectionError(ERR_PROTOCOL_ERROR, "bad padding");
+    }
+    padLength = payload[0] + 1;
+  }
+  auto i = streams_.find(streamId);
+  if (i == std::end(streams_) || (*i).second.reset) {
+    // The stream was closed by us.  The data is just discarded, but
+    // still counts against the connection window.
+    connConsumed_ += length;
+    updateConnectionWindow();
+    return;
+  }
+  auto& stream = (*i).second;
+  if (stream.endStream || !stream.finalResponse) {
+    resetStream(streamId, stream, ERR_STREAM_CLOSED);
+    connConsumed_ += length;
+    updateConnectionWindow();
+    return;
+  }
+  if (static_cast<int32_t>(length) > stream.recvWindow) {
+    resetStream(streamId, stream, ERR_FLOW_CONTROL_ERROR);
+    connConsumed_ += length;
+    updateConnectionWindow();
+    return;
+  }
+  stream.recvWindow -= length;
+  // Padding is never read, so give it back now.
+  connConsumed_ += padLength;
+  stream.consumed += padLength;
+  stream.data.append(payload + (padLength ? 1 : 0),
+                     payload + length - (padLength ? padLength - 1 : 0));
+  if (flags & FLAG_END_STREAM) {
+    stream.endStream = true;
+  }
+  wake(streamId, stream);
+}
+
+void Http2Session::onHeaders(uint8_t flags, int32_t streamId,
+                             const unsigned char* payload, size_t length)
+{
+  if (streamId == 0 || streamId % 2 == 0 || streamId >= nextStreamId_) {
+    connectionError(ERR_PROTOCOL_ERROR, "HEADERS on bad stream");
+  }
+  size_t first = 0;
+  size_t last = length;
+  if (flags & FLAG_PADDED) {
+    if (length == 0 || payload[0] >= length) {
+      connectionError(ERR_PROTOCOL_ERROR, "bad padding");
+    }
+    first = 1;
+    last -= payload[0];
+  }
+  if (flags & FLAG_PRIORITY) {
+    first += 5;
+    if (first > last) {
+      connectionError(ERR_FRAME_SIZE_ERROR, "bad HEADERS");
+    }
+  }
+  headerBlock_.assign(payload + first, payload + last);
+  headerStreamId_ = streamId;
+  headerFlags_ = flags;
+  if (flags & FLAG_END_HEADERS) {
+    onHeaderBlock();
+  }
+  else {
+    expectContinuation_ = true;
+  }
+}
+
+void Http2Session::onContinuation(uint8_t flags, int32_t streamId,
+                                  const unsigned char* payload, size_t length)
+{
+  if (!expectContinuation_ || streamId != headerStreamId_) {
+    connectionError(ERR_PROTOCOL_ERROR, "unexpected CONTINUATION");
+  }
+  if (headerBlock_.size() + length > MAX_HEADER_BLOCK_SIZE) {
+    connectionError(ERR_PROTOCOL_ERROR, "header block is too large");
+  }
+  headerBlock_.append(payload, payload + length);
+  if (flags & FLAG_END_HEADERS) {
+    expectContinuation_ = false;
+    onHeaderBlock();
+  }
+}
+
+void Http2Session::onHeaderBlock()
+{
+  std::vector<hpack::HeaderField> headers;
+  // The header block must be decoded even if the stream is closed,
+  // to keep the dynamic table in sync with the server.
+  try {
+    hpackDecoder_.decode(headers,
+                         reinterpret_cast<const unsigned char*>(
+                             headerBlock_.data()),
+                         headerBlock_.size());
+  }
+  catch (RecoverableException& e) {
+    connectionError(ERR_COMPRESSION_ERROR, e.what());
+  }
+  headerBlock_.clear();
+  auto i = streams_.find(headerStreamId_);
+  if (i == std::end(streams_) || (*i).second.reset) {
+    return;
+  }
+  auto& stream = (*i).second;
+  if (stream.endStream) {
+    resetStream(headerStreamId_, stream, ERR_STREAM_CLOSED);
+    return;
+  }
+  if (!stream.finalResponse) {
+    int status;
+    auto header = createHttp1Header(headers, status);
+    if (header.empty()) {
+      resetStream(headerStreamId_, stream, ERR_PROTOCOL_ERROR);
+      return;
+    }
+    if (status / 100 == 1) {
+      if (headerFlags_ & FLAG_END_STREAM) {
+        resetStream(headerStreamId_, stream, ERR_PROTOCOL_ERROR);
+        return;
+      }
+    }
+    else {
+      stream.finalResponse = true;
+    }
+    stream.data += header;
+    stream.headerLength += header.size();
+  }
+  else if (!(headerFlags_ & FLAG_END_STREAM)) {
+    // Trailers must end the stream.
+    resetStream(headerStreamId_, stream, ERR_PROTOCOL_ERROR);
+    return;
+  }
+  // Trailers are ignored.
+  if (headerFlags_ & FLAG_END_STREAM) {
+    stream.endStream = true;
+  }
+  wake(headerStreamId_, stream);
+}
+
+void Http2Session::consume(int32_t streamId, Stream& stream, size_t len)
+{
+  size_t headerLength = std::min(len, stream.headerLength);
+  stream.headerLength -= headerLength;
+  len -= headerLength;
+  stream.consumed += len;
+  connConsumed_ += len;
+  // Give the window back when a half of it is consumed, so that the
+  // server does not stall while WINDOW_UPDATE is in flight.
+  if (!stream.endStream && stream.consumed >= STREAM_WINDOW_SIZE / 2) {
+    queueWindowUpdate(streamId, stream.consumed);
+    stream.recvWindow += stream.consumed;
+    stream.consumed = 0;
+  }
+  updateConnectionWindow();
+}
+
+void Http2Session::updateConnectionWindow()
+{
+  if (connConsumed_ >= CONNECTION_WINDOW_SIZE / 2) {
+    queueWindowUpdate(0, connConsumed_);
+    connRecvWindow_ += connConsumed_;
+    connConsumed_ = 0;
+  }
+}
+
+size_t Http2Session::readData(int32_t streamId, unsigned char* data,
+                              size_t len)
+{
+  auto i = streams_.find(streamId);
+  assert(i != std::end(streams_));
+  auto& stream = (*i).second;
+  if (stream.pos == stream.data.size() && !stream.endStream &&
+      !stream.reset) {
+    readingStreamId_ = streamId;
+    auto clearReading = defer(this, [](Http2Session* session) {
+      session->readingStreamId_ = 0;
+    });
+    recv();
+  }
+  size_t n = std::min(len, stream.data.size() - stream.pos);
+  if (n == 0) {
+    if (stream.reset) {
+      throw DL_RETRY_EX(fmt("HTTP/2 stream %d was reset: error=%u", streamId,
+                            stream.errorCode));
+    }
+    if (!stream.endStream && !error_.empty()) {
+      throw DL_RETRY_EX(error_);
+    }
+    return 0;
+  }
+  memcpy(data, stream.data.data() + stream.pos, n);
+  stream.pos += n;
+  if (stream.pos == stream.data.size()) {
+    stream.data.clear();
+    stream.pos = 0;
+  }
+  else if (stream.pos >= 64_k && stream.pos * 2 >= stream.data.size()) {
+    stream.data.erase(0, stream.pos);
+    stream.pos = 0;
+  }
+  consume(streamId, stream, n);
+  send();
+  return n;
+}
+
+bool Http2Session::dataAvailable(int32_t streamId) const
+{
+  auto i = streams_.find(streamId);
+  if (i == std::end(streams_)) {
+    return false;
+  }
+  auto& stream = (*i).second;
+  return stream.pos < stream.data.size() || stream.endStream ||
+         stream.reset || !error_.empty();
+}
+
+bool Http2Session::streamClosed(int32_t streamId) const
+{
+  auto i = streams_.find(streamId);
+  if (i == std::end(streams_)) {
+    return true;
+  }
+  auto& stream = (*i).second;
+  return stream.endStream && stream.pos == stream.data.size();
+}
+
+void Http2Session::closeStream(int32_t streamId)
+{
+  auto i = streams_.find(streamId);
+  if (i == std::end(streams_)) {
+    return;
+  }
+  auto& stream = (*i).second;
+  if (!stream.endStream && !stream.reset && error_.empty()) {
+    queueRstStream(streamId, ERR_CANCEL);
+  }
+  // The data left unread is given back to the connection window.
+  size_t rest = stream.data.size() - stream.pos;
+  connConsumed_ += rest - std::min(rest, stream.headerLength);
+  streams_.erase(i);
+  if (streams_.empty()) {
+    idleTimer_ = global::wallclock();
+  }
+  if (error_.empty()) {
+    updateConnectionWindow();
+    try {
+      socketBuffer_.send();
+    }
+    catch (RecoverableException& e) {
+      fail(e.what());
+    }
+  }
+}
+
+void Http2Session::setStreamCommand(int32_t streamId, Command* command)
+{
+  auto i = streams_.find(streamId);
+  if (i != std::end(streams_)) {
+    (*i).second.command = command;
+  }
+}
+
+void Http2Session::releaseStreamCommand(int32_t streamId, Command* command)
+{
+  auto i = streams_.find(streamId);
+  if (i != std::end(streams_) && (*i).second.command == command) {
+    (*i).second.command = nullptr;
+  }
+}
+
+bool Http2Session::isOpen() const { return error_.empty() && !goawayReceived_; }
+
+bool Http2Session::canSubmitRequest() const
+{
+  if (!isOpen() || nextStreamId_ >= MAX_STREAM_ID - 1) {
+    return false;
+  }
+  size_t numOpen = 0;
+  for (auto& elem : streams_) {
+    if (!elem.second.endStream && !elem.second.reset) {
+      ++numOpen;
+    }
+  }
+  return numOpen < maxConcurrentStreams_;
+}
+
+} // namespace aria2
@@ -0,0 +1,219 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_HTTP2_SESSION_H
+#define D_HTTP2_SESSION_H
+
+#include "common.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+#include "hpack.h"
+#include "HpackDecoder.h"
+#include "SocketBuffer.h"
+#include "TimerA2.h"
+
+namespace aria2 {
+
+class SocketCore;
+class Command;
+class DownloadEngine;
+
+// The client side of an HTTP/2 connection (RFC 7540).  Requests are
+// multiplexed on one connection as streams.  The session is driven by
+// the commands which own the streams: whichever command reads from
+// the socket processes the frames of all streams, and wakes up the
+// commands of the other streams which received something.
+//
+// The response of each stream is presented as an HTTP/1.1 response
+// with "Connection: close", that is, the status line and the header
+// fields followed by the body until the end of the stream, so that
+// the response processing of HTTP/1.1 is used as is.
+class Http2Session {
+public:
+  // |e| may be nullptr, in which case no command is woken up.
+  Http2Session(std::shared_ptr<SocketCore> socket, DownloadEngine* e);
+  ~Http2Session();
+
+  // Submits a GET request with |headers| and returns its stream ID.
+  // |headers| must contain the pseudo header fields first, and the
+  // names must be in lower case.  The request is only queued; call
+  // send() to write it.
+  int32_t submitRequest(const std::vector<hpack::HeaderField>& headers);
+
+  // Reads frames from the socket until it would block, and processes
+  // them.  Throws DlRetryEx if the connection is broken.
+  void recv();
+
+  // Writes the queued frames as much as the socket allows.
+  void send();
+
+  // Returns true if there are frames which are not written yet.
+  bool wantWrite() const { return !socketBuffer_.sendBufferIsEmpty(); }
+
+  // Copies at most |len| bytes of the response of |streamId| to
+  // |data| and returns the number of bytes copied.  The socket is
+  // read if no data is buffered for the stream.  Throws DlRetryEx if
+  // the stream was reset or the connection is broken before the end
+  // of the stream.
+  size_t readData(int32_t streamId, unsigned char* data, size_t len);
+
+  // Returns true if readData() for |streamId| makes progress without
+  // reading the socket: data is buffered, or the stream is finished.
+  bool dataAvailable(int32_t streamId) const;
+
+  // Returns true if all data of |streamId| was read and the server
+  // ended the stream.
+  bool streamClosed(int32_t streamId) const;
+
+  // Forgets |streamId|.  If the server has not ended the stream yet,
+  // it is canceled with RST_STREAM.
+  void closeStream(int32_t streamId);
+
+  // Sets the command which is woken up when |streamId| receives data
+  // read by another stream.  Passing nullptr unsets it.
+  void setStreamCommand(int32_t streamId, Command* command);
+
+  // Unsets the command of |streamId| if it is |command|.
+  void releaseStreamCommand(int32_t streamId, Command* command);
+
+  // Returns true if a new request can be submitted: the connection
+  // is healthy, the server did not send GOAWAY, and the number of
+  // open streams is less than SETTINGS_MAX_CONCURRENT_STREAMS of the
+  // server.
+  bool canSubmitRequest() const;
+
+  // Returns true unless the connection is broken or the server sent
+  // GOAWAY.
+  bool isOpen() const;
+
+  size_t countStream() const { return streams_.size(); }
+
+  // Returns the time when the last stream was closed, or the session
+  // was created.  Only meaningful if countStream() == 0.
+  const Timer& getIdleTimer() const { return idleTimer_; }
+
+  const std::shared_ptr<SocketCore>& getSocket() const { return socket_; }
+
+private:
+  struct Stream {
+    // The response as HTTP/1.1 byte stream.  data[pos:] is not read
+    // yet.
+    std::string data;
+    size_t pos;
+    // The number of bytes at data[pos:] which came from header
+    // fields, and are not subject to flow control.
+    size_t headerLength;
+    // The flow control window we gave to the server, and the bytes
+    // read since the last WINDOW_UPDATE.
+    int32_t recvWindow;
+    int32_t consumed;
+    // Error code of RST_STREAM, or the reason of the failure.
+    uint32_t errorCode;
+    bool finalResponse;
+    bool endStream;
+    bool reset;
+    Command* command;
+    Stream();
+  };
+
+  std::shared_ptr<SocketCore> socket_;
+  DownloadEngine* e_;
+  SocketBuffer socketBuffer_;
+  HpackDecoder hpackDecoder_;
+  std::map<int32_t, Stream> streams_;
+
+  std::vector<unsigned char> rbuf_;
+  size_t rbufLen_;
+
+  // The header block of HEADERS and CONTINUATION frames being
+  // received, and its stream.  expectContinuation_ is true until
+  // END_HEADERS is received.
+  std::string headerBlock_;
+  int32_t headerStreamId_;
+  uint8_t headerFlags_;
+  bool expectContinuation_;
+
+  int32_t nextStreamId_;
+  int32_t lastStreamId_;
+  // The stream being read by readData().  Its command is not woken up.
+  int32_t readingStreamId_;
+  size_t maxConcurrentStreams_;
+  size_t maxFrameSize_;
+  int32_t connRecvWindow_;
+  int32_t connConsumed_;
+  bool settingsReceived_;
+  bool goawayReceived_;
+  // Non-empty if the connection is broken.
+  std::string error_;
+  Timer idleTimer_;
+
+  void queueFrame(uint8_t type, uint8_t flags, int32_t streamId,
+                  const std::string& payload);
+  void queueRstStream(int32_t streamId, uint32_t errorCode);
+  void queueWindowUpdate(int32_t streamId, int32_t increment);
+
+  // Throws DlRetryEx after queueing GOAWAY with |errorCode|.
+  void connectionError(uint32_t errorCode, const std::string& reason);
+  void resetStream(int32_t streamId, Stream& stream, uint32_t errorCode);
+  void fail(const std::string& error);
+  void wake(int32_t streamId, Stream& stream);
+  void consume(int32_t streamId, Stream& stream, size_t len);
+  // Sends WINDOW_UPDATE for the connection if enough data was
+  // consumed.
+  void updateConnectionWindow();
+
+  // Processes the frames in rbuf_ and returns the number of bytes
+  // processed.
+  size_t processFrames();
+  void processFrame(uint8_t type, uint8_t flags, int32_t streamId,
+                    const unsigned char* payload, size_t length);
+  void onData(uint8_t flags, int32_t streamId, const unsigned char* payload,
+              size_t length);
+  void onHeaders(uint8_t flags, int32_t streamId,
+                 const unsigned char* payload, size_t length);
+  void onContinuation(uint8_t flags, int32_t streamId,
+                      const unsigned char* payload, size_t length);
+  void onHeaderBlock();
+  void onSettings(uint8_t flags, int32_t streamId,
+                  const unsigned char* payload, size_t length);
+  void onGoaway(const unsigned char* payload, size_t length);
+};
+
+} // namespace aria2
+
+#endif // D_HTTP2_SESSION_H
@@ -35,6 +35,7 @@
 #include "HttpConnection.h"
 
 #include <sstream>
+#include <algorithm>
 
 #include "util.h"
 #include "message.h"
@@ -57,6 +58,7 @@
 #include "a2functional.h"
 #include "fmt.h"
 #include "SocketRecvBuffer.h"
+#include "Http2Session.h"
 #include "array_fun.h"
 
 namespace aria2 {
@@ -116,11 +118,70 @@ std::string HttpConnection::eraseConfidentialInfo(const std::string& request)
   return result;
 }
 
+namespace {
+// Converts HTTP/1.1 request header |request| to the header fields of
+// HTTP/2.  The connection-specific header fields are dropped.
+std::vector<hpack::HeaderField> createHttp2Headers(const std::string& request)
+{
+  typedef std::pair<std::string::const_iterator, std::string::const_iterator>
+      Scip;
+  std::vector<hpack::HeaderField> headers;
+  std::vector<Scip> lines;
+  util::splitIter(std::begin(request), std::end(request),
+                  std::back_inserter(lines), '\n', true);
+  if (lines.empty()) {
+    return headers;
+  }
+  std::vector<Scip> requestLine;
+  util::splitIter(lines[0].first, lines[0].second,
+                  std::back_inserter(requestLine), ' ', true);
+  if (requestLine.size() < 2) {
+    return headers;
+  }
+  headers.emplace_back(":method", std::string(requestLine[0].first,
+                                              requestLine[0].second));
+  headers.emplace_back(":scheme", "https");
+  headers.emplace_back(":authority", "");
+  headers.emplace_back(":path", std::string(requestLine[1].first,
+                                            requestLine[1].second));
+  for (auto i = std::begin(lines) + 1, eoi = std::end(lines); i != eoi; ++i) {
+    auto sep = std::find((*i).first, (*i).second, ':');
+    if (sep == (*i).second) {
+      continue;
+    }
+    auto name = util::toLower(std::string((*i).first, sep));
+    auto value = util::strip(std::string(sep + 1, (*i).second));
+    if (name == "host") {
+      headers[2].second = value;
+    }
+    else if (name != "connection" && name != "keep-alive" &&
+             name != "proxy-connection" && name != "transfer-encoding" &&
+             name != "upgrade") {
+      headers.emplace_back(std::move(name), std::move(value));
+    }
+  }
+  return headers;
+}
+} // namespace
+
 void HttpConnection::sendRequest(std::unique_ptr<HttpRequest> httpRequest,
                                  std::string request)
 {
   A2_LOG_INFO(
       fmt(MSG_SENDING_REQUEST, cuid_, eraseConfidentialInfo(request).c_str()));
+  if (http2Session_) {
+    if (socketRecvBuffer_->getHttp2Session()) {
+      throw DL_ABORT_EX("HTTP/2 stream cannot carry more than one request");
+    }
+    auto streamId = http2Session_->submitRequest(createHttp2Headers(request));
+    A2_LOG_INFO(fmt("CUID#%" PRId64 " - Request is sent on HTTP/2 stream %d",
+                    cuid_, streamId));
+    socketRecvBuffer_->setHttp2Stream(http2Session_, streamId);
+    http2Session_->send();
+    outstandingHttpRequests_.push_back(
+        make_unique<HttpRequestEntry>(std::move(httpRequest)));
+    return;
+  }
   socketBuffer_.pushStr(std::move(request));
   socketBuffer_.send();
   outstandingHttpRequests_.push_back(
@@ -145,8 +206,7 @@ std::unique_ptr<HttpResponse> HttpConnection::receiveResponse()
     throw DL_ABORT_EX(EX_NO_HTTP_REQUEST_ENTRY_FOUND);
   }
   if (socketRecvBuffer_->bufferEmpty()) {
-    if (socketRecvBuffer_->recv() == 0 && !socket_->wantRead() &&
-        !socket_->wantWrite()) {
+    if (socketRecvBuffer_->recv() == 0 && socketRecvBuffer_->eof()) {
       throw DL_RETRY_EX(EX_GOT_EOF);
     }
   }
@@ -189,9 +249,24 @@ bool HttpConnection::isIssued(const std::shared_ptr<Segment>& segment) const
 
 bool HttpConnection::sendBufferIsEmpty() const
 {
+  if (http2Session_) {
+    return !http2Session_->wantWrite();
+  }
   return socketBuffer_.sendBufferIsEmpty();
 }
 
-void HttpConnection::sendPendingData() { socketBuffer_.send(); }
+void HttpConnection::sendPendingData()
+{
+  if (http2Session_) {
+    http2Session_->send();
+    return;
+  }
+  socketBuffer_.send();
+}
+
+void HttpConnection::setHttp2Session(std::shared_ptr<Http2Session> session)
+{
+  http2Session_ = std::move(session);
+}
 
 } // namespace aria2
@@ -53,6 +53,7 @@ class Option;
 class Segment;
 class SocketCore;
 class SocketRecvBuffer;
+class Http2Session;
 
 class HttpRequestEntry {
 private:
@@ -84,6 +85,7 @@ private:
   std::shared_ptr<SocketCore> socket_;
   std::shared_ptr<SocketRecvBuffer> socketRecvBuffer_;
   SocketBuffer socketBuffer_;
+  std::shared_ptr<Http2Session> http2Session_;
 
   HttpRequestEntries outstandingHttpRequests_;
 
@@ -133,6 +135,15 @@ public:
   {
     return socketRecvBuffer_;
   }
+
+  // Sends the request as a stream of |session| instead of writing it
+  // to the socket.  Only one request can be sent in this mode.
+  void setHttp2Session(std::shared_ptr<Http2Session> session);
+
+  const std::shared_ptr<Http2Session>& getHttp2Session() const
+  {
+    return http2Session_;
+  }
 };
 
 } // namespace aria2
@@ -33,6 +33,9 @@
  */
 /* copyright --> */
 #include "HttpHeader.h"
+
+#include <algorithm>
+
 #include "Range.h"
 #include "util.h"
 #include "A2STR.h"
@@ -45,31 +48,56 @@ HttpHeader::HttpHeader() : statusCode_(0) {}
 
 HttpHeader::~HttpHeader() = default;
 
-void HttpHeader::put(int hdKey, const std::string& value)
+namespace {
+struct KeyLess {
+  bool operator()(const HttpHeader::FieldTable::value_type& field,
+                  int hdKey) const
+  {
+    return field.first < hdKey;
+  }
+  bool operator()(int hdKey,
+                  const HttpHeader::FieldTable::value_type& field) const
+  {
+    return hdKey < field.first;
+  }
+};
+} // namespace
+
+void HttpHeader::put(int hdKey, std::string value)
 {
-  std::multimap<int, std::string>::value_type vt(hdKey, value);
-  table_.insert(vt);
+  auto i = std::upper_bound(std::begin(table_), std::end(table_), hdKey,
+                            KeyLess());
+  table_.emplace(i, hdKey, std::move(value));
 }
 
-void HttpHeader::remove(int hdKey) { table_.erase(hdKey); }
+void HttpHeader::remove(int hdKey)
+{
+  auto r = equalRange(hdKey);
+  table_.erase(r.first, r.second);
+}
 
-bool HttpHeader::defined(int hdKey) const { return table_.count(hdKey); }
+bool HttpHeader::defined(int hdKey) const
+{
+  auto r = equalRange(hdKey);
+  return r.first != r.second;
+}
 
 const std::string& HttpHeader::find(int hdKey) const
 {
-  auto itr = table_.find(hdKey);
-  if (itr == table_.end()) {
+  auto i = std::lower_bound(std::begin(table_), std::end(table_), hdKey,
+                            KeyLess());
+  if (i == std::end(table_) || (*i).first != hdKey) {
     return A2STR::NIL;
   }
   else {
-    return (*itr).second;
+    return (*i).second;
   }
 }
 
 std::vector<std::string> HttpHeader::findAll(int hdKey) const
 {
   std::vector<std::string> v;
-  auto itrpair = table_.equal_range(hdKey);
+  auto itrpair = equalRange(hdKey);
   while (itrpair.first != itrpair.second) {
     v.push_back((*itrpair.first).second);
     ++itrpair.first;
@@ -77,11 +105,12 @@ std::vector<std::string> HttpHeader::findAll(int hdKey) const
   return v;
 }
 
-std::pair<std::multimap<int, std::string>::const_iterator,
-          std::multimap<int, std::string>::const_iterator>
+std::pair<HttpHeader::FieldTable::const_iterator,
+          HttpHeader::FieldTable::const_iterator>
 HttpHeader::equalRange(int hdKey) const
 {
-  return table_.equal_range(hdKey);
+  return std::equal_range(std::begin(table_), std::end(table_), hdKey,
+                          KeyLess());
 }
 
 Range HttpHeader::getRange() const
@@ -194,9 +223,7 @@ void HttpHeader::setReasonPhrase(const std::string& reasonPhrase)
 
 bool HttpHeader::fieldContains(int hdKey, const char* value)
 {
-  std::pair<std::multimap<int, std::string>::const_iterator,
-            std::multimap<int, std::string>::const_iterator>
-      range = equalRange(hdKey);
+  auto range = equalRange(hdKey);
   for (auto i = range.first; i != range.second; ++i) {
     std::vector<Scip> values;
     util::splitIter((*i).second.begin(), (*i).second.end(),
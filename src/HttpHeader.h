@@ -37,7 +37,6 @@
 
 #include "common.h"
 
-#include <map>
 #include <vector>
 #include <string>
 
@@ -46,8 +45,14 @@ namespace aria2 {
 struct Range;
 
 class HttpHeader {
+public:
+  // Header fields sorted by key.  Fields with the same key are kept
+  // in the order they were put.  A response carries only a handful of
+  // interesting fields, so a flat vector is cheaper than a tree.
+  typedef std::vector<std::pair<int, std::string>> FieldTable;
+
 private:
-  std::multimap<int, std::string> table_;
+  FieldTable table_;
 
   // HTTP status code, e.g. 200
   int statusCode_;
@@ -99,12 +104,11 @@ public:
   };
 
   // For all methods, use lowercased header field name.
-  void put(int hdKey, const std::string& value);
+  void put(int hdKey, std::string value);
   bool defined(int hdKey) const;
   const std::string& find(int hdKey) const;
   std::vector<std::string> findAll(int hdKey) const;
-  std::pair<std::multimap<int, std::string>::const_iterator,
-            std::multimap<int, std::string>::const_iterator>
+  std::pair<FieldTable::const_iterator, FieldTable::const_iterator>
   equalRange(int hdKey) const;
 
   void remove(int hdKey);
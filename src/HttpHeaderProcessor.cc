@@ -35,6 +35,7 @@
 #include "HttpHeaderProcessor.h"
 
 #include <vector>
+#include <algorithm>
 
 #include "HttpHeader.h"
 #include "message.h"
@@ -46,6 +47,15 @@
 
 namespace aria2 {
 
+namespace {
+// See Apache's documentation
+// http://httpd.apache.org/docs/2.2/en/mod/core.html about size
+// limit of HTTP headers. The page states that the number of request
+// fields rarely exceeds 20.
+constexpr size_t MAX_FIELD_NAME_LENGTH = 1024;
+constexpr size_t MAX_FIELD_VALUE_LENGTH = 8_k;
+} // namespace
+
 namespace {
 enum {
   // Server mode
@@ -137,10 +147,185 @@ size_t ignoreText(std::string& buf, const unsigned char* data, size_t length,
 }
 } // namespace
 
+namespace {
+// Returns the first CR or LF in [first, last), or last if there is
+// none.
+const unsigned char* findEol(const unsigned char* first,
+                             const unsigned char* last)
+{
+  for (; first != last && !util::isCRLF(*first); ++first)
+    ;
+  return first;
+}
+} // namespace
+
+namespace {
+// Returns the position just past the line terminator starting at
+// |eol|, or nullptr if the terminator is incomplete or is a lone CR.
+const unsigned char* skipEol(const unsigned char* eol,
+                             const unsigned char* last)
+{
+  if (eol == last) {
+    return nullptr;
+  }
+  if (*eol == '\r' && (++eol == last || *eol != '\n')) {
+    return nullptr;
+  }
+  return eol + 1;
+}
+} // namespace
+
+namespace {
+const unsigned char* findTokenEnd(const unsigned char* first,
+                                  const unsigned char* last)
+{
+  for (; first != last && !util::isLws(*first); ++first)
+    ;
+  return first;
+}
+} // namespace
+
+namespace {
+const unsigned char* skipLws(const unsigned char* first,
+                             const unsigned char* last)
+{
+  for (; first != last && util::isLws(*first); ++first)
+    ;
+  return first;
+}
+} // namespace
+
+namespace {
+// Looks up the field name [first, last) without allocating the
+// lowercased copy on the heap.
+int idFieldName(const unsigned char* first, const unsigned char* last)
+{
+  // Longer than any interesting header name
+  char name[32];
+  if (last - first >= static_cast<ptrdiff_t>(sizeof(name))) {
+    return HttpHeader::MAX_INTERESTING_HEADER;
+  }
+  std::transform(first, last, name, util::toLowerChar);
+  name[last - first] = '\0';
+  return idInterestingHeader(name);
+}
+} // namespace
+
+bool HttpHeaderProcessor::parseRequestLine(const unsigned char* first,
+                                           const unsigned char* last)
+{
+  auto methodLast = findTokenEnd(first, last);
+  if (methodLast == first || methodLast == last) {
+    return false;
+  }
+  auto path = skipLws(methodLast, last);
+  auto pathLast = findTokenEnd(path, last);
+  if (path == pathLast || pathLast == last) {
+    return false;
+  }
+  auto version = skipLws(pathLast, last);
+  if (version == last || findTokenEnd(version, last) != last) {
+    return false;
+  }
+  result_->setMethod(first, methodLast);
+  result_->setRequestPath(path, pathLast);
+  result_->setVersion(version, last);
+  return true;
+}
+
+bool HttpHeaderProcessor::parseStatusLine(const unsigned char* first,
+                                          const unsigned char* last)
+{
+  auto versionLast = findTokenEnd(first, last);
+  if (versionLast == first || versionLast == last) {
+    return false;
+  }
+  auto code = skipLws(versionLast, last);
+  auto codeLast = findTokenEnd(code, last);
+  if (codeLast - code != 3 || !util::isNumber(code, codeLast) ||
+      *code == '0') {
+    return false;
+  }
+  result_->setVersion(first, versionLast);
+  result_->setStatusCode((code[0] - '0') * 100 + (code[1] - '0') * 10 +
+                         (code[2] - '0'));
+  auto reasonPhrase = skipLws(codeLast, last);
+  if (reasonPhrase != last) {
+    result_->setReasonPhrase(std::string(reasonPhrase, last));
+  }
+  return true;
+}
+
+bool HttpHeaderProcessor::parseAll(const unsigned char* data, size_t length)
+{
+  auto last = data + length;
+  auto eol = findEol(data, last);
+  auto next = skipEol(eol, last);
+  if (!next) {
+    return false;
+  }
+  if (mode_ == CLIENT_PARSER ? !parseStatusLine(data, eol)
+                             : !parseRequestLine(data, eol)) {
+    return false;
+  }
+  for (;;) {
+    auto line = next;
+    eol = findEol(line, last);
+    next = skipEol(eol, last);
+    if (!next) {
+      return false;
+    }
+    if (line == eol) {
+      break;
+    }
+    // Multi-line header fields are left to the state machine.
+    if (util::isLws(*line)) {
+      return false;
+    }
+    auto colon = line;
+    for (; colon != eol && *colon != ':' && !util::isLws(*colon); ++colon)
+      ;
+    if (colon == line || colon == eol || *colon != ':') {
+      return false;
+    }
+    // Enforce the same limits as the state machine does.  The values
+    // of uninteresting fields are not stored, so they are not limited.
+    if (static_cast<size_t>(colon - line) > MAX_FIELD_NAME_LENGTH) {
+      throw DL_ABORT_EX("Too large HTTP header");
+    }
+    auto hdKey = idFieldName(line, colon);
+    if (hdKey != HttpHeader::MAX_INTERESTING_HEADER) {
+      auto value = util::stripIter(colon + 1, eol);
+      if (static_cast<size_t>(value.second - value.first) >
+          MAX_FIELD_VALUE_LENGTH) {
+        throw DL_ABORT_EX("Too large HTTP header");
+      }
+      result_->put(hdKey, std::string(value.first, value.second));
+    }
+  }
+  state_ = HEADERS_COMPLETE;
+  lastBytesProcessed_ = next - data;
+  headers_.assign(data, next);
+  return true;
+}
+
 bool HttpHeaderProcessor::parse(const unsigned char* data, size_t length)
 {
-  size_t i;
   lastBytesProcessed_ = 0;
+  // Most of the time the whole header arrives at once.  Then it is
+  // parsed in place in one pass without copying it piece by piece.
+  // Otherwise, the state machine below does the work incrementally,
+  // and it also reports the errors.
+  if (headers_.empty() &&
+      state_ == (mode_ == CLIENT_PARSER ? PREV_RES_VERSION : PREV_METHOD)) {
+    if (parseAll(data, length)) {
+      finalizeResult();
+      return true;
+    }
+    result_ = make_unique<HttpHeader>();
+  }
+
+  size_t i;
   for (i = 0; i < length; ++i) {
     unsigned char c = data[i];
     switch (state_) {
@@ -245,6 +430,7 @@ bool HttpHeaderProcessor::parse(const unsigned char* data, size_t length)
         throw DL_ABORT_EX("Bad Status-Line: missing status-code");
       }
 
+      i = getToken(buf_, data, length, i);
       break;
 
     case PREV_STATUS_CODE:
@@ -433,11 +619,8 @@ bool HttpHeaderProcessor::parse(const unsigned char* data, size_t length)
   }
 
 fin:
-  // See Apache's documentation
-  // http://httpd.apache.org/docs/2.2/en/mod/core.html about size
-  // limit of HTTP headers. The page states that the number of request
-  // fields rarely exceeds 20.
-  if (lastFieldName_.size() > 1024 || buf_.size() > 8_k) {
+  if (lastFieldName_.size() > MAX_FIELD_NAME_LENGTH ||
+      buf_.size() > MAX_FIELD_VALUE_LENGTH) {
     throw DL_ABORT_EX("Too large HTTP header");
   }
 
@@ -448,6 +631,13 @@ fin:
     return false;
   }
 
+  finalizeResult();
+
+  return true;
+}
+
+void HttpHeaderProcessor::finalizeResult()
+{
   // If both transfer-encoding and (content-length or content-range)
   // are present, delete content-length and content-range.  RFC 7230
   // says that sender must not send both transfer-encoding and
@@ -459,8 +649,6 @@ fin:
     result_->remove(HttpHeader::CONTENT_LENGTH);
     result_->remove(HttpHeader::CONTENT_RANGE);
   }
-
-  return true;
 }
 
 bool HttpHeaderProcessor::parse(const std::string& data)
@@ -81,6 +81,15 @@ public:
   void clear();
 
 private:
+  // Parses the header when it is entirely contained in
+  // data[0..length).  Returns false if it is incomplete or needs the
+  // attention of the incremental parser.
+  bool parseAll(const unsigned char* data, size_t length);
+  bool parseRequestLine(const unsigned char* first,
+                        const unsigned char* last);
+  bool parseStatusLine(const unsigned char* first, const unsigned char* last);
+  void finalizeResult();
+
   ParserMode mode_;
   int state_;
   size_t lastBytesProcessed_;
@@ -55,6 +55,7 @@
 #include "ConnectCommand.h"
 #include "HttpRequestConnectChain.h"
 #include "HttpProxyRequestConnectChain.h"
+#include "Http2Session.h"
 
 namespace aria2 {
 
@@ -116,6 +117,25 @@ std::unique_ptr<Command> HttpInitiateConnectionCommand::createNextCommand(
     }
   }
   else {
+    if (getRequest()->getProtocol() == "https" &&
+        getOption()->getAsBool(PREF_ENABLE_HTTP2)) {
+      auto session = getDownloadEngine()->findHttp2Session(
+          getRequest()->getHost(), getRequest()->getPort());
+      if (session) {
+        A2_LOG_INFO(fmt("CUID#%" PRId64 " - Reusing HTTP/2 connection",
+                        getCuid()));
+        setSocket(session->getSocket());
+        setConnectedAddrInfo(getRequest(), hostname, getSocket());
+        auto httpConnection = std::make_shared<HttpConnection>(
+            getCuid(), getSocket(),
+            std::make_shared<SocketRecvBuffer>(getSocket()));
+        httpConnection->setHttp2Session(std::move(session));
+        getRequest()->setPipeliningHint(false);
+        return make_unique<HttpRequestCommand>(
+            getCuid(), getRequest(), getFileEntry(), getRequestGroup(),
+            httpConnection, getDownloadEngine(), getSocket());
+      }
+    }
     std::shared_ptr<SocketCore> pooledSocket =
         getDownloadEngine()->popPooledSocket(resolvedAddresses,
                                              getRequest()->getPort());
@@ -59,6 +59,8 @@
 #include "LogFactory.h"
 #include "fmt.h"
 #include "SocketRecvBuffer.h"
+#include "Http2Session.h"
+#include "SocketPool.h"
 
 namespace aria2 {
 
@@ -74,6 +76,16 @@ HttpRequestCommand::HttpRequestCommand(
   setTimeout(std::chrono::seconds(getOption()->getAsInt(PREF_CONNECT_TIMEOUT)));
   disableReadCheckSocket();
   setWriteCheckSocket(getSocket());
+#ifdef ENABLE_SSL
+  if (req->getProtocol() == "https" &&
+      getOption()->getAsBool(PREF_ENABLE_HTTP2) && !isProxyDefined()) {
+    getSocket()->setAlpnProtocols({"h2", "http/1.1"});
+  }
+  if (req->getProtocol() == "https") {
+    getSocket()->setTlsSessionData(e->getSocketPool()->getTlsSessionData(
+        req->getHost(), req->getPort()));
+  }
+#endif // ENABLE_SSL
 }
 
 HttpRequestCommand::~HttpRequestCommand() = default;
@@ -130,6 +142,23 @@ bool HttpRequestCommand::executeInternal()
         addCommandSelf();
         return false;
       }
+      auto tlsSessionData = getSocket()->getTlsSessionData();
+      if (!tlsSessionData.empty()) {
+        getDownloadEngine()->getSocketPool()->putTlsSessionData(
+            getRequest()->getHost(), getRequest()->getPort(),
+            std::move(tlsSessionData));
+      }
+      if (!httpConnection_->getHttp2Session() &&
+          getSocket()->getAlpnProtocol() == "h2") {
+        A2_LOG_INFO(fmt("CUID#%" PRId64 " - Using HTTP/2", getCuid()));
+        auto session =
+            std::make_shared<Http2Session>(getSocket(), getDownloadEngine());
+        getDownloadEngine()->addHttp2Session(getRequest()->getHost(),
+                                             getRequest()->getPort(), session);
+        httpConnection_->setHttp2Session(std::move(session));
+        // A stream carries only one request.
+        getRequest()->setPipeliningHint(false);
+      }
     }
 #endif // ENABLE_SSL
     if (getSegments().empty()) {
@@ -188,6 +217,9 @@ bool HttpRequestCommand::executeInternal()
               createHttpRequest(getRequest(), getFileEntry(), segment,
                                 getOption(), getRequestGroup(),
                                 getDownloadEngine(), proxyRequest_, endOffset));
+          if (httpConnection_->getHttp2Session()) {
+            break;
+          }
         }
       }
     }
@@ -239,6 +239,7 @@ bool HttpServerBodyCommand::execute()
             return true;
           }
           A2_LOG_INFO(fmt("Executing RPC method %s", req.methodName.c_str()));
+          req.directEncoding = true;
           auto method = rpc::getMethod(req.methodName);
           auto res = method->execute(std::move(req), e_);
           bool gzip = httpServer_->supportsGZip();
@@ -113,8 +113,8 @@ bool HttpSkipResponseCommand::executeInternal()
   try {
     size_t bufSize;
     if (getSocketRecvBuffer()->bufferEmpty()) {
-      eof = getSocketRecvBuffer()->recv() == 0 && !getSocket()->wantRead() &&
-            !getSocket()->wantWrite();
+      eof = getSocketRecvBuffer()->recv() == 0 &&
+            getSocketRecvBuffer()->eof();
     }
     if (!eof) {
       if (sinkFilterOnly_) {
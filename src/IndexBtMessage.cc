@@ -40,6 +40,13 @@
 namespace aria2 {
 
 std::vector<unsigned char> IndexBtMessage::createMessage()
+{
+  auto msg = std::vector<unsigned char>(MESSAGE_LENGTH);
+  writeMessage(msg.data());
+  return msg;
+}
+
+size_t IndexBtMessage::writeMessage(unsigned char* buf)
 {
   /**
    * len --- 5, 4bytes
@@ -47,10 +54,9 @@ std::vector<unsigned char> IndexBtMessage::createMessage()
    * piece index --- index, 4bytes
    * total: 9bytes
    */
-  auto msg = std::vector<unsigned char>(MESSAGE_LENGTH);
-  bittorrent::createPeerMessageString(msg.data(), MESSAGE_LENGTH, 5, getId());
-  bittorrent::setIntParam(&msg[5], index_);
-  return msg;
+  bittorrent::createPeerMessageString(buf, MESSAGE_LENGTH, 5, getId());
+  bittorrent::setIntParam(&buf[5], index_);
+  return MESSAGE_LENGTH;
 }
 
 std::string IndexBtMessage::toString() const
@@ -67,6 +67,8 @@ public:
 
   virtual std::vector<unsigned char> createMessage() CXX11_OVERRIDE;
 
+  virtual size_t writeMessage(unsigned char* buf) CXX11_OVERRIDE;
+
   virtual std::string toString() const CXX11_OVERRIDE;
 };
 
@@ -35,16 +35,19 @@
 
 #include "InternalARC4Encryptor.h"
 
+#include <cstring>
+
 namespace aria2 {
 
-void ARC4Encryptor::init(const unsigned char* key, size_t keyLength)
+void InternalARC4Encryptor::init(const unsigned char* key,
+                                 size_t keyLength)
 {
   j = 0;
   for (auto& c : state_)
     c = j++;
 
   j = 0;
-  for (i = 0; i < sizeof(state_); ++i) {
+  for (i = 0; i < sizeof(state_) / sizeof(state_[0]); ++i) {
     j = (j + state_[i] + key[i % keyLength]) & 0xff;
     auto tmp = state_[i];
     state_[i] = state_[j];
@@ -53,17 +56,64 @@ void ARC4Encryptor::init(const unsigned char* key, size_t keyLength)
   i = j = 0;
 }
 
-void ARC4Encryptor::encrypt(size_t len, unsigned char* out,
-                            const unsigned char* in)
+namespace {
+// Produces the next byte of the key stream. |sx| holds state[x + 1],
+// which is loaded before the current swap is stored so that the
+// next step does not depend on the store.
+inline uint64_t next(uint32_t* state, uint32_t& x, uint32_t& y,
+                     uint32_t& sx)
+{
+  x = (x + 1) & 0xff;
+  y = (y + sx) & 0xff;
+  auto sy = state[y];
+  auto nx = (x + 1) & 0xff;
+  auto sn = state[nx];
+  state[y] = sx;
+  state[x] = sy;
+  auto k = state[(sx + sy) & 0xff];
+  // If the swap above touched state[x + 1], we already have it in sx.
+  sx = nx == y ? sx : sn;
+  return k;
+}
+} // namespace
+
+namespace {
+constexpr int shift(int n)
 {
-  for (auto c = 0u; c < len; ++c) {
-    i = (i + 1) & 0xff;
-    j = (j + state_[i]) & 0xff;
-    auto sj = state_[i];
-    auto si = state_[i] = state_[j];
-    state_[j] = sj;
-    out[c] = in[c] ^ state_[(si + sj) & 0xff];
+#ifdef WORDS_BIGENDIAN
+  return 56 - n * 8;
+#else  // !WORDS_BIGENDIAN
+  return n * 8;
+#endif // !WORDS_BIGENDIAN
+}
+} // namespace
+
+void InternalARC4Encryptor::encrypt(size_t len, unsigned char* out,
+                                    const unsigned char* in)
+{
+  auto x = i;
+  auto y = j;
+  auto sx = state_[(x + 1) & 0xff];
+  // Generate 8 bytes of key stream and XOR them in one go.
+  for (; len >= 8; len -= 8, in += 8, out += 8) {
+    uint64_t k = next(state_, x, y, sx) << shift(0);
+    k |= next(state_, x, y, sx) << shift(1);
+    k |= next(state_, x, y, sx) << shift(2);
+    k |= next(state_, x, y, sx) << shift(3);
+    k |= next(state_, x, y, sx) << shift(4);
+    k |= next(state_, x, y, sx) << shift(5);
+    k |= next(state_, x, y, sx) << shift(6);
+    k |= next(state_, x, y, sx) << shift(7);
+    uint64_t d;
+    memcpy(&d, in, sizeof(d));
+    d ^= k;
+    memcpy(out, &d, sizeof(d));
+  }
+  for (size_t c = 0; c < len; ++c) {
+    out[c] = in[c] ^ next(state_, x, y, sx);
   }
+  i = x;
+  j = y;
 }
 
 } // namespace aria2
@@ -39,10 +39,13 @@
 
 namespace aria2 {
 
-class ARC4Encryptor {
+class InternalARC4Encryptor {
 private:
-  unsigned char state_[256];
-  unsigned i, j;
+  // The permutation is kept in word sized entries. Byte sized
+  // entries make every swap a partial store which the following
+  // key stream lookup has to wait for.
+  uint32_t state_[256];
+  uint32_t i, j;
 
 public:
   void init(const unsigned char* key, size_t keyLength);
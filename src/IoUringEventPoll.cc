@@ -0,0 +1,530 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2009 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "IoUringEventPoll.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+
+#include "Command.h"
+#include "LogFactory.h"
+#include "Logger.h"
+#include "util.h"
+#include "a2functional.h"
+#include "fmt.h"
+
+namespace aria2 {
+
+namespace {
+// user_data of requests whose completions are not interesting: poll
+// removals and timeouts.  Socket poll requests never have the most
+// significant bit set because it encodes a non-negative socket.
+constexpr uint64_t IGNORED_USER_DATA = 1ULL << 63;
+
+uint64_t toUserData(sock_t socket, uint32_t armId)
+{
+  return (static_cast<uint64_t>(socket) << 32) | armId;
+}
+
+int ioUringSetup(unsigned entries, struct io_uring_params* params)
+{
+  return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete,
+                 unsigned flags)
+{
+  return syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags,
+                 nullptr, 0);
+}
+} // namespace
+
+IoUringEventPoll::KSocketEntry::KSocketEntry(sock_t s)
+    : SocketEntry<KCommandEvent, KADNSEvent>(s),
+      armId_(0),
+      armedEvents_(0),
+      dirty_(false)
+{
+}
+
+int accumulateEvent(int events, const IoUringEventPoll::KEvent& event)
+{
+  return events | event.getEvents();
+}
+
+int IoUringEventPoll::KSocketEntry::getEvents()
+{
+#ifdef ENABLE_ASYNC_DNS
+
+  return std::accumulate(adnsEvents_.begin(), adnsEvents_.end(),
+                         std::accumulate(commandEvents_.begin(),
+                                         commandEvents_.end(), 0,
+                                         accumulateEvent),
+                         accumulateEvent);
+
+#else // !ENABLE_ASYNC_DNS
+
+  return std::accumulate(commandEvents_.begin(), commandEvents_.end(), 0,
+                         accumulateEvent);
+
+#endif // !ENABLE_ASYNC_DNS
+}
+
+IoUringEventPoll::IoUringEventPoll()
+    : ringfd_(-1),
+      sqRing_(nullptr),
+      sqRingSize_(0),
+      cqRing_(nullptr),
+      cqRingSize_(0),
+      sqes_(nullptr),
+      sqesSize_(0),
+      sqHead_(nullptr),
+      sqTail_(nullptr),
+      sqRingMask_(nullptr),
+      sqArray_(nullptr),
+      sqEntries_(0),
+      sqTailLocal_(0),
+      cqHead_(nullptr),
+      cqTail_(nullptr),
+      cqRingMask_(nullptr),
+      cqes_(nullptr),
+      nextArmId_(0),
+      numEvents_(0),
+      timeout_{0, 0}
+{
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ringfd_ = ioUringSetup(IO_URING_ENTRIES, &params);
+  if (ringfd_ == -1) {
+    int errNum = errno;
+    A2_LOG_INFO(
+        fmt("io_uring_setup failed: %s", util::safeStrerror(errNum).c_str()));
+    return;
+  }
+
+  sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cqRingSize_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+  }
+
+  auto p = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQ_RING);
+  if (p == MAP_FAILED) {
+    sqRingSize_ = 0;
+    close(ringfd_);
+    ringfd_ = -1;
+    return;
+  }
+  sqRing_ = static_cast<unsigned char*>(p);
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    cqRing_ = sqRing_;
+  }
+  else {
+    p = mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_CQ_RING);
+    if (p == MAP_FAILED) {
+      cqRingSize_ = 0;
+      close(ringfd_);
+      ringfd_ = -1;
+      return;
+    }
+    cqRing_ = static_cast<unsigned char*>(p);
+  }
+
+  sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  p = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQES);
+  if (p == MAP_FAILED) {
+    sqesSize_ = 0;
+    close(ringfd_);
+    ringfd_ = -1;
+    return;
+  }
+  sqes_ = static_cast<struct io_uring_sqe*>(p);
+
+  sqHead_ = reinterpret_cast<unsigned*>(sqRing_ + params.sq_off.head);
+  sqTail_ = reinterpret_cast<unsigned*>(sqRing_ + params.sq_off.tail);
+  sqRingMask_ = reinterpret_cast<unsigned*>(sqRing_ + params.sq_off.ring_mask);
+  sqArray_ = reinterpret_cast<unsigned*>(sqRing_ + params.sq_off.array);
+  sqEntries_ = params.sq_entries;
+  sqTailLocal_ = *sqTail_;
+
+  cqHead_ = reinterpret_cast<unsigned*>(cqRing_ + params.cq_off.head);
+  cqTail_ = reinterpret_cast<unsigned*>(cqRing_ + params.cq_off.tail);
+  cqRingMask_ = reinterpret_cast<unsigned*>(cqRing_ + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<struct io_uring_cqe*>(cqRing_ + params.cq_off.cqes);
+}
+
+IoUringEventPoll::~IoUringEventPoll()
+{
+  if (sqes_) {
+    munmap(sqes_, sqesSize_);
+  }
+  if (cqRing_ && cqRing_ != sqRing_) {
+    munmap(cqRing_, cqRingSize_);
+  }
+  if (sqRing_) {
+    munmap(sqRing_, sqRingSize_);
+  }
+  if (ringfd_ != -1) {
+    int r = close(ringfd_);
+    int errNum = errno;
+    if (r == -1) {
+      A2_LOG_ERROR(fmt("Error occurred while closing io_uring file descriptor"
+                       " %d: %s",
+                       ringfd_, util::safeStrerror(errNum).c_str()));
+    }
+  }
+}
+
+bool IoUringEventPoll::good() const { return ringfd_ != -1; }
+
+int IoUringEventPoll::submit(unsigned waitNr)
+{
+  __atomic_store_n(sqTail_, sqTailLocal_, __ATOMIC_RELEASE);
+  unsigned flags = waitNr > 0 ? IORING_ENTER_GETEVENTS : 0;
+  for (;;) {
+    unsigned toSubmit = sqTailLocal_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    if (toSubmit == 0 && waitNr == 0) {
+      return 0;
+    }
+    int r = ioUringEnter(ringfd_, toSubmit, waitNr, flags);
+    if (r == -1) {
+      int errNum = errno;
+      if (errNum == EINTR) {
+        continue;
+      }
+      A2_LOG_INFO(fmt("io_uring_enter error: %s",
+                      util::safeStrerror(errNum).c_str()));
+    }
+    return r;
+  }
+}
+
+struct io_uring_sqe* IoUringEventPoll::getSqe()
+{
+  if (sqTailLocal_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >=
+      sqEntries_) {
+    submit(0);
+    if (sqTailLocal_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >=
+        sqEntries_) {
+      // The kernel refuses new submissions while completions are
+      // backlogged.  Drain them and try again.
+      reapCompletions();
+      submit(0);
+    }
+  }
+  auto idx = sqTailLocal_ & *sqRingMask_;
+  auto sqe = &sqes_[idx];
+  memset(sqe, 0, sizeof(*sqe));
+  sqArray_[idx] = idx;
+  ++sqTailLocal_;
+  return sqe;
+}
+
+void IoUringEventPoll::markDirty(KSocketEntry& socketEntry)
+{
+  if (!socketEntry.isDirty()) {
+    socketEntry.setDirty(true);
+    dirtySockets_.push_back(socketEntry.getSocket());
+  }
+}
+
+void IoUringEventPoll::flushChanges()
+{
+  for (auto userData : pendingRemoves_) {
+    auto sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = userData;
+    sqe->user_data = IGNORED_USER_DATA;
+  }
+  pendingRemoves_.clear();
+
+  // getSqe() may reap completions, which appends to dirtySockets_.
+  std::vector<sock_t> dirtySockets;
+  dirtySockets.swap(dirtySockets_);
+  for (auto socket : dirtySockets) {
+    auto i = socketEntries_.find(socket);
+    if (i == std::end(socketEntries_)) {
+      continue;
+    }
+    auto& socketEntry = (*i).second;
+    socketEntry.setDirty(false);
+    int events = socketEntry.getEvents();
+    if (socketEntry.getArmId()) {
+      if (socketEntry.getArmedEvents() == events) {
+        continue;
+      }
+      auto sqe = getSqe();
+      sqe->opcode = IORING_OP_POLL_REMOVE;
+      sqe->fd = -1;
+      sqe->addr = toUserData(socket, socketEntry.getArmId());
+      sqe->user_data = IGNORED_USER_DATA;
+      socketEntry.setArmed(0, 0);
+    }
+    if (events == 0) {
+      continue;
+    }
+    if (++nextArmId_ == 0) {
+      ++nextArmId_;
+    }
+    uint32_t pollEvents = events;
+#ifdef WORDS_BIGENDIAN
+    // The kernel expects poll32_events word-reversed on big endian.
+    pollEvents = (pollEvents << 16) | (pollEvents >> 16);
+#endif // WORDS_BIGENDIAN
+    auto sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = socket;
+    sqe->poll32_events = pollEvents;
+    sqe->user_data = toUserData(socket, nextArmId_);
+    socketEntry.setArmed(nextArmId_, events);
+  }
+}
+
+int IoUringEventPoll::reapCompletions()
+{
+  int numEvents = 0;
+  for (;;) {
+    unsigned head = *cqHead_;
+    unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      break;
+    }
+    for (; head != tail; ++head) {
+      const auto& cqe = cqes_[head & *cqRingMask_];
+      uint64_t userData = cqe.user_data;
+      int res = cqe.res;
+      if (userData & IGNORED_USER_DATA) {
+        continue;
+      }
+      auto i = socketEntries_.find(static_cast<sock_t>(userData >> 32));
+      if (i == std::end(socketEntries_) ||
+          (*i).second.getArmId() != static_cast<uint32_t>(userData)) {
+        // Completion of a poll request which has been replaced or
+        // removed.
+        continue;
+      }
+      auto& socketEntry = (*i).second;
+      socketEntry.setArmed(0, 0);
+      if (res < 0) {
+        // Do not re-arm here, otherwise a bad socket makes every
+        // poll() return immediately.  It is re-armed when its
+        // interest set changes.
+        A2_LOG_DEBUG(fmt("io_uring poll error on socket %d: %s",
+                         socketEntry.getSocket(),
+                         util::safeStrerror(-res).c_str()));
+        continue;
+      }
+      // Poll requests are oneshot.  Re-arm in the next submission.
+      markDirty(socketEntry);
+      socketEntry.processEvents(res);
+      ++numEvents;
+    }
+    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+  }
+  numEvents_ += numEvents;
+  return numEvents;
+}
+
+void IoUringEventPoll::poll(const struct timeval& tv)
+{
+  numEvents_ = 0;
+  flushChanges();
+
+  // flushChanges() may have already received events.  Then do not
+  // block, so that the commands run without delay.
+  if (numEvents_ == 0 && (tv.tv_sec > 0 || tv.tv_usec > 0)) {
+    timeout_.tv_sec = tv.tv_sec;
+    timeout_.tv_nsec = tv.tv_usec * 1000;
+    auto sqe = getSqe();
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(&timeout_);
+    sqe->len = 1;
+    // Complete the timeout as soon as one other request completes.
+    sqe->off = 1;
+    sqe->user_data = IGNORED_USER_DATA;
+    submit(1);
+  }
+  else {
+    submit(0);
+  }
+  reapCompletions();
+
+#ifdef ENABLE_ASYNC_DNS
+  // It turns out that we have to call ares_process_fd before ares's
+  // own timeout and ares may create new sockets or closes socket in
+  // their API. So we call ares_process_fd for all ares_channel and
+  // re-register their sockets.
+  for (auto& i : nameResolverEntries_) {
+    auto& ent = i.second;
+    ent.processTimeout();
+    ent.removeSocketEvents(this);
+    ent.addSocketEvents(this);
+  }
+#endif // ENABLE_ASYNC_DNS
+
+  // TODO timeout of name resolver is determined in Command(AbstractCommand,
+  // DHTEntryPoint...Command)
+}
+
+int IoUringEventPoll::translateEvents(EventPoll::EventType events)
+{
+  int newEvents = 0;
+  if (EventPoll::EVENT_READ & events) {
+    newEvents |= IEV_READ;
+  }
+  if (EventPoll::EVENT_WRITE & events) {
+    newEvents |= IEV_WRITE;
+  }
+  if (EventPoll::EVENT_ERROR & events) {
+    newEvents |= IEV_ERROR;
+  }
+  if (EventPoll::EVENT_HUP & events) {
+    newEvents |= IEV_HUP;
+  }
+  return newEvents;
+}
+
+bool IoUringEventPoll::addEvents(sock_t socket,
+                                 const IoUringEventPoll::KEvent& event)
+{
+  auto i = socketEntries_.lower_bound(socket);
+  if (i == std::end(socketEntries_) || (*i).first != socket) {
+    i = socketEntries_.insert(i, std::make_pair(socket, KSocketEntry(socket)));
+  }
+  auto& socketEntry = (*i).second;
+  event.addSelf(&socketEntry);
+  markDirty(socketEntry);
+  return true;
+}
+
+bool IoUringEventPoll::addEvents(sock_t socket, Command* command,
+                                 EventPoll::EventType events)
+{
+  return addEvents(socket, KCommandEvent(command, translateEvents(events)));
+}
+
+#ifdef ENABLE_ASYNC_DNS
+bool IoUringEventPoll::addEvents(sock_t socket, Command* command, int events,
+                                 const std::shared_ptr<AsyncNameResolver>& rs)
+{
+  return addEvents(socket, KADNSEvent(rs, command, socket, events));
+}
+#endif // ENABLE_ASYNC_DNS
+
+bool IoUringEventPoll::deleteEvents(sock_t socket,
+                                    const IoUringEventPoll::KEvent& event)
+{
+  auto i = socketEntries_.find(socket);
+  if (i == std::end(socketEntries_)) {
+    A2_LOG_DEBUG(fmt("Socket %d is not found in SocketEntries.", socket));
+    return false;
+  }
+
+  auto& socketEntry = (*i).second;
+  event.removeSelf(&socketEntry);
+  if (socketEntry.eventEmpty()) {
+    // The poll request in flight holds a reference to the socket, so
+    // it must be cancelled even if the socket is closed.
+    if (socketEntry.getArmId()) {
+      pendingRemoves_.push_back(toUserData(socket, socketEntry.getArmId()));
+    }
+    socketEntries_.erase(i);
+  }
+  else {
+    markDirty(socketEntry);
+  }
+  return true;
+}
+
+#ifdef ENABLE_ASYNC_DNS
+bool IoUringEventPoll::deleteEvents(
+    sock_t socket, Command* command,
+    const std::shared_ptr<AsyncNameResolver>& rs)
+{
+  return deleteEvents(socket, KADNSEvent(rs, command, socket, 0));
+}
+#endif // ENABLE_ASYNC_DNS
+
+bool IoUringEventPoll::deleteEvents(sock_t socket, Command* command,
+                                    EventPoll::EventType events)
+{
+  return deleteEvents(socket, KCommandEvent(command, translateEvents(events)));
+}
+
+#ifdef ENABLE_ASYNC_DNS
+bool IoUringEventPoll::addNameResolver(
+    const std::shared_ptr<AsyncNameResolver>& resolver, Command* command)
+{
+  auto key = std::make_pair(resolver.get(), command);
+  auto itr = nameResolverEntries_.lower_bound(key);
+
+  if (itr != std::end(nameResolverEntries_) && (*itr).first == key) {
+    return false;
+  }
+
+  itr = nameResolverEntries_.insert(
+      itr, std::make_pair(key, KAsyncNameResolverEntry(resolver, command)));
+  (*itr).second.addSocketEvents(this);
+  return true;
+}
+
+bool IoUringEventPoll::deleteNameResolver(
+    const std::shared_ptr<AsyncNameResolver>& resolver, Command* command)
+{
+  auto key = std::make_pair(resolver.get(), command);
+  auto itr = nameResolverEntries_.find(key);
+  if (itr == std::end(nameResolverEntries_)) {
+    return false;
+  }
+
+  (*itr).second.removeSocketEvents(this);
+  nameResolverEntries_.erase(itr);
+  return true;
+}
+#endif // ENABLE_ASYNC_DNS
+
+} // namespace aria2
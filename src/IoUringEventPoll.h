@@ -0,0 +1,214 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2009 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_IO_URING_EVENT_POLL_H
+#define D_IO_URING_EVENT_POLL_H
+
+#include "EventPoll.h"
+
+#include <poll.h>
+#include <linux/io_uring.h>
+
+#include <map>
+#include <vector>
+
+#include "Event.h"
+#include "a2functional.h"
+#ifdef ENABLE_ASYNC_DNS
+#include "AsyncNameResolver.h"
+#endif // ENABLE_ASYNC_DNS
+
+namespace aria2 {
+
+// EventPoll implementation on top of Linux io_uring.  Each socket has
+// at most one oneshot IORING_OP_POLL_ADD request in flight.  Changes
+// to the interest set made by commands are not sent to the kernel
+// immediately; they are coalesced per socket and submitted, together
+// with re-arming the polls which fired in the previous turn, in the
+// single io_uring_enter(2) call made by poll().
+class IoUringEventPoll : public EventPoll {
+private:
+  class KSocketEntry;
+
+  typedef Event<KSocketEntry> KEvent;
+  typedef CommandEvent<KSocketEntry, IoUringEventPoll> KCommandEvent;
+  typedef ADNSEvent<KSocketEntry, IoUringEventPoll> KADNSEvent;
+  typedef AsyncNameResolverEntry<IoUringEventPoll> KAsyncNameResolverEntry;
+  friend class AsyncNameResolverEntry<IoUringEventPoll>;
+
+  class KSocketEntry : public SocketEntry<KCommandEvent, KADNSEvent> {
+  private:
+    // Identifier of the poll request in flight, or 0 if none.
+    uint32_t armId_;
+    // Events the poll request in flight waits for.
+    int armedEvents_;
+    // true if this entry is in dirtySockets_.
+    bool dirty_;
+
+  public:
+    KSocketEntry(sock_t socket);
+
+    KSocketEntry(const KSocketEntry&) = delete;
+    KSocketEntry(KSocketEntry&&) = default;
+
+    int getEvents();
+
+    uint32_t getArmId() const { return armId_; }
+
+    int getArmedEvents() const { return armedEvents_; }
+
+    void setArmed(uint32_t armId, int events)
+    {
+      armId_ = armId;
+      armedEvents_ = events;
+    }
+
+    bool isDirty() const { return dirty_; }
+
+    void setDirty(bool f) { dirty_ = f; }
+  };
+
+  friend int accumulateEvent(int events, const KEvent& event);
+
+private:
+  typedef std::map<sock_t, KSocketEntry> KSocketEntrySet;
+  KSocketEntrySet socketEntries_;
+#ifdef ENABLE_ASYNC_DNS
+  typedef std::map<std::pair<AsyncNameResolver*, Command*>,
+                   KAsyncNameResolverEntry>
+      KAsyncNameResolverEntrySet;
+  KAsyncNameResolverEntrySet nameResolverEntries_;
+#endif // ENABLE_ASYNC_DNS
+
+  int ringfd_;
+
+  unsigned char* sqRing_;
+  size_t sqRingSize_;
+  unsigned char* cqRing_;
+  size_t cqRingSize_;
+  struct io_uring_sqe* sqes_;
+  size_t sqesSize_;
+
+  unsigned* sqHead_;
+  unsigned* sqTail_;
+  unsigned* sqRingMask_;
+  unsigned* sqArray_;
+  unsigned sqEntries_;
+  // Tail of SQ ring which is not yet published to the kernel.
+  unsigned sqTailLocal_;
+
+  unsigned* cqHead_;
+  unsigned* cqTail_;
+  unsigned* cqRingMask_;
+  struct io_uring_cqe* cqes_;
+
+  // Sockets whose interest set changed or whose poll request
+  // completed since the last submission.
+  std::vector<sock_t> dirtySockets_;
+
+  // Poll requests to cancel in the next submission, because their
+  // socket entries have been removed.
+  std::vector<uint64_t> pendingRemoves_;
+
+  uint32_t nextArmId_;
+
+  // The number of socket events processed in the current poll().
+  int numEvents_;
+
+  struct __kernel_timespec timeout_;
+
+  static const unsigned IO_URING_ENTRIES = 1024;
+
+  bool addEvents(sock_t socket, const KEvent& event);
+
+  bool deleteEvents(sock_t socket, const KEvent& event);
+
+  bool addEvents(sock_t socket, Command* command, int events,
+                 const std::shared_ptr<AsyncNameResolver>& rs);
+
+  bool deleteEvents(sock_t socket, Command* command,
+                    const std::shared_ptr<AsyncNameResolver>& rs);
+
+  void markDirty(KSocketEntry& socketEntry);
+
+  // Returns the next free SQE.  If the SQ ring is full, queued
+  // entries are submitted first.
+  struct io_uring_sqe* getSqe();
+
+  // Queues poll add/remove requests for the dirty sockets.
+  void flushChanges();
+
+  // Calls io_uring_enter(2) to submit all queued SQEs and waits for
+  // at least waitNr completions.  Returns -1 on error.
+  int submit(unsigned waitNr);
+
+  // Processes all completions available in the CQ ring.  Returns the
+  // number of completions which belong to sockets.
+  int reapCompletions();
+
+  static int translateEvents(EventPoll::EventType events);
+
+public:
+  IoUringEventPoll();
+
+  bool good() const;
+
+  virtual ~IoUringEventPoll();
+
+  virtual void poll(const struct timeval& tv) CXX11_OVERRIDE;
+
+  virtual bool addEvents(sock_t socket, Command* command,
+                         EventPoll::EventType events) CXX11_OVERRIDE;
+
+  virtual bool deleteEvents(sock_t socket, Command* command,
+                            EventPoll::EventType events) CXX11_OVERRIDE;
+#ifdef ENABLE_ASYNC_DNS
+
+  virtual bool
+  addNameResolver(const std::shared_ptr<AsyncNameResolver>& resolver,
+                  Command* command) CXX11_OVERRIDE;
+  virtual bool
+  deleteNameResolver(const std::shared_ptr<AsyncNameResolver>& resolver,
+                     Command* command) CXX11_OVERRIDE;
+#endif // ENABLE_ASYNC_DNS
+
+  static const int IEV_READ = POLLIN;
+  static const int IEV_WRITE = POLLOUT;
+  static const int IEV_ERROR = POLLERR;
+  static const int IEV_HUP = POLLHUP;
+};
+
+} // namespace aria2
+
+#endif // D_IO_URING_EVENT_POLL_H
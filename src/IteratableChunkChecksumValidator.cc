@@ -35,8 +35,10 @@
 #include "IteratableChunkChecksumValidator.h"
 
 #include <array>
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
+#include <vector>
 
 #include "util.h"
 #include "message.h"
@@ -51,9 +53,41 @@
 #include "MessageDigest.h"
 #include "fmt.h"
 #include "DlAbortEx.h"
+#ifdef ENABLE_THREADS
+#include "ThreadPool.h"
+#endif // ENABLE_THREADS
 
 namespace aria2 {
 
+#ifdef ENABLE_THREADS
+namespace {
+// The upper bound of the bytes read ahead per download.
+constexpr size_t MAX_READ_AHEAD = 32_m;
+
+// Hashes the piece data in a worker thread.  It owns the data, so
+// that it does not depend on the validator which may be destroyed
+// before the job is run.
+class DigestJob {
+private:
+  std::vector<unsigned char> data_;
+  std::string hashType_;
+
+public:
+  DigestJob(std::vector<unsigned char> data, std::string hashType)
+      : data_(std::move(data)), hashType_(std::move(hashType))
+  {
+  }
+
+  std::string operator()()
+  {
+    auto ctx = MessageDigest::create(hashType_);
+    ctx->update(data_.data(), data_.size());
+    return ctx->digest();
+  }
+};
+} // namespace
+#endif // ENABLE_THREADS
+
 IteratableChunkChecksumValidator::IteratableChunkChecksumValidator(
     const std::shared_ptr<DownloadContext>& dctx,
     const std::shared_ptr<PieceStorage>& pieceStorage)
@@ -62,6 +96,12 @@ IteratableChunkChecksumValidator::IteratableChunkChecksumValidator(
       bitfield_(make_unique<BitfieldMan>(dctx_->getPieceLength(),
                                          dctx_->getTotalLength())),
       currentIndex_(0)
+#ifdef ENABLE_THREADS
+      ,
+      threadPool_(nullptr),
+      readIndex_(0),
+      maxPending_(0)
+#endif // ENABLE_THREADS
 {
 }
 
@@ -70,21 +110,14 @@ IteratableChunkChecksumValidator::~IteratableChunkChecksumValidator() = default;
 void IteratableChunkChecksumValidator::validateChunk()
 {
   if (!finished()) {
-    std::string actualChecksum;
+#ifdef ENABLE_THREADS
+    if (threadPool_) {
+      validateChunkParallel();
+      return;
+    }
+#endif // ENABLE_THREADS
     try {
-      actualChecksum = calculateActualChecksum();
-      if (actualChecksum == dctx_->getPieceHashes()[currentIndex_]) {
-        bitfield_->setBit(currentIndex_);
-      }
-      else {
-        A2_LOG_INFO(
-            fmt(EX_INVALID_CHUNK_CHECKSUM,
-                static_cast<unsigned long>(currentIndex_),
-                static_cast<int64_t>(getCurrentOffset()),
-                util::toHex(dctx_->getPieceHashes()[currentIndex_]).c_str(),
-                util::toHex(actualChecksum).c_str()));
-        bitfield_->unsetBit(currentIndex_);
-      }
+      updateBitfield(calculateActualChecksum());
     }
     catch (RecoverableException& ex) {
       A2_LOG_DEBUG_EX(fmt("Caught exception while validating piece index=%lu."
@@ -103,18 +136,120 @@ void IteratableChunkChecksumValidator::validateChunk()
   }
 }
 
-std::string IteratableChunkChecksumValidator::calculateActualChecksum()
+void IteratableChunkChecksumValidator::updateBitfield(
+    const std::string& actualChecksum)
+{
+  if (actualChecksum == dctx_->getPieceHashes()[currentIndex_]) {
+    bitfield_->setBit(currentIndex_);
+  }
+  else {
+    A2_LOG_INFO(fmt(EX_INVALID_CHUNK_CHECKSUM,
+                    static_cast<unsigned long>(currentIndex_),
+                    static_cast<int64_t>(getCurrentOffset()),
+                    util::toHex(dctx_->getPieceHashes()[currentIndex_]).c_str(),
+                    util::toHex(actualChecksum).c_str()));
+    bitfield_->unsetBit(currentIndex_);
+  }
+}
+
+#ifdef ENABLE_THREADS
+void IteratableChunkChecksumValidator::setThreadPool(ThreadPool* threadPool)
+{
+  threadPool_ = threadPool;
+  if (threadPool_) {
+    // Keep all workers busy while the next pieces are being read,
+    // but do not hold too much memory for large pieces.
+    size_t pieceLength = std::max<int32_t>(1, dctx_->getPieceLength());
+    maxPending_ = std::min(threadPool_->getNumThreads() * 2,
+                           MAX_READ_AHEAD / pieceLength);
+    maxPending_ = std::max(maxPending_, static_cast<size_t>(2));
+  }
+}
+
+void IteratableChunkChecksumValidator::readAhead()
+{
+  int64_t offset = static_cast<int64_t>(readIndex_) * dctx_->getPieceLength();
+  size_t length = getChunkLength(readIndex_);
+  std::vector<unsigned char> data(length);
+  try {
+    auto diskAdaptor = pieceStorage_->getDiskAdaptor();
+    for (size_t nread = 0; nread < length;) {
+      size_t r = diskAdaptor->readDataDropCache(data.data() + nread,
+                                                length - nread, offset + nread);
+      if (r == 0) {
+        throw DL_ABORT_EX(fmt(EX_FILE_READ, dctx_->getBasePath().c_str(),
+                              "data is too short"));
+      }
+      nread += r;
+    }
+  }
+  catch (RecoverableException& ex) {
+    // Deliver the error in piece order, together with the digests.
+    std::promise<std::string> promise;
+    promise.set_exception(std::current_exception());
+    pendingDigests_.push_back(promise.get_future());
+    ++readIndex_;
+    return;
+  }
+  pendingDigests_.push_back(threadPool_->submit(
+      DigestJob(std::move(data), dctx_->getPieceHashType())));
+  ++readIndex_;
+}
+
+void IteratableChunkChecksumValidator::validateChunkParallel()
+{
+  // Disk reads are done in this thread because DiskAdaptor is not
+  // thread-safe.  Only hashing is done by worker threads.
+  if (readIndex_ < dctx_->getNumPieces()) {
+    readAhead();
+  }
+  // Wait for the oldest digest only if we cannot read ahead any
+  // more.  Otherwise, just take the digests already calculated.
+  bool wait = pendingDigests_.size() >= maxPending_ ||
+              readIndex_ == dctx_->getNumPieces();
+  while (!pendingDigests_.empty()) {
+    auto& front = pendingDigests_.front();
+    if (!wait &&
+        front.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      break;
+    }
+    wait = false;
+    try {
+      updateBitfield(front.get());
+    }
+    catch (RecoverableException& ex) {
+      A2_LOG_DEBUG_EX(fmt("Caught exception while validating piece index=%lu."
+                          " Some part of file may be missing."
+                          " Continue operation.",
+                          static_cast<unsigned long>(currentIndex_)),
+                      ex);
+      bitfield_->unsetBit(currentIndex_);
+    }
+    pendingDigests_.pop_front();
+    ++currentIndex_;
+  }
+  if (finished()) {
+    pieceStorage_->setBitfield(bitfield_->getBitfield(),
+                               bitfield_->getBitfieldLength());
+  }
+}
+#endif // ENABLE_THREADS
+
+size_t IteratableChunkChecksumValidator::getChunkLength(size_t index) const
 {
-  int64_t offset = getCurrentOffset();
-  size_t length;
   // When validating last piece
-  if (currentIndex_ + 1 == dctx_->getNumPieces()) {
-    length = dctx_->getTotalLength() - offset;
+  if (index + 1 == dctx_->getNumPieces()) {
+    return dctx_->getTotalLength() -
+           static_cast<int64_t>(index) * dctx_->getPieceLength();
   }
   else {
-    length = dctx_->getPieceLength();
+    return dctx_->getPieceLength();
   }
-  return digest(offset, length);
+}
+
+std::string IteratableChunkChecksumValidator::calculateActualChecksum()
+{
+  return digest(getCurrentOffset(), getChunkLength(currentIndex_));
 }
 
 void IteratableChunkChecksumValidator::init()
@@ -122,6 +257,10 @@ void IteratableChunkChecksumValidator::init()
   ctx_ = MessageDigest::create(dctx_->getPieceHashType());
   bitfield_->clearAllBit();
   currentIndex_ = 0;
+#ifdef ENABLE_THREADS
+  pendingDigests_.clear();
+  readIndex_ = 0;
+#endif // ENABLE_THREADS
 }
 
 std::string IteratableChunkChecksumValidator::digest(int64_t offset,
@@ -39,6 +39,10 @@
 
 #include <string>
 #include <memory>
+#ifdef ENABLE_THREADS
+#include <deque>
+#include <future>
+#endif // ENABLE_THREADS
 
 namespace aria2 {
 
@@ -46,6 +50,9 @@ class DownloadContext;
 class PieceStorage;
 class BitfieldMan;
 class MessageDigest;
+#ifdef ENABLE_THREADS
+class ThreadPool;
+#endif // ENABLE_THREADS
 
 class IteratableChunkChecksumValidator : public IteratableValidator {
 private:
@@ -54,11 +61,32 @@ private:
   std::unique_ptr<BitfieldMan> bitfield_;
   size_t currentIndex_;
   std::unique_ptr<MessageDigest> ctx_;
+#ifdef ENABLE_THREADS
+  ThreadPool* threadPool_;
+  // Digests of the pieces in [currentIndex_, readIndex_) being
+  // calculated by threadPool_, in piece order.
+  std::deque<std::future<std::string>> pendingDigests_;
+  // The index of the piece to be read next.
+  size_t readIndex_;
+  // The maximum number of pieces read ahead.
+  size_t maxPending_;
+
+  // Reads piece readIndex_ and submits it to threadPool_.
+  void readAhead();
+
+  void validateChunkParallel();
+#endif // ENABLE_THREADS
 
   std::string calculateActualChecksum();
 
   std::string digest(int64_t offset, size_t length);
 
+  size_t getChunkLength(size_t index) const;
+
+  // Sets the bit for currentIndex_ if actualChecksum matches the
+  // expected piece hash.  Otherwise unsets it.
+  void updateBitfield(const std::string& actualChecksum);
+
 public:
   IteratableChunkChecksumValidator(
       const std::shared_ptr<DownloadContext>& dctx,
@@ -75,6 +103,10 @@ public:
   virtual int64_t getCurrentOffset() const CXX11_OVERRIDE;
 
   virtual int64_t getTotalLength() const CXX11_OVERRIDE;
+
+#ifdef ENABLE_THREADS
+  virtual void setThreadPool(ThreadPool* threadPool) CXX11_OVERRIDE;
+#endif // ENABLE_THREADS
 };
 
 } // namespace aria2
@@ -41,6 +41,10 @@
 
 namespace aria2 {
 
+#ifdef ENABLE_THREADS
+class ThreadPool;
+#endif // ENABLE_THREADS
+
 /**
  * This class provides the interface to validate files.
  *
@@ -62,6 +66,13 @@ public:
   virtual int64_t getCurrentOffset() const = 0;
 
   virtual int64_t getTotalLength() const = 0;
+
+#ifdef ENABLE_THREADS
+  // Gives the worker threads which the validator may use to validate
+  // several chunks in parallel.  The default implementation does
+  // nothing.
+  virtual void setThreadPool(ThreadPool* threadPool) {}
+#endif // ENABLE_THREADS
 };
 
 } // namespace aria2
@@ -173,6 +173,61 @@ int GnuTLSSession::setSNIHostname(const std::string& hostname)
   return TLS_ERR_OK;
 }
 
+int GnuTLSSession::setAlpnProtocols(const std::vector<std::string>& protocols)
+{
+#if GNUTLS_VERSION_NUMBER >= 0x030200
+  std::vector<gnutls_datum_t> data;
+  for (auto& proto : protocols) {
+    gnutls_datum_t d;
+    d.data = reinterpret_cast<unsigned char*>(const_cast<char*>(proto.data()));
+    d.size = proto.size();
+    data.push_back(d);
+  }
+  rv_ = gnutls_alpn_set_protocols(sslSession_, data.data(), data.size(), 0);
+  if (rv_ != GNUTLS_E_SUCCESS) {
+    return TLS_ERR_ERROR;
+  }
+#endif // GNUTLS_VERSION_NUMBER >= 0x030200
+  return TLS_ERR_OK;
+}
+
+std::string GnuTLSSession::getAlpnProtocol()
+{
+#if GNUTLS_VERSION_NUMBER >= 0x030200
+  gnutls_datum_t proto;
+  if (gnutls_alpn_get_selected_protocol(sslSession_, &proto) ==
+      GNUTLS_E_SUCCESS) {
+    return std::string(proto.data, proto.data + proto.size);
+  }
+#endif // GNUTLS_VERSION_NUMBER >= 0x030200
+  return std::string();
+}
+
+int GnuTLSSession::setSessionData(const std::string& data)
+{
+  rv_ = gnutls_session_set_data(sslSession_, data.data(), data.size());
+  if (rv_ != GNUTLS_E_SUCCESS) {
+    return TLS_ERR_ERROR;
+  }
+  return TLS_ERR_OK;
+}
+
+std::string GnuTLSSession::getSessionData()
+{
+  gnutls_datum_t data;
+  if (gnutls_session_get_data2(sslSession_, &data) != GNUTLS_E_SUCCESS) {
+    return std::string();
+  }
+  std::string res(data.data, data.data + data.size);
+  gnutls_free(data.data);
+  return res;
+}
+
+bool GnuTLSSession::isSessionResumed()
+{
+  return gnutls_session_is_resumed(sslSession_);
+}
+
 int GnuTLSSession::closeConnection()
 {
   rv_ = gnutls_bye(sslSession_, GNUTLS_SHUT_WR);
@@ -96,6 +96,82 @@ int OpenSSLTLSSession::setSNIHostname(const std::string& hostname)
   return TLS_ERR_OK;
 }
 
+int OpenSSLTLSSession::setAlpnProtocols(
+    const std::vector<std::string>& protocols)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L
+  // The wire format is a list of length-prefixed strings.
+  std::string wire;
+  for (auto& proto : protocols) {
+    wire += static_cast<char>(proto.size());
+    wire += proto;
+  }
+  ERR_clear_error();
+  // Unlike most of OpenSSL functions, this returns 0 on success.
+  if (SSL_set_alpn_protos(ssl_,
+                          reinterpret_cast<const unsigned char*>(wire.data()),
+                          wire.size()) != 0) {
+    return TLS_ERR_ERROR;
+  }
+#endif // OPENSSL_VERSION_NUMBER >= 0x10002000L
+  return TLS_ERR_OK;
+}
+
+std::string OpenSSLTLSSession::getAlpnProtocol()
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L
+  const unsigned char* proto;
+  unsigned int len;
+  SSL_get0_alpn_selected(ssl_, &proto, &len);
+  if (proto) {
+    return std::string(proto, proto + len);
+  }
+#endif // OPENSSL_VERSION_NUMBER >= 0x10002000L
+  return std::string();
+}
+
+int OpenSSLTLSSession::setSessionData(const std::string& data)
+{
+  ERR_clear_error();
+  auto p = reinterpret_cast<const unsigned char*>(data.data());
+  SSL_SESSION* session = d2i_SSL_SESSION(nullptr, &p, data.size());
+  if (!session) {
+    return TLS_ERR_ERROR;
+  }
+  // SSL_set_session() takes its own reference.
+  rv_ = SSL_set_session(ssl_, session);
+  SSL_SESSION_free(session);
+  if (rv_ != 1) {
+    return TLS_ERR_ERROR;
+  }
+  return TLS_ERR_OK;
+}
+
+std::string OpenSSLTLSSession::getSessionData()
+{
+  SSL_SESSION* session = SSL_get_session(ssl_);
+  if (!session) {
+    return std::string();
+  }
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+  // With TLSv1.3, the session is resumable only after the server sent
+  // a ticket.
+  if (!SSL_SESSION_is_resumable(session)) {
+    return std::string();
+  }
+#endif // OPENSSL_VERSION_NUMBER >= 0x10101000L
+  int len = i2d_SSL_SESSION(session, nullptr);
+  if (len <= 0) {
+    return std::string();
+  }
+  std::string res(len, '\0');
+  auto p = reinterpret_cast<unsigned char*>(&res[0]);
+  i2d_SSL_SESSION(session, &p);
+  return res;
+}
+
+bool OpenSSLTLSSession::isSessionResumed() { return SSL_session_reused(ssl_); }
+
 int OpenSSLTLSSession::closeConnection()
 {
   ERR_clear_error();
@@ -36,6 +36,9 @@
 #include "a2io.h"
 #include "prefs.h"
 #include "RecoverableException.h"
+#include "DlAbortEx.h"
+#include "util.h"
+#include "fmt.h"
 
 #ifdef HAVE_LIBGNUTLS
 #include <gnutls/gnutls.h>
@@ -49,15 +52,34 @@ bool LogFactory::consoleOutput_ = true;
 Logger::LEVEL LogFactory::logLevel_ = Logger::A2_DEBUG;
 Logger::LEVEL LogFactory::consoleLogLevel_ = Logger::A2_NOTICE;
 bool LogFactory::colorOutput_ = true;
+std::vector<std::pair<Logger::SUBSYSTEM, Logger::LEVEL>>
+    LogFactory::subsystemLogLevels_;
+Logger::FORMAT LogFactory::format_ = Logger::FORMAT_TEXT;
+bool LogFactory::async_ = false;
+
+namespace {
+void applySubsystemLogLevels(
+    Logger* logger,
+    const std::vector<std::pair<Logger::SUBSYSTEM, Logger::LEVEL>>& levels)
+{
+  logger->clearSubsystemLogLevels();
+  for (auto& p : levels) {
+    logger->setSubsystemLogLevel(p.first, p.second);
+  }
+}
+} // namespace
 
 void LogFactory::openLogger(const std::shared_ptr<Logger>& logger)
 {
+  logger->setFormat(format_);
+  logger->setAsync(async_);
   if (filename_ != DEV_NULL) {
     // don't open file DEV_NULL for performance sake.
     // This avoids costly unnecessary message formatting and write.
     logger->openFile(filename_);
   }
   logger->setLogLevel(logLevel_);
+  applySubsystemLogLevels(logger.get(), subsystemLogLevels_);
   logger->setConsoleLogLevel(consoleLogLevel_);
   logger->setConsoleOutput(consoleOutput_);
   logger->setColorOutput(colorOutput_);
@@ -68,6 +90,9 @@ void LogFactory::adjustDependentLevels()
   auto level = consoleLogLevel_;
   if (filename_ != DEV_NULL) {
     level = std::min(level, logLevel_);
+    for (auto& p : subsystemLogLevels_) {
+      level = std::min(level, p.second);
+    }
   }
 #ifdef HAVE_LIBGNUTLS
   if (level == Logger::A2_DEBUG) {
@@ -118,26 +143,38 @@ void LogFactory::setLogFile(const std::string& name)
 }
 
 namespace {
-Logger::LEVEL toLogLevel(const std::string& level)
+bool toLogLevel(Logger::LEVEL& res, const std::string& level)
 {
   if (level == V_DEBUG) {
-    return Logger::A2_DEBUG;
+    res = Logger::A2_DEBUG;
   }
   else if (level == V_INFO) {
-    return Logger::A2_INFO;
+    res = Logger::A2_INFO;
   }
   else if (level == V_NOTICE) {
-    return Logger::A2_NOTICE;
+    res = Logger::A2_NOTICE;
   }
   else if (level == V_WARN) {
-    return Logger::A2_WARN;
+    res = Logger::A2_WARN;
   }
   else if (level == V_ERROR) {
-    return Logger::A2_ERROR;
+    res = Logger::A2_ERROR;
   }
   else {
-    return Logger::A2_NOTICE;
+    return false;
   }
+  return true;
+}
+} // namespace
+
+namespace {
+Logger::LEVEL toLogLevel(const std::string& level)
+{
+  Logger::LEVEL res;
+  if (toLogLevel(res, level)) {
+    return res;
+  }
+  return Logger::A2_NOTICE;
 }
 } // namespace
 
@@ -167,6 +204,50 @@ void LogFactory::setConsoleLogLevel(const std::string& level)
 
 void LogFactory::setColorOutput(bool enabled) { colorOutput_ = enabled; }
 
+std::vector<std::pair<Logger::SUBSYSTEM, Logger::LEVEL>>
+LogFactory::parseSubsystemLogLevels(const std::string& spec)
+{
+  std::vector<std::pair<Logger::SUBSYSTEM, Logger::LEVEL>> res;
+  std::vector<std::string> items;
+  util::split(std::begin(spec), std::end(spec), std::back_inserter(items), ',',
+              true);
+  for (auto& item : items) {
+    auto eq = item.find('=');
+    if (eq == std::string::npos) {
+      throw DL_ABORT_EX(fmt("Bad subsystem log level: %s", item.c_str()));
+    }
+    auto name = item.substr(0, eq);
+    int subsystem = 1;
+    for (; subsystem < Logger::NUM_SUBSYSTEM; ++subsystem) {
+      if (name == Logger::subsystemToString(
+                      static_cast<Logger::SUBSYSTEM>(subsystem))) {
+        break;
+      }
+    }
+    Logger::LEVEL level;
+    if (subsystem == Logger::NUM_SUBSYSTEM ||
+        !toLogLevel(level, item.substr(eq + 1))) {
+      throw DL_ABORT_EX(fmt("Bad subsystem log level: %s", item.c_str()));
+    }
+    res.emplace_back(static_cast<Logger::SUBSYSTEM>(subsystem), level);
+  }
+  return res;
+}
+
+void LogFactory::setSubsystemLogLevels(const std::string& spec)
+{
+  subsystemLogLevels_ = parseSubsystemLogLevels(spec);
+  if (logger_) {
+    applySubsystemLogLevels(logger_.get(), subsystemLogLevels_);
+  }
+  adjustDependentLevels();
+}
+
+void LogFactory::setLogFormat(const std::string& format)
+{
+  format_ = format == V_BINARY ? Logger::FORMAT_BINARY : Logger::FORMAT_TEXT;
+}
+
 void LogFactory::release() { logger_.reset(); }
 
 } // namespace aria2
@@ -39,6 +39,8 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <utility>
 
 #include "Logger.h"
 
@@ -52,6 +54,10 @@ private:
   static Logger::LEVEL logLevel_;
   static Logger::LEVEL consoleLogLevel_;
   static bool colorOutput_;
+  static std::vector<std::pair<Logger::SUBSYSTEM, Logger::LEVEL>>
+      subsystemLogLevels_;
+  static Logger::FORMAT format_;
+  static bool async_;
 
   static void openLogger(const std::shared_ptr<Logger>& logger);
 
@@ -106,6 +112,33 @@ public:
    */
   static void setColorOutput(bool enabled);
 
+  /**
+   * Set log levels to output to file per subsystem.  The |spec| is
+   * comma separated list of SUBSYSTEM=LEVEL, for example,
+   * "bt=debug,http=warn".  The subsystem not listed follows the log
+   * level set by setLogLevel().  This takes effect immediately if
+   * the logger has been created.  Throws DlAbortEx if |spec| is
+   * malformed.
+   */
+  static void setSubsystemLogLevels(const std::string& spec);
+
+  /**
+   * Parses |spec| described in setSubsystemLogLevels().  Throws
+   * DlAbortEx if |spec| is malformed.
+   */
+  static std::vector<std::pair<Logger::SUBSYSTEM, Logger::LEVEL>>
+  parseSubsystemLogLevels(const std::string& spec);
+
+  /**
+   * Set the format of log file.  Possible values are: text, binary
+   */
+  static void setLogFormat(const std::string& format);
+
+  /**
+   * Set flag whether the log file is written by the dedicated thread.
+   */
+  static void setAsync(bool f) { async_ = f; }
+
   /**
    * Releases used resources
    */
@@ -117,19 +150,24 @@ public:
 #define A2_LOG_DEBUG_ENABLED                                                   \
   aria2::LogFactory::getInstance()->levelEnabled(Logger::A2_DEBUG)
 
+// The subsystem is decided once per call site.
 #define A2_LOG(level, msg)                                                     \
   {                                                                            \
+    static const aria2::Logger::SUBSYSTEM a2_log_subsystem =                   \
+        aria2::Logger::toSubsystem(__FILE__);                                  \
     const std::shared_ptr<aria2::Logger>& logger =                             \
         aria2::LogFactory::getInstance();                                      \
-    if (logger->levelEnabled(level))                                           \
-      logger->log(level, __FILE__, __LINE__, msg);                             \
+    if (logger->levelEnabled(level, a2_log_subsystem))                         \
+      logger->log(level, a2_log_subsystem, __FILE__, __LINE__, msg);           \
   }
 #define A2_LOG_EX(level, msg, ex)                                              \
   {                                                                            \
+    static const aria2::Logger::SUBSYSTEM a2_log_subsystem =                   \
+        aria2::Logger::toSubsystem(__FILE__);                                  \
     const std::shared_ptr<aria2::Logger>& logger =                             \
         aria2::LogFactory::getInstance();                                      \
-    if (logger->levelEnabled(level))                                           \
-      logger->log(level, __FILE__, __LINE__, msg, ex);                         \
+    if (logger->levelEnabled(level, a2_log_subsystem))                         \
+      logger->log(level, a2_log_subsystem, __FILE__, __LINE__, msg, ex);       \
   }
 
 #define A2_LOG_DEBUG(msg) A2_LOG(Logger::A2_DEBUG, msg)
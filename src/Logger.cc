@@ -38,6 +38,11 @@
 #include <cstring>
 #include <cstdio>
 #include <cassert>
+#include <algorithm>
+#ifdef ENABLE_THREADS
+#include <thread>
+#include <condition_variable>
+#endif // ENABLE_THREADS
 
 #include "DlAbortEx.h"
 #include "fmt.h"
@@ -47,18 +52,115 @@
 #include "BufferedFile.h"
 #include "util.h"
 #include "console.h"
+#include "MpscQueue.h"
 
 namespace aria2 {
 
+#ifdef ENABLE_THREADS
+class Logger::AsyncWriter {
+public:
+  struct Record {
+    LEVEL level;
+    SUBSYSTEM subsystem;
+    const char* sourceFile;
+    int lineNum;
+    timeval tv;
+    std::string msg;
+    std::string trace;
+  };
+
+  AsyncWriter(Logger* logger)
+      : logger_{logger}, queue_{4096}, stop_{false}, sleeping_{false}
+  {
+    thread_ = std::thread([this] { run(); });
+  }
+
+  // Writes all queued messages and stops the thread.
+  ~AsyncWriter()
+  {
+    stop_ = true;
+    wakeup();
+    thread_.join();
+  }
+
+  void push(Record& rec)
+  {
+    while (!queue_.push(rec)) {
+      // The writer thread is behind.  Wait for it rather than losing
+      // the message.
+      wakeup();
+      std::this_thread::yield();
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_) {
+      wakeup();
+    }
+  }
+
+private:
+  void wakeup()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cond_.notify_one();
+  }
+
+  void run()
+  {
+    Record rec;
+    for (;;) {
+      bool written = false;
+      while (queue_.pop(rec)) {
+        logger_->writeFileLog(rec.level, rec.subsystem, rec.sourceFile,
+                              rec.lineNum, rec.tv, rec.msg.c_str(),
+                              rec.trace.c_str());
+        written = true;
+      }
+      if (written) {
+        logger_->fpp_->flush();
+        continue;
+      }
+      if (stop_) {
+        return;
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      sleeping_ = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (queue_.empty() && !stop_) {
+        // The timeout only covers a missed wakeup.
+        cond_.wait_for(lock, std::chrono::milliseconds(100));
+      }
+      sleeping_ = false;
+    }
+  }
+
+  Logger* logger_;
+  MpscQueue<Record> queue_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::atomic<bool> stop_;
+  std::atomic<bool> sleeping_;
+};
+#endif // ENABLE_THREADS
+
 Logger::Logger()
     : logLevel_(Logger::A2_DEBUG),
+      subsystemLogLevel_{},
+      binaryFile_(nullptr),
+      format_(FORMAT_TEXT),
       consoleLogLevel_(Logger::A2_NOTICE),
       consoleOutput_(true),
-      colorOutput_(global::cout()->supportsColor())
+      colorOutput_(global::cout()->supportsColor()),
+      async_(false)
 {
 }
 
-Logger::~Logger() = default;
+Logger::~Logger() { closeFile(); }
+
+namespace {
+const char BINARY_LOG_MAGIC[] = "A2LOG";
+const char BINARY_LOG_VERSION = 1;
+} // namespace
 
 void Logger::openFile(const std::string& filename)
 {
@@ -67,26 +169,67 @@ void Logger::openFile(const std::string& filename)
     fpp_ = global::cout();
   }
   else {
-    fpp_ =
+    auto fp =
         std::make_shared<BufferedFile>(filename.c_str(), BufferedFile::APPEND);
-    if (!*static_cast<BufferedFile*>(fpp_.get())) {
+    if (!*fp) {
       throw DL_ABORT_EX(fmt(EX_FILE_OPEN, filename.c_str(), "n/a"));
     }
+    if (format_ == FORMAT_BINARY) {
+      binaryFile_ = fp.get();
+      binaryFile_->write(BINARY_LOG_MAGIC, sizeof(BINARY_LOG_MAGIC) - 1);
+      binaryFile_->write(&BINARY_LOG_VERSION, 1);
+      binaryFile_->flush();
+    }
+    fpp_ = std::move(fp);
+  }
+  // Standard output is shared with console output, so it is always
+  // written synchronously.
+  if (async_ && filename != DEV_STDOUT) {
+    startAsyncWriter();
   }
 }
 
 void Logger::closeFile()
 {
+  stopAsyncWriter();
   if (fpp_) {
     fpp_.reset();
   }
+  binaryFile_ = nullptr;
+  sourceFileIds_.clear();
+}
+
+void Logger::startAsyncWriter()
+{
+#ifdef ENABLE_THREADS
+  asyncWriter_ = make_unique<AsyncWriter>(this);
+#endif // ENABLE_THREADS
+}
+
+void Logger::stopAsyncWriter()
+{
+#ifdef ENABLE_THREADS
+  asyncWriter_.reset();
+#endif // ENABLE_THREADS
 }
 
 void Logger::setConsoleOutput(bool enabled) { consoleOutput_ = enabled; }
 
 void Logger::setColorOutput(bool enabled) { colorOutput_ = enabled; }
 
-bool Logger::fileLogEnabled(LEVEL level) { return level >= logLevel_ && fpp_; }
+void Logger::clearSubsystemLogLevels()
+{
+  std::fill(std::begin(subsystemLogLevel_), std::end(subsystemLogLevel_), 0);
+}
+
+bool Logger::fileLogEnabled(LEVEL level, SUBSYSTEM subsystem)
+{
+  auto minLevel = subsystemLogLevel_[subsystem];
+  if (minLevel == 0) {
+    minLevel = logLevel_;
+  }
+  return level >= minLevel && fpp_;
+}
 
 bool Logger::consoleLogEnabled(LEVEL level)
 {
@@ -95,7 +238,84 @@ bool Logger::consoleLogEnabled(LEVEL level)
 
 bool Logger::levelEnabled(LEVEL level)
 {
-  return fileLogEnabled(level) || consoleLogEnabled(level);
+  if (consoleLogEnabled(level)) {
+    return true;
+  }
+  for (int i = 0; i < NUM_SUBSYSTEM; ++i) {
+    if (fileLogEnabled(level, static_cast<SUBSYSTEM>(i))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Logger::levelEnabled(LEVEL level, SUBSYSTEM subsystem)
+{
+  return fileLogEnabled(level, subsystem) || consoleLogEnabled(level);
+}
+
+namespace {
+struct SubsystemPattern {
+  const char* pattern;
+  // true if pattern must match the beginning of the file name.
+  // Otherwise, it may appear anywhere in the name.
+  bool prefix;
+  Logger::SUBSYSTEM subsystem;
+};
+
+// Searched in order, so that the more specific one comes first.
+const SubsystemPattern subsystemPatterns[] = {
+    {"DHT", true, Logger::SUBSYSTEM_DHT},
+    {"HttpServer", true, Logger::SUBSYSTEM_RPC},
+    {"Rpc", false, Logger::SUBSYSTEM_RPC},
+    {"rpc_", true, Logger::SUBSYSTEM_RPC},
+    {"WebSocket", true, Logger::SUBSYSTEM_RPC},
+    {"StatusSubscription", true, Logger::SUBSYSTEM_RPC},
+    {"Http", false, Logger::SUBSYSTEM_HTTP},
+    {"http", true, Logger::SUBSYSTEM_HTTP},
+    {"Hpack", true, Logger::SUBSYSTEM_HTTP},
+    {"Bt", false, Logger::SUBSYSTEM_BT},
+    {"bittorrent", true, Logger::SUBSYSTEM_BT},
+    {"Peer", false, Logger::SUBSYSTEM_BT},
+    {"Tracker", false, Logger::SUBSYSTEM_BT},
+    {"ExtensionMessage", false, Logger::SUBSYSTEM_BT},
+    {"UT", true, Logger::SUBSYSTEM_BT},
+    {"Lpd", true, Logger::SUBSYSTEM_BT},
+    {"Disk", false, Logger::SUBSYSTEM_DISK},
+    {"FileAllocation", false, Logger::SUBSYSTEM_DISK},
+    {"CheckIntegrity", false, Logger::SUBSYSTEM_DISK},
+};
+} // namespace
+
+Logger::SUBSYSTEM Logger::toSubsystem(const char* sourceFile)
+{
+  auto base = strrchr(sourceFile, '/');
+  base = base ? base + 1 : sourceFile;
+  for (auto& p : subsystemPatterns) {
+    if (p.prefix ? util::startsWith(base, base + strlen(base), p.pattern)
+                 : strstr(base, p.pattern) != nullptr) {
+      return p.subsystem;
+    }
+  }
+  return SUBSYSTEM_DEFAULT;
+}
+
+const char* Logger::subsystemToString(SUBSYSTEM subsystem)
+{
+  switch (subsystem) {
+  case SUBSYSTEM_BT:
+    return "bt";
+  case SUBSYSTEM_DHT:
+    return "dht";
+  case SUBSYSTEM_HTTP:
+    return "http";
+  case SUBSYSTEM_RPC:
+    return "rpc";
+  case SUBSYSTEM_DISK:
+    return "disk";
+  default:
+    return "";
+  }
 }
 
 namespace {
@@ -121,10 +341,8 @@ const char* levelToString(Logger::LEVEL level)
 namespace {
 template <typename Output>
 void writeHeader(Output& fp, Logger::LEVEL level, const char* sourceFile,
-                 int lineNum)
+                 int lineNum, const timeval& tv)
 {
-  struct timeval tv;
-  gettimeofday(&tv, nullptr);
   char datestr[20]; // 'YYYY-MM-DD hh:mm:ss'+'\0' = 20 bytes
   struct tm tm;
   // tv.tv_sec may not be of type time_t.
@@ -189,13 +407,76 @@ void writeStackTrace(Output& fp, const char* stackTrace)
 }
 } // namespace
 
-void Logger::writeLog(Logger::LEVEL level, const char* sourceFile, int lineNum,
-                      const char* msg, const char* trace)
+namespace {
+template <typename T> void appendLE(std::string& out, T n)
+{
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    out += static_cast<char>((n >> (i * 8)) & 0xff);
+  }
+}
+} // namespace
+
+void Logger::writeFileLog(LEVEL level, SUBSYSTEM subsystem,
+                          const char* sourceFile, int lineNum,
+                          const timeval& tv, const char* msg,
+                          const char* trace)
 {
-  if (fileLogEnabled(level)) {
-    writeHeader(*fpp_, level, sourceFile, lineNum);
+  if (!binaryFile_) {
+    writeHeader(*fpp_, level, sourceFile, lineNum, tv);
     fpp_->printf("%s\n", msg);
     writeStackTrace(*fpp_, trace);
+    return;
+  }
+  std::string rec;
+  auto i = sourceFileIds_.find(sourceFile);
+  uint16_t fileId;
+  if (i == std::end(sourceFileIds_)) {
+    fileId = sourceFileIds_.size();
+    sourceFileIds_.insert(std::make_pair(sourceFile, fileId));
+    auto len = static_cast<uint16_t>(strlen(sourceFile));
+    rec += static_cast<char>(1);
+    appendLE(rec, fileId);
+    appendLE(rec, len);
+    rec.append(sourceFile, len);
+  }
+  else {
+    fileId = (*i).second;
+  }
+  auto msglen = static_cast<uint32_t>(strlen(msg));
+  auto tracelen = static_cast<uint32_t>(strlen(trace));
+  rec += static_cast<char>(2);
+  rec += static_cast<char>(level);
+  rec += static_cast<char>(subsystem);
+  appendLE(rec, fileId);
+  appendLE(rec, static_cast<uint32_t>(lineNum));
+  appendLE(rec, static_cast<int64_t>(tv.tv_sec) * 1000000 + tv.tv_usec);
+  appendLE(rec, msglen);
+  rec.append(msg, msglen);
+  appendLE(rec, tracelen);
+  rec.append(trace, tracelen);
+  binaryFile_->write(rec.data(), rec.size());
+}
+
+void Logger::writeLog(LEVEL level, SUBSYSTEM subsystem, const char* sourceFile,
+                      int lineNum, const char* msg, const char* trace)
+{
+  timeval tv;
+  gettimeofday(&tv, nullptr);
+  bool fileLog = fileLogEnabled(level, subsystem);
+#ifdef ENABLE_THREADS
+  if (fileLog && asyncWriter_) {
+    AsyncWriter::Record rec{level, subsystem, sourceFile, lineNum,
+                            tv,    msg,       trace};
+    asyncWriter_->push(rec);
+    fileLog = false;
+  }
+  if (!fileLog && !consoleLogEnabled(level)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+#endif // ENABLE_THREADS
+  if (fileLog) {
+    writeFileLog(level, subsystem, sourceFile, lineNum, tv, msg, trace);
     fpp_->flush();
   }
   if (consoleLogEnabled(level)) {
@@ -210,7 +491,7 @@ void Logger::writeLog(Logger::LEVEL level, const char* sourceFile, int lineNum,
 void Logger::log(LEVEL level, const char* sourceFile, int lineNum,
                  const char* msg)
 {
-  writeLog(level, sourceFile, lineNum, msg, "");
+  log(level, toSubsystem(sourceFile), sourceFile, lineNum, msg);
 }
 
 void Logger::log(LEVEL level, const char* sourceFile, int lineNum,
@@ -222,7 +503,7 @@ void Logger::log(LEVEL level, const char* sourceFile, int lineNum,
 void Logger::log(LEVEL level, const char* sourceFile, int lineNum,
                  const char* msg, const Exception& ex)
 {
-  writeLog(level, sourceFile, lineNum, msg, ex.stackTrace().c_str());
+  log(level, toSubsystem(sourceFile), sourceFile, lineNum, msg, ex);
 }
 
 void Logger::log(LEVEL level, const char* sourceFile, int lineNum,
@@ -231,4 +512,29 @@ void Logger::log(LEVEL level, const char* sourceFile, int lineNum,
   log(level, sourceFile, lineNum, msg.c_str(), ex);
 }
 
+void Logger::log(LEVEL level, SUBSYSTEM subsystem, const char* sourceFile,
+                 int lineNum, const char* msg)
+{
+  writeLog(level, subsystem, sourceFile, lineNum, msg, "");
+}
+
+void Logger::log(LEVEL level, SUBSYSTEM subsystem, const char* sourceFile,
+                 int lineNum, const std::string& msg)
+{
+  log(level, subsystem, sourceFile, lineNum, msg.c_str());
+}
+
+void Logger::log(LEVEL level, SUBSYSTEM subsystem, const char* sourceFile,
+                 int lineNum, const char* msg, const Exception& ex)
+{
+  writeLog(level, subsystem, sourceFile, lineNum, msg,
+           ex.stackTrace().c_str());
+}
+
+void Logger::log(LEVEL level, SUBSYSTEM subsystem, const char* sourceFile,
+                 int lineNum, const std::string& msg, const Exception& ex)
+{
+  log(level, subsystem, sourceFile, lineNum, msg.c_str(), ex);
+}
+
 } // namespace aria2
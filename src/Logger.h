@@ -39,11 +39,18 @@
 
 #include <string>
 #include <memory>
+#include <map>
+#ifdef ENABLE_THREADS
+#include <mutex>
+#endif // ENABLE_THREADS
+
+#include "a2time.h"
 
 namespace aria2 {
 
 class Exception;
 class OutputFile;
+class IOFile;
 
 class Logger {
 public:
@@ -55,25 +62,83 @@ public:
     A2_ERROR = 1 << 4,
   };
 
+  // The subsystem which emits log message.  It is decided by the name
+  // of the source file.
+  enum SUBSYSTEM {
+    SUBSYSTEM_DEFAULT,
+    SUBSYSTEM_BT,
+    SUBSYSTEM_DHT,
+    SUBSYSTEM_HTTP,
+    SUBSYSTEM_RPC,
+    SUBSYSTEM_DISK,
+    NUM_SUBSYSTEM
+  };
+
+  // The format of file log output.  FORMAT_BINARY writes compact
+  // records instead of text:
+  //
+  // The file starts with the header "A2LOG" followed by 1 byte
+  // version (currently 1).  The header is written again whenever the
+  // file is opened.  Then the records follow.  All integers are in
+  // little endian.
+  //
+  // Source file record: type (1 byte, 1), id (2 bytes), length of
+  // name (2 bytes) and name.  This is written once before the first
+  // message record which refers to the id.
+  //
+  // Message record: type (1 byte, 2), level (1 byte, LEVEL), subsystem
+  // (1 byte, SUBSYSTEM), source file id (2 bytes), line number (4
+  // bytes), time in microseconds since the epoch (8 bytes), length of
+  // message (4 bytes), message, length of stack trace (4 bytes) and
+  // stack trace.
+  //
+  // doc/log/aria2logdecode converts it to the text format.
+  enum FORMAT { FORMAT_TEXT, FORMAT_BINARY };
+
 private:
   // Minimum log level for file log output.
   LEVEL logLevel_;
+  // Minimum log level for file log output per subsystem.  0 means
+  // that logLevel_ is used.
+  int subsystemLogLevel_[NUM_SUBSYSTEM];
   std::shared_ptr<OutputFile> fpp_;
+  // Not null if fpp_ is written in binary format.
+  IOFile* binaryFile_;
+  FORMAT format_;
+  // Source file name to its id in binary format.  The key is the
+  // pointer to __FILE__, so it is not compared by content.
+  std::map<const char*, uint16_t> sourceFileIds_;
   // Minimum log level for console log output.
   LEVEL consoleLogLevel_;
   // true if console log output is enabled.
   bool consoleOutput_;
   bool colorOutput_;
+  bool async_;
+#ifdef ENABLE_THREADS
+  // Serializes writeLog() because worker threads may log, too.
+  std::mutex mutex_;
+  // Writes file log output in the dedicated thread if async_ is true.
+  class AsyncWriter;
+  std::unique_ptr<AsyncWriter> asyncWriter_;
+#endif // ENABLE_THREADS
   // Don't allow copying
   Logger(const Logger&);
   Logger& operator=(const Logger&);
 
-  void writeLog(Logger::LEVEL level, const char* sourceFile, int lineNum,
-                const char* msg, const char* trace);
+  void writeLog(LEVEL level, SUBSYSTEM subsystem, const char* sourceFile,
+                int lineNum, const char* msg, const char* trace);
 
-  // Returns true if message with log level |level| will be outputted
-  // to file.
-  bool fileLogEnabled(LEVEL level);
+  // Writes a message to fpp_ in the current format.
+  void writeFileLog(LEVEL level, SUBSYSTEM subsystem, const char* sourceFile,
+                    int lineNum, const timeval& tv, const char* msg,
+                    const char* trace);
+
+  void startAsyncWriter();
+  void stopAsyncWriter();
+
+  // Returns true if message with log level |level| from |subsystem|
+  // will be outputted to file.
+  bool fileLogEnabled(LEVEL level, SUBSYSTEM subsystem);
   // Returns true if message with log level |level| will be outputted
   // to console.
   bool consoleLogEnabled(LEVEL level);
@@ -94,12 +159,44 @@ public:
   void log(LEVEL level, const char* sourceFile, int lineNum,
            const std::string& msg, const Exception& ex);
 
+  void log(LEVEL level, SUBSYSTEM subsystem, const char* sourceFile,
+           int lineNum, const char* msg);
+
+  void log(LEVEL level, SUBSYSTEM subsystem, const char* sourceFile,
+           int lineNum, const std::string& msg);
+
+  void log(LEVEL level, SUBSYSTEM subsystem, const char* sourceFile,
+           int lineNum, const char* msg, const Exception& ex);
+
+  void log(LEVEL level, SUBSYSTEM subsystem, const char* sourceFile,
+           int lineNum, const std::string& msg, const Exception& ex);
+
+  // Opens |filename| for file log output.  The format and whether it
+  // is written asynchronously are decided by setFormat() and
+  // setAsync() called before this function.  Binary format is not
+  // used for standard output.
   void openFile(const std::string& filename);
 
   void closeFile();
 
   void setLogLevel(LEVEL level) { logLevel_ = level; }
 
+  // Sets the minimum log level for file log output of messages from
+  // |subsystem|.  It overrides the level given by setLogLevel().
+  void setSubsystemLogLevel(SUBSYSTEM subsystem, LEVEL level)
+  {
+    subsystemLogLevel_[subsystem] = level;
+  }
+
+  void clearSubsystemLogLevels();
+
+  void setFormat(FORMAT format) { format_ = format; }
+
+  // If |enabled| is true, the messages to file are queued in the
+  // lock-free ring buffer and written by the dedicated thread.  This
+  // has no effect if aria2 is built without thread support.
+  void setAsync(bool enabled) { async_ = enabled; }
+
   void setConsoleLogLevel(LEVEL level) { consoleLogLevel_ = level; }
 
   void setConsoleOutput(bool enabled);
@@ -109,6 +206,14 @@ public:
   // Returns true if this logger actually writes debug log message to
   // either file or stdout.
   bool levelEnabled(LEVEL level);
+
+  bool levelEnabled(LEVEL level, SUBSYSTEM subsystem);
+
+  // Returns the subsystem for the messages from |sourceFile|.
+  static SUBSYSTEM toSubsystem(const char* sourceFile);
+
+  // Returns the name of |subsystem|, for example, "bt".
+  static const char* subsystemToString(SUBSYSTEM subsystem);
 };
 
 } // namespace aria2
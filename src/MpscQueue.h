@@ -0,0 +1,135 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_MPSC_QUEUE_H
+#define D_MPSC_QUEUE_H
+
+#include "common.h"
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+namespace aria2 {
+
+// Bounded lock-free queue which many threads push to and one thread
+// pops from.  The capacity is rounded up to the power of 2.  Each slot
+// carries a sequence number telling whether it is ready for the
+// producer or the consumer, so that neither side needs a lock.  T
+// must be default constructible and move assignable.
+template <typename T> class MpscQueue {
+public:
+  MpscQueue(size_t capacity) : mask_{0}, pushPos_{0}, popPos_{0}
+  {
+    size_t n = 1;
+    for (; n < capacity; n <<= 1)
+      ;
+    mask_ = n - 1;
+    slots_.reset(new Slot[n]);
+    for (size_t i = 0; i < n; ++i) {
+      slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  // Moves |value| into the queue and returns true.  If the queue is
+  // full, returns false and |value| is left untouched.  This function
+  // can be called from any thread.
+  bool push(T& value)
+  {
+    auto pos = pushPos_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+      slot = &slots_[pos & mask_];
+      auto seq = slot->seq.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (pushPos_.compare_exchange_weak(pos, pos + 1,
+                                           std::memory_order_relaxed)) {
+          break;
+        }
+      }
+      else if (diff < 0) {
+        return false;
+      }
+      else {
+        pos = pushPos_.load(std::memory_order_relaxed);
+      }
+    }
+    slot->value = std::move(value);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Moves the oldest value to |value| and returns true.  If the queue
+  // is empty, returns false.  Only one thread may call this function
+  // and empty().
+  bool pop(T& value)
+  {
+    auto& slot = slots_[popPos_ & mask_];
+    if (slot.seq.load(std::memory_order_acquire) != popPos_ + 1) {
+      return false;
+    }
+    value = std::move(slot.value);
+    slot.seq.store(popPos_ + mask_ + 1, std::memory_order_release);
+    ++popPos_;
+    return true;
+  }
+
+  bool empty() const
+  {
+    return slots_[popPos_ & mask_].seq.load(std::memory_order_acquire) !=
+           popPos_ + 1;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+private:
+  struct Slot {
+    std::atomic<size_t> seq;
+    T value;
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_;
+  std::atomic<size_t> pushPos_;
+  // Only touched by the consumer.
+  size_t popPos_;
+};
+
+} // namespace aria2
+
+#endif // D_MPSC_QUEUE_H
@@ -357,6 +357,56 @@ void MultiDiskAdaptor::writeData(const unsigned char* data, size_t len,
   }
 }
 
+void MultiDiskAdaptor::writeDataV(const a2iovec* iov, size_t iovcnt,
+                                  int64_t offset)
+{
+  size_t len = 0;
+  for (size_t i = 0; i < iovcnt; ++i) {
+    len += iov[i].A2IOVEC_LEN;
+  }
+  if (len == 0) {
+    return;
+  }
+  auto first = findFirstDiskWriterEntry(diskWriterEntries_, offset);
+  ssize_t rem = len;
+  int64_t fileOffset = offset - (*first)->getFileEntry()->getOffset();
+  // The buffer in iov to write next, and the number of bytes already
+  // taken from it.
+  size_t idx = 0;
+  size_t idxOffset = 0;
+  std::vector<a2iovec> fileiov;
+  for (auto i = first, eoi = diskWriterEntries_.cend(); i != eoi; ++i) {
+    ssize_t writeLength = calculateLength((*i).get(), fileOffset, rem);
+    openIfNot((*i).get(), &DiskWriterEntry::openFile);
+    if (!(*i)->isOpen()) {
+      throwOnDiskWriterNotOpened((*i).get(), offset + (len - rem));
+    }
+
+    // Split the buffers at the file boundary.
+    fileiov.clear();
+    for (size_t n = writeLength; n > 0;) {
+      size_t l = std::min(n, iov[idx].A2IOVEC_LEN - idxOffset);
+      a2iovec v;
+      v.A2IOVEC_BASE = static_cast<char*>(iov[idx].A2IOVEC_BASE) + idxOffset;
+      v.A2IOVEC_LEN = l;
+      fileiov.push_back(v);
+      n -= l;
+      idxOffset += l;
+      if (idxOffset == iov[idx].A2IOVEC_LEN) {
+        ++idx;
+        idxOffset = 0;
+      }
+    }
+    (*i)->getDiskWriter()->writeDataV(fileiov.data(), fileiov.size(),
+                                      fileOffset);
+    rem -= writeLength;
+    fileOffset = 0;
+    if (rem == 0) {
+      break;
+    }
+  }
+}
+
 ssize_t MultiDiskAdaptor::readData(unsigned char* data, size_t len,
                                    int64_t offset)
 {
@@ -410,13 +460,19 @@ ssize_t MultiDiskAdaptor::readData(unsigned char* data, size_t len,
   return totalReadLength;
 }
 
-void MultiDiskAdaptor::writeCache(const WrDiskCacheEntry* entry)
+ssize_t MultiDiskAdaptor::sendData(const std::shared_ptr<SocketCore>& socket,
+                                   size_t len, int64_t offset)
 {
-  for (auto& d : entry->getDataSet()) {
-    A2_LOG_DEBUG(fmt("Cache flush goff=%" PRId64 ", len=%lu", d->goff,
-                     static_cast<unsigned long>(d->len)));
-    writeData(d->data + d->offset, d->len, d->goff);
+  // Only sends the data in the first file.  The caller sends the
+  // rest in the subsequent calls.
+  auto first = findFirstDiskWriterEntry(diskWriterEntries_, offset);
+  int64_t fileOffset = offset - (*first)->getFileEntry()->getOffset();
+  ssize_t sendLength = calculateLength((*first).get(), fileOffset, len);
+  openIfNot((*first).get(), &DiskWriterEntry::openFile);
+  if (!(*first)->isOpen()) {
+    throwOnDiskWriterNotOpened((*first).get(), offset);
   }
+  return (*first)->getDiskWriter()->sendData(socket, sendLength, fileOffset);
 }
 
 bool MultiDiskAdaptor::fileExists()
@@ -127,13 +127,17 @@ public:
   virtual void writeData(const unsigned char* data, size_t len,
                          int64_t offset) CXX11_OVERRIDE;
 
+  virtual void writeDataV(const a2iovec* iov, size_t iovcnt,
+                          int64_t offset) CXX11_OVERRIDE;
+
   virtual ssize_t readData(unsigned char* data, size_t len,
                            int64_t offset) CXX11_OVERRIDE;
 
   virtual ssize_t readDataDropCache(unsigned char* data, size_t len,
                                     int64_t offset) CXX11_OVERRIDE;
 
-  virtual void writeCache(const WrDiskCacheEntry* entry) CXX11_OVERRIDE;
+  virtual ssize_t sendData(const std::shared_ptr<SocketCore>& socket,
+                           size_t len, int64_t offset) CXX11_OVERRIDE;
 
   virtual bool fileExists() CXX11_OVERRIDE;
 
@@ -76,6 +76,9 @@
 #ifdef ENABLE_ASYNC_DNS
 #include "AsyncNameResolver.h"
 #endif // ENABLE_ASYNC_DNS
+#ifdef ENABLE_THREADS
+#include "EngineShardMan.h"
+#endif // ENABLE_THREADS
 
 namespace aria2 {
 
@@ -174,6 +177,58 @@ void MultiUrlRequestInfo::printMessageForContinue()
   }
 }
 
+void MultiUrlRequestInfo::setupDownloadEngine(DownloadEngine* e)
+{
+  if (!option_->blank(PREF_LOAD_COOKIES)) {
+    File cookieFile(option_->get(PREF_LOAD_COOKIES));
+    if (cookieFile.isFile() &&
+        e->getCookieStorage()->load(cookieFile.getPath(),
+                                    Time().getTimeFromEpoch())) {
+      A2_LOG_INFO(
+          fmt("Loaded cookies from '%s'.", cookieFile.getPath().c_str()));
+    }
+    else {
+      A2_LOG_ERROR(
+          fmt(MSG_LOADING_COOKIE_FAILED, cookieFile.getPath().c_str()));
+    }
+  }
+
+  auto authConfigFactory = make_unique<AuthConfigFactory>();
+  File netrccf(option_->get(PREF_NETRC_PATH));
+  if (!option_->getAsBool(PREF_NO_NETRC) && netrccf.isFile()) {
+#ifdef __MINGW32__
+    // Windows OS does not have permission, so set it to 0.
+    mode_t mode = 0;
+#else  // !__MINGW32__
+    mode_t mode = netrccf.mode();
+#endif // !__MINGW32__
+    if (mode & (S_IRWXG | S_IRWXO)) {
+      A2_LOG_NOTICE(fmt(MSG_INCORRECT_NETRC_PERMISSION,
+                        option_->get(PREF_NETRC_PATH).c_str()));
+    }
+    else {
+      auto netrc = make_unique<Netrc>();
+      netrc->parse(option_->get(PREF_NETRC_PATH));
+      authConfigFactory->setNetrc(std::move(netrc));
+    }
+  }
+  e->setAuthConfigFactory(std::move(authConfigFactory));
+
+#ifdef HAVE_ARES_ADDR_NODE
+  ares_addr_node* asyncDNSServers =
+      parseAsyncDNSServers(option_->get(PREF_ASYNC_DNS_SERVER));
+  e->setAsyncDNSServers(asyncDNSServers);
+#endif // HAVE_ARES_ADDR_NODE
+
+  std::string serverStatIf = option_->get(PREF_SERVER_STAT_IF);
+  if (!serverStatIf.empty()) {
+    e->getRequestGroupMan()->loadServerStat(serverStatIf);
+    e->getRequestGroupMan()->removeStaleServerStat(
+        std::chrono::seconds(option_->getAsInt(PREF_SERVER_STAT_TIMEOUT)));
+  }
+  e->getRequestGroupMan()->getNetStat().downloadStart();
+}
+
 int MultiUrlRequestInfo::prepare()
 {
   global::globalHaltRequested = 0;
@@ -214,41 +269,6 @@ int MultiUrlRequestInfo::prepare()
     }
 #endif // ENABLE_WEBSOCKET
 
-    if (!option_->blank(PREF_LOAD_COOKIES)) {
-      File cookieFile(option_->get(PREF_LOAD_COOKIES));
-      if (cookieFile.isFile() &&
-          e_->getCookieStorage()->load(cookieFile.getPath(),
-                                       Time().getTimeFromEpoch())) {
-        A2_LOG_INFO(
-            fmt("Loaded cookies from '%s'.", cookieFile.getPath().c_str()));
-      }
-      else {
-        A2_LOG_ERROR(
-            fmt(MSG_LOADING_COOKIE_FAILED, cookieFile.getPath().c_str()));
-      }
-    }
-
-    auto authConfigFactory = make_unique<AuthConfigFactory>();
-    File netrccf(option_->get(PREF_NETRC_PATH));
-    if (!option_->getAsBool(PREF_NO_NETRC) && netrccf.isFile()) {
-#ifdef __MINGW32__
-      // Windows OS does not have permission, so set it to 0.
-      mode_t mode = 0;
-#else  // !__MINGW32__
-      mode_t mode = netrccf.mode();
-#endif // !__MINGW32__
-      if (mode & (S_IRWXG | S_IRWXO)) {
-        A2_LOG_NOTICE(fmt(MSG_INCORRECT_NETRC_PERMISSION,
-                          option_->get(PREF_NETRC_PATH).c_str()));
-      }
-      else {
-        auto netrc = make_unique<Netrc>();
-        netrc->parse(option_->get(PREF_NETRC_PATH));
-        authConfigFactory->setNetrc(std::move(netrc));
-      }
-    }
-    e_->setAuthConfigFactory(std::move(authConfigFactory));
-
 #ifdef ENABLE_SSL
     auto minTLSVer = util::toTLSVersion(option_->get(PREF_MIN_TLS_VERSION));
     std::shared_ptr<TLSContext> clTlsContext(
@@ -272,18 +292,7 @@ int MultiUrlRequestInfo::prepare()
     clTlsContext->setVerifyPeer(option_->getAsBool(PREF_CHECK_CERTIFICATE));
     SocketCore::setClientTLSContext(clTlsContext);
 #endif
-#ifdef HAVE_ARES_ADDR_NODE
-    ares_addr_node* asyncDNSServers =
-        parseAsyncDNSServers(option_->get(PREF_ASYNC_DNS_SERVER));
-    e_->setAsyncDNSServers(asyncDNSServers);
-#endif // HAVE_ARES_ADDR_NODE
-
-    std::string serverStatIf = option_->get(PREF_SERVER_STAT_IF);
-    if (!serverStatIf.empty()) {
-      e_->getRequestGroupMan()->loadServerStat(serverStatIf);
-      e_->getRequestGroupMan()->removeStaleServerStat(
-          std::chrono::seconds(option_->getAsInt(PREF_SERVER_STAT_TIMEOUT)));
-    }
+    setupDownloadEngine(e_.get());
     e_->setStatCalc(getStatCalc(option_));
     if (uriListParser_) {
       e_->getRequestGroupMan()->setUriListParser(uriListParser_);
@@ -291,7 +300,6 @@ int MultiUrlRequestInfo::prepare()
     if (useSignalHandler_) {
       setupSignalHandlers();
     }
-    e_->getRequestGroupMan()->getNetStat().downloadStart();
   }
   catch (RecoverableException& e) {
     A2_LOG_ERROR_EX(EX_EXCEPTION_CAUGHT, e);
@@ -304,6 +312,33 @@ int MultiUrlRequestInfo::prepare()
   return 0;
 }
 
+#ifdef ENABLE_THREADS
+void MultiUrlRequestInfo::startEngineShards()
+{
+  size_t numShards = option_->getAsInt(PREF_ENGINE_SHARDS);
+  if (numShards <= 1) {
+    return;
+  }
+  if (option_->getAsBool(PREF_ENABLE_RPC)) {
+    A2_LOG_WARN("--engine-shards is ignored because --enable-rpc is given.");
+    return;
+  }
+  auto shardMan = make_unique<EngineShardMan>(
+      numShards, option_.get(),
+      [this](DownloadEngine* e) { setupDownloadEngine(e); });
+  try {
+    shardMan->start(e_.get());
+  }
+  catch (RecoverableException& e) {
+    A2_LOG_ERROR_EX(EX_EXCEPTION_CAUGHT, e);
+    A2_LOG_WARN("Failed to start engine shards. Running downloads on one "
+                "engine.");
+    return;
+  }
+  engineShardMan_ = std::move(shardMan);
+}
+#endif // ENABLE_THREADS
+
 error_code::Value MultiUrlRequestInfo::getResult()
 {
   error_code::Value returnValue = error_code::FINISHED;
@@ -355,6 +390,9 @@ error_code::Value MultiUrlRequestInfo::execute()
   if (prepare() != 0) {
     return error_code::UNKNOWN_ERROR;
   }
+#ifdef ENABLE_THREADS
+  startEngineShards();
+#endif // ENABLE_THREADS
   // TODO Enclosed in try..catch block for just in case. Really need
   // this?
   try {
@@ -363,6 +401,11 @@ error_code::Value MultiUrlRequestInfo::execute()
   catch (RecoverableException& e) {
     A2_LOG_ERROR_EX(EX_EXCEPTION_CAUGHT, e);
   }
+#ifdef ENABLE_THREADS
+  if (engineShardMan_) {
+    engineShardMan_->stop();
+  }
+#endif // ENABLE_THREADS
   error_code::Value returnValue = getResult();
   if (useSignalHandler_) {
     resetSignalHandlers();
@@ -51,6 +51,9 @@ class RequestGroup;
 class Option;
 class UriListParser;
 class DownloadEngine;
+#ifdef ENABLE_THREADS
+class EngineShardMan;
+#endif // ENABLE_THREADS
 
 class MultiUrlRequestInfo {
 private:
@@ -60,6 +63,12 @@ private:
 
   std::shared_ptr<UriListParser> uriListParser_;
 
+#ifdef ENABLE_THREADS
+  // Declared before e_, so that the worker engines are destroyed
+  // after the primary engine which refers to it.
+  std::unique_ptr<EngineShardMan> engineShardMan_;
+#endif // ENABLE_THREADS
+
   std::unique_ptr<DownloadEngine> e_;
 
   sigset_t mask_;
@@ -67,6 +76,13 @@ private:
   bool useSignalHandler_;
 
   void printMessageForContinue();
+  // Loads cookies, netrc and server stats into |e|.  This is done for
+  // the primary engine and each engine shard.
+  void setupDownloadEngine(DownloadEngine* e);
+#ifdef ENABLE_THREADS
+  // Starts the engine shards if --engine-shards is greater than 1.
+  void startEngineShards();
+#endif // ENABLE_THREADS
   void setupSignalHandlers();
   void resetSignalHandlers();
 
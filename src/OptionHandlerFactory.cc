@@ -139,6 +139,16 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeOptionForReserved(true);
     handlers.push_back(op);
   }
+#ifdef ENABLE_THREADS
+  {
+    OptionHandler* op(new NumberOptionHandler(PREF_CHECK_INTEGRITY_THREADS,
+                                              TEXT_CHECK_INTEGRITY_THREADS,
+                                              "1", 1, 64));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_CHECKSUM);
+    handlers.push_back(op);
+  }
+#endif // ENABLE_THREADS
   {
     OptionHandler* op(new BooleanOptionHandler(PREF_CONDITIONAL_GET,
                                                TEXT_CONDITIONAL_GET, A2_V_FALSE,
@@ -192,6 +202,12 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_ADVANCED);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new BooleanOptionHandler(
+        PREF_ASYNC_LOG, TEXT_ASYNC_LOG, A2_V_FALSE, OptionHandler::OPT_ARG));
+    op->addTag(TAG_ADVANCED);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new BooleanOptionHandler(PREF_DEFERRED_INPUT,
                                                TEXT_DEFERRED_INPUT, A2_V_FALSE,
@@ -282,6 +298,15 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_RPC);
     handlers.push_back(op);
   }
+#ifdef ENABLE_THREADS
+  {
+    OptionHandler* op(new NumberOptionHandler(
+        PREF_ENGINE_SHARDS, TEXT_ENGINE_SHARDS, "1", 1, 64));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_EXPERIMENTAL);
+    handlers.push_back(op);
+  }
+#endif // ENABLE_THREADS
   {
     OptionHandler* op(new ParameterOptionHandler(PREF_EVENT_POLL,
                                                  TEXT_EVENT_POLL,
@@ -302,6 +327,9 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
 #ifdef HAVE_EPOLL
                                                      V_EPOLL,
 #endif // HAVE_EPOLL
+#ifdef HAVE_IO_URING
+                                                     V_IO_URING,
+#endif // HAVE_IO_URING
 #ifdef HAVE_KQUEUE
                                                      V_KQUEUE,
 #endif // HAVE_KQUEUE
@@ -334,6 +362,16 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeOptionForReserved(true);
     handlers.push_back(op);
   }
+#ifdef ENABLE_THREADS
+  {
+    OptionHandler* op(new NumberOptionHandler(PREF_FILE_ALLOCATION_THREADS,
+                                              TEXT_FILE_ALLOCATION_THREADS,
+                                              "1", 1, 64));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_FILE);
+    handlers.push_back(op);
+  }
+#endif // ENABLE_THREADS
   {
     OptionHandler* op(new BooleanOptionHandler(
         PREF_FORCE_SAVE, TEXT_FORCE_SAVE, A2_V_FALSE, OptionHandler::OPT_ARG));
@@ -429,6 +467,12 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeGlobalOption(true);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new ParameterOptionHandler(
+        PREF_LOG_FORMAT, TEXT_LOG_FORMAT, V_TEXT, {V_TEXT, V_BINARY}));
+    op->addTag(TAG_ADVANCED);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new NumberOptionHandler(PREF_MAX_CONCURRENT_DOWNLOADS,
                                               TEXT_MAX_CONCURRENT_DOWNLOADS,
@@ -731,6 +775,13 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_ADVANCED);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new SubsystemLogLevelOptionHandler(
+        PREF_SUBSYSTEM_LOG_LEVEL, TEXT_SUBSYSTEM_LOG_LEVEL, NO_DEFAULT_VALUE));
+    op->addTag(TAG_ADVANCED);
+    op->setChangeGlobalOption(true);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new BooleanOptionHandler(
         PREF_TRUNCATE_CONSOLE_READOUT, TEXT_TRUNCATE_CONSOLE_READOUT, A2_V_TRUE,
@@ -1086,6 +1137,17 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->setChangeOptionForReserved(true);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new BooleanOptionHandler(PREF_ENABLE_HTTP2,
+                                               TEXT_ENABLE_HTTP2, A2_V_FALSE,
+                                               OptionHandler::OPT_ARG));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_HTTP);
+    op->setInitialOption(true);
+    op->setChangeGlobalOption(true);
+    op->setChangeOptionForReserved(true);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new CumulativeOptionHandler(PREF_HEADER, TEXT_HEADER,
                                                   NO_DEFAULT_VALUE, "\n"));
@@ -1757,6 +1819,13 @@ std::vector<OptionHandler*> OptionHandlerFactory::createOptionHandlers()
     op->addTag(TAG_BITTORRENT);
     handlers.push_back(op);
   }
+  {
+    OptionHandler* op(new NumberOptionHandler(
+        PREF_UDP_BATCH_SIZE, TEXT_UDP_BATCH_SIZE, "16", 1, 1024));
+    op->addTag(TAG_ADVANCED);
+    op->addTag(TAG_BITTORRENT);
+    handlers.push_back(op);
+  }
   {
     OptionHandler* op(new BooleanOptionHandler(
         PREF_ENABLE_DHT, TEXT_ENABLE_DHT, A2_V_TRUE, OptionHandler::OPT_ARG));
@@ -600,6 +600,27 @@ std::string PrioritizePieceOptionHandler::createPossibleValuesString() const
   return "head[=SIZE], tail[=SIZE]";
 }
 
+SubsystemLogLevelOptionHandler::SubsystemLogLevelOptionHandler(
+    PrefPtr pref, const char* description, const std::string& defaultValue,
+    char shortName)
+    : AbstractOptionHandler(pref, description, defaultValue,
+                            OptionHandler::REQ_ARG, shortName)
+{
+}
+
+void SubsystemLogLevelOptionHandler::parseArg(Option& option,
+                                              const std::string& optarg) const
+{
+  // Throws DlAbortEx if optarg is malformed.
+  LogFactory::parseSubsystemLogLevels(optarg);
+  option.put(pref_, optarg);
+}
+
+std::string SubsystemLogLevelOptionHandler::createPossibleValuesString() const
+{
+  return "SUBSYSTEM=LEVEL[,...]";
+}
+
 OptimizeConcurrentDownloadsOptionHandler::
     OptimizeConcurrentDownloadsOptionHandler(PrefPtr pref,
                                              const char* description,
@@ -393,4 +393,29 @@ size_t Peer::countOutstandingUpload() const
   return res_->countOutstandingUpload();
 }
 
+void Peer::updateRequestLatency(Timer::Clock::duration latency)
+{
+  assert(res_);
+  res_->updateRequestLatency(latency);
+}
+
+void Peer::setRequestQueueSize(size_t size)
+{
+  assert(res_);
+  res_->setPeerRequestQueueSize(size);
+}
+
+size_t Peer::getMaxOutstandingRequest() const
+{
+  assert(res_);
+  return res_->getMaxOutstandingRequest();
+}
+
+std::chrono::milliseconds
+Peer::getRequestTimeout(const std::chrono::milliseconds& upper) const
+{
+  assert(res_);
+  return res_->getRequestTimeout(upper);
+}
+
 } // namespace aria2
@@ -266,6 +266,22 @@ public:
   void setBtMessageDispatcher(BtMessageDispatcher* dpt);
 
   size_t countOutstandingUpload() const;
+
+  // Updates the latency estimate with the time from sending a request
+  // to receiving the requested block.
+  void updateRequestLatency(Timer::Clock::duration latency);
+
+  // Sets the request queue size (reqq) the remote host told.
+  void setRequestQueueSize(size_t size);
+
+  // Returns the number of requests which should be outstanding to
+  // the remote host.
+  size_t getMaxOutstandingRequest() const;
+
+  // Returns the time after which a request to the remote host is
+  // considered stalled, which is at most |upper|.
+  std::chrono::milliseconds
+  getRequestTimeout(const std::chrono::milliseconds& upper) const;
 };
 
 template <typename InputIterator>
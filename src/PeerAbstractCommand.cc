@@ -97,7 +97,16 @@ bool PeerAbstractCommand::execute()
     if (checkPoint_.difference(global::wallclock()) >= timeout_) {
       throw DL_ABORT_EX(EX_TIME_OUT);
     }
-    return executeInternal();
+    if (executeInternal()) {
+      return true;
+    }
+    if (!noCheck_ && (checkSocketIsReadable_ || checkSocketIsWritable_) &&
+        waitsForSocketOnly()) {
+      auto timeout = timeout_ - checkPoint_.difference(global::wallclock());
+      e_->sleepCommand(
+          this, std::chrono::duration_cast<std::chrono::milliseconds>(timeout));
+    }
+    return false;
   }
   catch (DownloadFailureException& err) {
     A2_LOG_ERROR_EX(EX_DOWNLOAD_ABORTED, err);
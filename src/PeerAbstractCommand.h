@@ -83,6 +83,10 @@ protected:
   virtual void onFailure(const Exception& err){};
   virtual bool exitBeforeExecute() = 0;
   virtual bool executeInternal() = 0;
+  // Returns true if this command has nothing to do until the socket
+  // becomes ready or it times out.  Such command sleeps instead of
+  // being executed every second.
+  virtual bool waitsForSocketOnly() const { return true; }
   void setReadCheckSocket(const std::shared_ptr<SocketCore>& socket);
   void setWriteCheckSocket(const std::shared_ptr<SocketCore>& socket);
   void disableReadCheckSocket();
@@ -92,6 +92,30 @@ void PeerConnection::pushBytes(std::vector<unsigned char> data,
   socketBuffer_.pushBytes(std::move(data), std::move(progressUpdate));
 }
 
+void PeerConnection::pushBytes(const unsigned char* data, size_t length,
+                               std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  if (encryptionEnabled_) {
+    // Encrypt directly into the send buffer rather than encrypting in
+    // place and copying afterwards.
+    encryptor_->encrypt(
+        length, socketBuffer_.reserveBytes(length, std::move(progressUpdate)),
+        data);
+  }
+  else {
+    socketBuffer_.pushBytes(data, length, std::move(progressUpdate));
+  }
+}
+
+void PeerConnection::pushFile(std::shared_ptr<DiskAdaptor> diskAdaptor,
+                              int64_t offset, size_t length,
+                              std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  assert(!encryptionEnabled_);
+  socketBuffer_.pushFile(std::move(diskAdaptor), offset, length,
+                         std::move(progressUpdate));
+}
+
 bool PeerConnection::receiveMessage(unsigned char* data, size_t& dataLength)
 {
   while (1) {
@@ -50,6 +50,7 @@ namespace aria2 {
 class Peer;
 class SocketCore;
 class ARC4Encryptor;
+class DiskAdaptor;
 
 // The maximum length of buffer. If the message length (including 4
 // bytes length and payload length) is larger than this value, it is
@@ -100,6 +101,22 @@ public:
                  std::unique_ptr<ProgressUpdate> progressUpdate =
                      std::unique_ptr<ProgressUpdate>{});
 
+  // Copies length bytes of data into send buffer.  If encryption is
+  // enabled, data is encrypted while it is copied.  data is left
+  // unchanged.
+  void pushBytes(const unsigned char* data, size_t length,
+                 std::unique_ptr<ProgressUpdate> progressUpdate =
+                     std::unique_ptr<ProgressUpdate>{});
+
+  // Pushes length bytes of data at offset in diskAdaptor into send
+  // buffer.  The data is read from diskAdaptor when it is sent.  This
+  // function must not be called if encryption is enabled, because
+  // the data cannot be encrypted in advance.
+  void pushFile(std::shared_ptr<DiskAdaptor> diskAdaptor, int64_t offset,
+                size_t length,
+                std::unique_ptr<ProgressUpdate> progressUpdate =
+                    std::unique_ptr<ProgressUpdate>{});
+
   bool receiveMessage(unsigned char* data, size_t& dataLength);
 
   /**
@@ -114,6 +131,8 @@ public:
   void enableEncryption(std::unique_ptr<ARC4Encryptor> encryptor,
                         std::unique_ptr<ARC4Encryptor> decryptor);
 
+  bool isEncryptionEnabled() const { return encryptionEnabled_; }
+
   void presetBuffer(const unsigned char* data, size_t length);
 
   bool sendBufferIsEmpty() const;
@@ -184,6 +184,7 @@ PeerInteractionCommand::PeerInteractionCommand(
   dispatcher->setBtMessageFactory(factory.get());
   dispatcher->setRequestGroupMan(
       getDownloadEngine()->getRequestGroupMan().get());
+  dispatcher->setPieceStorage(pieceStorage.get());
   dispatcher->setPeerConnection(peerConnection.get());
 
   auto receiver = make_unique<DefaultBtMessageReceiver>();
@@ -76,6 +76,12 @@ protected:
   virtual void onAbort() CXX11_OVERRIDE;
   virtual void onFailure(const Exception& err) CXX11_OVERRIDE;
   virtual bool exitBeforeExecute() CXX11_OVERRIDE;
+  // After handshake, the peer needs periodic processing, such as
+  // keep-alive and choking.
+  virtual bool waitsForSocketOnly() const CXX11_OVERRIDE
+  {
+    return sequence_ != WIRED;
+  }
 
 public:
   PeerInteractionCommand(
@@ -40,6 +40,7 @@
 #include "BitfieldMan.h"
 #include "A2STR.h"
 #include "BtMessageDispatcher.h"
+#include "Piece.h"
 #include "wallclock.h"
 #include "a2functional.h"
 
@@ -51,6 +52,7 @@ PeerSessionResource::PeerSessionResource(int32_t pieceLength,
       lastDownloadUpdate_(Timer::zero()),
       lastAmUnchoking_(Timer::zero()),
       dispatcher_(nullptr),
+      peerRequestQueueSize_(0),
       amChoking_(true),
       amInterested_(false),
       peerChoking_(true),
@@ -214,9 +216,37 @@ int64_t PeerSessionResource::downloadLength() const
 void PeerSessionResource::updateDownload(int32_t bytes)
 {
   netStat_.updateDownload(bytes);
+  bdpEstimator_.updateDelivered(bytes);
   lastDownloadUpdate_ = global::wallclock();
 }
 
+void PeerSessionResource::updateRequestLatency(Timer::Clock::duration latency)
+{
+  bdpEstimator_.updateLatency(latency);
+}
+
+void PeerSessionResource::setPeerRequestQueueSize(size_t size)
+{
+  peerRequestQueueSize_ = size;
+}
+
+size_t PeerSessionResource::getMaxOutstandingRequest() const
+{
+  size_t ub = peerRequestQueueSize_ == 0
+                  ? UB_MAX_OUTSTANDING_REQUEST
+                  : std::min(peerRequestQueueSize_,
+                             UB_MAX_REQQ_OUTSTANDING_REQUEST);
+  return std::min(ub, std::max(DEFAULT_MAX_OUTSTANDING_REQUEST,
+                               bdpEstimator_.getPipelineDepth(
+                                   Piece::BLOCK_LENGTH)));
+}
+
+std::chrono::milliseconds PeerSessionResource::getRequestTimeout(
+    const std::chrono::milliseconds& upper) const
+{
+  return bdpEstimator_.getRequestTimeout(upper);
+}
+
 int64_t PeerSessionResource::getCompletedLength() const
 {
   return bitfieldMan_->getCompletedLength();
@@ -45,6 +45,7 @@
 #include "NetStat.h"
 #include "TimerA2.h"
 #include "ExtensionMessageRegistry.h"
+#include "BdpEstimator.h"
 
 namespace aria2 {
 
@@ -60,6 +61,7 @@ private:
   std::set<size_t> amAllowedIndexSet_;
   ExtensionMessageRegistry extreg_;
   NetStat netStat_;
+  BdpEstimator bdpEstimator_;
 
   Timer lastDownloadUpdate_;
 
@@ -67,6 +69,10 @@ private:
 
   BtMessageDispatcher* dispatcher_;
 
+  // The request queue size (reqq) this peer told in extended
+  // handshake.  0 if not told.
+  size_t peerRequestQueueSize_;
+
   // localhost is choking this peer
   bool amChoking_;
   // localhost is interested in this peer
@@ -192,6 +198,28 @@ public:
 
   const Timer& getLastDownloadUpdate() const { return lastDownloadUpdate_; }
 
+  // Updates the latency estimate with the time from sending a request
+  // to receiving the requested block.
+  void updateRequestLatency(Timer::Clock::duration latency);
+
+  const BdpEstimator& getBdpEstimator() const { return bdpEstimator_; }
+
+  void setPeerRequestQueueSize(size_t size);
+
+  // Returns the number of requests which should be outstanding to
+  // this peer, derived from the bandwidth-delay product of the path
+  // and bounded by the request queue size of the peer.  It is at
+  // least DEFAULT_MAX_OUTSTANDING_REQUEST, unless the peer told a
+  // smaller request queue size: such a peer drops the requests beyond
+  // it.
+  size_t getMaxOutstandingRequest() const;
+
+  // Returns the time after which a request to this peer is considered
+  // stalled, which adapts to the latency of the requests and is at
+  // most |upper|.
+  std::chrono::milliseconds
+  getRequestTimeout(const std::chrono::milliseconds& upper) const;
+
   const Timer& getLastAmUnchoking() const { return lastAmUnchoking_; }
 
   int64_t getCompletedLength() const;
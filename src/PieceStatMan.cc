@@ -43,7 +43,7 @@
 namespace aria2 {
 
 PieceStatMan::PieceStatMan(size_t pieceNum, bool randomShuffle)
-    : order_(pieceNum), counts_(pieceNum)
+    : order_(pieceNum), counts_(pieceNum), positions_(pieceNum), bucketStart_(1)
 {
   for (size_t i = 0; i < pieceNum; ++i) {
     order_[i] = i;
@@ -53,24 +53,69 @@ PieceStatMan::PieceStatMan(size_t pieceNum, bool randomShuffle)
     std::shuffle(order_.begin(), order_.end(),
                  *SimpleRandomizer::getInstance());
   }
+  for (size_t i = 0; i < pieceNum; ++i) {
+    positions_[order_[i]] = i;
+  }
 }
 
 PieceStatMan::~PieceStatMan() = default;
 
-namespace {
-void inc(int& x)
+void PieceStatMan::swapOrder(size_t pos1, size_t pos2)
+{
+  std::swap(order_[pos1], order_[pos2]);
+  positions_[order_[pos1]] = pos1;
+  positions_[order_[pos2]] = pos2;
+}
+
+void PieceStatMan::inc(size_t index)
 {
-  if (x < std::numeric_limits<int>::max()) {
-    ++x;
+  int& x = counts_[index];
+  if (x == std::numeric_limits<int>::max()) {
+    return;
   }
+  size_t c = x + 1;
+  if (bucketStart_.size() <= c) {
+    // The bucket of count c is empty and it begins at the end.
+    bucketStart_.resize(c + 1, order_.size());
+  }
+  // Move the piece to the last position of its bucket, which becomes
+  // the first position of the next bucket.
+  size_t last = bucketStart_[c] - 1;
+  swapOrder(positions_[index], last);
+  bucketStart_[c] = last;
+  ++x;
+}
+
+void PieceStatMan::sub(size_t index)
+{
+  int& x = counts_[index];
+  if (x == 0) {
+    return;
+  }
+  // Move the piece to the first position of its bucket, which becomes
+  // the last position of the previous bucket.
+  size_t first = bucketStart_[x];
+  swapOrder(positions_[index], first);
+  bucketStart_[x] = first + 1;
+  --x;
 }
-} // namespace
 
 namespace {
-void sub(int& x)
+// Calls fun(i) for each set bit index i in the first nbits of
+// bitfield.  Zero bytes are skipped.
+template <typename F>
+void forEachSetBit(const unsigned char* bitfield, size_t nbits, F fun)
 {
-  if (x > 0) {
-    --x;
+  for (size_t i = 0, len = (nbits + 7) / 8; i < len; ++i) {
+    unsigned char bits = bitfield[i];
+    if (i == len - 1) {
+      bits &= bitfield::lastByteMask(nbits);
+    }
+    for (size_t j = i * 8; bits; bits <<= 1, ++j) {
+      if (bits & 0x80u) {
+        fun(j);
+      }
+    }
   }
 }
 } // namespace
@@ -78,41 +123,38 @@ void sub(int& x)
 void PieceStatMan::addPieceStats(const unsigned char* bitfield,
                                  size_t bitfieldLength)
 {
-  for (size_t i = 0, nbits = counts_.size(); i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      inc(counts_[i]);
-    }
-  }
+  forEachSetBit(bitfield, counts_.size(), [this](size_t i) { inc(i); });
 }
 
 void PieceStatMan::subtractPieceStats(const unsigned char* bitfield,
                                       size_t bitfieldLength)
 {
-  for (size_t i = 0, nbits = counts_.size(); i < nbits; ++i) {
-    if (bitfield::test(bitfield, nbits, i)) {
-      sub(counts_[i]);
-    }
-  }
+  forEachSetBit(bitfield, counts_.size(), [this](size_t i) { sub(i); });
 }
 
 void PieceStatMan::updatePieceStats(const unsigned char* newBitfield,
                                     size_t newBitfieldLength,
                                     const unsigned char* oldBitfield)
 {
-  for (size_t i = 0, nbits = counts_.size(); i < nbits; ++i) {
-    bool inNew = bitfield::test(newBitfield, nbits, i);
-    bool inOld = bitfield::test(oldBitfield, nbits, i);
-    if (inNew) {
-      if (!inOld) {
-        inc(counts_[i]);
-      }
+  const size_t nbits = counts_.size();
+  for (size_t i = 0, len = (nbits + 7) / 8; i < len; ++i) {
+    unsigned char diff = newBitfield[i] ^ oldBitfield[i];
+    if (i == len - 1) {
+      diff &= bitfield::lastByteMask(nbits);
     }
-    else if (inOld) {
-      sub(counts_[i]);
+    for (size_t j = i * 8; diff; diff <<= 1, ++j) {
+      if (diff & 0x80u) {
+        if (bitfield::test(newBitfield, nbits, j)) {
+          inc(j);
+        }
+        else {
+          sub(j);
+        }
+      }
     }
   }
 }
 
-void PieceStatMan::addPieceStats(size_t index) { inc(counts_[index]); }
+void PieceStatMan::addPieceStats(size_t index) { inc(index); }
 
 } // namespace aria2
@@ -41,10 +41,23 @@
 
 namespace aria2 {
 
+// Keeps the number of peers which have each piece.  order_ holds the
+// piece indexes sorted by count in ascending order.  The pieces of the
+// same count form a bucket and bucketStart_[c] is the position of the
+// first piece in order_ whose count is greater than or equal to c.
+// Changing the count of a piece by 1 moves it to the border of its
+// bucket and shifts the border, so that it is done in O(1).
 class PieceStatMan {
 private:
   std::vector<size_t> order_;
   std::vector<int> counts_;
+  // positions_[i] is the position of piece i in order_.
+  std::vector<size_t> positions_;
+  std::vector<size_t> bucketStart_;
+
+  void inc(size_t index);
+  void sub(size_t index);
+  void swapOrder(size_t pos1, size_t pos2);
 
 public:
   PieceStatMan(size_t pieceNum, bool randomShuffle);
@@ -61,8 +74,12 @@ public:
                         size_t newBitfieldLength,
                         const unsigned char* oldBitfield);
 
+  // Returns the piece indexes sorted by count in ascending order.
+  // The order of the pieces which have the same count is unspecified.
   const std::vector<size_t>& getOrder() const { return order_; }
 
+  const std::vector<size_t>& getPositions() const { return positions_; }
+
   const std::vector<int>& getCounts() const { return counts_; }
 };
 
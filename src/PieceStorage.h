@@ -49,6 +49,7 @@ namespace aria2 {
 class Piece;
 #ifdef ENABLE_BITTORRENT
 class Peer;
+class EndGameManager;
 #endif // ENABLE_BITTORRENT
 class DiskAdaptor;
 class WrDiskCache;
@@ -124,6 +125,11 @@ public:
   virtual std::shared_ptr<Piece>
   getMissingPiece(const std::shared_ptr<Peer>& peer,
                   const std::vector<size_t>& excludedIndexes, cuid_t cuid) = 0;
+
+  // Returns the object which keeps track of the requests in end game
+  // mode.  Returns nullptr if end game mode has not been entered or
+  // this object does not support it.
+  virtual EndGameManager* getEndGameManager() { return nullptr; }
 #endif // ENABLE_BITTORRENT
 
   // Returns true if there is at least one missing and unused piece.
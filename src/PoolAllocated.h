@@ -0,0 +1,104 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_POOL_ALLOCATED_H
+#define D_POOL_ALLOCATED_H
+
+#include "common.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace aria2 {
+
+// Mix-in which makes new and delete of T recycle the memory of deleted
+// T objects through a free list, instead of going to the allocator
+// each time.  At most N freed blocks are kept.  Use this for small
+// objects which are created and destroyed at high rate, such as
+// BitTorrent messages:
+//
+//   class BtHaveMessage : public IndexBtMessage,
+//                         public PoolAllocated<BtHaveMessage> {
+//
+// The classes derived from T have different size and are allocated
+// as usual.  The free list is not thread-safe: T must be created and
+// deleted only in the thread running DownloadEngine.
+template <typename T, size_t N = 256> class PoolAllocated {
+public:
+  static void* operator new(size_t size)
+  {
+    if (size != sizeof(T) || !freeList_) {
+      return ::operator new(size);
+    }
+    auto node = freeList_;
+    freeList_ = node->next;
+    --numFree_;
+    return node;
+  }
+
+  static void operator delete(void* p, size_t size)
+  {
+    if (!p) {
+      return;
+    }
+    if (size != sizeof(T) || numFree_ >= N) {
+      ::operator delete(p);
+      return;
+    }
+    auto node = static_cast<Node*>(p);
+    node->next = freeList_;
+    freeList_ = node;
+    ++numFree_;
+  }
+
+  // Returns the number of blocks in the free list.
+  static size_t countFree() { return numFree_; }
+
+private:
+  struct Node {
+    Node* next;
+  };
+
+  static Node* freeList_;
+  static size_t numFree_;
+};
+
+template <typename T, size_t N>
+typename PoolAllocated<T, N>::Node* PoolAllocated<T, N>::freeList_ = nullptr;
+
+template <typename T, size_t N> size_t PoolAllocated<T, N>::numFree_ = 0;
+
+} // namespace aria2
+
+#endif // D_POOL_ALLOCATED_H
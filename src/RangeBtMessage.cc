@@ -46,6 +46,13 @@ RangeBtMessage::RangeBtMessage(uint8_t id, const char* name, size_t index,
 }
 
 std::vector<unsigned char> RangeBtMessage::createMessage()
+{
+  auto msg = std::vector<unsigned char>(MESSAGE_LENGTH);
+  writeMessage(msg.data());
+  return msg;
+}
+
+size_t RangeBtMessage::writeMessage(unsigned char* buf)
 {
   /**
    * len --- 13, 4bytes
@@ -55,12 +62,11 @@ std::vector<unsigned char> RangeBtMessage::createMessage()
    * length -- length, 4bytes
    * total: 17bytes
    */
-  auto msg = std::vector<unsigned char>(MESSAGE_LENGTH);
-  bittorrent::createPeerMessageString(msg.data(), MESSAGE_LENGTH, 13, getId());
-  bittorrent::setIntParam(&msg[5], index_);
-  bittorrent::setIntParam(&msg[9], begin_);
-  bittorrent::setIntParam(&msg[13], length_);
-  return msg;
+  bittorrent::createPeerMessageString(buf, MESSAGE_LENGTH, 13, getId());
+  bittorrent::setIntParam(&buf[5], index_);
+  bittorrent::setIntParam(&buf[9], begin_);
+  bittorrent::setIntParam(&buf[13], length_);
+  return MESSAGE_LENGTH;
 }
 
 std::string RangeBtMessage::toString() const
@@ -36,12 +36,14 @@
 #define D_RANGE_BT_MESSAGE_VALIDATOR_H
 
 #include "BtMessageValidator.h"
+#include "PoolAllocated.h"
 
 namespace aria2 {
 
 class RangeBtMessage;
 
-class RangeBtMessageValidator : public BtMessageValidator {
+class RangeBtMessageValidator : public BtMessageValidator,
+                                public PoolAllocated<RangeBtMessageValidator> {
 private:
   const RangeBtMessage* message_;
   size_t numPiece_;
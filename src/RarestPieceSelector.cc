@@ -51,24 +51,43 @@ RarestPieceSelector::RarestPieceSelector(
 bool RarestPieceSelector::select(size_t& index, const unsigned char* bitfield,
                                  size_t nbits) const
 {
+  // order is sorted by count, so the rarest piece in bitfield is the
+  // one which appears first in order.  If bitfield has the rare
+  // pieces, walking order from the beginning finds it quickly.  We
+  // give up walking after the cost of a scan of the whole bitfield.
   const std::vector<size_t>& order = pieceStatMan_->getOrder();
-  const std::vector<int>& counts = pieceStatMan_->getCounts();
-  int min = std::numeric_limits<int>::max();
-  size_t bestIdx = nbits;
-  for (size_t i = 0; i < nbits; ++i) {
-    size_t idx = order[i];
-    if (bitfield::test(bitfield, nbits, idx) && counts[idx] < min) {
-      min = counts[idx];
-      bestIdx = idx;
+  for (size_t i = 0, eoi = std::min(nbits, nbits / 64 + 8); i < eoi; ++i) {
+    if (bitfield::test(bitfield, nbits, order[i])) {
+      index = order[i];
+      return true;
     }
   }
-  if (bestIdx == nbits) {
-    return false;
+  // Otherwise, scan bitfield word by word and take the set bit which
+  // has the smallest position in order.
+  const std::vector<size_t>& positions = pieceStatMan_->getPositions();
+  const size_t len = (nbits + 7) / 8;
+  size_t bestPos = nbits;
+  auto update = [&](uint64_t bits, size_t offset) {
+    while (bits) {
+      size_t z = bitfield::countLeadingZero64(bits);
+      bits &= ~(static_cast<uint64_t>(1) << (63 - z));
+      size_t idx = offset + z;
+      if (idx < nbits && positions[idx] < bestPos) {
+        bestPos = positions[idx];
+      }
+    }
+  };
+  for (size_t w = 0; w < len / 8; ++w) {
+    update(bitfield::loadWord(bitfield, w), w * 64);
   }
-  else {
-    index = bestIdx;
-    return true;
+  for (size_t i = len / 8 * 8; i < len; ++i) {
+    update(static_cast<uint64_t>(bitfield[i]) << 56, i * 8);
+  }
+  if (bestPos == nbits) {
+    return false;
   }
+  index = order[bestPos];
+  return true;
 }
 
 } // namespace aria2
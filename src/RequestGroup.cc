@@ -133,6 +133,7 @@ RequestGroup::RequestGroup(const std::shared_ptr<GroupId>& gid,
 #endif // ENABLE_BITTORRENT
       followingGID_(0),
       lastModifiedTime_(Time::null()),
+      stateSerial_(0),
       timeout_(option->getAsInt(PREF_TIMEOUT)),
       state_(STATE_WAITING),
       numConcurrentCommand_(option->getAsInt(PREF_SPLIT)),
@@ -996,9 +997,18 @@ TransferStat RequestGroup::calculateStat() const
   return stat;
 }
 
+void RequestGroup::updateStateSerial()
+{
+  ++stateSerial_;
+  if (requestGroupMan_) {
+    requestGroupMan_->updateStateSerial();
+  }
+}
+
 void RequestGroup::setHaltRequested(bool f, HaltReason haltReason)
 {
   haltRequested_ = f;
+  updateStateSerial();
   if (haltRequested_) {
     pauseRequested_ = false;
     haltReason_ = haltReason;
@@ -1016,7 +1026,11 @@ void RequestGroup::setForceHaltRequested(bool f, HaltReason haltReason)
   forceHaltRequested_ = f;
 }
 
-void RequestGroup::setPauseRequested(bool f) { pauseRequested_ = f; }
+void RequestGroup::setPauseRequested(bool f)
+{
+  pauseRequested_ = f;
+  updateStateSerial();
+}
 
 void RequestGroup::setRestartRequested(bool f) { restartRequested_ = f; }
 
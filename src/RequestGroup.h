@@ -139,6 +139,11 @@ private:
 
   Time lastModifiedTime_;
 
+  // Incremented when the state of this download which is reported
+  // by RPC is changed by the other means than download progress,
+  // e.g., pause, unpause and changeOption.
+  uint64_t stateSerial_;
+
   // Timeout used for HTTP/FTP downloads.
   std::chrono::seconds timeout_;
 
@@ -353,6 +358,12 @@ public:
 
   bool isPauseRequested() const { return pauseRequested_; }
 
+  uint64_t getStateSerial() const { return stateSerial_; }
+
+  // Also updates the serial of RequestGroupMan if this group is
+  // active.
+  void updateStateSerial();
+
   void setRestartRequested(bool f);
 
   bool isRestartRequested() const { return restartRequested_; }
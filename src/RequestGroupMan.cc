@@ -88,6 +88,9 @@
 #ifdef ENABLE_BITTORRENT
 #include "bittorrent_helper.h"
 #endif // ENABLE_BITTORRENT
+#ifdef ENABLE_THREADS
+#include "EngineShardMan.h"
+#endif // ENABLE_THREADS
 
 namespace aria2 {
 
@@ -124,7 +127,12 @@ RequestGroupMan::RequestGroupMan(
       maxDownloadResult_(option->getAsInt(PREF_MAX_DOWNLOAD_RESULT)),
       openedFileCounter_(std::make_shared<OpenedFileCounter>(
           this, option->getAsInt(PREF_BT_MAX_OPEN_FILES))),
-      numStoppedTotal_(0)
+#ifdef ENABLE_THREADS
+      engineShardMan_(nullptr),
+      shardIndex_(0),
+#endif // ENABLE_THREADS
+      numStoppedTotal_(0),
+      stateSerial_(0)
 {
   setupOptimizeConcurrentDownloads();
   appendReservedGroup(reservedGroups_, requestGroups.begin(),
@@ -155,7 +163,8 @@ bool RequestGroupMan::downloadFinished()
   if (keepRunning_) {
     return false;
   }
-  return requestGroups_.empty() && reservedGroups_.empty();
+  return requestGroups_.empty() && reservedGroups_.empty() &&
+         countShardedGroup() == 0;
 }
 
 void RequestGroupMan::addRequestGroup(
@@ -210,6 +219,16 @@ size_t RequestGroupMan::countRequestGroup() const
   return requestGroups_.size();
 }
 
+size_t RequestGroupMan::countShardedGroup() const
+{
+#ifdef ENABLE_THREADS
+  if (engineShardMan_ && shardIndex_ == 0) {
+    return engineShardMan_->countGroup();
+  }
+#endif // ENABLE_THREADS
+  return 0;
+}
+
 std::shared_ptr<RequestGroup> RequestGroupMan::findGroup(a2_gid_t gid) const
 {
   std::shared_ptr<RequestGroup> rg = requestGroups_.get(gid);
@@ -481,6 +500,20 @@ void RequestGroupMan::removeStoppedGroup(DownloadEngine* e)
     A2_LOG_DEBUG(fmt("%lu RequestGroup(s) deleted.",
                      static_cast<unsigned long>(numRemoved)));
   }
+#ifdef ENABLE_THREADS
+  if (engineShardMan_ && shardIndex_ > 0 && numRemoved > 0) {
+    // The primary engine owns the download results and the download
+    // queue.
+    std::vector<std::shared_ptr<DownloadResult>> results(
+        downloadResults_.begin(), downloadResults_.end());
+    std::vector<std::shared_ptr<RequestGroup>> nextGroups(
+        reservedGroups_.begin(), reservedGroups_.end());
+    downloadResults_.clear();
+    reservedGroups_.clear();
+    engineShardMan_->postStopped(shardIndex_, numRemoved, std::move(results),
+                                 std::move(nextGroups));
+  }
+#endif // ENABLE_THREADS
 }
 
 void RequestGroupMan::configureRequestGroup(
@@ -553,28 +586,26 @@ void RequestGroupMan::fillRequestGroupFromReserver(DownloadEngine* e)
     // Drop pieceStorage here because paused download holds its
     // reference.
     groupToAdd->dropPieceStorage();
-    configureRequestGroup(groupToAdd);
-    groupToAdd->setRequestGroupMan(this);
-    groupToAdd->setState(RequestGroup::STATE_ACTIVE);
-    ++numActive_;
-    requestGroups_.push_back(groupToAdd->getGID(), groupToAdd);
-    try {
-      auto res = createInitialCommand(groupToAdd, e);
-      ++count;
-      if (res.empty()) {
-        requestQueueCheck();
-      }
-      else {
-        e->addCommand(std::move(res));
+#ifdef ENABLE_THREADS
+    if (engineShardMan_) {
+      auto shard = engineShardMan_->selectShard(
+          groupToAdd, numActive_ - engineShardMan_->countGroup());
+      if (shard != 0) {
+        groupToAdd->setState(RequestGroup::STATE_ACTIVE);
+        ++numActive_;
+        ++count;
+        // Run the hook before the group is handed over, since the
+        // worker shard starts to modify it right away.
+        util::executeHookByOptName(groupToAdd, e->getOption(),
+                                   PREF_ON_DOWNLOAD_START);
+        notifyDownloadEvent(EVENT_ON_DOWNLOAD_START, groupToAdd);
+        engineShardMan_->assign(shard, groupToAdd);
+        continue;
       }
     }
-    catch (RecoverableException& ex) {
-      A2_LOG_ERROR_EX(EX_EXCEPTION_CAUGHT, ex);
-      A2_LOG_DEBUG("Deleting temporal commands.");
-      groupToAdd->setLastErrorCode(ex.getErrorCode(), ex.what());
-      // We add groupToAdd to e later in order to it is processed in
-      // removeStoppedGroup().
-      requestQueueCheck();
+#endif // ENABLE_THREADS
+    if (startRequestGroup(groupToAdd, e)) {
+      ++count;
     }
 
     util::executeHookByOptName(groupToAdd, e->getOption(),
@@ -592,6 +623,35 @@ void RequestGroupMan::fillRequestGroupFromReserver(DownloadEngine* e)
   }
 }
 
+bool RequestGroupMan::startRequestGroup(
+    const std::shared_ptr<RequestGroup>& group, DownloadEngine* e)
+{
+  configureRequestGroup(group);
+  group->setRequestGroupMan(this);
+  group->setState(RequestGroup::STATE_ACTIVE);
+  ++numActive_;
+  requestGroups_.push_back(group->getGID(), group);
+  try {
+    auto res = createInitialCommand(group, e);
+    if (res.empty()) {
+      requestQueueCheck();
+    }
+    else {
+      e->addCommand(std::move(res));
+    }
+    return true;
+  }
+  catch (RecoverableException& ex) {
+    A2_LOG_ERROR_EX(EX_EXCEPTION_CAUGHT, ex);
+    A2_LOG_DEBUG("Deleting temporal commands.");
+    group->setLastErrorCode(ex.getErrorCode(), ex.what());
+    // We add group to e later in order to it is processed in
+    // removeStoppedGroup().
+    requestQueueCheck();
+    return false;
+  }
+}
+
 void RequestGroupMan::save()
 {
   for (auto& rg : requestGroups_) {
@@ -888,6 +948,11 @@ void RequestGroupMan::halt()
   for (auto& elem : requestGroups_) {
     elem->setHaltRequested(true);
   }
+#ifdef ENABLE_THREADS
+  if (engineShardMan_ && shardIndex_ == 0) {
+    engineShardMan_->halt();
+  }
+#endif // ENABLE_THREADS
 }
 
 void RequestGroupMan::forceHalt()
@@ -895,6 +960,11 @@ void RequestGroupMan::forceHalt()
   for (auto& elem : requestGroups_) {
     elem->setForceHaltRequested(true);
   }
+#ifdef ENABLE_THREADS
+  if (engineShardMan_ && shardIndex_ == 0) {
+    engineShardMan_->forceHalt();
+  }
+#endif // ENABLE_THREADS
 }
 
 TransferStat RequestGroupMan::calculateStat()
@@ -983,16 +1053,56 @@ void RequestGroupMan::removeStaleServerStat(const std::chrono::seconds& timeout)
   serverStatMan_->removeStaleServerStat(timeout);
 }
 
+int RequestGroupMan::calculateOverallDownloadSpeed()
+{
+  int speed = netStat_.calculateDownloadSpeed();
+#ifdef ENABLE_THREADS
+  if (engineShardMan_) {
+    speed = engineShardMan_->updateDownloadSpeed(shardIndex_, speed);
+  }
+#endif // ENABLE_THREADS
+  return speed;
+}
+
+int RequestGroupMan::calculateOverallUploadSpeed()
+{
+  int speed = netStat_.calculateUploadSpeed();
+#ifdef ENABLE_THREADS
+  if (engineShardMan_) {
+    speed = engineShardMan_->updateUploadSpeed(shardIndex_, speed);
+  }
+#endif // ENABLE_THREADS
+  return speed;
+}
+
 bool RequestGroupMan::doesOverallDownloadSpeedExceed()
 {
-  return maxOverallDownloadSpeedLimit_ > 0 &&
-         maxOverallDownloadSpeedLimit_ < netStat_.calculateDownloadSpeed();
+  if (maxOverallDownloadSpeedLimit_ <= 0) {
+    return false;
+  }
+  int speed = netStat_.calculateDownloadSpeed();
+#ifdef ENABLE_THREADS
+  if (engineShardMan_) {
+    return engineShardMan_->doesDownloadSpeedExceed(
+        shardIndex_, speed, maxOverallDownloadSpeedLimit_);
+  }
+#endif // ENABLE_THREADS
+  return maxOverallDownloadSpeedLimit_ < speed;
 }
 
 bool RequestGroupMan::doesOverallUploadSpeedExceed()
 {
-  return maxOverallUploadSpeedLimit_ > 0 &&
-         maxOverallUploadSpeedLimit_ < netStat_.calculateUploadSpeed();
+  if (maxOverallUploadSpeedLimit_ <= 0) {
+    return false;
+  }
+  int speed = netStat_.calculateUploadSpeed();
+#ifdef ENABLE_THREADS
+  if (engineShardMan_) {
+    return engineShardMan_->doesUploadSpeedExceed(shardIndex_, speed,
+                                                  maxOverallUploadSpeedLimit_);
+  }
+#endif // ENABLE_THREADS
+  return maxOverallUploadSpeedLimit_ < speed;
 }
 
 void RequestGroupMan::getUsedHosts(
@@ -61,6 +61,9 @@ class OutputFile;
 class UriListParser;
 class WrDiskCache;
 class OpenedFileCounter;
+#ifdef ENABLE_THREADS
+class EngineShardMan;
+#endif // ENABLE_THREADS
 
 typedef IndexedList<a2_gid_t, std::shared_ptr<RequestGroup>> RequestGroupList;
 typedef IndexedList<a2_gid_t, std::shared_ptr<DownloadResult>>
@@ -123,10 +126,22 @@ private:
 
   std::shared_ptr<OpenedFileCounter> openedFileCounter_;
 
+#ifdef ENABLE_THREADS
+  // Not null if downloads are run by several engine shards.
+  EngineShardMan* engineShardMan_;
+  // The shard which this object belongs to.  0 is the primary engine,
+  // which hands downloads to the others.
+  size_t shardIndex_;
+#endif // ENABLE_THREADS
+
   // The number of stopped downloads so far in total, including
   // evicted DownloadResults.
   size_t numStoppedTotal_;
 
+  // Incremented whenever the state of any active RequestGroup
+  // changes.
+  uint64_t stateSerial_;
+
   // SHA1 hash value of the content of last session serialization.
   std::string lastSessionHash_;
 
@@ -167,6 +182,13 @@ public:
 
   void fillRequestGroupFromReserver(DownloadEngine* e);
 
+  // Makes |group| active and creates its initial commands in |e|.
+  // Returns false if the commands could not be created.  The group is
+  // added to the active downloads anyway, so that it is processed by
+  // removeStoppedGroup().
+  bool startRequestGroup(const std::shared_ptr<RequestGroup>& group,
+                         DownloadEngine* e);
+
   // Note that this method does not call addRequestGroupIndex(). This
   // method should be considered as private, but exposed for unit
   // testing purpose.
@@ -186,6 +208,18 @@ public:
 
   size_t countRequestGroup() const;
 
+  // Returns the number of downloads handed to the worker shards of
+  // EngineShardMan.  They are not in requestGroups_.
+  size_t countShardedGroup() const;
+
+#ifdef ENABLE_THREADS
+  void setEngineShardMan(EngineShardMan* engineShardMan, size_t shardIndex)
+  {
+    engineShardMan_ = engineShardMan;
+    shardIndex_ = shardIndex;
+  }
+#endif // ENABLE_THREADS
+
   const RequestGroupList& getRequestGroups() const { return requestGroups_; }
 
   const RequestGroupList& getReservedGroups() const { return reservedGroups_; }
@@ -286,9 +320,18 @@ public:
 
   void removeStaleServerStat(const std::chrono::seconds& timeout);
 
+  // Returns the download speed of all engine shards, or the one of
+  // this object if downloads are not sharded.
+  int calculateOverallDownloadSpeed();
+
+  // Same as calculateOverallDownloadSpeed(), but for upload speed.
+  int calculateOverallUploadSpeed();
+
   // Returns true if current download speed exceeds
   // maxOverallDownloadSpeedLimit_.  Always returns false if
   // maxOverallDownloadSpeedLimit_ == 0.  Otherwise returns false.
+  // If downloads are sharded, the limit applies to all shards, see
+  // EngineShardMan::doesDownloadSpeedExceed().
   bool doesOverallDownloadSpeedExceed();
 
   void setMaxOverallDownloadSpeedLimit(int speed)
@@ -353,6 +396,10 @@ public:
 
   size_t getNumStoppedTotal() const { return numStoppedTotal_; }
 
+  uint64_t getStateSerial() const { return stateSerial_; }
+
+  void updateStateSerial() { ++stateSerial_; }
+
   void setLastSessionHash(std::string lastSessionHash)
   {
     lastSessionHash_ = std::move(lastSessionHash);
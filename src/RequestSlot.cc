@@ -36,9 +36,14 @@
 
 namespace aria2 {
 
-bool RequestSlot::isTimeout(const std::chrono::seconds& t) const
+bool RequestSlot::isTimeout(const std::chrono::milliseconds& t) const
 {
   return dispatchedTime_.difference(global::wallclock()) >= t;
 }
 
+Timer::Clock::duration RequestSlot::getLatency() const
+{
+  return dispatchedTime_.difference(global::wallclock());
+}
+
 } // namespace aria2
@@ -39,10 +39,11 @@
 #include "TimerA2.h"
 #include "Piece.h"
 #include "wallclock.h"
+#include "PoolAllocated.h"
 
 namespace aria2 {
 
-class RequestSlot {
+class RequestSlot : public PoolAllocated<RequestSlot> {
 public:
   RequestSlot(size_t index, int32_t begin, int32_t length, size_t blockIndex,
               std::shared_ptr<Piece> piece = nullptr)
@@ -51,6 +52,7 @@ public:
         begin_(begin),
         length_(length),
         blockIndex_(blockIndex),
+        released_(false),
         piece_(std::move(piece))
   {
   }
@@ -60,7 +62,8 @@ public:
         index_(0),
         begin_(0),
         length_(0),
-        blockIndex_(0)
+        blockIndex_(0),
+        released_(false)
   {
   }
 
@@ -85,7 +88,10 @@ public:
     }
   }
 
-  bool isTimeout(const std::chrono::seconds& t) const;
+  bool isTimeout(const std::chrono::milliseconds& t) const;
+
+  // Returns the time elapsed since this request was dispatched.
+  Timer::Clock::duration getLatency() const;
 
   size_t getIndex() const { return index_; }
   void setIndex(size_t index) { index_ = index; }
@@ -101,6 +107,11 @@ public:
 
   const std::shared_ptr<Piece>& getPiece() const { return piece_; }
 
+  // True if the block is open to the other connections in end game
+  // mode because this request looks stalled.
+  bool isReleased() const { return released_; }
+  void setReleased(bool f) { released_ = f; }
+
   // For unit test
   void setDispatchedTime(Timer t) { dispatchedTime_ = std::move(t); }
 
@@ -110,6 +121,7 @@ private:
   int32_t begin_;
   int32_t length_;
   size_t blockIndex_;
+  bool released_;
 
   // This is the piece whose index is index of this RequestSlot has.
   // To detect duplicate RequestSlot, we have to find the piece using
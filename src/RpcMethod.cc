@@ -49,6 +49,7 @@
 #include "DlAbortEx.h"
 #include "a2functional.h"
 #include "util.h"
+#include "ValueWriter.h"
 
 namespace aria2 {
 
@@ -94,6 +95,11 @@ RpcResponse RpcMethod::execute(RpcRequest req, DownloadEngine* e)
   try {
     authorize(req, e);
     authorized = RpcResponse::AUTHORIZED;
+    if (req.directEncoding) {
+      std::string out;
+      writeResult(req, e, *createParamWriter(req.jsonRpc, out));
+      return RpcResponse(0, authorized, std::move(out), std::move(req.id));
+    }
     auto r = process(req, e);
     return RpcResponse(0, authorized, std::move(r), std::move(req.id));
   }
@@ -104,6 +110,20 @@ RpcResponse RpcMethod::execute(RpcRequest req, DownloadEngine* e)
   }
 }
 
+void RpcMethod::writeResult(const RpcRequest& req, DownloadEngine* e,
+                            ValueWriter& writer)
+{
+  writer.writeValue(process(req, e).get());
+}
+
+std::unique_ptr<ValueBase> StreamingRpcMethod::process(const RpcRequest& req,
+                                                       DownloadEngine* e)
+{
+  ValueBaseWriter writer;
+  writeResult(req, e, writer);
+  return writer.getResult();
+}
+
 namespace {
 template <typename InputIterator, typename Pred>
 void gatherOption(InputIterator first, InputIterator last, Pred pred,
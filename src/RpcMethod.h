@@ -48,6 +48,7 @@ class DownloadEngine;
 class OptionParser;
 class Option;
 class Exception;
+class ValueWriter;
 
 namespace rpc {
 
@@ -73,6 +74,12 @@ protected:
   virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
                                              DownloadEngine* e) = 0;
 
+  // Writes the result of req to writer.  This function is used
+  // instead of process() if req.directEncoding is true.  The default
+  // implementation writes the value returned by process().
+  virtual void writeResult(const RpcRequest& req, DownloadEngine* e,
+                           ValueWriter& writer);
+
   void gatherRequestOption(Option* option, const Dict* optionsDict);
 
   void gatherChangeableOption(Option* option, Option* pendingOption,
@@ -103,6 +110,20 @@ public:
   virtual RpcResponse execute(RpcRequest req, DownloadEngine* e);
 };
 
+// Base class of RPC methods which can return large results.
+// Subclass writes the result through ValueWriter in writeResult(),
+// so that it can be encoded without building ValueBase.  Any
+// exception must be thrown before writing anything.
+class StreamingRpcMethod : public RpcMethod {
+protected:
+  // Builds ValueBase from the output of writeResult().
+  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
+                                             DownloadEngine* e) CXX11_OVERRIDE;
+
+  virtual void writeResult(const RpcRequest& req, DownloadEngine* e,
+                           ValueWriter& writer) CXX11_OVERRIDE = 0;
+};
+
 } // namespace rpc
 
 } // namespace aria2
@@ -45,6 +45,7 @@
 #include "OptionParser.h"
 #include "OptionHandler.h"
 #include "DownloadEngine.h"
+#include "SocketPool.h"
 #include "RequestGroup.h"
 #include "download_helper.h"
 #include "util.h"
@@ -69,6 +70,10 @@
 #include "MessageDigest.h"
 #include "message_digest_helper.h"
 #include "OpenedFileCounter.h"
+#include "StatusSubscription.h"
+#ifdef ENABLE_WEBSOCKET
+#include "WebSocketSession.h"
+#endif // ENABLE_WEBSOCKET
 #ifdef ENABLE_BITTORRENT
 #include "bittorrent_helper.h"
 #include "BtRegistry.h"
@@ -76,6 +81,7 @@
 #include "Peer.h"
 #include "BtRuntime.h"
 #include "BtAnnounce.h"
+#include "EndGameManager.h"
 #endif // ENABLE_BITTORRENT
 #include "CheckIntegrityEntry.h"
 
@@ -119,6 +125,7 @@ const char KEY_PORT[] = "port";
 const char KEY_AM_CHOKING[] = "amChoking";
 const char KEY_PEER_CHOKING[] = "peerChoking";
 const char KEY_SEEDER[] = "seeder";
+const char KEY_WASTED_LENGTH[] = "wastedLength";
 const char KEY_INDEX[] = "index";
 const char KEY_PATH[] = "path";
 const char KEY_SELECTED[] = "selected";
@@ -145,6 +152,8 @@ const char KEY_NUM_WAITING[] = "numWaiting";
 const char KEY_NUM_STOPPED[] = "numStopped";
 const char KEY_NUM_ACTIVE[] = "numActive";
 const char KEY_NUM_STOPPED_TOTAL[] = "numStoppedTotal";
+const char KEY_NUM_CONNECTION_POOL_HIT[] = "numConnectionPoolHit";
+const char KEY_NUM_CONNECTION_POOL_MISS[] = "numConnectionPoolMiss";
 const char KEY_VERIFIED_LENGTH[] = "verifiedLength";
 const char KEY_VERIFY_PENDING[] = "verifyIntegrityPending";
 } // namespace
@@ -533,76 +542,80 @@ std::unique_ptr<ValueBase> UnpauseAllRpcMethod::process(const RpcRequest& req,
 
 namespace {
 template <typename InputIterator>
-void createUriEntry(List* uriList, InputIterator first, InputIterator last,
-                    const std::string& status)
+void createUriEntry(ValueWriter& writer, InputIterator first,
+                    InputIterator last, const std::string& status)
 {
   for (; first != last; ++first) {
-    auto entry = Dict::g();
-    entry->put(KEY_URI, *first);
-    entry->put(KEY_STATUS, status);
-    uriList->append(std::move(entry));
+    writer.beginDict();
+    writer.put(KEY_URI, *first);
+    writer.put(KEY_STATUS, status);
+    writer.endDict();
   }
 }
 } // namespace
 
 namespace {
-void createUriEntry(List* uriList, const std::shared_ptr<FileEntry>& file)
+// Writes the URI entries of file as the elements of the current list.
+void createUriEntry(ValueWriter& writer, const std::shared_ptr<FileEntry>& file)
 {
-  createUriEntry(uriList, std::begin(file->getSpentUris()),
+  createUriEntry(writer, std::begin(file->getSpentUris()),
                  std::end(file->getSpentUris()), VLB_USED);
-  createUriEntry(uriList, std::begin(file->getRemainingUris()),
+  createUriEntry(writer, std::begin(file->getRemainingUris()),
                  std::end(file->getRemainingUris()), VLB_WAITING);
 }
 } // namespace
 
 namespace {
+// Writes the file entries as the elements of the current list.
 template <typename InputIterator>
-void createFileEntry(List* files, InputIterator first, InputIterator last,
-                     const BitfieldMan* bf)
+void createFileEntry(ValueWriter& writer, InputIterator first,
+                     InputIterator last, const BitfieldMan* bf)
 {
   size_t index = 1;
   for (; first != last; ++first, ++index) {
-    auto entry = Dict::g();
-    entry->put(KEY_INDEX, util::uitos(index));
-    entry->put(KEY_PATH, (*first)->getPath());
-    entry->put(KEY_SELECTED, (*first)->isRequested() ? VLB_TRUE : VLB_FALSE);
-    entry->put(KEY_LENGTH, util::itos((*first)->getLength()));
+    writer.beginDict();
+    writer.put(KEY_INDEX, util::uitos(index));
+    writer.put(KEY_PATH, (*first)->getPath());
+    writer.put(KEY_SELECTED, (*first)->isRequested() ? VLB_TRUE : VLB_FALSE);
+    writer.put(KEY_LENGTH, util::itos((*first)->getLength()));
     int64_t completedLength = bf->getOffsetCompletedLength(
         (*first)->getOffset(), (*first)->getLength());
-    entry->put(KEY_COMPLETED_LENGTH, util::itos(completedLength));
+    writer.put(KEY_COMPLETED_LENGTH, util::itos(completedLength));
 
-    auto uriList = List::g();
-    createUriEntry(uriList.get(), *first);
-    entry->put(KEY_URIS, std::move(uriList));
-    files->append(std::move(entry));
+    writer.writeKey(KEY_URIS);
+    writer.beginList();
+    createUriEntry(writer, *first);
+    writer.endList();
+    writer.endDict();
   }
 }
 } // namespace
 
 namespace {
 template <typename InputIterator>
-void createFileEntry(List* files, InputIterator first, InputIterator last,
-                     int64_t totalLength, int32_t pieceLength,
-                     const std::string& bitfield)
+void createFileEntry(ValueWriter& writer, InputIterator first,
+                     InputIterator last, int64_t totalLength,
+                     int32_t pieceLength, const std::string& bitfield)
 {
   BitfieldMan bf(pieceLength, totalLength);
   bf.setBitfield(reinterpret_cast<const unsigned char*>(bitfield.data()),
                  bitfield.size());
-  createFileEntry(files, first, last, &bf);
+  createFileEntry(writer, first, last, &bf);
 }
 } // namespace
 
 namespace {
 template <typename InputIterator>
-void createFileEntry(List* files, InputIterator first, InputIterator last,
-                     int64_t totalLength, int32_t pieceLength,
+void createFileEntry(ValueWriter& writer, InputIterator first,
+                     InputIterator last, int64_t totalLength,
+                     int32_t pieceLength,
                      const std::shared_ptr<PieceStorage>& ps)
 {
   BitfieldMan bf(pieceLength, totalLength);
   if (ps) {
     bf.setBitfield(ps->getBitfield(), ps->getBitfieldLength());
   }
-  createFileEntry(files, first, last, &bf);
+  createFileEntry(writer, first, last, &bf);
 }
 } // namespace
 
@@ -616,137 +629,167 @@ bool requested_key(const std::vector<std::string>& keys, const std::string& k)
 void gatherProgressCommon(Dict* entryDict,
                           const std::shared_ptr<RequestGroup>& group,
                           const std::vector<std::string>& keys)
+{
+  ValueBaseWriter writer(entryDict);
+  gatherProgressCommon(writer, group, keys);
+}
+
+void gatherProgressCommon(ValueWriter& writer,
+                          const std::shared_ptr<RequestGroup>& group,
+                          const std::vector<std::string>& keys)
 {
   auto& ps = group->getPieceStorage();
   if (requested_key(keys, KEY_GID)) {
-    entryDict->put(KEY_GID, GroupId::toHex(group->getGID()).c_str());
+    writer.put(KEY_GID, GroupId::toHex(group->getGID()));
   }
   if (requested_key(keys, KEY_TOTAL_LENGTH)) {
     // This is "filtered" total length if --select-file is used.
-    entryDict->put(KEY_TOTAL_LENGTH, util::itos(group->getTotalLength()));
+    writer.put(KEY_TOTAL_LENGTH, util::itos(group->getTotalLength()));
   }
   if (requested_key(keys, KEY_COMPLETED_LENGTH)) {
     // This is "filtered" total length if --select-file is used.
-    entryDict->put(KEY_COMPLETED_LENGTH,
-                   util::itos(group->getCompletedLength()));
+    writer.put(KEY_COMPLETED_LENGTH, util::itos(group->getCompletedLength()));
   }
   TransferStat stat = group->calculateStat();
   if (requested_key(keys, KEY_DOWNLOAD_SPEED)) {
-    entryDict->put(KEY_DOWNLOAD_SPEED, util::itos(stat.downloadSpeed));
+    writer.put(KEY_DOWNLOAD_SPEED, util::itos(stat.downloadSpeed));
   }
   if (requested_key(keys, KEY_UPLOAD_SPEED)) {
-    entryDict->put(KEY_UPLOAD_SPEED, util::itos(stat.uploadSpeed));
+    writer.put(KEY_UPLOAD_SPEED, util::itos(stat.uploadSpeed));
   }
   if (requested_key(keys, KEY_UPLOAD_LENGTH)) {
-    entryDict->put(KEY_UPLOAD_LENGTH, util::itos(stat.allTimeUploadLength));
+    writer.put(KEY_UPLOAD_LENGTH, util::itos(stat.allTimeUploadLength));
   }
   if (requested_key(keys, KEY_CONNECTIONS)) {
-    entryDict->put(KEY_CONNECTIONS, util::itos(group->getNumConnection()));
+    writer.put(KEY_CONNECTIONS, util::itos(group->getNumConnection()));
   }
   if (requested_key(keys, KEY_BITFIELD)) {
     if (ps) {
       if (ps->getBitfieldLength() > 0) {
-        entryDict->put(KEY_BITFIELD,
-                       util::toHex(ps->getBitfield(), ps->getBitfieldLength()));
+        writer.put(KEY_BITFIELD,
+                   util::toHex(ps->getBitfield(), ps->getBitfieldLength()));
       }
     }
   }
   auto& dctx = group->getDownloadContext();
   if (requested_key(keys, KEY_PIECE_LENGTH)) {
-    entryDict->put(KEY_PIECE_LENGTH, util::itos(dctx->getPieceLength()));
+    writer.put(KEY_PIECE_LENGTH, util::itos(dctx->getPieceLength()));
   }
   if (requested_key(keys, KEY_NUM_PIECES)) {
-    entryDict->put(KEY_NUM_PIECES, util::uitos(dctx->getNumPieces()));
+    writer.put(KEY_NUM_PIECES, util::uitos(dctx->getNumPieces()));
   }
   if (requested_key(keys, KEY_FOLLOWED_BY)) {
     if (!group->followedBy().empty()) {
-      auto list = List::g();
+      writer.writeKey(KEY_FOLLOWED_BY);
+      writer.beginList();
       // The element is GID.
       for (auto& gid : group->followedBy()) {
-        list->append(GroupId::toHex(gid));
+        writer.writeString(GroupId::toHex(gid));
       }
-      entryDict->put(KEY_FOLLOWED_BY, std::move(list));
+      writer.endList();
     }
   }
   if (requested_key(keys, KEY_FOLLOWING)) {
     if (group->following()) {
-      entryDict->put(KEY_FOLLOWING, GroupId::toHex(group->following()));
+      writer.put(KEY_FOLLOWING, GroupId::toHex(group->following()));
     }
   }
   if (requested_key(keys, KEY_BELONGS_TO)) {
     if (group->belongsTo()) {
-      entryDict->put(KEY_BELONGS_TO, GroupId::toHex(group->belongsTo()));
+      writer.put(KEY_BELONGS_TO, GroupId::toHex(group->belongsTo()));
     }
   }
   if (requested_key(keys, KEY_FILES)) {
-    auto files = List::g();
-    createFileEntry(files.get(), std::begin(dctx->getFileEntries()),
+    writer.writeKey(KEY_FILES);
+    writer.beginList();
+    createFileEntry(writer, std::begin(dctx->getFileEntries()),
                     std::end(dctx->getFileEntries()), dctx->getTotalLength(),
                     dctx->getPieceLength(), ps);
-    entryDict->put(KEY_FILES, std::move(files));
+    writer.endList();
   }
   if (requested_key(keys, KEY_DIR)) {
-    entryDict->put(KEY_DIR, group->getOption()->get(PREF_DIR));
+    writer.put(KEY_DIR, group->getOption()->get(PREF_DIR));
   }
 }
 
 #ifdef ENABLE_BITTORRENT
 void gatherBitTorrentMetadata(Dict* btDict, TorrentAttribute* torrentAttrs)
+{
+  ValueBaseWriter writer(btDict);
+  gatherBitTorrentMetadata(writer, torrentAttrs);
+}
+
+void gatherBitTorrentMetadata(ValueWriter& writer,
+                              TorrentAttribute* torrentAttrs)
 {
   if (!torrentAttrs->comment.empty()) {
-    btDict->put(KEY_COMMENT, torrentAttrs->comment);
+    writer.put(KEY_COMMENT, torrentAttrs->comment);
   }
   if (torrentAttrs->creationDate) {
-    btDict->put(KEY_CREATION_DATE, Integer::g(torrentAttrs->creationDate));
+    writer.writeKey(KEY_CREATION_DATE);
+    writer.writeInteger(torrentAttrs->creationDate);
   }
   if (torrentAttrs->mode) {
-    btDict->put(KEY_MODE, bittorrent::getModeString(torrentAttrs->mode));
+    writer.put(KEY_MODE, bittorrent::getModeString(torrentAttrs->mode));
   }
-  auto destAnnounceList = List::g();
+  writer.writeKey(KEY_ANNOUNCE_LIST);
+  writer.beginList();
   for (auto& annlist : torrentAttrs->announceList) {
-    auto destAnnounceTier = List::g();
+    writer.beginList();
     for (auto& ann : annlist) {
-      destAnnounceTier->append(ann);
+      writer.writeString(ann);
     }
-    destAnnounceList->append(std::move(destAnnounceTier));
+    writer.endList();
   }
-  btDict->put(KEY_ANNOUNCE_LIST, std::move(destAnnounceList));
+  writer.endList();
   if (!torrentAttrs->metadata.empty()) {
-    auto infoDict = Dict::g();
-    infoDict->put(KEY_NAME, torrentAttrs->name);
-    btDict->put(KEY_INFO, std::move(infoDict));
+    writer.writeKey(KEY_INFO);
+    writer.beginDict();
+    writer.put(KEY_NAME, torrentAttrs->name);
+    writer.endDict();
   }
 }
 
 namespace {
-void gatherProgressBitTorrent(Dict* entryDict,
+void gatherProgressBitTorrent(ValueWriter& writer,
                               const std::shared_ptr<RequestGroup>& group,
                               TorrentAttribute* torrentAttrs,
                               BtObject* btObject,
                               const std::vector<std::string>& keys)
 {
   if (requested_key(keys, KEY_INFO_HASH)) {
-    entryDict->put(KEY_INFO_HASH, util::toHex(torrentAttrs->infoHash));
+    writer.put(KEY_INFO_HASH, util::toHex(torrentAttrs->infoHash));
   }
   if (requested_key(keys, KEY_BITTORRENT)) {
-    auto btDict = Dict::g();
-    gatherBitTorrentMetadata(btDict.get(), torrentAttrs);
-    entryDict->put(KEY_BITTORRENT, std::move(btDict));
+    writer.writeKey(KEY_BITTORRENT);
+    writer.beginDict();
+    gatherBitTorrentMetadata(writer, torrentAttrs);
+    writer.endDict();
   }
   if (requested_key(keys, KEY_NUM_SEEDERS)) {
     if (!btObject) {
-      entryDict->put(KEY_NUM_SEEDERS, VLB_ZERO);
+      writer.put(KEY_NUM_SEEDERS, VLB_ZERO);
     }
     else {
       auto& peerStorage = btObject->peerStorage;
       assert(peerStorage);
       auto& peers = peerStorage->getUsedPeers();
-      entryDict->put(KEY_NUM_SEEDERS,
-                     util::uitos(countSeeder(peers.begin(), peers.end())));
+      writer.put(KEY_NUM_SEEDERS,
+                 util::uitos(countSeeder(peers.begin(), peers.end())));
     }
   }
   if (requested_key(keys, KEY_SEEDER)) {
-    entryDict->put(KEY_SEEDER, group->isSeeder() ? VLB_TRUE : VLB_FALSE);
+    writer.put(KEY_SEEDER, group->isSeeder() ? VLB_TRUE : VLB_FALSE);
+  }
+  if (requested_key(keys, KEY_WASTED_LENGTH)) {
+    auto& ps = group->getPieceStorage();
+    auto egm = ps ? ps->getEndGameManager() : nullptr;
+    if (!egm) {
+      writer.put(KEY_WASTED_LENGTH, VLB_ZERO);
+    }
+    else {
+      writer.put(KEY_WASTED_LENGTH, util::itos(egm->getWastedLength()));
+    }
   }
 }
 } // namespace
@@ -785,128 +828,156 @@ void gatherPeer(List* peers, const std::shared_ptr<PeerStorage>& ps)
 #endif // ENABLE_BITTORRENT
 
 namespace {
-void gatherProgress(Dict* entryDict, const std::shared_ptr<RequestGroup>& group,
+void gatherProgress(ValueWriter& writer,
+                    const std::shared_ptr<RequestGroup>& group,
                     DownloadEngine* e, const std::vector<std::string>& keys)
 {
-  gatherProgressCommon(entryDict, group, keys);
+  gatherProgressCommon(writer, group, keys);
 #ifdef ENABLE_BITTORRENT
   if (group->getDownloadContext()->hasAttribute(CTX_ATTR_BT)) {
     gatherProgressBitTorrent(
-        entryDict, group,
-        bittorrent::getTorrentAttrs(group->getDownloadContext()),
+        writer, group, bittorrent::getTorrentAttrs(group->getDownloadContext()),
         e->getBtRegistry()->get(group->getGID()), keys);
   }
 #endif // ENABLE_BITTORRENT
   if (e->getCheckIntegrityMan()) {
-    if (e->getCheckIntegrityMan()->isPicked(
-            [&group](const CheckIntegrityEntry& ent) {
-              return ent.getRequestGroup() == group.get();
-            })) {
-      entryDict->put(
-          KEY_VERIFIED_LENGTH,
-          util::itos(
-              e->getCheckIntegrityMan()->getPickedEntry()->getCurrentLength()));
+    auto entry = e->getCheckIntegrityMan()->findPickedEntry(
+        [&group](const CheckIntegrityEntry& ent) {
+          return ent.getRequestGroup() == group.get();
+        });
+    if (entry) {
+      writer.put(KEY_VERIFIED_LENGTH, util::itos(entry->getCurrentLength()));
     }
     if (e->getCheckIntegrityMan()->isQueued(
             [&group](const CheckIntegrityEntry& ent) {
               return ent.getRequestGroup() == group.get();
             })) {
-      entryDict->put(KEY_VERIFY_PENDING, VLB_TRUE);
+      writer.put(KEY_VERIFY_PENDING, VLB_TRUE);
     }
   }
 }
 } // namespace
 
+void gatherStatus(ValueWriter& writer,
+                  const std::shared_ptr<RequestGroup>& group,
+                  DownloadEngine* e, const std::vector<std::string>& keys)
+{
+  if (requested_key(keys, KEY_STATUS)) {
+    if (group->getState() == RequestGroup::STATE_ACTIVE) {
+      writer.put(KEY_STATUS, VLB_ACTIVE);
+    }
+    else {
+      if (group->isPauseRequested()) {
+        writer.put(KEY_STATUS, VLB_PAUSED);
+      }
+      else {
+        writer.put(KEY_STATUS, VLB_WAITING);
+      }
+    }
+  }
+  gatherProgress(writer, group, e, keys);
+}
+
 void gatherStoppedDownload(Dict* entryDict,
                            const std::shared_ptr<DownloadResult>& ds,
                            const std::vector<std::string>& keys)
+{
+  ValueBaseWriter writer(entryDict);
+  gatherStoppedDownload(writer, ds, keys);
+}
+
+void gatherStoppedDownload(ValueWriter& writer,
+                           const std::shared_ptr<DownloadResult>& ds,
+                           const std::vector<std::string>& keys)
 {
   if (requested_key(keys, KEY_GID)) {
-    entryDict->put(KEY_GID, ds->gid->toHex());
+    writer.put(KEY_GID, ds->gid->toHex());
   }
   if (requested_key(keys, KEY_ERROR_CODE)) {
-    entryDict->put(KEY_ERROR_CODE, util::itos(static_cast<int>(ds->result)));
+    writer.put(KEY_ERROR_CODE, util::itos(static_cast<int>(ds->result)));
   }
   if (requested_key(keys, KEY_ERROR_MESSAGE)) {
-    entryDict->put(KEY_ERROR_MESSAGE, ds->resultMessage);
+    writer.put(KEY_ERROR_MESSAGE, ds->resultMessage);
   }
   if (requested_key(keys, KEY_STATUS)) {
     if (ds->result == error_code::REMOVED) {
-      entryDict->put(KEY_STATUS, VLB_REMOVED);
+      writer.put(KEY_STATUS, VLB_REMOVED);
     }
     else if (ds->result == error_code::FINISHED) {
-      entryDict->put(KEY_STATUS, VLB_COMPLETE);
+      writer.put(KEY_STATUS, VLB_COMPLETE);
     }
     else {
-      entryDict->put(KEY_STATUS, VLB_ERROR);
+      writer.put(KEY_STATUS, VLB_ERROR);
     }
   }
   if (requested_key(keys, KEY_FOLLOWED_BY)) {
     if (!ds->followedBy.empty()) {
-      auto list = List::g();
+      writer.writeKey(KEY_FOLLOWED_BY);
+      writer.beginList();
       // The element is GID.
       for (auto gid : ds->followedBy) {
-        list->append(GroupId::toHex(gid));
+        writer.writeString(GroupId::toHex(gid));
       }
-      entryDict->put(KEY_FOLLOWED_BY, std::move(list));
+      writer.endList();
     }
   }
   if (requested_key(keys, KEY_FOLLOWING)) {
     if (ds->following) {
-      entryDict->put(KEY_FOLLOWING, GroupId::toHex(ds->following));
+      writer.put(KEY_FOLLOWING, GroupId::toHex(ds->following));
     }
   }
   if (requested_key(keys, KEY_BELONGS_TO)) {
     if (ds->belongsTo) {
-      entryDict->put(KEY_BELONGS_TO, GroupId::toHex(ds->belongsTo));
+      writer.put(KEY_BELONGS_TO, GroupId::toHex(ds->belongsTo));
     }
   }
   if (requested_key(keys, KEY_FILES)) {
-    auto files = List::g();
-    createFileEntry(files.get(), std::begin(ds->fileEntries),
+    writer.writeKey(KEY_FILES);
+    writer.beginList();
+    createFileEntry(writer, std::begin(ds->fileEntries),
                     std::end(ds->fileEntries), ds->totalLength, ds->pieceLength,
                     ds->bitfield);
-    entryDict->put(KEY_FILES, std::move(files));
+    writer.endList();
   }
   if (requested_key(keys, KEY_TOTAL_LENGTH)) {
-    entryDict->put(KEY_TOTAL_LENGTH, util::itos(ds->totalLength));
+    writer.put(KEY_TOTAL_LENGTH, util::itos(ds->totalLength));
   }
   if (requested_key(keys, KEY_COMPLETED_LENGTH)) {
-    entryDict->put(KEY_COMPLETED_LENGTH, util::itos(ds->completedLength));
+    writer.put(KEY_COMPLETED_LENGTH, util::itos(ds->completedLength));
   }
   if (requested_key(keys, KEY_UPLOAD_LENGTH)) {
-    entryDict->put(KEY_UPLOAD_LENGTH, util::itos(ds->uploadLength));
+    writer.put(KEY_UPLOAD_LENGTH, util::itos(ds->uploadLength));
   }
   if (requested_key(keys, KEY_BITFIELD)) {
     if (!ds->bitfield.empty()) {
-      entryDict->put(KEY_BITFIELD, util::toHex(ds->bitfield));
+      writer.put(KEY_BITFIELD, util::toHex(ds->bitfield));
     }
   }
   if (requested_key(keys, KEY_DOWNLOAD_SPEED)) {
-    entryDict->put(KEY_DOWNLOAD_SPEED, VLB_ZERO);
+    writer.put(KEY_DOWNLOAD_SPEED, VLB_ZERO);
   }
   if (requested_key(keys, KEY_UPLOAD_SPEED)) {
-    entryDict->put(KEY_UPLOAD_SPEED, VLB_ZERO);
+    writer.put(KEY_UPLOAD_SPEED, VLB_ZERO);
   }
   if (!ds->infoHash.empty()) {
     if (requested_key(keys, KEY_INFO_HASH)) {
-      entryDict->put(KEY_INFO_HASH, util::toHex(ds->infoHash));
+      writer.put(KEY_INFO_HASH, util::toHex(ds->infoHash));
     }
     if (requested_key(keys, KEY_NUM_SEEDERS)) {
-      entryDict->put(KEY_NUM_SEEDERS, VLB_ZERO);
+      writer.put(KEY_NUM_SEEDERS, VLB_ZERO);
     }
   }
   if (requested_key(keys, KEY_PIECE_LENGTH)) {
-    entryDict->put(KEY_PIECE_LENGTH, util::itos(ds->pieceLength));
+    writer.put(KEY_PIECE_LENGTH, util::itos(ds->pieceLength));
   }
   if (requested_key(keys, KEY_NUM_PIECES)) {
-    entryDict->put(KEY_NUM_PIECES, util::uitos(ds->numPieces));
+    writer.put(KEY_NUM_PIECES, util::uitos(ds->numPieces));
   }
   if (requested_key(keys, KEY_CONNECTIONS)) {
-    entryDict->put(KEY_CONNECTIONS, VLB_ZERO);
+    writer.put(KEY_CONNECTIONS, VLB_ZERO);
   }
   if (requested_key(keys, KEY_DIR)) {
-    entryDict->put(KEY_DIR, ds->dir);
+    writer.put(KEY_DIR, ds->dir);
   }
 
 #ifdef ENABLE_BITTORRENT
@@ -914,9 +985,10 @@ void gatherStoppedDownload(Dict* entryDict,
     const auto attrs =
         static_cast<TorrentAttribute*>(ds->attrs[CTX_ATTR_BT].get());
     if (requested_key(keys, KEY_BITTORRENT)) {
-      auto btDict = Dict::g();
-      gatherBitTorrentMetadata(btDict.get(), attrs);
-      entryDict->put(KEY_BITTORRENT, std::move(btDict));
+      writer.writeKey(KEY_BITTORRENT);
+      writer.beginDict();
+      gatherBitTorrentMetadata(writer, attrs);
+      writer.endDict();
     }
   }
 #endif // ENABLE_BITTORRENT
@@ -929,6 +1001,7 @@ std::unique_ptr<ValueBase> GetFilesRpcMethod::process(const RpcRequest& req,
 
   a2_gid_t gid = str2Gid(gidParam);
   auto files = List::g();
+  ValueBaseWriter writer(files.get());
   auto group = e->getRequestGroupMan()->findGroup(gid);
   if (!group) {
     auto dr = e->getRequestGroupMan()->findDownloadResult(gid);
@@ -937,14 +1010,14 @@ std::unique_ptr<ValueBase> GetFilesRpcMethod::process(const RpcRequest& req,
                             GroupId::toHex(gid).c_str()));
     }
     else {
-      createFileEntry(files.get(), std::begin(dr->fileEntries),
+      createFileEntry(writer, std::begin(dr->fileEntries),
                       std::end(dr->fileEntries), dr->totalLength,
                       dr->pieceLength, dr->bitfield);
     }
   }
   else {
     auto& dctx = group->getDownloadContext();
-    createFileEntry(files.get(),
+    createFileEntry(writer,
                     std::begin(group->getDownloadContext()->getFileEntries()),
                     std::end(group->getDownloadContext()->getFileEntries()),
                     dctx->getTotalLength(), dctx->getPieceLength(),
@@ -967,8 +1040,8 @@ std::unique_ptr<ValueBase> GetUrisRpcMethod::process(const RpcRequest& req,
   auto uriList = List::g();
   // TODO Current implementation just returns first FileEntry's URIs.
   if (!group->getDownloadContext()->getFileEntries().empty()) {
-    createUriEntry(uriList.get(),
-                   group->getDownloadContext()->getFirstFileEntry());
+    ValueBaseWriter writer(uriList.get());
+    createUriEntry(writer, group->getDownloadContext()->getFirstFileEntry());
   }
   return std::move(uriList);
 }
@@ -995,8 +1068,8 @@ std::unique_ptr<ValueBase> GetPeersRpcMethod::process(const RpcRequest& req,
 }
 #endif // ENABLE_BITTORRENT
 
-std::unique_ptr<ValueBase> TellStatusRpcMethod::process(const RpcRequest& req,
-                                                        DownloadEngine* e)
+void TellStatusRpcMethod::writeResult(const RpcRequest& req, DownloadEngine* e,
+                                      ValueWriter& writer)
 {
   const String* gidParam = checkRequiredParam<String>(req, 0);
   const List* keysParam = checkParam<List>(req, 1);
@@ -1006,51 +1079,40 @@ std::unique_ptr<ValueBase> TellStatusRpcMethod::process(const RpcRequest& req,
   toStringList(std::back_inserter(keys), keysParam);
 
   auto group = e->getRequestGroupMan()->findGroup(gid);
-  auto entryDict = Dict::g();
   if (!group) {
     auto ds = e->getRequestGroupMan()->findDownloadResult(gid);
     if (!ds) {
       throw DL_ABORT_EX(
           fmt("No such download for GID#%s", GroupId::toHex(gid).c_str()));
     }
-    gatherStoppedDownload(entryDict.get(), ds, keys);
+    writer.beginDict();
+    gatherStoppedDownload(writer, ds, keys);
+    writer.endDict();
   }
   else {
-    if (requested_key(keys, KEY_STATUS)) {
-      if (group->getState() == RequestGroup::STATE_ACTIVE) {
-        entryDict->put(KEY_STATUS, VLB_ACTIVE);
-      }
-      else {
-        if (group->isPauseRequested()) {
-          entryDict->put(KEY_STATUS, VLB_PAUSED);
-        }
-        else {
-          entryDict->put(KEY_STATUS, VLB_WAITING);
-        }
-      }
-    }
-    gatherProgress(entryDict.get(), group, e, keys);
+    writer.beginDict();
+    gatherStatus(writer, group, e, keys);
+    writer.endDict();
   }
-  return std::move(entryDict);
 }
 
-std::unique_ptr<ValueBase> TellActiveRpcMethod::process(const RpcRequest& req,
-                                                        DownloadEngine* e)
+void TellActiveRpcMethod::writeResult(const RpcRequest& req, DownloadEngine* e,
+                                      ValueWriter& writer)
 {
   const List* keysParam = checkParam<List>(req, 0);
   std::vector<std::string> keys;
   toStringList(std::back_inserter(keys), keysParam);
-  auto list = List::g();
   bool statusReq = requested_key(keys, KEY_STATUS);
+  writer.beginList();
   for (auto& group : e->getRequestGroupMan()->getRequestGroups()) {
-    auto entryDict = Dict::g();
+    writer.beginDict();
     if (statusReq) {
-      entryDict->put(KEY_STATUS, VLB_ACTIVE);
+      writer.put(KEY_STATUS, VLB_ACTIVE);
     }
-    gatherProgress(entryDict.get(), group, e, keys);
-    list->append(std::move(entryDict));
+    gatherProgress(writer, group, e, keys);
+    writer.endDict();
   }
-  return std::move(list);
+  writer.endList();
 }
 
 const RequestGroupList& TellWaitingRpcMethod::getItems(DownloadEngine* e) const
@@ -1059,18 +1121,18 @@ const RequestGroupList& TellWaitingRpcMethod::getItems(DownloadEngine* e) const
 }
 
 void TellWaitingRpcMethod::createEntry(
-    Dict* entryDict, const std::shared_ptr<RequestGroup>& item,
+    ValueWriter& writer, const std::shared_ptr<RequestGroup>& item,
     DownloadEngine* e, const std::vector<std::string>& keys) const
 {
   if (requested_key(keys, KEY_STATUS)) {
     if (item->isPauseRequested()) {
-      entryDict->put(KEY_STATUS, VLB_PAUSED);
+      writer.put(KEY_STATUS, VLB_PAUSED);
     }
     else {
-      entryDict->put(KEY_STATUS, VLB_WAITING);
+      writer.put(KEY_STATUS, VLB_WAITING);
     }
   }
-  gatherProgress(entryDict, item, e, keys);
+  gatherProgress(writer, item, e, keys);
 }
 
 const DownloadResultList&
@@ -1080,10 +1142,10 @@ TellStoppedRpcMethod::getItems(DownloadEngine* e) const
 }
 
 void TellStoppedRpcMethod::createEntry(
-    Dict* entryDict, const std::shared_ptr<DownloadResult>& item,
+    ValueWriter& writer, const std::shared_ptr<DownloadResult>& item,
     DownloadEngine* e, const std::vector<std::string>& keys) const
 {
-  gatherStoppedDownload(entryDict, item, keys);
+  gatherStoppedDownload(writer, item, keys);
 }
 
 std::unique_ptr<ValueBase>
@@ -1341,6 +1403,9 @@ std::unique_ptr<ValueBase> ChangeUriRpcMethod::process(const RpcRequest& req,
       }
     }
   }
+  if (delcount || addcount) {
+    group->updateStateSerial();
+  }
   if (addcount && group->getPieceStorage()) {
     std::vector<std::unique_ptr<Command>> commands;
     group->createNextCommand(commands, e);
@@ -1390,6 +1455,10 @@ GetGlobalStatRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
   res->put(KEY_NUM_STOPPED, util::uitos(rgman->getDownloadResults().size()));
   res->put(KEY_NUM_STOPPED_TOTAL, util::uitos(rgman->getNumStoppedTotal()));
   res->put(KEY_NUM_ACTIVE, util::uitos(rgman->getRequestGroups().size()));
+  auto& socketPool = e->getSocketPool();
+  res->put(KEY_NUM_CONNECTION_POOL_HIT, util::uitos(socketPool->getNumHit()));
+  res->put(KEY_NUM_CONNECTION_POOL_MISS,
+           util::uitos(socketPool->getNumMiss()));
   return std::move(res);
 }
 
@@ -1410,6 +1479,50 @@ std::unique_ptr<ValueBase> SaveSessionRpcMethod::process(const RpcRequest& req,
       fmt("Failed to serialize session to '%s'.", filename.c_str()));
 }
 
+namespace {
+void checkWebSocketSession(const RpcRequest& req)
+{
+  if (!req.wsSession) {
+    throw DL_ABORT_EX(fmt("%s is only available over WebSocket.",
+                          req.methodName.c_str()));
+  }
+}
+} // namespace
+
+std::unique_ptr<ValueBase> SubscribeRpcMethod::process(const RpcRequest& req,
+                                                       DownloadEngine* e)
+{
+  const List* keysParam = checkParam<List>(req, 0);
+  const Integer* intervalParam = checkParam<Integer>(req, 1);
+  checkWebSocketSession(req);
+  auto interval = 1_s;
+  if (intervalParam) {
+    if (intervalParam->i() < 1) {
+      throw DL_ABORT_EX("Interval must be greater than or equal to 1.");
+    }
+    interval = std::chrono::seconds(intervalParam->i());
+  }
+  std::vector<std::string> keys;
+  toStringList(std::back_inserter(keys), keysParam);
+#ifdef ENABLE_WEBSOCKET
+  req.wsSession->subscribe(make_unique<StatusSubscription>(std::move(keys)),
+                           interval);
+#endif // ENABLE_WEBSOCKET
+  return createOKResponse();
+}
+
+std::unique_ptr<ValueBase> UnsubscribeRpcMethod::process(const RpcRequest& req,
+                                                         DownloadEngine* e)
+{
+  checkWebSocketSession(req);
+#ifdef ENABLE_WEBSOCKET
+  if (!req.wsSession->unsubscribe()) {
+    throw DL_ABORT_EX("No subscription.");
+  }
+#endif // ENABLE_WEBSOCKET
+  return createOKResponse();
+}
+
 std::unique_ptr<ValueBase>
 SystemMulticallRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
 {
@@ -1418,29 +1531,54 @@ SystemMulticallRpcMethod::process(const RpcRequest& req, DownloadEngine* e)
   return nullptr;
 }
 
+namespace {
+void writeParam(ValueWriter& writer, const RpcResponse& res)
+{
+  if (res.param) {
+    writer.writeValue(res.param.get());
+  }
+  else {
+    writer.writeEncoded(res.encodedParam);
+  }
+}
+} // namespace
+
 RpcResponse SystemMulticallRpcMethod::execute(RpcRequest req, DownloadEngine* e)
 {
   auto authorized = RpcResponse::AUTHORIZED;
   try {
     const List* methodSpecs = checkRequiredParam<List>(req, 0);
-    auto list = List::g();
+    std::string out;
+    std::unique_ptr<ValueWriter> writer;
+    if (req.directEncoding) {
+      writer = createParamWriter(req.jsonRpc, out);
+    }
+    else {
+      writer = make_unique<ValueBaseWriter>();
+    }
+    writer->beginList();
     for (auto& methodSpec : *methodSpecs) {
       Dict* methodDict = downcast<Dict>(methodSpec);
       if (!methodDict) {
-        list->append(createErrorResponse(
-            DL_ABORT_EX("system.multicall expected struct."), req));
+        writer->writeValue(
+            createErrorResponse(
+                DL_ABORT_EX("system.multicall expected struct."), req)
+                .get());
         continue;
       }
       const String* methodName =
           downcast<String>(methodDict->get(KEY_METHOD_NAME));
       if (!methodName) {
-        list->append(
-            createErrorResponse(DL_ABORT_EX("Missing methodName."), req));
+        writer->writeValue(
+            createErrorResponse(DL_ABORT_EX("Missing methodName."), req)
+                .get());
         continue;
       }
       if (methodName->s() == getMethodName()) {
-        list->append(createErrorResponse(
-            DL_ABORT_EX("Recursive system.multicall forbidden."), req));
+        writer->writeValue(
+            createErrorResponse(
+                DL_ABORT_EX("Recursive system.multicall forbidden."), req)
+                .get());
         continue;
       }
       // TODO what if params missing?
@@ -1455,20 +1593,29 @@ RpcResponse SystemMulticallRpcMethod::execute(RpcRequest req, DownloadEngine* e)
       }
       RpcRequest r = {methodName->s(), std::move(paramsList), nullptr,
                       req.jsonRpc};
+      // Each result is encoded before the next method is executed.
+      r.directEncoding = req.directEncoding;
+      r.wsSession = req.wsSession;
       RpcResponse res = getMethod(methodName->s())->execute(std::move(r), e);
       if (rpc::not_authorized(res)) {
         authorized = RpcResponse::NOTAUTHORIZED;
       }
       if (res.code == 0) {
-        auto l = List::g();
-        l->append(std::move(res.param));
-        list->append(std::move(l));
+        writer->beginList();
+        writeParam(*writer, res);
+        writer->endList();
       }
       else {
-        list->append(std::move(res.param));
+        writeParam(*writer, res);
       }
     }
-    return RpcResponse(0, authorized, std::move(list), std::move(req.id));
+    writer->endList();
+    if (req.directEncoding) {
+      return RpcResponse(0, authorized, std::move(out), std::move(req.id));
+    }
+    return RpcResponse(0, authorized,
+                       static_cast<ValueBaseWriter*>(writer.get())->getResult(),
+                       std::move(req.id));
   }
   catch (RecoverableException& ex) {
     A2_LOG_DEBUG_EX(EX_EXCEPTION_CAUGHT, ex);
@@ -1555,6 +1702,7 @@ void changeOption(const std::shared_ptr<RequestGroup>& group,
   const std::shared_ptr<DownloadContext>& dctx = group->getDownloadContext();
   const std::shared_ptr<Option>& grOption = group->getOption();
   grOption->merge(option);
+  group->updateStateSerial();
   if (option.defined(PREF_CHECKSUM)) {
     const std::string& checksum = grOption->get(PREF_CHECKSUM);
     auto p = util::divide(std::begin(checksum), std::end(checksum), '=');
@@ -1672,6 +1820,9 @@ void changeGlobalOption(const Option& option, DownloadEngine* e)
   if (option.defined(PREF_LOG_LEVEL)) {
     LogFactory::setLogLevel(option.get(PREF_LOG_LEVEL));
   }
+  if (option.defined(PREF_SUBSYSTEM_LOG_LEVEL)) {
+    LogFactory::setSubsystemLogLevels(option.get(PREF_SUBSYSTEM_LOG_LEVEL));
+  }
   if (option.defined(PREF_LOG)) {
     LogFactory::setLogFile(option.get(PREF_LOG));
     try {
@@ -43,6 +43,7 @@
 
 #include "RpcRequest.h"
 #include "ValueBase.h"
+#include "ValueWriter.h"
 #include "TorrentAttribute.h"
 #include "DlAbortEx.h"
 #include "fmt.h"
@@ -286,25 +287,26 @@ public:
   static const char* getMethodName() { return "aria2.getServers"; }
 };
 
-class TellStatusRpcMethod : public RpcMethod {
+class TellStatusRpcMethod : public StreamingRpcMethod {
 protected:
-  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
-                                             DownloadEngine* e) CXX11_OVERRIDE;
+  virtual void writeResult(const RpcRequest& req, DownloadEngine* e,
+                           ValueWriter& writer) CXX11_OVERRIDE;
 
 public:
   static const char* getMethodName() { return "aria2.tellStatus"; }
 };
 
-class TellActiveRpcMethod : public RpcMethod {
+class TellActiveRpcMethod : public StreamingRpcMethod {
 protected:
-  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
-                                             DownloadEngine* e) CXX11_OVERRIDE;
+  virtual void writeResult(const RpcRequest& req, DownloadEngine* e,
+                           ValueWriter& writer) CXX11_OVERRIDE;
 
 public:
   static const char* getMethodName() { return "aria2.tellActive"; }
 };
 
-template <typename T> class AbstractPaginationRpcMethod : public RpcMethod {
+template <typename T>
+class AbstractPaginationRpcMethod : public StreamingRpcMethod {
 private:
   template <typename InputIterator>
   std::pair<InputIterator, InputIterator>
@@ -346,8 +348,8 @@ private:
 protected:
   typedef IndexedList<a2_gid_t, std::shared_ptr<T>> ItemListType;
 
-  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
-                                             DownloadEngine* e) CXX11_OVERRIDE
+  virtual void writeResult(const RpcRequest& req, DownloadEngine* e,
+                           ValueWriter& writer) CXX11_OVERRIDE
   {
     const Integer* offsetParam = checkRequiredParam<Integer>(req, 0);
     const Integer* numParam = checkRequiredInteger(req, 1, IntegerGE(0));
@@ -360,21 +362,31 @@ protected:
     const ItemListType& items = getItems(e);
     auto range =
         getPaginationRange(offset, num, std::begin(items), std::end(items));
-    auto list = List::g();
-    for (; range.first != range.second; ++range.first) {
-      auto entryDict = Dict::g();
-      createEntry(entryDict.get(), *range.first, e, keys);
-      list->append(std::move(entryDict));
-    }
+    writer.beginList();
     if (offset < 0) {
-      std::reverse(list->begin(), list->end());
+      // Counting from the end of the list, items are listed in the
+      // reverse order.
+      while (range.first != range.second) {
+        --range.second;
+        writer.beginDict();
+        createEntry(writer, *range.second, e, keys);
+        writer.endDict();
+      }
     }
-    return std::move(list);
+    else {
+      for (; range.first != range.second; ++range.first) {
+        writer.beginDict();
+        createEntry(writer, *range.first, e, keys);
+        writer.endDict();
+      }
+    }
+    writer.endList();
   }
 
   virtual const ItemListType& getItems(DownloadEngine* e) const = 0;
 
-  virtual void createEntry(Dict* entryDict, const std::shared_ptr<T>& item,
+  // Writes the members of the entry for item.
+  virtual void createEntry(ValueWriter& writer, const std::shared_ptr<T>& item,
                            DownloadEngine* e,
                            const std::vector<std::string>& keys) const = 0;
 };
@@ -385,7 +397,7 @@ protected:
   getItems(DownloadEngine* e) const CXX11_OVERRIDE;
 
   virtual void
-  createEntry(Dict* entryDict, const std::shared_ptr<RequestGroup>& item,
+  createEntry(ValueWriter& writer, const std::shared_ptr<RequestGroup>& item,
               DownloadEngine* e,
               const std::vector<std::string>& keys) const CXX11_OVERRIDE;
 
@@ -400,7 +412,7 @@ protected:
   getItems(DownloadEngine* e) const CXX11_OVERRIDE;
 
   virtual void
-  createEntry(Dict* entryDict, const std::shared_ptr<DownloadResult>& item,
+  createEntry(ValueWriter& writer, const std::shared_ptr<DownloadResult>& item,
               DownloadEngine* e,
               const std::vector<std::string>& keys) const CXX11_OVERRIDE;
 
@@ -516,6 +528,26 @@ public:
   static const char* getMethodName() { return "aria2.saveSession"; }
 };
 
+// Starts pushing aria2.onDownloadChange notification to the
+// WebSocket session the request is received from.
+class SubscribeRpcMethod : public RpcMethod {
+protected:
+  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
+                                             DownloadEngine* e) CXX11_OVERRIDE;
+
+public:
+  static const char* getMethodName() { return "aria2.subscribe"; }
+};
+
+class UnsubscribeRpcMethod : public RpcMethod {
+protected:
+  virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
+                                             DownloadEngine* e) CXX11_OVERRIDE;
+
+public:
+  static const char* getMethodName() { return "aria2.unsubscribe"; }
+};
+
 class SystemMulticallRpcMethod : public RpcMethod {
 protected:
   virtual std::unique_ptr<ValueBase> process(const RpcRequest& req,
@@ -555,21 +587,42 @@ protected:
                                              DownloadEngine* e) CXX11_OVERRIDE;
 };
 
+// Helper function to write the status and progress of group, which
+// is in the active or waiting queue. This function is used by
+// tellStatus method.
+void gatherStatus(ValueWriter& writer,
+                  const std::shared_ptr<RequestGroup>& group,
+                  DownloadEngine* e, const std::vector<std::string>& keys);
+
 // Helper function to store data to entryDict from ds. This function
 // is used by tellStatus method.
 void gatherStoppedDownload(Dict* entryDict,
                            const std::shared_ptr<DownloadResult>& ds,
                            const std::vector<std::string>& keys);
 
+// Same as above, but writes the members using writer.
+void gatherStoppedDownload(ValueWriter& writer,
+                           const std::shared_ptr<DownloadResult>& ds,
+                           const std::vector<std::string>& keys);
+
 // Helper function to store data to entryDict from group. This
 // function is used by tellStatus/tellActive/tellWaiting method
 void gatherProgressCommon(Dict* entryDict,
                           const std::shared_ptr<RequestGroup>& group,
                           const std::vector<std::string>& keys);
 
+// Same as above, but writes the members using writer.
+void gatherProgressCommon(ValueWriter& writer,
+                          const std::shared_ptr<RequestGroup>& group,
+                          const std::vector<std::string>& keys);
+
 #ifdef ENABLE_BITTORRENT
 // Helper function to store BitTorrent metadata from torrentAttrs.
 void gatherBitTorrentMetadata(Dict* btDict, TorrentAttribute* torrentAttrs);
+
+// Same as above, but writes the members using writer.
+void gatherBitTorrentMetadata(ValueWriter& writer,
+                              TorrentAttribute* torrentAttrs);
 #endif // ENABLE_BITTORRENT
 
 } // namespace rpc
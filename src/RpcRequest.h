@@ -38,6 +38,7 @@
 #include "common.h"
 
 #include <string>
+#include <memory>
 
 #include "ValueBase.h"
 
@@ -45,11 +46,21 @@ namespace aria2 {
 
 namespace rpc {
 
+class WebSocketSession;
+
 struct RpcRequest {
   std::string methodName;
   std::unique_ptr<List> params;
   std::unique_ptr<ValueBase> id;
   bool jsonRpc;
+  // If true, the result is encoded in the format of the request
+  // while it is produced, and is stored in
+  // RpcResponse::encodedParam instead of RpcResponse::param.  Set
+  // this when the response is only going to be sent to the client.
+  bool directEncoding;
+  // The WebSocket session which the request is received from, or
+  // nullptr if the request is not received over WebSocket.
+  std::shared_ptr<WebSocketSession> wsSession;
 
   RpcRequest();
 
@@ -102,20 +102,33 @@ void encodeValue(const ValueBase* value, OutputStream& o)
 
 namespace {
 template <typename OutputStream>
-std::string encodeAll(OutputStream& o, int code, const ValueBase* param)
+void encodeParam(const RpcResponse& res, OutputStream& o)
+{
+  if (res.param) {
+    encodeValue(res.param.get(), o);
+  }
+  else {
+    o << res.encodedParam;
+  }
+}
+} // namespace
+
+namespace {
+template <typename OutputStream>
+std::string encodeAll(OutputStream& o, const RpcResponse& res)
 {
   o << "<?xml version=\"1.0\"?>"
     << "<methodResponse>";
-  if (code == 0) {
+  if (res.code == 0) {
     o << "<params>"
       << "<param>";
-    encodeValue(param, o);
+    encodeParam(res, o);
     o << "</param>"
       << "</params>";
   }
   else {
     o << "<fault>";
-    encodeValue(param, o);
+    encodeParam(res, o);
     o << "</fault>";
   }
   o << "</methodResponse>";
@@ -133,42 +146,147 @@ RpcResponse::RpcResponse(int code, RpcResponse::authorization_t authorized,
 {
 }
 
+RpcResponse::RpcResponse(int code, RpcResponse::authorization_t authorized,
+                         std::string encodedParam,
+                         std::unique_ptr<ValueBase> id)
+    : encodedParam{std::move(encodedParam)},
+      id{std::move(id)},
+      code{code},
+      authorized{authorized}
+{
+}
+
+namespace {
+// ValueWriter which encodes the value in XML-RPC in the same way as
+// encodeValue().
+class XmlRpcWriter : public ValueWriter {
+public:
+  XmlRpcWriter(std::string& out) : out_(out) {}
+
+  virtual void beginDict() CXX11_OVERRIDE
+  {
+    out_ += "<value><struct>";
+    dict_.push_back(true);
+  }
+
+  virtual void endDict() CXX11_OVERRIDE
+  {
+    dict_.pop_back();
+    out_ += "</struct></value>";
+    endValue();
+  }
+
+  virtual void beginList() CXX11_OVERRIDE
+  {
+    out_ += "<value><array><data>";
+    dict_.push_back(false);
+  }
+
+  virtual void endList() CXX11_OVERRIDE
+  {
+    dict_.pop_back();
+    out_ += "</data></array></value>";
+    endValue();
+  }
+
+  virtual void writeKey(const std::string& key) CXX11_OVERRIDE
+  {
+    out_ += "<member><name>";
+    out_ += util::htmlEscape(key);
+    out_ += "</name>";
+  }
+
+  virtual void writeString(const std::string& s) CXX11_OVERRIDE
+  {
+    out_ += "<value><string>";
+    out_ += util::htmlEscape(s);
+    out_ += "</string></value>";
+    endValue();
+  }
+
+  virtual void writeInteger(int64_t i) CXX11_OVERRIDE
+  {
+    out_ += "<value><int>";
+    out_ += util::itos(i);
+    out_ += "</int></value>";
+    endValue();
+  }
+
+  // XML-RPC has no representation of these.
+  virtual void writeBool(bool b) CXX11_OVERRIDE { endValue(); }
+
+  virtual void writeNull() CXX11_OVERRIDE { endValue(); }
+
+  virtual void writeEncoded(const std::string& data) CXX11_OVERRIDE
+  {
+    out_ += data;
+    endValue();
+  }
+
+private:
+  void endValue()
+  {
+    if (!dict_.empty() && dict_.back()) {
+      out_ += "</member>";
+    }
+  }
+
+  std::string& out_;
+  // For each open container, true if it is struct.
+  std::vector<bool> dict_;
+};
+} // namespace
+
+std::unique_ptr<ValueWriter> createParamWriter(bool jsonRpc, std::string& out)
+{
+  if (jsonRpc) {
+    return make_unique<json::JsonWriter>(out);
+  }
+  else {
+    return make_unique<XmlRpcWriter>(out);
+  }
+}
+
 std::string toXml(const RpcResponse& res, bool gzip)
 {
   if (gzip) {
 #ifdef HAVE_ZLIB
     GZipEncoder o;
     o.init();
-    return encodeAll(o, res.code, res.param.get());
+    return encodeAll(o, res);
 #else  // !HAVE_ZLIB
     abort();
 #endif // !HAVE_ZLIB
   }
   else {
     std::stringstream o;
-    return encodeAll(o, res.code, res.param.get());
+    return encodeAll(o, res);
   }
 }
 
 namespace {
 template <typename OutputStream>
-OutputStream& encodeJsonAll(OutputStream& o, int code, const ValueBase* param,
-                            const ValueBase* id,
+OutputStream& encodeJsonAll(OutputStream& o, const RpcResponse& res,
                             const std::string& callback = A2STR::NIL)
 {
   if (!callback.empty()) {
     o << callback << "(";
   }
   o << "{\"id\":";
-  json::encode(o, id);
+  json::encode(o, res.id.get());
   o << ",\"jsonrpc\":\"2.0\",";
-  if (code == 0) {
+  if (res.code == 0) {
     o << "\"result\":";
   }
   else {
     o << "\"error\":";
   }
-  json::encode(o, param);
+  if (res.param) {
+    json::encode(o, res.param.get());
+  }
+  else {
+    o << res.encodedParam;
+  }
   o << "}";
   if (!callback.empty()) {
     o << ")";
@@ -184,16 +302,14 @@ std::string toJson(const RpcResponse& res, const std::string& callback,
 #ifdef HAVE_ZLIB
     GZipEncoder o;
     o.init();
-    return encodeJsonAll(o, res.code, res.param.get(), res.id.get(), callback)
-        .str();
+    return encodeJsonAll(o, res, callback).str();
 #else  // !HAVE_ZLIB
     abort();
 #endif // !HAVE_ZLIB
   }
   else {
     std::stringstream o;
-    return encodeJsonAll(o, res.code, res.param.get(), res.id.get(), callback)
-        .str();
+    return encodeJsonAll(o, res, callback).str();
   }
 }
 
@@ -208,13 +324,12 @@ OutputStream& encodeJsonBatchAll(OutputStream& o,
   }
   o << "[";
   if (!results.empty()) {
-    encodeJsonAll(o, results[0].code, results[0].param.get(),
-                  results[0].id.get());
+    encodeJsonAll(o, results[0]);
 
     for (auto i = std::begin(results) + 1, eoi = std::end(results); i != eoi;
          ++i) {
       o << ",";
-      encodeJsonAll(o, (*i).code, (*i).param.get(), (*i).id.get());
+      encodeJsonAll(o, *i);
     }
   }
   o << "]";
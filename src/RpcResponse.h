@@ -41,6 +41,7 @@
 #include <vector>
 
 #include "ValueBase.h"
+#include "ValueWriter.h"
 
 namespace aria2 {
 
@@ -51,12 +52,18 @@ struct RpcResponse {
 
   // 0 for success, non-zero for error
   std::unique_ptr<ValueBase> param;
+  // If param is null, the result already encoded in the format of
+  // the request.  See RpcRequest::directEncoding.
+  std::string encodedParam;
   std::unique_ptr<ValueBase> id;
   int code;
   authorization_t authorized;
 
   RpcResponse(int code, authorization_t authorized,
               std::unique_ptr<ValueBase> param, std::unique_ptr<ValueBase> id);
+
+  RpcResponse(int code, authorization_t authorized, std::string encodedParam,
+              std::unique_ptr<ValueBase> id);
 };
 
 inline bool not_authorized(const rpc::RpcResponse& res)
@@ -70,6 +77,10 @@ bool any_not_authorized(const InputIterator begin, const InputIterator end)
   return std::any_of(begin, end, not_authorized);
 }
 
+// Returns ValueWriter which appends the value to out in JSON if
+// jsonRpc is true, or in XML-RPC otherwise.
+std::unique_ptr<ValueWriter> createParamWriter(bool jsonRpc, std::string& out);
+
 std::string toXml(const RpcResponse& response, bool gzip = false);
 
 // Encodes RPC response in JSON. If callback is not empty, the
@@ -78,6 +78,8 @@ bool SeedCheckCommand::execute()
     if (seedCriteria_->evaluate()) {
       A2_LOG_NOTICE(MSG_SEEDING_END);
       btRuntime_->setHalt(true);
+      // Wake up sleeping commands of this download.
+      e_->setRefreshInterval(std::chrono::milliseconds(0));
     }
   }
   e_->addCommand(std::unique_ptr<Command>(this));
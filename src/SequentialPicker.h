@@ -46,23 +46,65 @@ namespace aria2 {
 template <typename T> class SequentialPicker {
 private:
   std::deque<std::unique_ptr<T>> entries_;
-  std::unique_ptr<T> pickedEntry_;
+  // Entries being processed, in the order they were picked.
+  std::deque<std::unique_ptr<T>> pickedEntries_;
+  // The maximum number of entries which can be picked at the same
+  // time.
+  size_t maxPicked_;
 
 public:
-  bool isPicked() const { return pickedEntry_.get(); }
+  explicit SequentialPicker(size_t maxPicked = 1) : maxPicked_(maxPicked) {}
 
-  const std::unique_ptr<T>& getPickedEntry() const { return pickedEntry_; }
+  bool isPicked() const { return !pickedEntries_.empty(); }
 
-  void dropPickedEntry() { pickedEntry_.reset(); }
+  // Returns true if there is a queued entry and the number of picked
+  // entries is less than the limit.
+  bool canPickNext() const
+  {
+    return hasNext() && pickedEntries_.size() < maxPicked_;
+  }
+
+  // Returns the entry picked first among the entries being
+  // processed, or nullptr if nothing is picked.
+  T* getPickedEntry() const
+  {
+    return pickedEntries_.empty() ? nullptr : pickedEntries_.front().get();
+  }
+
+  const std::deque<std::unique_ptr<T>>& getPickedEntries() const
+  {
+    return pickedEntries_;
+  }
+
+  size_t countPickedEntry() const { return pickedEntries_.size(); }
+
+  // Drops the entry picked first.
+  void dropPickedEntry()
+  {
+    if (!pickedEntries_.empty()) {
+      pickedEntries_.pop_front();
+    }
+  }
+
+  void dropPickedEntry(const T* entry)
+  {
+    for (auto i = std::begin(pickedEntries_); i != std::end(pickedEntries_);
+         ++i) {
+      if ((*i).get() == entry) {
+        pickedEntries_.erase(i);
+        return;
+      }
+    }
+  }
 
   bool hasNext() const { return !entries_.empty(); }
 
   T* pickNext()
   {
     if (hasNext()) {
-      pickedEntry_ = std::move(entries_.front());
+      pickedEntries_.push_back(std::move(entries_.front()));
       entries_.pop_front();
-      return pickedEntry_.get();
+      return pickedEntries_.back().get();
     }
     return nullptr;
   }
@@ -74,9 +116,15 @@ public:
 
   size_t countEntryInQueue() const { return entries_.size(); }
 
-  bool isPicked(const std::function<bool(const T&)>& pred) const
+  // Returns the picked entry which satisfies pred, or nullptr.
+  T* findPickedEntry(const std::function<bool(const T&)>& pred) const
   {
-    return pickedEntry_ && pred(*pickedEntry_);
+    for (auto& e : pickedEntries_) {
+      if (pred(*e)) {
+        return e.get();
+      }
+    }
+    return nullptr;
   }
 
   bool isQueued(const std::function<bool(const T&)>& pred) const
@@ -82,6 +82,21 @@ bool ServerStatMan::add(const std::shared_ptr<ServerStat>& serverStat)
   }
 }
 
+void ServerStatMan::merge(const ServerStatMan& other)
+{
+  for (auto& ss : other.serverStats_) {
+    auto i = serverStats_.lower_bound(ss);
+    if (i != serverStats_.end() && *(*i) == *ss) {
+      if ((*i)->getLastUpdated() < ss->getLastUpdated()) {
+        serverStats_.insert(serverStats_.erase(i), ss);
+      }
+    }
+    else {
+      serverStats_.insert(i, ss);
+    }
+  }
+}
+
 bool ServerStatMan::save(const std::string& filename) const
 {
   std::string tempfile = filename;
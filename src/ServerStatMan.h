@@ -58,6 +58,10 @@ public:
 
   bool add(const std::shared_ptr<ServerStat>& serverStat);
 
+  // Adds the stats in |other|.  If both have a stat of the same
+  // server, the one updated later is kept.
+  void merge(const ServerStatMan& other);
+
   bool load(const std::string& filename);
 
   bool save(const std::string& filename) const;
@@ -56,6 +56,14 @@ void SimpleBtMessage::send()
   A2_LOG_INFO(fmt(MSG_SEND_PEER_MESSAGE, getCuid(),
                   getPeer()->getIPAddress().c_str(), getPeer()->getPort(),
                   toString().c_str()));
+  unsigned char buf[MAX_FIXED_MESSAGE_LENGTH];
+  auto length = writeMessage(buf);
+  if (length > 0) {
+    A2_LOG_DEBUG(
+        fmt("msglength = %lu bytes", static_cast<unsigned long>(length)));
+    getPeerConnection()->pushBytes(buf, length, getProgressUpdate());
+    return;
+  }
   auto msg = createMessage();
   A2_LOG_DEBUG(
       fmt("msglength = %lu bytes", static_cast<unsigned long>(msg.size())));
@@ -47,10 +47,20 @@ class SimpleBtMessage : public AbstractBtMessage {
 public:
   SimpleBtMessage(uint8_t id, const char* name);
 
+  // The maximum length of the message written by writeMessage().
+  static const size_t MAX_FIXED_MESSAGE_LENGTH = 17;
+
   virtual void send() CXX11_OVERRIDE;
 
   virtual std::vector<unsigned char> createMessage() = 0;
 
+  // Writes the message to |buf|, which has at least
+  // MAX_FIXED_MESSAGE_LENGTH bytes, and returns its length.  send()
+  // uses this to pass the small fixed length message to the send
+  // buffer without allocating a vector.  The default implementation
+  // returns 0, which means that createMessage() must be used.
+  virtual size_t writeMessage(unsigned char* buf) { return 0; }
+
   virtual std::unique_ptr<ProgressUpdate> getProgressUpdate();
 
   virtual bool sendPredicate() const { return true; };
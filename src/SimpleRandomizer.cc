@@ -39,6 +39,9 @@
 #include <cstdlib>
 #include <cassert>
 #include <cstring>
+#ifdef ENABLE_THREADS
+#include <mutex>
+#endif // ENABLE_THREADS
 
 #include "a2time.h"
 #include "a2functional.h"
@@ -65,6 +68,10 @@ const std::unique_ptr<SimpleRandomizer>& SimpleRandomizer::getInstance()
 
 namespace {
 std::random_device rd;
+#ifdef ENABLE_THREADS
+// Guards gen_, which the engine shards share.
+std::mutex genMutex;
+#endif // ENABLE_THREADS
 } // namespace
 
 #ifdef __MINGW32__
@@ -112,6 +119,9 @@ void SimpleRandomizer::getRandomBytes(unsigned char* buf, size_t len)
   }
 // Fall through to generic implementation
 #endif // defined(HAVE_GETRANDOM_INTERFACE)
+#ifdef ENABLE_THREADS
+  std::lock_guard<std::mutex> lock(genMutex);
+#endif // ENABLE_THREADS
   auto ubuf = reinterpret_cast<result_type*>(buf);
   size_t q = len / sizeof(result_type);
   auto dis = std::uniform_int_distribution<result_type>();
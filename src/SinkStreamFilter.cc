@@ -72,14 +72,14 @@ ssize_t SinkStreamFilter::transform(const std::shared_ptr<BinaryStream>& out,
       assert(wrDiskCache_);
       // If we receive small data (e.g., 1 or 2 bytes), cache entry
       // becomes a headache. To mitigate this problem, we allocate
-      // cache buffer at least 4KiB and append the data to the
-      // contagious cache data.
+      // cache buffer at least WrDiskCache::CELL_BUFFER_SIZE bytes and
+      // append the data to the contagious cache data.
       size_t alen = piece->appendWrCache(
           wrDiskCache_, segment->getPositionToWrite(), inbuf, wlen);
       if (alen < wlen) {
         size_t len = wlen - alen;
-        size_t capacity = std::max(len, static_cast<size_t>(4_k));
-        auto dataCopy = new unsigned char[capacity];
+        size_t capacity;
+        auto dataCopy = wrDiskCache_->allocateBuffer(len, &capacity);
         memcpy(dataCopy, inbuf + alen, len);
         piece->updateWrCache(wrDiskCache_, dataCopy, 0, len, capacity,
                              segment->getPositionToWrite() + alen);
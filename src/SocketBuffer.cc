@@ -35,9 +35,11 @@
 #include "SocketBuffer.h"
 
 #include <cassert>
+#include <cstring>
 #include <algorithm>
 
 #include "SocketCore.h"
+#include "DiskAdaptor.h"
 #include "DlAbortEx.h"
 #include "message.h"
 #include "fmt.h"
@@ -102,6 +104,78 @@ const unsigned char* SocketBuffer::StringBufEntry::getData() const
   return reinterpret_cast<const unsigned char*>(str_.c_str());
 }
 
+SocketBuffer::FileBufEntry::FileBufEntry(
+    std::shared_ptr<DiskAdaptor> diskAdaptor, int64_t offset, size_t length,
+    std::unique_ptr<ProgressUpdate> progressUpdate)
+    : BufEntry(std::move(progressUpdate)),
+      diskAdaptor_(std::move(diskAdaptor)),
+      offset_(offset),
+      length_(length)
+{
+}
+
+SocketBuffer::FileBufEntry::~FileBufEntry() = default;
+
+ssize_t
+SocketBuffer::FileBufEntry::send(const std::shared_ptr<SocketCore>& socket,
+                                 size_t offset)
+{
+  return diskAdaptor_->sendData(socket, length_ - offset, offset_ + offset);
+}
+
+bool SocketBuffer::FileBufEntry::final(size_t offset) const
+{
+  return length_ <= offset;
+}
+
+size_t SocketBuffer::FileBufEntry::getLength() const { return length_; }
+
+const unsigned char* SocketBuffer::FileBufEntry::getData() const
+{
+  return nullptr;
+}
+
+SocketBuffer::InlineBufEntry::InlineBufEntry()
+    : BufEntry(nullptr), length_(0)
+{
+}
+
+ssize_t
+SocketBuffer::InlineBufEntry::send(const std::shared_ptr<SocketCore>& socket,
+                                   size_t offset)
+{
+  return socket->writeData(data_ + offset, length_ - offset);
+}
+
+bool SocketBuffer::InlineBufEntry::final(size_t offset) const
+{
+  return length_ <= offset;
+}
+
+size_t SocketBuffer::InlineBufEntry::getLength() const { return length_; }
+
+const unsigned char* SocketBuffer::InlineBufEntry::getData() const
+{
+  return data_;
+}
+
+unsigned char* SocketBuffer::InlineBufEntry::reserve(size_t length)
+{
+  if (CAPACITY - length_ < length) {
+    return nullptr;
+  }
+  auto p = data_ + length_;
+  length_ += length;
+  return p;
+}
+
+void SocketBuffer::InlineBufEntry::reset(
+    std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  progressUpdate_ = std::move(progressUpdate);
+  length_ = 0;
+}
+
 SocketBuffer::SocketBuffer(std::shared_ptr<SocketCore> socket)
     : socket_(std::move(socket)), offset_(0)
 {
@@ -118,6 +192,52 @@ void SocketBuffer::pushBytes(std::vector<unsigned char> bytes,
   }
 }
 
+void SocketBuffer::pushBytes(const unsigned char* data, size_t length,
+                             std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  if (length == 0) {
+    return;
+  }
+  memcpy(reserveBytes(length, std::move(progressUpdate)), data, length);
+}
+
+unsigned char*
+SocketBuffer::reserveBytes(size_t length,
+                           std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  if (length == 0) {
+    return nullptr;
+  }
+  if (length > InlineBufEntry::CAPACITY) {
+    std::vector<unsigned char> bytes(length);
+    // The storage of the vector does not move with the vector.
+    auto p = bytes.data();
+    pushBytes(std::move(bytes), std::move(progressUpdate));
+    return p;
+  }
+  if (!progressUpdate && !bufq_.empty()) {
+    auto entry = bufq_.back()->toInlineBufEntry();
+    if (entry && !entry->hasProgressUpdate()) {
+      auto p = entry->reserve(length);
+      if (p) {
+        return p;
+      }
+    }
+  }
+  std::unique_ptr<InlineBufEntry> entry;
+  if (spareEntries_.empty()) {
+    entry = make_unique<InlineBufEntry>();
+  }
+  else {
+    entry = std::move(spareEntries_.back());
+    spareEntries_.pop_back();
+  }
+  entry->reset(std::move(progressUpdate));
+  auto p = entry->reserve(length);
+  bufq_.push_back(std::move(entry));
+  return p;
+}
+
 void SocketBuffer::pushStr(std::string data,
                            std::unique_ptr<ProgressUpdate> progressUpdate)
 {
@@ -127,11 +247,57 @@ void SocketBuffer::pushStr(std::string data,
   }
 }
 
+void SocketBuffer::pushFile(std::shared_ptr<DiskAdaptor> diskAdaptor,
+                            int64_t offset, size_t length,
+                            std::unique_ptr<ProgressUpdate> progressUpdate)
+{
+  if (length > 0) {
+    bufq_.push_back(make_unique<FileBufEntry>(
+        std::move(diskAdaptor), offset, length, std::move(progressUpdate)));
+  }
+}
+
+namespace {
+// The maximum number of InlineBufEntry objects kept for reuse.
+const size_t MAX_SPARE_ENTRIES = 2;
+} // namespace
+
+void SocketBuffer::popFront()
+{
+  auto entry = bufq_.front()->toInlineBufEntry();
+  if (entry && spareEntries_.size() < MAX_SPARE_ENTRIES) {
+    bufq_.front().release();
+    entry->reset(nullptr);
+    spareEntries_.emplace_back(entry);
+  }
+  bufq_.pop_front();
+}
+
 ssize_t SocketBuffer::send()
 {
   a2iovec iov[A2_IOV_MAX];
   size_t totalslen = 0;
   while (!bufq_.empty()) {
+    if (!bufq_.front()->getData()) {
+      auto& buf = bufq_.front();
+      ssize_t slen = buf->send(socket_, offset_);
+      if (slen == 0 && !socket_->wantRead() && !socket_->wantWrite()) {
+        throw DL_ABORT_EX(fmt(EX_SOCKET_SEND, "Connection closed."));
+      }
+      totalslen += slen;
+      offset_ += slen;
+      if (buf->final(offset_)) {
+        buf->progressUpdate(slen, true);
+        popFront();
+        offset_ = 0;
+        continue;
+      }
+      buf->progressUpdate(slen, false);
+      if (socket_->wantRead() || socket_->wantWrite()) {
+        goto fin;
+      }
+      continue;
+    }
     size_t num;
     size_t bufqlen = bufq_.size();
     ssize_t amount = 24_k;
@@ -147,7 +313,7 @@ ssize_t SocketBuffer::send()
 
       ssize_t len = (*i)->getLength();
 
-      if (amount < len) {
+      if (amount < len || !(*i)->getData()) {
         break;
       }
 
@@ -175,7 +341,7 @@ ssize_t SocketBuffer::send()
 
     slen -= firstlen;
     bufq_.front()->progressUpdate(firstlen, true);
-    bufq_.pop_front();
+    popFront();
     offset_ = 0;
 
     for (size_t i = 1; i < num; ++i) {
@@ -189,7 +355,7 @@ ssize_t SocketBuffer::send()
 
       slen -= len;
       bufq_.front()->progressUpdate(len, true);
-      bufq_.pop_front();
+      popFront();
     }
   }
 fin:
@@ -45,6 +45,7 @@
 namespace aria2 {
 
 class SocketCore;
+class DiskAdaptor;
 
 struct ProgressUpdate {
   virtual ~ProgressUpdate() = default;
@@ -53,6 +54,8 @@ struct ProgressUpdate {
 
 class SocketBuffer {
 private:
+  class InlineBufEntry;
+
   class BufEntry {
   public:
     BufEntry(std::unique_ptr<ProgressUpdate> progressUpdate)
@@ -64,7 +67,13 @@ private:
                          size_t offset) = 0;
     virtual bool final(size_t offset) const = 0;
     virtual size_t getLength() const = 0;
+    // Returns the pointer to the data in memory.  Returns nullptr if
+    // the data is not in memory.  Such entry is not gathered into
+    // the vector of writev(2), and is sent by its own send().
     virtual const unsigned char* getData() const = 0;
+    // Returns this object if it is InlineBufEntry, or nullptr.
+    virtual InlineBufEntry* toInlineBufEntry() { return nullptr; }
+    bool hasProgressUpdate() const { return progressUpdate_ != nullptr; }
     void progressUpdate(size_t length, bool complete)
     {
       if (progressUpdate_) {
@@ -72,7 +81,7 @@ private:
       }
     }
 
-  private:
+  protected:
     std::unique_ptr<ProgressUpdate> progressUpdate_;
   };
 
@@ -105,10 +114,61 @@ private:
     std::string str_;
   };
 
+  // Refers to the range of data in DiskAdaptor.  The data is read
+  // from disk, or sent by sendfile(2) if possible, when it is sent.
+  class FileBufEntry : public BufEntry {
+  public:
+    FileBufEntry(std::shared_ptr<DiskAdaptor> diskAdaptor, int64_t offset,
+                 size_t length, std::unique_ptr<ProgressUpdate> progressUpdate);
+    virtual ~FileBufEntry();
+    virtual ssize_t send(const std::shared_ptr<SocketCore>& socket,
+                         size_t offset) CXX11_OVERRIDE;
+    virtual bool final(size_t offset) const CXX11_OVERRIDE;
+    virtual size_t getLength() const CXX11_OVERRIDE;
+    virtual const unsigned char* getData() const CXX11_OVERRIDE;
+
+  private:
+    std::shared_ptr<DiskAdaptor> diskAdaptor_;
+    int64_t offset_;
+    size_t length_;
+  };
+
+  // Holds the copy of small data in itself.  The consecutive small
+  // data without ProgressUpdate are packed into one entry, and the
+  // entries are reused once they are sent.
+  class InlineBufEntry : public BufEntry {
+  public:
+    static const size_t CAPACITY = 512;
+
+    InlineBufEntry();
+    virtual ssize_t send(const std::shared_ptr<SocketCore>& socket,
+                         size_t offset) CXX11_OVERRIDE;
+    virtual bool final(size_t offset) const CXX11_OVERRIDE;
+    virtual size_t getLength() const CXX11_OVERRIDE;
+    virtual const unsigned char* getData() const CXX11_OVERRIDE;
+    virtual InlineBufEntry* toInlineBufEntry() CXX11_OVERRIDE { return this; }
+    // Reserves |length| bytes at the end of the data if there is
+    // enough room.  Returns the pointer to the reserved bytes, or
+    // nullptr.
+    unsigned char* reserve(size_t length);
+    void reset(std::unique_ptr<ProgressUpdate> progressUpdate);
+
+  private:
+    size_t length_;
+    unsigned char data_[CAPACITY];
+  };
+
+  // Removes the first entry of bufq_, keeping it in spareEntries_ if
+  // it is InlineBufEntry.
+  void popFront();
+
   std::shared_ptr<SocketCore> socket_;
 
   std::deque<std::unique_ptr<BufEntry>> bufq_;
 
+  // InlineBufEntry objects which are ready to be reused.
+  std::vector<std::unique_ptr<InlineBufEntry>> spareEntries_;
+
   // Offset of data in bufq_[0]. SocketBuffer tries to send bufq_[0],
   // but it cannot always send whole data. In this case, offset points
   // to the data to be sent in the next send() call.
@@ -130,6 +190,25 @@ public:
   void pushBytes(std::vector<unsigned char> bytes,
                  std::unique_ptr<ProgressUpdate> progressUpdate = nullptr);
 
+  // Copies length bytes of data into queue.  The small data is
+  // packed into the buffer entry queued last if possible, so that
+  // the short messages do not allocate memory each time.  This
+  // function doesn't send data.  If progressUpdate is not null, its
+  // update() function will be called each time the data is sent. It
+  // will be deleted by this object. It can be null.
+  void pushBytes(const unsigned char* data, size_t length,
+                 std::unique_ptr<ProgressUpdate> progressUpdate = nullptr);
+
+  // Queues length bytes in the same way as pushBytes() above, but
+  // leaves them to the caller to fill in.  Returns the pointer to
+  // the queued bytes, which is valid until the next call of any
+  // member function.  This lets the caller transform data (e.g.,
+  // encrypt it) while copying it into queue.  If length is 0,
+  // nothing is queued and returns nullptr.
+  unsigned char*
+  reserveBytes(size_t length,
+               std::unique_ptr<ProgressUpdate> progressUpdate = nullptr);
+
   // Feeds data into queue. This function doesn't send data.  If
   // progressUpdate is not null, its update() function will be called
   // each time the data is sent. It will be deleted by this object. It
@@ -137,6 +216,16 @@ public:
   void pushStr(std::string data,
                std::unique_ptr<ProgressUpdate> progressUpdate = nullptr);
 
+  // Feeds length bytes of data at offset in diskAdaptor into queue.
+  // This function doesn't read nor send data.  The data is read from
+  // diskAdaptor when it is sent, so that it is not copied if the
+  // underlying DiskWriter can send it directly.  If progressUpdate is
+  // not null, its update() function will be called each time the
+  // data is sent. It will be deleted by this object. It can be null.
+  void pushFile(std::shared_ptr<DiskAdaptor> diskAdaptor, int64_t offset,
+                size_t length,
+                std::unique_ptr<ProgressUpdate> progressUpdate = nullptr);
+
   // Sends data in queue.  Returns the number of bytes sent.
   ssize_t send();
 
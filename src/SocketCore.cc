@@ -39,6 +39,9 @@
 #endif // HAVE_IPHLPAPI_H
 
 #include <unistd.h>
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif // HAVE_SYS_SENDFILE_H
 #ifdef HAVE_IFADDRS_H
 #include <ifaddrs.h>
 #endif // HAVE_IFADDRS_H
@@ -48,6 +51,9 @@
 #include <cassert>
 #include <sstream>
 #include <array>
+#ifdef ENABLE_THREADS
+#include <mutex>
+#endif // ENABLE_THREADS
 
 #include "message.h"
 #include "DlRetryEx.h"
@@ -58,6 +64,7 @@
 #include "a2functional.h"
 #include "LogFactory.h"
 #include "A2STR.h"
+#include "DatagramRing.h"
 #ifdef ENABLE_SSL
 #include "TLSContext.h"
 #include "TLSSession.h"
@@ -134,6 +141,14 @@ std::vector<SockAddr> SocketCore::bindAddrs_;
 std::vector<std::vector<SockAddr>> SocketCore::bindAddrsList_;
 std::vector<std::vector<SockAddr>>::iterator SocketCore::bindAddrsListIt_;
 
+#ifdef ENABLE_THREADS
+namespace {
+// Guards bindAddrs_ and bindAddrsListIt_ in establishConnection(),
+// which the engine shards call concurrently.
+std::mutex bindAddrsMutex;
+} // namespace
+#endif // ENABLE_THREADS
+
 int SocketCore::socketRecvBufferSize_ = 0;
 
 #ifdef ENABLE_SSL
@@ -459,9 +474,16 @@ void SocketCore::establishConnection(const std::string& host, uint16_t port,
 
     applySocketBufferSize(fd);
 
-    if (!bindAddrs_.empty()) {
+    std::vector<SockAddr> bindAddrs;
+    {
+#ifdef ENABLE_THREADS
+      std::lock_guard<std::mutex> lock(bindAddrsMutex);
+#endif // ENABLE_THREADS
+      bindAddrs = bindAddrs_;
+    }
+    if (!bindAddrs.empty()) {
       bool bindSuccess = false;
-      for (const auto& soaddr : bindAddrs_) {
+      for (const auto& soaddr : bindAddrs) {
         if (::bind(fd, &soaddr.su.sa, soaddr.suLength) == -1) {
           errNum = SOCKET_ERRNO;
           error = errorMsg(errNum);
@@ -478,6 +500,9 @@ void SocketCore::establishConnection(const std::string& host, uint16_t port,
       }
     }
     if (!bindAddrsList_.empty()) {
+#ifdef ENABLE_THREADS
+      std::lock_guard<std::mutex> lock(bindAddrsMutex);
+#endif // ENABLE_THREADS
       ++bindAddrsListIt_;
       if (bindAddrsListIt_ == bindAddrsList_.end()) {
         bindAddrsListIt_ = bindAddrsList_.begin();
@@ -796,6 +821,30 @@ ssize_t SocketCore::writeVector(a2iovec* iov, size_t iovcnt)
   return ret;
 }
 
+#if defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+ssize_t SocketCore::sendFile(int fd, int64_t offset, size_t len)
+{
+  assert(!secure_);
+  ssize_t ret = 0;
+  wantRead_ = false;
+  wantWrite_ = false;
+
+  off_t off = offset;
+  while ((ret = sendfile(sockfd_, fd, &off, len)) == -1 &&
+         SOCKET_ERRNO == A2_EINTR)
+    ;
+  int errNum = SOCKET_ERRNO;
+  if (ret == -1) {
+    if (!A2_WOULDBLOCK(errNum)) {
+      throw DL_RETRY_EX(fmt(EX_SOCKET_SEND, errorMsg(errNum).c_str()));
+    }
+    wantWrite_ = true;
+    ret = 0;
+  }
+  return ret;
+}
+#endif // HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+
 ssize_t SocketCore::writeData(const void* data, size_t len)
 {
   ssize_t ret = 0;
@@ -911,6 +960,22 @@ bool SocketCore::tlsConnect(const std::string& hostname)
   return tlsHandshake(clTlsContext_.get(), hostname);
 }
 
+std::string SocketCore::getAlpnProtocol() const
+{
+  if (secure_ != A2_TLS_CONNECTED) {
+    return A2STR::NIL;
+  }
+  return tlsSession_->getAlpnProtocol();
+}
+
+std::string SocketCore::getTlsSessionData() const
+{
+  if (secure_ != A2_TLS_CONNECTED) {
+    return A2STR::NIL;
+  }
+  return tlsSession_->getSessionData();
+}
+
 bool SocketCore::tlsHandshake(TLSContext* tlsctx, const std::string& hostname)
 {
   wantRead_ = false;
@@ -941,6 +1006,19 @@ bool SocketCore::tlsHandshake(TLSContext* tlsctx, const std::string& hostname)
                               tlsSession_->getLastErrorString().c_str()));
       }
     }
+    if (tlsctx->getSide() == TLS_CLIENT && !alpnProtocols_.empty()) {
+      rv = tlsSession_->setAlpnProtocols(alpnProtocols_);
+      if (rv != TLS_ERR_OK) {
+        throw DL_ABORT_EX(fmt(EX_SSL_INIT_FAILURE,
+                              tlsSession_->getLastErrorString().c_str()));
+      }
+    }
+    if (tlsctx->getSide() == TLS_CLIENT && !tlsSessionData_.empty() &&
+        tlsSession_->setSessionData(tlsSessionData_) != TLS_ERR_OK) {
+      // Not fatal.  The full handshake is done instead.
+      A2_LOG_DEBUG(fmt("Setting TLS session data failed: %s",
+                       tlsSession_->getLastErrorString().c_str()));
+    }
     // Done with the setup, now let handshaking begin immediately.
     secure_ = A2_TLS_HANDSHAKING;
     A2_LOG_DEBUG("TLS Handshaking");
@@ -986,6 +1064,9 @@ bool SocketCore::tlsHandshake(TLSContext* tlsctx, const std::string& hostname)
         A2_LOG_DEBUG(fmt("Securely connected to %s", peerInfo.c_str()));
         break;
       }
+      if (tlsSession_->isSessionResumed()) {
+        A2_LOG_DEBUG(fmt("TLS session resumed with %s", peerInfo.c_str()));
+      }
 
       // 3. We're connected now!
       secure_ = A2_TLS_CONNECTED;
@@ -1246,6 +1327,138 @@ ssize_t SocketCore::readDataFrom(void* data, size_t len, Endpoint& sender)
   return r;
 }
 
+size_t SocketCore::readDataFrom(DatagramRing& ring)
+{
+  wantRead_ = false;
+  wantWrite_ = false;
+  const size_t n = ring.capacity() - ring.size();
+  if (n == 0) {
+    return 0;
+  }
+#ifdef HAVE_RECVMMSG
+  for (size_t i = 0; i < n; ++i) {
+    auto& slot = ring.getFreeSlot(i);
+    auto& iov = ring.iovs_[i];
+    iov.iov_base = slot.data;
+    iov.iov_len = ring.getMaxDatagramLength();
+    auto& hdr = ring.msgs_[i].msg_hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_name = &slot.addr.su;
+    hdr.msg_namelen = sizeof(slot.addr.su);
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+  }
+  int r;
+  while ((r = recvmmsg(sockfd_, ring.msgs_.data(), n, 0, nullptr)) == -1 &&
+         A2_EINTR == SOCKET_ERRNO)
+    ;
+  int errNum = SOCKET_ERRNO;
+  if (r == -1) {
+    if (!A2_WOULDBLOCK(errNum)) {
+      throw DL_RETRY_EX(fmt(EX_SOCKET_RECV, errorMsg(errNum).c_str()));
+    }
+    wantRead_ = true;
+    return 0;
+  }
+  for (int i = 0; i < r; ++i) {
+    auto& slot = ring.getFreeSlot(i);
+    slot.length = ring.msgs_[i].msg_len;
+    slot.addr.suLength = ring.msgs_[i].msg_hdr.msg_namelen;
+  }
+  ring.pushBack(r);
+  return r;
+#else  // !HAVE_RECVMMSG
+  size_t i;
+  for (i = 0; i < n; ++i) {
+    auto& slot = ring.getFreeSlot(i);
+    socklen_t sockaddrlen = sizeof(slot.addr.su);
+    ssize_t r;
+    // Cast for Windows recvfrom()
+    while ((r = recvfrom(sockfd_, reinterpret_cast<char*>(slot.data),
+                         ring.getMaxDatagramLength(), 0, &slot.addr.su.sa,
+                         &sockaddrlen)) == -1 &&
+           A2_EINTR == SOCKET_ERRNO)
+      ;
+    int errNum = SOCKET_ERRNO;
+    if (r == -1) {
+      if (A2_WOULDBLOCK(errNum)) {
+        wantRead_ = true;
+      }
+      else if (i == 0) {
+        throw DL_RETRY_EX(fmt(EX_SOCKET_RECV, errorMsg(errNum).c_str()));
+      }
+      break;
+    }
+    slot.length = r;
+    slot.addr.suLength = sockaddrlen;
+  }
+  ring.pushBack(i);
+  return i;
+#endif // !HAVE_RECVMMSG
+}
+
+size_t SocketCore::writeData(DatagramRing& ring)
+{
+  wantRead_ = false;
+  wantWrite_ = false;
+  const size_t n = ring.size();
+  if (n == 0) {
+    return 0;
+  }
+#ifdef HAVE_SENDMMSG
+  for (size_t i = 0; i < n; ++i) {
+    auto& datagram = ring.get(i);
+    auto& iov = ring.iovs_[i];
+    iov.iov_base = datagram.data;
+    iov.iov_len = datagram.length;
+    auto& hdr = ring.msgs_[i].msg_hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_name = &datagram.addr.su;
+    hdr.msg_namelen = datagram.addr.suLength;
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+  }
+  int r;
+  while ((r = sendmmsg(sockfd_, ring.msgs_.data(), n, 0)) == -1 &&
+         A2_EINTR == SOCKET_ERRNO)
+    ;
+  int errNum = SOCKET_ERRNO;
+  if (r == -1) {
+    if (!A2_WOULDBLOCK(errNum)) {
+      throw DL_ABORT_EX(fmt(EX_SOCKET_SEND, errorMsg(errNum).c_str()));
+    }
+    wantWrite_ = true;
+    return 0;
+  }
+  ring.popFront(r);
+  return r;
+#else  // !HAVE_SENDMMSG
+  size_t i;
+  for (i = 0; i < n; ++i) {
+    auto& datagram = ring.get(i);
+    ssize_t r;
+    // Cast for Windows sendto()
+    while ((r = sendto(sockfd_, reinterpret_cast<const char*>(datagram.data),
+                       datagram.length, 0, &datagram.addr.su.sa,
+                       datagram.addr.suLength)) == -1 &&
+           A2_EINTR == SOCKET_ERRNO)
+      ;
+    int errNum = SOCKET_ERRNO;
+    if (r == -1) {
+      if (A2_WOULDBLOCK(errNum)) {
+        wantWrite_ = true;
+      }
+      else if (i == 0) {
+        throw DL_ABORT_EX(fmt(EX_SOCKET_SEND, errorMsg(errNum).c_str()));
+      }
+      break;
+    }
+  }
+  ring.popFront(i);
+  return i;
+#endif // !HAVE_SENDMMSG
+}
+
 std::string SocketCore::getSocketError() const
 {
   int error;
@@ -1263,6 +1476,8 @@ std::string SocketCore::getSocketError() const
   return "";
 }
 
+bool SocketCore::isSecure() const { return secure_ != A2_TLS_NONE; }
+
 bool SocketCore::wantRead() const { return wantRead_; }
 
 bool SocketCore::wantWrite() const { return wantWrite_; }
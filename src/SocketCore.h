@@ -59,6 +59,8 @@ class TLSSession;
 class SSHSession;
 #endif // HAVE_LIBSSH2
 
+class DatagramRing;
+
 class SocketCore {
   friend bool operator==(const SocketCore& s1, const SocketCore& s2);
   friend bool operator!=(const SocketCore& s1, const SocketCore& s2);
@@ -93,6 +95,10 @@ private:
 
   std::shared_ptr<TLSSession> tlsSession_;
 
+  // Protocols offered with ALPN in client side handshake.
+  std::vector<std::string> alpnProtocols_;
+  std::string tlsSessionData_;
+
   /**
    * Makes this socket secure. The connection must be established
    * before calling this method.
@@ -264,6 +270,17 @@ public:
 
   ssize_t writeVector(a2iovec* iov, size_t iovcnt);
 
+#if defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+  /**
+   * Writes at most len bytes of the file fd at offset into this
+   * socket using sendfile(2), so that the data is not copied into
+   * user space. This socket must not be secured by TLS. The size of
+   * written data is returned. If the underlying socket gets EAGAIN,
+   * wantWrite_ is set.
+   */
+  ssize_t sendFile(int fd, int64_t offset, size_t len);
+#endif // HAVE_SENDFILE && HAVE_SYS_SENDFILE_H
+
   /**
    * Reads up to len bytes from this socket.
    * data is a pointer pointing the first
@@ -285,6 +302,19 @@ public:
   // sender.addr will be numerihost assigned.
   ssize_t readDataFrom(void* data, size_t len, Endpoint& sender);
 
+  // Receives datagrams into the free slots of ring at once, using
+  // recvmmsg(2) if available.  Returns the number of datagrams
+  // received.  If no datagram is available, returns 0 and wantRead_
+  // is set.
+  size_t readDataFrom(DatagramRing& ring);
+
+  // Sends the datagrams in ring from the oldest one at once, using
+  // sendmmsg(2) if available, and removes the sent ones from ring.
+  // Returns the number of datagrams sent.  If the socket would
+  // block, returns 0 and wantWrite_ is set.  Throws DlAbortEx if the
+  // oldest datagram cannot be sent.
+  size_t writeData(DatagramRing& ring);
+
 #ifdef ENABLE_SSL
   // Performs TLS server side handshake. If handshake is completed,
   // returns true. If handshake has not been done yet, returns false.
@@ -296,6 +326,28 @@ public:
   // If you are going to verify peer's certificate, hostname must be
   // supplied.
   bool tlsConnect(const std::string& hostname);
+
+  // Sets the protocols offered with ALPN in the next client side
+  // handshake.
+  void setAlpnProtocols(std::vector<std::string> protocols)
+  {
+    alpnProtocols_ = std::move(protocols);
+  }
+
+  // Returns the protocol selected by the server with ALPN, or an
+  // empty string.
+  std::string getAlpnProtocol() const;
+
+  // Sets the data of an earlier TLS session with the same server,
+  // which is resumed in the next client side handshake.
+  void setTlsSessionData(std::string data)
+  {
+    tlsSessionData_ = std::move(data);
+  }
+
+  // Returns the data to resume the current TLS session later, or an
+  // empty string.
+  std::string getTlsSessionData() const;
 #endif // ENABLE_SSL
 
 #ifdef HAVE_LIBSSH2
@@ -324,6 +376,9 @@ public:
 
   std::string getSocketError() const;
 
+  // Returns true if TLS is used on this socket.
+  bool isSecure() const;
+
   /**
    * Returns true if the underlying socket gets EAGAIN in the previous
    * readData() or writeData() and the socket needs more incoming data to
@@ -0,0 +1,233 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "SocketPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "SocketCore.h"
+#include "LogFactory.h"
+#include "Logger.h"
+#include "fmt.h"
+#include "wallclock.h"
+#include "util.h"
+#include "A2STR.h"
+
+namespace aria2 {
+
+namespace {
+std::string toString(const SocketPool::Key& key)
+{
+  std::string s;
+  if (!key.username.empty()) {
+    s += util::percentEncode(key.username);
+    s += "@";
+  }
+  s += fmt("%s(%u)", key.host.c_str(), key.port);
+  if (!key.proxyhost.empty()) {
+    s += fmt("/%s(%u)", key.proxyhost.c_str(), key.proxyport);
+  }
+  return s;
+}
+} // namespace
+
+SocketPool::Key::Key(std::string host, uint16_t port, std::string username,
+                     std::string proxyhost, uint16_t proxyport)
+    : host(std::move(host)),
+      port(port),
+      username(std::move(username)),
+      proxyhost(std::move(proxyhost)),
+      proxyport(proxyport)
+{
+}
+
+bool SocketPool::Key::operator==(const Key& key) const
+{
+  return port == key.port && proxyport == key.proxyport && host == key.host &&
+         username == key.username && proxyhost == key.proxyhost;
+}
+
+size_t SocketPool::KeyHash::operator()(const Key& key) const
+{
+  std::hash<std::string> hash;
+  size_t seed = hash(key.host);
+  auto combine = [&seed](size_t v) {
+    seed ^= v + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  };
+  combine(key.port);
+  combine(hash(key.username));
+  combine(hash(key.proxyhost));
+  combine(key.proxyport);
+  return seed;
+}
+
+bool SocketPool::Entry::isTimeout() const
+{
+  return registeredTime.difference(global::wallclock()) >= timeout;
+}
+
+SocketPool::SocketPool(size_t maxSocketsPerKey, size_t maxSockets)
+    : maxSocketsPerKey_(std::max(static_cast<size_t>(1), maxSocketsPerKey)),
+      maxSockets_(std::max(static_cast<size_t>(1), maxSockets)),
+      minTimeout_(std::chrono::seconds::max()),
+      numHit_(0),
+      numMiss_(0)
+{
+}
+
+SocketPool::~SocketPool() = default;
+
+void SocketPool::erase(EntryIter i)
+{
+  auto j = index_.find((*i).key);
+  assert(j != std::end(index_));
+  auto& entries = (*j).second;
+  entries.erase(std::find(std::begin(entries), std::end(entries), i));
+  if (entries.empty()) {
+    index_.erase(j);
+  }
+  entries_.erase(i);
+}
+
+void SocketPool::add(const Key& key, const std::shared_ptr<SocketCore>& socket,
+                     const std::string& options, std::chrono::seconds timeout)
+{
+  A2_LOG_INFO(fmt("Pool socket for %s", toString(key).c_str()));
+  auto i = index_.find(key);
+  if (i != std::end(index_) && (*i).second.size() >= maxSocketsPerKey_) {
+    A2_LOG_DEBUG(fmt("Too many pooled sockets for %s. Closing the oldest one.",
+                     toString(key).c_str()));
+    erase((*i).second.front());
+  }
+  if (entries_.size() >= maxSockets_) {
+    A2_LOG_DEBUG("SocketPool is full. Closing the oldest socket.");
+    erase(std::begin(entries_));
+  }
+  entries_.push_back(Entry{key, socket, options, timeout, global::wallclock()});
+  index_[key].push_back(std::prev(std::end(entries_)));
+  minTimeout_ = std::min(minTimeout_, timeout);
+}
+
+std::shared_ptr<SocketCore> SocketPool::pop(const Key& key,
+                                            std::string* options)
+{
+  auto i = index_.find(key);
+  if (i == std::end(index_)) {
+    return nullptr;
+  }
+  auto& entries = (*i).second;
+  std::shared_ptr<SocketCore> socket;
+  // The most recently pooled socket is the least likely to be closed
+  // by the peer.
+  while (!entries.empty() && !socket) {
+    auto j = entries.back();
+    entries.pop_back();
+    auto& e = *j;
+    // We assume that if socket is readable it means peer shutdowns
+    // connection and the socket will receive EOF. So skip it.
+    if (!e.isTimeout() && !e.socket->isReadable(0)) {
+      A2_LOG_INFO(fmt("Found socket for %s", toString(key).c_str()));
+      socket = std::move(e.socket);
+      if (options) {
+        *options = std::move(e.options);
+      }
+    }
+    entries_.erase(j);
+  }
+  if (entries.empty()) {
+    index_.erase(i);
+  }
+  return socket;
+}
+
+void SocketPool::evict()
+{
+  if (entries_.empty()) {
+    return;
+  }
+  A2_LOG_DEBUG("Scanning SocketPool and erasing timed out entry.");
+  size_t numEntries = entries_.size();
+  auto& now = global::wallclock();
+  for (auto i = std::begin(entries_); i != std::end(entries_);) {
+    if ((*i).registeredTime.difference(now) < minTimeout_) {
+      // The rest of the entries were pooled even later.
+      break;
+    }
+    auto j = i++;
+    if ((*j).isTimeout()) {
+      erase(j);
+    }
+  }
+  A2_LOG_DEBUG(fmt("%lu entries removed.",
+                   static_cast<unsigned long>(numEntries - entries_.size())));
+}
+
+void SocketPool::countLookup(bool hit)
+{
+  if (hit) {
+    ++numHit_;
+  }
+  else {
+    ++numMiss_;
+  }
+}
+
+void SocketPool::putTlsSessionData(const std::string& hostname, uint16_t port,
+                                   std::string data)
+{
+  Key key(hostname, port);
+  auto i = tlsSessions_.find(key);
+  if (i != std::end(tlsSessions_)) {
+    (*i).second = std::move(data);
+    return;
+  }
+  if (tlsSessions_.size() >= maxSockets_) {
+    // Any entry will do.  The session is just not resumed.
+    tlsSessions_.erase(std::begin(tlsSessions_));
+  }
+  tlsSessions_.emplace(std::move(key), std::move(data));
+}
+
+const std::string& SocketPool::getTlsSessionData(const std::string& hostname,
+                                                 uint16_t port) const
+{
+  auto i = tlsSessions_.find(Key(hostname, port));
+  if (i == std::end(tlsSessions_)) {
+    return A2STR::NIL;
+  }
+  return (*i).second;
+}
+
+} // namespace aria2
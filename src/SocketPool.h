@@ -0,0 +1,155 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_SOCKET_POOL_H
+#define D_SOCKET_POOL_H
+
+#include "common.h"
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <chrono>
+
+#include "TimerA2.h"
+
+namespace aria2 {
+
+class SocketCore;
+
+// Idle connections kept for reuse.  Connections are looked up by a
+// structured key, and are evicted in the least recently pooled order
+// when the per-key or the total limit is reached, or when they time
+// out.
+class SocketPool {
+public:
+  struct Key {
+    // The IP address, or the hostname if the connection goes through
+    // a proxy.
+    std::string host;
+    uint16_t port;
+    std::string username;
+    std::string proxyhost;
+    uint16_t proxyport;
+
+    Key(std::string host, uint16_t port, std::string username = "",
+        std::string proxyhost = "", uint16_t proxyport = 0);
+
+    bool operator==(const Key& key) const;
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  SocketPool(size_t maxSocketsPerKey, size_t maxSockets);
+  ~SocketPool();
+
+  // Pools |socket| for |key|.  |options| is a protocol specific
+  // string returned with the socket by pop().  If the pool is full,
+  // the least recently pooled socket of the same key, or of all keys,
+  // is closed.
+  void add(const Key& key, const std::shared_ptr<SocketCore>& socket,
+           const std::string& options, std::chrono::seconds timeout);
+
+  // Removes the most recently pooled socket of |key| which is still
+  // usable, and returns it.  If |options| is not nullptr, the options
+  // of the socket are stored in it.  Timed out sockets and the sockets
+  // closed by the peer are discarded on the way.  Returns nullptr if
+  // no socket is found.
+  std::shared_ptr<SocketCore> pop(const Key& key,
+                                  std::string* options = nullptr);
+
+  // Discards the timed out sockets.
+  void evict();
+
+  size_t size() const { return entries_.size(); }
+
+  // Counts the result of a lookup for a connection.  A lookup may
+  // consist of several calls of pop(), one for each address of the
+  // server, so the caller counts it.
+  void countLookup(bool hit);
+
+  uint64_t getNumHit() const { return numHit_; }
+
+  uint64_t getNumMiss() const { return numMiss_; }
+
+  // Remembers |data| to resume the TLS session with |hostname|:|port|.
+  void putTlsSessionData(const std::string& hostname, uint16_t port,
+                         std::string data);
+
+  // Returns the TLS session data with |hostname|:|port|, or an empty
+  // string.
+  const std::string& getTlsSessionData(const std::string& hostname,
+                                       uint16_t port) const;
+
+private:
+  struct Entry {
+    Key key;
+    std::shared_ptr<SocketCore> socket;
+    std::string options;
+    std::chrono::seconds timeout;
+    Timer registeredTime;
+
+    bool isTimeout() const;
+  };
+
+  typedef std::list<Entry>::iterator EntryIter;
+
+  // All entries, the least recently pooled first.
+  std::list<Entry> entries_;
+  // The entries of each key, the least recently pooled first.
+  std::unordered_map<Key, std::vector<EntryIter>, KeyHash> index_;
+  // The TLS session data of each server.  Only hostname and port of
+  // the keys are used.
+  std::unordered_map<Key, std::string, KeyHash> tlsSessions_;
+
+  size_t maxSocketsPerKey_;
+  size_t maxSockets_;
+  // The smallest timeout ever given to add().  No entry registered
+  // within this period is timed out, which lets evict() stop early.
+  std::chrono::seconds minTimeout_;
+
+  uint64_t numHit_;
+  uint64_t numMiss_;
+
+  // Removes |i| from the index and from entries_.
+  void erase(EntryIter i);
+};
+
+} // namespace aria2
+
+#endif // D_SOCKET_POOL_H
@@ -38,16 +38,53 @@
 #include <cassert>
 
 #include "SocketCore.h"
+#include "Http2Session.h"
 #include "LogFactory.h"
 
 namespace aria2 {
 
 SocketRecvBuffer::SocketRecvBuffer(std::shared_ptr<SocketCore> socket)
-    : socket_(std::move(socket)), pos_(buf_.data()), last_(pos_)
+    : socket_(std::move(socket)),
+      pos_(buf_.data()),
+      last_(pos_),
+      streamId_(0),
+      command_(nullptr)
 {
 }
 
-SocketRecvBuffer::~SocketRecvBuffer() = default;
+SocketRecvBuffer::~SocketRecvBuffer()
+{
+  if (http2Session_) {
+    http2Session_->closeStream(streamId_);
+  }
+}
+
+void SocketRecvBuffer::setHttp2Stream(std::shared_ptr<Http2Session> session,
+                                      int32_t streamId)
+{
+  http2Session_ = std::move(session);
+  streamId_ = streamId;
+  http2Session_->setStreamCommand(streamId_, command_);
+}
+
+void SocketRecvBuffer::setCommand(Command* command)
+{
+  command_ = command;
+  if (http2Session_) {
+    http2Session_->setStreamCommand(streamId_, command_);
+  }
+}
+
+void SocketRecvBuffer::releaseCommand(Command* command)
+{
+  if (command_ != command) {
+    return;
+  }
+  command_ = nullptr;
+  if (http2Session_) {
+    http2Session_->releaseStreamCommand(streamId_, command);
+  }
+}
 
 ssize_t SocketRecvBuffer::recv()
 {
@@ -56,11 +93,29 @@ ssize_t SocketRecvBuffer::recv()
     A2_LOG_DEBUG("Buffer full");
     return 0;
   }
-  socket_->readData(last_, n);
+  if (http2Session_) {
+    n = http2Session_->readData(streamId_, last_, n);
+  }
+  else {
+    socket_->readData(last_, n);
+  }
   last_ += n;
   return n;
 }
 
+bool SocketRecvBuffer::eof() const
+{
+  if (http2Session_) {
+    return http2Session_->streamClosed(streamId_);
+  }
+  return !socket_->wantRead() && !socket_->wantWrite();
+}
+
+bool SocketRecvBuffer::dataAvailable() const
+{
+  return http2Session_ && http2Session_->dataAvailable(streamId_);
+}
+
 void SocketRecvBuffer::drain(size_t n)
 {
   assert(pos_ + n <= last_);
@@ -45,14 +45,24 @@
 namespace aria2 {
 
 class SocketCore;
+class Http2Session;
+class Command;
 
 class SocketRecvBuffer {
 public:
   SocketRecvBuffer(std::shared_ptr<SocketCore> socket);
   ~SocketRecvBuffer();
   // Reads data from socket as much as capacity allows. Returns the
-  // number of bytes read.
+  // number of bytes read.  If an HTTP/2 stream is set, reads the
+  // response of the stream instead.
   ssize_t recv();
+  // Returns true if the last recv() returned 0 because the end of
+  // data was reached, rather than because the socket would block.
+  bool eof() const;
+  // Returns true if recv() makes progress without waiting for the
+  // socket to become readable.  This is only the case when the data
+  // of an HTTP/2 stream was read from the socket by another stream.
+  bool dataAvailable() const;
   // Truncates the contents of buffer to 0.
   void truncateBuffer();
   // Drains first n bytes of data from buffer.  It is an programmer's
@@ -68,11 +78,31 @@ public:
 
   bool bufferEmpty() const { return pos_ == last_; }
 
+  // Makes recv() read the response of |streamId| in |session|.  The
+  // stream is closed when this object is destroyed.
+  void setHttp2Stream(std::shared_ptr<Http2Session> session,
+                      int32_t streamId);
+
+  const std::shared_ptr<Http2Session>& getHttp2Session() const
+  {
+    return http2Session_;
+  }
+
+  // Sets the command which reads from this buffer, so that it is
+  // woken up when the data of its HTTP/2 stream arrives.
+  void setCommand(Command* command);
+
+  // Unsets the command if it is |command|.
+  void releaseCommand(Command* command);
+
 private:
   std::array<unsigned char, 16_k> buf_;
   std::shared_ptr<SocketCore> socket_;
   unsigned char* pos_;
   unsigned char* last_;
+  std::shared_ptr<Http2Session> http2Session_;
+  int32_t streamId_;
+  Command* command_;
 };
 
 } // namespace aria2
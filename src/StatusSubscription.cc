@@ -0,0 +1,182 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "StatusSubscription.h"
+
+#include <algorithm>
+
+#include "DownloadEngine.h"
+#include "RequestGroupMan.h"
+#include "RequestGroup.h"
+#include "DownloadResult.h"
+#include "GroupId.h"
+#include "RpcMethodImpl.h"
+#include "ValueBase.h"
+#include "ValueWriter.h"
+#include "json.h"
+
+namespace aria2 {
+
+namespace rpc {
+
+namespace {
+const std::string ON_DOWNLOAD_CHANGE = "aria2.onDownloadChange";
+} // namespace
+
+StatusSubscription::StatusSubscription(std::vector<std::string> keys)
+    : keys_{std::move(keys)}, serial_{0}
+{
+}
+
+namespace {
+// Returns the members of status whose value differs from the last
+// reported one in fields, and updates fields.  The members which
+// disappeared from status are reported as null.  Returns nullptr if
+// nothing changed.
+std::unique_ptr<Dict> createChanges(std::map<std::string, std::string>& fields,
+                                    Dict* status, a2_gid_t gid)
+{
+  std::unique_ptr<Dict> changes;
+  auto put = [&](const std::string& key, std::unique_ptr<ValueBase> v) {
+    if (!changes) {
+      changes = Dict::g();
+      changes->put("gid", GroupId::toHex(gid));
+    }
+    changes->put(key, std::move(v));
+  };
+  for (auto i = std::begin(fields); i != std::end(fields);) {
+    if (status->containsKey((*i).first)) {
+      ++i;
+      continue;
+    }
+    put((*i).first, Null::g());
+    i = fields.erase(i);
+  }
+  for (auto& kv : *status) {
+    // gid never changes, and is always included by put().
+    if (kv.first == "gid") {
+      continue;
+    }
+    auto v = json::encode(kv.second.get());
+    auto& last = fields[kv.first];
+    if (last == v) {
+      continue;
+    }
+    last = std::move(v);
+    put(kv.first, std::move(kv.second));
+  }
+  return changes;
+}
+} // namespace
+
+std::string StatusSubscription::createNotification(DownloadEngine* e)
+{
+  ++serial_;
+  auto params = List::g();
+  auto& rgman = e->getRequestGroupMan();
+  auto examine = [&](const std::shared_ptr<RequestGroup>& group, bool active) {
+    auto gid = group->getGID();
+    auto i = entries_.find(gid);
+    bool known = i != std::end(entries_);
+    if (!known) {
+      i = entries_.emplace(gid, Entry{{}, 0, 0, active}).first;
+    }
+    auto& entry = (*i).second;
+    entry.seen = serial_;
+    if (known && !active && !entry.active &&
+        entry.stateSerial == group->getStateSerial()) {
+      return;
+    }
+    entry.active = active;
+    entry.stateSerial = group->getStateSerial();
+    ValueBaseWriter writer;
+    writer.beginDict();
+    gatherStatus(writer, group, e, keys_);
+    writer.endDict();
+    auto status = writer.getResult();
+    auto changes = createChanges(entry.fields, downcast<Dict>(status), gid);
+    if (changes) {
+      params->append(std::move(changes));
+    }
+  };
+  for (auto& group : rgman->getRequestGroups()) {
+    examine(group, true);
+  }
+  for (auto& group : rgman->getReservedGroups()) {
+    examine(group, false);
+  }
+  for (auto i = std::begin(entries_); i != std::end(entries_);) {
+    if ((*i).second.seen == serial_) {
+      ++i;
+      continue;
+    }
+    // The download was stopped, or removed from the waiting queue.
+    // In the latter case, no DownloadResult is left.
+    auto ds = rgman->findDownloadResult((*i).first);
+    if (!ds) {
+      if (keys_.empty() || std::find(std::begin(keys_), std::end(keys_),
+                                     "status") != std::end(keys_)) {
+        auto changes = Dict::g();
+        changes->put("gid", GroupId::toHex((*i).first));
+        changes->put("status", "removed");
+        params->append(std::move(changes));
+      }
+    }
+    else {
+      ValueBaseWriter writer;
+      writer.beginDict();
+      gatherStoppedDownload(writer, ds, keys_);
+      writer.endDict();
+      auto status = writer.getResult();
+      auto changes =
+          createChanges((*i).second.fields, downcast<Dict>(status), (*i).first);
+      if (changes) {
+        params->append(std::move(changes));
+      }
+    }
+    i = entries_.erase(i);
+  }
+  if (params->empty()) {
+    return "";
+  }
+  auto dict = Dict::g();
+  dict->put("jsonrpc", "2.0");
+  dict->put("method", ON_DOWNLOAD_CHANGE);
+  dict->put("params", std::move(params));
+  return json::encode(dict.get());
+}
+
+} // namespace rpc
+
+} // namespace aria2
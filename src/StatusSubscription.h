@@ -0,0 +1,99 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_STATUS_SUBSCRIPTION_H
+#define D_STATUS_SUBSCRIPTION_H
+
+#include "common.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+#include "GroupId.h"
+
+namespace aria2 {
+
+class DownloadEngine;
+class RequestGroup;
+
+namespace rpc {
+
+// Tracks the status of downloads on behalf of a client which called
+// aria2.subscribe, and reports only the fields changed since the
+// last report.  Active downloads are examined each time.  A download
+// in the waiting queue is examined only when it enters the queue or
+// its RequestGroup::getStateSerial() changes, so that unchanged
+// waiting downloads cost a lookup and an integer comparison.
+class StatusSubscription {
+public:
+  // keys is the list of the fields to report, as the keys parameter
+  // of aria2.tellStatus.  If it is empty, all fields are reported.
+  StatusSubscription(std::vector<std::string> keys);
+
+  // Returns JSON-RPC notification aria2.onDownloadChange whose params
+  // hold the changed fields of each changed download, or an empty
+  // string if nothing changed.  Each entry includes "gid".  The first
+  // call reports all downloads in the active and waiting queues.  A
+  // download which left the queues is reported once more with its
+  // final status, and then forgotten.  If it was removed from the
+  // waiting queue and left no download result, its status is
+  // reported as "removed".
+  std::string createNotification(DownloadEngine* e);
+
+  const std::vector<std::string>& getKeys() const { return keys_; }
+
+private:
+  struct Entry {
+    // The last reported value of each field, encoded in JSON.
+    std::map<std::string, std::string> fields;
+    uint64_t stateSerial;
+    // The value of serial_ when this download was last found in the
+    // active or waiting queue.
+    uint64_t seen;
+    bool active;
+  };
+
+  std::vector<std::string> keys_;
+  std::unordered_map<a2_gid_t, Entry> entries_;
+  // Incremented in each createNotification() call.
+  uint64_t serial_;
+};
+
+} // namespace rpc
+
+} // namespace aria2
+
+#endif // D_STATUS_SUBSCRIPTION_H
@@ -36,6 +36,10 @@
 #define TLS_SESSION_H
 
 #include "common.h"
+
+#include <string>
+#include <vector>
+
 #include "a2netcompat.h"
 #include "TLSContext.h"
 
@@ -68,6 +72,34 @@ public:
   // succeeds, or TLS_ERR_ERROR.
   virtual int setSNIHostname(const std::string& hostname) = 0;
 
+  // Sets |protocols| offered with TLS ALPN extension, in the order of
+  // preference.  This is only meaningful for client side session and
+  // must be called before the handshake.  This function returns
+  // TLS_ERR_OK if it succeeds, or TLS_ERR_ERROR.  Backends without
+  // ALPN support just offer nothing.
+  virtual int setAlpnProtocols(const std::vector<std::string>& protocols)
+  {
+    return TLS_ERR_OK;
+  }
+
+  // Returns the protocol selected by the server with ALPN, or an empty
+  // string if none was selected.
+  virtual std::string getAlpnProtocol() { return std::string(); }
+
+  // Sets the session data obtained by getSessionData() from an
+  // earlier session with the same server, so that the handshake
+  // resumes that session.  This is only meaningful for client side
+  // session and must be called before the handshake.  This function
+  // returns TLS_ERR_OK if it succeeds, or TLS_ERR_ERROR.
+  virtual int setSessionData(const std::string& data) { return TLS_ERR_OK; }
+
+  // Returns the data to resume this session later, or an empty string
+  // if the backend does not support resumption.
+  virtual std::string getSessionData() { return std::string(); }
+
+  // Returns true if the handshake resumed the earlier session.
+  virtual bool isSessionResumed() { return false; }
+
   // Closes the SSL/TLS session. Don't close underlying transport
   // socket. This function returns TLS_ERR_OK if it succeeds, or
   // TLS_ERR_ERROR.
@@ -0,0 +1,100 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_THREAD_POOL_H
+#define D_THREAD_POOL_H
+
+#include "common.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <type_traits>
+
+namespace aria2 {
+
+// Fixed size pool of worker threads.  Jobs are run in FIFO order.
+// The jobs must not touch the objects owned by the event loop; they
+// should work on the data given to them and hand the result back
+// through std::future, so that the event loop thread can apply it.
+class ThreadPool {
+private:
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> jobs_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool stop_;
+
+  void run();
+
+public:
+  // Starts numThreads workers.  numThreads must be greater than 0.
+  explicit ThreadPool(size_t numThreads);
+
+  // Waits for the already running jobs to finish and joins all
+  // workers.  The jobs still in queue are discarded.
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t getNumThreads() const { return workers_.size(); }
+
+  // Enqueues job.  The returned future becomes ready when job has
+  // been run.  If job throws exception, it is stored in the future
+  // and rethrown by std::future::get().  If the pool is destroyed
+  // before job is run, std::future::get() throws std::future_error.
+  template <typename F>
+  std::future<typename std::result_of<F()>::type> submit(F job)
+  {
+    typedef typename std::result_of<F()>::type R;
+    auto task = std::make_shared<std::packaged_task<R()>>(std::move(job));
+    auto res = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back([task] { (*task)(); });
+    }
+    cond_.notify_one();
+    return res;
+  }
+};
+
+} // namespace aria2
+
+#endif // D_THREAD_POOL_H
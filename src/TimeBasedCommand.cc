@@ -46,7 +46,8 @@ TimeBasedCommand::TimeBasedCommand(cuid_t cuid, DownloadEngine* e,
       checkPoint_(global::wallclock()),
       interval_(std::move(interval)),
       exit_(false),
-      routineCommand_(routineCommand)
+      routineCommand_(routineCommand),
+      sleep_(false)
 {
 }
 
@@ -75,6 +76,11 @@ bool TimeBasedCommand::execute()
   else {
     e_->addCommand(std::unique_ptr<Command>(this));
   }
+  if (sleep_) {
+    auto timeout = interval_ - checkPoint_.difference(global::wallclock());
+    e_->sleepCommand(
+        this, std::chrono::duration_cast<std::chrono::milliseconds>(timeout));
+  }
   return false;
 }
 
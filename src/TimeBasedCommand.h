@@ -61,11 +61,23 @@ private:
 
   bool routineCommand_;
 
+  /**
+   * If true, this command sleeps until the interval elapses instead of
+   * being executed at every refresh of DownloadEngine.
+   */
+  bool sleep_;
+
 protected:
   DownloadEngine* getDownloadEngine() const { return e_; }
 
   void enableExit() { exit_ = true; }
 
+  /**
+   * Only for the subclass which does nothing in preProcess() and
+   * postProcess().
+   */
+  void enableSleep() { sleep_ = true; }
+
   const std::chrono::seconds& getInterval() const { return interval_; }
 
 public:
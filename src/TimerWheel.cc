@@ -0,0 +1,168 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "TimerWheel.h"
+
+#include "Command.h"
+
+namespace aria2 {
+
+TimerWheel::Node::Node(Command* command)
+    : command_{command}, prev_{nullptr}, next_{nullptr}, expiry_{0}
+{
+}
+
+void TimerWheel::Node::unlink()
+{
+  if (!prev_) {
+    return;
+  }
+  prev_->next_ = next_;
+  next_->prev_ = prev_;
+  prev_ = next_ = nullptr;
+}
+
+TimerWheel::TimerWheel(const Timer& now, std::chrono::milliseconds tick)
+    : start_{now}, tick_{std::move(tick)}, base_{0}
+{
+  for (auto& level : slots_) {
+    for (auto& head : level) {
+      head.prev_ = head.next_ = &head;
+    }
+  }
+}
+
+TimerWheel::~TimerWheel() { clear(); }
+
+uint64_t TimerWheel::toTick(const Timer& t, bool roundUp) const
+{
+  auto d = std::chrono::duration_cast<std::chrono::milliseconds>(
+                 start_.difference(t))
+               .count();
+  if (roundUp) {
+    d += tick_.count() - 1;
+  }
+  return d / tick_.count();
+}
+
+void TimerWheel::insert(Node* node, uint64_t expiry)
+{
+  if (expiry < base_) {
+    expiry = base_;
+  }
+  auto delta = expiry - base_;
+  int level = 0;
+  for (; level < NUM_LEVELS - 1; ++level) {
+    if (delta < (1ULL << (SLOT_BITS * (level + 1)))) {
+      break;
+    }
+  }
+  if (level == NUM_LEVELS - 1) {
+    const auto maxDelta = (1ULL << (SLOT_BITS * NUM_LEVELS)) - 1;
+    if (delta > maxDelta) {
+      expiry = base_ + maxDelta;
+    }
+  }
+  auto& head = slots_[level][(expiry >> (SLOT_BITS * level)) & (NUM_SLOTS - 1)];
+  node->expiry_ = expiry;
+  node->prev_ = head.prev_;
+  node->next_ = &head;
+  head.prev_->next_ = node;
+  head.prev_ = node;
+}
+
+void TimerWheel::schedule(Command* command, const Timer& deadline)
+{
+  auto node = &command->timerNode_;
+  node->unlink();
+  insert(node, toTick(deadline, true));
+}
+
+void TimerWheel::cascade(int level, size_t index)
+{
+  auto& head = slots_[level][index];
+  if (head.next_ == &head) {
+    return;
+  }
+  // Detach the whole list first because insert() may put a node back
+  // into the same slot.
+  Node list;
+  list.next_ = head.next_;
+  list.prev_ = head.prev_;
+  list.next_->prev_ = &list;
+  list.prev_->next_ = &list;
+  head.prev_ = head.next_ = &head;
+  while (list.next_ != &list) {
+    auto node = list.next_;
+    node->unlink();
+    insert(node, node->expiry_);
+  }
+  list.prev_ = list.next_ = nullptr;
+}
+
+void TimerWheel::advance(const Timer& now)
+{
+  auto nowTick = toTick(now, false);
+  for (; base_ <= nowTick; ++base_) {
+    auto index = base_ & (NUM_SLOTS - 1);
+    if (index == 0) {
+      for (int level = 1; level < NUM_LEVELS; ++level) {
+        auto i = (base_ >> (SLOT_BITS * level)) & (NUM_SLOTS - 1);
+        cascade(level, i);
+        if (i != 0) {
+          break;
+        }
+      }
+    }
+    auto& head = slots_[0][index];
+    while (head.next_ != &head) {
+      auto node = head.next_;
+      node->unlink();
+      node->command_->setStatusActive();
+    }
+  }
+}
+
+void TimerWheel::clear()
+{
+  for (auto& level : slots_) {
+    for (auto& head : level) {
+      while (head.next_ != &head) {
+        head.next_->unlink();
+      }
+    }
+  }
+}
+
+} // namespace aria2
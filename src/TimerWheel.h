@@ -0,0 +1,127 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_TIMER_WHEEL_H
+#define D_TIMER_WHEEL_H
+
+#include "common.h"
+
+#include <chrono>
+
+#include "TimerA2.h"
+
+namespace aria2 {
+
+class Command;
+
+// Hierarchical timer wheel for sleeping Commands.  It has 4 levels of
+// 64 slots.  The first level holds the timers which expire within 64
+// ticks, and each higher level covers 64 times longer span than the
+// previous one.  The timers in a higher level slot are moved down
+// when the lower level wraps around, so that scheduling,
+// cancellation and expiration are all O(1) regardless of the number
+// of timers.
+//
+// The timers are linked intrusively through TimerWheel::Node embedded
+// in Command, and the Command removes itself from the wheel when it
+// is destroyed.
+class TimerWheel {
+public:
+  class Node {
+  public:
+    Node(Command* command = nullptr);
+
+    ~Node() { unlink(); }
+
+    Node(const Node&) = delete;
+    Node& operator=(const Node&) = delete;
+
+    // Returns true if this node is scheduled in a wheel.
+    bool linked() const { return prev_ != nullptr; }
+
+    // Removes this node from the wheel.  It is safe to call this
+    // function when this node is not scheduled.
+    void unlink();
+
+  private:
+    friend class TimerWheel;
+
+    Command* command_;
+    Node* prev_;
+    Node* next_;
+    uint64_t expiry_;
+  };
+
+  // |now| is the time of tick 0.
+  TimerWheel(const Timer& now,
+             std::chrono::milliseconds tick = std::chrono::milliseconds(100));
+
+  ~TimerWheel();
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  // Schedules |command| to wake up at |deadline|.  If it is already
+  // scheduled, it is rescheduled.
+  void schedule(Command* command, const Timer& deadline);
+
+  // Removes the timers expired at |now| and makes their Commands
+  // active.
+  void advance(const Timer& now);
+
+  // Removes all timers without making their Commands active.
+  void clear();
+
+private:
+  enum { SLOT_BITS = 6, NUM_SLOTS = 1 << SLOT_BITS, NUM_LEVELS = 4 };
+
+  uint64_t toTick(const Timer& t, bool roundUp) const;
+
+  void insert(Node* node, uint64_t expiry);
+
+  // Moves the timers in |index|-th slot of |level| to the lower
+  // levels.
+  void cascade(int level, size_t index);
+
+  Timer start_;
+  std::chrono::milliseconds tick_;
+  // The next tick to be processed.
+  uint64_t base_;
+  // The sentinels of the circular lists.
+  Node slots_[NUM_LEVELS][NUM_SLOTS];
+};
+
+} // namespace aria2
+
+#endif // D_TIMER_WHEEL_H
@@ -0,0 +1,318 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "ValueArena.h"
+
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+#include "a2functional.h"
+
+namespace aria2 {
+
+namespace {
+int compareKey(const ValueArena::Node& node, const char* key, size_t keylen)
+{
+  int rv = memcmp(node.str, key, std::min(node.size, keylen));
+  if (rv != 0) {
+    return rv;
+  }
+  return node.size < keylen ? -1 : node.size > keylen ? 1 : 0;
+}
+} // namespace
+
+bool ArenaValue::isString() const
+{
+  return arena_ && arena_->getNode(index_).type == ValueArena::STRING_NODE;
+}
+
+bool ArenaValue::isInteger() const
+{
+  return arena_ && arena_->getNode(index_).type == ValueArena::INTEGER_NODE;
+}
+
+bool ArenaValue::isBool() const
+{
+  return arena_ && arena_->getNode(index_).type == ValueArena::BOOL_NODE;
+}
+
+bool ArenaValue::isNull() const
+{
+  return arena_ && arena_->getNode(index_).type == ValueArena::NULL_NODE;
+}
+
+bool ArenaValue::isList() const
+{
+  return arena_ && arena_->getNode(index_).type == ValueArena::LIST_NODE;
+}
+
+bool ArenaValue::isDict() const
+{
+  return arena_ && arena_->getNode(index_).type == ValueArena::DICT_NODE;
+}
+
+const char* ArenaValue::data() const { return arena_->getNode(index_).str; }
+
+size_t ArenaValue::size() const { return arena_->getNode(index_).size; }
+
+std::string ArenaValue::s() const
+{
+  auto& node = arena_->getNode(index_);
+  return std::string(node.str, node.size);
+}
+
+bool ArenaValue::equals(const char* s, size_t len) const
+{
+  return compareKey(arena_->getNode(index_), s, len) == 0;
+}
+
+int64_t ArenaValue::i() const { return arena_->getNode(index_).integer; }
+
+bool ArenaValue::b() const { return arena_->getNode(index_).boolean; }
+
+ArenaValue ArenaValue::get(const char* key, size_t keylen) const
+{
+  if (!isDict()) {
+    return ArenaValue();
+  }
+  auto& node = arena_->getNode(index_);
+  size_t left = node.keyIndex;
+  size_t right = node.keyIndex + node.size;
+  while (left < right) {
+    size_t mid = left + (right - left) / 2;
+    size_t pos = arena_->getKeyPosition(mid);
+    int rv = compareKey(arena_->getNode(pos), key, keylen);
+    if (rv == 0) {
+      return ArenaValue(arena_, pos + 1);
+    }
+    if (rv < 0) {
+      left = mid + 1;
+    }
+    else {
+      right = mid;
+    }
+  }
+  return ArenaValue();
+}
+
+ArenaValue ArenaValue::get(const char* key) const
+{
+  return get(key, strlen(key));
+}
+
+ArenaValue ArenaValue::get(size_t index) const
+{
+  if (!isList() || index >= size()) {
+    return ArenaValue();
+  }
+  auto i = begin();
+  for (; index > 0; --index, ++i)
+    ;
+  return *i;
+}
+
+ArenaValue ArenaValue::getKey(size_t index) const
+{
+  assert(index < size());
+  return ArenaValue(
+      arena_, arena_->getKeyPosition(arena_->getNode(index_).keyIndex + index));
+}
+
+ArenaValue ArenaValue::getValue(size_t index) const
+{
+  auto key = getKey(index);
+  return ArenaValue(key.arena_, key.index_ + 1);
+}
+
+ArenaValue::ListIterator& ArenaValue::ListIterator::operator++()
+{
+  index_ = arena_->getNode(index_).next;
+  return *this;
+}
+
+ArenaValue::ListIterator ArenaValue::begin() const
+{
+  if (isList()) {
+    return ListIterator(arena_, index_ + 1);
+  }
+  return ListIterator(arena_, index_);
+}
+
+ArenaValue::ListIterator ArenaValue::end() const
+{
+  if (isList()) {
+    return ListIterator(arena_, arena_->getNode(index_).next);
+  }
+  return ListIterator(arena_, index_);
+}
+
+namespace {
+constexpr size_t MIN_BLOCK_SIZE = 4_k;
+constexpr size_t MAX_BLOCK_SIZE = 1_m;
+} // namespace
+
+ValueArena::ValueArena() : blockUsed_{0}, blockSize_{0} {}
+
+ValueArena::~ValueArena() = default;
+
+ArenaValue ValueArena::root() const
+{
+  if (nodes_.empty()) {
+    return ArenaValue();
+  }
+  return ArenaValue(this, 0);
+}
+
+void ValueArena::addNode(NodeType type)
+{
+  nodes_.emplace_back();
+  auto& node = nodes_.back();
+  node.type = type;
+  node.next = nodes_.size();
+  node.size = 0;
+  node.integer = 0;
+}
+
+void ValueArena::beginList()
+{
+  stack_.push_back(nodes_.size());
+  addNode(LIST_NODE);
+}
+
+void ValueArena::beginDict()
+{
+  stack_.push_back(nodes_.size());
+  addNode(DICT_NODE);
+}
+
+void ValueArena::endContainer()
+{
+  assert(!stack_.empty());
+  auto pos = stack_.back();
+  stack_.pop_back();
+  auto next = nodes_.size();
+  auto& node = nodes_[pos];
+  node.next = next;
+  if (node.type == LIST_NODE) {
+    for (auto i = pos + 1; i < next; i = nodes_[i].next) {
+      ++node.size;
+    }
+    return;
+  }
+  // The members of this dict are indexed after the members of all
+  // nested dicts, so they occupy the contiguous range at the end.
+  auto first = keyIndex_.size();
+  for (auto i = pos + 1; i + 1 < next; i = nodes_[i + 1].next) {
+    keyIndex_.push_back(i);
+  }
+  auto keyFirst = std::begin(keyIndex_) + first;
+  // The ties are broken by the position, so that the duplicated keys
+  // keep their order of appearance.  Unlike std::stable_sort, this
+  // does not allocate temporary buffer.
+  std::sort(keyFirst, std::end(keyIndex_), [this](size_t lhs, size_t rhs) {
+    int rv = compareKey(nodes_[lhs], nodes_[rhs].str, nodes_[rhs].size);
+    return rv < 0 || (rv == 0 && lhs < rhs);
+  });
+  // Only the last one of the duplicated keys is kept.
+  auto out = keyFirst;
+  for (auto i = keyFirst, eoi = std::end(keyIndex_); i != eoi; ++i) {
+    auto j = i + 1;
+    if (j != eoi && compareKey(nodes_[*i], nodes_[*j].str,
+                               nodes_[*j].size) == 0) {
+      continue;
+    }
+    *out++ = *i;
+  }
+  keyIndex_.erase(out, std::end(keyIndex_));
+  node.keyIndex = first;
+  node.size = keyIndex_.size() - first;
+}
+
+void ValueArena::addString(const char* data, size_t len)
+{
+  addNode(STRING_NODE);
+  auto& node = nodes_.back();
+  node.str = data;
+  node.size = len;
+}
+
+void ValueArena::addInteger(int64_t i)
+{
+  addNode(INTEGER_NODE);
+  nodes_.back().integer = i;
+}
+
+void ValueArena::addBool(bool b)
+{
+  addNode(BOOL_NODE);
+  nodes_.back().boolean = b;
+}
+
+void ValueArena::addNull() { addNode(NULL_NODE); }
+
+const char* ValueArena::copyString(const char* data, size_t len)
+{
+  if (len == 0) {
+    return "";
+  }
+  if (len > MIN_BLOCK_SIZE / 4) {
+    // Large string gets its own block, so that the space left in the
+    // current block is not wasted.
+    auto block = std::unique_ptr<char[]>(new char[len]);
+    memcpy(block.get(), data, len);
+    auto res = block.get();
+    blocks_.insert(blocks_.empty() ? std::end(blocks_)
+                                   : std::end(blocks_) - 1,
+                   std::move(block));
+    return res;
+  }
+  if (blocks_.empty() || blockSize_ - blockUsed_ < len) {
+    blockSize_ = std::min(MAX_BLOCK_SIZE,
+                          std::max(MIN_BLOCK_SIZE, blockSize_ * 2));
+    blocks_.push_back(std::unique_ptr<char[]>(new char[blockSize_]));
+    blockUsed_ = 0;
+  }
+  auto res = blocks_.back().get() + blockUsed_;
+  memcpy(res, data, len);
+  blockUsed_ += len;
+  return res;
+}
+
+void ValueArena::adoptInput(std::vector<char> input)
+{
+  input_ = std::move(input);
+}
+
+} // namespace aria2
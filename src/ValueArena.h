@@ -0,0 +1,228 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_VALUE_ARENA_H
+#define D_VALUE_ARENA_H
+
+#include "common.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace aria2 {
+
+class ValueArena;
+
+// Lightweight read-only handle to the value stored in ValueArena.
+// The handle which does not refer to any value evaluates to false.
+// It is only valid while the ValueArena it refers to is alive.
+class ArenaValue {
+public:
+  ArenaValue() : arena_{nullptr}, index_{0} {}
+  ArenaValue(const ValueArena* arena, size_t index)
+      : arena_{arena}, index_{index}
+  {
+  }
+
+  explicit operator bool() const { return arena_ != nullptr; }
+
+  bool isString() const;
+  bool isInteger() const;
+  bool isBool() const;
+  bool isNull() const;
+  bool isList() const;
+  bool isDict() const;
+
+  // Returns the pointer to the string.  The string is not
+  // NULL-terminated.
+  const char* data() const;
+  // Returns the length of the string, or the number of elements of
+  // list or dict.  For dict, the members with the duplicated key are
+  // counted as one.
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+  // Returns the copy of the string.
+  std::string s() const;
+  // Returns true if the string equals to |s|.
+  bool equals(const char* s, size_t len) const;
+
+  int64_t i() const;
+  bool b() const;
+
+  // Returns the value associated to |key| in dict.  If the key
+  // appears more than once, the last one is returned, just like
+  // Dict::put overwrites the previous value.  If this is not dict or
+  // no such key exists, returns empty handle.
+  ArenaValue get(const char* key, size_t keylen) const;
+  ArenaValue get(const std::string& key) const
+  {
+    return get(key.data(), key.size());
+  }
+  ArenaValue get(const char* key) const;
+  bool containsKey(const std::string& key) const
+  {
+    return static_cast<bool>(get(key));
+  }
+  // Returns |index|-th element of list.  This takes linear time.
+  ArenaValue get(size_t index) const;
+
+  // Returns |index|-th key and value of dict in ascending order of
+  // key.  The |index| must be less than size().
+  ArenaValue getKey(size_t index) const;
+  ArenaValue getValue(size_t index) const;
+
+  // Forward iterator over the elements of list.
+  class ListIterator {
+  public:
+    ListIterator(const ValueArena* arena, size_t index)
+        : arena_{arena}, index_{index}
+    {
+    }
+    ArenaValue operator*() const { return ArenaValue(arena_, index_); }
+    ListIterator& operator++();
+    bool operator==(const ListIterator& other) const
+    {
+      return index_ == other.index_;
+    }
+    bool operator!=(const ListIterator& other) const
+    {
+      return index_ != other.index_;
+    }
+
+  private:
+    const ValueArena* arena_;
+    size_t index_;
+  };
+
+  // If this is not list, begin() == end().
+  ListIterator begin() const;
+  ListIterator end() const;
+
+private:
+  const ValueArena* arena_;
+  size_t index_;
+};
+
+// Stores the tree of values, which has the same data model as
+// ValueBase, in a few contiguous buffers.  The nodes are laid out in
+// pre-order in a single vector, and each container node knows where
+// its subtree ends.  The members of dict are indexed by a sorted
+// vector of key positions.  The strings are not copied if they are in
+// the input buffer given to the parser; otherwise they are copied to
+// the block allocated storage owned by this object.  Therefore,
+// building the tree does not require per-value heap allocation.
+class ValueArena {
+public:
+  enum NodeType {
+    STRING_NODE,
+    INTEGER_NODE,
+    BOOL_NODE,
+    NULL_NODE,
+    LIST_NODE,
+    DICT_NODE
+  };
+
+  struct Node {
+    NodeType type;
+    // The position of the node which follows the subtree rooted at
+    // this node.
+    size_t next;
+    // The length of string, or the number of elements of list and
+    // dict.
+    size_t size;
+    union {
+      const char* str;
+      int64_t integer;
+      bool boolean;
+      // For dict, the offset in the key index where the sorted
+      // member positions start.
+      size_t keyIndex;
+    };
+  };
+
+  ValueArena();
+  ~ValueArena();
+
+  ValueArena(const ValueArena&) = delete;
+  ValueArena& operator=(const ValueArena&) = delete;
+
+  // Returns the handle to the root value.  If nothing is stored,
+  // returns empty handle.
+  ArenaValue root() const;
+
+  bool empty() const { return nodes_.empty(); }
+
+  // The functions below are used to build the tree.  The values
+  // added between beginList()/beginDict() and endContainer() become
+  // the elements of the container.  The members of dict are added as
+  // the sequence of key string and value.
+  void beginList();
+  void beginDict();
+  void endContainer();
+  // Adds string.  The |data| is not copied, so it must outlive this
+  // object.  Use copyString() to make the copy owned by this object.
+  void addString(const char* data, size_t len);
+  void addInteger(int64_t i);
+  void addBool(bool b);
+  void addNull();
+  // Copies |len| bytes of |data| to the storage owned by this object
+  // and returns the pointer to the copy.
+  const char* copyString(const char* data, size_t len);
+  // Takes the ownership of |input| so that the strings referring to
+  // it stay valid.
+  void adoptInput(std::vector<char> input);
+
+  const Node& getNode(size_t index) const { return nodes_[index]; }
+  size_t getKeyPosition(size_t index) const { return keyIndex_[index]; }
+
+private:
+  void addNode(NodeType type);
+
+  std::vector<Node> nodes_;
+  // The positions of the key nodes of each dict, sorted by key.
+  std::vector<size_t> keyIndex_;
+  // The positions of the containers being built.
+  std::vector<size_t> stack_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  // The number of bytes used in the last block.
+  size_t blockUsed_;
+  size_t blockSize_;
+  std::vector<char> input_;
+};
+
+} // namespace aria2
+
+#endif // D_VALUE_ARENA_H
@@ -0,0 +1,164 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "ValueWriter.h"
+
+#include <cassert>
+
+namespace aria2 {
+
+void ValueWriter::writeValue(const ValueBase* v)
+{
+  class Visitor : public ValueBaseVisitor {
+  public:
+    Visitor(ValueWriter& writer) : writer_(writer) {}
+
+    virtual void visit(const String& v) CXX11_OVERRIDE
+    {
+      writer_.writeString(v.s());
+    }
+
+    virtual void visit(const Integer& v) CXX11_OVERRIDE
+    {
+      writer_.writeInteger(v.i());
+    }
+
+    virtual void visit(const Bool& v) CXX11_OVERRIDE
+    {
+      writer_.writeBool(v.val());
+    }
+
+    virtual void visit(const Null& v) CXX11_OVERRIDE { writer_.writeNull(); }
+
+    virtual void visit(const List& v) CXX11_OVERRIDE
+    {
+      writer_.beginList();
+      for (const auto& e : v) {
+        e->accept(*this);
+      }
+      writer_.endList();
+    }
+
+    virtual void visit(const Dict& v) CXX11_OVERRIDE
+    {
+      writer_.beginDict();
+      for (const auto& e : v) {
+        writer_.writeKey(e.first);
+        e.second->accept(*this);
+      }
+      writer_.endDict();
+    }
+
+  private:
+    ValueWriter& writer_;
+  };
+
+  Visitor visitor(*this);
+  v->accept(visitor);
+}
+
+ValueBaseWriter::ValueBaseWriter() = default;
+
+ValueBaseWriter::ValueBaseWriter(Dict* dict)
+{
+  stack_.push_back(Frame{dict, nullptr});
+}
+
+ValueBaseWriter::ValueBaseWriter(List* list)
+{
+  stack_.push_back(Frame{nullptr, list});
+}
+
+ValueBase* ValueBaseWriter::add(std::unique_ptr<ValueBase> v)
+{
+  auto p = v.get();
+  if (stack_.empty()) {
+    assert(!result_);
+    result_ = std::move(v);
+  }
+  else if (stack_.back().dict) {
+    stack_.back().dict->put(std::move(key_), std::move(v));
+    key_.clear();
+  }
+  else {
+    stack_.back().list->append(std::move(v));
+  }
+  return p;
+}
+
+void ValueBaseWriter::beginDict()
+{
+  auto dict = static_cast<Dict*>(add(Dict::g()));
+  stack_.push_back(Frame{dict, nullptr});
+}
+
+void ValueBaseWriter::endDict()
+{
+  assert(!stack_.empty() && stack_.back().dict);
+  stack_.pop_back();
+}
+
+void ValueBaseWriter::beginList()
+{
+  auto list = static_cast<List*>(add(List::g()));
+  stack_.push_back(Frame{nullptr, list});
+}
+
+void ValueBaseWriter::endList()
+{
+  assert(!stack_.empty() && stack_.back().list);
+  stack_.pop_back();
+}
+
+void ValueBaseWriter::writeKey(const std::string& key) { key_ = key; }
+
+void ValueBaseWriter::writeString(const std::string& s) { add(String::g(s)); }
+
+void ValueBaseWriter::writeInteger(int64_t i) { add(Integer::g(i)); }
+
+void ValueBaseWriter::writeBool(bool b)
+{
+  add(b ? Bool::gTrue() : Bool::gFalse());
+}
+
+void ValueBaseWriter::writeNull() { add(Null::g()); }
+
+void ValueBaseWriter::writeEncoded(const std::string& data) { assert(0); }
+
+std::unique_ptr<ValueBase> ValueBaseWriter::getResult()
+{
+  return std::move(result_);
+}
+
+} // namespace aria2
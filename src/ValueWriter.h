@@ -0,0 +1,127 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_VALUE_WRITER_H
+#define D_VALUE_WRITER_H
+
+#include "common.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "ValueBase.h"
+
+namespace aria2 {
+
+// Writes a value of the same data model as ValueBase piece by piece,
+// so that a large value can be serialized as it is produced, without
+// building ValueBase objects first.  In a dict, each value must be
+// preceded by a call of writeKey().  Begin and end calls must be
+// balanced.
+class ValueWriter {
+public:
+  virtual ~ValueWriter() = default;
+
+  virtual void beginDict() = 0;
+  virtual void endDict() = 0;
+  virtual void beginList() = 0;
+  virtual void endList() = 0;
+  virtual void writeKey(const std::string& key) = 0;
+  virtual void writeString(const std::string& s) = 0;
+  virtual void writeInteger(int64_t i) = 0;
+  virtual void writeBool(bool b) = 0;
+  virtual void writeNull() = 0;
+
+  // Writes data, which is a value already serialized by the same kind
+  // of writer.  Not all writers support this.
+  virtual void writeEncoded(const std::string& data) = 0;
+
+  // Writes v by calling the other functions.
+  void writeValue(const ValueBase* v);
+
+  // Shorthand for writeKey() followed by writeString().
+  void put(const std::string& key, const std::string& s)
+  {
+    writeKey(key);
+    writeString(s);
+  }
+};
+
+// ValueWriter which builds ValueBase.
+class ValueBaseWriter : public ValueWriter {
+public:
+  // The written value is obtained by getResult().
+  ValueBaseWriter();
+
+  // Writes members to dict, which must outlive this object.  The
+  // first call must be writeKey().
+  ValueBaseWriter(Dict* dict);
+
+  // Writes elements to list, which must outlive this object.
+  ValueBaseWriter(List* list);
+
+  virtual void beginDict() CXX11_OVERRIDE;
+  virtual void endDict() CXX11_OVERRIDE;
+  virtual void beginList() CXX11_OVERRIDE;
+  virtual void endList() CXX11_OVERRIDE;
+  virtual void writeKey(const std::string& key) CXX11_OVERRIDE;
+  virtual void writeString(const std::string& s) CXX11_OVERRIDE;
+  virtual void writeInteger(int64_t i) CXX11_OVERRIDE;
+  virtual void writeBool(bool b) CXX11_OVERRIDE;
+  virtual void writeNull() CXX11_OVERRIDE;
+
+  // Not supported.  Must not be called.
+  virtual void writeEncoded(const std::string& data) CXX11_OVERRIDE;
+
+  std::unique_ptr<ValueBase> getResult();
+
+private:
+  // Stores v to the current container, or to result_ if there is
+  // none.  Returns raw pointer of v.
+  ValueBase* add(std::unique_ptr<ValueBase> v);
+
+  struct Frame {
+    Dict* dict;
+    List* list;
+  };
+
+  std::vector<Frame> stack_;
+  std::string key_;
+  std::unique_ptr<ValueBase> result_;
+};
+
+} // namespace aria2
+
+#endif // D_VALUE_WRITER_H
@@ -0,0 +1,118 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "WakeupFd.h"
+
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif // HAVE_SYS_EVENTFD_H
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif // HAVE_FCNTL_H
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif // HAVE_UNISTD_H
+
+#include <cerrno>
+
+#include "DlAbortEx.h"
+#include "util.h"
+#include "fmt.h"
+
+namespace aria2 {
+
+WakeupFd::WakeupFd()
+{
+  fd_[0] = fd_[1] = (sock_t)-1;
+#if defined(HAVE_SYS_EVENTFD_H)
+  fd_[0] = fd_[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (fd_[0] == -1) {
+    int errNum = errno;
+    throw DL_ABORT_EX(fmt("Failed to create eventfd. cause: %s",
+                          util::safeStrerror(errNum).c_str()));
+  }
+#elif !defined(__MINGW32__)
+  if (pipe(fd_) == -1) {
+    int errNum = errno;
+    throw DL_ABORT_EX(fmt("Failed to create pipe. cause: %s",
+                          util::safeStrerror(errNum).c_str()));
+  }
+  for (auto fd : fd_) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+  }
+#endif
+}
+
+WakeupFd::~WakeupFd()
+{
+#ifndef __MINGW32__
+  if (fd_[0] != -1) {
+    ::close(fd_[0]);
+  }
+  if (fd_[1] != fd_[0]) {
+    ::close(fd_[1]);
+  }
+#endif // !__MINGW32__
+}
+
+void WakeupFd::notify()
+{
+#if defined(HAVE_SYS_EVENTFD_H)
+  uint64_t n = 1;
+  while (write(fd_[1], &n, sizeof(n)) == -1 && errno == EINTR)
+    ;
+#elif !defined(__MINGW32__)
+  char c = 0;
+  while (write(fd_[1], &c, sizeof(c)) == -1 && errno == EINTR)
+    ;
+#endif
+}
+
+void WakeupFd::clear()
+{
+#if defined(HAVE_SYS_EVENTFD_H)
+  uint64_t n;
+  while (read(fd_[0], &n, sizeof(n)) == -1 && errno == EINTR)
+    ;
+#elif !defined(__MINGW32__)
+  char buf[64];
+  ssize_t nread;
+  while ((nread = read(fd_[0], buf, sizeof(buf))) > 0 ||
+         (nread == -1 && errno == EINTR))
+    ;
+#endif
+}
+
+} // namespace aria2
@@ -0,0 +1,73 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_WAKEUP_FD_H
+#define D_WAKEUP_FD_H
+
+#include "common.h"
+
+#include "a2netcompat.h"
+
+namespace aria2 {
+
+// The file descriptor which another thread makes readable in order to
+// wake up the event polling of DownloadEngine.  eventfd is used if
+// available, otherwise pipe.  On Windows, there is no wakeup file
+// descriptor, and getFd() returns -1.
+class WakeupFd {
+public:
+  WakeupFd();
+  ~WakeupFd();
+
+  WakeupFd(const WakeupFd&) = delete;
+  WakeupFd& operator=(const WakeupFd&) = delete;
+
+  // Makes the file descriptor readable.  This function can be called
+  // from any thread.
+  void notify();
+
+  // Makes the file descriptor unreadable.
+  void clear();
+
+  sock_t getFd() const { return fd_[0]; }
+
+private:
+  // For eventfd, fd_[0] == fd_[1].  For pipe, the read end and the
+  // write end.
+  sock_t fd_[2];
+};
+
+} // namespace aria2
+
+#endif // D_WAKEUP_FD_H
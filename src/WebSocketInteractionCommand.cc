@@ -68,6 +68,7 @@ WebSocketInteractionCommand::~WebSocketInteractionCommand()
     e_->deleteSocketForWriteCheck(socket_, this);
   }
   e_->getWebSocketSessionMan()->removeSession(wsSession_);
+  wsSession_->unsubscribe();
 }
 
 void WebSocketInteractionCommand::updateWriteCheck()
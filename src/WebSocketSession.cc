@@ -44,6 +44,8 @@
 #include "message.h"
 #include "DownloadEngine.h"
 #include "DelayedCommand.h"
+#include "TimeBasedCommand.h"
+#include "StatusSubscription.h"
 #include "WebSocketInteractionCommand.h"
 #include "rpc_helper.h"
 #include "RpcResponse.h"
@@ -175,8 +177,9 @@ void onMsgRecvCallback(wslay_event_context_ptr wsctx,
     }
     Dict* jsondict = downcast<Dict>(json);
     auto e = wsSession->getDownloadEngine();
+    auto& session = wsSession->getCommand()->getSession();
     if (jsondict) {
-      RpcResponse res = processJsonRpcRequest(jsondict, e);
+      RpcResponse res = processJsonRpcRequest(jsondict, e, session);
       addResponse(wsSession, res);
     }
     else {
@@ -189,7 +192,7 @@ void onMsgRecvCallback(wslay_event_context_ptr wsctx,
              i != eoi; ++i) {
           Dict* jsondict = downcast<Dict>(*i);
           if (jsondict) {
-            auto resp = processJsonRpcRequest(jsondict, e);
+            auto resp = processJsonRpcRequest(jsondict, e, session);
             results.push_back(std::move(resp));
           }
         }
@@ -298,6 +301,67 @@ void WebSocketSession::addTextMessage(const std::string& msg, bool delayed)
   wslay_event_queue_msg(wsctx_, &arg);
 }
 
+namespace {
+class StatusSubscriptionCommand : public TimeBasedCommand {
+private:
+  std::weak_ptr<WebSocketSession> session_;
+  std::weak_ptr<StatusSubscription> subscription_;
+
+public:
+  StatusSubscriptionCommand(cuid_t cuid, DownloadEngine* e,
+                            std::weak_ptr<WebSocketSession> session,
+                            std::weak_ptr<StatusSubscription> subscription,
+                            std::chrono::seconds interval)
+      : TimeBasedCommand(cuid, e, std::move(interval)),
+        session_{std::move(session)},
+        subscription_{std::move(subscription)}
+  {
+  }
+
+  virtual void preProcess() CXX11_OVERRIDE
+  {
+    if (getDownloadEngine()->isHaltRequested() || subscription_.expired()) {
+      enableExit();
+    }
+  }
+
+  virtual void process() CXX11_OVERRIDE
+  {
+    auto session = session_.lock();
+    auto subscription = subscription_.lock();
+    if (!session || !subscription) {
+      enableExit();
+      return;
+    }
+    auto msg = subscription->createNotification(getDownloadEngine());
+    if (!msg.empty()) {
+      session->addTextMessage(msg, false);
+      session->getCommand()->updateWriteCheck();
+    }
+  }
+};
+} // namespace
+
+void WebSocketSession::subscribe(
+    std::unique_ptr<StatusSubscription> subscription,
+    std::chrono::seconds interval)
+{
+  subscription_ = std::move(subscription);
+  auto e = getDownloadEngine();
+  e->addCommand(make_unique<StatusSubscriptionCommand>(
+      e->newCUID(), e, command_->getSession(), subscription_,
+      std::move(interval)));
+}
+
+bool WebSocketSession::unsubscribe()
+{
+  if (!subscription_) {
+    return false;
+  }
+  subscription_.reset();
+  return true;
+}
+
 bool WebSocketSession::closeReceived()
 {
   return wslay_event_get_close_received(wsctx_);
@@ -38,6 +38,7 @@
 #include "common.h"
 
 #include <memory>
+#include <chrono>
 
 #include <wslay/wslay.h>
 
@@ -51,6 +52,7 @@ class DownloadEngine;
 namespace rpc {
 
 class WebSocketInteractionCommand;
+class StatusSubscription;
 
 class WebSocketSession {
 public:
@@ -88,6 +90,13 @@ public:
   // this function resets parser state and receivedLength_.
   std::unique_ptr<ValueBase> parseFinal(const uint8_t* data, size_t len,
                                         ssize_t& error);
+  // Starts sending the notification created by |subscription| every
+  // |interval|.  The previous subscription, if any, is cancelled.
+  void subscribe(std::unique_ptr<StatusSubscription> subscription,
+                 std::chrono::seconds interval);
+  // Cancels the subscription.  Returns false if there is no
+  // subscription.
+  bool unsubscribe();
 
   const std::shared_ptr<SocketCore>& getSocket() const { return socket_; }
 
@@ -109,6 +118,7 @@ private:
   int32_t receivedLength_;
   json::ValueBaseJsonParser parser_;
   WebSocketInteractionCommand* command_;
+  std::shared_ptr<StatusSubscription> subscription_;
 };
 
 } // namespace rpc
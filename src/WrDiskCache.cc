@@ -42,7 +42,47 @@
 
 namespace aria2 {
 
-WrDiskCache::WrDiskCache(size_t limit) : limit_(limit), total_(0), clock_(0) {}
+const size_t WrDiskCache::CELL_BUFFER_SIZE;
+const int WrDiskCache::NUM_SIZE_CLASS;
+
+WrDiskCache::WrDiskCache(size_t limit)
+    : limit_(limit),
+      total_(0),
+#ifdef ENABLE_THREADS
+      sharedTotal_(nullptr),
+#endif // ENABLE_THREADS
+      lists_(),
+      classMask_(0)
+{
+}
+
+#ifdef ENABLE_THREADS
+void WrDiskCache::shareTotal(std::atomic<size_t>* sharedTotal)
+{
+  assert(total_ == 0);
+  sharedTotal_ = sharedTotal;
+}
+#endif // ENABLE_THREADS
+
+void WrDiskCache::addTotal(ssize_t delta)
+{
+  total_ += delta;
+#ifdef ENABLE_THREADS
+  if (sharedTotal_) {
+    sharedTotal_->fetch_add(delta, std::memory_order_relaxed);
+  }
+#endif // ENABLE_THREADS
+}
+
+size_t WrDiskCache::getLimitedTotal() const
+{
+#ifdef ENABLE_THREADS
+  if (sharedTotal_) {
+    return sharedTotal_->load(std::memory_order_relaxed);
+  }
+#endif // ENABLE_THREADS
+  return total_;
+}
 
 WrDiskCache::~WrDiskCache()
 {
@@ -50,79 +90,153 @@ WrDiskCache::~WrDiskCache()
     A2_LOG_WARN(fmt("Write disk cache is not empty size=%lu",
                     static_cast<unsigned long>(total_)));
   }
+  for (auto& l : lists_) {
+    for (auto ent = l.head; ent; ent = ent->next_) {
+      ent->cache_ = nullptr;
+    }
+  }
+  for (auto buf : freeBuffers_) {
+    delete[] buf;
+  }
 }
 
-bool WrDiskCache::add(WrDiskCacheEntry* ent)
+int WrDiskCache::getSizeClass(size_t size)
 {
-  ent->setSizeKey(ent->getSize());
-  ent->setLastUpdate(++clock_);
-  std::pair<EntrySet::iterator, bool> rv = set_.insert(ent);
-  if (rv.second) {
-    total_ += ent->getSize();
-    ensureLimit();
-    return true;
+  int c = 0;
+  for (; size && c < NUM_SIZE_CLASS - 1; size >>= 1, ++c)
+    ;
+  return c;
+}
+
+void WrDiskCache::link(WrDiskCacheEntry* ent)
+{
+  auto c = getSizeClass(ent->getSize());
+  auto& l = lists_[c];
+  ent->sizeClass_ = c;
+  ent->prev_ = l.tail;
+  ent->next_ = nullptr;
+  if (l.tail) {
+    l.tail->next_ = ent;
   }
   else {
-    A2_LOG_WARN(fmt("Found duplicate cache entry a.{size=%lu,clock=%" PRId64
-                    "} b{size=%lu,clock=%" PRId64 "}",
-                    static_cast<unsigned long>((*rv.first)->getSize()),
-                    (*rv.first)->getLastUpdate(),
-                    static_cast<unsigned long>(ent->getSize()),
-                    ent->getLastUpdate()));
-    return false;
+    l.head = ent;
+    classMask_ |= static_cast<uint64_t>(1) << c;
   }
+  l.tail = ent;
 }
 
-bool WrDiskCache::remove(WrDiskCacheEntry* ent)
+void WrDiskCache::unlink(WrDiskCacheEntry* ent)
 {
-  if (set_.erase(ent)) {
-    A2_LOG_DEBUG(fmt("Removed cache entry size=%lu, clock=%" PRId64,
-                     static_cast<unsigned long>(ent->getSize()),
-                     ent->getLastUpdate()));
-    total_ -= ent->getSize();
-    return true;
+  auto c = ent->sizeClass_;
+  auto& l = lists_[c];
+  if (ent->prev_) {
+    ent->prev_->next_ = ent->next_;
+  }
+  else {
+    l.head = ent->next_;
+  }
+  if (ent->next_) {
+    ent->next_->prev_ = ent->prev_;
   }
   else {
+    l.tail = ent->prev_;
+  }
+  ent->prev_ = ent->next_ = nullptr;
+  if (!l.head) {
+    classMask_ &= ~(static_cast<uint64_t>(1) << c);
+  }
+}
+
+bool WrDiskCache::add(WrDiskCacheEntry* ent)
+{
+  if (ent->cache_) {
+    A2_LOG_WARN(fmt("Found duplicate cache entry size=%lu",
+                    static_cast<unsigned long>(ent->getSize())));
+    return false;
+  }
+  ent->cache_ = this;
+  link(ent);
+  addTotal(ent->getSize());
+  ensureLimit();
+  return true;
+}
+
+bool WrDiskCache::remove(WrDiskCacheEntry* ent)
+{
+  if (ent->cache_ != this) {
     return false;
   }
+  A2_LOG_DEBUG(fmt("Removed cache entry size=%lu",
+                   static_cast<unsigned long>(ent->getSize())));
+  unlink(ent);
+  ent->cache_ = nullptr;
+  addTotal(-static_cast<ssize_t>(ent->getSize()));
+  return true;
 }
 
 bool WrDiskCache::update(WrDiskCacheEntry* ent, ssize_t delta)
 {
-  if (!set_.erase(ent)) {
+  if (ent->cache_ != this) {
     return false;
   }
-  A2_LOG_DEBUG(fmt("Update cache entry size=%lu, delta=%ld, clock=%" PRId64,
+  A2_LOG_DEBUG(fmt("Update cache entry size=%lu, delta=%ld",
                    static_cast<unsigned long>(ent->getSize()),
-                   static_cast<long>(delta), ent->getLastUpdate()));
+                   static_cast<long>(delta)));
 
-  ent->setSizeKey(ent->getSize());
-  ent->setLastUpdate(++clock_);
-  set_.insert(ent);
+  unlink(ent);
+  link(ent);
 
   if (delta < 0) {
     assert(total_ >= static_cast<size_t>(-delta));
   }
-  total_ += delta;
+  addTotal(delta);
   ensureLimit();
   return true;
 }
 
 void WrDiskCache::ensureLimit()
 {
-  while (total_ > limit_) {
-    auto i = set_.begin();
-    WrDiskCacheEntry* ent = *i;
-    A2_LOG_DEBUG(fmt("Force flush cache entry size=%lu, clock=%" PRId64,
-                     static_cast<unsigned long>(ent->getSizeKey()),
-                     ent->getLastUpdate()));
-    total_ -= ent->getSize();
+  // With the shared total, the bytes over the limit may be held by
+  // the other caches.  Then this cache gives up all of its own.
+  while (total_ > 0 && getLimitedTotal() > limit_) {
+    assert(classMask_);
+    int c = NUM_SIZE_CLASS - 1;
+    for (; !(classMask_ & (static_cast<uint64_t>(1) << c)); --c)
+      ;
+    WrDiskCacheEntry* ent = lists_[c].head;
+    A2_LOG_DEBUG(fmt("Force flush cache entry size=%lu",
+                     static_cast<unsigned long>(ent->getSize())));
+    addTotal(-static_cast<ssize_t>(ent->getSize()));
+    unlink(ent);
     ent->writeToDisk();
-    set_.erase(i);
+    link(ent);
+  }
+}
 
-    ent->setSizeKey(ent->getSize());
-    ent->setLastUpdate(++clock_);
-    set_.insert(ent);
+unsigned char* WrDiskCache::allocateBuffer(size_t len, size_t* capacity)
+{
+  if (len > CELL_BUFFER_SIZE) {
+    *capacity = len;
+    return new unsigned char[len];
+  }
+  *capacity = CELL_BUFFER_SIZE;
+  if (freeBuffers_.empty()) {
+    return new unsigned char[CELL_BUFFER_SIZE];
+  }
+  auto buf = freeBuffers_.back();
+  freeBuffers_.pop_back();
+  return buf;
+}
+
+void WrDiskCache::releaseBuffer(unsigned char* buf, size_t capacity)
+{
+  // Keep at most the number of buffers which the cache can hold.
+  if (capacity == CELL_BUFFER_SIZE &&
+      freeBuffers_.size() < limit_ / CELL_BUFFER_SIZE) {
+    freeBuffers_.push_back(buf);
+  }
+  else {
+    delete[] buf;
   }
 }
 
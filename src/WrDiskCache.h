@@ -37,7 +37,10 @@
 
 #include "common.h"
 
-#include <set>
+#include <vector>
+#ifdef ENABLE_THREADS
+#include <atomic>
+#endif // ENABLE_THREADS
 
 #include "a2functional.h"
 
@@ -64,14 +67,63 @@ public:
   void ensureLimit();
   size_t getSize() const { return total_; }
 
+#ifdef ENABLE_THREADS
+  // Makes the limit apply to |*sharedTotal|, the number of bytes
+  // cached by all caches sharing it, instead of the bytes in this
+  // cache.  Each cache still evicts only its own entries, because
+  // they are written by the thread owning the cache.  This must be
+  // called while this cache is empty.
+  void shareTotal(std::atomic<size_t>* sharedTotal);
+#endif // ENABLE_THREADS
+
+  // Returns the buffer which can hold at least |len| bytes for a data
+  // cell.  The capacity of the buffer is stored in |*capacity|.  The
+  // buffer of CELL_BUFFER_SIZE bytes is taken from the pool if
+  // available.
+  unsigned char* allocateBuffer(size_t len, size_t* capacity);
+  // Releases |buf| of |capacity| bytes, which must be allocated by
+  // new[].  The buffer of CELL_BUFFER_SIZE bytes is kept in the pool
+  // for reuse.
+  void releaseBuffer(unsigned char* buf, size_t capacity);
+  size_t getNumPooledBuffer() const { return freeBuffers_.size(); }
+
+  // The size of data cell buffers pooled.  This is the block size of
+  // BitTorrent.
+  static const size_t CELL_BUFFER_SIZE = 16_k;
+
 private:
-  typedef std::set<WrDiskCacheEntry*, DerefLess<WrDiskCacheEntry*>> EntrySet;
+  // Entries are classified by the bit length of their cache size.
+  // Each class is a doubly linked list of entries, ordered from the
+  // least recently updated one.  ensureLimit() evicts the least
+  // recently updated entry in the largest class first.
+  static const int NUM_SIZE_CLASS = 64;
+
+  struct EntryList {
+    WrDiskCacheEntry* head;
+    WrDiskCacheEntry* tail;
+  };
+
+  static int getSizeClass(size_t size);
+  // Appends |ent| to the tail of the list of its size class.
+  void link(WrDiskCacheEntry* ent);
+  void unlink(WrDiskCacheEntry* ent);
+  // Adds |delta| to total_ and the shared total, if any.
+  void addTotal(ssize_t delta);
+  // Returns the number of bytes the limit is applied to.
+  size_t getLimitedTotal() const;
+
   // Maximum number of bytes the storage can cache.
   size_t limit_;
   // Current number of bytes cached.
   size_t total_;
-  EntrySet set_;
-  int64_t clock_;
+#ifdef ENABLE_THREADS
+  std::atomic<size_t>* sharedTotal_;
+#endif // ENABLE_THREADS
+  EntryList lists_[NUM_SIZE_CLASS];
+  // The bit i is set if lists_[i] is not empty.
+  uint64_t classMask_;
+  // Pool of buffers of CELL_BUFFER_SIZE bytes.
+  std::vector<unsigned char*> freeBuffers_;
 };
 
 } // namespace aria2
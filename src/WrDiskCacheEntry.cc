@@ -37,6 +37,7 @@
 #include <cstring>
 
 #include "DiskAdaptor.h"
+#include "WrDiskCache.h"
 #include "RecoverableException.h"
 #include "DownloadFailureException.h"
 #include "LogFactory.h"
@@ -46,8 +47,10 @@ namespace aria2 {
 
 WrDiskCacheEntry::WrDiskCacheEntry(
     const std::shared_ptr<DiskAdaptor>& diskAdaptor)
-    : sizeKey_(0),
-      lastUpdate_(0),
+    : cache_(nullptr),
+      prev_(nullptr),
+      next_(nullptr),
+      sizeClass_(0),
       size_(0),
       error_(CACHE_ERR_SUCCESS),
       errorCode_(error_code::UNDEFINED),
@@ -67,7 +70,12 @@ WrDiskCacheEntry::~WrDiskCacheEntry()
 void WrDiskCacheEntry::deleteDataCells()
 {
   for (auto& e : set_) {
-    delete[] e->data;
+    if (cache_) {
+      cache_->releaseBuffer(e->data, e->offset + e->capacity);
+    }
+    else {
+      delete[] e->data;
+    }
     delete e;
   }
   set_.clear();
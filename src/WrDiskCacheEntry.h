@@ -81,15 +81,6 @@ public:
   size_t append(int64_t goff, const unsigned char* data, size_t len);
 
   size_t getSize() const { return size_; }
-  void setSizeKey(size_t sizeKey) { sizeKey_ = sizeKey; }
-  size_t getSizeKey() const { return sizeKey_; }
-  void setLastUpdate(int64_t clock) { lastUpdate_ = clock; }
-  int64_t getLastUpdate() const { return lastUpdate_; }
-  bool operator<(const WrDiskCacheEntry& rhs) const
-  {
-    return sizeKey_ > rhs.sizeKey_ ||
-           (sizeKey_ == rhs.sizeKey_ && lastUpdate_ < rhs.lastUpdate_);
-  }
 
   enum { CACHE_ERR_SUCCESS, CACHE_ERR_ERROR };
 
@@ -99,10 +90,17 @@ public:
   const DataCellSet& getDataSet() const { return set_; }
 
 private:
+  friend class WrDiskCache;
+
   void deleteDataCells();
 
-  size_t sizeKey_;
-  int64_t lastUpdate_;
+  // The cache this entry is added to.  The buffers of data cells are
+  // released to its pool.
+  WrDiskCache* cache_;
+  // Links in the list of WrDiskCache.
+  WrDiskCacheEntry* prev_;
+  WrDiskCacheEntry* next_;
+  int sizeClass_;
 
   size_t size_;
 
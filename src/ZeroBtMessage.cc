@@ -43,15 +43,21 @@ ZeroBtMessage::ZeroBtMessage(uint8_t id, const char* name)
 }
 
 std::vector<unsigned char> ZeroBtMessage::createMessage()
+{
+  auto msg = std::vector<unsigned char>(MESSAGE_LENGTH);
+  writeMessage(msg.data());
+  return msg;
+}
+
+size_t ZeroBtMessage::writeMessage(unsigned char* buf)
 {
   /**
    * len --- 1, 4bytes
    * id --- ?, 1byte
    * total: 5bytes
    */
-  auto msg = std::vector<unsigned char>(MESSAGE_LENGTH);
-  bittorrent::createPeerMessageString(msg.data(), MESSAGE_LENGTH, 1, getId());
-  return msg;
+  bittorrent::createPeerMessageString(buf, MESSAGE_LENGTH, 1, getId());
+  return MESSAGE_LENGTH;
 }
 
 std::string ZeroBtMessage::toString() const { return getName(); }
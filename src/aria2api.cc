@@ -58,6 +58,8 @@
 #include "RpcMethodImpl.h"
 #include "console.h"
 #include "KeepRunningCommand.h"
+#include "ApiTaskCommand.h"
+#include "ApiTaskQueue.h"
 #include "A2STR.h"
 #include "SingletonHolder.h"
 #include "Notifier.h"
@@ -68,8 +70,14 @@
 
 namespace aria2 {
 
+namespace {
+// The capacity of the queue for postTask()
+const size_t TASK_QUEUE_CAPACITY = 4096;
+} // namespace
+
 Session::Session(const KeyVals& options)
-    : context(std::make_shared<Context>(false, 0, nullptr, options))
+    : taskQueue(make_unique<ApiTaskQueue>(TASK_QUEUE_CAPACITY)),
+      context(std::make_shared<Context>(false, 0, nullptr, options))
 {
 }
 
@@ -126,6 +134,8 @@ Session* sessionNew(const KeyVals& options, const SessionConfig& config)
       return nullptr;
     }
     auto& e = session->context->reqinfo->getDownloadEngine();
+    e->addCommand(
+        make_unique<ApiTaskCommand>(e->newCUID(), e.get(), session.get()));
     if (config.keepRunning) {
       e->getRequestGroupMan()->setKeepRunning(true);
       // Add command to make aria2 keep event polling
@@ -172,6 +182,11 @@ int shutdown(Session* session, bool force)
   return 0;
 }
 
+int postTask(Session* session, Task task)
+{
+  return session->taskQueue->push(task) ? 0 : -1;
+}
+
 std::string gidToHex(A2Gid gid) { return GroupId::toHex(gid); }
 
 A2Gid hexToGid(const std::string& hex)
@@ -45,10 +45,13 @@ namespace aria2 {
 
 struct Context;
 class ApiCallbackDownloadEventListener;
+class ApiTaskQueue;
 
 struct Session {
   Session(const KeyVals& options);
   ~Session();
+  // Declared first, so that it outlives ApiTaskCommand in context.
+  std::unique_ptr<ApiTaskQueue> taskQueue;
   std::shared_ptr<Context> context;
   std::unique_ptr<ApiCallbackDownloadEventListener> listener;
 };
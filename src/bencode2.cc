@@ -35,6 +35,7 @@
 #include "bencode2.h"
 
 #include <sstream>
+#include <array>
 
 #include "fmt.h"
 #include "DlAbortEx.h"
@@ -42,6 +43,7 @@
 #include "BufferedFile.h"
 #include "util.h"
 #include "ValueBaseBencodeParser.h"
+#include "ArenaStructParserStateMachine.h"
 
 namespace aria2 {
 
@@ -125,6 +127,89 @@ std::string encode(const ValueBase* vlb)
   return visitor.getResult();
 }
 
+std::unique_ptr<ValueArena> decodeArena(const unsigned char* data, size_t len)
+{
+  ssize_t error;
+  auto res = parseArena<bittorrent::BencodeParser>(
+      reinterpret_cast<const char*>(data), len, error);
+  if (error < 0) {
+    throw DL_ABORT_EX2(
+        fmt("Bencode decoding failed: error=%d", static_cast<int>(error)),
+        error_code::BENCODE_PARSE_ERROR);
+  }
+  return res;
+}
+
+std::unique_ptr<ValueArena> decodeArena(const std::string& data)
+{
+  return decodeArena(reinterpret_cast<const unsigned char*>(data.c_str()),
+                     data.size());
+}
+
+std::unique_ptr<ValueArena> decodeArenaFromFile(const std::string& filename)
+{
+  BufferedFile fp(filename.c_str(), BufferedFile::READ);
+  if (!fp) {
+    return nullptr;
+  }
+  std::vector<char> buf;
+  std::array<char, 4_k> chunk;
+  size_t nread;
+  while ((nread = fp.read(chunk.data(), chunk.size())) > 0) {
+    buf.insert(std::end(buf), std::begin(chunk), std::begin(chunk) + nread);
+  }
+  if (!fp.eof()) {
+    return nullptr;
+  }
+  ssize_t error;
+  auto res = parseArena<bittorrent::BencodeParser>(buf.data(), buf.size(),
+                                                   error);
+  if (!res) {
+    return nullptr;
+  }
+  // Moving vector does not invalidate the pointers to its elements.
+  res->adoptInput(std::move(buf));
+  return res;
+}
+
+namespace {
+void encode(std::string& out, const ArenaValue& v)
+{
+  if (v.isString()) {
+    out += util::uitos(v.size());
+    out += ':';
+    out.append(v.data(), v.size());
+  }
+  else if (v.isInteger()) {
+    out += 'i';
+    out += util::itos(v.i());
+    out += 'e';
+  }
+  else if (v.isList()) {
+    out += 'l';
+    for (auto e : v) {
+      encode(out, e);
+    }
+    out += 'e';
+  }
+  else if (v.isDict()) {
+    out += 'd';
+    for (size_t i = 0, len = v.size(); i < len; ++i) {
+      encode(out, v.getKey(i));
+      encode(out, v.getValue(i));
+    }
+    out += 'e';
+  }
+}
+} // namespace
+
+std::string encode(const ArenaValue& v)
+{
+  std::string out;
+  encode(out, v);
+  return out;
+}
+
 } // namespace bencode2
 
 } // namespace aria2
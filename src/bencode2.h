@@ -40,6 +40,7 @@
 #include <string>
 
 #include "ValueBase.h"
+#include "ValueArena.h"
 
 namespace aria2 {
 
@@ -59,6 +60,25 @@ std::unique_ptr<ValueBase> decodeFromFile(const std::string& filename);
 
 std::string encode(const ValueBase* vlb);
 
+// Decodes the data whose length is len into ValueArena.  The strings
+// in the result refer to data, so data must outlive the result.
+std::unique_ptr<ValueArena> decodeArena(const unsigned char* data,
+                                        size_t len);
+
+std::unique_ptr<ValueArena> decodeArena(const std::string& data);
+
+// The result would refer to the destroyed temporary.
+std::unique_ptr<ValueArena> decodeArena(std::string&& data) = delete;
+
+// Reads the whole content of filename and decodes it into
+// ValueArena, which owns the content.  Returns nullptr if the file
+// cannot be read or decoding failed.
+std::unique_ptr<ValueArena> decodeArenaFromFile(const std::string& filename);
+
+// Encodes v in the same way as encode(const ValueBase*) does: the
+// members of dict are written in ascending order of key.
+std::string encode(const ArenaValue& v);
+
 } // namespace bencode2
 
 } // namespace aria2
@@ -94,28 +94,74 @@ inline size_t countBit32(uint32_t n)
          cntbits[(n >> 16) & 0xffu] + cntbits[(n >> 24) & 0xffu];
 }
 
+inline size_t countBit64(uint64_t n)
+{
+#ifdef __GNUC__
+  return __builtin_popcountll(n);
+#else  // !__GNUC__
+  return countBit32(n) + countBit32(n >> 32);
+#endif // !__GNUC__
+}
+
+// Returns the number of leading 0-bits in n.  n must not be 0.
+inline size_t countLeadingZero64(uint64_t n)
+{
+  assert(n);
+#ifdef __GNUC__
+  return __builtin_clzll(n);
+#else  // !__GNUC__
+  size_t count = 0;
+  for (; !(n & (static_cast<uint64_t>(1) << 63)); n <<= 1, ++count)
+    ;
+  return count;
+#endif // !__GNUC__
+}
+
+// Returns the number of trailing 0-bits in n.  n must not be 0.
+inline size_t countTrailingZero64(uint64_t n)
+{
+  assert(n);
+#ifdef __GNUC__
+  return __builtin_ctzll(n);
+#else  // !__GNUC__
+  size_t count = 0;
+  for (; !(n & 1); n >>= 1, ++count)
+    ;
+  return count;
+#endif // !__GNUC__
+}
+
+// Returns the index-th 64 bits word of bitfield.  The bit index
+// 64*index is stored in the most significant bit of the returned
+// value, so that countLeadingZero64() gives the offset of the first
+// set bit in the word.  bitfield must have at least 8*(index+1)
+// bytes.
+inline uint64_t loadWord(const unsigned char* bitfield, size_t index)
+{
+  const unsigned char* p = bitfield + index * 8;
+  uint64_t v = 0;
+  for (size_t i = 0; i < 8; ++i) {
+    v = (v << 8) | p[i];
+  }
+  return v;
+}
+
 // Counts set bit in bitfield.
 inline size_t countSetBit(const unsigned char* bitfield, size_t nbits)
 {
   if (nbits == 0) {
     return 0;
   }
-  size_t count = 0;
-  size_t size = sizeof(uint32_t);
-  size_t len = (nbits + 7) / 8;
-  if (nbits % 32 != 0) {
-    --len;
-    count +=
-        countBit32(static_cast<uint32_t>(bitfield[len] & lastByteMask(nbits)));
-  }
-  size_t to = len / size;
+  size_t len = (nbits + 7) / 8 - 1;
+  size_t count = countBit32(bitfield[len] & lastByteMask(nbits));
+  size_t to = len / sizeof(uint64_t);
   for (size_t i = 0; i < to; ++i) {
-    uint32_t v;
-    memcpy(&v, &bitfield[i * size], sizeof(v));
-    count += countBit32(v);
+    uint64_t v;
+    memcpy(&v, &bitfield[i * sizeof(v)], sizeof(v));
+    count += countBit64(v);
   }
-  for (size_t i = len - len % size; i < len; ++i) {
-    count += countBit32(static_cast<uint32_t>(bitfield[i]));
+  for (size_t i = to * sizeof(uint64_t); i < len; ++i) {
+    count += cntbits[bitfield[i]];
   }
   return count;
 }
@@ -61,7 +61,7 @@
 #include "error_code.h"
 #include "array_fun.h"
 #include "DownloadFailureException.h"
-#include "ValueBaseBencodeParser.h"
+#include "ValueArena.h"
 
 namespace aria2 {
 
@@ -97,13 +97,13 @@ const std::string SINGLE("single");
 
 namespace {
 void extractPieceHash(const std::shared_ptr<DownloadContext>& ctx,
-                      const std::string& hashData, size_t hashLength,
+                      const char* hashData, size_t hashLength,
                       size_t numPieces)
 {
   std::vector<std::string> pieceHashes;
   pieceHashes.reserve(numPieces);
   for (size_t i = 0; i < numPieces; ++i) {
-    const char* p = hashData.data() + i * hashLength;
+    const char* p = hashData + i * hashLength;
     pieceHashes.push_back(std::string(p, p + hashLength));
   }
   ctx->setPieceHashes("sha-1", pieceHashes.begin(), pieceHashes.end());
@@ -112,47 +112,21 @@ void extractPieceHash(const std::shared_ptr<DownloadContext>& ctx,
 
 namespace {
 void extractUrlList(TorrentAttribute* torrent, std::vector<std::string>& uris,
-                    const ValueBase* v)
+                    const ArenaValue& v)
 {
-  class UrlListVisitor : public ValueBaseVisitor {
-  private:
-    std::vector<std::string>& uris_;
-    TorrentAttribute* torrent_;
-
-  public:
-    UrlListVisitor(std::vector<std::string>& uris, TorrentAttribute* torrent)
-        : uris_(uris), torrent_(torrent)
-    {
-    }
-
-    virtual void visit(const String& v) CXX11_OVERRIDE
-    {
-      std::string utf8Uri = util::encodeNonUtf8(v.s());
-      uris_.push_back(utf8Uri);
-      torrent_->urlList.push_back(utf8Uri);
-    }
-
-    virtual void visit(const Integer& v) CXX11_OVERRIDE {}
-    virtual void visit(const Bool& v) CXX11_OVERRIDE {}
-    virtual void visit(const Null& v) CXX11_OVERRIDE {}
-
-    virtual void visit(const List& v) CXX11_OVERRIDE
-    {
-      for (auto& elem : v) {
-        const String* uri = downcast<String>(elem);
-        if (uri) {
-          std::string utf8Uri = util::encodeNonUtf8(uri->s());
-          uris_.push_back(utf8Uri);
-          torrent_->urlList.push_back(utf8Uri);
-        }
+  if (v.isString()) {
+    std::string utf8Uri = util::encodeNonUtf8(v.s());
+    uris.push_back(utf8Uri);
+    torrent->urlList.push_back(utf8Uri);
+  }
+  else if (v.isList()) {
+    for (auto uri : v) {
+      if (uri.isString()) {
+        std::string utf8Uri = util::encodeNonUtf8(uri.s());
+        uris.push_back(utf8Uri);
+        torrent->urlList.push_back(utf8Uri);
       }
     }
-    virtual void visit(const Dict& v) CXX11_OVERRIDE {}
-  };
-
-  if (v) {
-    UrlListVisitor visitor(uris, torrent);
-    v->accept(visitor);
   }
 }
 } // namespace
@@ -176,7 +150,7 @@ OutputIterator createUri(InputIterator first, InputIterator last,
 
 namespace {
 void extractFileEntries(const std::shared_ptr<DownloadContext>& ctx,
-                        TorrentAttribute* torrent, const Dict* infoDict,
+                        TorrentAttribute* torrent, const ArenaValue& infoDict,
                         const std::shared_ptr<Option>& option,
                         const std::string& defaultName,
                         const std::string& overrideName,
@@ -184,19 +158,15 @@ void extractFileEntries(const std::shared_ptr<DownloadContext>& ctx,
 {
   std::string utf8Name;
   if (overrideName.empty()) {
-    std::string nameKey;
-    if (infoDict->containsKey(C_NAME_UTF8)) {
-      nameKey = C_NAME_UTF8;
-    }
-    else {
-      nameKey = C_NAME;
+    auto nameData = infoDict.get(C_NAME_UTF8);
+    if (!nameData) {
+      nameData = infoDict.get(C_NAME);
     }
-    const String* nameData = downcast<String>(infoDict->get(nameKey));
-    if (nameData) {
-      utf8Name = util::encodeNonUtf8(nameData->s());
+    if (nameData.isString()) {
+      utf8Name = util::encodeNonUtf8(nameData.s());
       if (util::detectDirTraversal(utf8Name)) {
         throw DL_ABORT_EX2(
-            fmt(MSG_DIR_TRAVERSAL_DETECTED, nameData->s().c_str()),
+            fmt(MSG_DIR_TRAVERSAL_DETECTED, nameData.s().c_str()),
             error_code::BITTORRENT_PARSE_ERROR);
       }
     }
@@ -211,59 +181,52 @@ void extractFileEntries(const std::shared_ptr<DownloadContext>& ctx,
   torrent->name = utf8Name;
   int maxConn = option->getAsInt(PREF_MAX_CONNECTION_PER_SERVER);
   std::vector<std::shared_ptr<FileEntry>> fileEntries;
-  const List* filesList = downcast<List>(infoDict->get(C_FILES));
-  if (filesList) {
-    fileEntries.reserve(filesList->size());
+  auto filesList = infoDict.get(C_FILES);
+  if (filesList.isList()) {
+    fileEntries.reserve(filesList.size());
     int64_t length = 0;
     int64_t offset = 0;
     // multi-file mode
     torrent->mode = BT_FILE_MODE_MULTI;
-    for (auto& f : *filesList) {
-      const Dict* fileDict = downcast<Dict>(f);
-      if (!fileDict) {
+    for (auto fileDict : filesList) {
+      if (!fileDict.isDict()) {
         continue;
       }
-      const Integer* fileLengthData =
-          downcast<Integer>(fileDict->get(C_LENGTH));
-      if (!fileLengthData) {
+      auto fileLengthData = fileDict.get(C_LENGTH);
+      if (!fileLengthData.isInteger()) {
         throw DL_ABORT_EX2(fmt(MSG_MISSING_BT_INFO, C_LENGTH),
                            error_code::BITTORRENT_PARSE_ERROR);
       }
 
-      if (fileLengthData->i() < 0) {
+      if (fileLengthData.i() < 0) {
         throw DL_ABORT_EX2(
-            fmt(MSG_NEGATIVE_LENGTH_BT_INFO, C_LENGTH, fileLengthData->i()),
+            fmt(MSG_NEGATIVE_LENGTH_BT_INFO, C_LENGTH, fileLengthData.i()),
             error_code::BITTORRENT_PARSE_ERROR);
       }
 
-      if (length > std::numeric_limits<int64_t>::max() - fileLengthData->i()) {
+      if (length > std::numeric_limits<int64_t>::max() - fileLengthData.i()) {
         throw DOWNLOAD_FAILURE_EXCEPTION(fmt(EX_TOO_LARGE_FILE, length));
       }
-      length += fileLengthData->i();
-      if (fileLengthData->i() > std::numeric_limits<a2_off_t>::max()) {
+      length += fileLengthData.i();
+      if (fileLengthData.i() > std::numeric_limits<a2_off_t>::max()) {
         throw DOWNLOAD_FAILURE_EXCEPTION(fmt(EX_TOO_LARGE_FILE, length));
       }
-      std::string pathKey;
-      if (fileDict->containsKey(C_PATH_UTF8)) {
-        pathKey = C_PATH_UTF8;
+      auto pathList = fileDict.get(C_PATH_UTF8);
+      if (!pathList) {
+        pathList = fileDict.get(C_PATH);
       }
-      else {
-        pathKey = C_PATH;
-      }
-      const List* pathList = downcast<List>(fileDict->get(pathKey));
-      if (!pathList || pathList->empty()) {
+      if (!pathList.isList() || pathList.empty()) {
         throw DL_ABORT_EX2("Path is empty.",
                            error_code::BITTORRENT_PARSE_ERROR);
       }
 
-      std::vector<std::string> pathelem(pathList->size() + 1);
+      std::vector<std::string> pathelem(pathList.size() + 1);
       pathelem[0] = utf8Name;
       auto pathelemOutItr = pathelem.begin();
       ++pathelemOutItr;
-      for (auto& p : *pathList) {
-        const String* elem = downcast<String>(p);
-        if (elem) {
-          (*pathelemOutItr++) = elem->s();
+      for (auto elem : pathList) {
+        if (elem.isString()) {
+          (*pathelemOutItr++) = elem.s();
         }
         else {
           throw DL_ABORT_EX2("Path element is not string.",
@@ -288,7 +251,7 @@ void extractFileEntries(const std::shared_ptr<DownloadContext>& ctx,
 
       auto fileEntry = std::make_shared<FileEntry>(
           util::applyDir(option->get(PREF_DIR), suffixPath),
-          fileLengthData->i(), offset, uris);
+          fileLengthData.i(), offset, uris);
       fileEntry->setOriginalName(utf8Path);
       fileEntry->setSuffixPath(suffixPath);
       fileEntry->setMaxConnectionPerServer(maxConn);
@@ -299,12 +262,12 @@ void extractFileEntries(const std::shared_ptr<DownloadContext>& ctx,
   else {
     // single-file mode;
     torrent->mode = BT_FILE_MODE_SINGLE;
-    const Integer* lengthData = downcast<Integer>(infoDict->get(C_LENGTH));
-    if (!lengthData) {
+    auto lengthData = infoDict.get(C_LENGTH);
+    if (!lengthData.isInteger()) {
       throw DL_ABORT_EX2(fmt(MSG_MISSING_BT_INFO, C_LENGTH),
                          error_code::BITTORRENT_PARSE_ERROR);
     }
-    int64_t totalLength = lengthData->i();
+    int64_t totalLength = lengthData.i();
 
     if (totalLength < 0) {
       throw DL_ABORT_EX2(
@@ -346,20 +309,18 @@ void extractFileEntries(const std::shared_ptr<DownloadContext>& ctx,
 } // namespace
 
 namespace {
-void extractAnnounce(TorrentAttribute* torrent, const Dict* rootDict)
+void extractAnnounce(TorrentAttribute* torrent, const ArenaValue& rootDict)
 {
-  const List* announceList = downcast<List>(rootDict->get(C_ANNOUNCE_LIST));
-  if (announceList) {
-    for (auto& elem : *announceList) {
-      const List* tier = downcast<List>(elem);
-      if (!tier) {
+  auto announceList = rootDict.get(C_ANNOUNCE_LIST);
+  if (announceList.isList()) {
+    for (auto tier : announceList) {
+      if (!tier.isList()) {
         continue;
       }
       std::vector<std::string> ntier;
-      for (auto& t : *tier) {
-        const String* uri = downcast<String>(t);
-        if (uri) {
-          ntier.push_back(util::encodeNonUtf8(util::strip(uri->s())));
+      for (auto uri : tier) {
+        if (uri.isString()) {
+          ntier.push_back(util::encodeNonUtf8(util::strip(uri.s())));
         }
       }
       if (!ntier.empty()) {
@@ -368,10 +329,10 @@ void extractAnnounce(TorrentAttribute* torrent, const Dict* rootDict)
     }
   }
   else {
-    const String* announce = downcast<String>(rootDict->get(C_ANNOUNCE));
-    if (announce) {
+    auto announce = rootDict.get(C_ANNOUNCE);
+    if (announce.isString()) {
       std::vector<std::string> tier;
-      tier.push_back(util::encodeNonUtf8(util::strip(announce->s())));
+      tier.push_back(util::encodeNonUtf8(util::strip(announce.s())));
       torrent->announceList.push_back(tier);
     }
   }
@@ -379,29 +340,27 @@ void extractAnnounce(TorrentAttribute* torrent, const Dict* rootDict)
 } // namespace
 
 namespace {
-void extractNodes(TorrentAttribute* torrent, const ValueBase* nodesListSrc)
+void extractNodes(TorrentAttribute* torrent, const ArenaValue& nodesList)
 {
-  const List* nodesList = downcast<List>(nodesListSrc);
-  if (nodesList) {
-    for (auto& elem : *nodesList) {
-      const List* addrPairList = downcast<List>(elem);
-      if (!addrPairList || addrPairList->size() != 2) {
+  if (nodesList.isList()) {
+    for (auto addrPairList : nodesList) {
+      if (!addrPairList.isList() || addrPairList.size() != 2) {
         continue;
       }
-      const String* hostname = downcast<String>(addrPairList->get(0));
-      if (!hostname) {
+      auto hostname = addrPairList.get(static_cast<size_t>(0));
+      if (!hostname.isString()) {
         continue;
       }
       std::string utf8Hostname =
-          util::encodeNonUtf8(util::strip(hostname->s()));
+          util::encodeNonUtf8(util::strip(hostname.s()));
       if (utf8Hostname.empty()) {
         continue;
       }
-      const Integer* port = downcast<Integer>(addrPairList->get(1));
-      if (!port || !(0 < port->i() && port->i() < 65536)) {
+      auto port = addrPairList.get(1);
+      if (!port.isInteger() || !(0 < port.i() && port.i() < 65536)) {
         continue;
       }
-      torrent->nodes.push_back(std::make_pair(utf8Hostname, port->i()));
+      torrent->nodes.push_back(std::make_pair(utf8Hostname, port.i()));
     }
   }
 }
@@ -409,25 +368,27 @@ void extractNodes(TorrentAttribute* torrent, const ValueBase* nodesListSrc)
 
 namespace {
 void processRootDictionary(const std::shared_ptr<DownloadContext>& ctx,
-                           const ValueBase* root,
+                           const ArenaValue& rootDict,
                            const std::shared_ptr<Option>& option,
                            const std::string& defaultName,
                            const std::string& overrideName,
                            const std::vector<std::string>& uris)
 {
-  const Dict* rootDict = downcast<Dict>(root);
-  if (!rootDict) {
+  if (!rootDict.isDict()) {
     throw DL_ABORT_EX2("torrent file does not contain a root dictionary.",
                        error_code::BITTORRENT_PARSE_ERROR);
   }
-  const Dict* infoDict = downcast<Dict>(rootDict->get(C_INFO));
-  if (!infoDict) {
+  auto infoDict = rootDict.get(C_INFO);
+  if (!infoDict.isDict()) {
     throw DL_ABORT_EX2(fmt(MSG_MISSING_BT_INFO, C_INFO),
                        error_code::BITTORRENT_PARSE_ERROR);
   }
   auto torrent = std::make_shared<TorrentAttribute>();
 
   // retrieve infoHash
+  // The info dictionary is encoded again rather than taken from the
+  // input as is, so that the infohash does not depend on the key order
+  // and duplicates in the input.
   std::string encodedInfoDict = bencode2::encode(infoDict);
   unsigned char infoHash[INFO_HASH_LENGTH];
   message_digest::digest(infoHash, INFO_HASH_LENGTH,
@@ -438,8 +399,8 @@ void processRootDictionary(const std::shared_ptr<DownloadContext>& ctx,
   torrent->metadataSize = encodedInfoDict.size();
 
   // calculate the number of pieces
-  const String* piecesData = downcast<String>(infoDict->get(C_PIECES));
-  if (!piecesData) {
+  auto piecesData = infoDict.get(C_PIECES);
+  if (!piecesData.isString()) {
     throw DL_ABORT_EX2(fmt(MSG_MISSING_BT_INFO, C_PIECES),
                        error_code::BITTORRENT_PARSE_ERROR);
   }
@@ -447,34 +408,33 @@ void processRootDictionary(const std::shared_ptr<DownloadContext>& ctx,
   //   if(piecesData.s().empty()) {
   //     throw DL_ABORT_EX("The length of piece hash is 0.");
   //   }
-  size_t numPieces = piecesData->s().size() / PIECE_HASH_LENGTH;
+  size_t numPieces = piecesData.size() / PIECE_HASH_LENGTH;
   // Commented out to download 0 length torrent.
   //   if(numPieces == 0) {
   //     throw DL_ABORT_EX("The number of pieces is 0.");
   //   }
   // retrieve piece length
-  const Integer* pieceLengthData =
-      downcast<Integer>(infoDict->get(C_PIECE_LENGTH));
-  if (!pieceLengthData) {
+  auto pieceLengthData = infoDict.get(C_PIECE_LENGTH);
+  if (!pieceLengthData.isInteger()) {
     throw DL_ABORT_EX2(fmt(MSG_MISSING_BT_INFO, C_PIECE_LENGTH),
                        error_code::BITTORRENT_PARSE_ERROR);
   }
 
-  if (pieceLengthData->i() < 0) {
+  if (pieceLengthData.i() < 0) {
     throw DL_ABORT_EX2(
-        fmt(MSG_NEGATIVE_LENGTH_BT_INFO, C_PIECE_LENGTH, pieceLengthData->i()),
+        fmt(MSG_NEGATIVE_LENGTH_BT_INFO, C_PIECE_LENGTH, pieceLengthData.i()),
         error_code::BITTORRENT_PARSE_ERROR);
   }
 
-  size_t pieceLength = pieceLengthData->i();
+  size_t pieceLength = pieceLengthData.i();
   ctx->setPieceLength(pieceLength);
   // retrieve piece hashes
-  extractPieceHash(ctx, piecesData->s(), PIECE_HASH_LENGTH, numPieces);
+  extractPieceHash(ctx, piecesData.data(), PIECE_HASH_LENGTH, numPieces);
   // private flag
-  const Integer* privateData = downcast<Integer>(infoDict->get(C_PRIVATE));
+  auto privateData = infoDict.get(C_PRIVATE);
   int privatefg = 0;
-  if (privateData) {
-    if (privateData->i() == 1) {
+  if (privateData.isInteger()) {
+    if (privateData.i() == 1) {
       privatefg = 1;
     }
   }
@@ -485,7 +445,7 @@ void processRootDictionary(const std::shared_ptr<DownloadContext>& ctx,
   // This implementation obeys HTTP-Seeding specification:
   // see http://www.getright.com/seedtorrent.html
   std::vector<std::string> urlList;
-  extractUrlList(torrent.get(), urlList, rootDict->get(C_URL_LIST));
+  extractUrlList(torrent.get(), urlList, rootDict.get(C_URL_LIST));
   urlList.insert(urlList.end(), uris.begin(), uris.end());
   std::sort(urlList.begin(), urlList.end());
   urlList.erase(std::unique(urlList.begin(), urlList.end()), urlList.end());
@@ -500,40 +460,52 @@ void processRootDictionary(const std::shared_ptr<DownloadContext>& ctx,
   // retrieve announce
   extractAnnounce(torrent.get(), rootDict);
   // retrieve nodes
-  extractNodes(torrent.get(), rootDict->get(C_NODES));
+  extractNodes(torrent.get(), rootDict.get(C_NODES));
 
-  const Integer* creationDate =
-      downcast<Integer>(rootDict->get(C_CREATION_DATE));
-  if (creationDate) {
-    torrent->creationDate = creationDate->i();
+  auto creationDate = rootDict.get(C_CREATION_DATE);
+  if (creationDate.isInteger()) {
+    torrent->creationDate = creationDate.i();
   }
-  const String* commentUtf8 = downcast<String>(rootDict->get(C_COMMENT_UTF8));
-  if (commentUtf8) {
-    torrent->comment = util::encodeNonUtf8(commentUtf8->s());
+  auto commentUtf8 = rootDict.get(C_COMMENT_UTF8);
+  if (commentUtf8.isString()) {
+    torrent->comment = util::encodeNonUtf8(commentUtf8.s());
   }
   else {
-    const String* comment = downcast<String>(rootDict->get(C_COMMENT));
-    if (comment) {
-      torrent->comment = util::encodeNonUtf8(comment->s());
+    auto comment = rootDict.get(C_COMMENT);
+    if (comment.isString()) {
+      torrent->comment = util::encodeNonUtf8(comment.s());
     }
   }
-  const String* createdBy = downcast<String>(rootDict->get(C_CREATED_BY));
-  if (createdBy) {
-    torrent->createdBy = util::encodeNonUtf8(createdBy->s());
+  auto createdBy = rootDict.get(C_CREATED_BY);
+  if (createdBy.isString()) {
+    torrent->createdBy = util::encodeNonUtf8(createdBy.s());
   }
 
   ctx->setAttribute(CTX_ATTR_BT, std::move(torrent));
 }
 } // namespace
 
+namespace {
+void processRootDictionary(const std::shared_ptr<DownloadContext>& ctx,
+                           const std::unique_ptr<ValueArena>& torrent,
+                           const std::shared_ptr<Option>& option,
+                           const std::string& defaultName,
+                           const std::string& overrideName,
+                           const std::vector<std::string>& uris)
+{
+  processRootDictionary(ctx, torrent ? torrent->root() : ArenaValue(), option,
+                        defaultName, overrideName, uris);
+}
+} // namespace
+
 void load(const std::string& torrentFile,
           const std::shared_ptr<DownloadContext>& ctx,
           const std::shared_ptr<Option>& option,
           const std::string& overrideName)
 {
-  ValueBaseBencodeParser parser;
-  processRootDictionary(ctx, parseFile(parser, torrentFile).get(), option,
-                        torrentFile, overrideName, std::vector<std::string>());
+  processRootDictionary(ctx, bencode2::decodeArenaFromFile(torrentFile),
+                        option, torrentFile, overrideName,
+                        std::vector<std::string>());
 }
 
 void load(const std::string& torrentFile,
@@ -541,9 +513,8 @@ void load(const std::string& torrentFile,
           const std::shared_ptr<Option>& option,
           const std::vector<std::string>& uris, const std::string& overrideName)
 {
-  ValueBaseBencodeParser parser;
-  processRootDictionary(ctx, parseFile(parser, torrentFile).get(), option,
-                        torrentFile, overrideName, uris);
+  processRootDictionary(ctx, bencode2::decodeArenaFromFile(torrentFile),
+                        option, torrentFile, overrideName, uris);
 }
 
 void loadFromMemory(const unsigned char* content, size_t length,
@@ -552,7 +523,7 @@ void loadFromMemory(const unsigned char* content, size_t length,
                     const std::string& defaultName,
                     const std::string& overrideName)
 {
-  processRootDictionary(ctx, bencode2::decode(content, length).get(), option,
+  processRootDictionary(ctx, bencode2::decodeArena(content, length), option,
                         defaultName, overrideName, std::vector<std::string>());
 }
 
@@ -563,7 +534,7 @@ void loadFromMemory(const unsigned char* content, size_t length,
                     const std::string& defaultName,
                     const std::string& overrideName)
 {
-  processRootDictionary(ctx, bencode2::decode(content, length).get(), option,
+  processRootDictionary(ctx, bencode2::decodeArena(content, length), option,
                         defaultName, overrideName, uris);
 }
 
@@ -573,7 +544,7 @@ void loadFromMemory(const std::string& context,
                     const std::string& defaultName,
                     const std::string& overrideName)
 {
-  processRootDictionary(ctx, bencode2::decode(context).get(), option,
+  processRootDictionary(ctx, bencode2::decodeArena(context), option,
                         defaultName, overrideName, std::vector<std::string>());
 }
 
@@ -584,7 +555,7 @@ void loadFromMemory(const std::string& context,
                     const std::string& defaultName,
                     const std::string& overrideName)
 {
-  processRootDictionary(ctx, bencode2::decode(context).get(), option,
+  processRootDictionary(ctx, bencode2::decodeArena(context), option,
                         defaultName, overrideName, uris);
 }
 
@@ -594,6 +565,21 @@ void loadFromMemory(const ValueBase* torrent,
                     const std::vector<std::string>& uris,
                     const std::string& defaultName,
                     const std::string& overrideName)
+{
+  if (!downcast<Dict>(torrent)) {
+    throw DL_ABORT_EX2("torrent file does not contain a root dictionary.",
+                       error_code::BITTORRENT_PARSE_ERROR);
+  }
+  loadFromMemory(bencode2::encode(torrent), ctx, option, uris, defaultName,
+                 overrideName);
+}
+
+void loadFromMemory(const ArenaValue& torrent,
+                    const std::shared_ptr<DownloadContext>& ctx,
+                    const std::shared_ptr<Option>& option,
+                    const std::vector<std::string>& uris,
+                    const std::string& defaultName,
+                    const std::string& overrideName)
 {
   processRootDictionary(ctx, torrent, option, defaultName, overrideName, uris);
 }
@@ -47,6 +47,7 @@
 #include "a2netcompat.h"
 #include "Peer.h"
 #include "ValueBase.h"
+#include "ValueArena.h"
 #include "util.h"
 #include "DownloadContext.h"
 #include "TimeA2.h"
@@ -107,6 +108,13 @@ void loadFromMemory(const ValueBase* torrent,
                     const std::string& defaultName,
                     const std::string& overrideName = "");
 
+void loadFromMemory(const ArenaValue& torrent,
+                    const std::shared_ptr<DownloadContext>& ctx,
+                    const std::shared_ptr<Option>& option,
+                    const std::vector<std::string>& uris,
+                    const std::string& defaultName,
+                    const std::string& overrideName = "");
+
 // Parses BitTorrent Magnet URI and returns
 // std::unique_ptr<TorrentAttribute> which includes infoHash, name and
 // announceList. If parsing operation failed, an RecoverableException
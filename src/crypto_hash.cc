@@ -70,6 +70,417 @@ template <typename T> static forceinline T par(T b, T c, T d)
   w03 = endian(buffer[3]), w02 = endian(buffer[2]);                            \
   w01 = endian(buffer[1]), w00 = endian(buffer[0])
 
+// Hardware accelerated transforms, selected at runtime.
+#if (defined(__x86_64__) || defined(__i386__)) &&                            \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define __hash_have_shani 1
+#include <cpuid.h>
+#include <immintrin.h>
+
+#define __hash_shani_target __attribute__((target("sha,sse4.1")))
+
+// Returns true if the CPU supports the SHA extensions, and SSSE3 and
+// SSE4.1 which the kernels below use as well.
+static bool have_shani()
+{
+  static const bool rv = [] {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSSE3) ||
+        !(ecx & bit_SSE4_1) || __get_cpuid_max(0, nullptr) < 7) {
+      return false;
+    }
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    // CPUID.(EAX=07H, ECX=0):EBX.SHA[bit 29]
+    return (ebx & (1u << 29)) != 0;
+  }();
+  return rv;
+}
+
+// The |state| is in the host byte order, the |data| is |nblocks|
+// 64 bytes blocks.
+__hash_shani_target static void sha1_shani(uint32_t* state,
+                                          const uint8_t* data, size_t nblocks)
+{
+  const __m128i mask =
+      _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+  __m128i abcd, abcd_save, e0, e0_save, e1;
+  __m128i m0, m1, m2, m3;
+
+  abcd = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+  e0 = _mm_set_epi32(state[4], 0, 0, 0);
+
+  for (; nblocks; --nblocks, data += 64) {
+    abcd_save = abcd;
+    e0_save = e0;
+
+    // Rounds 0-3
+    m0 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0)), mask);
+    e0 = _mm_add_epi32(e0, m0);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+    // Rounds 4-7
+    m1 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)), mask);
+    e1 = _mm_sha1nexte_epu32(e1, m1);
+    e0 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+    m0 = _mm_sha1msg1_epu32(m0, m1);
+
+    // Rounds 8-11
+    m2 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)), mask);
+    e0 = _mm_sha1nexte_epu32(e0, m2);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+    m1 = _mm_sha1msg1_epu32(m1, m2);
+    m0 = _mm_xor_si128(m0, m2);
+
+    // Rounds 12-15
+    m3 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)), mask);
+    e1 = _mm_sha1nexte_epu32(e1, m3);
+    e0 = abcd;
+    m0 = _mm_sha1msg2_epu32(m0, m3);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+    m2 = _mm_sha1msg1_epu32(m2, m3);
+    m1 = _mm_xor_si128(m1, m3);
+
+    // Rounds 16-19
+    e0 = _mm_sha1nexte_epu32(e0, m0);
+    e1 = abcd;
+    m1 = _mm_sha1msg2_epu32(m1, m0);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+    m3 = _mm_sha1msg1_epu32(m3, m0);
+    m2 = _mm_xor_si128(m2, m0);
+
+    // Rounds 20-23
+    e1 = _mm_sha1nexte_epu32(e1, m1);
+    e0 = abcd;
+    m2 = _mm_sha1msg2_epu32(m2, m1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+    m0 = _mm_sha1msg1_epu32(m0, m1);
+    m3 = _mm_xor_si128(m3, m1);
+
+    // Rounds 24-27
+    e0 = _mm_sha1nexte_epu32(e0, m2);
+    e1 = abcd;
+    m3 = _mm_sha1msg2_epu32(m3, m2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+    m1 = _mm_sha1msg1_epu32(m1, m2);
+    m0 = _mm_xor_si128(m0, m2);
+
+    // Rounds 28-31
+    e1 = _mm_sha1nexte_epu32(e1, m3);
+    e0 = abcd;
+    m0 = _mm_sha1msg2_epu32(m0, m3);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+    m2 = _mm_sha1msg1_epu32(m2, m3);
+    m1 = _mm_xor_si128(m1, m3);
+
+    // Rounds 32-35
+    e0 = _mm_sha1nexte_epu32(e0, m0);
+    e1 = abcd;
+    m1 = _mm_sha1msg2_epu32(m1, m0);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+    m3 = _mm_sha1msg1_epu32(m3, m0);
+    m2 = _mm_xor_si128(m2, m0);
+
+    // Rounds 36-39
+    e1 = _mm_sha1nexte_epu32(e1, m1);
+    e0 = abcd;
+    m2 = _mm_sha1msg2_epu32(m2, m1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+    m0 = _mm_sha1msg1_epu32(m0, m1);
+    m3 = _mm_xor_si128(m3, m1);
+
+    // Rounds 40-43
+    e0 = _mm_sha1nexte_epu32(e0, m2);
+    e1 = abcd;
+    m3 = _mm_sha1msg2_epu32(m3, m2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+    m1 = _mm_sha1msg1_epu32(m1, m2);
+    m0 = _mm_xor_si128(m0, m2);
+
+    // Rounds 44-47
+    e1 = _mm_sha1nexte_epu32(e1, m3);
+    e0 = abcd;
+    m0 = _mm_sha1msg2_epu32(m0, m3);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+    m2 = _mm_sha1msg1_epu32(m2, m3);
+    m1 = _mm_xor_si128(m1, m3);
+
+    // Rounds 48-51
+    e0 = _mm_sha1nexte_epu32(e0, m0);
+    e1 = abcd;
+    m1 = _mm_sha1msg2_epu32(m1, m0);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+    m3 = _mm_sha1msg1_epu32(m3, m0);
+    m2 = _mm_xor_si128(m2, m0);
+
+    // Rounds 52-55
+    e1 = _mm_sha1nexte_epu32(e1, m1);
+    e0 = abcd;
+    m2 = _mm_sha1msg2_epu32(m2, m1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+    m0 = _mm_sha1msg1_epu32(m0, m1);
+    m3 = _mm_xor_si128(m3, m1);
+
+    // Rounds 56-59
+    e0 = _mm_sha1nexte_epu32(e0, m2);
+    e1 = abcd;
+    m3 = _mm_sha1msg2_epu32(m3, m2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+    m1 = _mm_sha1msg1_epu32(m1, m2);
+    m0 = _mm_xor_si128(m0, m2);
+
+    // Rounds 60-63
+    e1 = _mm_sha1nexte_epu32(e1, m3);
+    e0 = abcd;
+    m0 = _mm_sha1msg2_epu32(m0, m3);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+    m2 = _mm_sha1msg1_epu32(m2, m3);
+    m1 = _mm_xor_si128(m1, m3);
+
+    // Rounds 64-67
+    e0 = _mm_sha1nexte_epu32(e0, m0);
+    e1 = abcd;
+    m1 = _mm_sha1msg2_epu32(m1, m0);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+    m3 = _mm_sha1msg1_epu32(m3, m0);
+    m2 = _mm_xor_si128(m2, m0);
+
+    // Rounds 68-71
+    e1 = _mm_sha1nexte_epu32(e1, m1);
+    e0 = abcd;
+    m2 = _mm_sha1msg2_epu32(m2, m1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+    m3 = _mm_xor_si128(m3, m1);
+
+    // Rounds 72-75
+    e0 = _mm_sha1nexte_epu32(e0, m2);
+    e1 = abcd;
+    m3 = _mm_sha1msg2_epu32(m3, m2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+
+    // Rounds 76-79
+    e1 = _mm_sha1nexte_epu32(e1, m3);
+    e0 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+    e0 = _mm_sha1nexte_epu32(e0, e0_save);
+    abcd = _mm_add_epi32(abcd, abcd_save);
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state),
+                   _mm_shuffle_epi32(abcd, 0x1b));
+  state[4] = _mm_extract_epi32(e0, 3);
+}
+
+__hash_shani_target static void sha256_shani(uint32_t* state,
+                                            const uint8_t* data,
+                                            size_t nblocks)
+{
+  static const uint32_t k[] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+      0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+      0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+      0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+      0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+      0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+      0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+      0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+      0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+  const __m128i mask =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  __m128i state0, state1, abef_save, cdgh_save, msg, tmp;
+  __m128i m0, m1, m2, m3;
+
+  // Reorder the state words into ABEF and CDGH.
+  tmp = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xb1);
+  state1 = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1b);
+  state0 = _mm_alignr_epi8(tmp, state1, 8);
+  state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+  for (; nblocks; --nblocks, data += 64) {
+    abef_save = state0;
+    cdgh_save = state1;
+
+    // Rounds 0-3
+    m0 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0)), mask);
+    msg = _mm_add_epi32(
+        m0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 0)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+    // Rounds 4-7
+    m1 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)), mask);
+    msg = _mm_add_epi32(
+        m1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 4)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    m0 = _mm_sha256msg1_epu32(m0, m1);
+
+    // Rounds 8-11
+    m2 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)), mask);
+    msg = _mm_add_epi32(
+        m2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 8)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    m1 = _mm_sha256msg1_epu32(m1, m2);
+
+    // Rounds 12-15
+    m3 = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)), mask);
+    msg = _mm_add_epi32(
+        m3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 12)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(m3, m2, 4);
+    m0 = _mm_sha256msg2_epu32(_mm_add_epi32(m0, tmp), m3);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    m2 = _mm_sha256msg1_epu32(m2, m3);
+
+    // Rounds 16-19
+    msg = _mm_add_epi32(
+        m0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 16)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(m0, m3, 4);
+    m1 = _mm_sha256msg2_epu32(_mm_add_epi32(m1, tmp), m0);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    m3 = _mm_sha256msg1_epu32(m3, m0);
+
+    // Rounds 20-23
+    msg = _mm_add_epi32(
+        m1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 20)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(m1, m0, 4);
+    m2 = _mm_sha256msg2_epu32(_mm_add_epi32(m2, tmp), m1);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    m0 = _mm_sha256msg1_epu32(m0, m1);
+
+    // Rounds 24-27
+    msg = _mm_add_epi32(
+        m2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 24)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(m2, m1, 4);
+    m3 = _mm_sha256msg2_epu32(_mm_add_epi32(m3, tmp), m2);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    m1 = _mm_sha256msg1_epu32(m1, m2);
+
+    // Rounds 28-31
+    msg = _mm_add_epi32(
+        m3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 28)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(m3, m2, 4);
+    m0 = _mm_sha256msg2_epu32(_mm_add_epi32(m0, tmp), m3);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    m2 = _mm_sha256msg1_epu32(m2, m3);
+
+    // Rounds 32-35
+    msg = _mm_add_epi32(
+        m0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 32)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(m0, m3, 4);
+    m1 = _mm_sha256msg2_epu32(_mm_add_epi32(m1, tmp), m0);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    m3 = _mm_sha256msg1_epu32(m3, m0);
+
+    // Rounds 36-39
+    msg = _mm_add_epi32(
+        m1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 36)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(m1, m0, 4);
+    m2 = _mm_sha256msg2_epu32(_mm_add_epi32(m2, tmp), m1);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    m0 = _mm_sha256msg1_epu32(m0, m1);
+
+    // Rounds 40-43
+    msg = _mm_add_epi32(
+        m2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 40)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(m2, m1, 4);
+    m3 = _mm_sha256msg2_epu32(_mm_add_epi32(m3, tmp), m2);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    m1 = _mm_sha256msg1_epu32(m1, m2);
+
+    // Rounds 44-47
+    msg = _mm_add_epi32(
+        m3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 44)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(m3, m2, 4);
+    m0 = _mm_sha256msg2_epu32(_mm_add_epi32(m0, tmp), m3);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    m2 = _mm_sha256msg1_epu32(m2, m3);
+
+    // Rounds 48-51
+    msg = _mm_add_epi32(
+        m0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 48)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(m0, m3, 4);
+    m1 = _mm_sha256msg2_epu32(_mm_add_epi32(m1, tmp), m0);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    m3 = _mm_sha256msg1_epu32(m3, m0);
+
+    // Rounds 52-55
+    msg = _mm_add_epi32(
+        m1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 52)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(m1, m0, 4);
+    m2 = _mm_sha256msg2_epu32(_mm_add_epi32(m2, tmp), m1);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+    // Rounds 56-59
+    msg = _mm_add_epi32(
+        m2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 56)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    tmp = _mm_alignr_epi8(m2, m1, 4);
+    m3 = _mm_sha256msg2_epu32(_mm_add_epi32(m3, tmp), m2);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+    // Rounds 60-63
+    msg = _mm_add_epi32(
+        m3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 60)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+    state0 = _mm_add_epi32(state0, abef_save);
+    state1 = _mm_add_epi32(state1, cdgh_save);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1b);
+  state1 = _mm_shuffle_epi32(state1, 0xb1);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state),
+                   _mm_blend_epi16(tmp, state1, 0xf0));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4),
+                   _mm_alignr_epi8(state1, tmp, 8));
+}
+#endif // (__x86_64__ || __i386__) && (__clang__ || __GNUC__ >= 5)
+
 using namespace crypto;
 using namespace crypto::hash;
 
@@ -93,6 +504,15 @@ protected:
 
   virtual void transform(const word_t* buffer) = 0;
 
+  // Transforms |nblocks| blocks in |bytes|.  Implementations may
+  // override this to process many blocks at once.
+  virtual void transformBlocks(const uint8_t* bytes, size_t nblocks)
+  {
+    for (; nblocks; --nblocks, bytes += sizeof(buffer_)) {
+      transform(reinterpret_cast<const word_t*>(bytes));
+    }
+  }
+
   virtual std::string digest()
   {
     return std::string((const char*)state_.bytes, sizeof(state_.bytes));
@@ -125,13 +545,14 @@ public:
     }
 
     // |transform| as many blocks as possible.
-    while (len >= sizeof(buffer_)) {
+    if (len >= sizeof(buffer_)) {
       // |offset_| has to be 0 at this point!
       // Which is guaranteed by the block above.
 
-      transform(reinterpret_cast<const word_t*>(bytes));
-      bytes += sizeof(buffer_);
-      len -= sizeof(buffer_);
+      const auto nblocks = len / sizeof(buffer_);
+      transformBlocks(bytes, nblocks);
+      bytes += nblocks * sizeof(buffer_);
+      len -= nblocks * sizeof(buffer_);
     }
 
     // Buffer remaining bytes, if any.
@@ -373,6 +794,13 @@ private:
 protected:
   virtual void transform(const word_t* buffer)
   {
+#ifdef __hash_have_shani
+    if (likely(have_shani())) {
+      sha1_shani(state_.words, reinterpret_cast<const uint8_t*>(buffer), 1);
+      return;
+    }
+#endif // __hash_have_shani
+
     __hash_assign_words(__crypto_be);
     __hash_maybe_memfence;
 
@@ -513,6 +941,17 @@ protected:
     state_.words[4] += e;
   }
 
+#ifdef __hash_have_shani
+  virtual void transformBlocks(const uint8_t* bytes, size_t nblocks)
+  {
+    if (likely(have_shani())) {
+      sha1_shani(state_.words, bytes, nblocks);
+      return;
+    }
+    AlgorithmImpl::transformBlocks(bytes, nblocks);
+  }
+#endif // __hash_have_shani
+
 public:
   SHA1() { reset(); }
 
@@ -538,6 +977,13 @@ private:
 protected:
   virtual void transform(const word_t* buffer)
   {
+#ifdef __hash_have_shani
+    if (likely(have_shani())) {
+      sha256_shani(state_.words, reinterpret_cast<const uint8_t*>(buffer), 1);
+      return;
+    }
+#endif // __hash_have_shani
+
     __hash_assign_words(__crypto_be);
     __hash_maybe_memfence;
 
@@ -709,6 +1155,17 @@ protected:
     state_.words[7] += h;
   }
 
+#ifdef __hash_have_shani
+  virtual void transformBlocks(const uint8_t* bytes, size_t nblocks)
+  {
+    if (likely(have_shani())) {
+      sha256_shani(state_.words, bytes, nblocks);
+      return;
+    }
+    AlgorithmImpl::transformBlocks(bytes, nblocks);
+  }
+#endif // __hash_have_shani
+
 public:
   SHA256() { reset(); }
 
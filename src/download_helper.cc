@@ -66,7 +66,9 @@
 #ifdef ENABLE_BITTORRENT
 #include "bittorrent_helper.h"
 #include "BtConstants.h"
-#include "ValueBaseBencodeParser.h"
+#include "bencode2.h"
+#include "ArenaStructParserStateMachine.h"
+#include "BencodeParser.h"
 #endif // ENABLE_BITTORRENT
 
 namespace aria2 {
@@ -186,7 +188,7 @@ std::shared_ptr<RequestGroup>
 createBtRequestGroup(const std::string& metaInfoUri,
                      const std::shared_ptr<Option>& optionTemplate,
                      const std::vector<std::string>& auxUris,
-                     const ValueBase* torrent, bool adjustAnnounceUri = true)
+                     const ArenaValue& torrent, bool adjustAnnounceUri = true)
 {
   auto option = util::copy(optionTemplate);
   auto gid = getGID(option);
@@ -252,11 +254,10 @@ createBtMagnetRequestGroup(const std::string& magnetLink,
         util::applyDir(optionTemplate->get(PREF_DIR),
                        util::toHex(torrentAttrs->infoHash) + ".torrent");
 
-    bittorrent::ValueBaseBencodeParser parser;
-    auto torrent = parseFile(parser, torrentFilename);
+    auto torrent = bencode2::decodeArenaFromFile(torrentFilename);
     if (torrent) {
       auto rg = createBtRequestGroup(torrentFilename, optionTemplate, {},
-                                     torrent.get());
+                                     torrent->root());
       const auto& actualInfoHash =
           bittorrent::getTorrentAttrs(rg->getDownloadContext())->infoHash;
 
@@ -308,21 +309,21 @@ void createRequestGroupForBitTorrent(
     const std::string& metaInfoUri, const std::string& torrentData,
     bool adjustAnnounceUri)
 {
-  std::unique_ptr<ValueBase> torrent;
-  bittorrent::ValueBaseBencodeParser parser;
+  std::unique_ptr<ValueArena> torrent;
   if (torrentData.empty()) {
-    torrent = parseFile(parser, metaInfoUri);
+    torrent = bencode2::decodeArenaFromFile(metaInfoUri);
   }
   else {
     ssize_t error;
-    torrent = parser.parseFinal(torrentData.c_str(), torrentData.size(), error);
+    torrent = parseArena<bittorrent::BencodeParser>(
+        torrentData.c_str(), torrentData.size(), error);
   }
   if (!torrent) {
     throw DL_ABORT_EX2("Bencode decoding failed",
                        error_code::BENCODE_PARSE_ERROR);
   }
   createRequestGroupForBitTorrent(result, option, uris, metaInfoUri,
-                                  torrent.get(), adjustAnnounceUri);
+                                  torrent->root(), adjustAnnounceUri);
 }
 
 void createRequestGroupForBitTorrent(
@@ -330,6 +331,23 @@ void createRequestGroupForBitTorrent(
     const std::shared_ptr<Option>& option, const std::vector<std::string>& uris,
     const std::string& metaInfoUri, const ValueBase* torrent,
     bool adjustAnnounceUri)
+{
+  if (!torrent) {
+    throw DL_ABORT_EX2("Bencode decoding failed",
+                       error_code::BENCODE_PARSE_ERROR);
+  }
+  auto data = bencode2::encode(torrent);
+  auto arena = bencode2::decodeArena(data);
+  createRequestGroupForBitTorrent(result, option, uris, metaInfoUri,
+                                  arena ? arena->root() : ArenaValue(),
+                                  adjustAnnounceUri);
+}
+
+void createRequestGroupForBitTorrent(
+    std::vector<std::shared_ptr<RequestGroup>>& result,
+    const std::shared_ptr<Option>& option, const std::vector<std::string>& uris,
+    const std::string& metaInfoUri, const ArenaValue& torrent,
+    bool adjustAnnounceUri)
 {
   std::vector<std::string> nargs;
   if (option->get(PREF_PARAMETERIZED_URI) == A2_V_TRUE) {
@@ -407,14 +425,13 @@ public:
     }
     else if (!ignoreLocalPath_ && detector_.guessTorrentFile(uri)) {
       try {
-        bittorrent::ValueBaseBencodeParser parser;
-        auto torrent = parseFile(parser, uri);
+        auto torrent = bencode2::decodeArenaFromFile(uri);
         if (!torrent) {
           throw DL_ABORT_EX2("Bencode decoding failed",
                              error_code::BENCODE_PARSE_ERROR);
         }
         requestGroups_.push_back(
-            createBtRequestGroup(uri, option_, {}, torrent.get()));
+            createBtRequestGroup(uri, option_, {}, torrent->root()));
       }
       catch (RecoverableException& e) {
         if (throwOnError_) {
@@ -50,6 +50,7 @@ class MetadataInfo;
 class DownloadContext;
 class UriListParser;
 class ValueBase;
+class ArenaValue;
 class GroupId;
 
 #ifdef ENABLE_BITTORRENT
@@ -75,6 +76,12 @@ void createRequestGroupForBitTorrent(
     const std::string& metaInfoUri, const ValueBase* torrent,
     bool adjustAnnounceUri = true);
 
+void createRequestGroupForBitTorrent(
+    std::vector<std::shared_ptr<RequestGroup>>& result,
+    const std::shared_ptr<Option>& option, const std::vector<std::string>& uris,
+    const std::string& metaInfoUri, const ArenaValue& torrent,
+    bool adjustAnnounceUri = true);
+
 #endif // ENABLE_BITTORRENT
 
 #ifdef ENABLE_METALINK
@@ -0,0 +1,345 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#include "hpack.h"
+
+#include <array>
+
+#include "DlAbortEx.h"
+#include "array_fun.h"
+
+namespace aria2 {
+
+namespace hpack {
+
+namespace {
+const HeaderField staticTable[] = {
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""},
+};
+} // namespace
+
+size_t getStaticTableSize() { return arraySize(staticTable); }
+
+const HeaderField& getStaticTableEntry(size_t index)
+{
+  return staticTable[index - 1];
+}
+
+namespace {
+// The symbol 256 is EOS.
+constexpr size_t NUM_SYMBOLS = 257;
+constexpr size_t MAX_CODE_LENGTH = 30;
+
+// The code lengths of the Huffman code in RFC 7541 Appendix B.  The
+// code is canonical, so that the codes are reconstructed from the
+// lengths: shorter codes come first, and the codes of the same length
+// are assigned in the order of symbols.
+const uint8_t huffmanCodeLength[] = {
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28, 28, 28,
+    28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28, 6,  10, 10, 12,
+    13, 6,  8,  11, 10, 10, 8,  11, 8,  6,  6,  6,  5,  5,  5,  6,  6,  6,
+    6,  6,  6,  6,  7,  8,  15, 6,  12, 10, 13, 6,  7,  7,  7,  7,  7,  7,
+    7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  8,  7,
+    8,  13, 19, 13, 14, 6,  15, 5,  6,  5,  6,  5,  6,  6,  6,  5,  7,  7,
+    6,  6,  6,  5,  6,  7,  6,  5,  5,  6,  7,  7,  7,  7,  7,  15, 11, 14,
+    13, 28, 20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24, 22, 21,
+    20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23, 21, 21, 22, 21,
+    23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23, 26, 26, 20, 19, 22, 23,
+    22, 25, 26, 26, 26, 27, 27, 26, 24, 25, 19, 21, 26, 27, 27, 26, 27, 24,
+    21, 21, 26, 26, 28, 27, 27, 27, 20, 24, 20, 21, 22, 21, 21, 23, 22, 22,
+    25, 25, 24, 24, 26, 23, 26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27,
+    27, 27, 27, 26, 30,
+};
+
+struct HuffmanTable {
+  std::array<uint32_t, NUM_SYMBOLS> codes;
+  // The first code and the number of codes of each length, and the
+  // index in symbols where the symbols of each length start.
+  std::array<uint32_t, MAX_CODE_LENGTH + 1> firstCode;
+  std::array<uint32_t, MAX_CODE_LENGTH + 1> count;
+  std::array<uint32_t, MAX_CODE_LENGTH + 1> offset;
+  // Symbols sorted by (code length, symbol).
+  std::array<uint16_t, NUM_SYMBOLS> symbols;
+
+  HuffmanTable()
+  {
+    count.fill(0);
+    for (size_t i = 0; i < NUM_SYMBOLS; ++i) {
+      ++count[huffmanCodeLength[i]];
+    }
+    uint32_t code = 0;
+    uint32_t index = 0;
+    for (size_t len = 1; len <= MAX_CODE_LENGTH; ++len) {
+      firstCode[len] = code;
+      offset[len] = index;
+      index += count[len];
+      code = (code + count[len]) << 1;
+    }
+    std::array<uint32_t, MAX_CODE_LENGTH + 1> next = offset;
+    for (size_t i = 0; i < NUM_SYMBOLS; ++i) {
+      size_t len = huffmanCodeLength[i];
+      size_t pos = next[len]++;
+      symbols[pos] = i;
+      codes[i] = firstCode[len] + (pos - offset[len]);
+    }
+  }
+};
+
+const HuffmanTable& getHuffmanTable()
+{
+  static HuffmanTable table;
+  return table;
+}
+} // namespace
+
+void encodeInteger(std::string& out, unsigned char flags, size_t prefix,
+                   uint64_t value)
+{
+  uint64_t max = (1 << prefix) - 1;
+  if (value < max) {
+    out += static_cast<char>(flags | value);
+    return;
+  }
+  out += static_cast<char>(flags | max);
+  value -= max;
+  for (; value >= 128; value >>= 7) {
+    out += static_cast<char>((value & 0x7f) | 0x80);
+  }
+  out += static_cast<char>(value);
+}
+
+size_t decodeInteger(uint64_t& value, const unsigned char* data, size_t len,
+                     size_t prefix)
+{
+  if (len == 0) {
+    return 0;
+  }
+  uint64_t max = (1 << prefix) - 1;
+  value = data[0] & max;
+  if (value < max) {
+    return 1;
+  }
+  for (size_t i = 1, shift = 0; i < len; ++i, shift += 7) {
+    // Values which do not fit in 32 bits are never legitimate here.
+    if (shift > 28) {
+      throw DL_ABORT_EX("HPACK: integer overflow");
+    }
+    value += static_cast<uint64_t>(data[i] & 0x7f) << shift;
+    if ((data[i] & 0x80) == 0) {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+size_t huffmanEncodedLength(const std::string& s)
+{
+  size_t nbits = 0;
+  for (auto c : s) {
+    nbits += huffmanCodeLength[static_cast<unsigned char>(c)];
+  }
+  return (nbits + 7) / 8;
+}
+
+void huffmanEncode(std::string& out, const std::string& s)
+{
+  auto& table = getHuffmanTable();
+  uint64_t bits = 0;
+  size_t nbits = 0;
+  for (auto c : s) {
+    auto sym = static_cast<unsigned char>(c);
+    bits = (bits << huffmanCodeLength[sym]) | table.codes[sym];
+    nbits += huffmanCodeLength[sym];
+    for (; nbits >= 8; nbits -= 8) {
+      out += static_cast<char>(bits >> (nbits - 8));
+    }
+  }
+  if (nbits) {
+    // Pad with the most significant bits of EOS, which are all 1.
+    out += static_cast<char>((bits << (8 - nbits)) | (0xff >> nbits));
+  }
+}
+
+std::string huffmanDecode(const unsigned char* data, size_t len)
+{
+  auto& table = getHuffmanTable();
+  std::string res;
+  uint32_t code = 0;
+  size_t codeLength = 0;
+  // True if the bits read since the last symbol are all 1.
+  bool allOnes = true;
+  for (size_t i = 0; i < len; ++i) {
+    for (int j = 7; j >= 0; --j) {
+      uint32_t bit = (data[i] >> j) & 1;
+      code = (code << 1) | bit;
+      ++codeLength;
+      allOnes = allOnes && bit;
+      if (code - table.firstCode[codeLength] < table.count[codeLength]) {
+        auto sym = table.symbols[table.offset[codeLength] + code -
+                                 table.firstCode[codeLength]];
+        if (sym == NUM_SYMBOLS - 1) {
+          throw DL_ABORT_EX("HPACK: EOS in Huffman encoded string");
+        }
+        res += static_cast<char>(sym);
+        code = 0;
+        codeLength = 0;
+        allOnes = true;
+      }
+      else if (codeLength == MAX_CODE_LENGTH) {
+        throw DL_ABORT_EX("HPACK: bad Huffman code");
+      }
+    }
+  }
+  // The padding must be the prefix of EOS, and shorter than 8 bits.
+  if (codeLength > 7 || !allOnes) {
+    throw DL_ABORT_EX("HPACK: bad Huffman padding");
+  }
+  return res;
+}
+
+void encodeString(std::string& out, const std::string& s)
+{
+  size_t hlen = huffmanEncodedLength(s);
+  if (hlen < s.size()) {
+    encodeInteger(out, 0x80, 7, hlen);
+    huffmanEncode(out, s);
+  }
+  else {
+    encodeInteger(out, 0, 7, s.size());
+    out += s;
+  }
+}
+
+void encodeHeaderBlock(std::string& out,
+                       const std::vector<HeaderField>& headers)
+{
+  for (auto& hd : headers) {
+    size_t nameIndex = 0;
+    size_t index = 0;
+    for (size_t i = 1; i <= arraySize(staticTable) && index == 0; ++i) {
+      auto& ent = staticTable[i - 1];
+      if (ent.first != hd.first) {
+        continue;
+      }
+      if (nameIndex == 0) {
+        nameIndex = i;
+      }
+      if (ent.second == hd.second) {
+        index = i;
+      }
+    }
+    if (index) {
+      // Indexed Header Field Representation
+      encodeInteger(out, 0x80, 7, index);
+      continue;
+    }
+    // Literal Header Field without Indexing.  Credentials must not be
+    // remembered by intermediaries, so they are never indexed.
+    unsigned char flags =
+        hd.first == "authorization" || hd.first == "proxy-authorization" ||
+                hd.first == "cookie"
+            ? 0x10
+            : 0;
+    encodeInteger(out, flags, 4, nameIndex);
+    if (nameIndex == 0) {
+      encodeString(out, hd.first);
+    }
+    encodeString(out, hd.second);
+  }
+}
+
+} // namespace hpack
+
+} // namespace aria2
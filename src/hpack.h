@@ -0,0 +1,98 @@
+/* <!-- copyright */
+/*
+ * aria2 - The high speed download utility
+ *
+ * Copyright (C) 2016 Tatsuhiro Tsujikawa
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+/* copyright --> */
+#ifndef D_HPACK_H
+#define D_HPACK_H
+
+#include "common.h"
+
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace aria2 {
+
+// HPACK header compression for HTTP/2 (RFC 7541).  The encoder never
+// adds entries to the dynamic table; HpackDecoder keeps the dynamic
+// table of the decoding side.
+namespace hpack {
+
+typedef std::pair<std::string, std::string> HeaderField;
+
+// Returns the number of entries in the static table.
+size_t getStaticTableSize();
+
+// Returns the |index|-th entry of the static table.  |index| is
+// 1-based, as it appears on the wire.
+const HeaderField& getStaticTableEntry(size_t index);
+
+// Appends |value| encoded as an integer with |prefix| bits prefix to
+// |out|.  |flags| is ORed into the first byte and must not overlap
+// with the prefix bits.
+void encodeInteger(std::string& out, unsigned char flags, size_t prefix,
+                   uint64_t value);
+
+// Decodes an integer with |prefix| bits prefix from [data, data+len)
+// and stores it in |value|.  Returns the number of bytes consumed, or
+// 0 if the input ends in the middle of the integer.  Throws
+// DlAbortEx if the integer is too large.
+size_t decodeInteger(uint64_t& value, const unsigned char* data, size_t len,
+                     size_t prefix);
+
+// Returns the length of |s| in bytes after Huffman encoding.
+size_t huffmanEncodedLength(const std::string& s);
+
+// Appends |s| encoded with the Huffman code of HPACK to |out|.
+void huffmanEncode(std::string& out, const std::string& s);
+
+// Decodes Huffman encoded [data, data+len).  Throws DlAbortEx if the
+// input is not a valid Huffman encoded string.
+std::string huffmanDecode(const unsigned char* data, size_t len);
+
+// Appends |s| as a string literal to |out|.  The Huffman code is used
+// if it makes the string shorter.
+void encodeString(std::string& out, const std::string& s);
+
+// Appends the header block of |headers| to |out|.  The header fields
+// which match an entry in the static table are encoded as indexed
+// fields, and the others as literals without indexing.  The names in
+// |headers| must be in lower case.
+void encodeHeaderBlock(std::string& out,
+                       const std::vector<HeaderField>& headers);
+
+} // namespace hpack
+
+} // namespace aria2
+
+#endif // D_HPACK_H
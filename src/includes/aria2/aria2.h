@@ -41,6 +41,9 @@
 
 #include <string>
 #include <vector>
+#include <functional>
+#include <future>
+#include <memory>
 
 // Libaria2: The aim of this library is provide same functionality
 // available in RPC methods. The function signatures are not
@@ -252,6 +255,58 @@ enum RUN_MODE {
  */
 int run(Session* session, RUN_MODE mode);
 
+/**
+ * @typedef
+ *
+ * The task queued by :func:`postTask()`.  It is called with the
+ * session it was queued to.
+ */
+typedef std::function<void(Session* session)> Task;
+
+/**
+ * @function
+ *
+ * Queues the |task| to be executed in the thread calling
+ * :func:`run()`.  Unlike other functions in this library, this
+ * function can be called from any thread at any time between
+ * :func:`sessionNew()` and :func:`sessionFinal()`.  The |task| is
+ * executed during the next event polling of :func:`run()`, and it may
+ * call any function of this library with the given session.  If
+ * :func:`run()` is blocked in event polling, this function wakes it
+ * up.  The tasks queued by one thread are executed in the order they
+ * were queued.
+ *
+ * This function returns 0 if it succeeds, or negative error code.  It
+ * fails if the queue is full, or if :func:`run()` is finishing
+ * because no downloads are left or :func:`shutdown()` was called.
+ * The queue has room for 4096 tasks.  If the task is not queued, it
+ * is destroyed without being called.
+ */
+int postTask(Session* session, Task task);
+
+/**
+ * @function
+ *
+ * Same as :func:`postTask()`, but returns the future which will hold
+ * the return value of ``func(session)``, or the exception it threw.
+ * If the |func| cannot be queued, or the session is finalized before
+ * the |func| is executed, ``get()`` of the returned future throws
+ * ``std::future_error`` with ``std::future_errc::broken_promise``.
+ * For example, to add URI from another thread::
+ *
+ *     auto res = aria2::submitTask(session, [&](aria2::Session* s) {
+ *       aria2::A2Gid gid;
+ *       aria2::addUri(s, &gid, uris, aria2::KeyVals());
+ *       return gid;
+ *     });
+ *     aria2::A2Gid gid = res.get();
+ *
+ * Do not wait for the future in the thread calling :func:`run()`.
+ */
+template <typename F>
+auto submitTask(Session* session, F func)
+    -> std::future<decltype(func(session))>;
+
 /**
  * @function
  *
@@ -887,6 +942,19 @@ DownloadHandle* getDownloadHandle(Session* session, A2Gid gid);
  */
 void deleteDownloadHandle(DownloadHandle* dh);
 
+template <typename F>
+auto submitTask(Session* session, F func)
+    -> std::future<decltype(func(session))>
+{
+  typedef decltype(func(session)) R;
+  // std::function requires copyable target, so share packaged_task.
+  auto task = std::make_shared<std::packaged_task<R(Session*)>>(
+      std::move(func));
+  auto res = task->get_future();
+  postTask(session, [task](Session* s) { (*task)(s); });
+  return res;
+}
+
 } // namespace aria2
 
 #endif // ARIA2_H
@@ -99,6 +99,95 @@ std::string encode(const ValueBase* json)
   return encode(out, json).str();
 }
 
+JsonWriter::JsonWriter(std::string& out) : out_(out), afterKey_(false) {}
+
+void JsonWriter::separate()
+{
+  if (empty_.empty()) {
+    return;
+  }
+  if (!empty_.back()) {
+    out_ += ",";
+  }
+  empty_.back() = false;
+}
+
+void JsonWriter::beginValue()
+{
+  if (afterKey_) {
+    afterKey_ = false;
+    return;
+  }
+  separate();
+}
+
+void JsonWriter::beginDict()
+{
+  beginValue();
+  out_ += "{";
+  empty_.push_back(true);
+}
+
+void JsonWriter::endDict()
+{
+  empty_.pop_back();
+  out_ += "}";
+}
+
+void JsonWriter::beginList()
+{
+  beginValue();
+  out_ += "[";
+  empty_.push_back(true);
+}
+
+void JsonWriter::endList()
+{
+  empty_.pop_back();
+  out_ += "]";
+}
+
+void JsonWriter::writeKey(const std::string& key)
+{
+  separate();
+  out_ += "\"";
+  out_ += jsonEscape(key);
+  out_ += "\":";
+  afterKey_ = true;
+}
+
+void JsonWriter::writeString(const std::string& s)
+{
+  beginValue();
+  out_ += "\"";
+  out_ += jsonEscape(s);
+  out_ += "\"";
+}
+
+void JsonWriter::writeInteger(int64_t i)
+{
+  beginValue();
+  out_ += util::itos(i);
+}
+
+void JsonWriter::writeBool(bool b)
+{
+  beginValue();
+  out_ += b ? "true" : "false";
+}
+
+void JsonWriter::writeNull()
+{
+  beginValue();
+  out_ += "null";
+}
+
+void JsonWriter::writeEncoded(const std::string& data)
+{
+  beginValue();
+  out_ += data;
+}
+
 JsonGetParam::JsonGetParam(const std::string& request,
                            const std::string& callback)
     : request(request), callback(callback)
@@ -36,7 +36,11 @@
 #define D_JSON_H
 
 #include "common.h"
+
+#include <vector>
+
 #include "ValueBase.h"
+#include "ValueWriter.h"
 
 namespace aria2 {
 
@@ -117,6 +121,34 @@ OutputStream& encode(OutputStream& out, const ValueBase* vlb)
 // Serializes JSON object or array.
 std::string encode(const ValueBase* json);
 
+// ValueWriter which serializes the value as JSON and appends it to
+// the given string.
+class JsonWriter : public ValueWriter {
+public:
+  JsonWriter(std::string& out);
+
+  virtual void beginDict() CXX11_OVERRIDE;
+  virtual void endDict() CXX11_OVERRIDE;
+  virtual void beginList() CXX11_OVERRIDE;
+  virtual void endList() CXX11_OVERRIDE;
+  virtual void writeKey(const std::string& key) CXX11_OVERRIDE;
+  virtual void writeString(const std::string& s) CXX11_OVERRIDE;
+  virtual void writeInteger(int64_t i) CXX11_OVERRIDE;
+  virtual void writeBool(bool b) CXX11_OVERRIDE;
+  virtual void writeNull() CXX11_OVERRIDE;
+  virtual void writeEncoded(const std::string& data) CXX11_OVERRIDE;
+
+private:
+  // Writes "," if a value precedes in the current container.
+  void separate();
+  void beginValue();
+
+  std::string& out_;
+  // For each open container, true if nothing is written to it yet.
+  std::vector<bool> empty_;
+  bool afterKey_;
+};
+
 struct JsonGetParam {
   std::string request;
   std::string callback;
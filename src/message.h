@@ -86,6 +86,8 @@
   " index=%lu, begin=%d, blockIndex=%lu because of time out"
 #define MSG_DELETING_REQUEST_SLOT_ACQUIRED "CUID#%" PRId64 " - Deleting request slot" \
   " index=%lu, begin=%d, blockIndex=%lu because the block has been acquired."
+#define MSG_RELEASING_REQUEST_SLOT_STALLED "CUID#%" PRId64 " - Releasing request slot" \
+  " index=%lu, begin=%d, blockIndex=%lu to other peers because it is stalled."
 #define MSG_FAST_EXTENSION_ENABLED "CUID#%" PRId64 " - Fast extension enabled."
 #define MSG_EXTENDED_MESSAGING_ENABLED "CUID#%" PRId64 " - Extended Messaging enabled."
 #define MSG_FILE_ALLOCATION_FAILURE                             \
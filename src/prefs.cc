@@ -137,12 +137,14 @@ const std::string V_FEEDBACK("feedback");
 const std::string V_ADAPTIVE("adaptive");
 const std::string V_LIBUV("libuv");
 const std::string V_EPOLL("epoll");
+const std::string V_IO_URING("io_uring");
 const std::string V_KQUEUE("kqueue");
 const std::string V_PORT("port");
 const std::string V_POLL("poll");
 const std::string V_SELECT("select");
 const std::string V_BINARY("binary");
 const std::string V_ASCII("ascii");
+const std::string V_TEXT("text");
 const std::string V_GET("get");
 const std::string V_TUNNEL("tunnel");
 const std::string V_PLAIN("plain");
@@ -197,6 +199,8 @@ PrefPtr PREF_STARTUP_IDLE_TIME = makePref("startup-idle-time");
 // value: prealloc | fallc | none
 PrefPtr PREF_FILE_ALLOCATION = makePref("file-allocation");
 // value: 1*digit
+PrefPtr PREF_FILE_ALLOCATION_THREADS = makePref("file-allocation-threads");
+// value: 1*digit
 PrefPtr PREF_NO_FILE_ALLOCATION_LIMIT = makePref("no-file-allocation-limit");
 // value: true | false
 PrefPtr PREF_ALLOW_OVERWRITE = makePref("allow-overwrite");
@@ -204,6 +208,10 @@ PrefPtr PREF_ALLOW_OVERWRITE = makePref("allow-overwrite");
 PrefPtr PREF_REALTIME_CHUNK_CHECKSUM = makePref("realtime-chunk-checksum");
 // value: true | false
 PrefPtr PREF_CHECK_INTEGRITY = makePref("check-integrity");
+// value: 1*digit
+PrefPtr PREF_CHECK_INTEGRITY_THREADS = makePref("check-integrity-threads");
+// value: 1*digit
+PrefPtr PREF_ENGINE_SHARDS = makePref("engine-shards");
 // value: string that your file system recognizes as a file name.
 PrefPtr PREF_NETRC_PATH = makePref("netrc-path");
 // value:
@@ -251,6 +259,12 @@ PrefPtr PREF_SUMMARY_INTERVAL = makePref("summary-interval");
 PrefPtr PREF_LOG_LEVEL = makePref("log-level");
 // value: debug, info, notice, warn, error
 PrefPtr PREF_CONSOLE_LOG_LEVEL = makePref("console-log-level");
+// value: SUBSYSTEM=LEVEL[,...]
+PrefPtr PREF_SUBSYSTEM_LOG_LEVEL = makePref("subsystem-log-level");
+// value: text | binary
+PrefPtr PREF_LOG_FORMAT = makePref("log-format");
+// value: true | false
+PrefPtr PREF_ASYNC_LOG = makePref("async-log");
 // value: inorder | feedback | adaptive
 PrefPtr PREF_URI_SELECTOR = makePref("uri-selector");
 // value: 1*digit
@@ -407,6 +421,8 @@ PrefPtr PREF_SAVE_COOKIES = makePref("save-cookies");
 PrefPtr PREF_ENABLE_HTTP_KEEP_ALIVE = makePref("enable-http-keep-alive");
 // values: true | false
 PrefPtr PREF_ENABLE_HTTP_PIPELINING = makePref("enable-http-pipelining");
+// values: true | false
+PrefPtr PREF_ENABLE_HTTP2 = makePref("enable-http2");
 // value: 1*digit
 PrefPtr PREF_MAX_HTTP_PIPELINING = makePref("max-http-pipelining");
 // value: string
@@ -552,6 +568,8 @@ PrefPtr PREF_BT_TRACKER_CONNECT_TIMEOUT =
     makePref("bt-tracker-connect-timeout");
 // values: 1*digit
 PrefPtr PREF_DHT_MESSAGE_TIMEOUT = makePref("dht-message-timeout");
+// values: 1*digit
+PrefPtr PREF_UDP_BATCH_SIZE = makePref("udp-batch-size");
 // values: string
 PrefPtr PREF_ON_BT_DOWNLOAD_COMPLETE = makePref("on-bt-download-complete");
 // values: string
@@ -94,12 +94,14 @@ extern const std::string V_FEEDBACK;
 extern const std::string V_ADAPTIVE;
 extern const std::string V_LIBUV;
 extern const std::string V_EPOLL;
+extern const std::string V_IO_URING;
 extern const std::string V_KQUEUE;
 extern const std::string V_PORT;
 extern const std::string V_POLL;
 extern const std::string V_SELECT;
 extern const std::string V_BINARY;
 extern const std::string V_ASCII;
+extern const std::string V_TEXT;
 extern const std::string V_GET;
 extern const std::string V_TUNNEL;
 extern const std::string V_PLAIN;
@@ -151,6 +153,8 @@ extern PrefPtr PREF_STARTUP_IDLE_TIME;
 // value: prealloc | falloc | none
 extern PrefPtr PREF_FILE_ALLOCATION;
 // value: 1*digit
+extern PrefPtr PREF_FILE_ALLOCATION_THREADS;
+// value: 1*digit
 extern PrefPtr PREF_NO_FILE_ALLOCATION_LIMIT;
 // value: true | false
 extern PrefPtr PREF_ALLOW_OVERWRITE;
@@ -158,6 +162,10 @@ extern PrefPtr PREF_ALLOW_OVERWRITE;
 extern PrefPtr PREF_REALTIME_CHUNK_CHECKSUM;
 // value: true | false
 extern PrefPtr PREF_CHECK_INTEGRITY;
+// value: 1*digit
+extern PrefPtr PREF_CHECK_INTEGRITY_THREADS;
+// value: 1*digit
+extern PrefPtr PREF_ENGINE_SHARDS;
 // value: string that your file system recognizes as a file name.
 extern PrefPtr PREF_NETRC_PATH;
 // value:
@@ -204,6 +212,12 @@ extern PrefPtr PREF_SUMMARY_INTERVAL;
 extern PrefPtr PREF_LOG_LEVEL;
 // value: debug, info, notice, warn, error
 extern PrefPtr PREF_CONSOLE_LOG_LEVEL;
+// value: SUBSYSTEM=LEVEL[,...]
+extern PrefPtr PREF_SUBSYSTEM_LOG_LEVEL;
+// value: text | binary
+extern PrefPtr PREF_LOG_FORMAT;
+// value: true | false
+extern PrefPtr PREF_ASYNC_LOG;
 // value: inorder | feedback | adaptive
 extern PrefPtr PREF_URI_SELECTOR;
 // value: 1*digit
@@ -360,6 +374,8 @@ extern PrefPtr PREF_SAVE_COOKIES;
 extern PrefPtr PREF_ENABLE_HTTP_KEEP_ALIVE;
 // values: true | false
 extern PrefPtr PREF_ENABLE_HTTP_PIPELINING;
+// values: true | false
+extern PrefPtr PREF_ENABLE_HTTP2;
 // value: 1*digit
 extern PrefPtr PREF_MAX_HTTP_PIPELINING;
 // value: string
@@ -502,6 +518,8 @@ extern PrefPtr PREF_BT_TRACKER_TIMEOUT;
 extern PrefPtr PREF_BT_TRACKER_CONNECT_TIMEOUT;
 // values: 1*digit
 extern PrefPtr PREF_DHT_MESSAGE_TIMEOUT;
+// values: 1*digit
+extern PrefPtr PREF_UDP_BATCH_SIZE;
 // values: string
 extern PrefPtr PREF_ON_BT_DOWNLOAD_COMPLETE;
 // values: string
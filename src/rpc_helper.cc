@@ -77,7 +77,9 @@ RpcResponse createJsonRpcErrorResponse(int code, const std::string& msg,
                           std::move(id)};
 }
 
-RpcResponse processJsonRpcRequest(Dict* jsondict, DownloadEngine* e)
+RpcResponse
+processJsonRpcRequest(Dict* jsondict, DownloadEngine* e,
+                      const std::shared_ptr<WebSocketSession>& wsSession)
 {
   auto id = jsondict->popValue("id");
   if (!id) {
@@ -102,6 +104,8 @@ RpcResponse processJsonRpcRequest(Dict* jsondict, DownloadEngine* e)
   }
   A2_LOG_INFO(fmt("Executing RPC method %s", methodName->s().c_str()));
   RpcRequest req = {methodName->s(), std::move(params), std::move(id), true};
+  req.directEncoding = true;
+  req.wsSession = wsSession;
   return getMethod(methodName->s())->execute(std::move(req), e);
 }
 
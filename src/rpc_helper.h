@@ -52,6 +52,7 @@ class DownloadEngine;
 namespace rpc {
 
 struct RpcResponse;
+class WebSocketSession;
 
 #ifdef ENABLE_XML_RPC
 RpcRequest xmlParseMemory(const char* xml, size_t size);
@@ -62,8 +63,13 @@ RpcRequest xmlParseMemory(const char* xml, size_t size);
 RpcResponse createJsonRpcErrorResponse(int code, const std::string& msg,
                                        std::unique_ptr<ValueBase> id);
 
-// Processes JSON-RPC request |jsondict| and returns the result.
-RpcResponse processJsonRpcRequest(Dict* jsondict, DownloadEngine* e);
+// Processes JSON-RPC request |jsondict| and returns the result.  The
+// result is encoded in JSON as it is produced, and is stored in
+// RpcResponse::encodedParam.  If the request is received over
+// WebSocket, |wsSession| is the session.
+RpcResponse processJsonRpcRequest(
+    Dict* jsondict, DownloadEngine* e,
+    const std::shared_ptr<WebSocketSession>& wsSession = nullptr);
 
 } // namespace rpc
 
@@ -149,6 +149,11 @@
     "                              'trunc' uses ftruncate() system call or\n" \
     "                              platform-specific counterpart to truncate a file\n" \
     "                              to a specified length.")
+#define TEXT_FILE_ALLOCATION_THREADS                                    \
+  _(" --file-allocation-threads=NUM Allocate files of up to NUM downloads at the\n" \
+    "                              same time using worker threads. The main thread\n" \
+    "                              keeps serving other downloads and RPC requests\n" \
+    "                              while files are allocated.")
 #define TEXT_NO_FILE_ALLOCATION_LIMIT                                   \
   _(" --no-file-allocation-limit=SIZE No file allocation is made for files whose\n" \
     "                              size is smaller than SIZE.\n"        \
@@ -192,6 +197,10 @@
   _(" --enable-http-keep-alive[=true|false] Enable HTTP/1.1 persistent connection.")
 #define TEXT_ENABLE_HTTP_PIPELINING                                     \
   _(" --enable-http-pipelining[=true|false] Enable HTTP/1.1 pipelining.")
+#define TEXT_ENABLE_HTTP2                                               \
+  _(" --enable-http2[=true|false] Offer HTTP/2 to HTTPS servers, and send the\n" \
+    "                              requests to the same server as streams of one\n" \
+    "                              connection if the server accepts it.")
 #define TEXT_CHECK_INTEGRITY                                            \
   _(" -V, --check-integrity[=true|false] Check file integrity by validating piece\n" \
     "                              hashes or a hash of entire file. This option has\n" \
@@ -722,6 +731,10 @@
     "                              instead.")
 #define TEXT_DHT_MESSAGE_TIMEOUT                \
   _(" --dht-message-timeout=SEC    Set timeout in seconds.")
+#define TEXT_UDP_BATCH_SIZE                     \
+  _(" --udp-batch-size=NUM         Receive or send at most NUM UDP datagrams of\n" \
+    "                              DHT and UDP trackers in one system call.\n" \
+    "                              Specify 1 to handle one datagram at a time.")
 #define TEXT_HTTP_ACCEPT_GZIP                   \
   _(" --http-accept-gzip[=true|false] Send 'Accept: deflate, gzip' request header\n" \
     "                              and inflate response if remote server responds\n" \
@@ -748,6 +761,17 @@
     "                              If SIZE is 15M, since 2*15M > 20MiB, aria2 does\n" \
     "                              not split file and download it using 1 source.\n" \
     "                              You can append K or M(1K = 1024, 1M = 1024K).")
+#define TEXT_CHECK_INTEGRITY_THREADS                                    \
+  _(" --check-integrity-threads=NUM Use NUM worker threads to validate piece\n" \
+    "                              hashes. Up to NUM downloads are validated at the\n" \
+    "                              same time. The data is read by the main thread\n" \
+    "                              and hashed by the worker threads.")
+#define TEXT_ENGINE_SHARDS                                              \
+  _(" --engine-shards=NUM          Run downloads on NUM download engines, each in\n" \
+    "                              its own thread. The BitTorrent downloads always\n" \
+    "                              run on the main engine. This option is ignored\n" \
+    "                              if --enable-rpc is given. This option is\n" \
+    "                              experimental. See man page for details.")
 #define TEXT_CONDITIONAL_GET                    \
   _(" --conditional-get[=true|false] Download file only when the local file is older\n" \
     "                              than remote file. Currently, this function has\n" \
@@ -1013,6 +1037,21 @@
     "                              by aria2.")
 #define TEXT_CONSOLE_LOG_LEVEL                                          \
   _(" --console-log-level=LEVEL    Set log level to output to console.")
+#define TEXT_SUBSYSTEM_LOG_LEVEL                                        \
+  _(" --subsystem-log-level=SUBSYSTEM=LEVEL[,...] Set log level to output to\n" \
+    "                              file per subsystem. SUBSYSTEM is one of bt,\n" \
+    "                              dht, http, rpc and disk. LEVEL is one of the\n" \
+    "                              values accepted by --log-level. The subsystem\n" \
+    "                              not listed follows --log-level.")
+#define TEXT_LOG_FORMAT                                                 \
+  _(" --log-format=FORMAT          Set the format of the log file. If binary is\n" \
+    "                              given, log is written in compact binary format\n" \
+    "                              which can be decoded by aria2logdecode script\n" \
+    "                              in doc/log. The log to standard output is\n" \
+    "                              always written in text.")
+#define TEXT_ASYNC_LOG                                                  \
+  _(" --async-log[=true|false]     Write the log file in a dedicated thread so\n" \
+    "                              that the download is not blocked by disk I/O.")
 #define TEXT_SAVE_SESSION_INTERVAL                                      \
   _(" --save-session-interval=SEC  Save error/unfinished downloads to a file\n" \
     "                              specified by --save-session option every SEC\n" \
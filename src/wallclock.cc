@@ -40,8 +40,14 @@ namespace global {
 
 Timer& wallclock()
 {
+#ifdef ENABLE_THREADS
+  // Each thread running DownloadEngine resets its own clock.
+  static thread_local Timer t;
+  return t;
+#else  // !ENABLE_THREADS
   static auto t = new Timer();
   return *t;
+#endif // !ENABLE_THREADS
 }
 
 } // namespace global
@@ -39,7 +39,8 @@ namespace aria2 {
 namespace global {
 
 // Global clock, this clock is reset before executeCommand() call to
-// reduce the call gettimeofday() system call.
+// reduce the call gettimeofday() system call.  If threads are enabled,
+// each thread has its own clock.
 Timer& wallclock();
 
 } // namespace global
@@ -1,8 +1,10 @@
 #include "ARC4Encryptor.h"
 
 #include <cstring>
+#include <algorithm>
 #include <cppunit/extensions/HelperMacros.h>
 
+#include "InternalARC4Encryptor.h"
 #include "Exception.h"
 #include "util.h"
 
@@ -12,6 +14,9 @@ class ARC4Test : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(ARC4Test);
   CPPUNIT_TEST(testEncrypt);
+  CPPUNIT_TEST(testEncrypt_keyStream);
+  CPPUNIT_TEST(testEncrypt_chunked);
+  CPPUNIT_TEST(testEncrypt_internal);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -20,6 +25,9 @@ public:
   void tearDown() {}
 
   void testEncrypt();
+  void testEncrypt_keyStream();
+  void testEncrypt_chunked();
+  void testEncrypt_internal();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ARC4Test);
@@ -50,4 +58,62 @@ void ARC4Test::testEncrypt()
   CPPUNIT_ASSERT(memcmp(key, decrypted, LEN) == 0);
 }
 
+void ARC4Test::testEncrypt_keyStream()
+{
+  // Test vectors from RFC 6229
+  const unsigned char key[] = {0x01, 0x02, 0x03, 0x04, 0x05};
+  ARC4Encryptor enc;
+  enc.init(key, sizeof(key));
+  unsigned char buf[4112];
+  memset(buf, 0, sizeof(buf));
+  enc.encrypt(sizeof(buf), buf, buf);
+  CPPUNIT_ASSERT_EQUAL(std::string("b2396305f03dc027ccc3524a0a1118a8"),
+                       util::toHex(buf, 16));
+  CPPUNIT_ASSERT_EQUAL(std::string("ff25b58995996707e51fbdf08b34d875"),
+                       util::toHex(buf + 4096, 16));
+}
+
+void ARC4Test::testEncrypt_chunked()
+{
+  unsigned char key[16];
+  util::generateRandomData(key, sizeof(key));
+  ARC4Encryptor whole;
+  ARC4Encryptor chunked;
+  whole.init(key, sizeof(key));
+  chunked.init(key, sizeof(key));
+  unsigned char data[1000];
+  util::generateRandomData(data, sizeof(data));
+  unsigned char expected[sizeof(data)];
+  unsigned char actual[sizeof(data)];
+  whole.encrypt(sizeof(data), expected, data);
+  // Odd chunk sizes mix whole words and the tail bytes.
+  for (size_t off = 0, len = 1; off < sizeof(data); off += len, len += 3) {
+    len = std::min(len, sizeof(data) - off);
+    chunked.encrypt(len, actual + off, data + off);
+  }
+  CPPUNIT_ASSERT(memcmp(expected, actual, sizeof(data)) == 0);
+}
+
+void ARC4Test::testEncrypt_internal()
+{
+  // Without USE_INTERNAL_ARC4, ARC4Encryptor is the implementation
+  // from the crypto library.  Both must produce the same stream.
+  unsigned char key[16];
+  util::generateRandomData(key, sizeof(key));
+  ARC4Encryptor lib;
+  InternalARC4Encryptor internal;
+  lib.init(key, sizeof(key));
+  internal.init(key, sizeof(key));
+  unsigned char data[16_k];
+  util::generateRandomData(data, sizeof(data));
+  unsigned char expected[sizeof(data)];
+  unsigned char actual[sizeof(data)];
+  for (size_t off = 0, len = 1; off < sizeof(data); off += len, len += 7) {
+    len = std::min(len, sizeof(data) - off);
+    lib.encrypt(len, expected + off, data + off);
+    internal.encrypt(len, actual + off, data + off);
+  }
+  CPPUNIT_ASSERT(memcmp(expected, actual, sizeof(data)) == 0);
+}
+
 } // namespace aria2
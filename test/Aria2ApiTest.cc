@@ -2,6 +2,10 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 
+#ifdef ENABLE_THREADS
+#include <thread>
+#endif // ENABLE_THREADS
+
 #include "TestUtil.h"
 #include "prefs.h"
 #include "OptionParser.h"
@@ -25,6 +29,8 @@ class Aria2ApiTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testChangeOption);
   CPPUNIT_TEST(testChangeGlobalOption);
   CPPUNIT_TEST(testDownloadResultDH);
+  CPPUNIT_TEST(testPostTask);
+  CPPUNIT_TEST(testPostTask_thread);
   CPPUNIT_TEST_SUITE_END();
 
   Session* session_;
@@ -47,6 +53,17 @@ public:
   void testChangeOption();
   void testChangeGlobalOption();
   void testDownloadResultDH();
+  void testPostTask();
+  void testPostTask_thread();
+
+private:
+  void renewSessionWithKeepRunning()
+  {
+    sessionFinal(session_);
+    SessionConfig config;
+    config.keepRunning = true;
+    session_ = sessionNew({{"no-conf", "true"}}, config);
+  }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(Aria2ApiTest);
@@ -248,4 +265,93 @@ void Aria2ApiTest::testDownloadResultDH()
   deleteDownloadHandle(hd);
 }
 
+void Aria2ApiTest::testPostTask()
+{
+  renewSessionWithKeepRunning();
+  auto res = submitTask(session_, [](Session* session) {
+    A2Gid gid;
+    std::vector<std::string> uris{"http://localhost/1"};
+    addUri(session, &gid, uris, KeyVals());
+    pauseDownload(session, gid);
+    return gid;
+  });
+  auto failure = submitTask(session_, [](Session* session) -> int {
+    throw std::runtime_error("failure");
+  });
+  CPPUNIT_ASSERT(std::future_status::timeout ==
+                 res.wait_for(std::chrono::seconds(0)));
+  CPPUNIT_ASSERT_EQUAL(1, run(session_, RUN_ONCE));
+  auto gid = res.get();
+  DownloadHandle* hd = getDownloadHandle(session_, gid);
+  CPPUNIT_ASSERT(hd);
+  CPPUNIT_ASSERT_EQUAL(DOWNLOAD_PAUSED, hd->getStatus());
+  deleteDownloadHandle(hd);
+  try {
+    failure.get();
+    CPPUNIT_FAIL("exception must be thrown");
+  }
+  catch (std::runtime_error& e) {
+    CPPUNIT_ASSERT_EQUAL(std::string("failure"), std::string(e.what()));
+  }
+  // Tasks are rejected after shutdown.
+  CPPUNIT_ASSERT_EQUAL(0, shutdown(session_, true));
+  while (run(session_, RUN_ONCE) == 1)
+    ;
+  CPPUNIT_ASSERT_EQUAL(-1, postTask(session_, [](Session* session) {}));
+  res = submitTask(session_, [](Session* session) { return (A2Gid)0; });
+  try {
+    res.get();
+    CPPUNIT_FAIL("exception must be thrown");
+  }
+  catch (std::future_error& e) {
+    CPPUNIT_ASSERT(std::future_errc::broken_promise == e.code());
+  }
+}
+
+void Aria2ApiTest::testPostTask_thread()
+{
+#ifdef ENABLE_THREADS
+  renewSessionWithKeepRunning();
+  const int numThreads = 4;
+  const int numTasks = 1000;
+  // Only touched in this thread, which calls run().
+  std::vector<int> last(numThreads, -1);
+  bool ordered = true;
+  int n = 0;
+  auto runThread = std::this_thread::get_id();
+  bool sameThread = true;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < numTasks; ++i) {
+        while (postTask(session_, [&, t, i](Session* session) {
+                 sameThread =
+                     sameThread && runThread == std::this_thread::get_id();
+                 ordered = ordered && last[t] < i;
+                 last[t] = i;
+                 ++n;
+               }) != 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  // run() must not wait for the polling timeout to execute tasks.
+  auto start = std::chrono::steady_clock::now();
+  while (n < numThreads * numTasks) {
+    CPPUNIT_ASSERT_EQUAL(1, run(session_, RUN_ONCE));
+  }
+  CPPUNIT_ASSERT(std::chrono::steady_clock::now() - start <
+                 std::chrono::seconds(5));
+  for (auto& th : threads) {
+    th.join();
+  }
+  CPPUNIT_ASSERT(ordered);
+  CPPUNIT_ASSERT(sameThread);
+  CPPUNIT_ASSERT_EQUAL(0, shutdown(session_));
+  while (run(session_, RUN_ONCE) == 1)
+    ;
+#endif // ENABLE_THREADS
+}
+
 } // namespace aria2
@@ -0,0 +1,114 @@
+#include "BdpEstimator.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "wallclock.h"
+
+namespace aria2 {
+
+class BdpEstimatorTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(BdpEstimatorTest);
+  CPPUNIT_TEST(testUpdateLatency);
+  CPPUNIT_TEST(testGetRequestTimeout);
+  CPPUNIT_TEST(testGetPipelineDepth);
+  CPPUNIT_TEST(testGetPipelineDepth_window);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() { global::wallclock().reset(); }
+
+  void tearDown() { global::wallclock().reset(); }
+
+  void testUpdateLatency();
+  void testGetRequestTimeout();
+  void testGetPipelineDepth();
+  void testGetPipelineDepth_window();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BdpEstimatorTest);
+
+void BdpEstimatorTest::testUpdateLatency()
+{
+  BdpEstimator est;
+  est.updateLatency(std::chrono::milliseconds(200));
+  CPPUNIT_ASSERT_EQUAL((int64_t)200000, (int64_t)est.getMinRtt().count());
+  CPPUNIT_ASSERT_EQUAL((int64_t)200000,
+                       (int64_t)est.getSmoothedLatency().count());
+  est.updateLatency(std::chrono::milliseconds(300));
+  CPPUNIT_ASSERT_EQUAL((int64_t)200000, (int64_t)est.getMinRtt().count());
+  CPPUNIT_ASSERT_EQUAL((int64_t)212500,
+                       (int64_t)est.getSmoothedLatency().count());
+  est.updateLatency(std::chrono::milliseconds(100));
+  CPPUNIT_ASSERT_EQUAL((int64_t)100000, (int64_t)est.getMinRtt().count());
+  CPPUNIT_ASSERT_EQUAL((int64_t)198437,
+                       (int64_t)est.getSmoothedLatency().count());
+}
+
+void BdpEstimatorTest::testGetRequestTimeout()
+{
+  BdpEstimator est;
+  // No sample yet
+  CPPUNIT_ASSERT(std::chrono::milliseconds(60_s) ==
+                 est.getRequestTimeout(60_s));
+  est.updateLatency(std::chrono::milliseconds(200));
+  CPPUNIT_ASSERT(BdpEstimator::MIN_REQUEST_TIMEOUT ==
+                 est.getRequestTimeout(60_s));
+
+  BdpEstimator slow;
+  // srtt = 4s, rttvar = 2s
+  slow.updateLatency(4_s);
+  CPPUNIT_ASSERT(std::chrono::milliseconds(12_s) ==
+                 slow.getRequestTimeout(60_s));
+  CPPUNIT_ASSERT(std::chrono::milliseconds(10_s) ==
+                 slow.getRequestTimeout(10_s));
+}
+
+void BdpEstimatorTest::testGetPipelineDepth()
+{
+  BdpEstimator est;
+  CPPUNIT_ASSERT_EQUAL((size_t)0, est.getPipelineDepth(16_k));
+  est.updateLatency(std::chrono::milliseconds(200));
+  // 6 blocks in a round trip time
+  est.updateDelivered(16_k);
+  global::wallclock().advance(std::chrono::milliseconds(100));
+  est.updateDelivered(16_k * 2);
+  // The round is not over yet.
+  CPPUNIT_ASSERT_EQUAL((size_t)0, est.getPipelineDepth(16_k));
+  global::wallclock().advance(std::chrono::milliseconds(100));
+  est.updateDelivered(16_k * 3);
+  CPPUNIT_ASSERT_EQUAL((int64_t)16_k * 6 * 5, est.getBandwidth());
+  // The pipeline doubles.
+  CPPUNIT_ASSERT_EQUAL((size_t)12, est.getPipelineDepth(16_k));
+
+  global::wallclock().advance(std::chrono::milliseconds(100));
+  est.updateDelivered(16_k * 6);
+  global::wallclock().advance(std::chrono::milliseconds(200));
+  est.updateDelivered(16_k * 6);
+  CPPUNIT_ASSERT_EQUAL((size_t)24, est.getPipelineDepth(16_k));
+}
+
+void BdpEstimatorTest::testGetPipelineDepth_window()
+{
+  BdpEstimator est;
+  est.updateLatency(std::chrono::milliseconds(100));
+  est.updateDelivered(16_k);
+  global::wallclock().advance(std::chrono::milliseconds(100));
+  est.updateDelivered(16_k * 9);
+  CPPUNIT_ASSERT_EQUAL((size_t)20, est.getPipelineDepth(16_k));
+  // The rate drops, but the maximum is remembered for a while.
+  for (size_t i = 0; i < BdpEstimator::BANDWIDTH_WINDOW - 1; ++i) {
+    global::wallclock().advance(std::chrono::milliseconds(100));
+    est.updateDelivered(16_k);
+    global::wallclock().advance(std::chrono::milliseconds(100));
+    est.updateDelivered(16_k);
+  }
+  CPPUNIT_ASSERT_EQUAL((size_t)20, est.getPipelineDepth(16_k));
+  global::wallclock().advance(std::chrono::milliseconds(100));
+  est.updateDelivered(16_k);
+  global::wallclock().advance(std::chrono::milliseconds(100));
+  est.updateDelivered(16_k);
+  CPPUNIT_ASSERT_EQUAL((size_t)4, est.getPipelineDepth(16_k));
+}
+
+} // namespace aria2
@@ -1,6 +1,7 @@
 #include "BitfieldMan.h"
 
 #include <cstring>
+#include <random>
 #include <vector>
 
 #include <cppunit/extensions/HelperMacros.h>
@@ -41,6 +42,8 @@ class BitfieldManTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testGetFirstNMissingUnusedIndex);
   CPPUNIT_TEST(testGetInorderMissingUnusedIndex);
   CPPUNIT_TEST(testGetGeomMissingUnusedIndex);
+  CPPUNIT_TEST(testSummary);
+  CPPUNIT_TEST(testSummary_sparse);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -73,6 +76,8 @@ public:
   void testGetFirstNMissingUnusedIndex();
   void testGetInorderMissingUnusedIndex();
   void testGetGeomMissingUnusedIndex();
+  void testSummary();
+  void testSummary_sparse();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(BitfieldManTest);
@@ -815,4 +820,113 @@ void BitfieldManTest::testGetGeomMissingUnusedIndex()
   bt.setUseBit(12);
 }
 
+namespace {
+// Checks the results of the queries using the summary against the
+// ones calculated bit by bit.
+void checkSummary(const BitfieldMan& bt)
+{
+  std::vector<size_t> missing, missingUnused;
+  for (size_t i = 0; i < bt.countBlock(); ++i) {
+    if (!bt.isBitSet(i) && (!bt.isFilterEnabled() || bt.isFilterBitSet(i))) {
+      missing.push_back(i);
+      if (!bt.isUseBitSet(i)) {
+        missingUnused.push_back(i);
+      }
+    }
+  }
+  size_t index;
+  CPPUNIT_ASSERT_EQUAL(!missing.empty(), bt.getFirstMissingIndex(index));
+  if (!missing.empty()) {
+    CPPUNIT_ASSERT_EQUAL(missing[0], index);
+  }
+  CPPUNIT_ASSERT_EQUAL(!missingUnused.empty(),
+                       bt.getFirstMissingUnusedIndex(index));
+  if (!missingUnused.empty()) {
+    CPPUNIT_ASSERT_EQUAL(missingUnused[0], index);
+  }
+  std::vector<size_t> out;
+  size_t n = std::min(missingUnused.size(), static_cast<size_t>(100));
+  CPPUNIT_ASSERT_EQUAL(n, bt.getFirstNMissingUnusedIndex(out, 100));
+  CPPUNIT_ASSERT(std::equal(out.begin(), out.end(), missingUnused.begin()));
+  CPPUNIT_ASSERT_EQUAL(missing.size(), bt.countMissingBlock());
+  CPPUNIT_ASSERT_EQUAL(bt.countMissingBlockNow(), bt.countMissingBlock());
+  CPPUNIT_ASSERT_EQUAL(bt.getCompletedLengthNow(), bt.getCompletedLength());
+  CPPUNIT_ASSERT_EQUAL(bt.getFilteredCompletedLengthNow(),
+                       bt.getFilteredCompletedLength());
+
+  std::vector<unsigned char> peer(bt.getBitfieldLength(), 0xffu);
+  CPPUNIT_ASSERT_EQUAL(!missing.empty(),
+                       bt.hasMissingPiece(peer.data(), peer.size()));
+}
+} // namespace
+
+void BitfieldManTest::testSummary()
+{
+  // 1000 blocks.  The last word is not full.
+  BitfieldMan bt(1_k, 1000_k - 10);
+  bt.addFilter(100_k, 500_k);
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<size_t> dist(0, bt.countBlock() - 1);
+  checkSummary(bt);
+  for (int i = 0; i < 3000; ++i) {
+    size_t index = dist(gen);
+    switch (gen() % 4) {
+    case 0:
+    case 1:
+      bt.setBit(index);
+      break;
+    case 2:
+      bt.unsetBit(index);
+      break;
+    default:
+      if (bt.isUseBitSet(index)) {
+        bt.unsetUseBit(index);
+      }
+      else {
+        bt.setUseBit(index);
+      }
+    }
+    if (i == 1500) {
+      bt.enableFilter();
+    }
+    if (i % 100 == 0) {
+      checkSummary(bt);
+    }
+  }
+  checkSummary(bt);
+  bt.setAllBit();
+  checkSummary(bt);
+  bt.clearAllBit();
+  bt.setAllUseBit();
+  checkSummary(bt);
+  bt.clearAllUseBit();
+  checkSummary(bt);
+
+  BitfieldMan copy(bt);
+  checkSummary(copy);
+}
+
+void BitfieldManTest::testSummary_sparse()
+{
+  BitfieldMan bt(1_k, 200_k);
+  unsigned char ignoreBitfield[25];
+  memset(ignoreBitfield, 0, sizeof(ignoreBitfield));
+  // The first 2 words are completed or in use.
+  bt.setBitRange(0, 63);
+  for (size_t i = 64; i < 128; ++i) {
+    bt.setUseBit(i);
+  }
+  size_t index;
+  CPPUNIT_ASSERT(bt.getSparseMissingUnusedIndex(index, 1_k, ignoreBitfield,
+                                                sizeof(ignoreBitfield)));
+  CPPUNIT_ASSERT_EQUAL((size_t)164, index);
+  CPPUNIT_ASSERT(bt.getInorderMissingUnusedIndex(index, 1_k, ignoreBitfield,
+                                                 sizeof(ignoreBitfield)));
+  CPPUNIT_ASSERT_EQUAL((size_t)128, index);
+  bt.unsetUseBit(100);
+  CPPUNIT_ASSERT(bt.getInorderMissingUnusedIndex(index, 1_k, ignoreBitfield,
+                                                 sizeof(ignoreBitfield)));
+  CPPUNIT_ASSERT_EQUAL((size_t)100, index);
+}
+
 } // namespace aria2
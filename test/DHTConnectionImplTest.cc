@@ -6,6 +6,7 @@
 #include "Exception.h"
 #include "SocketCore.h"
 #include "A2STR.h"
+#include "util.h"
 
 namespace aria2 {
 
@@ -13,6 +14,7 @@ class DHTConnectionImplTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(DHTConnectionImplTest);
   CPPUNIT_TEST(testWriteAndReadData);
+  CPPUNIT_TEST(testWriteAndReadData_batch);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -21,6 +23,7 @@ public:
   void tearDown() {}
 
   void testWriteAndReadData();
+  void testWriteAndReadData_batch();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DHTConnectionImplTest);
@@ -59,4 +62,54 @@ void DHTConnectionImplTest::testWriteAndReadData()
   }
 }
 
+void DHTConnectionImplTest::testWriteAndReadData_batch()
+{
+  try {
+    DHTConnectionImpl con1(AF_INET);
+    con1.setBatchSize(2);
+    uint16_t con1port = 0;
+    CPPUNIT_ASSERT(con1.bind(con1port, A2STR::NIL));
+
+    DHTConnectionImpl con2(AF_INET);
+    con2.setBatchSize(2);
+    uint16_t con2port = 0;
+    CPPUNIT_ASSERT(con2.bind(con2port, A2STR::NIL));
+
+    // The third message makes the buffer full and the first 2
+    // messages are sent.
+    for (int i = 0; i < 3; ++i) {
+      std::string message = "hello " + util::itos(i);
+      CPPUNIT_ASSERT_EQUAL(
+          (ssize_t)message.size(),
+          con1.sendMessage(
+              reinterpret_cast<const unsigned char*>(message.c_str()),
+              message.size(), "127.0.0.1", con2port));
+    }
+    // Non-numeric host is sent after the buffered ones.
+    std::string message = "hello 3";
+    con1.sendMessage(reinterpret_cast<const unsigned char*>(message.c_str()),
+                     message.size(), "localhost", con2port);
+
+    unsigned char readbuffer[100];
+    std::string remoteHost;
+    uint16_t remotePort;
+    for (int i = 0; i < 4; ++i) {
+      ssize_t rlength;
+      while ((rlength = con2.receiveMessage(readbuffer, sizeof(readbuffer),
+                                            remoteHost, remotePort)) == 0)
+        ;
+      CPPUNIT_ASSERT_EQUAL("hello " + util::itos(i),
+                           std::string(&readbuffer[0], &readbuffer[rlength]));
+      CPPUNIT_ASSERT_EQUAL(std::string("127.0.0.1"), remoteHost);
+      CPPUNIT_ASSERT_EQUAL(con1port, remotePort);
+    }
+    CPPUNIT_ASSERT_EQUAL((ssize_t)0,
+                         con2.receiveMessage(readbuffer, sizeof(readbuffer),
+                                             remoteHost, remotePort));
+  }
+  catch (Exception& e) {
+    CPPUNIT_FAIL(e.stackTrace());
+  }
+}
+
 } // namespace aria2
@@ -0,0 +1,47 @@
+#include "DatagramRing.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace aria2 {
+
+class DatagramRingTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(DatagramRingTest);
+  CPPUNIT_TEST(testPushAndPop);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testPushAndPop();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DatagramRingTest);
+
+void DatagramRingTest::testPushAndPop()
+{
+  DatagramRing ring(3, 10);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, ring.capacity());
+  CPPUNIT_ASSERT_EQUAL((size_t)10, ring.getMaxDatagramLength());
+  CPPUNIT_ASSERT(ring.empty());
+  for (size_t i = 0; i < 2; ++i) {
+    ring.getFreeSlot(i).length = i;
+  }
+  ring.pushBack(2);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, ring.size());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, ring.front().length);
+  ring.popFront();
+  CPPUNIT_ASSERT_EQUAL((size_t)1, ring.front().length);
+  // Wraps around.
+  for (size_t i = 0; i < 2; ++i) {
+    ring.getFreeSlot(i).length = i + 2;
+  }
+  ring.pushBack(2);
+  CPPUNIT_ASSERT(ring.full());
+  for (size_t i = 0; i < 3; ++i) {
+    CPPUNIT_ASSERT_EQUAL(i + 1, ring.get(i).length);
+    CPPUNIT_ASSERT(ring.get(i).data != ring.get((i + 1) % 3).data);
+  }
+  ring.popFront(3);
+  CPPUNIT_ASSERT(ring.empty());
+}
+
+} // namespace aria2
@@ -18,6 +18,9 @@
 #include "DownloadContext.h"
 #include "bittorrent_helper.h"
 #include "PeerConnection.h"
+#include "DefaultPieceStorage.h"
+#include "EndGameManager.h"
+#include "wallclock.h"
 
 namespace aria2 {
 
@@ -32,11 +35,13 @@ class DefaultBtMessageDispatcherTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testDoCancelSendingPieceAction);
   CPPUNIT_TEST(testCheckRequestSlotAndDoNecessaryThing);
   CPPUNIT_TEST(testCheckRequestSlotAndDoNecessaryThing_timeout);
+  CPPUNIT_TEST(testCheckRequestSlotAndDoNecessaryThing_stalled);
   CPPUNIT_TEST(testCheckRequestSlotAndDoNecessaryThing_completeBlock);
   CPPUNIT_TEST(testCountOutstandingRequest);
   CPPUNIT_TEST(testIsOutstandingRequest);
   CPPUNIT_TEST(testGetOutstandingRequest);
   CPPUNIT_TEST(testRemoveOutstandingRequest);
+  CPPUNIT_TEST(testCancelAcquiredRequests_endGame);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -58,11 +63,13 @@ public:
   void testDoCancelSendingPieceAction();
   void testCheckRequestSlotAndDoNecessaryThing();
   void testCheckRequestSlotAndDoNecessaryThing_timeout();
+  void testCheckRequestSlotAndDoNecessaryThing_stalled();
   void testCheckRequestSlotAndDoNecessaryThing_completeBlock();
   void testCountOutstandingRequest();
   void testIsOutstandingRequest();
   void testGetOutstandingRequest();
   void testRemoveOutstandingRequest();
+  void testCancelAcquiredRequests_endGame();
 
   struct EventCheck {
     EventCheck()
@@ -240,7 +247,8 @@ void DefaultBtMessageDispatcherTest::
   btMessageDispatcher->addOutstandingRequest(std::move(slot));
   btMessageDispatcher->checkRequestSlotAndDoNecessaryThing();
 
-  CPPUNIT_ASSERT_EQUAL((size_t)0,
+  // CANCEL is sent for the dropped request.
+  CPPUNIT_ASSERT_EQUAL((size_t)1,
                        btMessageDispatcher->getMessageQueue().size());
   CPPUNIT_ASSERT_EQUAL((size_t)0,
                        btMessageDispatcher->getRequestSlots().size());
@@ -248,6 +256,49 @@ void DefaultBtMessageDispatcherTest::
   CPPUNIT_ASSERT_EQUAL(true, peer->snubbing());
 }
 
+void DefaultBtMessageDispatcherTest::
+    testCheckRequestSlotAndDoNecessaryThing_stalled()
+{
+  DefaultPieceStorage ps(dctx_, option_.get());
+  ps.enterEndGame();
+  auto egm = ps.getEndGameManager();
+  auto piece = std::make_shared<Piece>(0, MY_PIECE_LENGTH);
+  size_t index;
+  CPPUNIT_ASSERT(piece->getMissingUnusedBlockIndex(index));
+
+  global::wallclock().reset();
+  // The adaptive timeout is MIN_REQUEST_TIMEOUT.
+  peer->updateRequestLatency(std::chrono::milliseconds(100));
+  btMessageDispatcher->setPieceStorage(&ps);
+  btMessageDispatcher->setRequestTimeout(1_min);
+  btMessageDispatcher->addOutstandingRequest(
+      make_unique<RequestSlot>(0, 0, MY_PIECE_LENGTH, 0, piece));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, egm->countRequest(0, 0));
+
+  global::wallclock().advance(std::chrono::seconds(10));
+  btMessageDispatcher->checkRequestSlotAndDoNecessaryThing();
+  // The block can be requested from other peers, but the request is
+  // kept and the peer is not snubbed.
+  CPPUNIT_ASSERT_EQUAL((size_t)0, egm->countRequest(0, 0));
+  CPPUNIT_ASSERT_EQUAL((size_t)0,
+                       btMessageDispatcher->getMessageQueue().size());
+  CPPUNIT_ASSERT_EQUAL((size_t)1,
+                       btMessageDispatcher->getRequestSlots().size());
+  CPPUNIT_ASSERT(btMessageDispatcher->getRequestSlots()[0]->isReleased());
+  CPPUNIT_ASSERT(!peer->snubbing());
+
+  global::wallclock().advance(std::chrono::minutes(1));
+  btMessageDispatcher->checkRequestSlotAndDoNecessaryThing();
+  CPPUNIT_ASSERT_EQUAL((size_t)1,
+                       btMessageDispatcher->getMessageQueue().size());
+  CPPUNIT_ASSERT_EQUAL((size_t)0,
+                       btMessageDispatcher->getRequestSlots().size());
+  CPPUNIT_ASSERT(peer->snubbing());
+  global::wallclock().reset();
+  // Destroy the dispatcher before ps.
+  btMessageDispatcher.reset();
+}
+
 void DefaultBtMessageDispatcherTest::
     testCheckRequestSlotAndDoNecessaryThing_completeBlock()
 {
@@ -322,4 +373,45 @@ void DefaultBtMessageDispatcherTest::testRemoveOutstandingRequest()
   CPPUNIT_ASSERT(!piece->isBlockUsed(blockIndex));
 }
 
+void DefaultBtMessageDispatcherTest::testCancelAcquiredRequests_endGame()
+{
+  DefaultPieceStorage ps(dctx_, option_.get());
+  // Created when end game mode is entered.
+  CPPUNIT_ASSERT(!ps.getEndGameManager());
+  auto piece = std::make_shared<Piece>(0, 32_k);
+  EndGameManager* egm;
+  {
+    DefaultBtMessageDispatcher dispatcher;
+    dispatcher.setPeer(peer);
+    dispatcher.setDownloadContext(dctx_.get());
+    dispatcher.setBtMessageFactory(messageFactory_.get());
+    dispatcher.setCuid(1);
+    dispatcher.setPieceStorage(&ps);
+    // Not tracked before end game
+    dispatcher.addOutstandingRequest(
+        make_unique<RequestSlot>(0, 0, 16_k, 0, piece));
+    ps.enterEndGame();
+    egm = ps.getEndGameManager();
+    CPPUNIT_ASSERT(egm);
+    CPPUNIT_ASSERT_EQUAL((size_t)0, egm->countRequest(0, 0));
+    dispatcher.addOutstandingRequest(
+        make_unique<RequestSlot>(0, 16_k, 16_k, 1, piece));
+    CPPUNIT_ASSERT_EQUAL((size_t)1, egm->countRequest(0, 0));
+    CPPUNIT_ASSERT_EQUAL((size_t)1, egm->countRequest(0, 1));
+    egm->addRequest(2, 0, 0);
+    egm->addRequest(2, 0, 1);
+
+    // The connection 2 received block 0.
+    piece->completeBlock(0);
+    egm->onBlockReceived(2, 0, 0);
+    CPPUNIT_ASSERT(egm->popCancelRequired(1));
+    dispatcher.cancelAcquiredRequests();
+    CPPUNIT_ASSERT_EQUAL((size_t)1, dispatcher.getMessageQueue().size());
+    CPPUNIT_ASSERT_EQUAL((size_t)1, dispatcher.getRequestSlots().size());
+    CPPUNIT_ASSERT_EQUAL((size_t)2, egm->countRequest(0, 1));
+  }
+  // Requests are untracked when the connection goes away.
+  CPPUNIT_ASSERT_EQUAL((size_t)1, egm->countRequest(0, 1));
+}
+
 } // namespace aria2
@@ -10,6 +10,7 @@
 #include "Option.h"
 #include "BtRuntime.h"
 #include "array_fun.h"
+#include "wallclock.h"
 
 namespace aria2 {
 
@@ -22,9 +23,11 @@ class DefaultPeerStorageTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testAddAndCheckoutPeer);
   CPPUNIT_TEST(testIsPeerAvailable);
   CPPUNIT_TEST(testCheckoutPeer);
+  CPPUNIT_TEST(testCheckoutPeer_priority);
   CPPUNIT_TEST(testReturnPeer);
   CPPUNIT_TEST(testOnErasingPeer);
   CPPUNIT_TEST(testAddBadPeer);
+  CPPUNIT_TEST(testAddBadPeer_expiry);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -46,9 +49,11 @@ public:
   void testAddAndCheckoutPeer();
   void testIsPeerAvailable();
   void testCheckoutPeer();
+  void testCheckoutPeer_priority();
   void testReturnPeer();
   void testOnErasingPeer();
   void testAddBadPeer();
+  void testAddBadPeer_expiry();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DefaultPeerStorageTest);
@@ -191,6 +196,42 @@ void DefaultPeerStorageTest::testCheckoutPeer()
   CPPUNIT_ASSERT(!ps.checkoutPeer(peers.size() + 1));
 }
 
+void DefaultPeerStorageTest::testCheckoutPeer_priority()
+{
+  DefaultPeerStorage ps;
+
+  auto dropped = std::make_shared<Peer>("192.168.0.1", 1000);
+  dropped->allocateSessionResource(1_m, 10_m);
+  dropped->setDisconnectedGracefully(true);
+  CPPUNIT_ASSERT(ps.addPeer(dropped));
+  CPPUNIT_ASSERT(ps.checkoutPeer(1));
+  ps.returnPeer(dropped);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, ps.getDroppedPeers().size());
+
+  // The peer which disconnected recently comes last, and the local
+  // peer comes first.
+  CPPUNIT_ASSERT(ps.addPeer(std::make_shared<Peer>("192.168.0.1", 1000)));
+  CPPUNIT_ASSERT(ps.addPeer(std::make_shared<Peer>("192.168.0.2", 1000)));
+  auto local = std::make_shared<Peer>("192.168.0.3", 1000);
+  local->setLocalPeer(true);
+  CPPUNIT_ASSERT(ps.addPeer(local));
+  CPPUNIT_ASSERT(ps.addPeer(std::make_shared<Peer>("192.168.0.4", 1000)));
+
+  // The lowest priority peer is removed first.
+  ps.deleteUnusedPeer(1);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, ps.getUnusedPeers().size());
+  CPPUNIT_ASSERT(ps.addPeer(std::make_shared<Peer>("192.168.0.1", 1000)));
+
+  const char* expected[] = {"192.168.0.3", "192.168.0.2", "192.168.0.4",
+                            "192.168.0.1"};
+  for (size_t i = 0; i < arraySize(expected); ++i) {
+    auto p = ps.checkoutPeer(i + 2);
+    CPPUNIT_ASSERT(p);
+    CPPUNIT_ASSERT_EQUAL(std::string(expected[i]), p->getIPAddress());
+  }
+  CPPUNIT_ASSERT(!ps.checkoutPeer(10));
+}
+
 void DefaultPeerStorageTest::testReturnPeer()
 {
   DefaultPeerStorage ps;
@@ -233,4 +274,27 @@ void DefaultPeerStorageTest::testAddBadPeer()
   CPPUNIT_ASSERT(!ps.isBadPeer("192.168.0.2"));
 }
 
+void DefaultPeerStorageTest::testAddBadPeer_expiry()
+{
+  global::wallclock().reset();
+  DefaultPeerStorage ps;
+  ps.addBadPeer("192.168.0.1");
+  ps.addBadPeer("2001:db8::1");
+  CPPUNIT_ASSERT(ps.isBadPeer("2001:db8::1"));
+  CPPUNIT_ASSERT(!ps.isBadPeer("192.168.0.10"));
+  CPPUNIT_ASSERT(!ps.isBadPeer("192.168.0"));
+  CPPUNIT_ASSERT(!ps.addPeer(std::make_shared<Peer>("192.168.0.1", 6889)));
+  // Bad peers last for 120 seconds at least, and 600 seconds at most.
+  global::wallclock().advance(119_s);
+  CPPUNIT_ASSERT(ps.isBadPeer("192.168.0.1"));
+  global::wallclock().advance(482_s);
+  CPPUNIT_ASSERT(!ps.isBadPeer("192.168.0.1"));
+  CPPUNIT_ASSERT(!ps.isBadPeer("2001:db8::1"));
+  CPPUNIT_ASSERT(ps.addPeer(std::make_shared<Peer>("192.168.0.1", 6889)));
+  // Marked bad again
+  ps.addBadPeer("192.168.0.1");
+  CPPUNIT_ASSERT(ps.isBadPeer("192.168.0.1"));
+  global::wallclock().reset();
+}
+
 } // namespace aria2
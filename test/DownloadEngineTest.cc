@@ -0,0 +1,140 @@
+#include "DownloadEngine.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "SelectEventPoll.h"
+#include "Command.h"
+#include "SocketCore.h"
+#include "Http2Session.h"
+#include "wallclock.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+class DownloadEngineTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(DownloadEngineTest);
+  CPPUNIT_TEST(testRun_sleepingCommand);
+  CPPUNIT_TEST(testFindHttp2Session);
+  CPPUNIT_TEST(testEvictHttp2Sessions_idle);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::unique_ptr<DownloadEngine> e_;
+  // The server side of the sessions created by createHttp2Session().
+  std::vector<std::shared_ptr<SocketCore>> servers_;
+
+  std::shared_ptr<Http2Session> createHttp2Session();
+
+public:
+  void setUp()
+  {
+    e_ = make_unique<DownloadEngine>(make_unique<SelectEventPoll>());
+    servers_.clear();
+  }
+
+  void tearDown() { global::wallclock().reset(); }
+
+  void testRun_sleepingCommand();
+  void testFindHttp2Session();
+  void testEvictHttp2Sessions_idle();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DownloadEngineTest);
+
+namespace {
+class MockCommand : public Command {
+private:
+  DownloadEngine* e_;
+  int* executed_;
+
+public:
+  MockCommand(cuid_t cuid, DownloadEngine* e, int* executed)
+      : Command(cuid), e_(e), executed_(executed)
+  {
+  }
+
+  virtual bool execute() CXX11_OVERRIDE
+  {
+    ++*executed_;
+    e_->addCommand(std::unique_ptr<Command>(this));
+    return false;
+  }
+};
+} // namespace
+
+std::shared_ptr<Http2Session> DownloadEngineTest::createHttp2Session()
+{
+  auto client = std::make_shared<SocketCore>();
+  SocketCore serverSocket;
+  serverSocket.bind(0);
+  serverSocket.beginListen();
+  serverSocket.setBlockingMode();
+  client->establishConnection("localhost", serverSocket.getAddrInfo().port);
+  client->setBlockingMode();
+  auto server = serverSocket.acceptConnection();
+  server->setBlockingMode();
+  client->setNonBlockingMode();
+  servers_.push_back(std::move(server));
+  return std::make_shared<Http2Session>(client, nullptr);
+}
+
+void DownloadEngineTest::testRun_sleepingCommand()
+{
+  int sleepingExecuted = 0;
+  int activatedExecuted = 0;
+  auto sleeping = make_unique<MockCommand>(1, e_.get(), &sleepingExecuted);
+  auto activated = make_unique<MockCommand>(2, e_.get(), &activatedExecuted);
+  e_->sleepCommand(sleeping.get(), 60_s);
+  e_->sleepCommand(activated.get(), 60_s);
+  // Raised by a socket event or a wake up from another command
+  // before the sleep expires.
+  activated->setStatusActive();
+  auto activatedPtr = activated.get();
+  e_->addCommand(std::move(sleeping));
+  e_->addCommand(std::move(activated));
+
+  // The first turn executes all commands (STATUS_ALL).
+  CPPUNIT_ASSERT_EQUAL(1, e_->run(true));
+  CPPUNIT_ASSERT_EQUAL(0, sleepingExecuted);
+  CPPUNIT_ASSERT_EQUAL(1, activatedExecuted);
+  CPPUNIT_ASSERT(!activatedPtr->isSleeping());
+}
+
+void DownloadEngineTest::testFindHttp2Session()
+{
+  auto s1 = createHttp2Session();
+  auto s2 = createHttp2Session();
+  e_->addHttp2Session("alpha", 443, s1);
+  e_->addHttp2Session("bravo", 443, s2);
+  CPPUNIT_ASSERT(s1 == e_->findHttp2Session("alpha", 443));
+  CPPUNIT_ASSERT(s2 == e_->findHttp2Session("bravo", 443));
+  CPPUNIT_ASSERT(!e_->findHttp2Session("alpha", 80));
+
+  // GOAWAY, last stream ID 0, NO_ERROR
+  const char goaway[] = "\x00\x00\x08\x07\x00\x00\x00\x00\x00"
+                        "\x00\x00\x00\x00\x00\x00\x00\x00";
+  servers_[0]->writeData(goaway, sizeof(goaway) - 1);
+  CPPUNIT_ASSERT(!e_->findHttp2Session("alpha", 443));
+  CPPUNIT_ASSERT(!s1->isOpen());
+  // The lookup leaves the closed session to evictHttp2Sessions().
+  CPPUNIT_ASSERT_EQUAL(2L, s1.use_count());
+
+  e_->evictHttp2Sessions();
+  CPPUNIT_ASSERT_EQUAL(1L, s1.use_count());
+  CPPUNIT_ASSERT(s2 == e_->findHttp2Session("bravo", 443));
+}
+
+void DownloadEngineTest::testEvictHttp2Sessions_idle()
+{
+  auto session = createHttp2Session();
+  e_->addHttp2Session("alpha", 443, session);
+  global::wallclock().advance(16_s);
+  CPPUNIT_ASSERT(!e_->findHttp2Session("alpha", 443));
+  CPPUNIT_ASSERT_EQUAL(2L, session.use_count());
+
+  e_->evictHttp2Sessions();
+  CPPUNIT_ASSERT_EQUAL(1L, session.use_count());
+}
+
+} // namespace aria2
@@ -0,0 +1,105 @@
+#include "EndGameManager.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "a2functional.h"
+
+namespace aria2 {
+
+class EndGameManagerTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(EndGameManagerTest);
+  CPPUNIT_TEST(testAddRequest);
+  CPPUNIT_TEST(testRemoveConnection);
+  CPPUNIT_TEST(testGetRedundancyLimit);
+  CPPUNIT_TEST(testOnBlockReceived);
+  CPPUNIT_TEST(testAddWastedLength);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testAddRequest();
+  void testRemoveConnection();
+  void testGetRedundancyLimit();
+  void testOnBlockReceived();
+  void testAddWastedLength();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(EndGameManagerTest);
+
+void EndGameManagerTest::testAddRequest()
+{
+  EndGameManager egm;
+  egm.addRequest(1, 0, 0);
+  egm.addRequest(2, 0, 0);
+  // Duplicate request from the same connection is counted once.
+  egm.addRequest(2, 0, 0);
+  egm.addRequest(1, 0, 1);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, egm.countRequest(0, 0));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, egm.countRequest(0, 1));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, egm.countRequest(1, 0));
+  egm.removeRequest(2, 0, 0);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, egm.countRequest(0, 0));
+  egm.removeRequest(1, 0, 0);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, egm.countRequest(0, 0));
+  // Removing unknown request is no-op.
+  egm.removeRequest(1, 0, 0);
+}
+
+void EndGameManagerTest::testRemoveConnection()
+{
+  EndGameManager egm;
+  egm.addRequest(1, 0, 0);
+  egm.addRequest(2, 0, 0);
+  egm.addRequest(1, 3, 7);
+  egm.onBlockReceived(2, 0, 0);
+  egm.removeConnection(1);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, egm.countRequest(0, 0));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, egm.countRequest(3, 7));
+  CPPUNIT_ASSERT(!egm.popCancelRequired(1));
+}
+
+void EndGameManagerTest::testGetRedundancyLimit()
+{
+  EndGameManager egm;
+  CPPUNIT_ASSERT_EQUAL(EndGameManager::FAST_PEER_REDUNDANCY,
+                       egm.getRedundancyLimit(1, 100_k));
+  // Slower than the average of 55KiB/s
+  CPPUNIT_ASSERT_EQUAL(EndGameManager::SLOW_PEER_REDUNDANCY,
+                       egm.getRedundancyLimit(2, 10_k));
+  CPPUNIT_ASSERT_EQUAL(EndGameManager::FAST_PEER_REDUNDANCY,
+                       egm.getRedundancyLimit(1, 100_k));
+  CPPUNIT_ASSERT_EQUAL(EndGameManager::FAST_PEER_REDUNDANCY,
+                       egm.getRedundancyLimit(2, 200_k));
+  // Stalled connection never duplicates requests.
+  CPPUNIT_ASSERT_EQUAL(EndGameManager::SLOW_PEER_REDUNDANCY,
+                       egm.getRedundancyLimit(3, 0));
+}
+
+void EndGameManagerTest::testOnBlockReceived()
+{
+  EndGameManager egm;
+  egm.addRequest(1, 0, 0);
+  egm.addRequest(2, 0, 0);
+  egm.addRequest(3, 0, 0);
+  egm.addRequest(3, 0, 1);
+  egm.onBlockReceived(1, 0, 0);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, egm.countRequest(0, 0));
+  CPPUNIT_ASSERT(!egm.popCancelRequired(1));
+  CPPUNIT_ASSERT(egm.popCancelRequired(2));
+  CPPUNIT_ASSERT(!egm.popCancelRequired(2));
+  CPPUNIT_ASSERT(egm.popCancelRequired(3));
+  // Nobody else requested the block.
+  egm.onBlockReceived(3, 0, 1);
+  CPPUNIT_ASSERT(!egm.popCancelRequired(3));
+}
+
+void EndGameManagerTest::testAddWastedLength()
+{
+  EndGameManager egm;
+  CPPUNIT_ASSERT_EQUAL((int64_t)0, egm.getWastedLength());
+  egm.addWastedLength(16_k);
+  egm.addWastedLength(16_k);
+  CPPUNIT_ASSERT_EQUAL((int64_t)32_k, egm.getWastedLength());
+}
+
+} // namespace aria2
@@ -0,0 +1,107 @@
+#include "EngineShardMan.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "RequestGroup.h"
+#include "DownloadContext.h"
+#include "GroupId.h"
+#include "Option.h"
+#include "util.h"
+#include "a2functional.h"
+#ifdef ENABLE_BITTORRENT
+#include "bittorrent_helper.h"
+#endif // ENABLE_BITTORRENT
+
+namespace aria2 {
+
+class EngineShardManTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(EngineShardManTest);
+  CPPUNIT_TEST(testSelectShard);
+#ifdef ENABLE_BITTORRENT
+  CPPUNIT_TEST(testSelectShard_bt);
+#endif // ENABLE_BITTORRENT
+  CPPUNIT_TEST(testUpdateDownloadSpeed);
+  CPPUNIT_TEST(testDoesDownloadSpeedExceed);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::shared_ptr<Option> option_;
+
+  std::shared_ptr<RequestGroup> createGroup()
+  {
+    auto group = std::make_shared<RequestGroup>(GroupId::create(),
+                                                util::copy(option_));
+    group->setDownloadContext(std::make_shared<DownloadContext>());
+    return group;
+  }
+
+public:
+  void setUp() { option_ = std::make_shared<Option>(); }
+
+  void testSelectShard();
+#ifdef ENABLE_BITTORRENT
+  void testSelectShard_bt();
+#endif // ENABLE_BITTORRENT
+  void testUpdateDownloadSpeed();
+  void testDoesDownloadSpeedExceed();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(EngineShardManTest);
+
+void EngineShardManTest::testSelectShard()
+{
+  EngineShardMan shardMan(3, option_.get(), nullptr);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, shardMan.getNumShard());
+  auto group = createGroup();
+  // The primary engine wins the tie.
+  CPPUNIT_ASSERT_EQUAL((size_t)0, shardMan.selectShard(group, 0));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, shardMan.selectShard(group, 1));
+  shardMan.assign(1, createGroup());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, shardMan.countGroup());
+  CPPUNIT_ASSERT_EQUAL((size_t)2, shardMan.selectShard(group, 1));
+  shardMan.assign(2, createGroup());
+  CPPUNIT_ASSERT_EQUAL((size_t)2, shardMan.countGroup());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, shardMan.selectShard(group, 1));
+  // The ties among the worker shards are spread over them.
+  CPPUNIT_ASSERT_EQUAL((size_t)1, shardMan.selectShard(group, 2));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, shardMan.selectShard(group, 2));
+}
+
+#ifdef ENABLE_BITTORRENT
+void EngineShardManTest::testSelectShard_bt()
+{
+  EngineShardMan shardMan(2, option_.get(), nullptr);
+  auto group = createGroup();
+  group->getDownloadContext()->setAttribute(CTX_ATTR_BT,
+                                            make_unique<TorrentAttribute>());
+  // BitTorrent downloads stay in the primary engine.
+  CPPUNIT_ASSERT_EQUAL((size_t)0, shardMan.selectShard(group, 10));
+}
+#endif // ENABLE_BITTORRENT
+
+void EngineShardManTest::testUpdateDownloadSpeed()
+{
+  EngineShardMan shardMan(3, option_.get(), nullptr);
+  CPPUNIT_ASSERT_EQUAL(100, shardMan.updateDownloadSpeed(0, 100));
+  CPPUNIT_ASSERT_EQUAL(300, shardMan.updateDownloadSpeed(2, 200));
+  CPPUNIT_ASSERT_EQUAL(250, shardMan.updateDownloadSpeed(0, 50));
+  CPPUNIT_ASSERT_EQUAL(10, shardMan.updateUploadSpeed(1, 10));
+  CPPUNIT_ASSERT_EQUAL(250, shardMan.updateDownloadSpeed(1, 0));
+}
+
+void EngineShardManTest::testDoesDownloadSpeedExceed()
+{
+  EngineShardMan shardMan(2, option_.get(), nullptr);
+  CPPUNIT_ASSERT(!shardMan.doesDownloadSpeedExceed(0, 900, 1000));
+  CPPUNIT_ASSERT(!shardMan.doesDownloadSpeedExceed(1, 100, 1000));
+  // The limit is exceeded.  Only the shard above its share, 500, is
+  // throttled.
+  CPPUNIT_ASSERT(shardMan.doesDownloadSpeedExceed(0, 950, 1000));
+  CPPUNIT_ASSERT(!shardMan.doesDownloadSpeedExceed(1, 100, 1000));
+  CPPUNIT_ASSERT(shardMan.doesDownloadSpeedExceed(1, 600, 1000));
+  CPPUNIT_ASSERT(!shardMan.doesUploadSpeedExceed(0, 600, 1000));
+  CPPUNIT_ASSERT(shardMan.doesUploadSpeedExceed(1, 600, 1000));
+}
+
+} // namespace aria2
@@ -0,0 +1,138 @@
+#include "FileAllocationEntry.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "RequestGroup.h"
+#include "DownloadContext.h"
+#include "PieceStorage.h"
+#include "DiskAdaptor.h"
+#include "GroupId.h"
+#include "Option.h"
+#include "File.h"
+#include "prefs.h"
+#include "a2functional.h"
+#ifdef ENABLE_THREADS
+#include "ThreadPool.h"
+#endif // ENABLE_THREADS
+
+namespace aria2 {
+
+class FileAllocationEntryTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(FileAllocationEntryTest);
+  CPPUNIT_TEST(testAllocateChunk);
+#ifdef ENABLE_THREADS
+  CPPUNIT_TEST(testAllocateChunk_threadPool);
+  CPPUNIT_TEST(testCancel);
+#endif // ENABLE_THREADS
+  CPPUNIT_TEST_SUITE_END();
+
+  std::shared_ptr<Option> option_;
+
+public:
+  void setUp()
+  {
+    option_ = std::make_shared<Option>();
+    option_->put(PREF_DIR, A2_TEST_OUT_DIR);
+    option_->put(PREF_FILE_ALLOCATION, V_PREALLOC);
+  }
+
+  void testAllocateChunk();
+#ifdef ENABLE_THREADS
+  void testAllocateChunk_threadPool();
+  void testCancel();
+#endif // ENABLE_THREADS
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FileAllocationEntryTest);
+
+namespace {
+class TestFileAllocationEntry : public FileAllocationEntry {
+public:
+  TestFileAllocationEntry(RequestGroup* requestGroup)
+      : FileAllocationEntry(requestGroup)
+  {
+  }
+
+  virtual void
+  prepareForNextAction(std::vector<std::unique_ptr<Command>>& commands,
+                       DownloadEngine* e) CXX11_OVERRIDE
+  {
+  }
+};
+
+std::shared_ptr<RequestGroup> createRequestGroup(std::shared_ptr<Option> option,
+                                                 const std::string& filename,
+                                                 int64_t totalLength)
+{
+  auto path = std::string(A2_TEST_OUT_DIR) + "/" + filename;
+  File(path).remove();
+  auto group = std::make_shared<RequestGroup>(GroupId::create(), option);
+  group->setDownloadContext(
+      std::make_shared<DownloadContext>(1_m, totalLength, path));
+  group->initPieceStorage();
+  group->getPieceStorage()->getDiskAdaptor()->initAndOpenFile();
+  return group;
+}
+} // namespace
+
+void FileAllocationEntryTest::testAllocateChunk()
+{
+  auto group = createRequestGroup(
+      option_, "aria2_FileAllocationEntryTest_testAllocateChunk", 1_m + 7);
+  TestFileAllocationEntry entry(group.get());
+  while (!entry.finished()) {
+    entry.allocateChunk();
+  }
+  CPPUNIT_ASSERT_EQUAL((int64_t)(1_m + 7), entry.getCurrentLength());
+  CPPUNIT_ASSERT_EQUAL((int64_t)(1_m + 7),
+                       File(group->getFirstFilePath()).size());
+}
+
+#ifdef ENABLE_THREADS
+void FileAllocationEntryTest::testAllocateChunk_threadPool()
+{
+  ThreadPool pool(2);
+  auto group1 = createRequestGroup(
+      option_, "aria2_FileAllocationEntryTest_threadPool1", 4_m + 1);
+  auto group2 = createRequestGroup(
+      option_, "aria2_FileAllocationEntryTest_threadPool2", 3_m);
+  TestFileAllocationEntry entry1(group1.get());
+  TestFileAllocationEntry entry2(group2.get());
+  entry1.setThreadPool(&pool);
+  entry2.setThreadPool(&pool);
+
+  entry1.allocateChunk();
+  entry2.allocateChunk();
+  CPPUNIT_ASSERT(!entry1.finished());
+  CPPUNIT_ASSERT(!entry2.finished());
+  CPPUNIT_ASSERT(entry1.allocatingInBackground());
+
+  while (!entry1.finished() || !entry2.finished()) {
+    entry1.allocateChunk();
+    entry2.allocateChunk();
+  }
+  CPPUNIT_ASSERT(!entry1.allocatingInBackground());
+  CPPUNIT_ASSERT_EQUAL((int64_t)(4_m + 1), entry1.getCurrentLength());
+  CPPUNIT_ASSERT_EQUAL((int64_t)(4_m + 1),
+                       File(group1->getFirstFilePath()).size());
+  CPPUNIT_ASSERT_EQUAL((int64_t)3_m, entry2.getCurrentLength());
+  CPPUNIT_ASSERT_EQUAL((int64_t)3_m, File(group2->getFirstFilePath()).size());
+}
+
+void FileAllocationEntryTest::testCancel()
+{
+  ThreadPool pool(1);
+  auto group = createRequestGroup(
+      option_, "aria2_FileAllocationEntryTest_testCancel", 64_m);
+  {
+    TestFileAllocationEntry entry(group.get());
+    entry.setThreadPool(&pool);
+    entry.allocateChunk();
+    // The destructor must wait for the worker thread.
+  }
+  CPPUNIT_ASSERT(File(group->getFirstFilePath()).size() <= (int64_t)64_m);
+}
+#endif // ENABLE_THREADS
+
+} // namespace aria2
@@ -24,6 +24,7 @@ class HandshakeExtensionMessageTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testDoReceivedAction);
   CPPUNIT_TEST(testCreate);
   CPPUNIT_TEST(testCreate_stringnum);
+  CPPUNIT_TEST(testCreate_reqq);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -38,6 +39,7 @@ public:
   void testDoReceivedAction();
   void testCreate();
   void testCreate_stringnum();
+  void testCreate_reqq();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(HandshakeExtensionMessageTest);
@@ -134,7 +136,8 @@ void HandshakeExtensionMessageTest::testDoReceivedAction()
 void HandshakeExtensionMessageTest::testCreate()
 {
   std::string in =
-      "0d1:pi6881e1:v5:aria21:md5:a2dhti2e6:ut_pexi1ee13:metadata_sizei1024ee";
+      "0d1:pi6881e4:reqqi500e1:v5:aria21:md5:a2dhti2e6:ut_pexi1ee"
+      "13:metadata_sizei1024ee";
   std::shared_ptr<HandshakeExtensionMessage> m(
       HandshakeExtensionMessage::create(
           reinterpret_cast<const unsigned char*>(in.c_str()), in.size()));
@@ -143,6 +146,7 @@ void HandshakeExtensionMessageTest::testCreate()
   CPPUNIT_ASSERT_EQUAL(
       (uint8_t)1, m->getExtensionMessageID(ExtensionMessageRegistry::UT_PEX));
   CPPUNIT_ASSERT_EQUAL((size_t)1_k, m->getMetadataSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)500, m->getReqq());
   try {
     // bad payload format
     std::string in = "011:hello world";
@@ -189,4 +193,17 @@ void HandshakeExtensionMessageTest::testCreate_stringnum()
       (uint8_t)0, m->getExtensionMessageID(ExtensionMessageRegistry::UT_PEX));
 }
 
+void HandshakeExtensionMessageTest::testCreate_reqq()
+{
+  std::string in = "0d4:reqqi1000000ee";
+  auto m = HandshakeExtensionMessage::create(
+      reinterpret_cast<const unsigned char*>(in.c_str()), in.size());
+  CPPUNIT_ASSERT_EQUAL((size_t)UB_MAX_REQQ_OUTSTANDING_REQUEST, m->getReqq());
+
+  in = "0d4:reqqi-1ee";
+  m = HandshakeExtensionMessage::create(
+      reinterpret_cast<const unsigned char*>(in.c_str()), in.size());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, m->getReqq());
+}
+
 } // namespace aria2
@@ -0,0 +1,319 @@
+#include "hpack.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "HpackDecoder.h"
+#include "DlAbortEx.h"
+#include "util.h"
+
+namespace aria2 {
+
+class HpackTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(HpackTest);
+  CPPUNIT_TEST(testEncodeInteger);
+  CPPUNIT_TEST(testDecodeInteger);
+  CPPUNIT_TEST(testHuffmanEncode);
+  CPPUNIT_TEST(testHuffmanDecode);
+  CPPUNIT_TEST(testHuffmanDecode_invalid);
+  CPPUNIT_TEST(testEncodeHeaderBlock);
+  CPPUNIT_TEST(testDecode_withoutHuffman);
+  CPPUNIT_TEST(testDecode_withHuffman);
+  CPPUNIT_TEST(testDecode_eviction);
+  CPPUNIT_TEST(testDecode_invalid);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testEncodeInteger();
+  void testDecodeInteger();
+  void testHuffmanEncode();
+  void testHuffmanDecode();
+  void testHuffmanDecode_invalid();
+  void testEncodeHeaderBlock();
+  void testDecode_withoutHuffman();
+  void testDecode_withHuffman();
+  void testDecode_eviction();
+  void testDecode_invalid();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HpackTest);
+
+namespace {
+std::string fromHex(const std::string& s)
+{
+  return util::fromHex(s.begin(), s.end());
+}
+
+std::vector<hpack::HeaderField> decode(HpackDecoder& decoder,
+                                       const std::string& hex)
+{
+  auto block = fromHex(hex);
+  std::vector<hpack::HeaderField> headers;
+  decoder.decode(headers, reinterpret_cast<const unsigned char*>(block.data()),
+                 block.size());
+  return headers;
+}
+
+std::string huffmanDecode(const std::string& hex)
+{
+  auto s = fromHex(hex);
+  return hpack::huffmanDecode(reinterpret_cast<const unsigned char*>(s.data()),
+                              s.size());
+}
+} // namespace
+
+void HpackTest::testEncodeInteger()
+{
+  // Examples in RFC 7541, Appendix C.1
+  std::string out;
+  hpack::encodeInteger(out, 0, 5, 10);
+  CPPUNIT_ASSERT_EQUAL(std::string("0a"), util::toHex(out));
+  out.clear();
+  hpack::encodeInteger(out, 0, 5, 1337);
+  CPPUNIT_ASSERT_EQUAL(std::string("1f9a0a"), util::toHex(out));
+  out.clear();
+  hpack::encodeInteger(out, 0, 8, 42);
+  CPPUNIT_ASSERT_EQUAL(std::string("2a"), util::toHex(out));
+  out.clear();
+  hpack::encodeInteger(out, 0x80, 7, 2);
+  CPPUNIT_ASSERT_EQUAL(std::string("82"), util::toHex(out));
+}
+
+void HpackTest::testDecodeInteger()
+{
+  uint64_t value;
+  auto s = fromHex("ff9a0a");
+  auto data = reinterpret_cast<const unsigned char*>(s.data());
+  CPPUNIT_ASSERT_EQUAL((size_t)3, hpack::decodeInteger(value, data, 3, 5));
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1337, value);
+  // Incomplete
+  CPPUNIT_ASSERT_EQUAL((size_t)0, hpack::decodeInteger(value, data, 2, 5));
+
+  s = fromHex("3e");
+  data = reinterpret_cast<const unsigned char*>(s.data());
+  CPPUNIT_ASSERT_EQUAL((size_t)1, hpack::decodeInteger(value, data, 1, 6));
+  CPPUNIT_ASSERT_EQUAL((uint64_t)62, value);
+
+  s = fromHex("1fffffffffffffffffff01");
+  data = reinterpret_cast<const unsigned char*>(s.data());
+  try {
+    hpack::decodeInteger(value, data, s.size(), 5);
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (DlAbortEx& e) {
+  }
+}
+
+void HpackTest::testHuffmanEncode()
+{
+  // Examples in RFC 7541, Appendix C.4
+  std::string out;
+  hpack::huffmanEncode(out, "www.example.com");
+  CPPUNIT_ASSERT_EQUAL(std::string("f1e3c2e5f23a6ba0ab90f4ff"),
+                       util::toHex(out));
+  CPPUNIT_ASSERT_EQUAL((size_t)12,
+                       hpack::huffmanEncodedLength("www.example.com"));
+  out.clear();
+  hpack::huffmanEncode(out, "no-cache");
+  CPPUNIT_ASSERT_EQUAL(std::string("a8eb10649cbf"), util::toHex(out));
+  out.clear();
+  hpack::huffmanEncode(out, "custom-value");
+  CPPUNIT_ASSERT_EQUAL(std::string("25a849e95bb8e8b4bf"), util::toHex(out));
+}
+
+void HpackTest::testHuffmanDecode()
+{
+  CPPUNIT_ASSERT_EQUAL(std::string("www.example.com"),
+                       huffmanDecode("f1e3c2e5f23a6ba0ab90f4ff"));
+  CPPUNIT_ASSERT_EQUAL(std::string("custom-key"),
+                       huffmanDecode("25a849e95ba97d7f"));
+  CPPUNIT_ASSERT_EQUAL(std::string(), huffmanDecode(""));
+
+  std::string s;
+  for (int i = 0; i < 256; ++i) {
+    s += static_cast<char>(i);
+  }
+  std::string out;
+  hpack::huffmanEncode(out, s);
+  CPPUNIT_ASSERT_EQUAL(out.size(), hpack::huffmanEncodedLength(s));
+  CPPUNIT_ASSERT(s ==
+                 hpack::huffmanDecode(
+                     reinterpret_cast<const unsigned char*>(out.data()),
+                     out.size()));
+}
+
+void HpackTest::testHuffmanDecode_invalid()
+{
+  // Padding longer than 7 bits
+  try {
+    huffmanDecode("f1e3c2e5f23a6ba0ab90f4ffff");
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (DlAbortEx& e) {
+  }
+  // Padding which is not the prefix of EOS
+  try {
+    huffmanDecode("a8eb10649cbe");
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (DlAbortEx& e) {
+  }
+  // EOS
+  try {
+    huffmanDecode("fffffffc");
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (DlAbortEx& e) {
+  }
+}
+
+void HpackTest::testEncodeHeaderBlock()
+{
+  std::vector<hpack::HeaderField> headers{
+      {":method", "GET"},
+      {":scheme", "https"},
+      {":path", "/index.html"},
+      {":authority", "www.example.com"},
+      {"user-agent", "aria2"},
+      {"authorization", "Basic Zm9vOmJhcg=="},
+      {"x-custom", "custom-value"}};
+  std::string out;
+  hpack::encodeHeaderBlock(out, headers);
+  // :method GET, :scheme https and :path /index.html are in the
+  // static table.
+  CPPUNIT_ASSERT_EQUAL(std::string("828785"), util::toHex(out.substr(0, 3)));
+
+  HpackDecoder decoder;
+  std::vector<hpack::HeaderField> decoded;
+  decoder.decode(decoded, reinterpret_cast<const unsigned char*>(out.data()),
+                 out.size());
+  CPPUNIT_ASSERT(headers == decoded);
+  // Nothing is indexed by the encoder.
+  CPPUNIT_ASSERT_EQUAL((size_t)0, decoder.getNumTableEntries());
+}
+
+void HpackTest::testDecode_withoutHuffman()
+{
+  // Examples in RFC 7541, Appendix C.3
+  HpackDecoder decoder;
+  auto headers = decode(decoder, "828684410f7777772e6578616d706c652e636f6d");
+  CPPUNIT_ASSERT_EQUAL((size_t)4, headers.size());
+  CPPUNIT_ASSERT_EQUAL(std::string(":method"), headers[0].first);
+  CPPUNIT_ASSERT_EQUAL(std::string("GET"), headers[0].second);
+  CPPUNIT_ASSERT_EQUAL(std::string(":scheme"), headers[1].first);
+  CPPUNIT_ASSERT_EQUAL(std::string("http"), headers[1].second);
+  CPPUNIT_ASSERT_EQUAL(std::string(":path"), headers[2].first);
+  CPPUNIT_ASSERT_EQUAL(std::string("/"), headers[2].second);
+  CPPUNIT_ASSERT_EQUAL(std::string(":authority"), headers[3].first);
+  CPPUNIT_ASSERT_EQUAL(std::string("www.example.com"), headers[3].second);
+  CPPUNIT_ASSERT_EQUAL((size_t)57, decoder.getTableSize());
+
+  headers = decode(decoder, "828684be58086e6f2d6361636865");
+  CPPUNIT_ASSERT_EQUAL((size_t)5, headers.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("www.example.com"), headers[3].second);
+  CPPUNIT_ASSERT_EQUAL(std::string("cache-control"), headers[4].first);
+  CPPUNIT_ASSERT_EQUAL(std::string("no-cache"), headers[4].second);
+  CPPUNIT_ASSERT_EQUAL((size_t)110, decoder.getTableSize());
+
+  headers = decode(decoder, "828785bf400a637573746f6d2d6b65790c637573746f6d2d"
+                            "76616c7565");
+  CPPUNIT_ASSERT_EQUAL((size_t)5, headers.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("https"), headers[1].second);
+  CPPUNIT_ASSERT_EQUAL(std::string("/index.html"), headers[2].second);
+  CPPUNIT_ASSERT_EQUAL(std::string("www.example.com"), headers[3].second);
+  CPPUNIT_ASSERT_EQUAL(std::string("custom-key"), headers[4].first);
+  CPPUNIT_ASSERT_EQUAL(std::string("custom-value"), headers[4].second);
+  CPPUNIT_ASSERT_EQUAL((size_t)164, decoder.getTableSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)3, decoder.getNumTableEntries());
+}
+
+void HpackTest::testDecode_withHuffman()
+{
+  // Examples in RFC 7541, Appendix C.4
+  HpackDecoder decoder;
+  auto headers = decode(decoder, "828684418cf1e3c2e5f23a6ba0ab90f4ff");
+  CPPUNIT_ASSERT_EQUAL((size_t)4, headers.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("www.example.com"), headers[3].second);
+
+  headers = decode(decoder, "828684be5886a8eb10649cbf");
+  CPPUNIT_ASSERT_EQUAL((size_t)5, headers.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("no-cache"), headers[4].second);
+
+  headers =
+      decode(decoder, "828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf");
+  CPPUNIT_ASSERT_EQUAL((size_t)5, headers.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("custom-key"), headers[4].first);
+  CPPUNIT_ASSERT_EQUAL(std::string("custom-value"), headers[4].second);
+  CPPUNIT_ASSERT_EQUAL((size_t)164, decoder.getTableSize());
+}
+
+void HpackTest::testDecode_eviction()
+{
+  // Examples in RFC 7541, Appendix C.5
+  HpackDecoder decoder(256);
+  auto headers = decode(
+      decoder, "4803333032580770726976617465611d4d6f6e2c203231204f637420323031"
+               "332032303a31333a323120474d546e1768747470733a2f2f7777772e6578"
+               "616d706c652e636f6d");
+  CPPUNIT_ASSERT_EQUAL((size_t)4, headers.size());
+  CPPUNIT_ASSERT_EQUAL(std::string(":status"), headers[0].first);
+  CPPUNIT_ASSERT_EQUAL(std::string("302"), headers[0].second);
+  CPPUNIT_ASSERT_EQUAL(std::string("location"), headers[3].first);
+  CPPUNIT_ASSERT_EQUAL(std::string("https://www.example.com"),
+                       headers[3].second);
+  CPPUNIT_ASSERT_EQUAL((size_t)222, decoder.getTableSize());
+
+  // ":status: 307" evicts ":status: 302".
+  headers = decode(decoder, "4803333037c1c0bf");
+  CPPUNIT_ASSERT_EQUAL((size_t)4, headers.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("307"), headers[0].second);
+  CPPUNIT_ASSERT_EQUAL(std::string("private"), headers[1].second);
+  CPPUNIT_ASSERT_EQUAL(std::string("Mon, 21 Oct 2013 20:13:21 GMT"),
+                       headers[2].second);
+  CPPUNIT_ASSERT_EQUAL(std::string("https://www.example.com"),
+                       headers[3].second);
+  CPPUNIT_ASSERT_EQUAL((size_t)222, decoder.getTableSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)4, decoder.getNumTableEntries());
+
+  // Dynamic table size update to 0 empties the table.
+  headers = decode(decoder, "2082");
+  CPPUNIT_ASSERT_EQUAL((size_t)1, headers.size());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, decoder.getTableSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, decoder.getNumTableEntries());
+}
+
+void HpackTest::testDecode_invalid()
+{
+  {
+    // Index out of range
+    HpackDecoder decoder;
+    try {
+      decode(decoder, "be");
+      CPPUNIT_FAIL("exception must be thrown.");
+    }
+    catch (DlAbortEx& e) {
+    }
+  }
+  {
+    // Table size update larger than the limit
+    HpackDecoder decoder;
+    try {
+      decode(decoder, "3fe21f");
+      CPPUNIT_FAIL("exception must be thrown.");
+    }
+    catch (DlAbortEx& e) {
+    }
+  }
+  {
+    // Truncated string literal
+    HpackDecoder decoder;
+    try {
+      decode(decoder, "410f7777");
+      CPPUNIT_FAIL("exception must be thrown.");
+    }
+    catch (DlAbortEx& e) {
+    }
+  }
+}
+
+} // namespace aria2
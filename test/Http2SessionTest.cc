@@ -0,0 +1,408 @@
+#include "Http2Session.h"
+
+#include <cstring>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "SocketCore.h"
+#include "HpackDecoder.h"
+#include "DlRetryEx.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+class Http2SessionTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(Http2SessionTest);
+  CPPUNIT_TEST(testSubmitRequest);
+  CPPUNIT_TEST(testResponse);
+  CPPUNIT_TEST(testResponse_continuation);
+  CPPUNIT_TEST(testRstStream);
+  CPPUNIT_TEST(testRstStream_badLength);
+  CPPUNIT_TEST(testGoaway);
+  CPPUNIT_TEST(testWindowUpdate);
+  CPPUNIT_TEST(testCloseStream);
+  CPPUNIT_TEST(testProtocolError);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::shared_ptr<SocketCore> client_;
+  std::shared_ptr<SocketCore> server_;
+  std::unique_ptr<Http2Session> session_;
+
+public:
+  void setUp();
+
+  void testSubmitRequest();
+  void testResponse();
+  void testResponse_continuation();
+  void testRstStream();
+  void testRstStream_badLength();
+  void testGoaway();
+  void testWindowUpdate();
+  void testCloseStream();
+  void testProtocolError();
+
+private:
+  struct Frame {
+    uint8_t type;
+    uint8_t flags;
+    int32_t streamId;
+    std::string payload;
+  };
+
+  void writeFrame(uint8_t type, uint8_t flags, int32_t streamId,
+                  const std::string& payload);
+  Frame readFrame();
+  // Reads the connection preface and the first frames sent by the
+  // client, and sends empty SETTINGS.
+  void handshake();
+  int32_t submitRequest();
+  std::string readAll(int32_t streamId);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(Http2SessionTest);
+
+namespace {
+void readExactly(SocketCore& socket, char* data, size_t len)
+{
+  while (len) {
+    size_t n = len;
+    socket.readData(data, n);
+    CPPUNIT_ASSERT(n > 0);
+    data += n;
+    len -= n;
+  }
+}
+
+std::string uint32ToString(uint32_t n)
+{
+  std::string s;
+  s += static_cast<char>(n >> 24);
+  s += static_cast<char>(n >> 16);
+  s += static_cast<char>(n >> 8);
+  s += static_cast<char>(n);
+  return s;
+}
+
+uint32_t stringToUint32(const std::string& s, size_t offset = 0)
+{
+  auto p = reinterpret_cast<const unsigned char*>(s.data()) + offset;
+  return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) |
+         p[3];
+}
+
+std::string encode(const std::vector<hpack::HeaderField>& headers)
+{
+  std::string block;
+  hpack::encodeHeaderBlock(block, headers);
+  return block;
+}
+} // namespace
+
+void Http2SessionTest::setUp()
+{
+  client_ = std::make_shared<SocketCore>();
+  SocketCore serverSocket;
+  serverSocket.bind(0);
+  serverSocket.beginListen();
+  serverSocket.setBlockingMode();
+  auto endpoint = serverSocket.getAddrInfo();
+  client_->establishConnection("localhost", endpoint.port);
+  client_->setBlockingMode();
+  server_ = serverSocket.acceptConnection();
+  server_->setBlockingMode();
+  client_->setNonBlockingMode();
+  session_ = make_unique<Http2Session>(client_, nullptr);
+}
+
+void Http2SessionTest::writeFrame(uint8_t type, uint8_t flags,
+                                  int32_t streamId, const std::string& payload)
+{
+  std::string frame;
+  frame += static_cast<char>(payload.size() >> 16);
+  frame += static_cast<char>(payload.size() >> 8);
+  frame += static_cast<char>(payload.size());
+  frame += static_cast<char>(type);
+  frame += static_cast<char>(flags);
+  frame += uint32ToString(streamId);
+  frame += payload;
+  server_->writeData(frame.data(), frame.size());
+}
+
+Http2SessionTest::Frame Http2SessionTest::readFrame()
+{
+  unsigned char header[9];
+  readExactly(*server_, reinterpret_cast<char*>(header), sizeof(header));
+  Frame frame;
+  size_t length = (header[0] << 16) | (header[1] << 8) | header[2];
+  frame.type = header[3];
+  frame.flags = header[4];
+  frame.streamId =
+      stringToUint32(std::string(&header[5], &header[9])) & 0x7fffffff;
+  frame.payload.resize(length);
+  if (length) {
+    readExactly(*server_, &frame.payload[0], length);
+  }
+  return frame;
+}
+
+void Http2SessionTest::handshake()
+{
+  session_->send();
+  char preface[24];
+  readExactly(*server_, preface, sizeof(preface));
+  CPPUNIT_ASSERT(memcmp("PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n", preface,
+                        sizeof(preface)) == 0);
+  auto settings = readFrame();
+  CPPUNIT_ASSERT_EQUAL((uint8_t)4, settings.type);
+  CPPUNIT_ASSERT_EQUAL((uint8_t)0, settings.flags);
+  // SETTINGS_ENABLE_PUSH = 0, SETTINGS_INITIAL_WINDOW_SIZE = 4MiB
+  CPPUNIT_ASSERT_EQUAL(std::string("\x00\x02\x00\x00\x00\x00"
+                                   "\x00\x04\x00\x40\x00\x00",
+                                   12),
+                       settings.payload);
+  auto windowUpdate = readFrame();
+  CPPUNIT_ASSERT_EQUAL((uint8_t)8, windowUpdate.type);
+  CPPUNIT_ASSERT_EQUAL((int32_t)0, windowUpdate.streamId);
+  CPPUNIT_ASSERT_EQUAL((uint32_t)(16_m - 65535),
+                       stringToUint32(windowUpdate.payload));
+  writeFrame(4, 0, 0, "");
+}
+
+int32_t Http2SessionTest::submitRequest()
+{
+  auto streamId = session_->submitRequest({{":method", "GET"},
+                                           {":scheme", "https"},
+                                           {":authority", "localhost"},
+                                           {":path", "/"}});
+  session_->send();
+  return streamId;
+}
+
+std::string Http2SessionTest::readAll(int32_t streamId)
+{
+  std::string res;
+  unsigned char buf[4096];
+  while (!session_->streamClosed(streamId)) {
+    size_t n = session_->readData(streamId, buf, sizeof(buf));
+    CPPUNIT_ASSERT(n > 0);
+    res.append(&buf[0], &buf[n]);
+  }
+  return res;
+}
+
+void Http2SessionTest::testSubmitRequest()
+{
+  handshake();
+  CPPUNIT_ASSERT(session_->canSubmitRequest());
+  CPPUNIT_ASSERT_EQUAL((int32_t)1, submitRequest());
+  auto headers = readFrame();
+  CPPUNIT_ASSERT_EQUAL((uint8_t)1, headers.type);
+  // END_STREAM | END_HEADERS
+  CPPUNIT_ASSERT_EQUAL((uint8_t)0x5, headers.flags);
+  CPPUNIT_ASSERT_EQUAL((int32_t)1, headers.streamId);
+  HpackDecoder decoder;
+  std::vector<hpack::HeaderField> fields;
+  decoder.decode(fields,
+                 reinterpret_cast<const unsigned char*>(headers.payload.data()),
+                 headers.payload.size());
+  CPPUNIT_ASSERT_EQUAL((size_t)4, fields.size());
+  CPPUNIT_ASSERT_EQUAL(std::string(":authority"), fields[2].first);
+  CPPUNIT_ASSERT_EQUAL(std::string("localhost"), fields[2].second);
+
+  CPPUNIT_ASSERT_EQUAL((int32_t)3, submitRequest());
+  CPPUNIT_ASSERT_EQUAL((int32_t)3, readFrame().streamId);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, session_->countStream());
+}
+
+void Http2SessionTest::testResponse()
+{
+  handshake();
+  auto streamId = submitRequest();
+  readFrame();
+  writeFrame(1, 0x4, streamId,
+             encode({{":status", "200"},
+                     {"content-length", "5"},
+                     {"connection", "keep-alive"}}));
+  // PADDED
+  writeFrame(0, 0x8, streamId, std::string("\x02hel\0\0", 6));
+  writeFrame(0, 0x1, streamId, "lo");
+  CPPUNIT_ASSERT(!session_->dataAvailable(streamId));
+  CPPUNIT_ASSERT_EQUAL(std::string("HTTP/1.1 200\r\n"
+                                   "content-length: 5\r\n"
+                                   "Connection: close\r\n"
+                                   "\r\n"
+                                   "hello"),
+                       readAll(streamId));
+  CPPUNIT_ASSERT(session_->streamClosed(streamId));
+  // SETTINGS ACK
+  auto ack = readFrame();
+  CPPUNIT_ASSERT_EQUAL((uint8_t)4, ack.type);
+  CPPUNIT_ASSERT_EQUAL((uint8_t)1, ack.flags);
+  session_->closeStream(streamId);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, session_->countStream());
+  CPPUNIT_ASSERT(session_->isOpen());
+}
+
+void Http2SessionTest::testResponse_continuation()
+{
+  handshake();
+  auto streamId = submitRequest();
+  readFrame();
+  // Interim response first.
+  writeFrame(1, 0x4, streamId, encode({{":status", "100"}}));
+  auto block = encode({{":status", "404"}, {"content-length", "0"}});
+  writeFrame(1, 0x1, streamId, block.substr(0, 2));
+  writeFrame(9, 0x4, streamId, block.substr(2));
+  CPPUNIT_ASSERT_EQUAL(std::string("HTTP/1.1 100\r\n"
+                                   "Connection: close\r\n"
+                                   "\r\n"
+                                   "HTTP/1.1 404\r\n"
+                                   "content-length: 0\r\n"
+                                   "Connection: close\r\n"
+                                   "\r\n"),
+                       readAll(streamId));
+}
+
+void Http2SessionTest::testRstStream()
+{
+  handshake();
+  auto streamId = submitRequest();
+  readFrame();
+  // REFUSED_STREAM
+  writeFrame(3, 0, streamId, uint32ToString(7));
+  unsigned char buf[256];
+  try {
+    session_->readData(streamId, buf, sizeof(buf));
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (DlRetryEx& e) {
+  }
+  CPPUNIT_ASSERT(session_->dataAvailable(streamId));
+  CPPUNIT_ASSERT(!session_->streamClosed(streamId));
+  // The connection is still usable.
+  CPPUNIT_ASSERT(session_->isOpen());
+}
+
+void Http2SessionTest::testRstStream_badLength()
+{
+  handshake();
+  auto streamId = submitRequest();
+  readFrame();
+  writeFrame(3, 0, streamId, uint32ToString(7) + "a");
+  try {
+    session_->recv();
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (DlRetryEx& e) {
+  }
+  CPPUNIT_ASSERT(!session_->isOpen());
+  // SETTINGS ACK
+  CPPUNIT_ASSERT_EQUAL((uint8_t)4, readFrame().type);
+  auto goaway = readFrame();
+  CPPUNIT_ASSERT_EQUAL((uint8_t)7, goaway.type);
+  // FRAME_SIZE_ERROR
+  CPPUNIT_ASSERT_EQUAL((uint32_t)6, stringToUint32(goaway.payload, 4));
+}
+
+void Http2SessionTest::testGoaway()
+{
+  handshake();
+  auto stream1 = submitRequest();
+  readFrame();
+  auto stream3 = submitRequest();
+  readFrame();
+  writeFrame(7, 0, 0, uint32ToString(stream1) + uint32ToString(0));
+  writeFrame(1, 0x5, stream1, encode({{":status", "204"}}));
+  unsigned char buf[256];
+  try {
+    session_->readData(stream3, buf, sizeof(buf));
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (DlRetryEx& e) {
+  }
+  CPPUNIT_ASSERT(!session_->isOpen());
+  CPPUNIT_ASSERT(!session_->canSubmitRequest());
+  CPPUNIT_ASSERT_EQUAL(std::string("HTTP/1.1 204\r\n"
+                                   "Connection: close\r\n"
+                                   "\r\n"),
+                       readAll(stream1));
+}
+
+void Http2SessionTest::testWindowUpdate()
+{
+  handshake();
+  auto streamId = submitRequest();
+  readFrame();
+  writeFrame(1, 0x4, streamId, encode({{":status", "200"}}));
+  unsigned char buf[16_k];
+  // "HTTP/1.1 200\r\nConnection: close\r\n\r\n" does not count against
+  // the window.
+  for (size_t total = 0; total < 35;) {
+    total += session_->readData(streamId, buf, 35 - total);
+  }
+  std::string data(16_k, 'a');
+  // Consume a half of the stream window.
+  for (size_t i = 0; i < 2_m / data.size(); ++i) {
+    writeFrame(0, 0, streamId, data);
+    for (size_t total = 0; total < data.size();) {
+      total += session_->readData(streamId, buf, sizeof(buf));
+    }
+  }
+  // SETTINGS ACK
+  CPPUNIT_ASSERT_EQUAL((uint8_t)4, readFrame().type);
+  auto windowUpdate = readFrame();
+  CPPUNIT_ASSERT_EQUAL((uint8_t)8, windowUpdate.type);
+  CPPUNIT_ASSERT_EQUAL(streamId, windowUpdate.streamId);
+  CPPUNIT_ASSERT_EQUAL((uint32_t)2_m, stringToUint32(windowUpdate.payload));
+}
+
+void Http2SessionTest::testCloseStream()
+{
+  handshake();
+  auto streamId = submitRequest();
+  readFrame();
+  session_->closeStream(streamId);
+  // SETTINGS ACK is not sent yet, because nothing was read.
+  auto rst = readFrame();
+  CPPUNIT_ASSERT_EQUAL((uint8_t)3, rst.type);
+  CPPUNIT_ASSERT_EQUAL(streamId, rst.streamId);
+  // CANCEL
+  CPPUNIT_ASSERT_EQUAL((uint32_t)8, stringToUint32(rst.payload));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, session_->countStream());
+  CPPUNIT_ASSERT(session_->streamClosed(streamId));
+}
+
+void Http2SessionTest::testProtocolError()
+{
+  session_->send();
+  char preface[24];
+  readExactly(*server_, preface, sizeof(preface));
+  readFrame();
+  readFrame();
+  auto streamId = submitRequest();
+  readFrame();
+  // DATA before SETTINGS
+  writeFrame(0, 0, streamId, "hello");
+  try {
+    session_->recv();
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (DlRetryEx& e) {
+  }
+  CPPUNIT_ASSERT(!session_->isOpen());
+  auto goaway = readFrame();
+  CPPUNIT_ASSERT_EQUAL((uint8_t)7, goaway.type);
+  // PROTOCOL_ERROR
+  CPPUNIT_ASSERT_EQUAL((uint32_t)1, stringToUint32(goaway.payload, 4));
+  unsigned char buf[256];
+  try {
+    session_->readData(streamId, buf, sizeof(buf));
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (DlRetryEx& e) {
+  }
+}
+
+} // namespace aria2
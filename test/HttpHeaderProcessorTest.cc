@@ -7,6 +7,7 @@
 #include "HttpHeader.h"
 #include "DlRetryEx.h"
 #include "DlAbortEx.h"
+#include "a2functional.h"
 
 namespace aria2 {
 
@@ -24,8 +25,11 @@ class HttpHeaderProcessorTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testGetHttpResponseHeader_nameStartsWs);
   CPPUNIT_TEST(testGetHttpResponseHeader_teAndCl);
   CPPUNIT_TEST(testBeyondLimit);
+  CPPUNIT_TEST(testBeyondLimit_oneBuffer);
   CPPUNIT_TEST(testGetHeaderString);
   CPPUNIT_TEST(testGetHttpRequestHeader);
+  CPPUNIT_TEST(testParse_fragmented);
+  CPPUNIT_TEST(testParse_loneCr);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -40,8 +44,11 @@ public:
   void testGetHttpResponseHeader_nameStartsWs();
   void testGetHttpResponseHeader_teAndCl();
   void testBeyondLimit();
+  void testBeyondLimit_oneBuffer();
   void testGetHeaderString();
   void testGetHttpRequestHeader();
+  void testParse_fragmented();
+  void testParse_loneCr();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(HttpHeaderProcessorTest);
@@ -244,6 +251,51 @@ void HttpHeaderProcessorTest::testBeyondLimit()
   }
 }
 
+void HttpHeaderProcessorTest::testBeyondLimit_oneBuffer()
+{
+  {
+    HttpHeaderProcessor proc(HttpHeaderProcessor::SERVER_PARSER);
+    std::string hd = "POST /jsonrpc HTTP/1.1\r\n"
+                     "Authorization: Basic " +
+                     std::string(8_k, 'A') +
+                     "\r\n"
+                     "\r\n";
+    try {
+      proc.parse(hd);
+      CPPUNIT_FAIL("Exception must be thrown.");
+    }
+    catch (DlAbortEx& ex) {
+      // Success
+    }
+  }
+  {
+    HttpHeaderProcessor proc(HttpHeaderProcessor::SERVER_PARSER);
+    std::string hd = "POST /jsonrpc HTTP/1.1\r\n" + std::string(1025, 'A') +
+                     ": a\r\n"
+                     "\r\n";
+    try {
+      proc.parse(hd);
+      CPPUNIT_FAIL("Exception must be thrown.");
+    }
+    catch (DlAbortEx& ex) {
+      // Success
+    }
+  }
+  {
+    // Just within the limit.
+    HttpHeaderProcessor proc(HttpHeaderProcessor::SERVER_PARSER);
+    std::string hd = "POST /jsonrpc HTTP/1.1\r\n"
+                     "Authorization: " +
+                     std::string(8_k, 'A') +
+                     "\r\n"
+                     "\r\n";
+    CPPUNIT_ASSERT(proc.parse(hd));
+    CPPUNIT_ASSERT_EQUAL(
+        std::string(8_k, 'A'),
+        proc.getResult()->find(HttpHeader::AUTHORIZATION));
+  }
+}
+
 void HttpHeaderProcessorTest::testGetHeaderString()
 {
   HttpHeaderProcessor proc(HttpHeaderProcessor::CLIENT_PARSER);
@@ -295,4 +347,63 @@ void HttpHeaderProcessorTest::testGetHttpRequestHeader()
   CPPUNIT_ASSERT(!httpHeader->defined(HttpHeader::CONTENT_ENCODING));
 }
 
+void HttpHeaderProcessorTest::testParse_fragmented()
+{
+  std::string hd = "HTTP/1.1 206 Partial Content\r\n"
+                   "Content-Length: 100\r\n"
+                   "Set-Cookie: a=b\r\n"
+                   "LINK: <http://host/a>; rel=duplicate\r\n"
+                   "Set-Cookie:c=d \t\r\n"
+                   "X-Very-Long-Uninteresting-Header-Field-Name: x\n"
+                   "Content-Range: bytes 0-99/200\r\n"
+                   "\r\nputbackme";
+  HttpHeaderProcessor whole(HttpHeaderProcessor::CLIENT_PARSER);
+  CPPUNIT_ASSERT(whole.parse(hd));
+  CPPUNIT_ASSERT_EQUAL(hd.size() - 9, whole.getLastBytesProcessed());
+
+  HttpHeaderProcessor fragmented(HttpHeaderProcessor::CLIENT_PARSER);
+  size_t i;
+  for (i = 0; i < hd.size(); ++i) {
+    if (fragmented.parse(hd.substr(i, 1))) {
+      break;
+    }
+  }
+  CPPUNIT_ASSERT_EQUAL(hd.size() - 10, i);
+  CPPUNIT_ASSERT_EQUAL(whole.getHeaderString(), fragmented.getHeaderString());
+
+  auto h1 = whole.getResult();
+  auto h2 = fragmented.getResult();
+  for (auto h : {h1.get(), h2.get()}) {
+    CPPUNIT_ASSERT_EQUAL(std::string("HTTP/1.1"), h->getVersion());
+    CPPUNIT_ASSERT_EQUAL(206, h->getStatusCode());
+    CPPUNIT_ASSERT_EQUAL(std::string("Partial Content"),
+                         h->getReasonPhrase());
+    CPPUNIT_ASSERT_EQUAL(std::string("100"),
+                         h->find(HttpHeader::CONTENT_LENGTH));
+    CPPUNIT_ASSERT_EQUAL(std::string("bytes 0-99/200"),
+                         h->find(HttpHeader::CONTENT_RANGE));
+    CPPUNIT_ASSERT_EQUAL(std::string("<http://host/a>; rel=duplicate"),
+                         h->find(HttpHeader::LINK));
+    auto cookies = h->findAll(HttpHeader::SET_COOKIE);
+    CPPUNIT_ASSERT_EQUAL((size_t)2, cookies.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("a=b"), cookies[0]);
+    CPPUNIT_ASSERT_EQUAL(std::string("c=d"), cookies[1]);
+  }
+}
+
+void HttpHeaderProcessorTest::testParse_loneCr()
+{
+  HttpHeaderProcessor proc(HttpHeaderProcessor::CLIENT_PARSER);
+  std::string hd = "HTTP/1.1 200 OK\r\n"
+                   "Content-Length: 1\r00\r\n"
+                   "\r\n";
+  try {
+    proc.parse(hd);
+    CPPUNIT_FAIL("Exception must be thrown.");
+  }
+  catch (DlAbortEx& ex) {
+    // Success
+  }
+}
+
 } // namespace aria2
@@ -142,13 +142,20 @@ void HttpHeaderTest::testFindAll()
 {
   HttpHeader h;
   h.put(HttpHeader::LINK, "100");
+  h.put(HttpHeader::UPGRADE, "300");
   h.put(HttpHeader::LINK, "101");
   h.put(HttpHeader::CONNECTION, "200");
+  h.put(HttpHeader::LINK, "102");
 
   std::vector<std::string> r(h.findAll(HttpHeader::LINK));
-  CPPUNIT_ASSERT_EQUAL((size_t)2, r.size());
+  CPPUNIT_ASSERT_EQUAL((size_t)3, r.size());
   CPPUNIT_ASSERT_EQUAL(std::string("100"), r[0]);
   CPPUNIT_ASSERT_EQUAL(std::string("101"), r[1]);
+  CPPUNIT_ASSERT_EQUAL(std::string("102"), r[2]);
+  CPPUNIT_ASSERT_EQUAL(std::string("100"), h.find(HttpHeader::LINK));
+  CPPUNIT_ASSERT_EQUAL(std::string("200"), h.find(HttpHeader::CONNECTION));
+  CPPUNIT_ASSERT_EQUAL(std::string("300"), h.find(HttpHeader::UPGRADE));
+  CPPUNIT_ASSERT(h.findAll(HttpHeader::DIGEST).empty());
 }
 
 void HttpHeaderTest::testClearField()
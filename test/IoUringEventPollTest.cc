@@ -0,0 +1,174 @@
+#include "IoUringEventPoll.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Command.h"
+
+namespace aria2 {
+
+class IoUringEventPollTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(IoUringEventPollTest);
+  CPPUNIT_TEST(testAddEvents);
+  CPPUNIT_TEST(testDeleteEvents);
+  CPPUNIT_TEST(testPoll_rearm);
+  CPPUNIT_TEST(testPoll_timeout);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::unique_ptr<IoUringEventPoll> poll_;
+  int fds_[2];
+
+public:
+  void setUp()
+  {
+    poll_ = make_unique<IoUringEventPoll>();
+    CPPUNIT_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+  }
+
+  void tearDown()
+  {
+    poll_.reset();
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+
+  void testAddEvents();
+  void testDeleteEvents();
+  void testPoll_rearm();
+  void testPoll_timeout();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IoUringEventPollTest);
+
+namespace {
+class MockCommand : public Command {
+public:
+  MockCommand() : Command(1) {}
+
+  virtual bool execute() CXX11_OVERRIDE { return false; }
+
+  bool readEvent() const { return readEventEnabled(); }
+
+  bool writeEvent() const { return writeEventEnabled(); }
+};
+
+struct timeval toTimeval(int msec)
+{
+  struct timeval tv;
+  tv.tv_sec = msec / 1000;
+  tv.tv_usec = (msec % 1000) * 1000;
+  return tv;
+}
+} // namespace
+
+// io_uring may be disabled by the kernel or a seccomp filter.  Then
+// there is nothing to test here; DownloadEngineFactory falls back to
+// epoll.
+#define SKIP_IF_UNAVAILABLE()                                                  \
+  if (!poll_->good()) {                                                        \
+    return;                                                                    \
+  }
+
+void IoUringEventPollTest::testAddEvents()
+{
+  SKIP_IF_UNAVAILABLE();
+  MockCommand rc, wc;
+  CPPUNIT_ASSERT(poll_->addEvents(fds_[0], &rc, EventPoll::EVENT_READ));
+  CPPUNIT_ASSERT(poll_->addEvents(fds_[0], &wc, EventPoll::EVENT_WRITE));
+
+  // The socket is writable, but nothing has been written yet.
+  poll_->poll(toTimeval(1000));
+  CPPUNIT_ASSERT(!rc.readEvent());
+  CPPUNIT_ASSERT(wc.writeEvent());
+
+  wc.clearIOEvents();
+  CPPUNIT_ASSERT_EQUAL((ssize_t)1, write(fds_[1], "a", 1));
+  poll_->poll(toTimeval(1000));
+  CPPUNIT_ASSERT(rc.readEvent());
+  CPPUNIT_ASSERT(wc.writeEvent());
+}
+
+void IoUringEventPollTest::testDeleteEvents()
+{
+  SKIP_IF_UNAVAILABLE();
+  MockCommand rc, wc;
+  CPPUNIT_ASSERT(!poll_->deleteEvents(fds_[0], &rc, EventPoll::EVENT_READ));
+
+  CPPUNIT_ASSERT(poll_->addEvents(fds_[0], &rc, EventPoll::EVENT_READ));
+  CPPUNIT_ASSERT(poll_->addEvents(fds_[0], &wc, EventPoll::EVENT_WRITE));
+  poll_->poll(toTimeval(1000));
+  CPPUNIT_ASSERT(wc.writeEvent());
+
+  // Removing one command keeps the other one armed.
+  CPPUNIT_ASSERT(poll_->deleteEvents(fds_[0], &wc, EventPoll::EVENT_WRITE));
+  wc.clearIOEvents();
+  CPPUNIT_ASSERT_EQUAL((ssize_t)1, write(fds_[1], "a", 1));
+  poll_->poll(toTimeval(1000));
+  CPPUNIT_ASSERT(rc.readEvent());
+  CPPUNIT_ASSERT(!wc.writeEvent());
+
+  // The poll request in flight is cancelled with the last command.
+  CPPUNIT_ASSERT(poll_->deleteEvents(fds_[0], &rc, EventPoll::EVENT_READ));
+  rc.clearIOEvents();
+  poll_->poll(toTimeval(10));
+  CPPUNIT_ASSERT(!rc.readEvent());
+  CPPUNIT_ASSERT(!poll_->deleteEvents(fds_[0], &rc, EventPoll::EVENT_READ));
+}
+
+void IoUringEventPollTest::testPoll_rearm()
+{
+  SKIP_IF_UNAVAILABLE();
+  MockCommand rc;
+  CPPUNIT_ASSERT(poll_->addEvents(fds_[0], &rc, EventPoll::EVENT_READ));
+  CPPUNIT_ASSERT_EQUAL((ssize_t)1, write(fds_[1], "a", 1));
+  poll_->poll(toTimeval(1000));
+  CPPUNIT_ASSERT(rc.readEvent());
+
+  // The oneshot poll request has completed.  It must be re-armed, so
+  // that unread data is reported again.
+  for (int i = 0; i < 3; ++i) {
+    rc.clearIOEvents();
+    poll_->poll(toTimeval(1000));
+    CPPUNIT_ASSERT(rc.readEvent());
+  }
+
+  char buf[1];
+  CPPUNIT_ASSERT_EQUAL((ssize_t)1, read(fds_[0], buf, sizeof(buf)));
+  rc.clearIOEvents();
+  poll_->poll(toTimeval(10));
+  CPPUNIT_ASSERT(!rc.readEvent());
+
+  CPPUNIT_ASSERT_EQUAL((ssize_t)1, write(fds_[1], "b", 1));
+  poll_->poll(toTimeval(1000));
+  CPPUNIT_ASSERT(rc.readEvent());
+}
+
+void IoUringEventPollTest::testPoll_timeout()
+{
+  SKIP_IF_UNAVAILABLE();
+  MockCommand rc;
+  CPPUNIT_ASSERT(poll_->addEvents(fds_[0], &rc, EventPoll::EVENT_READ));
+
+  auto start = std::chrono::steady_clock::now();
+  poll_->poll(toTimeval(200));
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  CPPUNIT_ASSERT(!rc.readEvent());
+  CPPUNIT_ASSERT(elapsed >= std::chrono::milliseconds(150));
+  CPPUNIT_ASSERT(elapsed < std::chrono::seconds(2));
+
+  // An event ends the wait before the timeout.
+  CPPUNIT_ASSERT_EQUAL((ssize_t)1, write(fds_[1], "a", 1));
+  start = std::chrono::steady_clock::now();
+  poll_->poll(toTimeval(5000));
+  elapsed = std::chrono::steady_clock::now() - start;
+  CPPUNIT_ASSERT(rc.readEvent());
+  CPPUNIT_ASSERT(elapsed < std::chrono::seconds(2));
+}
+
+} // namespace aria2
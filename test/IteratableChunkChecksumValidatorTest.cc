@@ -9,6 +9,9 @@
 #include "DiskAdaptor.h"
 #include "FileEntry.h"
 #include "PieceSelector.h"
+#ifdef ENABLE_THREADS
+#include "ThreadPool.h"
+#endif // ENABLE_THREADS
 
 namespace aria2 {
 
@@ -17,6 +20,9 @@ class IteratableChunkChecksumValidatorTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(IteratableChunkChecksumValidatorTest);
   CPPUNIT_TEST(testValidate);
   CPPUNIT_TEST(testValidate_readError);
+#ifdef ENABLE_THREADS
+  CPPUNIT_TEST(testValidate_threadPool);
+#endif // ENABLE_THREADS
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -27,6 +33,9 @@ public:
 
   void testValidate();
   void testValidate_readError();
+#ifdef ENABLE_THREADS
+  void testValidate_threadPool();
+#endif // ENABLE_THREADS
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(IteratableChunkChecksumValidatorTest);
@@ -106,4 +115,59 @@ void IteratableChunkChecksumValidatorTest::testValidate_readError()
   CPPUNIT_ASSERT(!ps->hasPiece(4));
 }
 
+#ifdef ENABLE_THREADS
+void IteratableChunkChecksumValidatorTest::testValidate_threadPool()
+{
+  ThreadPool pool(2);
+  Option option;
+  std::shared_ptr<DownloadContext> dctx(new DownloadContext(
+      100, 500, A2_TEST_DIR "/chunkChecksumTestFile250.txt"));
+  std::deque<std::string> hashes(&csArray[0], &csArray[3]);
+  hashes[1] = fromHex("ffffffffffffffffffffffffffffffffffffffff");
+  hashes.push_back(fromHex("ffffffffffffffffffffffffffffffffffffffff"));
+  hashes.push_back(fromHex("ffffffffffffffffffffffffffffffffffffffff"));
+  dctx->setPieceHashes("sha-1", hashes.begin(), hashes.end());
+  std::shared_ptr<DefaultPieceStorage> ps(
+      new DefaultPieceStorage(dctx, &option));
+  ps->initStorage();
+  ps->getDiskAdaptor()->enableReadOnly();
+  ps->getDiskAdaptor()->openFile();
+
+  IteratableChunkChecksumValidator validator(dctx, ps);
+  validator.init();
+  validator.setThreadPool(&pool);
+
+  while (!validator.finished()) {
+    validator.validateChunk();
+  }
+
+  CPPUNIT_ASSERT_EQUAL((int64_t)500, validator.getCurrentOffset());
+  CPPUNIT_ASSERT(ps->hasPiece(0));
+  CPPUNIT_ASSERT(!ps->hasPiece(1));
+  // Read errors are reported in piece order, too.
+  CPPUNIT_ASSERT(!ps->hasPiece(2));
+  CPPUNIT_ASSERT(!ps->hasPiece(3));
+  CPPUNIT_ASSERT(!ps->hasPiece(4));
+
+  // All pieces are valid
+  std::shared_ptr<DownloadContext> dctx2(new DownloadContext(
+      100, 250, A2_TEST_DIR "/chunkChecksumTestFile250.txt"));
+  dctx2->setPieceHashes("sha-1", &csArray[0], &csArray[3]);
+  std::shared_ptr<DefaultPieceStorage> ps2(
+      new DefaultPieceStorage(dctx2, &option));
+  ps2->initStorage();
+  ps2->getDiskAdaptor()->enableReadOnly();
+  ps2->getDiskAdaptor()->openFile();
+
+  IteratableChunkChecksumValidator validator2(dctx2, ps2);
+  validator2.init();
+  validator2.setThreadPool(&pool);
+
+  while (!validator2.finished()) {
+    validator2.validateChunk();
+  }
+  CPPUNIT_ASSERT(ps2->downloadFinished());
+}
+#endif // ENABLE_THREADS
+
 } // namespace aria2
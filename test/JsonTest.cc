@@ -13,12 +13,14 @@ class JsonTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(JsonTest);
   CPPUNIT_TEST(testEncode);
+  CPPUNIT_TEST(testJsonWriter);
   CPPUNIT_TEST(testDecodeGetParams);
   CPPUNIT_TEST_SUITE_END();
 
 private:
 public:
   void testEncode();
+  void testJsonWriter();
   void testDecodeGetParams();
 };
 
@@ -67,6 +69,69 @@ void JsonTest::testEncode()
   }
 }
 
+void JsonTest::testJsonWriter()
+{
+  {
+    std::string out;
+    json::JsonWriter w(out);
+    w.beginDict();
+    w.put("name", "aria2");
+    w.writeKey("loc");
+    w.writeInteger(80000);
+    w.writeKey("files");
+    w.beginList();
+    w.writeString("aria2c");
+    w.beginList();
+    w.endList();
+    w.beginDict();
+    w.endDict();
+    w.endList();
+    w.writeKey("attrs");
+    w.beginDict();
+    w.put("license", "GPL");
+    w.endDict();
+    w.writeKey("flags");
+    w.beginList();
+    w.writeBool(true);
+    w.writeBool(false);
+    w.writeNull();
+    w.endList();
+    w.endDict();
+    CPPUNIT_ASSERT_EQUAL(std::string("{\"name\":\"aria2\","
+                                     "\"loc\":80000,"
+                                     "\"files\":[\"aria2c\",[],{}],"
+                                     "\"attrs\":{\"license\":\"GPL\"},"
+                                     "\"flags\":[true,false,null]}"),
+                         out);
+  }
+  {
+    std::string out;
+    json::JsonWriter w(out);
+    w.beginList();
+    w.writeString("\"\\/\b\f\n\r\t");
+    w.writeEncoded("{\"a\":1}");
+    w.writeEncoded("[]");
+    w.endList();
+    CPPUNIT_ASSERT_EQUAL(
+        std::string("[\"\\\"\\\\\\/\\b\\f\\n\\r\\t\",{\"a\":1},[]]"),
+        out);
+  }
+  {
+    // writeValue() produces the same output as encode() does.
+    auto dict = Dict::g();
+    dict->put("name", "aria2");
+    dict->put("loc", Integer::g(80000));
+    auto files = List::g();
+    files->append("aria2c");
+    files->append(Null::g());
+    dict->put("files", std::move(files));
+    std::string out;
+    json::JsonWriter w(out);
+    w.writeValue(dict.get());
+    CPPUNIT_ASSERT_EQUAL(json::encode(dict.get()), out);
+  }
+}
+
 void JsonTest::testDecodeGetParams()
 {
   {
@@ -0,0 +1,189 @@
+#include "Logger.h"
+
+#include <algorithm>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "LogFactory.h"
+#include "File.h"
+#include "DlAbortEx.h"
+#include "TestUtil.h"
+
+namespace aria2 {
+
+class LoggerTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(LoggerTest);
+  CPPUNIT_TEST(testToSubsystem);
+  CPPUNIT_TEST(testLevelEnabled);
+  CPPUNIT_TEST(testBinaryFormat);
+  CPPUNIT_TEST(testAsync);
+  CPPUNIT_TEST(testParseSubsystemLogLevels);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::string logfile_;
+
+public:
+  void setUp()
+  {
+    logfile_ = A2_TEST_OUT_DIR "/aria2_LoggerTest.log";
+    File(logfile_).remove();
+  }
+
+  void testToSubsystem();
+  void testLevelEnabled();
+  void testBinaryFormat();
+  void testAsync();
+  void testParseSubsystemLogLevels();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LoggerTest);
+
+void LoggerTest::testToSubsystem()
+{
+  CPPUNIT_ASSERT_EQUAL(Logger::SUBSYSTEM_DHT,
+                       Logger::toSubsystem("src/DHTRoutingTable.cc"));
+  CPPUNIT_ASSERT_EQUAL(Logger::SUBSYSTEM_RPC,
+                       Logger::toSubsystem("src/HttpServerCommand.cc"));
+  CPPUNIT_ASSERT_EQUAL(Logger::SUBSYSTEM_RPC,
+                       Logger::toSubsystem("RpcMethodImpl.cc"));
+  CPPUNIT_ASSERT_EQUAL(Logger::SUBSYSTEM_HTTP,
+                       Logger::toSubsystem("/a/b/HttpConnection.cc"));
+  CPPUNIT_ASSERT_EQUAL(Logger::SUBSYSTEM_BT,
+                       Logger::toSubsystem("DefaultBtInteractive.cc"));
+  CPPUNIT_ASSERT_EQUAL(Logger::SUBSYSTEM_BT,
+                       Logger::toSubsystem("bittorrent_helper.cc"));
+  CPPUNIT_ASSERT_EQUAL(Logger::SUBSYSTEM_DISK,
+                       Logger::toSubsystem("AbstractDiskWriter.cc"));
+  CPPUNIT_ASSERT_EQUAL(Logger::SUBSYSTEM_DEFAULT,
+                       Logger::toSubsystem("util.cc"));
+  CPPUNIT_ASSERT_EQUAL(std::string("bt"), std::string(Logger::subsystemToString(
+                                              Logger::SUBSYSTEM_BT)));
+}
+
+void LoggerTest::testLevelEnabled()
+{
+  Logger logger;
+  logger.setConsoleOutput(false);
+  logger.setLogLevel(Logger::A2_WARN);
+  // No file is opened.
+  CPPUNIT_ASSERT(!logger.levelEnabled(Logger::A2_ERROR, Logger::SUBSYSTEM_BT));
+  logger.openFile(logfile_);
+  logger.setSubsystemLogLevel(Logger::SUBSYSTEM_BT, Logger::A2_DEBUG);
+  CPPUNIT_ASSERT(logger.levelEnabled(Logger::A2_DEBUG, Logger::SUBSYSTEM_BT));
+  CPPUNIT_ASSERT(
+      !logger.levelEnabled(Logger::A2_DEBUG, Logger::SUBSYSTEM_HTTP));
+  CPPUNIT_ASSERT(logger.levelEnabled(Logger::A2_WARN, Logger::SUBSYSTEM_HTTP));
+  // Some subsystem wants debug.
+  CPPUNIT_ASSERT(logger.levelEnabled(Logger::A2_DEBUG));
+
+  logger.log(Logger::A2_DEBUG, Logger::SUBSYSTEM_BT, "bt.cc", 1, "peer");
+  logger.log(Logger::A2_DEBUG, Logger::SUBSYSTEM_HTTP, "http.cc", 2, "get");
+  logger.clearSubsystemLogLevels();
+  CPPUNIT_ASSERT(!logger.levelEnabled(Logger::A2_DEBUG, Logger::SUBSYSTEM_BT));
+  CPPUNIT_ASSERT(!logger.levelEnabled(Logger::A2_DEBUG));
+  logger.closeFile();
+
+  auto s = readFile(logfile_);
+  CPPUNIT_ASSERT(s.find("[DEBUG] [bt.cc:1] peer\n") != std::string::npos);
+  CPPUNIT_ASSERT(s.find("get") == std::string::npos);
+}
+
+namespace {
+template <typename T> T readLE(const std::string& s, size_t& pos)
+{
+  T n = 0;
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    n |= static_cast<T>(static_cast<unsigned char>(s[pos + i])) << (i * 8);
+  }
+  pos += sizeof(T);
+  return n;
+}
+} // namespace
+
+void LoggerTest::testBinaryFormat()
+{
+  const char* sourceFile = "DHTNode.cc";
+  Logger logger;
+  logger.setConsoleOutput(false);
+  logger.setFormat(Logger::FORMAT_BINARY);
+  logger.openFile(logfile_);
+  logger.log(Logger::A2_INFO, Logger::SUBSYSTEM_DHT, sourceFile, 300,
+             "hello");
+  logger.log(Logger::A2_ERROR, Logger::SUBSYSTEM_DHT, sourceFile, 301, "world",
+             DL_ABORT_EX("oops"));
+  logger.closeFile();
+
+  auto s = readFile(logfile_);
+  size_t pos = 0;
+  CPPUNIT_ASSERT_EQUAL(std::string("A2LOG\x01"), s.substr(pos, 6));
+  pos += 6;
+  // Source file record
+  CPPUNIT_ASSERT_EQUAL((char)1, s[pos++]);
+  CPPUNIT_ASSERT_EQUAL((uint16_t)0, readLE<uint16_t>(s, pos));
+  CPPUNIT_ASSERT_EQUAL((uint16_t)10, readLE<uint16_t>(s, pos));
+  CPPUNIT_ASSERT_EQUAL(std::string(sourceFile), s.substr(pos, 10));
+  pos += 10;
+  // Message record
+  CPPUNIT_ASSERT_EQUAL((char)2, s[pos++]);
+  CPPUNIT_ASSERT_EQUAL((char)Logger::A2_INFO, s[pos++]);
+  CPPUNIT_ASSERT_EQUAL((char)Logger::SUBSYSTEM_DHT, s[pos++]);
+  CPPUNIT_ASSERT_EQUAL((uint16_t)0, readLE<uint16_t>(s, pos));
+  CPPUNIT_ASSERT_EQUAL((uint32_t)300, readLE<uint32_t>(s, pos));
+  CPPUNIT_ASSERT(readLE<uint64_t>(s, pos) > 0);
+  CPPUNIT_ASSERT_EQUAL((uint32_t)5, readLE<uint32_t>(s, pos));
+  CPPUNIT_ASSERT_EQUAL(std::string("hello"), s.substr(pos, 5));
+  pos += 5;
+  CPPUNIT_ASSERT_EQUAL((uint32_t)0, readLE<uint32_t>(s, pos));
+  // The second message refers to the same source file record.
+  CPPUNIT_ASSERT_EQUAL((char)2, s[pos++]);
+  CPPUNIT_ASSERT_EQUAL((char)Logger::A2_ERROR, s[pos++]);
+  pos += 1;
+  CPPUNIT_ASSERT_EQUAL((uint16_t)0, readLE<uint16_t>(s, pos));
+  CPPUNIT_ASSERT_EQUAL((uint32_t)301, readLE<uint32_t>(s, pos));
+  pos += 8;
+  CPPUNIT_ASSERT_EQUAL((uint32_t)5, readLE<uint32_t>(s, pos));
+  pos += 5;
+  auto tracelen = readLE<uint32_t>(s, pos);
+  CPPUNIT_ASSERT(s.substr(pos, tracelen).find("oops") != std::string::npos);
+  CPPUNIT_ASSERT_EQUAL(s.size(), pos + tracelen);
+}
+
+void LoggerTest::testAsync()
+{
+  Logger logger;
+  logger.setConsoleOutput(false);
+  logger.setAsync(true);
+  logger.openFile(logfile_);
+  for (int i = 0; i < 10000; ++i) {
+    logger.log(Logger::A2_INFO, "async.cc", i, "msg");
+  }
+  // Waits for the writer to drain the queue.
+  logger.closeFile();
+  auto s = readFile(logfile_);
+  CPPUNIT_ASSERT_EQUAL((size_t)10000, (size_t)std::count(std::begin(s),
+                                                         std::end(s), '\n'));
+  CPPUNIT_ASSERT(s.find("[async.cc:9999] msg\n") != std::string::npos);
+}
+
+void LoggerTest::testParseSubsystemLogLevels()
+{
+  auto res = LogFactory::parseSubsystemLogLevels("bt=debug,disk=error");
+  CPPUNIT_ASSERT_EQUAL((size_t)2, res.size());
+  CPPUNIT_ASSERT_EQUAL(Logger::SUBSYSTEM_BT, res[0].first);
+  CPPUNIT_ASSERT_EQUAL(Logger::A2_DEBUG, res[0].second);
+  CPPUNIT_ASSERT_EQUAL(Logger::SUBSYSTEM_DISK, res[1].first);
+  CPPUNIT_ASSERT_EQUAL(Logger::A2_ERROR, res[1].second);
+  CPPUNIT_ASSERT(LogFactory::parseSubsystemLogLevels("").empty());
+  for (auto& spec : {"bt", "foo=debug", "bt=verbose", "=debug"}) {
+    try {
+      LogFactory::parseSubsystemLogLevels(spec);
+      CPPUNIT_FAIL(std::string("exception must be thrown: ") + spec);
+    }
+    catch (RecoverableException& e) {
+    }
+  }
+}
+
+} // namespace aria2
@@ -10,6 +10,7 @@ class MessageDigestTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(MessageDigestTest);
   CPPUNIT_TEST(testDigest);
+  CPPUNIT_TEST(testDigestMultiBlock);
   CPPUNIT_TEST(testSupports);
   CPPUNIT_TEST(testGetDigestLength);
   CPPUNIT_TEST(testIsStronger);
@@ -32,6 +33,7 @@ public:
   }
 
   void testDigest();
+  void testDigestMultiBlock();
   void testSupports();
   void testGetDigestLength();
   void testIsStronger();
@@ -72,6 +74,25 @@ void MessageDigestTest::testDigest()
 #endif // HAVE_ZLIB
 }
 
+void MessageDigestTest::testDigestMultiBlock()
+{
+  // One million 'a's, fed in pieces which are not multiple of the
+  // block size, so that both buffered and bulk transforms are used.
+  std::string data(1000000, 'a');
+  auto sha256 = MessageDigest::create("sha-256");
+  for (size_t i = 0, len = 1; i < data.size(); i += len, len = len * 7 % 9973) {
+    len = std::min(len, data.size() - i);
+    sha1_->update(data.data() + i, len);
+    sha256->update(data.data() + i, len);
+  }
+  CPPUNIT_ASSERT_EQUAL(std::string("34aa973cd4c4daa4f61eeb2bdbad27316534016f"),
+                       util::toHex(sha1_->digest()));
+  CPPUNIT_ASSERT_EQUAL(
+      std::string(
+          "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"),
+      util::toHex(sha256->digest()));
+}
+
 void MessageDigestTest::testSupports()
 {
   CPPUNIT_ASSERT(MessageDigest::supports("md5"));
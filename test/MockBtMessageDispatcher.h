@@ -45,6 +45,8 @@ public:
 
   virtual void checkRequestSlotAndDoNecessaryThing() CXX11_OVERRIDE {}
 
+  virtual void cancelAcquiredRequests() CXX11_OVERRIDE {}
+
   virtual bool isSendingInProgress() CXX11_OVERRIDE { return false; }
 
   virtual size_t countMessageInQueue() CXX11_OVERRIDE
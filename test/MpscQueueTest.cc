@@ -0,0 +1,91 @@
+#include "MpscQueue.h"
+
+#include <vector>
+#include <string>
+#ifdef ENABLE_THREADS
+#include <thread>
+#endif // ENABLE_THREADS
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace aria2 {
+
+class MpscQueueTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(MpscQueueTest);
+  CPPUNIT_TEST(testPushPop);
+  CPPUNIT_TEST(testConcurrentPush);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testPushPop();
+  void testConcurrentPush();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MpscQueueTest);
+
+void MpscQueueTest::testPushPop()
+{
+  MpscQueue<std::string> q(3);
+  CPPUNIT_ASSERT_EQUAL((size_t)4, q.capacity());
+  CPPUNIT_ASSERT(q.empty());
+  std::string s;
+  CPPUNIT_ASSERT(!q.pop(s));
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 4; ++i) {
+      s = std::to_string(i);
+      CPPUNIT_ASSERT(q.push(s));
+    }
+    s = "full";
+    CPPUNIT_ASSERT(!q.push(s));
+    CPPUNIT_ASSERT_EQUAL(std::string("full"), s);
+    CPPUNIT_ASSERT(!q.empty());
+    for (int i = 0; i < 4; ++i) {
+      CPPUNIT_ASSERT(q.pop(s));
+      CPPUNIT_ASSERT_EQUAL(std::to_string(i), s);
+    }
+    CPPUNIT_ASSERT(q.empty());
+  }
+}
+
+void MpscQueueTest::testConcurrentPush()
+{
+#ifdef ENABLE_THREADS
+  const int numThreads = 4;
+  const int numItems = 10000;
+  MpscQueue<int> q(64);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; ++t) {
+    threads.emplace_back([&q, t, numItems]() {
+      for (int i = 0; i < numItems; ++i) {
+        int v = t * numItems + i;
+        while (!q.push(v)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  // Values from the same producer must come out in order.
+  std::vector<int> last(numThreads, -1);
+  bool ordered = true;
+  int n = 0;
+  while (n < numThreads * numItems) {
+    int v;
+    if (!q.pop(v)) {
+      std::this_thread::yield();
+      continue;
+    }
+    int t = v / numItems;
+    ordered = ordered && last[t] < v % numItems;
+    last[t] = v % numItems;
+    ++n;
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+  CPPUNIT_ASSERT(ordered);
+  CPPUNIT_ASSERT(q.empty());
+#endif // ENABLE_THREADS
+}
+
+} // namespace aria2
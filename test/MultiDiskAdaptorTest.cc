@@ -13,6 +13,7 @@
 #include "TestUtil.h"
 #include "DiskWriter.h"
 #include "WrDiskCacheEntry.h"
+#include "SocketCore.h"
 
 namespace aria2 {
 
@@ -20,7 +21,9 @@ class MultiDiskAdaptorTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(MultiDiskAdaptorTest);
   CPPUNIT_TEST(testWriteData);
+  CPPUNIT_TEST(testWriteDataV);
   CPPUNIT_TEST(testReadData);
+  CPPUNIT_TEST(testSendData);
   CPPUNIT_TEST(testCutTrailingGarbage);
   CPPUNIT_TEST(testSize);
   CPPUNIT_TEST(testUtime);
@@ -39,7 +42,9 @@ public:
   }
 
   void testWriteData();
+  void testWriteDataV();
   void testReadData();
+  void testSendData();
   void testCutTrailingGarbage();
   void testSize();
   void testUtime();
@@ -334,6 +339,34 @@ void MultiDiskAdaptorTest::testWriteData()
   CPPUNIT_ASSERT(File(A2_TEST_OUT_DIR "/file5.txt").isFile());
 }
 
+void MultiDiskAdaptorTest::testWriteDataV()
+{
+  auto fileEntries = createEntries();
+  adaptor->setFileEntries(std::begin(fileEntries), std::end(fileEntries));
+
+  std::string msg[] = {"1234567", "890ABCD", "", "EFGHI"};
+  a2iovec iov[4];
+  for (size_t i = 0; i < 4; ++i) {
+    iov[i].A2IOVEC_BASE = &msg[i][0];
+    iov[i].A2IOVEC_LEN = msg[i].size();
+  }
+  adaptor->openFile();
+  adaptor->writeDataV(iov, 4, 10);
+  adaptor->closeFile();
+
+  CPPUNIT_ASSERT_EQUAL(std::string(10, '\0') + "12345",
+                       readFile(A2_TEST_OUT_DIR "/file1.txt"));
+  CPPUNIT_ASSERT_EQUAL(std::string("67890AB"),
+                       readFile(A2_TEST_OUT_DIR "/file2.txt"));
+  CPPUNIT_ASSERT(File(A2_TEST_OUT_DIR "/file3.txt").isFile());
+  CPPUNIT_ASSERT_EQUAL(std::string("CD"),
+                       readFile(A2_TEST_OUT_DIR "/file4.txt"));
+  CPPUNIT_ASSERT_EQUAL(std::string("EFG"),
+                       readFile(A2_TEST_OUT_DIR "/file6.txt"));
+  CPPUNIT_ASSERT_EQUAL(std::string("HI"),
+                       readFile(A2_TEST_OUT_DIR "/file8.txt"));
+}
+
 void MultiDiskAdaptorTest::testReadData()
 {
   auto entries = std::vector<std::shared_ptr<FileEntry>>{
@@ -360,6 +393,46 @@ void MultiDiskAdaptorTest::testReadData()
                        std::string((char*)buf));
 }
 
+void MultiDiskAdaptorTest::testSendData()
+{
+  auto entries = std::vector<std::shared_ptr<FileEntry>>{
+      std::make_shared<FileEntry>(A2_TEST_DIR "/file1r.txt", 15, 0),
+      std::make_shared<FileEntry>(A2_TEST_DIR "/file2r.txt", 7, 15),
+      std::make_shared<FileEntry>(A2_TEST_DIR "/file3r.txt", 3, 22)};
+
+  adaptor->setFileEntries(std::begin(entries), std::end(entries));
+  adaptor->enableReadOnly();
+  adaptor->openFile();
+
+  auto listenSocket = std::make_shared<SocketCore>();
+  listenSocket->bind(0);
+  listenSocket->beginListen();
+  listenSocket->setBlockingMode();
+  auto clientSocket = std::make_shared<SocketCore>();
+  clientSocket->establishConnection("localhost",
+                                    listenSocket->getAddrInfo().port);
+  while (!clientSocket->isWritable(0))
+    ;
+  clientSocket->setBlockingMode();
+  auto serverSocket = listenSocket->acceptConnection();
+  serverSocket->setBlockingMode();
+
+  // Only the data in the first file is sent.
+  CPPUNIT_ASSERT_EQUAL((ssize_t)9, adaptor->sendData(serverSocket, 10, 6));
+  CPPUNIT_ASSERT_EQUAL((ssize_t)1, adaptor->sendData(serverSocket, 1, 15));
+
+  unsigned char buf[128];
+  size_t total = 0;
+  while (total < 10) {
+    size_t len = 10 - total;
+    clientSocket->readData(buf + total, len);
+    CPPUNIT_ASSERT(len > 0);
+    total += len;
+  }
+  CPPUNIT_ASSERT_EQUAL(std::string("7890ABCDEF"),
+                       std::string(&buf[0], &buf[total]));
+}
+
 void MultiDiskAdaptorTest::testCutTrailingGarbage()
 {
   std::string dir = A2_TEST_OUT_DIR;
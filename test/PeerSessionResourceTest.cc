@@ -5,6 +5,7 @@
 #include "MockBtMessageDispatcher.h"
 #include "Exception.h"
 #include "util.h"
+#include "wallclock.h"
 
 namespace aria2 {
 
@@ -29,6 +30,7 @@ class PeerSessionResourceTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testOptUnchoking);
   CPPUNIT_TEST(testShouldBeChoking);
   CPPUNIT_TEST(testCountOutstandingRequest);
+  CPPUNIT_TEST(testGetMaxOutstandingRequest);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -54,6 +56,7 @@ public:
   void testOptUnchoking();
   void testShouldBeChoking();
   void testCountOutstandingRequest();
+  void testGetMaxOutstandingRequest();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PeerSessionResourceTest);
@@ -258,4 +261,28 @@ void PeerSessionResourceTest::testCountOutstandingRequest()
   CPPUNIT_ASSERT_EQUAL((size_t)0, res.countOutstandingUpload());
 }
 
+void PeerSessionResourceTest::testGetMaxOutstandingRequest()
+{
+  PeerSessionResource res(1_k, 1_m);
+  CPPUNIT_ASSERT_EQUAL(DEFAULT_MAX_OUTSTANDING_REQUEST,
+                       res.getMaxOutstandingRequest());
+  // 200ms round trip time and 200MiB/s
+  global::wallclock().reset();
+  res.updateRequestLatency(std::chrono::milliseconds(200));
+  res.updateDownload(16_k);
+  global::wallclock().advance(std::chrono::milliseconds(200));
+  res.updateDownload(40_m - 16_k);
+  global::wallclock().reset();
+  CPPUNIT_ASSERT_EQUAL(UB_MAX_OUTSTANDING_REQUEST,
+                       res.getMaxOutstandingRequest());
+  res.setPeerRequestQueueSize(1000);
+  CPPUNIT_ASSERT_EQUAL((size_t)1000, res.getMaxOutstandingRequest());
+  res.setPeerRequestQueueSize(100000);
+  CPPUNIT_ASSERT_EQUAL(UB_MAX_REQQ_OUTSTANDING_REQUEST,
+                       res.getMaxOutstandingRequest());
+  // A reqq below DEFAULT_MAX_OUTSTANDING_REQUEST is honored.
+  res.setPeerRequestQueueSize(3);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, res.getMaxOutstandingRequest());
+}
+
 } // namespace aria2
@@ -1,5 +1,9 @@
 #include "PieceStatMan.h"
 
+#include <algorithm>
+#include <cstring>
+#include <random>
+
 #include <cppunit/extensions/HelperMacros.h>
 
 namespace aria2 {
@@ -11,6 +15,7 @@ class PieceStatManTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testAddPieceStats_bitfield);
   CPPUNIT_TEST(testUpdatePieceStats);
   CPPUNIT_TEST(testSubtractPieceStats);
+  CPPUNIT_TEST(testOrder);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -22,6 +27,7 @@ public:
   void testAddPieceStats_bitfield();
   void testUpdatePieceStats();
   void testSubtractPieceStats();
+  void testOrder();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PieceStatManTest);
@@ -35,9 +41,9 @@ void PieceStatManTest::testAddPieceStats_index()
     const std::vector<size_t>& order(pieceStatMan.getOrder());
     const std::vector<int>& counts(pieceStatMan.getCounts());
     for (size_t i = 0; i < 10; ++i) {
-      CPPUNIT_ASSERT_EQUAL(i, order[i]);
       CPPUNIT_ASSERT_EQUAL(ans[i], counts[i]);
     }
+    CPPUNIT_ASSERT_EQUAL((size_t)1, order[9]);
   }
   pieceStatMan.addPieceStats(1);
   {
@@ -126,4 +132,58 @@ void PieceStatManTest::testSubtractPieceStats()
   }
 }
 
+void PieceStatManTest::testOrder()
+{
+  PieceStatMan pieceStatMan(100, true);
+  std::vector<int> ans(100);
+  std::mt19937 gen(1);
+  unsigned char oldBitfield[13] = {};
+  for (int i = 0; i < 1000; ++i) {
+    unsigned char bitfield[13];
+    for (auto& c : bitfield) {
+      c = gen();
+    }
+    bitfield[12] &= 0xf0u;
+    switch (gen() % 3) {
+    case 0:
+      pieceStatMan.addPieceStats(bitfield, sizeof(bitfield));
+      for (size_t j = 0; j < 100; ++j) {
+        ans[j] += (bitfield[j / 8] >> (7 - j % 8)) & 1;
+      }
+      break;
+    case 1:
+      pieceStatMan.subtractPieceStats(bitfield, sizeof(bitfield));
+      for (size_t j = 0; j < 100; ++j) {
+        if ((bitfield[j / 8] >> (7 - j % 8)) & 1) {
+          ans[j] = std::max(0, ans[j] - 1);
+        }
+      }
+      break;
+    default:
+      pieceStatMan.updatePieceStats(bitfield, sizeof(bitfield), oldBitfield);
+      for (size_t j = 0; j < 100; ++j) {
+        int inNew = (bitfield[j / 8] >> (7 - j % 8)) & 1;
+        int inOld = (oldBitfield[j / 8] >> (7 - j % 8)) & 1;
+        if (inNew && !inOld) {
+          ++ans[j];
+        }
+        else if (!inNew && inOld) {
+          ans[j] = std::max(0, ans[j] - 1);
+        }
+      }
+      memcpy(oldBitfield, bitfield, sizeof(bitfield));
+    }
+    const std::vector<size_t>& order(pieceStatMan.getOrder());
+    const std::vector<size_t>& positions(pieceStatMan.getPositions());
+    const std::vector<int>& counts(pieceStatMan.getCounts());
+    for (size_t j = 0; j < 100; ++j) {
+      CPPUNIT_ASSERT_EQUAL(ans[j], counts[j]);
+      CPPUNIT_ASSERT_EQUAL(j, order[positions[j]]);
+      if (j > 0) {
+        CPPUNIT_ASSERT(counts[order[j - 1]] <= counts[order[j]]);
+      }
+    }
+  }
+}
+
 } // namespace aria2
@@ -0,0 +1,73 @@
+#include "PoolAllocated.h"
+
+#include <memory>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace aria2 {
+
+class PoolAllocatedTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(PoolAllocatedTest);
+  CPPUNIT_TEST(testNewDelete);
+  CPPUNIT_TEST(testNewDelete_derived);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testNewDelete();
+  void testNewDelete_derived();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PoolAllocatedTest);
+
+namespace {
+struct Base {
+  virtual ~Base() = default;
+};
+
+struct Pooled : public Base, public PoolAllocated<Pooled, 2> {
+  int64_t values[4];
+};
+
+struct Derived : public Pooled {
+  int64_t extra[4];
+};
+} // namespace
+
+void PoolAllocatedTest::testNewDelete()
+{
+  auto a = new Pooled();
+  auto b = new Pooled();
+  auto c = new Pooled();
+  CPPUNIT_ASSERT_EQUAL((size_t)0, Pooled::countFree());
+  delete a;
+  delete b;
+  // The free list holds at most 2 blocks.
+  delete c;
+  CPPUNIT_ASSERT_EQUAL((size_t)2, Pooled::countFree());
+  // Deleting through the base class returns the block too.
+  std::unique_ptr<Base> d(new Pooled());
+  CPPUNIT_ASSERT(static_cast<Pooled*>(d.get()) == b);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, Pooled::countFree());
+  d.reset();
+  CPPUNIT_ASSERT_EQUAL((size_t)2, Pooled::countFree());
+  auto e = new Pooled();
+  auto f = new Pooled();
+  CPPUNIT_ASSERT(e == b);
+  CPPUNIT_ASSERT(f == a);
+  CPPUNIT_ASSERT_EQUAL((size_t)0, Pooled::countFree());
+  delete e;
+  delete f;
+}
+
+void PoolAllocatedTest::testNewDelete_derived()
+{
+  auto n = Pooled::countFree();
+  std::unique_ptr<Base> d(new Derived());
+  CPPUNIT_ASSERT_EQUAL(n, Pooled::countFree());
+  d.reset();
+  // Derived has different size, so it is not pooled.
+  CPPUNIT_ASSERT_EQUAL(n, Pooled::countFree());
+}
+
+} // namespace aria2
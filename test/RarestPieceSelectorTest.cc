@@ -12,6 +12,7 @@ class RarestPieceSelectorTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(RarestPieceSelectorTest);
   CPPUNIT_TEST(testSelect);
+  CPPUNIT_TEST(testSelect_scanBitfield);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -24,6 +25,7 @@ public:
   void testUpdatePieceStats();
   void testSubtractPieceStats();
   void testSelect();
+  void testSelect_scanBitfield();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RarestPieceSelectorTest);
@@ -47,4 +49,30 @@ void RarestPieceSelectorTest::testSelect()
   CPPUNIT_ASSERT_EQUAL((size_t)2, index);
 }
 
+void RarestPieceSelectorTest::testSelect_scanBitfield()
+{
+  std::shared_ptr<PieceStatMan> pieceStatMan(new PieceStatMan(1000, true));
+  RarestPieceSelector selector(pieceStatMan);
+  BitfieldMan bf(1_k, 1000_k);
+  size_t index;
+  CPPUNIT_ASSERT(!selector.select(index, bf.getBitfield(), bf.countBlock()));
+  // Everyone has pieces except for the last 100 pieces, which we
+  // don't want to select.
+  BitfieldMan peer(1_k, 1000_k);
+  peer.setBitRange(0, 899);
+  pieceStatMan->addPieceStats(peer.getBitfield(), peer.getBitfieldLength());
+  pieceStatMan->addPieceStats(peer.getBitfield(), peer.getBitfieldLength());
+  pieceStatMan->addPieceStats(500);
+  pieceStatMan->addPieceStats(700);
+  bf.setBit(500);
+  bf.setBit(700);
+  bf.setBit(850);
+  CPPUNIT_ASSERT(selector.select(index, bf.getBitfield(), bf.countBlock()));
+  CPPUNIT_ASSERT_EQUAL((size_t)850, index);
+  bf.unsetBit(850);
+  bf.setBit(999);
+  CPPUNIT_ASSERT(selector.select(index, bf.getBitfield(), bf.countBlock()));
+  CPPUNIT_ASSERT_EQUAL((size_t)999, index);
+}
+
 } // namespace aria2
@@ -21,6 +21,8 @@
 #include "download_helper.h"
 #include "FileEntry.h"
 #include "RpcMethodFactory.h"
+#include "ValueBaseJsonParser.h"
+#include "json.h"
 #ifdef ENABLE_BITTORRENT
 #include "BtRegistry.h"
 #include "BtRuntime.h"
@@ -64,6 +66,7 @@ class RpcMethodTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testTellStatus_withoutGid);
   CPPUNIT_TEST(testTellWaiting);
   CPPUNIT_TEST(testTellWaiting_fail);
+  CPPUNIT_TEST(testTellWaiting_directEncoding);
   CPPUNIT_TEST(testGetVersion);
   CPPUNIT_TEST(testNoSuchMethod);
   CPPUNIT_TEST(testGatherStoppedDownload);
@@ -82,6 +85,7 @@ class RpcMethodTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testPause);
   CPPUNIT_TEST(testSystemMulticall);
   CPPUNIT_TEST(testSystemMulticall_fail);
+  CPPUNIT_TEST(testSystemMulticall_directEncoding);
   CPPUNIT_TEST(testSystemListMethods);
   CPPUNIT_TEST(testSystemListNotifications);
   CPPUNIT_TEST_SUITE_END();
@@ -134,6 +138,7 @@ public:
   void testTellStatus_withoutGid();
   void testTellWaiting();
   void testTellWaiting_fail();
+  void testTellWaiting_directEncoding();
   void testGetVersion();
   void testNoSuchMethod();
   void testGatherStoppedDownload();
@@ -152,6 +157,7 @@ public:
   void testPause();
   void testSystemMulticall();
   void testSystemMulticall_fail();
+  void testSystemMulticall_directEncoding();
   void testSystemListMethods();
   void testSystemListNotifications();
 };
@@ -172,6 +178,32 @@ RpcRequest createReq(std::string methodName)
 }
 } // namespace
 
+namespace {
+// Executes req with and without direct encoding, and returns both
+// results in JSON.  The directly encoded one is decoded and encoded
+// again to normalize the order of keys.
+std::pair<std::string, std::string>
+executeBoth(RpcMethod& m, const std::function<RpcRequest()>& createReq,
+            DownloadEngine* e)
+{
+  auto req = createReq();
+  req.jsonRpc = true;
+  auto res = m.execute(std::move(req), e);
+  CPPUNIT_ASSERT_EQUAL(0, res.code);
+  req = createReq();
+  req.jsonRpc = true;
+  req.directEncoding = true;
+  auto directRes = m.execute(std::move(req), e);
+  CPPUNIT_ASSERT_EQUAL(0, directRes.code);
+  CPPUNIT_ASSERT(!directRes.param);
+  ssize_t error;
+  auto decoded = json::ValueBaseJsonParser().parseFinal(
+      directRes.encodedParam.c_str(), directRes.encodedParam.size(), error);
+  CPPUNIT_ASSERT(decoded);
+  return {json::encode(res.param.get()), json::encode(decoded.get())};
+}
+} // namespace
+
 void RpcMethodTest::testAuthorize()
 {
   // Select RPC method which takes non-string parameter to make sure
@@ -893,6 +925,44 @@ void RpcMethodTest::testTellWaiting()
   CPPUNIT_ASSERT_EQUAL((size_t)1, resParams->size());
 }
 
+void RpcMethodTest::testTellWaiting_directEncoding()
+{
+  addUri("http://1/", e_);
+  addUri("http://2/", e_);
+  addUri("http://3/", e_);
+#ifdef ENABLE_BITTORRENT
+  addTorrent(A2_TEST_DIR "/single.torrent", e_);
+#endif // ENABLE_BITTORRENT
+  TellWaitingRpcMethod m;
+  for (auto offset : {0, 1, -1, -2}) {
+    auto r = executeBoth(m,
+                         [offset]() {
+                           auto req = createReq(
+                               TellWaitingRpcMethod::getMethodName());
+                           req.params->append(Integer::g(offset));
+                           req.params->append(Integer::g(3));
+                           return req;
+                         },
+                         e_.get());
+    CPPUNIT_ASSERT_EQUAL(r.first, r.second);
+  }
+  // with keys
+  auto r = executeBoth(m,
+                       []() {
+                         auto req = createReq(
+                             TellWaitingRpcMethod::getMethodName());
+                         req.params->append(Integer::g(0));
+                         req.params->append(Integer::g(3));
+                         auto keys = List::g();
+                         keys->append("gid");
+                         keys->append("files");
+                         req.params->append(std::move(keys));
+                         return req;
+                       },
+                       e_.get());
+  CPPUNIT_ASSERT_EQUAL(r.first, r.second);
+}
+
 void RpcMethodTest::testTellWaiting_fail()
 {
   TellWaitingRpcMethod m;
@@ -1411,6 +1481,35 @@ void RpcMethodTest::testSystemMulticall()
   CPPUNIT_ASSERT(downcast<List>(resParams->get(6)));
 }
 
+void RpcMethodTest::testSystemMulticall_directEncoding()
+{
+  addUri("http://1/", e_);
+  SystemMulticallRpcMethod m;
+  auto r = executeBoth(
+      m,
+      []() {
+        auto req = createReq("system.multicall");
+        auto reqparams = List::g();
+        for (std::string name : {TellWaitingRpcMethod::getMethodName(),
+                                 "not exists",
+                                 GetVersionRpcMethod::getMethodName()}) {
+          auto dict = Dict::g();
+          dict->put("methodName", name);
+          auto params = List::g();
+          if (name == TellWaitingRpcMethod::getMethodName()) {
+            params->append(Integer::g(0));
+            params->append(Integer::g(1));
+          }
+          dict->put("params", std::move(params));
+          reqparams->append(std::move(dict));
+        }
+        req.params->append(std::move(reqparams));
+        return req;
+      },
+      e_.get());
+  CPPUNIT_ASSERT_EQUAL(r.first, r.second);
+}
+
 void RpcMethodTest::testSystemMulticall_fail()
 {
   SystemMulticallRpcMethod m;
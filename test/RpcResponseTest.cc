@@ -9,15 +9,19 @@ namespace rpc {
 class RpcResponseTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(RpcResponseTest);
   CPPUNIT_TEST(testToJson);
+  CPPUNIT_TEST(testToJson_encodedParam);
 #ifdef ENABLE_XML_RPC
   CPPUNIT_TEST(testToXml);
+  CPPUNIT_TEST(testToXml_encodedParam);
 #endif // ENABLE_XML_RPC
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void testToJson();
+  void testToJson_encodedParam();
 #ifdef ENABLE_XML_RPC
   void testToXml();
+  void testToXml_encodedParam();
 #endif // ENABLE_XML_RPC
 };
 
@@ -97,6 +101,23 @@ void RpcResponseTest::testToJson()
   }
 }
 
+void RpcResponseTest::testToJson_encodedParam()
+{
+  std::string out;
+  auto w = createParamWriter(true, out);
+  w->beginList();
+  w->writeInteger(1);
+  w->writeString("a");
+  w->endList();
+  CPPUNIT_ASSERT_EQUAL(std::string("[1,\"a\"]"), out);
+  RpcResponse res(0, RpcResponse::AUTHORIZED, std::move(out),
+                  String::g("9"));
+  CPPUNIT_ASSERT_EQUAL(std::string("{\"id\":\"9\","
+                                   "\"jsonrpc\":\"2.0\","
+                                   "\"result\":[1,\"a\"]}"),
+                       toJson(res, "", false));
+}
+
 #ifdef ENABLE_XML_RPC
 void RpcResponseTest::testToXml()
 {
@@ -126,6 +147,24 @@ void RpcResponseTest::testToXml()
                   "</methodResponse>"),
       s);
 }
+
+void RpcResponseTest::testToXml_encodedParam()
+{
+  auto param = Dict::g();
+  param->put("gid", "2089b05ecca3d829");
+  param->put("pieceLength", Integer::g(1048576));
+  auto files = List::g();
+  files->append("a");
+  files->append(Dict::g());
+  param->put("files", std::move(files));
+  std::string out;
+  auto w = createParamWriter(false, out);
+  w->writeValue(param.get());
+  RpcResponse res(0, RpcResponse::AUTHORIZED, std::move(out), Null::g());
+  RpcResponse expected(0, RpcResponse::AUTHORIZED, std::move(param),
+                       Null::g());
+  CPPUNIT_ASSERT_EQUAL(toXml(expected, false), toXml(res, false));
+}
 #endif // ENABLE_XML_RPC
 
 } // namespace rpc
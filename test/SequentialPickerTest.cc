@@ -10,10 +10,12 @@ class SequentialPickerTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(SequentialPickerTest);
   CPPUNIT_TEST(testPick);
+  CPPUNIT_TEST(testPickMultiple);
   CPPUNIT_TEST_SUITE_END();
 
 public:
   void testPick();
+  void testPickMultiple();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SequentialPickerTest);
@@ -48,4 +50,36 @@ void SequentialPickerTest::testPick()
   CPPUNIT_ASSERT(!picker.hasNext());
 }
 
+void SequentialPickerTest::testPickMultiple()
+{
+  SequentialPicker<int> picker(2);
+
+  picker.pushEntry(make_unique<int>(1));
+  picker.pushEntry(make_unique<int>(2));
+  picker.pushEntry(make_unique<int>(3));
+
+  CPPUNIT_ASSERT(picker.canPickNext());
+  CPPUNIT_ASSERT_EQUAL(1, *picker.pickNext());
+  CPPUNIT_ASSERT(picker.canPickNext());
+  auto second = picker.pickNext();
+  CPPUNIT_ASSERT_EQUAL(2, *second);
+  // Limit reached
+  CPPUNIT_ASSERT(!picker.canPickNext());
+  CPPUNIT_ASSERT(picker.hasNext());
+  CPPUNIT_ASSERT_EQUAL((size_t)2, picker.countPickedEntry());
+  CPPUNIT_ASSERT_EQUAL(1, *picker.getPickedEntry());
+  CPPUNIT_ASSERT_EQUAL(
+      2, *picker.findPickedEntry([](const int& v) { return v == 2; }));
+  CPPUNIT_ASSERT(!picker.findPickedEntry([](const int& v) { return v == 3; }));
+
+  picker.dropPickedEntry(second);
+
+  CPPUNIT_ASSERT_EQUAL((size_t)1, picker.countPickedEntry());
+  CPPUNIT_ASSERT_EQUAL(1, *picker.getPickedEntry());
+  CPPUNIT_ASSERT(picker.canPickNext());
+  CPPUNIT_ASSERT_EQUAL(3, *picker.pickNext());
+  CPPUNIT_ASSERT(!picker.canPickNext());
+  CPPUNIT_ASSERT(!picker.hasNext());
+}
+
 } // namespace aria2
@@ -19,6 +19,7 @@ class ServerStatManTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(testSave);
   CPPUNIT_TEST(testLoad);
   CPPUNIT_TEST(testRemoveStaleServerStat);
+  CPPUNIT_TEST(testMerge);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -30,6 +31,7 @@ public:
   void testSave();
   void testLoad();
   void testRemoveStaleServerStat();
+  void testMerge();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ServerStatManTest);
@@ -170,4 +172,33 @@ void ServerStatManTest::testRemoveStaleServerStat()
   CPPUNIT_ASSERT(!ssm.find("mirror", "http"));
 }
 
+void ServerStatManTest::testMerge()
+{
+  auto localhost_http = std::make_shared<ServerStat>("localhost", "http");
+  localhost_http->setDownloadSpeed(100);
+  localhost_http->setLastUpdated(Time(1210000000));
+  ServerStatMan ssm;
+  CPPUNIT_ASSERT(ssm.add(localhost_http));
+
+  auto newer_http = std::make_shared<ServerStat>("localhost", "http");
+  newer_http->setDownloadSpeed(200);
+  newer_http->setLastUpdated(Time(1210000002));
+  auto localhost_ftp = std::make_shared<ServerStat>("localhost", "ftp");
+  ServerStatMan other;
+  CPPUNIT_ASSERT(other.add(newer_http));
+  CPPUNIT_ASSERT(other.add(localhost_ftp));
+  ssm.merge(other);
+  CPPUNIT_ASSERT_EQUAL(200, ssm.find("localhost", "http")->getDownloadSpeed());
+  CPPUNIT_ASSERT(ssm.find("localhost", "ftp"));
+
+  auto older_http = std::make_shared<ServerStat>("localhost", "http");
+  older_http->setDownloadSpeed(50);
+  older_http->setLastUpdated(Time(1210000001));
+  ServerStatMan older;
+  CPPUNIT_ASSERT(older.add(older_http));
+  ssm.merge(older);
+  // The more recently updated stat is kept.
+  CPPUNIT_ASSERT_EQUAL(200, ssm.find("localhost", "http")->getDownloadSpeed());
+}
+
 } // namespace aria2
@@ -0,0 +1,149 @@
+#include "SocketBuffer.h"
+
+#include <cstring>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "SocketCore.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+class SocketBufferTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(SocketBufferTest);
+  CPPUNIT_TEST(testPushBytes_pack);
+  CPPUNIT_TEST(testPushBytes_large);
+  CPPUNIT_TEST(testReserveBytes);
+  CPPUNIT_TEST_SUITE_END();
+
+  std::shared_ptr<SocketCore> client_;
+  std::shared_ptr<SocketCore> server_;
+
+public:
+  void setUp()
+  {
+    client_ = std::make_shared<SocketCore>();
+    SocketCore serverSocket;
+    serverSocket.bind(0);
+    serverSocket.beginListen();
+    serverSocket.setBlockingMode();
+    auto endpoint = serverSocket.getAddrInfo();
+    client_->establishConnection("localhost", endpoint.port);
+    client_->setBlockingMode();
+    server_ = serverSocket.acceptConnection();
+    server_->setBlockingMode();
+  }
+
+  void testPushBytes_pack();
+  void testPushBytes_large();
+  void testReserveBytes();
+
+private:
+  std::string readExactly(size_t length)
+  {
+    std::string res;
+    char buf[4096];
+    while (res.size() < length) {
+      size_t len = std::min(sizeof(buf), length - res.size());
+      server_->readData(buf, len);
+      CPPUNIT_ASSERT(len > 0);
+      res.append(buf, len);
+    }
+    return res;
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SocketBufferTest);
+
+namespace {
+struct CountUpdate : public ProgressUpdate {
+  CountUpdate(size_t* total, int* completed)
+      : total(total), completed(completed)
+  {
+  }
+  virtual void update(size_t length, bool complete) CXX11_OVERRIDE
+  {
+    *total += length;
+    if (complete) {
+      ++*completed;
+    }
+  }
+  size_t* total;
+  int* completed;
+};
+} // namespace
+
+namespace {
+const unsigned char* bytes(const char* s)
+{
+  return reinterpret_cast<const unsigned char*>(s);
+}
+} // namespace
+
+void SocketBufferTest::testPushBytes_pack()
+{
+  SocketBuffer sb(client_);
+  sb.pushBytes(bytes("alpha"), 5);
+  sb.pushBytes(bytes("bravo"), 5);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, sb.getBufferEntrySize());
+  sb.pushStr("charlie");
+  sb.pushBytes(bytes("delta"), 5);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, sb.getBufferEntrySize());
+  size_t total = 0;
+  int completed = 0;
+  // The data with ProgressUpdate gets its own entry, and nothing is
+  // packed after it.
+  sb.pushBytes(bytes("echo"), 4, make_unique<CountUpdate>(&total, &completed));
+  sb.pushBytes(bytes("foxtrot"), 7);
+  CPPUNIT_ASSERT_EQUAL((size_t)5, sb.getBufferEntrySize());
+  sb.pushBytes(bytes("golf"), 4);
+  CPPUNIT_ASSERT_EQUAL((size_t)5, sb.getBufferEntrySize());
+
+  CPPUNIT_ASSERT_EQUAL((ssize_t)37, sb.send());
+  CPPUNIT_ASSERT(sb.sendBufferIsEmpty());
+  CPPUNIT_ASSERT_EQUAL((size_t)4, total);
+  CPPUNIT_ASSERT_EQUAL(1, completed);
+  CPPUNIT_ASSERT_EQUAL(
+      std::string("alphabravocharliedeltaechofoxtrotgolf"), readExactly(37));
+
+  // Sent entries are reused.
+  sb.pushBytes(bytes("hotel"), 5);
+  sb.pushBytes(bytes("india"), 5);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, sb.getBufferEntrySize());
+  CPPUNIT_ASSERT_EQUAL((ssize_t)10, sb.send());
+  CPPUNIT_ASSERT_EQUAL(std::string("hotelindia"), readExactly(10));
+}
+
+void SocketBufferTest::testPushBytes_large()
+{
+  SocketBuffer sb(client_);
+  std::string small(500, 'a');
+  std::string large(1000, 'b');
+  sb.pushBytes(bytes(small.c_str()), small.size());
+  // Does not fit in the remaining room.
+  sb.pushBytes(bytes(small.c_str()), small.size());
+  CPPUNIT_ASSERT_EQUAL((size_t)2, sb.getBufferEntrySize());
+  sb.pushBytes(bytes(large.c_str()), large.size());
+  CPPUNIT_ASSERT_EQUAL((size_t)3, sb.getBufferEntrySize());
+  CPPUNIT_ASSERT_EQUAL((ssize_t)2000, sb.send());
+  CPPUNIT_ASSERT_EQUAL(small + small + large, readExactly(2000));
+}
+
+void SocketBufferTest::testReserveBytes()
+{
+  SocketBuffer sb(client_);
+  CPPUNIT_ASSERT(!sb.reserveBytes(0));
+  sb.pushBytes(bytes("alpha"), 5);
+  memcpy(sb.reserveBytes(5), "bravo", 5);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, sb.getBufferEntrySize());
+  std::string large(1000, 'c');
+  memcpy(sb.reserveBytes(large.size()), large.c_str(), large.size());
+  CPPUNIT_ASSERT_EQUAL((size_t)2, sb.getBufferEntrySize());
+  memcpy(sb.reserveBytes(5), "delta", 5);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, sb.getBufferEntrySize());
+  CPPUNIT_ASSERT_EQUAL((ssize_t)1015, sb.send());
+  CPPUNIT_ASSERT_EQUAL("alphabravo" + large + "delta", readExactly(1015));
+}
+
+} // namespace aria2
@@ -0,0 +1,198 @@
+#include "SocketPool.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "SocketCore.h"
+
+namespace aria2 {
+
+class SocketPoolTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(SocketPoolTest);
+  CPPUNIT_TEST(testAddPop);
+  CPPUNIT_TEST(testPop_key);
+  CPPUNIT_TEST(testPop_closedByPeer);
+  CPPUNIT_TEST(testAdd_maxSocketsPerKey);
+  CPPUNIT_TEST(testAdd_maxSockets);
+  CPPUNIT_TEST(testEvict);
+  CPPUNIT_TEST(testCountLookup);
+  CPPUNIT_TEST(testTlsSessionData);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::unique_ptr<SocketCore> server_;
+  // The peers of the sockets created by createSocket().
+  std::vector<std::shared_ptr<SocketCore>> peers_;
+
+public:
+  void setUp()
+  {
+    server_ = make_unique<SocketCore>();
+    server_->bind(0);
+    server_->beginListen();
+    server_->setBlockingMode();
+    peers_.clear();
+  }
+
+  void testAddPop();
+  void testPop_key();
+  void testPop_closedByPeer();
+  void testAdd_maxSocketsPerKey();
+  void testAdd_maxSockets();
+  void testEvict();
+  void testCountLookup();
+  void testTlsSessionData();
+
+private:
+  std::shared_ptr<SocketCore> createSocket()
+  {
+    auto socket = std::make_shared<SocketCore>();
+    socket->establishConnection("localhost", server_->getAddrInfo().port);
+    socket->setBlockingMode();
+    peers_.push_back(server_->acceptConnection());
+    return socket;
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SocketPoolTest);
+
+void SocketPoolTest::testAddPop()
+{
+  SocketPool pool(16, 256);
+  SocketPool::Key key("192.168.0.1", 80);
+  auto s1 = createSocket();
+  auto s2 = createSocket();
+  pool.add(key, s1, "opt1", std::chrono::seconds(15));
+  pool.add(key, s2, "opt2", std::chrono::seconds(15));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, pool.size());
+
+  std::string options;
+  // The most recently pooled one first
+  CPPUNIT_ASSERT(s2 == pool.pop(key, &options));
+  CPPUNIT_ASSERT_EQUAL(std::string("opt2"), options);
+  CPPUNIT_ASSERT(s1 == pool.pop(key, &options));
+  CPPUNIT_ASSERT_EQUAL(std::string("opt1"), options);
+  CPPUNIT_ASSERT(!pool.pop(key));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, pool.size());
+}
+
+void SocketPoolTest::testPop_key()
+{
+  SocketPool pool(16, 256);
+  auto s = createSocket();
+  pool.add(SocketPool::Key("192.168.0.1", 21, "alice", "proxy", 8080), s, "",
+           std::chrono::seconds(15));
+  CPPUNIT_ASSERT(!pool.pop(SocketPool::Key("192.168.0.1", 21)));
+  CPPUNIT_ASSERT(!pool.pop(SocketPool::Key("192.168.0.1", 21, "bob", "proxy",
+                                           8080)));
+  CPPUNIT_ASSERT(!pool.pop(SocketPool::Key("192.168.0.1", 21, "alice",
+                                           "proxy", 3128)));
+  CPPUNIT_ASSERT(!pool.pop(SocketPool::Key("192.168.0.1", 20, "alice",
+                                           "proxy", 8080)));
+  CPPUNIT_ASSERT(s == pool.pop(SocketPool::Key("192.168.0.1", 21, "alice",
+                                               "proxy", 8080)));
+}
+
+void SocketPoolTest::testPop_closedByPeer()
+{
+  SocketPool pool(16, 256);
+  SocketPool::Key key("192.168.0.1", 80);
+  auto s1 = createSocket();
+  auto s2 = createSocket();
+  pool.add(key, s1, "", std::chrono::seconds(15));
+  pool.add(key, s2, "", std::chrono::seconds(15));
+  peers_[1]->closeConnection();
+  // s2 is discarded, because it will receive EOF.
+  CPPUNIT_ASSERT(s1 == pool.pop(key));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, pool.size());
+}
+
+void SocketPoolTest::testAdd_maxSocketsPerKey()
+{
+  SocketPool pool(2, 256);
+  SocketPool::Key key("192.168.0.1", 80);
+  auto s1 = createSocket();
+  auto s2 = createSocket();
+  auto s3 = createSocket();
+  auto other = createSocket();
+  pool.add(key, s1, "", std::chrono::seconds(15));
+  pool.add(SocketPool::Key("192.168.0.2", 80), other, "",
+           std::chrono::seconds(15));
+  pool.add(key, s2, "", std::chrono::seconds(15));
+  pool.add(key, s3, "", std::chrono::seconds(15));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, pool.size());
+  CPPUNIT_ASSERT(s3 == pool.pop(key));
+  CPPUNIT_ASSERT(s2 == pool.pop(key));
+  CPPUNIT_ASSERT(!pool.pop(key));
+  CPPUNIT_ASSERT(other == pool.pop(SocketPool::Key("192.168.0.2", 80)));
+}
+
+void SocketPoolTest::testAdd_maxSockets()
+{
+  SocketPool pool(16, 2);
+  auto s1 = createSocket();
+  auto s2 = createSocket();
+  auto s3 = createSocket();
+  pool.add(SocketPool::Key("192.168.0.1", 80), s1, "",
+           std::chrono::seconds(15));
+  pool.add(SocketPool::Key("192.168.0.2", 80), s2, "",
+           std::chrono::seconds(15));
+  pool.add(SocketPool::Key("192.168.0.3", 80), s3, "",
+           std::chrono::seconds(15));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, pool.size());
+  // The least recently pooled one was closed.
+  CPPUNIT_ASSERT(!pool.pop(SocketPool::Key("192.168.0.1", 80)));
+  CPPUNIT_ASSERT(s2 == pool.pop(SocketPool::Key("192.168.0.2", 80)));
+  CPPUNIT_ASSERT(s3 == pool.pop(SocketPool::Key("192.168.0.3", 80)));
+}
+
+void SocketPoolTest::testEvict()
+{
+  SocketPool pool(16, 256);
+  auto s1 = createSocket();
+  auto s2 = createSocket();
+  auto s3 = createSocket();
+  pool.add(SocketPool::Key("192.168.0.1", 80), s1, "",
+           std::chrono::seconds(15));
+  pool.add(SocketPool::Key("192.168.0.2", 80), s2, "",
+           std::chrono::seconds(0));
+  pool.add(SocketPool::Key("192.168.0.3", 80), s3, "",
+           std::chrono::seconds(15));
+  pool.evict();
+  CPPUNIT_ASSERT_EQUAL((size_t)2, pool.size());
+  CPPUNIT_ASSERT(!pool.pop(SocketPool::Key("192.168.0.2", 80)));
+  CPPUNIT_ASSERT(s1 == pool.pop(SocketPool::Key("192.168.0.1", 80)));
+  CPPUNIT_ASSERT(s3 == pool.pop(SocketPool::Key("192.168.0.3", 80)));
+}
+
+void SocketPoolTest::testCountLookup()
+{
+  SocketPool pool(16, 256);
+  pool.countLookup(true);
+  pool.countLookup(false);
+  pool.countLookup(false);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)1, pool.getNumHit());
+  CPPUNIT_ASSERT_EQUAL((uint64_t)2, pool.getNumMiss());
+}
+
+void SocketPoolTest::testTlsSessionData()
+{
+  SocketPool pool(16, 2);
+  CPPUNIT_ASSERT_EQUAL(std::string(),
+                       pool.getTlsSessionData("example.org", 443));
+  pool.putTlsSessionData("example.org", 443, "foo");
+  pool.putTlsSessionData("example.org", 8443, "bar");
+  CPPUNIT_ASSERT_EQUAL(std::string("foo"),
+                       pool.getTlsSessionData("example.org", 443));
+  CPPUNIT_ASSERT_EQUAL(std::string("bar"),
+                       pool.getTlsSessionData("example.org", 8443));
+  pool.putTlsSessionData("example.org", 443, "baz");
+  CPPUNIT_ASSERT_EQUAL(std::string("baz"),
+                       pool.getTlsSessionData("example.org", 443));
+  // Full.  Some entry is dropped.
+  pool.putTlsSessionData("example.net", 443, "qux");
+  CPPUNIT_ASSERT_EQUAL(std::string("qux"),
+                       pool.getTlsSessionData("example.net", 443));
+}
+
+} // namespace aria2
@@ -0,0 +1,168 @@
+#include "StatusSubscription.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "DownloadEngine.h"
+#include "SelectEventPoll.h"
+#include "Option.h"
+#include "RequestGroupMan.h"
+#include "RequestGroup.h"
+#include "DownloadResult.h"
+#include "GroupId.h"
+#include "prefs.h"
+#include "File.h"
+#include "TestUtil.h"
+#include "download_helper.h"
+#include "ValueBase.h"
+#include "ValueBaseJsonParser.h"
+
+namespace aria2 {
+
+namespace rpc {
+
+class StatusSubscriptionTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(StatusSubscriptionTest);
+  CPPUNIT_TEST(testCreateNotification);
+  CPPUNIT_TEST(testCreateNotification_stopped);
+  CPPUNIT_TEST(testCreateNotification_removed);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::unique_ptr<DownloadEngine> e_;
+  std::shared_ptr<Option> option_;
+
+public:
+  void setUp()
+  {
+    option_ = std::make_shared<Option>();
+    option_->put(PREF_DIR, A2_TEST_OUT_DIR "/aria2_StatusSubscriptionTest");
+    option_->put(PREF_PIECE_LENGTH, "1048576");
+    option_->put(PREF_MAX_DOWNLOAD_RESULT, "10");
+    File(option_->get(PREF_DIR)).mkdirs();
+    e_ = make_unique<DownloadEngine>(make_unique<SelectEventPoll>());
+    e_->setOption(option_.get());
+    e_->setRequestGroupMan(make_unique<RequestGroupMan>(
+        std::vector<std::shared_ptr<RequestGroup>>{}, 1, option_.get()));
+  }
+
+  void testCreateNotification();
+  void testCreateNotification_stopped();
+  void testCreateNotification_removed();
+
+private:
+  std::shared_ptr<RequestGroup> addUri(const std::string& uri)
+  {
+    std::vector<std::shared_ptr<RequestGroup>> result;
+    createRequestGroupForUri(result, option_, {uri});
+    e_->getRequestGroupMan()->addReservedGroup(result);
+    return result.front();
+  }
+
+  // Decodes notification msg and returns its params.
+  std::unique_ptr<ValueBase> decode(const std::string& msg)
+  {
+    ssize_t error;
+    auto v = json::ValueBaseJsonParser().parseFinal(msg.c_str(), msg.size(),
+                                                    error);
+    auto dict = downcast<Dict>(v);
+    CPPUNIT_ASSERT(dict);
+    CPPUNIT_ASSERT_EQUAL(std::string("aria2.onDownloadChange"),
+                         downcast<String>(dict->get("method"))->s());
+    return dict->popValue("params");
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StatusSubscriptionTest);
+
+namespace {
+const Dict* getEntry(const ValueBase* params, size_t index)
+{
+  return downcast<Dict>(downcast<List>(params)->get(index));
+}
+} // namespace
+
+namespace {
+std::string getString(const Dict* dict, const std::string& key)
+{
+  return downcast<String>(dict->get(key))->s();
+}
+} // namespace
+
+void StatusSubscriptionTest::testCreateNotification()
+{
+  auto g1 = addUri("http://1/");
+  auto g2 = addUri("http://2/");
+  StatusSubscription sub({"status", "totalLength"});
+  // The first notification reports everything.
+  auto params = decode(sub.createNotification(e_.get()));
+  CPPUNIT_ASSERT_EQUAL((size_t)2, downcast<List>(params)->size());
+  auto entry = getEntry(params.get(), 0);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, entry->size());
+  CPPUNIT_ASSERT_EQUAL(GroupId::toHex(g1->getGID()), getString(entry, "gid"));
+  CPPUNIT_ASSERT_EQUAL(std::string("waiting"), getString(entry, "status"));
+  CPPUNIT_ASSERT_EQUAL(std::string("0"), getString(entry, "totalLength"));
+  entry = getEntry(params.get(), 1);
+  CPPUNIT_ASSERT_EQUAL(GroupId::toHex(g2->getGID()), getString(entry, "gid"));
+  // Nothing changed
+  CPPUNIT_ASSERT_EQUAL(std::string(), sub.createNotification(e_.get()));
+  // Only the changed field is reported.
+  g2->setPauseRequested(true);
+  params = decode(sub.createNotification(e_.get()));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, downcast<List>(params)->size());
+  entry = getEntry(params.get(), 0);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, entry->size());
+  CPPUNIT_ASSERT_EQUAL(GroupId::toHex(g2->getGID()), getString(entry, "gid"));
+  CPPUNIT_ASSERT_EQUAL(std::string("paused"), getString(entry, "status"));
+  // The state serial is updated, but the fields are unchanged.
+  g2->updateStateSerial();
+  CPPUNIT_ASSERT_EQUAL(std::string(), sub.createNotification(e_.get()));
+  // New download
+  auto g3 = addUri("http://3/");
+  params = decode(sub.createNotification(e_.get()));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, downcast<List>(params)->size());
+  entry = getEntry(params.get(), 0);
+  CPPUNIT_ASSERT_EQUAL(GroupId::toHex(g3->getGID()), getString(entry, "gid"));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, entry->size());
+}
+
+void StatusSubscriptionTest::testCreateNotification_stopped()
+{
+  auto g1 = addUri("http://1/");
+  StatusSubscription sub({"status", "errorCode"});
+  sub.createNotification(e_.get());
+  auto& rgman = e_->getRequestGroupMan();
+  rgman->removeReservedGroup(g1->getGID());
+  g1->setHaltRequested(true, RequestGroup::USER_REQUEST);
+  rgman->addDownloadResult(g1->createDownloadResult());
+  auto params = decode(sub.createNotification(e_.get()));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, downcast<List>(params)->size());
+  auto entry = getEntry(params.get(), 0);
+  CPPUNIT_ASSERT_EQUAL(GroupId::toHex(g1->getGID()), getString(entry, "gid"));
+  CPPUNIT_ASSERT_EQUAL(std::string("removed"), getString(entry, "status"));
+  CPPUNIT_ASSERT_EQUAL(std::string("31"), getString(entry, "errorCode"));
+  // The stopped download is reported only once.
+  CPPUNIT_ASSERT_EQUAL(std::string(), sub.createNotification(e_.get()));
+}
+
+void StatusSubscriptionTest::testCreateNotification_removed()
+{
+  auto g1 = addUri("http://1/");
+  auto g2 = addUri("http://2/");
+  StatusSubscription sub({"totalLength"});
+  StatusSubscription statusSub({});
+  sub.createNotification(e_.get());
+  statusSub.createNotification(e_.get());
+  e_->getRequestGroupMan()->removeReservedGroup(g1->getGID());
+  // status is not subscribed.
+  CPPUNIT_ASSERT_EQUAL(std::string(), sub.createNotification(e_.get()));
+  auto params = decode(statusSub.createNotification(e_.get()));
+  CPPUNIT_ASSERT_EQUAL((size_t)1, downcast<List>(params)->size());
+  auto entry = getEntry(params.get(), 0);
+  CPPUNIT_ASSERT_EQUAL(GroupId::toHex(g1->getGID()), getString(entry, "gid"));
+  CPPUNIT_ASSERT_EQUAL(std::string("removed"), getString(entry, "status"));
+}
+
+} // namespace rpc
+
+} // namespace aria2
@@ -0,0 +1,55 @@
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <stdexcept>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace aria2 {
+
+class ThreadPoolTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(ThreadPoolTest);
+  CPPUNIT_TEST(testSubmit);
+  CPPUNIT_TEST(testSubmit_exception);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testSubmit();
+  void testSubmit_exception();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ThreadPoolTest);
+
+void ThreadPoolTest::testSubmit()
+{
+  std::atomic<int> count(0);
+  ThreadPool pool(4);
+  CPPUNIT_ASSERT_EQUAL((size_t)4, pool.getNumThreads());
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 100; ++i) {
+    results.push_back(pool.submit([i, &count] {
+      ++count;
+      return i * i;
+    }));
+  }
+  for (int i = 0; i < 100; ++i) {
+    CPPUNIT_ASSERT_EQUAL(i * i, results[i].get());
+  }
+  CPPUNIT_ASSERT_EQUAL(100, count.load());
+}
+
+void ThreadPoolTest::testSubmit_exception()
+{
+  ThreadPool pool(1);
+  auto res = pool.submit([]() -> int { throw std::runtime_error("error"); });
+  try {
+    res.get();
+    CPPUNIT_FAIL("exception must be thrown");
+  }
+  catch (std::runtime_error& e) {
+    CPPUNIT_ASSERT_EQUAL(std::string("error"), std::string(e.what()));
+  }
+}
+
+} // namespace aria2
@@ -0,0 +1,154 @@
+#include "TimerWheel.h"
+
+#include <memory>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Command.h"
+#include "a2functional.h"
+
+namespace aria2 {
+
+class TimerWheelTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(TimerWheelTest);
+  CPPUNIT_TEST(testAdvance);
+  CPPUNIT_TEST(testAdvance_cascade);
+  CPPUNIT_TEST(testAdvance_pastDeadline);
+  CPPUNIT_TEST(testWakeUp);
+  CPPUNIT_TEST(testSchedule_reschedule);
+  CPPUNIT_TEST(testClear);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testAdvance();
+  void testAdvance_cascade();
+  void testAdvance_pastDeadline();
+  void testWakeUp();
+  void testSchedule_reschedule();
+  void testClear();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TimerWheelTest);
+
+namespace {
+class MockCommand : public Command {
+public:
+  MockCommand() : Command(1) {}
+  virtual bool execute() CXX11_OVERRIDE { return true; }
+  bool isActive() const { return statusMatch(Command::STATUS_ACTIVE); }
+};
+} // namespace
+
+namespace {
+Timer at(std::chrono::milliseconds t)
+{
+  return Timer(std::chrono::duration_cast<Timer::Clock::duration>(t));
+}
+} // namespace
+
+void TimerWheelTest::testAdvance()
+{
+  TimerWheel wheel(at(0_ms));
+  MockCommand c1, c2;
+  wheel.schedule(&c1, at(250_ms));
+  wheel.schedule(&c2, at(350_ms));
+  CPPUNIT_ASSERT(c1.isSleeping());
+  wheel.advance(at(200_ms));
+  CPPUNIT_ASSERT(c1.isSleeping());
+  CPPUNIT_ASSERT(!c1.isActive());
+  // The deadline is rounded up to the tick.
+  wheel.advance(at(299_ms));
+  CPPUNIT_ASSERT(c1.isSleeping());
+  wheel.advance(at(300_ms));
+  CPPUNIT_ASSERT(!c1.isSleeping());
+  CPPUNIT_ASSERT(c1.isActive());
+  CPPUNIT_ASSERT(c2.isSleeping());
+  CPPUNIT_ASSERT(!c2.isActive());
+  wheel.advance(at(10000_ms));
+  CPPUNIT_ASSERT(!c2.isSleeping());
+  CPPUNIT_ASSERT(c2.isActive());
+}
+
+void TimerWheelTest::testAdvance_cascade()
+{
+  TimerWheel wheel(at(0_ms));
+  // Each of them is put in the different level.
+  std::chrono::milliseconds deadlines[] = {3000_ms, 60000_ms, 3600000_ms,
+                                           86400000_ms};
+  MockCommand commands[4];
+  for (size_t i = 0; i < 4; ++i) {
+    wheel.schedule(&commands[i], at(deadlines[i]));
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    // Advances in steps of irregular size.
+    wheel.advance(at(deadlines[i] - 100_ms));
+    CPPUNIT_ASSERT(commands[i].isSleeping());
+    wheel.advance(at(deadlines[i]));
+    CPPUNIT_ASSERT(!commands[i].isSleeping());
+    CPPUNIT_ASSERT(commands[i].isActive());
+    for (size_t j = i + 1; j < 4; ++j) {
+      CPPUNIT_ASSERT(commands[j].isSleeping());
+    }
+  }
+}
+
+void TimerWheelTest::testAdvance_pastDeadline()
+{
+  TimerWheel wheel(at(0_ms));
+  wheel.advance(at(5000_ms));
+  MockCommand c;
+  wheel.schedule(&c, at(1000_ms));
+  CPPUNIT_ASSERT(c.isSleeping());
+  wheel.advance(at(5000_ms));
+  CPPUNIT_ASSERT(c.isSleeping());
+  wheel.advance(at(5100_ms));
+  CPPUNIT_ASSERT(c.isActive());
+}
+
+void TimerWheelTest::testWakeUp()
+{
+  TimerWheel wheel(at(0_ms));
+  MockCommand c1;
+  auto c2 = make_unique<MockCommand>();
+  wheel.schedule(&c1, at(1000_ms));
+  wheel.schedule(c2.get(), at(1000_ms));
+  c1.wakeUp();
+  CPPUNIT_ASSERT(!c1.isSleeping());
+  // The destroyed command removes itself from the wheel.
+  c2.reset();
+  wheel.advance(at(2000_ms));
+  CPPUNIT_ASSERT(!c1.isActive());
+}
+
+void TimerWheelTest::testSchedule_reschedule()
+{
+  TimerWheel wheel(at(0_ms));
+  MockCommand c;
+  wheel.schedule(&c, at(1000_ms));
+  wheel.schedule(&c, at(20000_ms));
+  wheel.advance(at(19900_ms));
+  CPPUNIT_ASSERT(c.isSleeping());
+  wheel.advance(at(20000_ms));
+  CPPUNIT_ASSERT(c.isActive());
+}
+
+void TimerWheelTest::testClear()
+{
+  MockCommand c1, c2;
+  {
+    TimerWheel wheel(at(0_ms));
+    wheel.schedule(&c1, at(1000_ms));
+    wheel.schedule(&c2, at(100000_ms));
+    wheel.clear();
+    CPPUNIT_ASSERT(!c1.isSleeping());
+    CPPUNIT_ASSERT(!c2.isSleeping());
+    wheel.advance(at(100000_ms));
+    CPPUNIT_ASSERT(!c1.isActive());
+    wheel.schedule(&c1, at(1000_ms));
+  }
+  // The wheel is destroyed before the command.
+  CPPUNIT_ASSERT(!c1.isSleeping());
+}
+
+} // namespace aria2
@@ -0,0 +1,206 @@
+#include "ValueArena.h"
+
+#include <cstring>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ArenaStructParserStateMachine.h"
+#include "GenericParser.h"
+#include "BencodeParser.h"
+#include "JsonParser.h"
+#include "bencode2.h"
+#include "util.h"
+#include "TestUtil.h"
+
+namespace aria2 {
+
+class ValueArenaTest : public CppUnit::TestFixture {
+
+  CPPUNIT_TEST_SUITE(ValueArenaTest);
+  CPPUNIT_TEST(testParseBencode);
+  CPPUNIT_TEST(testParseBencode_duplicateKey);
+  CPPUNIT_TEST(testParseBencode_error);
+  CPPUNIT_TEST(testParseJson);
+  CPPUNIT_TEST(testParseUpdate);
+  CPPUNIT_TEST(testCopyString);
+  CPPUNIT_TEST(testEncode);
+  CPPUNIT_TEST(testDecodeArenaFromFile);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void testParseBencode();
+  void testParseBencode_duplicateKey();
+  void testParseBencode_error();
+  void testParseJson();
+  void testParseUpdate();
+  void testCopyString();
+  void testEncode();
+  void testDecodeArenaFromFile();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ValueArenaTest);
+
+void ValueArenaTest::testParseBencode()
+{
+  std::string src = "d4:name3:foo6:lengthi-7e5:filesl1:ad1:xi1eeee";
+  auto arena = bencode2::decodeArena(src);
+  auto root = arena->root();
+  CPPUNIT_ASSERT(root.isDict());
+  CPPUNIT_ASSERT_EQUAL((size_t)3, root.size());
+
+  auto name = root.get("name");
+  CPPUNIT_ASSERT(name.isString());
+  CPPUNIT_ASSERT_EQUAL(std::string("foo"), name.s());
+  // The string refers to the input buffer.
+  CPPUNIT_ASSERT(src.data() + 9 == name.data());
+
+  CPPUNIT_ASSERT_EQUAL((int64_t)-7, root.get("length").i());
+  CPPUNIT_ASSERT(!root.get("nothing"));
+  CPPUNIT_ASSERT(!root.containsKey("nam"));
+  CPPUNIT_ASSERT(!root.get("name").get("name"));
+
+  auto files = root.get("files");
+  CPPUNIT_ASSERT(files.isList());
+  CPPUNIT_ASSERT_EQUAL((size_t)2, files.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("a"), files.get((size_t)0).s());
+  CPPUNIT_ASSERT_EQUAL((int64_t)1, files.get(1).get("x").i());
+  CPPUNIT_ASSERT(!files.get(2));
+  size_t n = 0;
+  for (auto v : files) {
+    CPPUNIT_ASSERT(v);
+    ++n;
+  }
+  CPPUNIT_ASSERT_EQUAL((size_t)2, n);
+
+  // Members are ordered by key.
+  CPPUNIT_ASSERT_EQUAL(std::string("files"), root.getKey(0).s());
+  CPPUNIT_ASSERT_EQUAL(std::string("length"), root.getKey(1).s());
+  CPPUNIT_ASSERT_EQUAL(std::string("name"), root.getKey(2).s());
+  CPPUNIT_ASSERT(root.getValue(2).equals("foo", 3));
+
+  // Non-list value has no element.
+  CPPUNIT_ASSERT(name.begin() == name.end());
+
+  src = "";
+  CPPUNIT_ASSERT(!bencode2::decodeArena(src));
+  src = "de";
+  auto empty = bencode2::decodeArena(src);
+  CPPUNIT_ASSERT(empty->root().isDict());
+  CPPUNIT_ASSERT(empty->root().empty());
+}
+
+void ValueArenaTest::testParseBencode_duplicateKey()
+{
+  std::string src = "d1:bi1e1:ai2e1:bi3e1:ai4ee";
+  auto arena = bencode2::decodeArena(src);
+  auto root = arena->root();
+  CPPUNIT_ASSERT_EQUAL((size_t)2, root.size());
+  // The last one wins.
+  CPPUNIT_ASSERT_EQUAL((int64_t)4, root.get("a").i());
+  CPPUNIT_ASSERT_EQUAL((int64_t)3, root.get("b").i());
+}
+
+void ValueArenaTest::testParseBencode_error()
+{
+  try {
+    std::string src = "d1:ai1e";
+    bencode2::decodeArena(src);
+    CPPUNIT_FAIL("exception must be thrown.");
+  }
+  catch (RecoverableException& e) {
+  }
+}
+
+void ValueArenaTest::testParseJson()
+{
+  std::string src = "{\"str\":\"a\\nb\",\"plain\":\"xyz\","
+                    "\"list\":[true,false,null,1.5,-3,{}],\"utf\":\"\\u00e9\"}";
+  ssize_t error;
+  auto arena = parseArena<json::JsonParser>(src.c_str(), src.size(), error);
+  CPPUNIT_ASSERT_EQUAL((ssize_t)src.size(), error);
+  auto root = arena->root();
+  CPPUNIT_ASSERT_EQUAL((size_t)4, root.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("a\nb"), root.get("str").s());
+  CPPUNIT_ASSERT_EQUAL(std::string("xyz"), root.get("plain").s());
+  CPPUNIT_ASSERT(src.data() < root.get("plain").data() &&
+                 root.get("plain").data() < src.data() + src.size());
+  CPPUNIT_ASSERT_EQUAL(std::string("\xc3\xa9"), root.get("utf").s());
+  auto list = root.get("list");
+  CPPUNIT_ASSERT_EQUAL((size_t)6, list.size());
+  CPPUNIT_ASSERT(list.get((size_t)0).isBool());
+  CPPUNIT_ASSERT(list.get((size_t)0).b());
+  CPPUNIT_ASSERT(!list.get(1).b());
+  CPPUNIT_ASSERT(list.get(2).isNull());
+  // Fraction is ignored just like ValueBaseStructParserStateMachine.
+  CPPUNIT_ASSERT_EQUAL((int64_t)1, list.get(3).i());
+  CPPUNIT_ASSERT_EQUAL((int64_t)-3, list.get(4).i());
+  CPPUNIT_ASSERT(list.get(5).isDict());
+
+  src = "[1,";
+  CPPUNIT_ASSERT(!parseArena<json::JsonParser>(src.c_str(), src.size(), error));
+  CPPUNIT_ASSERT(error < 0);
+}
+
+void ValueArenaTest::testParseUpdate()
+{
+  GenericParser<json::JsonParser, ArenaStructParserStateMachine> parser;
+  std::string src = "{\"key\":\"hello world\",\"n\":[1]}";
+  // Feed one byte at a time from the buffer which is reused, so that
+  // all strings must be copied.
+  char buf[1];
+  for (auto c : src) {
+    buf[0] = c;
+    CPPUNIT_ASSERT_EQUAL((ssize_t)1, parser.parseUpdate(buf, 1));
+    buf[0] = '\0';
+  }
+  ssize_t error;
+  auto arena = parser.parseFinal(nullptr, 0, error);
+  CPPUNIT_ASSERT(arena);
+  auto root = arena->root();
+  CPPUNIT_ASSERT_EQUAL(std::string("hello world"), root.get("key").s());
+  CPPUNIT_ASSERT_EQUAL((int64_t)1, root.get("n").get((size_t)0).i());
+
+  // The parser can be reused.
+  src = "\"foo\"";
+  arena = parser.parseFinal(src.c_str(), src.size(), error);
+  CPPUNIT_ASSERT_EQUAL(std::string("foo"), arena->root().s());
+}
+
+void ValueArenaTest::testCopyString()
+{
+  ValueArena arena;
+  std::string large(4096, 'a');
+  auto small = arena.copyString("foo", 3);
+  auto copied = arena.copyString(large.data(), large.size());
+  auto small2 = arena.copyString("bar", 3);
+  CPPUNIT_ASSERT_EQUAL(std::string("foo"), std::string(small, 3));
+  CPPUNIT_ASSERT_EQUAL(large, std::string(copied, large.size()));
+  CPPUNIT_ASSERT_EQUAL(std::string("bar"), std::string(small2, 3));
+  // Small strings are packed into the same block.
+  CPPUNIT_ASSERT(small + 3 == small2);
+}
+
+void ValueArenaTest::testEncode()
+{
+  std::string src = "d1:bi1e1:al3:fooi-2edee1:ai3ee";
+  auto arena = bencode2::decodeArena(src);
+  CPPUNIT_ASSERT_EQUAL(std::string("d1:ai3e1:bi1ee"),
+                       bencode2::encode(arena->root()));
+  src = "l3:fooi-2edee";
+  arena = bencode2::decodeArena(src);
+  CPPUNIT_ASSERT_EQUAL(src, bencode2::encode(arena->root()));
+}
+
+void ValueArenaTest::testDecodeArenaFromFile()
+{
+  auto arena = bencode2::decodeArenaFromFile(A2_TEST_DIR "/test.torrent");
+  CPPUNIT_ASSERT(arena);
+  auto info = arena->root().get("info");
+  CPPUNIT_ASSERT(info.isDict());
+  CPPUNIT_ASSERT_EQUAL(std::string("aria2-test"), info.get("name").s());
+
+  CPPUNIT_ASSERT(!bencode2::decodeArenaFromFile(A2_TEST_DIR "/nonexistent"));
+  CPPUNIT_ASSERT(!bencode2::decodeArenaFromFile(A2_TEST_DIR "/base_uri.xml"));
+}
+
+} // namespace aria2
@@ -14,6 +14,10 @@ class WrDiskCacheTest : public CppUnit::TestFixture {
 
   CPPUNIT_TEST_SUITE(WrDiskCacheTest);
   CPPUNIT_TEST(testAdd);
+  CPPUNIT_TEST(testAllocateBuffer);
+#ifdef ENABLE_THREADS
+  CPPUNIT_TEST(testShareTotal);
+#endif // ENABLE_THREADS
   CPPUNIT_TEST_SUITE_END();
 
   std::shared_ptr<DirectDiskAdaptor> adaptor_;
@@ -29,6 +33,10 @@ public:
   }
 
   void testAdd();
+  void testAllocateBuffer();
+#ifdef ENABLE_THREADS
+  void testShareTotal();
+#endif // ENABLE_THREADS
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(WrDiskCacheTest);
@@ -58,20 +66,109 @@ void WrDiskCacheTest::testAdd()
   e3.cacheData(createDataCell(15, " world"));
   CPPUNIT_ASSERT(dc.update(&e3, 6));
 
-  // e3 is flushed to the disk
-  CPPUNIT_ASSERT_EQUAL(std::string("who knows?hello world"),
+  // e2 and e3 are in the same size class.  e2 is flushed to the disk
+  // because it is less recently updated.
+  CPPUNIT_ASSERT_EQUAL(std::string("who knows?") + std::string(11, '\0') +
+                           "seconddata",
                        writer_->getString());
-  CPPUNIT_ASSERT_EQUAL((size_t)0, e3.getSize());
-  CPPUNIT_ASSERT_EQUAL((size_t)10, dc.getSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, e2.getSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)11, e3.getSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)11, dc.getSize());
 
   e2.cacheData(createDataCell(31, "01234567890"));
   CPPUNIT_ASSERT(dc.update(&e2, 11));
-  // e2 is flushed to the disk
+  // e3 is flushed to the disk
+  CPPUNIT_ASSERT_EQUAL(std::string("who knows?hello worldseconddata"),
+                       writer_->getString());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, e3.getSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)11, dc.getSize());
+
+  e1.cacheData(createDataCell(44, "xyz"));
+  CPPUNIT_ASSERT(dc.update(&e1, 3));
+  e2.cacheData(createDataCell(42, "ab"));
+  CPPUNIT_ASSERT(dc.update(&e2, 2));
+  CPPUNIT_ASSERT_EQUAL((size_t)16, dc.getSize());
+  e3.cacheData(createDataCell(47, "hello"));
+  CPPUNIT_ASSERT(dc.update(&e3, 5));
+  // e2 is flushed first because it is in the largest size class,
+  // although e1 is less recently updated.
   CPPUNIT_ASSERT_EQUAL(
-      std::string("who knows?hello worldseconddata01234567890"),
+      std::string("who knows?hello worldseconddata01234567890ab"),
       writer_->getString());
   CPPUNIT_ASSERT_EQUAL((size_t)0, e2.getSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)3, e1.getSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)8, dc.getSize());
+
+  CPPUNIT_ASSERT(dc.remove(&e1));
+  CPPUNIT_ASSERT(!dc.remove(&e1));
+  CPPUNIT_ASSERT_EQUAL((size_t)5, dc.getSize());
+  e1.clear();
+  CPPUNIT_ASSERT(dc.update(&e3, -5));
+  e3.clear();
   CPPUNIT_ASSERT_EQUAL((size_t)0, dc.getSize());
+  CPPUNIT_ASSERT(dc.remove(&e2));
+  CPPUNIT_ASSERT(dc.remove(&e3));
+}
+
+void WrDiskCacheTest::testAllocateBuffer()
+{
+  WrDiskCache dc(32_k);
+  size_t capacity;
+  auto buf1 = dc.allocateBuffer(100, &capacity);
+  CPPUNIT_ASSERT_EQUAL(WrDiskCache::CELL_BUFFER_SIZE, capacity);
+  auto buf2 = dc.allocateBuffer(16_k, &capacity);
+  CPPUNIT_ASSERT_EQUAL(WrDiskCache::CELL_BUFFER_SIZE, capacity);
+  auto buf3 = dc.allocateBuffer(16_k + 1, &capacity);
+  CPPUNIT_ASSERT_EQUAL((size_t)16_k + 1, capacity);
+  auto buf4 = dc.allocateBuffer(1, &capacity);
+
+  dc.releaseBuffer(buf1, WrDiskCache::CELL_BUFFER_SIZE);
+  dc.releaseBuffer(buf3, 16_k + 1);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, dc.getNumPooledBuffer());
+  // Released buffer is reused.
+  CPPUNIT_ASSERT(buf1 == dc.allocateBuffer(10, &capacity));
+  CPPUNIT_ASSERT_EQUAL((size_t)0, dc.getNumPooledBuffer());
+
+  dc.releaseBuffer(buf1, WrDiskCache::CELL_BUFFER_SIZE);
+  dc.releaseBuffer(buf2, WrDiskCache::CELL_BUFFER_SIZE);
+  // The pool does not keep more buffers than the cache limit.
+  dc.releaseBuffer(buf4, WrDiskCache::CELL_BUFFER_SIZE);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, dc.getNumPooledBuffer());
+}
+
+#ifdef ENABLE_THREADS
+void WrDiskCacheTest::testShareTotal()
+{
+  std::atomic<size_t> total(0);
+  WrDiskCache dc1(20);
+  WrDiskCache dc2(20);
+  dc1.shareTotal(&total);
+  dc2.shareTotal(&total);
+
+  WrDiskCacheEntry e1(adaptor_);
+  e1.cacheData(createDataCell(0, "who knows?"));
+  CPPUNIT_ASSERT(dc1.add(&e1));
+  CPPUNIT_ASSERT_EQUAL((size_t)10, total.load());
+
+  auto adaptor2 = std::make_shared<DirectDiskAdaptor>();
+  auto dw = make_unique<ByteArrayDiskWriter>();
+  auto writer2 = dw.get();
+  adaptor2->setDiskWriter(std::move(dw));
+  WrDiskCacheEntry e2(adaptor2);
+  e2.cacheData(createDataCell(0, "0123456789ab"));
+  CPPUNIT_ASSERT(dc2.add(&e2));
+  // The limit is exceeded in total.  dc2 flushes its own entry.
+  CPPUNIT_ASSERT_EQUAL(std::string("0123456789ab"), writer2->getString());
+  CPPUNIT_ASSERT_EQUAL((size_t)0, dc2.getSize());
+  CPPUNIT_ASSERT_EQUAL((size_t)10, dc1.getSize());
+  CPPUNIT_ASSERT_EQUAL(std::string(), writer_->getString());
+  CPPUNIT_ASSERT_EQUAL((size_t)10, total.load());
+
+  CPPUNIT_ASSERT(dc1.remove(&e1));
+  e1.clear();
+  CPPUNIT_ASSERT_EQUAL((size_t)0, total.load());
+  CPPUNIT_ASSERT(dc2.remove(&e2));
 }
+#endif // ENABLE_THREADS
 
 } // namespace aria2